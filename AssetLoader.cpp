@@ -0,0 +1,27 @@
+#include "AssetLoader.h"
+
+AssetLoader::AssetLoader(JobSystem& a_jsJobs) :
+	m_jsJobs(a_jsJobs),
+	m_tpStart(Clock::now())
+{
+}
+
+AssetLoadStats AssetLoader::Finish(void)
+{
+	// Waiting in submission order, so create steps can depend on earlier ones.
+	for (std::function<void()>& create : m_lCreateSteps)
+		create();
+
+	AssetLoadStats stats = {};
+	stats.AssetCount = static_cast<unsigned int>(m_lCreateSteps.size());
+	stats.ThreadCount = m_jsJobs.GetThreadCount();
+	stats.WallTimeMs = MillisecondsSince(m_tpStart);
+
+	m_lCreateSteps.clear();
+	return stats;
+}
+
+double AssetLoader::MillisecondsSince(Clock::time_point a_tpStart)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - a_tpStart).count();
+}
@@ -0,0 +1,77 @@
+#ifndef __ASSETLOADER_H_
+#define __ASSETLOADER_H_
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "JobSystem.h"
+
+/// <summary>
+/// Timing of a batch of assets loaded through an AssetLoader.
+/// </summary>
+struct AssetLoadStats
+{
+	unsigned int AssetCount;
+	unsigned int ThreadCount;
+	double WallTimeMs;				// From constructing the loader to Finish() returning.  Loading the
+									// same batch on JobSystem(0) gives the serial baseline to compare with.
+};
+
+/// <summary>
+/// Splits asset loading into a CPU step (file reads, decoding, mesh processing)
+/// that runs on a JobSystem and a create step that runs on the thread calling
+/// Finish(), which should be the thread that owns the graphics device.  Nothing
+/// here depends on the graphics API, the create steps decide what "create" means.
+/// </summary>
+class AssetLoader
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	JobSystem& m_jsJobs;
+	std::vector<std::function<void()>> m_lCreateSteps;
+	Clock::time_point m_tpStart;
+
+public:
+	/// <summary>
+	/// Starts timing a new batch of assets.
+	/// </summary>
+	/// <param name="a_jsJobs">The job system the load steps are submitted to.</param>
+	AssetLoader(JobSystem& a_jsJobs);
+
+	AssetLoader(const AssetLoader&) = delete;
+	AssetLoader& operator=(const AssetLoader&) = delete;
+
+	/// <summary>
+	/// Queues the load step of an asset right away and remembers its create step for Finish().
+	/// </summary>
+	/// <param name="a_fLoad">Returns the CPU side data.  Runs on a worker thread.</param>
+	/// <param name="a_fCreate">Receives the data by reference.  Runs on the thread calling Finish(), in the order assets were added.</param>
+	template<typename Load, typename Create>
+	void Add(Load a_fLoad, Create a_fCreate)
+	{
+		typedef std::invoke_result_t<Load> Result;
+
+		std::shared_ptr<std::future<Result>> pFuture = std::make_shared<std::future<Result>>(m_jsJobs.Submit(std::move(a_fLoad)));
+
+		m_lCreateSteps.push_back([pFuture, a_fCreate]() mutable
+		{
+			Result value = pFuture->get();
+			a_fCreate(value);
+		});
+	}
+
+	/// <summary>
+	/// Waits for every load step and runs the create steps on the calling thread.
+	/// Rethrows the first exception thrown by a load or create step.
+	/// </summary>
+	/// <returns>The wall time of the whole batch.</returns>
+	AssetLoadStats Finish(void);
+
+private:
+	static double MillisecondsSince(Clock::time_point a_tpStart);
+};
+
+#endif //__ASSETLOADER_H_
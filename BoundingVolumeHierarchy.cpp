@@ -0,0 +1,520 @@
+#include "BoundingVolumeHierarchy.h"
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+
+using namespace DirectX;
+
+namespace
+{
+	// Centroids are sorted into this many slots per axis when looking for a split.
+	const unsigned int g_uBinCount = 12;
+
+	// Build() stops splitting at g_uMaxDepth, so no traversal ever holds more than this many nodes.
+	const unsigned int g_uMaxDepth = 62;
+	const unsigned int g_uStackSize = g_uMaxDepth + 2;
+
+	struct Bin
+	{
+		XMFLOAT3 Min;
+		XMFLOAT3 Max;
+		unsigned int Count;
+	};
+
+	void ResetBounds(XMFLOAT3& a_v3Min, XMFLOAT3& a_v3Max)
+	{
+		a_v3Min = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+		a_v3Max = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	}
+
+	void GrowBounds(XMFLOAT3& a_v3Min, XMFLOAT3& a_v3Max, const XMFLOAT3& a_v3OtherMin, const XMFLOAT3& a_v3OtherMax)
+	{
+		a_v3Min.x = std::min(a_v3Min.x, a_v3OtherMin.x);
+		a_v3Min.y = std::min(a_v3Min.y, a_v3OtherMin.y);
+		a_v3Min.z = std::min(a_v3Min.z, a_v3OtherMin.z);
+		a_v3Max.x = std::max(a_v3Max.x, a_v3OtherMax.x);
+		a_v3Max.y = std::max(a_v3Max.y, a_v3OtherMax.y);
+		a_v3Max.z = std::max(a_v3Max.z, a_v3OtherMax.z);
+	}
+
+	// Half the surface area, the constant factor cancels out of every comparison.
+	float HalfArea(const XMFLOAT3& a_v3Min, const XMFLOAT3& a_v3Max)
+	{
+		float fX = a_v3Max.x - a_v3Min.x;
+		float fY = a_v3Max.y - a_v3Min.y;
+		float fZ = a_v3Max.z - a_v3Min.z;
+		if (fX < 0.0f || fY < 0.0f || fZ < 0.0f) return 0.0f;
+		return fX * fY + fY * fZ + fZ * fX;
+	}
+
+	float Component(const XMFLOAT3& a_v3, int a_nAxis)
+	{
+		return a_nAxis == 0 ? a_v3.x : (a_nAxis == 1 ? a_v3.y : a_v3.z);
+	}
+
+	bool BoxesOverlap(const XMFLOAT3& a_v3MinA, const XMFLOAT3& a_v3MaxA, const XMFLOAT3& a_v3MinB, const XMFLOAT3& a_v3MaxB)
+	{
+		return a_v3MinA.x <= a_v3MaxB.x && a_v3MaxA.x >= a_v3MinB.x
+			&& a_v3MinA.y <= a_v3MaxB.y && a_v3MaxA.y >= a_v3MinB.y
+			&& a_v3MinA.z <= a_v3MaxB.z && a_v3MaxA.z >= a_v3MinB.z;
+	}
+
+	bool BoxTouchesSphere(const XMFLOAT3& a_v3Min, const XMFLOAT3& a_v3Max, const XMFLOAT3& a_v3Center, float a_fRadiusSq)
+	{
+		// Squared distance from the center to the closest point of the box.
+		float fX = std::max(std::max(a_v3Min.x - a_v3Center.x, a_v3Center.x - a_v3Max.x), 0.0f);
+		float fY = std::max(std::max(a_v3Min.y - a_v3Center.y, a_v3Center.y - a_v3Max.y), 0.0f);
+		float fZ = std::max(std::max(a_v3Min.z - a_v3Center.z, a_v3Center.z - a_v3Max.z), 0.0f);
+		return fX * fX + fY * fY + fZ * fZ <= a_fRadiusSq;
+	}
+
+	enum class PlaneResult { Outside, Intersecting, Inside };
+
+	PlaneResult TestFrustum(const Frustum& a_fFrustum, const XMFLOAT3& a_v3Min, const XMFLOAT3& a_v3Max)
+	{
+		XMFLOAT3 v3Center((a_v3Min.x + a_v3Max.x) * 0.5f, (a_v3Min.y + a_v3Max.y) * 0.5f, (a_v3Min.z + a_v3Max.z) * 0.5f);
+		XMFLOAT3 v3Extents((a_v3Max.x - a_v3Min.x) * 0.5f, (a_v3Max.y - a_v3Min.y) * 0.5f, (a_v3Max.z - a_v3Min.z) * 0.5f);
+
+		PlaneResult result = PlaneResult::Inside;
+		for (int p = 0; p < 6; p++)
+		{
+			const XMFLOAT4& v4Plane = a_fFrustum.Planes[p];
+			float fDistance = v4Plane.x * v3Center.x + v4Plane.y * v3Center.y + v4Plane.z * v3Center.z + v4Plane.w;
+			float fReach = fabsf(v4Plane.x) * v3Extents.x + fabsf(v4Plane.y) * v3Extents.y + fabsf(v4Plane.z) * v3Extents.z;
+			if (fDistance + fReach < 0.0f) return PlaneResult::Outside;
+			if (fDistance - fReach < 0.0f) result = PlaneResult::Intersecting;
+		}
+		return result;
+	}
+
+	// Slab test, gives the distance the ray enters the box at or FLT_MAX for a miss.
+	float IntersectRay(const XMFLOAT3& a_v3Min, const XMFLOAT3& a_v3Max, const XMFLOAT3& a_v3Origin, const XMFLOAT3& a_v3InverseDirection, float a_fMaxDistance)
+	{
+		float fX1 = (a_v3Min.x - a_v3Origin.x) * a_v3InverseDirection.x;
+		float fX2 = (a_v3Max.x - a_v3Origin.x) * a_v3InverseDirection.x;
+		float fNear = std::min(fX1, fX2), fFar = std::max(fX1, fX2);
+		float fY1 = (a_v3Min.y - a_v3Origin.y) * a_v3InverseDirection.y;
+		float fY2 = (a_v3Max.y - a_v3Origin.y) * a_v3InverseDirection.y;
+		fNear = std::max(fNear, std::min(fY1, fY2)), fFar = std::min(fFar, std::max(fY1, fY2));
+		float fZ1 = (a_v3Min.z - a_v3Origin.z) * a_v3InverseDirection.z;
+		float fZ2 = (a_v3Max.z - a_v3Origin.z) * a_v3InverseDirection.z;
+		fNear = std::max(fNear, std::min(fZ1, fZ2)), fFar = std::min(fFar, std::max(fZ1, fZ2));
+
+		fNear = std::max(fNear, 0.0f);
+		if (fFar >= fNear && fNear < a_fMaxDistance) return fNear;
+		return FLT_MAX;
+	}
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy()
+{
+	m_fBuildCost = 0.0f;
+	m_fCost = 0.0f;
+	m_uBuildCount = 0;
+}
+
+void BoundingVolumeHierarchy::Build(const CullBox* a_pBoxes, unsigned int a_uCount)
+{
+	SetItemBoxes(a_pBoxes, a_uCount);
+	m_lNodes.clear();
+	m_lItems.resize(a_uCount);
+	m_uBuildCount++;
+	if (a_uCount == 0)
+	{
+		m_fBuildCost = m_fCost = 0.0f;
+		return;
+	}
+
+	std::vector<XMFLOAT3> lCentroids(a_uCount);
+	for (unsigned int i = 0; i < a_uCount; i++)
+	{
+		m_lItems[i] = i;
+		lCentroids[i] = a_pBoxes[i].Center;
+	}
+
+	// A binary tree with one item per leaf has 2n - 1 nodes, reserving up front keeps references valid while splitting.
+	m_lNodes.reserve(2 * a_uCount);
+	BVHNode root;
+	root.LeftFirst = 0;
+	root.Count = a_uCount;
+	FitLeaf(root);
+	m_lNodes.push_back(root);
+
+	// Children are always added after their parent, so Refit() can walk the array backwards.
+	unsigned int pStack[g_uStackSize], pDepth[g_uStackSize];
+	unsigned int uStackSize = 0;
+	pStack[uStackSize] = 0;
+	pDepth[uStackSize++] = 0;
+	while (uStackSize > 0)
+	{
+		uStackSize--;
+		unsigned int uNode = pStack[uStackSize];
+		unsigned int uDepth = pDepth[uStackSize];
+		if (uDepth < g_uMaxDepth && Split(uNode, lCentroids))
+		{
+			pStack[uStackSize] = m_lNodes[uNode].LeftFirst;
+			pDepth[uStackSize++] = uDepth + 1;
+			pStack[uStackSize] = m_lNodes[uNode].LeftFirst + 1;
+			pDepth[uStackSize++] = uDepth + 1;
+		}
+	}
+
+	m_fBuildCost = m_fCost = CalculateCost();
+}
+
+void BoundingVolumeHierarchy::Refit(const CullBox* a_pBoxes)
+{
+	SetItemBoxes(a_pBoxes, static_cast<unsigned int>(m_lItemMin.size()));
+
+	for (size_t i = m_lNodes.size(); i-- > 0;)
+	{
+		BVHNode& node = m_lNodes[i];
+		if (node.Count > 0)
+		{
+			FitLeaf(node);
+			continue;
+		}
+
+		const BVHNode& left = m_lNodes[node.LeftFirst];
+		const BVHNode& right = m_lNodes[node.LeftFirst + 1];
+		node.Min = left.Min;
+		node.Max = left.Max;
+		GrowBounds(node.Min, node.Max, right.Min, right.Max);
+	}
+
+	m_fCost = CalculateCost();
+}
+
+void BoundingVolumeHierarchy::Update(const CullBox* a_pBoxes, unsigned int a_uCount)
+{
+	if (a_uCount != m_lItemMin.size() || m_lNodes.empty())
+	{
+		Build(a_pBoxes, a_uCount);
+		return;
+	}
+
+	Refit(a_pBoxes);
+	if (m_fCost > m_fBuildCost * REBUILD_COST_RATIO)
+	{
+		Build(a_pBoxes, a_uCount);
+	}
+}
+
+unsigned int BoundingVolumeHierarchy::QueryFrustum(const Frustum& a_fFrustum, unsigned char* a_pVisible) const
+{
+	std::fill(a_pVisible, a_pVisible + m_lItemMin.size(), static_cast<unsigned char>(0));
+	if (m_lNodes.empty()) return 0;
+
+	unsigned int uVisible = 0;
+	unsigned int pStack[g_uStackSize];
+	unsigned int uStackSize = 0;
+	pStack[uStackSize++] = 0;
+	while (uStackSize > 0)
+	{
+		const BVHNode& node = m_lNodes[pStack[--uStackSize]];
+		PlaneResult result = TestFrustum(a_fFrustum, node.Min, node.Max);
+		if (result == PlaneResult::Outside) continue;
+
+		if (result == PlaneResult::Inside)
+		{
+			// Every item below sits inside the node's box, so none of them need testing.
+			// The items of a subtree are contiguous, from its leftmost leaf to its rightmost one.
+			const BVHNode* pFirst = &node;
+			const BVHNode* pLast = &node;
+			while (pFirst->Count == 0) pFirst = &m_lNodes[pFirst->LeftFirst];
+			while (pLast->Count == 0) pLast = &m_lNodes[pLast->LeftFirst + 1];
+			for (unsigned int i = pFirst->LeftFirst; i < pLast->LeftFirst + pLast->Count; i++)
+			{
+				a_pVisible[m_lItems[i]] = 1;
+			}
+			uVisible += pLast->LeftFirst + pLast->Count - pFirst->LeftFirst;
+			continue;
+		}
+
+		if (node.Count > 0)
+		{
+			for (unsigned int i = node.LeftFirst; i < node.LeftFirst + node.Count; i++)
+			{
+				unsigned int uItem = m_lItems[i];
+				if (TestFrustum(a_fFrustum, m_lItemMin[uItem], m_lItemMax[uItem]) != PlaneResult::Outside)
+				{
+					a_pVisible[uItem] = 1;
+					uVisible++;
+				}
+			}
+			continue;
+		}
+
+		pStack[uStackSize++] = node.LeftFirst;
+		pStack[uStackSize++] = node.LeftFirst + 1;
+	}
+
+	return uVisible;
+}
+
+bool BoundingVolumeHierarchy::RayCast(XMFLOAT3 a_v3Origin, XMFLOAT3 a_v3Direction, unsigned int& a_uHit, float& a_fDistance) const
+{
+	if (m_lNodes.empty()) return false;
+
+	// Zero components become infinities, which the slab test handles.
+	XMFLOAT3 v3InverseDirection(1.0f / a_v3Direction.x, 1.0f / a_v3Direction.y, 1.0f / a_v3Direction.z);
+	float fNearest = FLT_MAX;
+	bool bHit = false;
+
+	unsigned int pStack[g_uStackSize];
+	unsigned int uStackSize = 0;
+	if (IntersectRay(m_lNodes[0].Min, m_lNodes[0].Max, a_v3Origin, v3InverseDirection, fNearest) != FLT_MAX)
+	{
+		pStack[uStackSize++] = 0;
+	}
+
+	while (uStackSize > 0)
+	{
+		const BVHNode& node = m_lNodes[pStack[--uStackSize]];
+		if (node.Count > 0)
+		{
+			for (unsigned int i = node.LeftFirst; i < node.LeftFirst + node.Count; i++)
+			{
+				unsigned int uItem = m_lItems[i];
+				float fDistance = IntersectRay(m_lItemMin[uItem], m_lItemMax[uItem], a_v3Origin, v3InverseDirection, fNearest);
+				if (fDistance < fNearest)
+				{
+					fNearest = fDistance;
+					a_uHit = uItem;
+					bHit = true;
+				}
+			}
+			continue;
+		}
+
+		// Visiting the nearer child first so the farther one can be skipped once something closer is hit.
+		unsigned int uNear = node.LeftFirst;
+		unsigned int uFar = node.LeftFirst + 1;
+		float fNear = IntersectRay(m_lNodes[uNear].Min, m_lNodes[uNear].Max, a_v3Origin, v3InverseDirection, fNearest);
+		float fFar = IntersectRay(m_lNodes[uFar].Min, m_lNodes[uFar].Max, a_v3Origin, v3InverseDirection, fNearest);
+		if (fFar < fNear)
+		{
+			std::swap(uNear, uFar);
+			std::swap(fNear, fFar);
+		}
+		if (fFar != FLT_MAX) pStack[uStackSize++] = uFar;
+		if (fNear != FLT_MAX) pStack[uStackSize++] = uNear;
+	}
+
+	if (bHit) a_fDistance = fNearest;
+	return bHit;
+}
+
+void BoundingVolumeHierarchy::QuerySphere(XMFLOAT3 a_v3Center, float a_fRadius, std::vector<unsigned int>& a_lResults) const
+{
+	a_lResults.clear();
+	if (m_lNodes.empty()) return;
+
+	float fRadiusSq = a_fRadius * a_fRadius;
+	unsigned int pStack[g_uStackSize];
+	unsigned int uStackSize = 0;
+	pStack[uStackSize++] = 0;
+	while (uStackSize > 0)
+	{
+		const BVHNode& node = m_lNodes[pStack[--uStackSize]];
+		if (!BoxTouchesSphere(node.Min, node.Max, a_v3Center, fRadiusSq)) continue;
+
+		if (node.Count > 0)
+		{
+			for (unsigned int i = node.LeftFirst; i < node.LeftFirst + node.Count; i++)
+			{
+				unsigned int uItem = m_lItems[i];
+				if (BoxTouchesSphere(m_lItemMin[uItem], m_lItemMax[uItem], a_v3Center, fRadiusSq)) a_lResults.push_back(uItem);
+			}
+			continue;
+		}
+
+		pStack[uStackSize++] = node.LeftFirst;
+		pStack[uStackSize++] = node.LeftFirst + 1;
+	}
+}
+
+void BoundingVolumeHierarchy::QueryBox(const CullBox& a_cbBox, std::vector<unsigned int>& a_lResults) const
+{
+	a_lResults.clear();
+	if (m_lNodes.empty()) return;
+
+	XMFLOAT3 v3Min(a_cbBox.Center.x - a_cbBox.Extents.x, a_cbBox.Center.y - a_cbBox.Extents.y, a_cbBox.Center.z - a_cbBox.Extents.z);
+	XMFLOAT3 v3Max(a_cbBox.Center.x + a_cbBox.Extents.x, a_cbBox.Center.y + a_cbBox.Extents.y, a_cbBox.Center.z + a_cbBox.Extents.z);
+	unsigned int pStack[g_uStackSize];
+	unsigned int uStackSize = 0;
+	pStack[uStackSize++] = 0;
+	while (uStackSize > 0)
+	{
+		const BVHNode& node = m_lNodes[pStack[--uStackSize]];
+		if (!BoxesOverlap(node.Min, node.Max, v3Min, v3Max)) continue;
+
+		if (node.Count > 0)
+		{
+			for (unsigned int i = node.LeftFirst; i < node.LeftFirst + node.Count; i++)
+			{
+				unsigned int uItem = m_lItems[i];
+				if (BoxesOverlap(m_lItemMin[uItem], m_lItemMax[uItem], v3Min, v3Max)) a_lResults.push_back(uItem);
+			}
+			continue;
+		}
+
+		pStack[uStackSize++] = node.LeftFirst;
+		pStack[uStackSize++] = node.LeftFirst + 1;
+	}
+}
+
+unsigned int BoundingVolumeHierarchy::GetItemCount(void) const
+{
+	return static_cast<unsigned int>(m_lItemMin.size());
+}
+
+unsigned int BoundingVolumeHierarchy::GetNodeCount(void) const
+{
+	return static_cast<unsigned int>(m_lNodes.size());
+}
+
+unsigned int BoundingVolumeHierarchy::GetBuildCount(void) const
+{
+	return m_uBuildCount;
+}
+
+void BoundingVolumeHierarchy::SetItemBoxes(const CullBox* a_pBoxes, unsigned int a_uCount)
+{
+	m_lItemMin.resize(a_uCount);
+	m_lItemMax.resize(a_uCount);
+	for (unsigned int i = 0; i < a_uCount; i++)
+	{
+		const CullBox& box = a_pBoxes[i];
+		m_lItemMin[i] = XMFLOAT3(box.Center.x - box.Extents.x, box.Center.y - box.Extents.y, box.Center.z - box.Extents.z);
+		m_lItemMax[i] = XMFLOAT3(box.Center.x + box.Extents.x, box.Center.y + box.Extents.y, box.Center.z + box.Extents.z);
+	}
+}
+
+void BoundingVolumeHierarchy::FitLeaf(BVHNode& a_nNode) const
+{
+	ResetBounds(a_nNode.Min, a_nNode.Max);
+	for (unsigned int i = a_nNode.LeftFirst; i < a_nNode.LeftFirst + a_nNode.Count; i++)
+	{
+		unsigned int uItem = m_lItems[i];
+		GrowBounds(a_nNode.Min, a_nNode.Max, m_lItemMin[uItem], m_lItemMax[uItem]);
+	}
+}
+
+float BoundingVolumeHierarchy::CalculateCost(void) const
+{
+	// Expected work for a random query: every interior node costs one box test
+	// and every leaf one per item, weighted by the chance of reaching it.
+	float fCost = 0.0f;
+	for (const BVHNode& node : m_lNodes)
+	{
+		fCost += HalfArea(node.Min, node.Max) * (node.Count > 0 ? static_cast<float>(node.Count) : 1.0f);
+	}
+
+	float fRootArea = HalfArea(m_lNodes[0].Min, m_lNodes[0].Max);
+	return fRootArea > 0.0f ? fCost / fRootArea : fCost;
+}
+
+bool BoundingVolumeHierarchy::Split(unsigned int a_uNode, const std::vector<XMFLOAT3>& a_lCentroids)
+{
+	BVHNode& node = m_lNodes[a_uNode];
+	if (node.Count <= 1) return false;
+
+	XMFLOAT3 v3CentroidMin, v3CentroidMax;
+	ResetBounds(v3CentroidMin, v3CentroidMax);
+	for (unsigned int i = node.LeftFirst; i < node.LeftFirst + node.Count; i++)
+	{
+		GrowBounds(v3CentroidMin, v3CentroidMax, a_lCentroids[m_lItems[i]], a_lCentroids[m_lItems[i]]);
+	}
+
+	// Binned SAH: sort the centroids into slots along each axis and try a split between every pair.
+	float fBestCost = FLT_MAX;
+	int nBestAxis = -1;
+	unsigned int uBestSplit = 0;
+	for (int nAxis = 0; nAxis < 3; nAxis++)
+	{
+		float fAxisMin = Component(v3CentroidMin, nAxis);
+		float fAxisMax = Component(v3CentroidMax, nAxis);
+		if (fAxisMax <= fAxisMin) continue;
+
+		Bin pBins[g_uBinCount];
+		for (unsigned int b = 0; b < g_uBinCount; b++)
+		{
+			ResetBounds(pBins[b].Min, pBins[b].Max);
+			pBins[b].Count = 0;
+		}
+
+		float fScale = g_uBinCount / (fAxisMax - fAxisMin);
+		for (unsigned int i = node.LeftFirst; i < node.LeftFirst + node.Count; i++)
+		{
+			unsigned int uItem = m_lItems[i];
+			unsigned int uBin = std::min(g_uBinCount - 1, static_cast<unsigned int>((Component(a_lCentroids[uItem], nAxis) - fAxisMin) * fScale));
+			GrowBounds(pBins[uBin].Min, pBins[uBin].Max, m_lItemMin[uItem], m_lItemMax[uItem]);
+			pBins[uBin].Count++;
+		}
+
+		// Sweeping from both ends gives the area and count on each side of every split.
+		float pLeftArea[g_uBinCount - 1], pRightArea[g_uBinCount - 1];
+		unsigned int pLeftCount[g_uBinCount - 1], pRightCount[g_uBinCount - 1];
+		XMFLOAT3 v3LeftMin, v3LeftMax, v3RightMin, v3RightMax;
+		ResetBounds(v3LeftMin, v3LeftMax);
+		ResetBounds(v3RightMin, v3RightMax);
+		unsigned int uLeftSum = 0, uRightSum = 0;
+		for (unsigned int b = 0; b < g_uBinCount - 1; b++)
+		{
+			uLeftSum += pBins[b].Count;
+			GrowBounds(v3LeftMin, v3LeftMax, pBins[b].Min, pBins[b].Max);
+			pLeftCount[b] = uLeftSum;
+			pLeftArea[b] = HalfArea(v3LeftMin, v3LeftMax);
+
+			unsigned int r = g_uBinCount - 1 - b;
+			uRightSum += pBins[r].Count;
+			GrowBounds(v3RightMin, v3RightMax, pBins[r].Min, pBins[r].Max);
+			pRightCount[r - 1] = uRightSum;
+			pRightArea[r - 1] = HalfArea(v3RightMin, v3RightMax);
+		}
+
+		for (unsigned int b = 0; b < g_uBinCount - 1; b++)
+		{
+			if (pLeftCount[b] == 0 || pRightCount[b] == 0) continue;
+			float fCost = pLeftArea[b] * pLeftCount[b] + pRightArea[b] * pRightCount[b];
+			if (fCost < fBestCost)
+			{
+				fBestCost = fCost;
+				nBestAxis = nAxis;
+				uBestSplit = b;
+			}
+		}
+	}
+
+	// Every centroid in the same spot, there is nothing to split on.
+	if (nBestAxis < 0) return false;
+
+	// Small leaves stay whole when splitting would not pay for the extra box test.
+	float fLeafCost = HalfArea(node.Min, node.Max) * node.Count;
+	if (node.Count <= MAX_LEAF_SIZE && fBestCost + HalfArea(node.Min, node.Max) >= fLeafCost) return false;
+
+	float fAxisMin = Component(v3CentroidMin, nBestAxis);
+	float fScale = g_uBinCount / (Component(v3CentroidMax, nBestAxis) - fAxisMin);
+	unsigned int* pBegin = m_lItems.data() + node.LeftFirst;
+	unsigned int* pMiddle = std::partition(pBegin, pBegin + node.Count, [&](unsigned int a_uItem)
+	{
+		unsigned int uBin = std::min(g_uBinCount - 1, static_cast<unsigned int>((Component(a_lCentroids[a_uItem], nBestAxis) - fAxisMin) * fScale));
+		return uBin <= uBestSplit;
+	});
+	unsigned int uLeftCount = static_cast<unsigned int>(pMiddle - pBegin);
+
+	BVHNode left, right;
+	left.LeftFirst = node.LeftFirst;
+	left.Count = uLeftCount;
+	right.LeftFirst = node.LeftFirst + uLeftCount;
+	right.Count = node.Count - uLeftCount;
+	FitLeaf(left);
+	FitLeaf(right);
+
+	node.LeftFirst = static_cast<unsigned int>(m_lNodes.size());
+	node.Count = 0;
+	m_lNodes.push_back(left);
+	m_lNodes.push_back(right);
+	return true;
+}
@@ -0,0 +1,128 @@
+#ifndef __BOUNDINGVOLUMEHIERARCHY_H_
+#define __BOUNDINGVOLUMEHIERARCHY_H_
+
+#include <DirectXMath.h>
+#include <vector>
+#include "FrustumCuller.h"
+
+/// <summary>
+/// Node of a BoundingVolumeHierarchy.  Interior nodes have a Count of 0 and
+/// their children at LeftFirst and LeftFirst + 1, leaves hold Count items
+/// starting at LeftFirst.  32 bytes, two to a cache line.
+/// </summary>
+struct BVHNode
+{
+	DirectX::XMFLOAT3 Min;
+	unsigned int LeftFirst;
+	DirectX::XMFLOAT3 Max;
+	unsigned int Count;
+};
+
+/// <summary>
+/// Bounding volume hierarchy over world space boxes, built with the surface
+/// area heuristic.  Moving items only refits the existing tree, and the tree
+/// is rebuilt once refitting has made it noticeably worse than a fresh build.
+/// Items are referred to by their index in the box array passed to Update().
+/// </summary>
+class BoundingVolumeHierarchy
+{
+private:
+	std::vector<BVHNode> m_lNodes;
+	std::vector<unsigned int> m_lItems;				// Item indices, grouped by leaf.
+	std::vector<DirectX::XMFLOAT3> m_lItemMin;
+	std::vector<DirectX::XMFLOAT3> m_lItemMax;
+	float m_fBuildCost;								// SAH cost right after the last build.
+	float m_fCost;									// SAH cost after the last refit.
+	unsigned int m_uBuildCount;
+
+public:
+	// Refitting stops once the tree costs this much more than it did when built.
+	static constexpr float REBUILD_COST_RATIO = 1.5f;
+	// Leaves only grow past this when their items cannot be told apart.
+	static const unsigned int MAX_LEAF_SIZE = 4;
+
+	BoundingVolumeHierarchy();
+
+	/// <summary>
+	/// Builds the tree from scratch with the surface area heuristic.
+	/// </summary>
+	/// <param name="a_pBoxes">The item boxes.</param>
+	/// <param name="a_uCount">The amount of items.</param>
+	void Build(const CullBox* a_pBoxes, unsigned int a_uCount);
+
+	/// <summary>
+	/// Refits the tree to boxes that have moved, keeping its structure.
+	/// </summary>
+	/// <param name="a_pBoxes">The item boxes, in the same order and amount as the last build.</param>
+	void Refit(const CullBox* a_pBoxes);
+
+	/// <summary>
+	/// Refits to the new boxes, or rebuilds if items were added or removed or
+	/// refitting has let the tree degrade past REBUILD_COST_RATIO.
+	/// </summary>
+	/// <param name="a_pBoxes">The item boxes.</param>
+	/// <param name="a_uCount">The amount of items.</param>
+	void Update(const CullBox* a_pBoxes, unsigned int a_uCount);
+
+	/// <summary>
+	/// Finds every item whose box touches a frustum.  Subtrees entirely inside
+	/// are accepted without testing their items.
+	/// </summary>
+	/// <param name="a_fFrustum">The view volume.</param>
+	/// <param name="a_pVisible">Receives one flag per item, 1 if it touches the frustum.</param>
+	/// <returns>The amount of visible items.</returns>
+	unsigned int QueryFrustum(const Frustum& a_fFrustum, unsigned char* a_pVisible) const;
+
+	/// <summary>
+	/// Finds the nearest item box a ray enters.
+	/// </summary>
+	/// <param name="a_v3Origin">Start of the ray.</param>
+	/// <param name="a_v3Direction">Direction of the ray, does not need to be normalized.</param>
+	/// <param name="a_uHit">Receives the index of the item hit.</param>
+	/// <param name="a_fDistance">Receives how far along the ray, in multiples of the direction, the box is entered.  0 if the ray starts inside.</param>
+	/// <returns>True if anything was hit.</returns>
+	bool RayCast(DirectX::XMFLOAT3 a_v3Origin, DirectX::XMFLOAT3 a_v3Direction, unsigned int& a_uHit, float& a_fDistance) const;
+
+	/// <summary>
+	/// Finds every item whose box overlaps a sphere.
+	/// </summary>
+	/// <param name="a_v3Center">Center of the sphere.</param>
+	/// <param name="a_fRadius">Radius of the sphere.</param>
+	/// <param name="a_lResults">Receives the indices of the overlapping items.</param>
+	void QuerySphere(DirectX::XMFLOAT3 a_v3Center, float a_fRadius, std::vector<unsigned int>& a_lResults) const;
+
+	/// <summary>
+	/// Finds every item whose box overlaps another box.
+	/// </summary>
+	/// <param name="a_cbBox">The box to test against.</param>
+	/// <param name="a_lResults">Receives the indices of the overlapping items.</param>
+	void QueryBox(const CullBox& a_cbBox, std::vector<unsigned int>& a_lResults) const;
+
+	/// <summary>
+	/// Gets the amount of items in the tree.
+	/// </summary>
+	unsigned int GetItemCount(void) const;
+
+	/// <summary>
+	/// Gets the amount of nodes in the tree.
+	/// </summary>
+	unsigned int GetNodeCount(void) const;
+
+	/// <summary>
+	/// Gets how many times the tree has been built from scratch.
+	/// </summary>
+	unsigned int GetBuildCount(void) const;
+
+private:
+	void SetItemBoxes(const CullBox* a_pBoxes, unsigned int a_uCount);
+	void FitLeaf(BVHNode& a_nNode) const;
+	float CalculateCost(void) const;
+
+	/// <summary>
+	/// Splits a leaf in two where the surface area heuristic says it is cheapest.
+	/// </summary>
+	/// <returns>False if keeping the leaf is cheaper than any split.</returns>
+	bool Split(unsigned int a_uNode, const std::vector<DirectX::XMFLOAT3>& a_lCentroids);
+};
+
+#endif //__BOUNDINGVOLUMEHIERARCHY_H_
@@ -27,11 +27,33 @@ DirectX::XMFLOAT4X4 Camera::GetProjection()
 	return m_m4Projection;
 }
 
-Transform Camera::GetTransform()
+const Transform& Camera::GetTransform() const
 {
 	return m_tTransform;
 }
 
+Frustum Camera::GetFrustum()
+{
+	XMFLOAT4X4 m4ViewProjection;
+	XMStoreFloat4x4(&m4ViewProjection, XMMatrixMultiply(XMLoadFloat4x4(&m_m4View), XMLoadFloat4x4(&m_m4Projection)));
+	return FrustumCuller::ExtractFrustum(m4ViewProjection);
+}
+
+void Camera::GetPickRay(int a_nX, int a_nY, int a_nWidth, int a_nHeight, DirectX::XMFLOAT3& a_v3Origin, DirectX::XMFLOAT3& a_v3Direction)
+{
+	// Pixel to normalized device coordinates, y points up in clip space.
+	float fX = (2.0f * (a_nX + 0.5f)) / a_nWidth - 1.0f;
+	float fY = 1.0f - (2.0f * (a_nY + 0.5f)) / a_nHeight;
+
+	// Unprojecting the point on the near and far planes back into the world.
+	XMMATRIX inverseViewProjection = XMMatrixInverse(nullptr, XMMatrixMultiply(XMLoadFloat4x4(&m_m4View), XMLoadFloat4x4(&m_m4Projection)));
+	XMVECTOR vNear = XMVector3TransformCoord(XMVectorSet(fX, fY, 0.0f, 1.0f), inverseViewProjection);
+	XMVECTOR vFar = XMVector3TransformCoord(XMVectorSet(fX, fY, 1.0f, 1.0f), inverseViewProjection);
+
+	XMStoreFloat3(&a_v3Origin, vNear);
+	XMStoreFloat3(&a_v3Direction, XMVector3Normalize(XMVectorSubtract(vFar, vNear)));
+}
+
 void Camera::UpdateProjection(float a_fAspectRatio)
 {
 	// Creating the Projection matrix.
@@ -2,6 +2,7 @@
 #define __CAMERA_H_
 
 #include "Transform.h"
+#include "FrustumCuller.h"
 
 class Camera
 {
@@ -16,7 +17,23 @@ public:
 
 	DirectX::XMFLOAT4X4 GetView();
 	DirectX::XMFLOAT4X4 GetProjection();
-	Transform GetTransform();
+	const Transform& GetTransform() const;
+
+	/// <summary>
+	/// Gets the world space planes of what the camera currently sees.
+	/// </summary>
+	Frustum GetFrustum();
+
+	/// <summary>
+	/// Gets the world space ray under a point on the screen, for picking.
+	/// </summary>
+	/// <param name="a_nX">Pixel x, from the left of the window.</param>
+	/// <param name="a_nY">Pixel y, from the top of the window.</param>
+	/// <param name="a_nWidth">Width of the window in pixels.</param>
+	/// <param name="a_nHeight">Height of the window in pixels.</param>
+	/// <param name="a_v3Origin">Receives the ray's start, on the near plane.</param>
+	/// <param name="a_v3Direction">Receives the ray's normalized direction.</param>
+	void GetPickRay(int a_nX, int a_nY, int a_nWidth, int a_nHeight, DirectX::XMFLOAT3& a_v3Origin, DirectX::XMFLOAT3& a_v3Direction);
 
 	void UpdateProjection(float a_fAspectRatio);
 	void UpdateView();
@@ -0,0 +1,14 @@
+#include "ShaderFunctions.hlsli"
+
+cbuffer externalData : register(b0)
+{
+    matrix worldViewProjection;	// Through the light's view and projection.
+    float3 boundsMin;
+    float3 boundsExtent;
+};
+
+// Simplified vertex shader for rendering shadows of compressed meshes.
+float4 main(CompressedVertexShaderInput input) : SV_POSITION
+{
+    return mul(worldViewProjection, float4(DecodePosition(input.localPosition, boundsMin, boundsExtent), 1.0f));
+}
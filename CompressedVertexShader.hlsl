@@ -0,0 +1,35 @@
+#include "ShaderFunctions.hlsli"
+
+cbuffer PerObject : register(b0)
+{
+	// - -
+    matrix world;	
+	// - -
+    matrix worldInvTranspose;
+	// - -
+    matrix worldViewProjection;
+	// - -
+    matrix worldLightViewProjection;
+	// - -
+    float3 boundsMin;
+	// - -
+    float3 boundsExtent;
+}
+
+// Same as VertexShader.hlsl, but reads a CompressedVertex.
+VertexToPixel main( CompressedVertexShaderInput input )
+{
+	// Set up output struct
+	VertexToPixel output;
+    
+	// The matrix products are done once per object on the CPU.
+    float3 localPosition = DecodePosition(input.localPosition, boundsMin, boundsExtent);
+	output.screenPosition = mul(worldViewProjection, float4(localPosition, 1.0f));
+    output.normal = normalize(mul((float3x3) worldInvTranspose, DecodeOctahedral(input.normal)));
+    output.uv = input.uv;
+    output.worldPos = mul(world, float4(localPosition, 1.0f)).xyz;
+    output.tangent = float4(normalize(mul((float3x3) world, DecodeOctahedral(input.tangent))), input.localPosition.w * 2.0f - 1.0f);
+    output.shadowMapPos = mul(worldLightViewProjection, float4(localPosition, 1.0f));
+	
+	return output;
+}
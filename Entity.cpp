@@ -2,15 +2,15 @@
 #include "Graphics.h"
 #include "Window.h"
 
-Entity::Entity(std::shared_ptr<Mesh> a_pMesh, std::shared_ptr<Material> a_pMaterial)
+Entity::Entity(std::shared_ptr<Mesh> a_pMesh, std::shared_ptr<Material> a_pMaterial, TransformSystem& a_tsTransforms)
 {
 	m_pMesh = a_pMesh;
 	m_pMaterial = a_pMaterial;
-	m_tTransform = Transform();
+	m_thTransform = TransformHandle(&a_tsTransforms, a_tsTransforms.Create());
 }
 
 // Getters
-Transform& Entity::GetTransform() { return m_tTransform; }
+TransformHandle Entity::GetTransform() { return m_thTransform; }
 std::shared_ptr<Mesh> Entity::GetMesh() { return m_pMesh; }
 std::shared_ptr<Material> Entity::GetMaterial() { return m_pMaterial; }
 
@@ -21,32 +21,48 @@ void Entity::SetMaterial(std::shared_ptr<Material> a_pMaterial)
 	m_pMaterial = std::make_shared<Material>(*a_pMaterial);
 }
 
-void Entity::Draw(std::shared_ptr<Camera> a_pCamera, float a_fTotalTime)
+void Entity::Draw(unsigned int a_uLod, const IndexRange* a_pRanges, unsigned int a_uRangeCount, bool a_bBindMaterial)
 {
-	m_pMaterial->GetVertexShader()->SetShader();
-	m_pMaterial->GetPixelShader()->SetShader();
-	m_pMaterial->PrepMaterialForDraw();
+	// The previous draw may have left this material's shaders and textures bound already.
+	if (a_bBindMaterial)
+	{
+		m_pMaterial->GetVertexShader()->SetShader();
+		m_pMaterial->GetPixelShader()->SetShader();
+		m_pMaterial->PrepMaterialForDraw();
+	}
 
-	// Vertex shader data setting.
-	std::shared_ptr<SimpleVertexShader> vs = m_pMaterial->GetVertexShader();
-	vs->SetMatrix4x4("world", m_tTransform.GetWorldMatrix());	// The world matrix of the entity.
-	vs->SetMatrix4x4("worldInvTranspose", m_tTransform.GetWorldInverseTransposeMatrix());	
-	vs->SetMatrix4x4("view", a_pCamera->GetView());				// The view matrix of the entity.
-	vs->SetMatrix4x4("projection", a_pCamera->GetProjection());	// The projection matrix of the entity.
+	// Vertex shader data setting, through handles the material found once.
+	SimpleVertexShader* vs = m_pMaterial->GetVertexShader().get();
+	const MaterialShaderHandles& handles = m_pMaterial->GetHandles();
+	vs->SetMatrix4x4(handles.World, m_thTransform.GetWorldMatrix());	// The world matrix of the entity.
+	vs->SetMatrix4x4(handles.WorldInvTranspose, m_thTransform.GetWorldInverseTransposeMatrix());	
+	vs->SetMatrix4x4(handles.WorldViewProjection, m_thTransform.GetWorldViewProjectionMatrix());				// Precomputed for the camera this frame.
+	vs->SetMatrix4x4(handles.WorldLightViewProjection, m_thTransform.GetWorldLightViewProjectionMatrix());	// Precomputed for the shadow map.
+	if (m_pMesh->IsCompressed())
+	{
+		// Compressed positions are stored relative to the mesh's bounds.
+		DirectX::XMFLOAT3 v3Min = m_pMesh->GetBoundsMin();
+		DirectX::XMFLOAT3 v3Max = m_pMesh->GetBoundsMax();
+		vs->SetFloat3(handles.BoundsMin, v3Min);
+		vs->SetFloat3(handles.BoundsExtent, DirectX::XMFLOAT3(v3Max.x - v3Min.x, v3Max.y - v3Min.y, v3Max.z - v3Min.z));
+	}
 	vs->CopyAllBufferData();
 
-	// Pixel shader data setting.
-	std::shared_ptr<SimplePixelShader>ps = m_pMaterial->GetPixelShader();
-	ps->SetFloat4("colorTint", m_pMaterial->GetColor());		// The color tint of the entity.
-	ps->SetFloat("totalTime", a_fTotalTime);					// The total time that has elapsed in the program.
-	ps->SetFloat3("cameraPosition", a_pCamera.get()->GetTransform().GetPosition());
-	ps->SetFloat("roughness", m_pMaterial->GetRoughness());
+	// Only the material's own buffer is left, which changes when the material does.
+	m_pMaterial->GetPixelShader()->CopyAllBufferData();
+
+	// Rendering the meshlets that survived culling, or else the requested level of detail.
+	if (a_pRanges != nullptr) m_pMesh->Draw(a_pRanges, a_uRangeCount);
+	else m_pMesh->Draw(a_uLod);
+}
 
-	// TODO: make the scale and offset both fields of the Material.
-	ps->SetFloat2("scale", m_pMaterial->GetScale());		// The scale of the texture in the shader. 
-	ps->SetFloat2("offset", m_pMaterial->GetOffset());		// The offset of the texture in the shader.
-	ps->CopyAllBufferData();
+void Entity::DrawInstanced(std::shared_ptr<SimpleVertexShader> a_pInstancedShader, unsigned int a_uLod, unsigned int a_uInstanceCount, unsigned int a_uFirstInstance)
+{
+	// The matrices come from the instance buffer instead of the material's vertex shader.
+	a_pInstancedShader->SetShader();
+	m_pMaterial->GetPixelShader()->SetShader();
+	m_pMaterial->PrepMaterialForDraw();
+	m_pMaterial->GetPixelShader()->CopyAllBufferData();
 
-	// Rendering the mesh to the window.
-	m_pMesh->Draw();
+	m_pMesh->DrawInstanced(a_uLod, a_uInstanceCount, a_uFirstInstance);
 }
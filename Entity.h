@@ -5,24 +5,43 @@
 #include "Mesh.h"
 #include "Material.h"
 #include "Camera.h"
+#include "TransformSystem.h"
 
 class Entity 
 {
 private:
 	std::shared_ptr<Mesh> m_pMesh;
 	std::shared_ptr<Material> m_pMaterial;
-	Transform m_tTransform;
+	TransformHandle m_thTransform;
 
 public:
-	Entity(std::shared_ptr<Mesh> a_pMesh, std::shared_ptr<Material> a_pMaterial);
+	Entity(std::shared_ptr<Mesh> a_pMesh, std::shared_ptr<Material> a_pMaterial, TransformSystem& a_tsTransforms);
 
-	Transform& GetTransform();
+	TransformHandle GetTransform();
 	std::shared_ptr<Mesh> GetMesh();
 	std::shared_ptr<Material> GetMaterial();
 
 	void SetMaterial(std::shared_ptr<Material> a_pMaterial);
 
-	void Draw(std::shared_ptr<Camera> a_pCamera, float a_fTotalTime);
+	/// <summary>
+	/// Draws this entity's mesh with its material.  The scene's constants
+	/// and shadow map must already be bound.
+	/// </summary>
+	/// <param name="a_uLod">The level of detail to draw, ignored when ranges are given.</param>
+	/// <param name="a_pRanges">Only these ranges of the index buffer, such as the meshlets left after culling.</param>
+	/// <param name="a_uRangeCount">The amount of ranges.</param>
+	/// <param name="a_bBindMaterial">False if the last draw used the same material, its shaders and textures are still bound.</param>
+	void Draw(unsigned int a_uLod = 0, const IndexRange* a_pRanges = nullptr, unsigned int a_uRangeCount = 0, bool a_bBindMaterial = true);
+
+	/// <summary>
+	/// Draws this entity's mesh and material once per instance bound to slot 1,
+	/// for a batch of entities that share both.
+	/// </summary>
+	/// <param name="a_pInstancedShader">Stands in for the material's vertex shader, reading the instance data.</param>
+	/// <param name="a_uLod">The level of detail every instance is drawn at.</param>
+	/// <param name="a_uInstanceCount">The amount of instances.</param>
+	/// <param name="a_uFirstInstance">The first instance's position in the instance buffer.</param>
+	void DrawInstanced(std::shared_ptr<SimpleVertexShader> a_pInstancedShader, unsigned int a_uLod, unsigned int a_uInstanceCount, unsigned int a_uFirstInstance);
 };
 
 #endif //__GAMEENTITY_H_
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "FrustumCuller.h"
+
+using namespace DirectX;
+
+Frustum FrustumCuller::ExtractFrustum(const DirectX::XMFLOAT4X4& a_m4ViewProjection)
+{
+	// Clip space is position * viewProjection, so each clip coordinate is a
+	// column of the matrix.  Inside means -w <= x <= w, -w <= y <= w, 0 <= z <= w.
+	XMMATRIX columns = XMMatrixTranspose(XMLoadFloat4x4(&a_m4ViewProjection));
+	XMVECTOR vPlanes[6] =
+	{
+		XMVectorAdd(columns.r[3], columns.r[0]),
+		XMVectorSubtract(columns.r[3], columns.r[0]),
+		XMVectorAdd(columns.r[3], columns.r[1]),
+		XMVectorSubtract(columns.r[3], columns.r[1]),
+		columns.r[2],
+		XMVectorSubtract(columns.r[3], columns.r[2])
+	};
+
+	Frustum frustum;
+	for (int i = 0; i < 6; i++)
+	{
+		// Normalizing so distances come out in world units.
+		XMStoreFloat4(&frustum.Planes[i], XMPlaneNormalize(vPlanes[i]));
+	}
+	return frustum;
+}
+
+CullBox FrustumCuller::TransformBox(DirectX::XMFLOAT3 a_v3Min, DirectX::XMFLOAT3 a_v3Max, const DirectX::XMFLOAT4X4& a_m4World)
+{
+	XMVECTOR vMin = XMLoadFloat3(&a_v3Min);
+	XMVECTOR vMax = XMLoadFloat3(&a_v3Max);
+	XMVECTOR vHalf = XMVectorReplicate(0.5f);
+	XMVECTOR vCenter = XMVectorMultiply(XMVectorAdd(vMin, vMax), vHalf);
+	XMVECTOR vExtents = XMVectorMultiply(XMVectorSubtract(vMax, vMin), vHalf);
+
+	// Each local axis adds its half size times the absolute row it maps through.
+	XMMATRIX world = XMLoadFloat4x4(&a_m4World);
+	XMVECTOR vWorldExtents = XMVectorMultiply(XMVectorSplatX(vExtents), XMVectorAbs(world.r[0]));
+	vWorldExtents = XMVectorMultiplyAdd(XMVectorSplatY(vExtents), XMVectorAbs(world.r[1]), vWorldExtents);
+	vWorldExtents = XMVectorMultiplyAdd(XMVectorSplatZ(vExtents), XMVectorAbs(world.r[2]), vWorldExtents);
+
+	CullBox box;
+	XMStoreFloat3(&box.Center, XMVector3TransformCoord(vCenter, world));
+	XMStoreFloat3(&box.Extents, vWorldExtents);
+	return box;
+}
+
+unsigned int FrustumCuller::Cull(const Frustum& a_fFrustum, const CullBox* a_pBoxes, unsigned int a_uCount, unsigned char* a_pVisible)
+{
+	XMVECTOR vZero = XMVectorZero();
+	unsigned int uVisible = 0;
+
+	for (unsigned int uFirst = 0; uFirst < a_uCount; uFirst += 4)
+	{
+		// Gathering four boxes, repeating the last one to pad out the final batch.
+		XMMATRIX centers, extents;
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			unsigned int uBox = uFirst + i < a_uCount ? uFirst + i : a_uCount - 1;
+			centers.r[i] = XMLoadFloat3(&a_pBoxes[uBox].Center);
+			extents.r[i] = XMLoadFloat3(&a_pBoxes[uBox].Extents);
+		}
+
+		// One box per lane: r[0] holds the four x values, r[1] the y values, r[2] the z values.
+		centers = XMMatrixTranspose(centers);
+		extents = XMMatrixTranspose(extents);
+
+		XMVECTOR vOutside = XMVectorFalseInt();
+		for (int p = 0; p < 6; p++)
+		{
+			XMVECTOR vPlane = XMLoadFloat4(&a_fFrustum.Planes[p]);
+			XMVECTOR vNormalX = XMVectorSplatX(vPlane);
+			XMVECTOR vNormalY = XMVectorSplatY(vPlane);
+			XMVECTOR vNormalZ = XMVectorSplatZ(vPlane);
+
+			// Signed distance of the center, plus how far the box reaches towards the plane.
+			XMVECTOR vDistance = XMVectorMultiplyAdd(vNormalX, centers.r[0], XMVectorSplatW(vPlane));
+			vDistance = XMVectorMultiplyAdd(vNormalY, centers.r[1], vDistance);
+			vDistance = XMVectorMultiplyAdd(vNormalZ, centers.r[2], vDistance);
+			XMVECTOR vReach = XMVectorMultiply(XMVectorAbs(vNormalX), extents.r[0]);
+			vReach = XMVectorMultiplyAdd(XMVectorAbs(vNormalY), extents.r[1], vReach);
+			vReach = XMVectorMultiplyAdd(XMVectorAbs(vNormalZ), extents.r[2], vReach);
+
+			vOutside = XMVectorOrInt(vOutside, XMVectorLess(XMVectorAdd(vDistance, vReach), vZero));
+		}
+
+		uint32_t pOutside[4];
+		XMStoreInt4(pOutside, vOutside);
+		for (unsigned int i = 0; i < 4 && uFirst + i < a_uCount; i++)
+		{
+			a_pVisible[uFirst + i] = pOutside[i] == 0 ? 1 : 0;
+			uVisible += a_pVisible[uFirst + i];
+		}
+	}
+
+	return uVisible;
+}
@@ -0,0 +1,61 @@
+#ifndef __FRUSTUMCULLER_H_
+#define __FRUSTUMCULLER_H_
+
+#include <DirectXMath.h>
+
+/// <summary>
+/// World space axis aligned box, stored as a center and half size so the
+/// plane tests need no min/max selection.
+/// </summary>
+struct CullBox
+{
+	DirectX::XMFLOAT3 Center;
+	DirectX::XMFLOAT3 Extents;
+};
+
+/// <summary>
+/// The six planes of a view volume, (a, b, c, d) with a*x + b*y + c*z + d >= 0
+/// on the inside.  Left, right, bottom, top, near, far.
+/// </summary>
+struct Frustum
+{
+	DirectX::XMFLOAT4 Planes[6];
+};
+
+/// <summary>
+/// Tests bounds against a view volume before anything is drawn.  Works for
+/// perspective and orthographic projections alike, since it only looks at
+/// the planes of the combined view * projection.
+/// </summary>
+namespace FrustumCuller
+{
+	/// <summary>
+	/// Pulls the normalized planes out of a view * projection matrix, with
+	/// Direct3D's 0 to 1 clip depth.
+	/// </summary>
+	/// <param name="a_m4ViewProjection">The row vector view * projection matrix.</param>
+	/// <returns>The world space frustum.</returns>
+	Frustum ExtractFrustum(const DirectX::XMFLOAT4X4& a_m4ViewProjection);
+
+	/// <summary>
+	/// Gets the world space box around a local space box after a transform.
+	/// </summary>
+	/// <param name="a_v3Min">The local box's minimum corner.</param>
+	/// <param name="a_v3Max">The local box's maximum corner.</param>
+	/// <param name="a_m4World">The world matrix.</param>
+	/// <returns>The box enclosing all eight transformed corners.</returns>
+	CullBox TransformBox(DirectX::XMFLOAT3 a_v3Min, DirectX::XMFLOAT3 a_v3Max, const DirectX::XMFLOAT4X4& a_m4World);
+
+	/// <summary>
+	/// Tests four boxes at a time, one per SIMD lane, against every plane.
+	/// Boxes touching the frustum count as visible.
+	/// </summary>
+	/// <param name="a_fFrustum">The view volume.</param>
+	/// <param name="a_pBoxes">The world space boxes.</param>
+	/// <param name="a_uCount">The amount of boxes.</param>
+	/// <param name="a_pVisible">Receives 1 for every visible box and 0 for every culled one.</param>
+	/// <returns>The amount of visible boxes.</returns>
+	unsigned int Cull(const Frustum& a_fFrustum, const CullBox* a_pBoxes, unsigned int a_uCount, unsigned char* a_pVisible);
+}
+
+#endif //__FRUSTUMCULLER_H_
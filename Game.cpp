@@ -9,6 +9,7 @@
 #include "ImGui/imgui_impl_win32.h"
 
 #include <vector>
+#include <climits>
 #include <WICTextureLoader.h>
 // Needed for a helper function to load pre-compiled shader files
 #pragma comment(lib, "d3dcompiler.lib")
@@ -17,10 +18,27 @@
 #include "Material.h"
 #include "Colors.h"
 #include "Texture.h"
+#include "TextureLoader.h"
+#include "AssetLoader.h"
 
 // For the DirectX Math library
 using namespace DirectX;
 
+namespace
+{
+	// Meshes with more triangles than this cost more to rasterize as occluders than they save.
+	const int g_dMaxOccluderTriangles = 1024;
+
+	// Below this many entities FrustumCuller's linear pass beats querying the tree.
+	// BoundingVolumeHierarchyBenchmark has them even at 5k boxes and the tree ahead at 10k.
+	const unsigned int g_uMinTreeCullEntities = 8000;
+
+	// Scales the pixels of error each pass tolerates.  Shadows are blurred by filtering
+	// and only seen second hand, so their casters switch to coarse levels much sooner.
+	const float g_fLodBias = 1.0f;
+	const float g_fShadowLodBias = 4.0f;
+}
+
 void Game::Initialize()
 {
 	// Seeding the random object.
@@ -30,6 +48,15 @@ void Game::Initialize()
 	m_lCameras.push_back(std::shared_ptr<Camera>(new Camera(Window::AspectRatio(), XMFLOAT3(0.0f, 0.0f, -5.0f), 60.0f)));
 	m_pActiveCamera = m_lCameras[0];
 
+	// Routing every shader's binds through the state cache, so repeats never reach the context.
+	ISimpleShader::StateCache = &Graphics::StateCache;
+
+	// Writing vertex and pixel shader constants back to back into one buffer, where the device can bind them at an offset.
+	if (Graphics::ConstantRing.IsValid()) ISimpleShader::ConstantRing = &Graphics::ConstantRing;
+
+	// Leaving the scene and view constants to SceneConstants, which fills them once a frame for every shader.
+	ISimpleShader::SharedConstantBufferNames = { SceneConstants::BUFFER_NAME, SceneConstants::VIEW_BUFFER_NAME };
+
 	// Loading in the main shaders that the program will be using.
 	std::shared_ptr<SimpleVertexShader> pBasicVS = std::make_shared<SimpleVertexShader>(
 		Graphics::Device, Graphics::Context, FixPath(L"VertexShader.cso").c_str());
@@ -52,51 +79,107 @@ void Game::Initialize()
 	sampleDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
 	Graphics::Device.Get()->CreateSamplerState(&sampleDesc, &pSampler);
 
-	#pragma region Loading textures and setting materials.
-	std::vector<std::shared_ptr<Material>> lMaterials;
+	#pragma region Loading assets.
+	// Every texture, model and sky face is read and decoded/processed on the job
+	// system at once.  Only creating the GPU resources happens here on the device
+	// thread, in Finish().
+	AssetLoader loader(m_jsJobs);
+
+	auto loadTexture = [&loader](const wchar_t* a_sFilepath, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>* a_pSRV)
+	{
+		std::wstring sFilepath = a_sFilepath;
+		loader.Add(
+			[sFilepath]() { return TextureLoader::Decode(sFilepath.c_str()); },
+			[a_pSRV](DecodedImage& a_diImage) { *a_pSRV = TextureLoader::CreateShaderResourceView(a_diImage); });
+	};
+	auto loadMesh = [&loader](const char* a_sFilepath, std::shared_ptr<Mesh>* a_pMesh, MeshLoadOptions a_mloOptions = MeshLoadOptions())
+	{
+		std::string sFilepath = a_sFilepath;
+		loader.Add(
+			[sFilepath, a_mloOptions]() { return Mesh::Load(sFilepath.c_str(), a_mloOptions); },
+			[a_pMesh](MeshData& a_mdData) { *a_pMesh = std::make_shared<Mesh>(a_mdData); });
+	};
+
 	// Loading in the textures:
 	TextureSet cobblestone = {};
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/cobblestone_albedo.png", nullptr, &cobblestone.Albedo);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/cobblestone_normals.png", nullptr,	&cobblestone.Normal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/cobblestone_metal.png", nullptr, &cobblestone.Metal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/cobblestone_roughness.png", nullptr, &cobblestone.Roughness);
+	loadTexture(L"Textures/PBR/cobblestone_albedo.png", &cobblestone.Albedo);
+	loadTexture(L"Textures/PBR/cobblestone_normals.png", &cobblestone.Normal);
+	loadTexture(L"Textures/PBR/cobblestone_metal.png", &cobblestone.Metal);
+	loadTexture(L"Textures/PBR/cobblestone_roughness.png", &cobblestone.Roughness);
 
 	TextureSet bronze = {};
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/bronze_albedo.png", nullptr, &bronze.Albedo);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/bronze_normals.png", nullptr, &bronze.Normal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/bronze_metal.png", nullptr, &bronze.Metal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/bronze_roughness.png", nullptr, &bronze.Roughness);
+	loadTexture(L"Textures/PBR/bronze_albedo.png", &bronze.Albedo);
+	loadTexture(L"Textures/PBR/bronze_normals.png", &bronze.Normal);
+	loadTexture(L"Textures/PBR/bronze_metal.png", &bronze.Metal);
+	loadTexture(L"Textures/PBR/bronze_roughness.png", &bronze.Roughness);
 
 	TextureSet scratch = {};
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/scratched_albedo.png", nullptr, &scratch.Albedo);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/scratched_normals.png", nullptr, &scratch.Normal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/scratched_metal.png", nullptr, &scratch.Metal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/scratched_roughness.png", nullptr, &scratch.Roughness);
+	loadTexture(L"Textures/PBR/scratched_albedo.png", &scratch.Albedo);
+	loadTexture(L"Textures/PBR/scratched_normals.png", &scratch.Normal);
+	loadTexture(L"Textures/PBR/scratched_metal.png", &scratch.Metal);
+	loadTexture(L"Textures/PBR/scratched_roughness.png", &scratch.Roughness);
 
 	TextureSet rust = {};
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/rust_albedo.png", nullptr, &rust.Albedo);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/rust_normals.png", nullptr, &rust.Normal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/rust_metal.png", nullptr, &rust.Metal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/rust_roughness.png", nullptr, &rust.Roughness);
+	loadTexture(L"Textures/PBR/rust_albedo.png", &rust.Albedo);
+	loadTexture(L"Textures/PBR/rust_normals.png", &rust.Normal);
+	loadTexture(L"Textures/PBR/rust_metal.png", &rust.Metal);
+	loadTexture(L"Textures/PBR/rust_roughness.png", &rust.Roughness);
 
 	TextureSet wood = {};
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/wood_albedo.png", nullptr, &wood.Albedo);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/wood_normals.png", nullptr, &wood.Normal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/wood_metal.png", nullptr, &wood.Metal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/wood_roughness.png", nullptr, &wood.Roughness);
+	loadTexture(L"Textures/PBR/wood_albedo.png", &wood.Albedo);
+	loadTexture(L"Textures/PBR/wood_normals.png", &wood.Normal);
+	loadTexture(L"Textures/PBR/wood_metal.png", &wood.Metal);
+	loadTexture(L"Textures/PBR/wood_roughness.png", &wood.Roughness);
 
 	TextureSet floor = {};
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/floor_albedo.png", nullptr, &floor.Albedo);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/floor_normals.png", nullptr, &floor.Normal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/floor_metal.png", nullptr, &floor.Metal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/floor_roughness.png", nullptr, &floor.Roughness);
+	loadTexture(L"Textures/PBR/floor_albedo.png", &floor.Albedo);
+	loadTexture(L"Textures/PBR/floor_normals.png", &floor.Normal);
+	loadTexture(L"Textures/PBR/floor_metal.png", &floor.Metal);
+	loadTexture(L"Textures/PBR/floor_roughness.png", &floor.Roughness);
 
 	TextureSet rough = {};
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/rough_albedo.png", nullptr, &rough.Albedo);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/rough_normals.png", nullptr, &rough.Normal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/rough_metal.png", nullptr, &rough.Metal);
-	CreateWICTextureFromFile(Graphics::Device.Get(), Graphics::Context.Get(), L"Textures/PBR/rough_roughness.png", nullptr, &rough.Roughness);
+	loadTexture(L"Textures/PBR/rough_albedo.png", &rough.Albedo);
+	loadTexture(L"Textures/PBR/rough_normals.png", &rough.Normal);
+	loadTexture(L"Textures/PBR/rough_metal.png", &rough.Metal);
+	loadTexture(L"Textures/PBR/rough_roughness.png", &rough.Roughness);
+
+	// Loading the 3D models.
+	std::shared_ptr<Mesh> cube, cylinder, sphere, helix, torus, quad, quadDoubleSided;
+	loadMesh("Models/cube.graphics_obj", &cube);
+	loadMesh("Models/cylinder.graphics_obj", &cylinder);
+	// The dense, closed models are split into meshlets so their back facing clusters can be skipped.
+	MeshLoadOptions meshletOptions;
+	meshletOptions.BuildMeshlets = true;
+	loadMesh("Models/sphere.graphics_obj", &sphere, meshletOptions);
+	loadMesh("Models/helix.graphics_obj", &helix, meshletOptions);
+	loadMesh("Models/torus.graphics_obj", &torus, meshletOptions);
+	loadMesh("Models/quad.graphics_obj", &quad);
+	loadMesh("Models/quad_double_sided.graphics_obj", &quadDoubleSided);
+
+	// Decoding the six faces of the sky box, +X, -X, +Y, -Y, +Z, -Z.
+	const wchar_t* pSkyFaces[6] =
+	{
+		L"Textures/Skies/right.png",
+		L"Textures/Skies/left.png",
+		L"Textures/Skies/up.png",
+		L"Textures/Skies/down.png",
+		L"Textures/Skies/front.png",
+		L"Textures/Skies/back.png"
+	};
+	DecodedImage skyFaces[6];
+	for (int i = 0; i < 6; i++)
+	{
+		std::wstring sFilepath = pSkyFaces[i];
+		loader.Add(
+			[sFilepath]() { return TextureLoader::Decode(sFilepath.c_str()); },
+			[&skyFaces, i](DecodedImage& a_diImage) { skyFaces[i] = std::move(a_diImage); });
+	}
+
+	// Waiting on the workers and creating everything on the GPU.
+	m_alsAssetLoadStats = loader.Finish();
+	#pragma endregion
 
+	#pragma region Setting up materials.
 	// Creating the materials.
 	std::shared_ptr<Material> matCobblestone = 
 		std::make_shared<Material>(Material(pBasicVS, pPBRPixelShader, XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), 0.0f));
@@ -162,24 +245,9 @@ void Game::Initialize()
 	matRough->AddTexturesSRV("RoughnessMap", rough.Roughness);
 	matRough->AddTexturesSRV("MetalnessMap", rough.Metal);
 	matRough->SetScale(DirectX::XMFLOAT2(1.0f, 1.0f));
-
-	lMaterials.push_back(matCobblestone);
-	lMaterials.push_back(matBronze);
-	lMaterials.push_back(matScratch);
-	lMaterials.push_back(matRust);
-	lMaterials.push_back(matWood);
-	lMaterials.push_back(matFloor);
-	lMaterials.push_back(matRough);
 	#pragma endregion
 
-	// Loading the 3D models.
-	std::shared_ptr<Mesh> cube = std::make_shared<Mesh>(Mesh("Models/cube.graphics_obj"));
-	std::shared_ptr<Mesh> cylinder = std::make_shared<Mesh>(Mesh("Models/cylinder.graphics_obj"));
-	std::shared_ptr<Mesh> sphere = std::make_shared<Mesh>(Mesh("Models/sphere.graphics_obj"));
-	std::shared_ptr<Mesh> helix = std::make_shared<Mesh>(Mesh("Models/helix.graphics_obj"));
-	std::shared_ptr<Mesh> torus = std::make_shared<Mesh>(Mesh("Models/torus.graphics_obj"));
-	std::shared_ptr<Mesh> quad = std::make_shared<Mesh>(Mesh("Models/quad.graphics_obj"));
-	std::shared_ptr<Mesh> quadDoubleSided = std::make_shared<Mesh>(Mesh("Models/quad_double_sided.graphics_obj"));
+	m_lMeshes = { cube, cylinder, sphere, helix, torus, quad, quadDoubleSided };
 
 	// Creating a light.
 	Light currentLight = {};
@@ -204,28 +272,22 @@ void Game::Initialize()
 
 	// Loading in the sky box.
 	m_pSkyBox = new Sky(cube, pSampler);
-	m_pSkyBox->CreateCubemap(
-		L"Textures/Skies/right.png",
-		L"Textures/Skies/left.png",
-		L"Textures/Skies/up.png",
-		L"Textures/Skies/down.png",
-		L"Textures/Skies/front.png",
-		L"Textures/Skies/back.png"
-	);
+	m_pSkyBox->CreateCubemap(skyFaces);
 
 	// Instantiating the floor.
-	m_pFloor = new Entity(quadDoubleSided, matWood);
+	m_pFloor = new Entity(quadDoubleSided, matWood, m_tsTransforms);
 	m_pFloor->GetTransform().MoveAbsolute(0.0f, -3.0f, 0.0f);
 	m_pFloor->GetTransform().Scale(4.0f, 4.0f, 4.0f);
 
 	// Creating the shadow manager.
 	m_pShadowManager = new ShadowManager(DirectX::XMFLOAT3(0.0f, -1.0f, 1.0f));
 
-	// Giving all of the materials the shadow sampler.
-	for (int i = 0; i < lMaterials.size(); i++)
-	{
-		lMaterials[i]->AddSampler("ShadowSampler", m_pShadowManager->GetShadowSampler());
-	}
+	// Entities sharing a mesh and a material drawn with the basic vertex shader get drawn together.
+	m_pInstanceRenderer = new InstanceRenderer(pBasicVS);
+
+	// The lights, camera and shadow map are bound once a frame for every material.
+	m_pSceneConstants = new SceneConstants();
+	m_pSceneConstants->SetShadowMap(m_pShadowManager->GetShadowSRV(), m_pShadowManager->GetShadowSampler());
 
 	// Controls the amount of sets of Entities are created.
 	int dAmountOfSets = 1;
@@ -233,13 +295,13 @@ void Game::Initialize()
 	// Instantiating the Entities.
 	for (int i = 0; i < dAmountOfSets; i++)
 	{
-		m_lEntities.push_back(Entity(sphere, matCobblestone));
-		m_lEntities.push_back(Entity(cylinder, matRust));
-		m_lEntities.push_back(Entity(helix, matScratch));
-		m_lEntities.push_back(Entity(torus, matBronze));
-		m_lEntities.push_back(Entity(helix, matWood));
-		m_lEntities.push_back(Entity(cylinder, matFloor));
-		m_lEntities.push_back(Entity(sphere, matRough));
+		m_lEntities.push_back(Entity(sphere, matCobblestone, m_tsTransforms));
+		m_lEntities.push_back(Entity(cylinder, matRust, m_tsTransforms));
+		m_lEntities.push_back(Entity(helix, matScratch, m_tsTransforms));
+		m_lEntities.push_back(Entity(torus, matBronze, m_tsTransforms));
+		m_lEntities.push_back(Entity(helix, matWood, m_tsTransforms));
+		m_lEntities.push_back(Entity(cylinder, matFloor, m_tsTransforms));
+		m_lEntities.push_back(Entity(sphere, matRough, m_tsTransforms));
 	}
 
 	// Setting the locations of entities around the world.
@@ -251,7 +313,7 @@ void Game::Initialize()
 
 			// Setting the scale and getting the current Transform.
 			float fUniformScale = 0.25f;
-			Transform& current = m_lEntities[index].GetTransform();
+			TransformHandle current = m_lEntities[index].GetTransform();
 
 			// Setting the scale and spacing out the models.
 			current.SetScale(fUniformScale, fUniformScale, fUniformScale);
@@ -286,6 +348,8 @@ Game::~Game()
 	delete m_pSkyBox;
 	delete m_pFloor;
 	delete m_pShadowManager;
+	delete m_pSceneConstants;
+	delete m_pInstanceRenderer;
 
 	// ImGui clean up
 	ImGui_ImplDX11_Shutdown();
@@ -327,6 +391,21 @@ void Game::Update(float deltaTime, float totalTime)
 		}
 	}
 
+	// Recomputing every moved entity's matrices at once before drawing.
+	m_tsTransforms.Update(&m_jsJobs);
+
+	// Picking whatever entity is under the cursor, the left button is already taken by the camera.
+	// Uses the hierarchy from the last frame's draw, a frame behind at worst.
+	if (Input::MouseRightPress())
+	{
+		XMFLOAT3 v3Origin, v3Direction;
+		m_pActiveCamera->GetPickRay(Input::GetMouseX(), Input::GetMouseY(), Window::Width(), Window::Height(), v3Origin, v3Direction);
+
+		unsigned int uHit;
+		float fDistance;
+		m_nPickedEntity = m_bvhEntities.RayCast(v3Origin, v3Direction, uHit, fDistance) ? static_cast<int>(uHit) : -1;
+	}
+
 	// Example input checking: Quit if the escape key is pressed
 	if (Input::KeyDown(VK_ESCAPE)) Window::Quit();
 }
@@ -357,6 +436,48 @@ void Game::UpdateImGui(float deltaTime)
 	ImGui::Text("Framerate: %f fps", ImGui::GetIO().Framerate);
 	// Window resolution:
 	ImGui::Text("Window Resolution: %dx%d", Window::Width(), Window::Height());
+	// Startup asset loading:
+	ImGui::Text("Asset Load: %.1f ms on %u threads", m_alsAssetLoadStats.WallTimeMs, m_alsAssetLoadStats.ThreadCount);
+	// Stays put while nothing moves, reads never force a recompute.
+	ImGui::Text("Matrix Recomputes: %u entity, %u other",
+		m_tsTransforms.GetRecalculationCount(), Transform::GetRecalculationCount());
+	ImGui::Text("Culling: %u/%u drawn, %u/%u casting shadows",
+		m_uCameraVisibleCount, static_cast<unsigned int>(m_lEntities.size()),
+		m_uShadowVisibleCount, static_cast<unsigned int>(m_lEntities.size()));
+	ImGui::Text("Entity BVH: %u nodes, %u builds", m_bvhEntities.GetNodeCount(), m_bvhEntities.GetBuildCount());
+	const OcclusionStats& osStats = m_ocOcclusion.GetStats();
+	ImGui::Text("Occlusion: %u/%u occluded, %u occluder triangles, %.2f ms raster, %.2f ms test",
+		osStats.Occluded, osStats.Tested, osStats.OccluderTriangles, osStats.RasterizeMs, osStats.TestMs);
+	ImGui::Text("LOD: %u/%u triangles drawn (%.0f%%)", m_uDrawnTriangles, m_uFullDetailTriangles,
+		m_uFullDetailTriangles > 0 ? 100.0f * m_uDrawnTriangles / m_uFullDetailTriangles : 100.0f);
+	ImGui::Text("Meshlets: %u/%u culled (%u back facing, %u outside), %u/%u triangles kept, %u draws",
+		m_mcsMeshletStats.BackfaceCulled + m_mcsMeshletStats.FrustumCulled, m_mcsMeshletStats.Meshlets,
+		m_mcsMeshletStats.BackfaceCulled, m_mcsMeshletStats.FrustumCulled,
+		m_mcsMeshletStats.TrianglesKept, m_mcsMeshletStats.Triangles, m_mcsMeshletStats.Ranges);
+	ImGui::Text("Draw calls: %u main (%u without instancing), %u shadow (%u without instancing)",
+		m_uCameraDraws, m_uCameraVisibleCount, m_uShadowDraws, m_uShadowVisibleCount);
+	const RenderQueueStats& rqsStats = m_rqQueue.GetStats();
+	ImGui::Text("Render queue: %u draws sorted in %.3f ms, %u state changes (%u unsorted), %u mesh changes (%u unsorted)",
+		rqsStats.Draws, rqsStats.SortMs, rqsStats.StateChanges, rqsStats.UnsortedStateChanges, rqsStats.MeshChanges, rqsStats.UnsortedMeshChanges);
+	ImGui::Text("Constant buffers: %u uploaded (%.1f KB), %u unchanged and skipped",
+		m_susUploads.Uploads, m_susUploads.Bytes / 1024.0f, m_susUploads.Skipped);
+	const UploadRingStats& ursConstants = Graphics::ConstantRing.GetLastFrameStats();
+	const UploadRingStats& ursInstances = Graphics::InstanceRing.GetLastFrameStats();
+	if (Graphics::ConstantRing.IsValid())
+		ImGui::Text("Upload rings: constants %.1f of %.0f KB in %u writes, instances %.1f of %.0f KB in %u writes, grown %u times",
+			ursConstants.Bytes / 1024.0f, ursConstants.Capacity / 1024.0f, ursConstants.Allocations,
+			ursInstances.Bytes / 1024.0f, ursInstances.Capacity / 1024.0f, ursInstances.Allocations,
+			ursConstants.Growths + ursInstances.Growths);
+	else
+		ImGui::Text("Upload rings: instances %.1f of %.0f KB in %u writes, grown %u times, constants updated per buffer",
+			ursInstances.Bytes / 1024.0f, ursInstances.Capacity / 1024.0f, ursInstances.Allocations, ursInstances.Growths);
+	ImGui::Text("Shader reflection: %u reflected, %u read from cache, %u shared with an identical shader",
+		ISimpleShader::ReflectionStats.Reflected, ISimpleShader::ReflectionStats.Cached, ISimpleShader::ReflectionStats.Shared);
+	const PipelineStateStats& pssStats = Graphics::StateCache.GetLastFrameStats();
+	ImGui::Text("State cache: %u binds issued, %u elided (%.0f%%)", pssStats.Issued, pssStats.Elided,
+		pssStats.Issued + pssStats.Elided > 0 ? 100.0f * pssStats.Elided / (pssStats.Issued + pssStats.Elided) : 0.0f);
+	if (m_nPickedEntity >= 0) ImGui::Text("Picked: Entity %d (right click)", m_nPickedEntity);
+	else ImGui::Text("Picked: none (right click)");
 
 	// Editing the color of the background.
 	ImGui::ColorEdit4("Background Color", m_fBackgroundColor);
@@ -386,21 +507,27 @@ void Game::UpdateImGui(float deltaTime)
 			if (ImGui::TreeNode(sInterface.c_str()))
 			{
 				// Getting the current entity's transform.
-				Transform& current = m_lEntities[i].GetTransform();
+				TransformHandle current = m_lEntities[i].GetTransform();
+				XMFLOAT3 v3Position = current.GetPosition();
+				XMFLOAT3 v3Rotation = current.GetRotation();
+				XMFLOAT3 v3Scale = current.GetScale();
 
-				// Creating the drag floats.
-				ImGui::DragFloat3(
+				// Creating the drag floats, only writing back what was changed.
+				if (ImGui::DragFloat3(
 					("Position##" + std::to_string(i)).c_str(), 
-					&current.GetPosition().x,
-					0.05f);
-				ImGui::DragFloat3(
+					&v3Position.x,
+					0.05f))
+					current.SetPosition(v3Position);
+				if (ImGui::DragFloat3(
 					("Rotation##" + std::to_string(i)).c_str(),
-					&current.GetRotation().x,
-					0.05f);
-				ImGui::DragFloat3(
+					&v3Rotation.x,
+					0.05f))
+					current.SetRotation(v3Rotation);
+				if (ImGui::DragFloat3(
 					("Scale##" + std::to_string(i)).c_str(),
-					&current.GetScale().x,
-					0.05f);
+					&v3Scale.x,
+					0.05f))
+					current.SetScale(v3Scale);
 				if (ImGui::TreeNode("Material Textures:"))
 				{
 					// Looping through the textures in the entity's map,
@@ -418,6 +545,40 @@ void Game::UpdateImGui(float deltaTime)
 		}
 		ImGui::TreePop();
 	}
+	// Creating a sub section for the loaded meshes.
+	if (ImGui::TreeNode("Meshes"))
+	{
+		for (unsigned int i = 0; i < m_lMeshes.size(); i++)
+		{
+			Mesh* pMesh = m_lMeshes[i].get();
+			ImGui::Text("%s%s", pMesh->GetName().c_str(), pMesh->WasLoadedFromCache() ? " (cached)" : "");
+			ImGui::Text("    Vertices: %d (%d before welding)", pMesh->GetVertexCount(), pMesh->GetUnweldedVertexCount());
+			ImGui::Text("    Vertex Buffer: %.1f KB (%.1f KB before welding)%s",
+				pMesh->GetVertexCount() * pMesh->GetVertexStride() / 1024.0f,
+				pMesh->GetUnweldedVertexCount() * sizeof(Vertex) / 1024.0f,
+				pMesh->IsCompressed() ? " compressed" : "");
+			const MeshLod& lastLod = pMesh->GetLod(pMesh->GetLodCount() - 1);
+			ImGui::Text("    Index Buffer: %.1f KB (%d bit, every LOD)",
+				(lastLod.IndexStart + lastLod.IndexCount) * (pMesh->GetIndexFormat() == DXGI_FORMAT_R16_UINT ? 2 : 4) / 1024.0f,
+				pMesh->GetIndexFormat() == DXGI_FORMAT_R16_UINT ? 16 : 32);
+
+			VertexCacheStats loaded = pMesh->GetVertexCacheStats(false);
+			VertexCacheStats optimized = pMesh->GetVertexCacheStats(true);
+			ImGui::Text("    ACMR: %.3f -> %.3f  ATVR: %.3f -> %.3f",
+				loaded.ACMR, optimized.ACMR, loaded.ATVR, optimized.ATVR);
+			if (!pMesh->GetMeshlets().empty())
+			{
+				MeshletStats meshletStats = MeshletBuilder::Analyze(pMesh->GetMeshlets().data(), pMesh->GetMeshlets().size());
+				ImGui::Text("    Meshlets: %u, %.0f%% vertex fill, %.0f%% triangle fill",
+					meshletStats.MeshletCount, meshletStats.VertexFill * 100.0f, meshletStats.TriangleFill * 100.0f);
+			}
+			for (unsigned int l = 0; l < pMesh->GetLodCount(); l++)
+			{
+				ImGui::Text("    LOD %u: %u triangles, %.3f%% error", l, pMesh->GetLod(l).IndexCount / 3, pMesh->GetLod(l).Error * 100.0f);
+			}
+		}
+		ImGui::TreePop();
+	}
 	// Creating a sub section for the cameras.
 	if (ImGui::TreeNode("Cameras"))
 	{
@@ -504,33 +665,202 @@ void Game::UpdateImGui(float deltaTime)
 // --------------------------------------------------------
 void Game::Draw(float deltaTime, float totalTime)
 {
-	m_pShadowManager->Draw(m_lEntities);
+	// Forgetting what ImGui, Present and the unbinding at the end of last frame left bound.
+	Graphics::StateCache.BeginFrame();
+
+	// Keeping the last frame's constant buffer uploads for the stats window.
+	m_susUploads = ISimpleShader::UploadStats;
+	ISimpleShader::UploadStats = SimpleUploadStats();
+
+	// Taking back ring space the GPU is done with, before anything is written this frame.
+	Graphics::ConstantRing.BeginFrame();
+	Graphics::InstanceRing.BeginFrame();
+
+	// Multiplying every entity's world matrix through the camera and the light once, up front.
+	XMFLOAT4X4 m4View = m_pActiveCamera->GetView();
+	XMFLOAT4X4 m4Projection = m_pActiveCamera->GetProjection();
+	XMFLOAT4X4 m4ViewProjection;
+	XMStoreFloat4x4(&m4ViewProjection, XMMatrixMultiply(XMLoadFloat4x4(&m4View), XMLoadFloat4x4(&m4Projection)));
+	m_tsTransforms.CalculateViewProjections(m4ViewProjection, m_pShadowManager->GetLightViewProjection(), &m_jsJobs);
+
+	// Culling entities outside the camera's view and the light's volume before drawing anything.
+	unsigned int uEntityCount = static_cast<unsigned int>(m_lEntities.size());
+	m_lEntityBounds.resize(uEntityCount);
+	m_lCameraVisible.resize(uEntityCount);
+	m_lShadowVisible.resize(uEntityCount);
+	for (unsigned int i = 0; i < uEntityCount; i++)
+	{
+		std::shared_ptr<Mesh> pMesh = m_lEntities[i].GetMesh();
+		m_lEntityBounds[i] = FrustumCuller::TransformBox(pMesh->GetBoundsMin(), pMesh->GetBoundsMax(), m_lEntities[i].GetTransform().GetWorldMatrix());
+	}
+	m_bvhEntities.Update(m_lEntityBounds.data(), uEntityCount);
+	if (uEntityCount >= g_uMinTreeCullEntities)
+	{
+		m_uCameraVisibleCount = m_bvhEntities.QueryFrustum(m_pActiveCamera->GetFrustum(), m_lCameraVisible.data());
+		m_uShadowVisibleCount = m_bvhEntities.QueryFrustum(m_pShadowManager->GetLightFrustum(), m_lShadowVisible.data());
+	}
+	else
+	{
+		m_uCameraVisibleCount = FrustumCuller::Cull(m_pActiveCamera->GetFrustum(), m_lEntityBounds.data(), uEntityCount, m_lCameraVisible.data());
+		m_uShadowVisibleCount = FrustumCuller::Cull(m_pShadowManager->GetLightFrustum(), m_lEntityBounds.data(), uEntityCount, m_lShadowVisible.data());
+	}
+
+	// Rasterizing the floor and the visible low poly entities on the CPU, then
+	// skipping whatever they hide.  Shadow casters are left alone, they can
+	// still throw shadows into view from behind an occluder.
+	m_ocOcclusion.BeginFrame();
+	std::shared_ptr<Mesh> pFloorMesh = m_pFloor->GetMesh();
+	m_ocOcclusion.AddOccluder(pFloorMesh->GetPositions().data(), pFloorMesh->GetIndices().data(),
+		static_cast<unsigned int>(pFloorMesh->GetIndexCount()), m_pFloor->GetTransform().GetWorldViewProjectionMatrix());
+	for (unsigned int i = 0; i < uEntityCount; i++)
+	{
+		std::shared_ptr<Mesh> pMesh = m_lEntities[i].GetMesh();
+		if (!m_lCameraVisible[i] || pMesh->GetIndexCount() / 3 > g_dMaxOccluderTriangles) continue;
+
+		m_ocOcclusion.AddOccluder(pMesh->GetPositions().data(), pMesh->GetIndices().data(),
+			static_cast<unsigned int>(pMesh->GetIndexCount()), m_lEntities[i].GetTransform().GetWorldViewProjectionMatrix());
+	}
+	m_ocOcclusion.Rasterize(&m_jsJobs);
+	m_uCameraVisibleCount -= m_ocOcclusion.Cull(m_lEntityBounds.data(), uEntityCount, m4ViewProjection, m_lCameraVisible.data());
+
+	// Choosing each entity's level of detail from how large its bounding sphere appears on screen.
+	XMFLOAT3 v3CameraPosition = m_pActiveCamera->GetTransform().GetPosition();
+	float fPixelsPerUnitAtOne = m4Projection._22 * Window::Height() * 0.5f;
+	m_lCameraLods.resize(uEntityCount);
+	m_lShadowLods.resize(uEntityCount);
+	m_uDrawnTriangles = 0;
+	m_uFullDetailTriangles = 0;
+	for (unsigned int i = 0; i < uEntityCount; i++)
+	{
+		m_lCameraLods[i] = 0;
+		m_lShadowLods[i] = 0;
+		if (!m_lCameraVisible[i] && !m_lShadowVisible[i]) continue;
+
+		std::shared_ptr<Mesh> pMesh = m_lEntities[i].GetMesh();
+		XMFLOAT4X4 m4World = m_lEntities[i].GetTransform().GetWorldMatrix();
+		XMMATRIX mWorld = XMLoadFloat4x4(&m4World);
+		XMFLOAT3 v3Center = pMesh->GetSphereCenter();
+		XMVECTOR vCenter = XMVector3Transform(XMLoadFloat3(&v3Center), mWorld);
+		XMVECTOR vScale = XMVectorMax(XMVector3Length(mWorld.r[0]), XMVectorMax(XMVector3Length(mWorld.r[1]), XMVector3Length(mWorld.r[2])));
+		float fRadius = pMesh->GetSphereRadius() * XMVectorGetX(vScale);
+		float fDistance = XMVectorGetX(XMVector3Length(XMVectorSubtract(vCenter, XMLoadFloat3(&v3CameraPosition))));
+
+		// Full detail once the camera is inside the sphere.
+		if (fDistance > fRadius)
+		{
+			float fScreenDiameter = 2.0f * fRadius * fPixelsPerUnitAtOne / fDistance;
+			m_lCameraLods[i] = static_cast<unsigned char>(pMesh->SelectLod(fScreenDiameter, g_fLodBias));
+			m_lShadowLods[i] = static_cast<unsigned char>(pMesh->SelectLod(fScreenDiameter, g_fShadowLodBias));
+		}
+		if (m_lCameraVisible[i])
+		{
+			m_uDrawnTriangles += pMesh->GetLod(m_lCameraLods[i]).IndexCount / 3;
+			m_uFullDetailTriangles += pMesh->GetLod(0).IndexCount / 3;
+		}
+	}
+
+	// Batching entities that share a mesh, material and level of detail into one instanced draw each.
+	m_pInstanceRenderer->Batch(m_lEntities, m_lCameraVisible.data(), m_lCameraLods.data(), m_lShadowVisible.data(), m_lShadowLods.data());
+	const InstanceBatches& ibCamera = m_pInstanceRenderer->GetCameraBatches();
+	const InstanceBatches& ibShadow = m_pInstanceRenderer->GetShadowBatches();
+	m_uCameraDraws = m_uCameraVisibleCount - static_cast<unsigned int>(ibCamera.Order.size() - ibCamera.Batches.size());
+	m_uShadowDraws = m_uShadowVisibleCount - static_cast<unsigned int>(ibShadow.Order.size() - ibShadow.Batches.size());
+
+	// Culling the meshlets of visible full detail entities that have them, against the camera only.
+	// The shadow pass keeps whole meshes, faces turned from the camera can still face the light.
+	// Batched entities are left whole, their ranges would each need a draw of their own.
+	Frustum fCameraFrustum = m_pActiveCamera->GetFrustum();
+	m_lMeshletRanges.clear();
+	m_lMeshletRangeStart.assign(uEntityCount, UINT_MAX);
+	m_lMeshletRangeCount.assign(uEntityCount, 0);
+	m_mcsMeshletStats = {};
+	for (unsigned int i = 0; i < uEntityCount; i++)
+	{
+		std::shared_ptr<Mesh> pMesh = m_lEntities[i].GetMesh();
+		const std::vector<Meshlet>& lMeshlets = pMesh->GetMeshlets();
+		if (!m_lCameraVisible[i] || ibCamera.Batched[i] || m_lCameraLods[i] != 0 || lMeshlets.empty()) continue;
+
+		m_lMeshletRangeStart[i] = static_cast<unsigned int>(m_lMeshletRanges.size());
+		m_lMeshletRangeCount[i] = MeshletCuller::Cull(lMeshlets.data(), lMeshlets.size(), m_lEntities[i].GetTransform().GetWorldMatrix(),
+			fCameraFrustum, v3CameraPosition, m_lMeshletRanges, m_mcsMeshletStats);
+	}
+	m_uDrawnTriangles -= m_mcsMeshletStats.Triangles - m_mcsMeshletStats.TrianglesKept;
+
+	// Queueing every draw of both passes, keyed so sorting groups them by shader, material
+	// and mesh, nearest first.  Depths are of each entity's origin, the view space depth
+	// for the camera and the depth along the light for its orthographic projection.
+	m_rqQueue.Clear();
+	for (unsigned int i = 0; i < uEntityCount; i++)
+	{
+		std::shared_ptr<Mesh> pMesh = m_lEntities[i].GetMesh();
+		if (m_lShadowVisible[i] && !ibShadow.Batched[i])
+		{
+			m_rqQueue.Add(m_rqQueue.MakeKey(RenderPass::Shadow, m_pShadowManager->GetVertexShader(pMesh).get(), nullptr, pMesh.get(),
+				m_lEntities[i].GetTransform().GetWorldLightViewProjectionMatrix()._43), i);
+		}
+		bool bCameraDraw = m_lMeshletRangeStart[i] == UINT_MAX || m_lMeshletRangeCount[i] > 0;
+		if (m_lCameraVisible[i] && !ibCamera.Batched[i] && bCameraDraw)
+		{
+			std::shared_ptr<Material> pMaterial = m_lEntities[i].GetMaterial();
+			m_rqQueue.Add(m_rqQueue.MakeKey(RenderPass::Opaque, pMaterial->GetVertexShader().get(), pMaterial.get(), pMesh.get(),
+				m_lEntities[i].GetTransform().GetWorldViewProjectionMatrix()._44), i);
+		}
+	}
+	for (unsigned int b = 0; b < ibShadow.Batches.size(); b++)
+	{
+		Entity& e = m_lEntities[ibShadow.Order[ibShadow.Batches[b].First]];
+		m_rqQueue.Add(m_rqQueue.MakeKey(RenderPass::Shadow, m_pInstanceRenderer->GetShadowVertexShader().get(), nullptr, e.GetMesh().get(),
+			e.GetTransform().GetWorldLightViewProjectionMatrix()._43), b | INSTANCE_BATCH_FLAG);
+	}
+	for (unsigned int b = 0; b < ibCamera.Batches.size(); b++)
+	{
+		Entity& e = m_lEntities[ibCamera.Order[ibCamera.Batches[b].First]];
+		m_rqQueue.Add(m_rqQueue.MakeKey(RenderPass::Opaque, m_pInstanceRenderer->GetVertexShader().get(), e.GetMaterial().get(), e.GetMesh().get(),
+			e.GetTransform().GetWorldViewProjectionMatrix()._44), b | INSTANCE_BATCH_FLAG);
+	}
+	m_rqQueue.Sort(&m_jsJobs);
+
+	m_pShadowManager->Draw(m_lEntities, m_lShadowLods.data(), m_rqQueue, m_pInstanceRenderer);
 	m_pPPManager->PreRender(m_fBackgroundColor);
 
 	// Clear the back buffer (erase what's on screen) and depth buffer
 	Graphics::Context->ClearRenderTargetView(Graphics::BackBufferRTV.Get(), m_fBackgroundColor);
 	Graphics::Context->ClearDepthStencilView(Graphics::DepthBufferDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
 
-	// Rendering the entities.
-	for (unsigned int i = 0; i < m_lEntities.size(); i++)
-	{
-		// Setting the ambient light.
-		m_lEntities[i].GetMaterial()->GetPixelShader()->SetFloat3("ambient", m_v3AmbientColor);
-
-		// Passing in light data.
-		m_lEntities[i].GetMaterial()->GetPixelShader()->SetData("lights", &m_lLights[0], sizeof(Light) * (int)m_lLights.size());
+	// Giving every shader the lights, camera and shadow map once, after the render targets are bound.
+	m_pSceneConstants->Update(m_v3AmbientColor, v3CameraPosition, m_lLights.data(), static_cast<unsigned int>(m_lLights.size()));
+	m_pSceneConstants->Bind();
 
-		// Passing in shadow data.
-		m_lEntities[i].GetMaterial()->GetVertexShader()->SetMatrix4x4("lightView", m_pShadowManager->GetLightView());
-		m_lEntities[i].GetMaterial()->GetVertexShader()->SetMatrix4x4("lightProjection", m_pShadowManager->GetLightProjection());
-
-		// Adding the shadow map.
-		m_lEntities[i].GetMaterial()->AddTexturesSRV("ShadowMap", m_pShadowManager->GetShadowSRV());
+	// Rendering the entities in sorted order, binding a material only when it changes.
+	size_t uFirstDraw, uLastDraw;
+	m_rqQueue.GetPassRange(RenderPass::Opaque, uFirstDraw, uLastDraw);
+	const uint32_t* pDrawValues = m_rqQueue.GetValues();
+	Material* pBoundMaterial = nullptr;
+	for (size_t q = uFirstDraw; q < uLastDraw; q++)
+	{
+		if (pDrawValues[q] & INSTANCE_BATCH_FLAG)
+		{
+			// Batches bind the instanced vertex shader in place of the material's.
+			m_pInstanceRenderer->DrawCameraBatch(m_lEntities, m_lCameraLods.data(), pDrawValues[q] & ~INSTANCE_BATCH_FLAG);
+			pBoundMaterial = nullptr;
+			continue;
+		}
 
-		m_lEntities[i].Draw(m_pActiveCamera, totalTime);
+		unsigned int i = pDrawValues[q];
+		Material* pMaterial = m_lEntities[i].GetMaterial().get();
+		bool bBindMaterial = pMaterial != pBoundMaterial;
+		pBoundMaterial = pMaterial;
+		if (m_lMeshletRangeStart[i] == UINT_MAX)
+		{
+			m_lEntities[i].Draw(m_lCameraLods[i], nullptr, 0, bBindMaterial);
+		}
+		else
+		{
+			m_lEntities[i].Draw(0, &m_lMeshletRanges[m_lMeshletRangeStart[i]], m_lMeshletRangeCount[i], bBindMaterial);
+		}
 	}
 	
-	m_pFloor->Draw(m_pActiveCamera, totalTime);
+	m_pFloor->Draw();
 
 	// Rendering the sky box.
 	m_pSkyBox->Draw(m_pActiveCamera);
@@ -542,6 +872,10 @@ void Game::Draw(float deltaTime, float totalTime)
 	ImGui::Render();
 	ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
 
+	// Marking where this frame's ring writes end, so the GPU passing it frees them.
+	Graphics::ConstantRing.EndFrame();
+	Graphics::InstanceRing.EndFrame();
+
 	// Present at the end of the frame
 	bool vsync = Graphics::VsyncState();
 	Graphics::SwapChain->Present(
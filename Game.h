@@ -11,7 +11,16 @@
 #include "Lights.h"
 #include "Sky.h"
 #include "ShadowManager.h"
+#include "SceneConstants.h"
 #include "PostProcessManager.h"
+#include "AssetLoader.h"
+#include "JobSystem.h"
+#include "TransformSystem.h"
+#include "FrustumCuller.h"
+#include "BoundingVolumeHierarchy.h"
+#include "OcclusionCuller.h"
+#include "InstanceRenderer.h"
+#include "RenderQueue.h"
 
 class Game
 {
@@ -23,12 +32,38 @@ private:
 	std::vector<std::shared_ptr<Camera>> m_lCameras;
 	std::shared_ptr<Camera> m_pActiveCamera = nullptr;
 	std::vector<Light> m_lLights;
+	JobSystem m_jsJobs;
+	TransformSystem m_tsTransforms;
 	std::vector<Entity> m_lEntities;
+	std::vector<CullBox> m_lEntityBounds;			// World space boxes, rebuilt every frame.
+	std::vector<unsigned char> m_lCameraVisible;	// One flag per entity.
+	std::vector<unsigned char> m_lShadowVisible;	// One flag per entity.
+	unsigned int m_uCameraVisibleCount = 0;
+	unsigned int m_uShadowVisibleCount = 0;
+	BoundingVolumeHierarchy m_bvhEntities;			// Over m_lEntityBounds, refit every frame.
+	int m_nPickedEntity = -1;						// Last entity right clicked, -1 for none.
+	OcclusionCuller m_ocOcclusion;					// The floor and low poly entities hiding the rest.
+	std::vector<unsigned char> m_lCameraLods;		// Level of detail per entity for the main pass.
+	std::vector<unsigned char> m_lShadowLods;		// Level of detail per entity for the shadow pass.
+	unsigned int m_uDrawnTriangles = 0;				// Main pass triangles at the chosen levels of detail.
+	unsigned int m_uFullDetailTriangles = 0;		// What the main pass would have drawn at full detail.
+	std::vector<IndexRange> m_lMeshletRanges;		// Surviving meshlets of every entity, back to back.
+	std::vector<unsigned int> m_lMeshletRangeStart;	// Per entity, its first range, or UINT_MAX if its meshlets were not culled.
+	std::vector<unsigned int> m_lMeshletRangeCount;	// Per entity.
+	MeshletCullStats m_mcsMeshletStats = {};
+	unsigned int m_uCameraDraws = 0;				// Main pass entity draw calls, a batch counting once.
+	unsigned int m_uShadowDraws = 0;				// Shadow pass entity draw calls, a batch counting once.
+	RenderQueue m_rqQueue;							// Both passes' draws, sorted by state then depth.
+	SimpleUploadStats m_susUploads;					// Constant buffer uploads over the last whole frame.
+	std::vector<std::shared_ptr<Mesh>> m_lMeshes;
+	AssetLoadStats m_alsAssetLoadStats = {};
 
 	
 	Sky* m_pSkyBox = nullptr;
 	Entity* m_pFloor = nullptr;
 	ShadowManager* m_pShadowManager = nullptr;
+	SceneConstants* m_pSceneConstants = nullptr;
+	InstanceRenderer* m_pInstanceRenderer = nullptr;
 	PostProcessManager* m_pPPManager = nullptr;
 
 public:
@@ -124,6 +124,21 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
 
 	// We're set up
 	apiInitialized = true;
+	Context.As(&Context1);
+	StateCache.SetContext(Context.Get(), Context1.Get());
+
+	// Constants can only share one buffer if parts of it can be bound, and
+	// mapped without discarding what earlier draws still need.  Otherwise
+	// each constant buffer keeps being updated on its own.
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+	if (Context1 &&
+		SUCCEEDED(Device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) &&
+		options.ConstantBufferOffsetting &&
+		options.MapNoOverwriteOnDynamicConstantBuffer)
+	{
+		ConstantRing.Initialize(Device.Get(), Context.Get(), 1024 * 1024, D3D11_BIND_CONSTANT_BUFFER);
+	}
+	InstanceRing.Initialize(Device.Get(), Context.Get(), 1024 * 1024, D3D11_BIND_VERTEX_BUFFER);
 
 	// Call ResizeBuffers(), which will also set up the 
 	// render target view and depth stencil view for the
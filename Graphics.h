@@ -1,9 +1,11 @@
 #pragma once
 
 #include <Windows.h>
-#include <d3d11.h>
+#include <d3d11_1.h>
 #include <string>
 #include <wrl/client.h>
+#include "PipelineStateCache.h"
+#include "UploadRing.h"
 
 #pragma comment(lib, "d3d11.lib")
 #pragma comment(lib, "dxgi.lib")
@@ -17,6 +19,16 @@ namespace Graphics
 	inline Microsoft::WRL::ComPtr<ID3D11DeviceContext> Context;
 	inline Microsoft::WRL::ComPtr<IDXGISwapChain> SwapChain;
 
+	// The same context through D3D11.1, null where that's missing
+	inline Microsoft::WRL::ComPtr<ID3D11DeviceContext1> Context1;
+
+	// Drops binds of what is already bound to Context
+	inline PipelineStateCache StateCache;
+
+	// Per frame data written back to back, constants only where they can be bound at an offset
+	inline UploadRing ConstantRing;
+	inline UploadRing InstanceRing;
+
 	// Rendering buffers
 	inline Microsoft::WRL::ComPtr<ID3D11RenderTargetView> BackBufferRTV;
 	inline Microsoft::WRL::ComPtr<ID3D11DepthStencilView> DepthBufferDSV;
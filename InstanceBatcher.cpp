@@ -0,0 +1,66 @@
+#include "InstanceBatcher.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+	bool SameKey(const InstanceKey& a_ikA, const InstanceKey& a_ikB)
+	{
+		return a_ikA.Mesh == a_ikB.Mesh && a_ikA.Material == a_ikB.Material && a_ikA.Lod == a_ikB.Lod;
+	}
+}
+
+unsigned int InstanceBatcher::Build(const InstanceKey* a_pKeys, size_t a_uCount, InstanceBatches& a_ibBatches, unsigned int a_uMinInstances)
+{
+	a_ibBatches.Order.clear();
+	a_ibBatches.Batches.clear();
+	a_ibBatches.Batched.assign(a_uCount, 0);
+
+	// Sorting the drawn entities so equal keys sit together.  Ties keep entity order,
+	// and the first entity of each group decides where the group goes.
+	std::vector<uint32_t> lSorted;
+	for (size_t i = 0; i < a_uCount; i++)
+	{
+		if (a_pKeys[i].Mesh != nullptr) lSorted.push_back(static_cast<uint32_t>(i));
+	}
+	std::less<const void*> pointerLess;
+	std::stable_sort(lSorted.begin(), lSorted.end(), [&](uint32_t a_uA, uint32_t a_uB)
+	{
+		const InstanceKey& a = a_pKeys[a_uA];
+		const InstanceKey& b = a_pKeys[a_uB];
+		if (a.Mesh != b.Mesh) return pointerLess(a.Mesh, b.Mesh);
+		if (a.Material != b.Material) return pointerLess(a.Material, b.Material);
+		return a.Lod < b.Lod;
+	});
+
+	// Keeping the groups large enough to be worth an instanced draw.
+	std::vector<InstanceBatch> lGroups;
+	for (size_t uStart = 0; uStart < lSorted.size();)
+	{
+		size_t uEnd = uStart + 1;
+		while (uEnd < lSorted.size() && SameKey(a_pKeys[lSorted[uStart]], a_pKeys[lSorted[uEnd]])) uEnd++;
+		if (uEnd - uStart >= a_uMinInstances)
+		{
+			lGroups.push_back({ static_cast<uint32_t>(uStart), static_cast<uint32_t>(uEnd - uStart) });
+		}
+		uStart = uEnd;
+	}
+	std::sort(lGroups.begin(), lGroups.end(), [&](const InstanceBatch& a_ibA, const InstanceBatch& a_ibB)
+	{
+		return lSorted[a_ibA.First] < lSorted[a_ibB.First];
+	});
+
+	// Laying the groups out back to back, which is also how their instance data is uploaded.
+	for (const InstanceBatch& group : lGroups)
+	{
+		a_ibBatches.Batches.push_back({ static_cast<uint32_t>(a_ibBatches.Order.size()), group.Count });
+		for (uint32_t i = 0; i < group.Count; i++)
+		{
+			uint32_t uEntity = lSorted[group.First + i];
+			a_ibBatches.Order.push_back(uEntity);
+			a_ibBatches.Batched[uEntity] = 1;
+		}
+	}
+	return static_cast<unsigned int>(a_ibBatches.Order.size());
+}
@@ -0,0 +1,59 @@
+#ifndef __INSTANCEBATCHER_H_
+#define __INSTANCEBATCHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// What has to match for two entities to share an instanced draw.
+/// </summary>
+struct InstanceKey
+{
+	const void* Mesh;					// Null if the entity is not drawn, or cannot be instanced.
+	const void* Material;				// Null when the pass ignores materials, as the shadow pass does.
+	uint32_t Lod;
+};
+
+/// <summary>
+/// A run of InstanceBatches::Order drawn with one DrawIndexedInstanced call.
+/// </summary>
+struct InstanceBatch
+{
+	uint32_t First;						// First entry of Order, and the first instance in the instance buffer.
+	uint32_t Count;
+};
+
+/// <summary>
+/// The batches of one pass.
+/// </summary>
+struct InstanceBatches
+{
+	std::vector<uint32_t> Order;			// Entity indices, batch after batch.
+	std::vector<InstanceBatch> Batches;
+	std::vector<unsigned char> Batched;		// One flag per entity, set if a batch draws it.
+};
+
+/// <summary>
+/// Groups entities with the same mesh, material and level of detail so each
+/// group can be drawn with a single instanced call.  Free of the graphics device.
+/// </summary>
+namespace InstanceBatcher
+{
+	// Smaller groups are left to draw one by one, a batch of one saves no draw
+	// calls and would still pay for its instance data.
+	const unsigned int MIN_INSTANCES = 2;
+
+	/// <summary>
+	/// Builds the batches of one pass.  Entities within a batch keep their
+	/// relative order, and batches are ordered by their first entity.
+	/// </summary>
+	/// <param name="a_pKeys">One key per entity.</param>
+	/// <param name="a_uCount">The amount of entities.</param>
+	/// <param name="a_ibBatches">Receives the batches, replacing what was there.</param>
+	/// <param name="a_uMinInstances">The fewest entities worth batching.</param>
+	/// <returns>The amount of entities the batches draw.</returns>
+	unsigned int Build(const InstanceKey* a_pKeys, size_t a_uCount, InstanceBatches& a_ibBatches, unsigned int a_uMinInstances = MIN_INSTANCES);
+}
+
+#endif //__INSTANCEBATCHER_H_
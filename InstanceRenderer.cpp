@@ -0,0 +1,183 @@
+#include "InstanceRenderer.h"
+
+#include "Graphics.h"
+#include "PathHelpers.h"
+#include <d3dcompiler.h>
+#include <cstddef>
+
+namespace
+{
+	/// <summary>
+	/// Adds the four rows of one per instance matrix to an input layout.
+	/// </summary>
+	void AddMatrix(std::vector<D3D11_INPUT_ELEMENT_DESC>& a_lElements, const char* a_sSemantic, UINT a_uOffset)
+	{
+		for (UINT uRow = 0; uRow < 4; uRow++)
+		{
+			D3D11_INPUT_ELEMENT_DESC element = {};
+			element.SemanticName = a_sSemantic;
+			element.SemanticIndex = uRow;
+			element.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+			element.InputSlot = 1;
+			element.AlignedByteOffset = a_uOffset + uRow * sizeof(DirectX::XMFLOAT4);
+			element.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
+			element.InstanceDataStepRate = 1;
+			a_lElements.push_back(element);
+		}
+	}
+}
+
+InstanceRenderer::InstanceRenderer(std::shared_ptr<SimpleVertexShader> a_pReplacedShader) :
+	m_pReplacedShader(a_pReplacedShader),
+	m_uaCameraInstances(),
+	m_uaShadowInstances()
+{
+	m_pVertexShader = std::make_shared<SimpleVertexShader>(
+		Graphics::Device, Graphics::Context, FixPath(L"InstancedVertexShader.cso").c_str(),
+		CreateInputLayout(FixPath(L"InstancedVertexShader.cso").c_str(), false), true);
+	m_pShadowVertexShader = std::make_shared<SimpleVertexShader>(
+		Graphics::Device, Graphics::Context, FixPath(L"InstancedShadowVertex.cso").c_str(),
+		CreateInputLayout(FixPath(L"InstancedShadowVertex.cso").c_str(), true), true);
+}
+
+Microsoft::WRL::ComPtr<ID3D11InputLayout> InstanceRenderer::CreateInputLayout(LPCWSTR a_sShaderFile, bool a_bShadow)
+{
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> pInputLayout;
+
+	// The layout is validated against the shader's input signature.
+	Microsoft::WRL::ComPtr<ID3DBlob> pShaderBlob;
+	if (FAILED(D3DReadFileToBlob(a_sShaderFile, pShaderBlob.GetAddressOf())))
+		return pInputLayout;
+
+	// The vertex stream, as in VertexShaderInput.
+	std::vector<D3D11_INPUT_ELEMENT_DESC> lElements(4);
+	lElements[0] = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(Vertex, Position), D3D11_INPUT_PER_VERTEX_DATA, 0 };
+	lElements[1] = { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(Vertex, Normal), D3D11_INPUT_PER_VERTEX_DATA, 0 };
+	lElements[2] = { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offsetof(Vertex, UV), D3D11_INPUT_PER_VERTEX_DATA, 0 };
+	lElements[3] = { "TANGENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(Vertex, Tangent), D3D11_INPUT_PER_VERTEX_DATA, 0 };
+
+	// The instance stream, one step per instance.
+	if (a_bShadow)
+	{
+		AddMatrix(lElements, "WORLD_VIEW_PROJECTION_PER_INSTANCE", 0);
+	}
+	else
+	{
+		AddMatrix(lElements, "WORLD_PER_INSTANCE", offsetof(InstanceData, World));
+		AddMatrix(lElements, "WORLD_INV_TRANSPOSE_PER_INSTANCE", offsetof(InstanceData, WorldInvTranspose));
+		AddMatrix(lElements, "WORLD_VIEW_PROJECTION_PER_INSTANCE", offsetof(InstanceData, WorldViewProjection));
+		AddMatrix(lElements, "WORLD_LIGHT_VIEW_PROJECTION_PER_INSTANCE", offsetof(InstanceData, WorldLightViewProjection));
+	}
+
+	Graphics::Device->CreateInputLayout(
+		lElements.data(),
+		static_cast<UINT>(lElements.size()),
+		pShaderBlob->GetBufferPointer(),
+		pShaderBlob->GetBufferSize(),
+		pInputLayout.GetAddressOf());
+	return pInputLayout;
+}
+
+void InstanceRenderer::Batch(
+	std::vector<Entity>& a_lEntities,
+	const unsigned char* a_pCameraVisible,
+	const unsigned char* a_pCameraLods,
+	const unsigned char* a_pShadowVisible,
+	const unsigned char* a_pShadowLods)
+{
+	size_t uCount = a_lEntities.size();
+	m_lKeys.resize(uCount);
+
+	// The main pass needs the same material, and one the instanced shader can stand in for.
+	for (size_t i = 0; i < uCount; i++)
+	{
+		Entity& e = a_lEntities[i];
+		Mesh* pMesh = e.GetMesh().get();
+		Material* pMaterial = e.GetMaterial().get();
+		bool bInstanced = a_pCameraVisible[i] && !pMesh->IsCompressed() && pMaterial->GetVertexShader() == m_pReplacedShader;
+		m_lKeys[i] = { bInstanced ? pMesh : nullptr, pMaterial, a_pCameraLods[i] };
+	}
+	InstanceBatcher::Build(m_lKeys.data(), uCount, m_ibCamera);
+
+	// The shadow pass draws depth alone, so any material will do.
+	for (size_t i = 0; i < uCount; i++)
+	{
+		Mesh* pMesh = a_lEntities[i].GetMesh().get();
+		bool bInstanced = a_pShadowVisible[i] && !pMesh->IsCompressed();
+		m_lKeys[i] = { bInstanced ? pMesh : nullptr, nullptr, a_pShadowLods[i] };
+	}
+	InstanceBatcher::Build(m_lKeys.data(), uCount, m_ibShadow);
+
+	// Copying the matrices the transforms already worked out for the frame, batch after batch,
+	// into the instance ring behind whatever the GPU may still be reading.
+	unsigned int uCameraCount = static_cast<unsigned int>(m_ibCamera.Order.size());
+	if (uCameraCount > 0)
+	{
+		InstanceData* pInstances = static_cast<InstanceData*>(Graphics::InstanceRing.Map(uCameraCount * sizeof(InstanceData), 16, m_uaCameraInstances));
+		if (pInstances == nullptr)
+		{
+			m_ibCamera.Batches.clear();
+			m_ibCamera.Order.clear();
+			m_ibCamera.Batched.assign(uCount, 0);
+		}
+		else
+		{
+			for (unsigned int i = 0; i < uCameraCount; i++)
+			{
+				TransformHandle transform = a_lEntities[m_ibCamera.Order[i]].GetTransform();
+				pInstances[i].World = transform.GetWorldMatrix();
+				pInstances[i].WorldInvTranspose = transform.GetWorldInverseTransposeMatrix();
+				pInstances[i].WorldViewProjection = transform.GetWorldViewProjectionMatrix();
+				pInstances[i].WorldLightViewProjection = transform.GetWorldLightViewProjectionMatrix();
+			}
+			Graphics::InstanceRing.Unmap();
+		}
+	}
+
+	unsigned int uShadowCount = static_cast<unsigned int>(m_ibShadow.Order.size());
+	if (uShadowCount > 0)
+	{
+		DirectX::XMFLOAT4X4* pInstances = static_cast<DirectX::XMFLOAT4X4*>(Graphics::InstanceRing.Map(uShadowCount * sizeof(DirectX::XMFLOAT4X4), 16, m_uaShadowInstances));
+		if (pInstances == nullptr)
+		{
+			m_ibShadow.Batches.clear();
+			m_ibShadow.Order.clear();
+			m_ibShadow.Batched.assign(uCount, 0);
+		}
+		else
+		{
+			for (unsigned int i = 0; i < uShadowCount; i++)
+			{
+				pInstances[i] = a_lEntities[m_ibShadow.Order[i]].GetTransform().GetWorldLightViewProjectionMatrix();
+			}
+			Graphics::InstanceRing.Unmap();
+		}
+	}
+}
+
+const InstanceBatches& InstanceRenderer::GetCameraBatches(void) { return m_ibCamera; }
+const InstanceBatches& InstanceRenderer::GetShadowBatches(void) { return m_ibShadow; }
+
+std::shared_ptr<SimpleVertexShader> InstanceRenderer::GetVertexShader(void) { return m_pVertexShader; }
+std::shared_ptr<SimpleVertexShader> InstanceRenderer::GetShadowVertexShader(void) { return m_pShadowVertexShader; }
+
+void InstanceRenderer::DrawCameraBatch(std::vector<Entity>& a_lEntities, const unsigned char* a_pCameraLods, unsigned int a_uBatch)
+{
+	// Slot 1 is ignored by the input layouts that draw one entity at a time, so it can stay bound.
+	Graphics::StateCache.SetVertexBuffer(1, m_uaCameraInstances.Buffer, sizeof(InstanceData), m_uaCameraInstances.Offset);
+
+	// Every entity of a batch shares the first one's mesh, material and level of detail.
+	const InstanceBatch& batch = m_ibCamera.Batches[a_uBatch];
+	unsigned int uFirst = m_ibCamera.Order[batch.First];
+	a_lEntities[uFirst].DrawInstanced(m_pVertexShader, a_pCameraLods[uFirst], batch.Count, batch.First);
+}
+
+void InstanceRenderer::DrawShadowBatch(std::vector<Entity>& a_lEntities, const unsigned char* a_pShadowLods, unsigned int a_uBatch)
+{
+	Graphics::StateCache.SetVertexBuffer(1, m_uaShadowInstances.Buffer, sizeof(DirectX::XMFLOAT4X4), m_uaShadowInstances.Offset);
+	m_pShadowVertexShader->SetShader();
+
+	const InstanceBatch& batch = m_ibShadow.Batches[a_uBatch];
+	unsigned int uFirst = m_ibShadow.Order[batch.First];
+	a_lEntities[uFirst].GetMesh()->DrawInstanced(a_pShadowLods[uFirst], batch.Count, batch.First);
+}
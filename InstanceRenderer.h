@@ -0,0 +1,117 @@
+#ifndef __INSTANCERENDERER_H_
+#define __INSTANCERENDERER_H_
+
+#include <d3d11.h>
+#include <memory>
+#include <vector>
+#include <wrl/client.h>
+#include <DirectXMath.h>
+
+#include "Entity.h"
+#include "SimpleShader.h"
+#include "InstanceBatcher.h"
+#include "UploadRing.h"
+
+// Set on a render queue value that holds a batch index instead of an entity index.
+const uint32_t INSTANCE_BATCH_FLAG = 0x80000000u;
+
+/// <summary>
+/// Per instance data of the main pass, read by InstancedVertexShader.hlsl.
+/// The shadow pass only uploads WorldLightViewProjection.
+/// </summary>
+struct InstanceData
+{
+	DirectX::XMFLOAT4X4 World;
+	DirectX::XMFLOAT4X4 WorldInvTranspose;
+	DirectX::XMFLOAT4X4 WorldViewProjection;
+	DirectX::XMFLOAT4X4 WorldLightViewProjection;
+};
+
+/// <summary>
+/// Draws entities that share a mesh, material and level of detail with one
+/// DrawIndexedInstanced call per group, in the main pass and the shadow pass.
+/// Only meshes with full float vertices are batched, and in the main pass only
+/// materials using the vertex shader the instanced one stands in for.
+/// </summary>
+class InstanceRenderer
+{
+private:
+	std::shared_ptr<SimpleVertexShader> m_pReplacedShader;
+	std::shared_ptr<SimpleVertexShader> m_pVertexShader;
+	std::shared_ptr<SimpleVertexShader> m_pShadowVertexShader;
+	UploadAllocation m_uaCameraInstances;		// This frame's, in the instance ring.
+	UploadAllocation m_uaShadowInstances;
+	std::vector<InstanceKey> m_lKeys;
+	InstanceBatches m_ibCamera;
+	InstanceBatches m_ibShadow;
+
+	/// <summary>
+	/// Creates the input layout of an instanced shader, the vertex in slot 0 and
+	/// the given matrices of InstanceData in slot 1.
+	/// </summary>
+	/// <param name="a_sShaderFile">The compiled shader the layout is validated against.</param>
+	/// <param name="a_bShadow">Only the light matrix, laid out back to back, instead of all of InstanceData.</param>
+	static Microsoft::WRL::ComPtr<ID3D11InputLayout> CreateInputLayout(LPCWSTR a_sShaderFile, bool a_bShadow);
+
+public:
+	/// <summary>
+	/// Loads the instanced shaders.
+	/// </summary>
+	/// <param name="a_pReplacedShader">Materials with this vertex shader can be drawn instanced.</param>
+	InstanceRenderer(std::shared_ptr<SimpleVertexShader> a_pReplacedShader);
+
+	/// <summary>
+	/// Groups the entities of both passes and uploads their instance data.
+	/// Call after the levels of detail are chosen and the transforms' view
+	/// projections are calculated for the frame.
+	/// </summary>
+	/// <param name="a_lEntities">Every entity.</param>
+	/// <param name="a_pCameraVisible">One flag per entity for the main pass.</param>
+	/// <param name="a_pCameraLods">One level of detail per entity for the main pass.</param>
+	/// <param name="a_pShadowVisible">One flag per entity for the shadow pass.</param>
+	/// <param name="a_pShadowLods">One level of detail per entity for the shadow pass.</param>
+	void Batch(
+		std::vector<Entity>& a_lEntities,
+		const unsigned char* a_pCameraVisible,
+		const unsigned char* a_pCameraLods,
+		const unsigned char* a_pShadowVisible,
+		const unsigned char* a_pShadowLods);
+
+	/// <summary>
+	/// Gets the main pass batches of the last Batch() call.
+	/// </summary>
+	const InstanceBatches& GetCameraBatches(void);
+
+	/// <summary>
+	/// Gets the shadow pass batches of the last Batch() call.
+	/// </summary>
+	const InstanceBatches& GetShadowBatches(void);
+
+	/// <summary>
+	/// Gets the shader drawing the main pass batches.
+	/// </summary>
+	std::shared_ptr<SimpleVertexShader> GetVertexShader(void);
+
+	/// <summary>
+	/// Gets the shader drawing the shadow pass batches.
+	/// </summary>
+	std::shared_ptr<SimpleVertexShader> GetShadowVertexShader(void);
+
+	/// <summary>
+	/// Draws one main pass batch with its first entity's material.
+	/// </summary>
+	/// <param name="a_lEntities">The entities given to Batch().</param>
+	/// <param name="a_pCameraLods">The levels of detail given to Batch().</param>
+	/// <param name="a_uBatch">Which of the camera batches to draw.</param>
+	void DrawCameraBatch(std::vector<Entity>& a_lEntities, const unsigned char* a_pCameraLods, unsigned int a_uBatch);
+
+	/// <summary>
+	/// Draws one shadow pass batch into whatever depth target is bound.
+	/// </summary>
+	/// <param name="a_lEntities">The entities given to Batch().</param>
+	/// <param name="a_pShadowLods">The levels of detail given to Batch().</param>
+	/// <param name="a_uBatch">Which of the shadow batches to draw.</param>
+	void DrawShadowBatch(std::vector<Entity>& a_lEntities, const unsigned char* a_pShadowLods, unsigned int a_uBatch);
+};
+
+#endif //__INSTANCERENDERER_H_
@@ -0,0 +1,8 @@
+#include "ShaderFunctions.hlsli"
+
+// Same as ShadowVertex.hlsl, with the world * light view projection of each
+// entity read from the instance buffer as four rows.
+float4 main(VertexShaderInput input, row_major float4x4 worldViewProjection : WORLD_VIEW_PROJECTION_PER_INSTANCE) : SV_POSITION
+{
+    return mul(float4(input.localPosition, 1.0f), worldViewProjection);
+}
@@ -0,0 +1,28 @@
+#include "ShaderFunctions.hlsli"
+
+// One per entity of the batch, see InstanceData in InstanceRenderer.h.  Each
+// matrix arrives as four rows, the way DirectXMath lays it out in memory.
+struct InstanceInput
+{
+    row_major float4x4 world : WORLD_PER_INSTANCE;
+    row_major float4x4 worldInvTranspose : WORLD_INV_TRANSPOSE_PER_INSTANCE;
+    row_major float4x4 worldViewProjection : WORLD_VIEW_PROJECTION_PER_INSTANCE;
+    row_major float4x4 worldLightViewProjection : WORLD_LIGHT_VIEW_PROJECTION_PER_INSTANCE;
+};
+
+// Same as VertexShader.hlsl, but with the matrices read from the instance buffer.
+VertexToPixel main( VertexShaderInput input, InstanceInput instance )
+{
+	// Set up output struct
+	VertexToPixel output;
+    
+	// Row vectors on the left, as the rows came in.
+	output.screenPosition = mul(float4(input.localPosition, 1.0f), instance.worldViewProjection);
+    output.normal = normalize(mul(input.normal, (float3x3) instance.worldInvTranspose));
+    output.uv = input.uv;
+    output.worldPos = mul(float4(input.localPosition, 1.0f), instance.world).xyz;
+    output.tangent = float4(normalize(mul(input.tangent.xyz, (float3x3) instance.world)), input.tangent.w);
+    output.shadowMapPos = mul(float4(input.localPosition, 1.0f), instance.worldLightViewProjection);
+	
+	return output;
+}
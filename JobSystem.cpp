@@ -0,0 +1,47 @@
+#include "JobSystem.h"
+
+JobSystem::JobSystem(unsigned int a_uThreadCount) :
+	m_bStopping(false)
+{
+	m_lWorkers.reserve(a_uThreadCount);
+	for (unsigned int i = 0; i < a_uThreadCount; i++)
+	{
+		m_lWorkers.emplace_back(&JobSystem::WorkerLoop, this);
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mQueueLock);
+		m_bStopping = true;
+	}
+	m_cvJobAdded.notify_all();
+
+	for (std::thread& worker : m_lWorkers)
+		worker.join();
+}
+
+unsigned int JobSystem::GetThreadCount(void) const
+{
+	return static_cast<unsigned int>(m_lWorkers.size());
+}
+
+void JobSystem::WorkerLoop(void)
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			// Sleeping until there is work, draining the queue before stopping.
+			std::unique_lock<std::mutex> lock(m_mQueueLock);
+			m_cvJobAdded.wait(lock, [this]() { return m_bStopping || !m_qJobs.empty(); });
+			if (m_qJobs.empty()) return;
+
+			job = std::move(m_qJobs.front());
+			m_qJobs.pop();
+		}
+
+		job();
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef __JOBSYSTEM_H_
+#define __JOBSYSTEM_H_
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/// <summary>
+/// Fixed size pool of worker threads pulling jobs off a shared queue.  Jobs
+/// must not touch the device context, only the thread that owns it may.
+/// </summary>
+class JobSystem
+{
+private:
+	std::vector<std::thread> m_lWorkers;
+	std::queue<std::function<void()>> m_qJobs;
+	std::mutex m_mQueueLock;
+	std::condition_variable m_cvJobAdded;
+	bool m_bStopping;
+
+public:
+	/// <summary>
+	/// Starts the worker threads.
+	/// </summary>
+	/// <param name="a_uThreadCount">Amount of workers.  0 runs every job inline on Submit, which is the serial baseline.</param>
+	JobSystem(unsigned int a_uThreadCount = std::thread::hardware_concurrency());
+
+	/// <summary>
+	/// Finishes every queued job, then joins the workers.
+	/// </summary>
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	/// <summary>
+	/// Gets the amount of worker threads.
+	/// </summary>
+	/// <returns>0 if jobs run inline.</returns>
+	unsigned int GetThreadCount(void) const;
+
+	/// <summary>
+	/// Queues a job for the workers.
+	/// </summary>
+	/// <param name="a_fJob">The work to do.  Any exception it throws is rethrown from the future's get().</param>
+	/// <returns>A future holding the job's result.</returns>
+	template<typename Job>
+	std::future<std::invoke_result_t<Job>> Submit(Job a_fJob)
+	{
+		typedef std::invoke_result_t<Job> Result;
+
+		// packaged_task is move-only but std::function needs to be copyable.
+		std::shared_ptr<std::packaged_task<Result()>> pTask =
+			std::make_shared<std::packaged_task<Result()>>(std::move(a_fJob));
+		std::future<Result> future = pTask->get_future();
+
+		if (m_lWorkers.empty())
+		{
+			(*pTask)();
+			return future;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mQueueLock);
+			m_qJobs.push([pTask]() { (*pTask)(); });
+		}
+		m_cvJobAdded.notify_one();
+		return future;
+	}
+
+private:
+	void WorkerLoop(void);
+};
+
+#endif //__JOBSYSTEM_H_
@@ -7,6 +7,9 @@
 #define LIGHT_TYPE_POINT 1
 #define LIGHT_TYPE_SPOT 2
 
+// The most lights the shaders take, see SceneConstants.hlsli.
+#define MAX_LIGHT_COUNT 5
+
 /// <summary>
 /// Defines all necessary values for a light in the world.
 /// </summary>
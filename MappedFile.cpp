@@ -0,0 +1,130 @@
+#include "MappedFile.h"
+
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const char* a_sFilepath) :
+	m_pData(nullptr),
+	m_uSize(0),
+	m_bIsMapped(false)
+#ifdef _WIN32
+	, m_pFileHandle(INVALID_HANDLE_VALUE),
+	m_pMappingHandle(nullptr)
+#endif
+{
+	// Mapping is preferred, but any failure (network drives, empty files, etc.)
+	// falls back to just reading the whole file into memory.
+	if (!Map(a_sFilepath))
+	{
+		ReadFallback(a_sFilepath);
+	}
+}
+
+MappedFile::~MappedFile()
+{
+	if (!m_bIsMapped) return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(m_pData);
+	CloseHandle(m_pMappingHandle);
+	CloseHandle(m_pFileHandle);
+#else
+	munmap(const_cast<char*>(m_pData), m_uSize);
+#endif
+}
+
+bool MappedFile::IsOpen(void) const { return m_pData != nullptr; }
+bool MappedFile::IsMapped(void) const { return m_bIsMapped; }
+const char* MappedFile::GetData(void) const { return m_pData; }
+size_t MappedFile::GetSize(void) const { return m_uSize; }
+
+bool MappedFile::Map(const char* a_sFilepath)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(
+		a_sFilepath,
+		GENERIC_READ,
+		FILE_SHARE_READ,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+		nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	// Zero length files cannot be mapped.
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (view == nullptr)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	m_pFileHandle = file;
+	m_pMappingHandle = mapping;
+	m_pData = static_cast<const char*>(view);
+	m_uSize = static_cast<size_t>(size.QuadPart);
+#else
+	int file = open(a_sFilepath, O_RDONLY);
+	if (file < 0) return false;
+
+	// Zero length files cannot be mapped.
+	struct stat info = {};
+	if (fstat(file, &info) != 0 || info.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (view == MAP_FAILED) return false;
+
+	// The whole file is about to be read front to back.
+	madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+	m_pData = static_cast<const char*>(view);
+	m_uSize = static_cast<size_t>(info.st_size);
+#endif
+
+	m_bIsMapped = true;
+	return true;
+}
+
+bool MappedFile::ReadFallback(const char* a_sFilepath)
+{
+	std::ifstream file(a_sFilepath, std::ios::binary | std::ios::ate);
+	if (!file.is_open()) return false;
+
+	// Sizing the buffer to the whole file and reading it in one go.
+	std::streamsize size = file.tellg();
+	file.seekg(0, std::ios::beg);
+	m_lFallbackData.resize(static_cast<size_t>(size) + 1);
+	if (size > 0 && !file.read(m_lFallbackData.data(), size)) return false;
+
+	m_pData = m_lFallbackData.data();
+	m_uSize = static_cast<size_t>(size);
+	return true;
+}
@@ -0,0 +1,64 @@
+#ifndef __MAPPEDFILE_H_
+#define __MAPPEDFILE_H_
+
+#include <cstddef>
+#include <vector>
+
+/// <summary>
+/// Read-only view of an entire file on disk.  The file is memory-mapped when
+/// the platform allows it and read through an std::ifstream otherwise.
+/// </summary>
+class MappedFile
+{
+private:
+	const char* m_pData;
+	size_t m_uSize;
+	bool m_bIsMapped;
+	std::vector<char> m_lFallbackData;
+
+#ifdef _WIN32
+	void* m_pFileHandle;
+	void* m_pMappingHandle;
+#endif
+
+public:
+	/// <summary>
+	/// Opens and maps the file at the passed in path.
+	/// </summary>
+	/// <param name="a_sFilepath">Path to the file being read.</param>
+	MappedFile(const char* a_sFilepath);
+
+	/// <summary>
+	/// Unmaps the file and closes any open handles.
+	/// </summary>
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/// <summary>
+	/// Whether or not the file was opened successfully.
+	/// </summary>
+	bool IsOpen(void) const;
+
+	/// <summary>
+	/// Whether or not the contents are backed by a memory mapping rather than a copy.
+	/// </summary>
+	bool IsMapped(void) const;
+
+	/// <summary>
+	/// Gets a pointer to the first byte of the file.
+	/// </summary>
+	const char* GetData(void) const;
+
+	/// <summary>
+	/// Gets the size of the file in bytes.
+	/// </summary>
+	size_t GetSize(void) const;
+
+private:
+	bool Map(const char* a_sFilepath);
+	bool ReadFallback(const char* a_sFilepath);
+};
+
+#endif //__MAPPEDFILE_H_
@@ -1,5 +1,28 @@
 #include "Material.h"
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace
+{
+	/// <summary>
+	/// Sorts the bound values by register and splits them into runs of neighbouring registers.
+	/// </summary>
+	template<typename T>
+	void BuildRanges(std::vector<std::pair<unsigned int, T*>>& a_lBinds, std::vector<T*>& a_lSlots, std::vector<MaterialBindRange>& a_lRanges)
+	{
+		std::sort(a_lBinds.begin(), a_lBinds.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+		for (const auto& bind : a_lBinds)
+		{
+			if (a_lRanges.empty() || a_lRanges.back().FirstSlot + a_lRanges.back().Count != bind.first)
+				a_lRanges.push_back({ bind.first, 0, static_cast<unsigned int>(a_lSlots.size()) });
+			a_lRanges.back().Count++;
+			a_lSlots.push_back(bind.second);
+		}
+	}
+}
+
 Material::Material(
 	std::shared_ptr<SimpleVertexShader> a_pVertexShader,
 	std::shared_ptr<SimplePixelShader> a_pPixelShader, 
@@ -12,6 +35,7 @@ Material::Material(
 	m_mTextureSRVs = std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>>();
 	m_mSamplers = std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>>();
 	m_fRoughness = a_fRoughness;
+	Bake();
 }
 
 Material::~Material()
@@ -31,6 +55,15 @@ Material::Material(const Material& a_pOther)
 	m_fRoughness = a_pOther.m_fRoughness;
 	m_fScale = a_pOther.m_fScale;
 	m_fOffset = a_pOther.m_fOffset;
+	m_lTextureSlots = a_pOther.m_lTextureSlots;
+	m_lTextureRanges = a_pOther.m_lTextureRanges;
+	m_lSamplerSlots = a_pOther.m_lSamplerSlots;
+	m_lSamplerRanges = a_pOther.m_lSamplerRanges;
+	m_lConstantBlock = a_pOther.m_lConstantBlock;
+	m_iBlockBuffer = a_pOther.m_iBlockBuffer;
+	m_uBlockOffset = a_pOther.m_uBlockOffset;
+	m_mblLayout = a_pOther.m_mblLayout;
+	m_mshHandles = a_pOther.m_mshHandles;
 }
 
 Material& Material::operator=(const Material& a_pOther)
@@ -45,8 +78,18 @@ Material& Material::operator=(const Material& a_pOther)
 	m_v4ColorTint = a_pOther.m_v4ColorTint;
 	m_mTextureSRVs = a_pOther.m_mTextureSRVs;
 	m_mSamplers = a_pOther.m_mSamplers;
+	m_fRoughness = a_pOther.m_fRoughness;
 	m_fScale = a_pOther.m_fScale;
 	m_fOffset = a_pOther.m_fOffset;
+	m_lTextureSlots = a_pOther.m_lTextureSlots;
+	m_lTextureRanges = a_pOther.m_lTextureRanges;
+	m_lSamplerSlots = a_pOther.m_lSamplerSlots;
+	m_lSamplerRanges = a_pOther.m_lSamplerRanges;
+	m_lConstantBlock = a_pOther.m_lConstantBlock;
+	m_iBlockBuffer = a_pOther.m_iBlockBuffer;
+	m_uBlockOffset = a_pOther.m_uBlockOffset;
+	m_mblLayout = a_pOther.m_mblLayout;
+	m_mshHandles = a_pOther.m_mshHandles;
 
 	return *this;
 }
@@ -55,6 +98,7 @@ std::shared_ptr<SimpleVertexShader> Material::GetVertexShader() { return m_pVert
 std::shared_ptr<SimplePixelShader> Material::GetPixelShader() { return m_pPixelShader; }
 DirectX::XMFLOAT4 Material::GetColor() { return m_v4ColorTint; }
 float Material::GetRoughness() { return m_fRoughness; }
+const MaterialShaderHandles& Material::GetHandles() const { return m_mshHandles; }
 
 DirectX::XMFLOAT2 Material::GetScale()
 {
@@ -69,32 +113,118 @@ DirectX::XMFLOAT2 Material::GetOffset()
 void Material::SetScale(DirectX::XMFLOAT2 a_fScale)
 {
 	m_fScale = a_fScale;
+	PackConstants();
 }
 
 void Material::SetOffset(DirectX::XMFLOAT2 a_fOffset)
 {
 	m_fOffset = a_fOffset;
+	PackConstants();
 }
 
 std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> Material::GetTextures()
 { return m_mTextureSRVs; }
 
-void Material::SetVertexShader(std::shared_ptr<SimpleVertexShader> a_pVertexShader) { m_pVertexShader = a_pVertexShader; }
-void Material::SetPixelShader(std::shared_ptr<SimplePixelShader> a_pPixelShader) { m_pPixelShader = a_pPixelShader; }
-void Material::SetColor(DirectX::XMFLOAT4 a_v4ColorTint) { m_v4ColorTint = a_v4ColorTint; }
+void Material::SetVertexShader(std::shared_ptr<SimpleVertexShader> a_pVertexShader) { m_pVertexShader = a_pVertexShader; Bake(); }
+void Material::SetPixelShader(std::shared_ptr<SimplePixelShader> a_pPixelShader) { m_pPixelShader = a_pPixelShader; Bake(); }
+void Material::SetColor(DirectX::XMFLOAT4 a_v4ColorTint) { m_v4ColorTint = a_v4ColorTint; PackConstants(); }
 
 void Material::AddTexturesSRV(std::string a_sTextureName, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_pSRV)
 {
-	m_mTextureSRVs.insert({ a_sTextureName, a_pSRV });
+	if (m_mTextureSRVs.insert({ a_sTextureName, a_pSRV }).second) Bake();
 }
 
 void Material::AddSampler(std::string a_sSamplerName, Microsoft::WRL::ComPtr<ID3D11SamplerState> a_pSampler)
 {
-	m_mSamplers.insert({ a_sSamplerName, a_pSampler });
+	if (m_mSamplers.insert({ a_sSamplerName, a_pSampler }).second) Bake();
 }
 
 void Material::PrepMaterialForDraw()
 {
-	for (const auto& t : m_mTextureSRVs) { m_pPixelShader->SetShaderResourceView(t.first.c_str(), t.second); }
-	for (const auto& s : m_mSamplers) { m_pPixelShader->SetSamplerState(s.first.c_str(), s.second); }
+	for (const MaterialBindRange& r : m_lTextureRanges) { m_pPixelShader->SetShaderResourceViews(r.FirstSlot, r.Count, &m_lTextureSlots[r.Start]); }
+	for (const MaterialBindRange& r : m_lSamplerRanges) { m_pPixelShader->SetSamplerStates(r.FirstSlot, r.Count, &m_lSamplerSlots[r.Start]); }
+	if (m_iBlockBuffer >= 0)
+		m_pPixelShader->SetBufferData(m_iBlockBuffer, m_uBlockOffset, m_lConstantBlock.data(), static_cast<unsigned int>(m_lConstantBlock.size()));
+}
+
+void Material::Bake()
+{
+	m_mshHandles = MaterialShaderHandles();
+	m_lTextureSlots.clear();
+	m_lTextureRanges.clear();
+	m_lSamplerSlots.clear();
+	m_lSamplerRanges.clear();
+	m_lConstantBlock.clear();
+	m_iBlockBuffer = -1;
+	m_uBlockOffset = 0;
+	m_mblLayout = MaterialBlockLayout();
+
+	if (m_pVertexShader)
+	{
+		m_mshHandles.World = m_pVertexShader->GetVariableHandle("world");
+		m_mshHandles.WorldInvTranspose = m_pVertexShader->GetVariableHandle("worldInvTranspose");
+		m_mshHandles.WorldViewProjection = m_pVertexShader->GetVariableHandle("worldViewProjection");
+		m_mshHandles.WorldLightViewProjection = m_pVertexShader->GetVariableHandle("worldLightViewProjection");
+		m_mshHandles.BoundsMin = m_pVertexShader->GetVariableHandle("boundsMin");
+		m_mshHandles.BoundsExtent = m_pVertexShader->GetVariableHandle("boundsExtent");
+	}
+	if (!m_pPixelShader) return;
+
+	// Textures and samplers the pixel shader does not use are dropped, as binding them by name did nothing.
+	std::vector<std::pair<unsigned int, ID3D11ShaderResourceView*>> lTextures;
+	for (const auto& t : m_mTextureSRVs)
+	{
+		const SimpleSRV* pSRV = m_pPixelShader->GetShaderResourceViewInfo(t.first);
+		if (pSRV) lTextures.push_back({ pSRV->BindIndex, t.second.Get() });
+	}
+	BuildRanges(lTextures, m_lTextureSlots, m_lTextureRanges);
+	std::vector<std::pair<unsigned int, ID3D11SamplerState*>> lSamplers;
+	for (const auto& s : m_mSamplers)
+	{
+		const SimpleSampler* pSampler = m_pPixelShader->GetSamplerInfo(s.first);
+		if (pSampler) lSamplers.push_back({ pSampler->BindIndex, s.second.Get() });
+	}
+	BuildRanges(lSamplers, m_lSamplerSlots, m_lSamplerRanges);
+
+	// The parameters share one constant buffer, and the block spans only the bytes from the first
+	// to the last of them, so copying it in leaves the rest of the buffer alone.
+	const SimpleShaderVariable* pVariables[] = {
+		m_pPixelShader->GetVariableInfo("colorTint"),
+		m_pPixelShader->GetVariableInfo("roughness"),
+		m_pPixelShader->GetVariableInfo("scale"),
+		m_pPixelShader->GetVariableInfo("offset") };
+	const unsigned int uSizes[] = { sizeof(m_v4ColorTint), sizeof(m_fRoughness), sizeof(m_fScale), sizeof(m_fOffset) };
+	int* pOffsets[] = { &m_mblLayout.ColorTint, &m_mblLayout.Roughness, &m_mblLayout.Scale, &m_mblLayout.Offset };
+	unsigned int uEnd = 0;
+	for (size_t i = 0; i < 4; i++)
+	{
+		const SimpleShaderVariable* pVariable = pVariables[i];
+		if (!pVariable || pVariable->Size < uSizes[i]) continue;
+		if (m_iBlockBuffer < 0)
+		{
+			m_iBlockBuffer = static_cast<int>(pVariable->ConstantBufferIndex);
+			m_uBlockOffset = pVariable->ByteOffset;
+		}
+		if (pVariable->ConstantBufferIndex != static_cast<unsigned int>(m_iBlockBuffer)) continue;
+		*pOffsets[i] = static_cast<int>(pVariable->ByteOffset);
+		if (pVariable->ByteOffset < m_uBlockOffset) m_uBlockOffset = pVariable->ByteOffset;
+		if (pVariable->ByteOffset + uSizes[i] > uEnd) uEnd = pVariable->ByteOffset + uSizes[i];
+	}
+	if (m_iBlockBuffer < 0) return;
+	for (int* pOffset : pOffsets)
+	{
+		if (*pOffset >= 0) *pOffset -= static_cast<int>(m_uBlockOffset);
+	}
+	m_lConstantBlock.assign(uEnd - m_uBlockOffset, 0);
+	PackConstants();
+}
+
+void Material::PackConstants()
+{
+	if (m_lConstantBlock.empty()) return;
+	unsigned char* pBlock = m_lConstantBlock.data();
+	if (m_mblLayout.ColorTint >= 0) memcpy(pBlock + m_mblLayout.ColorTint, &m_v4ColorTint, sizeof(m_v4ColorTint));
+	if (m_mblLayout.Roughness >= 0) memcpy(pBlock + m_mblLayout.Roughness, &m_fRoughness, sizeof(m_fRoughness));
+	if (m_mblLayout.Scale >= 0) memcpy(pBlock + m_mblLayout.Scale, &m_fScale, sizeof(m_fScale));
+	if (m_mblLayout.Offset >= 0) memcpy(pBlock + m_mblLayout.Offset, &m_fOffset, sizeof(m_fOffset));
 }
@@ -3,8 +3,46 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 #include "SimpleShader.h"
 
+/// <summary>
+/// The variables set on a material's vertex shader every draw, found by name
+/// once whenever a shader changes.  Invalid for variables a shader does not have.
+/// </summary>
+struct MaterialShaderHandles
+{
+	SimpleVariableHandle World;
+	SimpleVariableHandle WorldInvTranspose;
+	SimpleVariableHandle WorldViewProjection;
+	SimpleVariableHandle WorldLightViewProjection;
+	SimpleVariableHandle BoundsMin;
+	SimpleVariableHandle BoundsExtent;
+};
+
+/// <summary>
+/// A run of neighbouring registers bound with one call, taking its values
+/// from a material's flat list of textures or samplers.
+/// </summary>
+struct MaterialBindRange
+{
+	unsigned int FirstSlot;
+	unsigned int Count;
+	unsigned int Start;					// Position of the first value in the list.
+};
+
+/// <summary>
+/// Where a material's parameters sit in its constant block, -1 for any the
+/// pixel shader does not have.
+/// </summary>
+struct MaterialBlockLayout
+{
+	int ColorTint = -1;
+	int Roughness = -1;
+	int Scale = -1;
+	int Offset = -1;
+};
+
 class Material
 {
 private:
@@ -19,6 +57,33 @@ private:
 	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> m_mTextureSRVs;
 	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>> m_mSamplers;
 
+	// The same textures and samplers baked against the pixel shader, ordered by register.  The
+	// maps above hold the references, these only what is bound.
+	std::vector<ID3D11ShaderResourceView*> m_lTextureSlots;
+	std::vector<MaterialBindRange> m_lTextureRanges;
+	std::vector<ID3D11SamplerState*> m_lSamplerSlots;
+	std::vector<MaterialBindRange> m_lSamplerRanges;
+
+	// The parameters packed as the pixel shader's constant buffer lays them out, covering
+	// the bytes from m_uBlockOffset on in buffer m_iBlockBuffer, -1 if it has none of them.
+	std::vector<unsigned char> m_lConstantBlock;
+	int m_iBlockBuffer = -1;
+	unsigned int m_uBlockOffset = 0;
+	MaterialBlockLayout m_mblLayout;
+
+	MaterialShaderHandles m_mshHandles;
+
+	/// <summary>
+	/// Finds the per draw variables in the current shaders, and flattens the
+	/// textures, samplers and parameters into what binding them needs.
+	/// </summary>
+	void Bake();
+
+	/// <summary>
+	/// Writes the parameters into the constant block.
+	/// </summary>
+	void PackConstants();
+
 public:
 	/// <summary>
 	/// Constructs an instance of a Material for applying shaders to specific Meshes.
@@ -64,6 +129,10 @@ public:
 	/// Gets the roughness of the material.
 	/// </summary>
 	float GetRoughness();
+	/// <summary>
+	/// Gets the handles of the variables set every draw.
+	/// </summary>
+	const MaterialShaderHandles& GetHandles() const;
 
 	/// <summary>
 	/// Gets the scale of the material's textures.
@@ -116,7 +185,9 @@ public:
 	void AddSampler(std::string a_sSamplerName, Microsoft::WRL::ComPtr<ID3D11SamplerState> a_pSampler);
 
 	/// <summary>
-	/// Sets all members from the unordered_maps for texture rendering.
+	/// Binds the textures and samplers, and copies the parameters into the pixel
+	/// shader's constant buffer, which is uploaded only if they differ from
+	/// what it last held.
 	/// </summary>
 	void PrepMaterialForDraw();
 };
@@ -1,12 +1,49 @@
 #include "Mesh.h"
 
 #include "Graphics.h"
+#include "ObjLoader.h"
+#include "MeshCache.h"
+#include "VertexCompression.h"
+#include "TangentGenerator.h"
+#include <cmath>
 #include <vector>
-#include <fstream>
+#include <stdexcept>
 
 using namespace DirectX;
 
-Mesh::Mesh(Vertex* a_pVertices, int a_dVertexCount, unsigned int* a_pIndices, int a_dIndexCount)
+namespace
+{
+	// Bits of MeshCacheHeader::OptionFlags, so a cache built with different options is rebuilt.
+	const uint32_t g_uCacheOptimizedFlag = 1u << 0;
+	const uint32_t g_uCacheLodsFlag = 1u << 1;
+	const uint32_t g_uCacheMeshletsFlag = 1u << 2;
+
+	// How far in pixels a level of detail may deviate from full detail before a finer one is drawn.
+	const float g_fLodErrorPixels = 1.0f;
+
+	/// <summary>
+	/// Whether every index into a vertex buffer fits in 16 bits.
+	/// </summary>
+	bool FitsIn16BitIndices(int a_dVertexCount)
+	{
+		return a_dVertexCount <= 0xFFFF;
+	}
+
+	/// <summary>
+	/// Copies 32 bit indices into a 16 bit array.  Only valid if FitsIn16BitIndices().
+	/// </summary>
+	std::vector<uint16_t> NarrowIndices(const unsigned int* a_pIndices, int a_dIndexCount)
+	{
+		std::vector<uint16_t> narrowed(a_dIndexCount);
+		for (int i = 0; i < a_dIndexCount; i++)
+		{
+			narrowed[i] = static_cast<uint16_t>(a_pIndices[i]);
+		}
+		return narrowed;
+	}
+}
+
+Mesh::Mesh(Vertex* a_pVertices, int a_dVertexCount, unsigned int* a_pIndices, int a_dIndexCount, bool a_bCompressVertices)
 {
 	// Saving the passed in values to the member fields.
 	m_pVertexBuffer = nullptr;
@@ -14,289 +51,197 @@ Mesh::Mesh(Vertex* a_pVertices, int a_dVertexCount, unsigned int* a_pIndices, in
 
 	m_dVertexCount = a_dVertexCount;
 	m_dIndexCount = a_dIndexCount;
+	m_dUnweldedVertexCount = a_dIndexCount;
+	m_sName = "";
+	m_vcsLoaded = MeshOptimizer::AnalyzeVertexCache(a_pIndices, a_dIndexCount, a_dVertexCount);
+	m_vcsOptimized = m_vcsLoaded;
+	m_bLoadedFromCache = false;
+	m_bCompressed = a_bCompressVertices;
+
+	// Calculating vertex tangents and bounds.
+	TangentGenerator::CalculateTangents(a_pVertices, a_dVertexCount, a_pIndices, a_dIndexCount);
+	CalculateBounds(a_pVertices, a_dVertexCount, m_v3BoundsMin, m_v3BoundsMax);
+	CalculateBoundingSphere(a_pVertices, a_dVertexCount, m_v3BoundsMin, m_v3BoundsMax, m_v3SphereCenter, m_fSphereRadius);
+
+	// Appending the simplified levels of detail after the full detail indices.
+	std::vector<unsigned int> lodIndices = MeshSimplifier::GenerateLods(a_pVertices, a_dVertexCount, a_pIndices, a_dIndexCount, m_pLods, m_uLodCount);
+
+	// Creating the GPU side buffers.
+	CreateBuffers(a_pVertices, a_dVertexCount, lodIndices.data(), sizeof(unsigned int), static_cast<int>(lodIndices.size()));
+}
 
-	// Calculating vertex tangents.
-	CalculateTangents(a_pVertices, a_dVertexCount, a_pIndices, a_dIndexCount);
-
-	// Setting up the vertex buffer setup struct object.
-	D3D11_BUFFER_DESC vbd = {};
-	vbd.Usage = D3D11_USAGE_IMMUTABLE;						// Will NEVER change
-	vbd.ByteWidth = sizeof(Vertex) * a_dVertexCount;		// 3 = number of vertices in the buffer
-	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;				// Tells Direct3D this is a vertex buffer
-	vbd.CPUAccessFlags = 0;									// Note: We cannot access the data from C++ (this is good)
-	vbd.MiscFlags = 0;
-	vbd.StructureByteStride = 0;
-
-	// Setting up the index buffer setup struct object.
-	D3D11_BUFFER_DESC ibd = {};
-	ibd.Usage = D3D11_USAGE_IMMUTABLE;						// Will NEVER change
-	ibd.ByteWidth = sizeof(unsigned int) * a_dIndexCount;	// 3 = number of indices in the buffer
-	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;				// Tells Direct3D this is an index buffer
-	ibd.CPUAccessFlags = 0;									// Note: We cannot access the data from C++ (this is good)
-	ibd.MiscFlags = 0;
-	ibd.StructureByteStride = 0;
+Mesh::Mesh(const char* a_sFilepath, MeshLoadOptions a_mloOptions) :
+	Mesh(Load(a_sFilepath, a_mloOptions))
+{
+}
 
-	// Creating the structs that actually hold the buffer data
-	D3D11_SUBRESOURCE_DATA initialVertexData = {};
-	D3D11_SUBRESOURCE_DATA initialIndexData = {};
+Mesh::Mesh(const MeshData& a_mdData)
+{
+	m_pVertexBuffer = nullptr;
+	m_pIndexBuffer = nullptr;
 
-	// Setting the system memory to hold the buffer data.
-	initialVertexData.pSysMem = a_pVertices;
-	initialIndexData.pSysMem = a_pIndices;
+	m_sName = a_mdData.Name;
+	m_dVertexCount = a_mdData.VertexCount;
+	m_dIndexCount = static_cast<int>(a_mdData.Lods[0].IndexCount);
+	m_dUnweldedVertexCount = a_mdData.UnweldedVertexCount;
+	m_vcsLoaded = a_mdData.LoadedStats;
+	m_vcsOptimized = a_mdData.OptimizedStats;
+	m_v3BoundsMin = a_mdData.BoundsMin;
+	m_v3BoundsMax = a_mdData.BoundsMax;
+	m_v3SphereCenter = a_mdData.SphereCenter;
+	m_fSphereRadius = a_mdData.SphereRadius;
+	m_bLoadedFromCache = a_mdData.Cache != nullptr;
+	m_bCompressed = a_mdData.Options.CompressVertices;
+	m_uLodCount = a_mdData.LodCount;
+	for (unsigned int i = 0; i < m_uLodCount; i++)
+	{
+		m_pLods[i] = a_mdData.Lods[i];
+	}
+	m_lMeshlets = a_mdData.Meshlets;
+
+	// Cached arrays go straight from the mapping to the GPU.
+	const Vertex* pVertices = a_mdData.Vertices.data();
+	const void* pIndices = a_mdData.IndexStride == sizeof(uint16_t) ?
+		static_cast<const void*>(a_mdData.NarrowedIndices.data()) :
+		static_cast<const void*>(a_mdData.Indices.data());
+	if (a_mdData.Cache)
+	{
+		pVertices = a_mdData.Cache->GetVertices();
+		pIndices = a_mdData.Cache->GetIndices();
+		const Meshlet* pMeshlets = a_mdData.Cache->GetMeshlets();
+		m_lMeshlets.assign(pMeshlets, pMeshlets + a_mdData.Cache->GetHeader().MeshletCount);
+	}
 
-	// Creating the buffers.
-	Graphics::Device->CreateBuffer(&vbd, &initialVertexData, m_pVertexBuffer.GetAddressOf());
-	Graphics::Device->CreateBuffer(&ibd, &initialIndexData, m_pIndexBuffer.GetAddressOf());
+	// Creating the GPU side buffers.
+	CreateBuffers(pVertices, m_dVertexCount, pIndices, a_mdData.IndexStride, a_mdData.IndexCount);
 }
 
-Mesh::Mesh(const char* a_sFilepath)
+MeshData Mesh::Load(const char* a_sFilepath, MeshLoadOptions a_mloOptions)
 {
-	// Author: Chris Cascioli
-	// Purpose: Basic .OBJ 3D model loading, supporting positions, uvs and normals
-	// 
-	// - You are allowed to directly copy/paste this into your code base
-	//   for assignments, given that you clearly cite that this is not
-	//   code of your own design.
-	
-	// File input object
-	std::ifstream obj(a_sFilepath);
-
-	// Check for successful open
-	if (!obj.is_open())
-		throw std::invalid_argument("Error opening file: Invalid file path or file is inaccessible");
-
-	// Variables used while reading the file
-	std::vector<XMFLOAT3> positions;		// Positions from the file
-	std::vector<XMFLOAT3> normals;			// Normals from the file
-	std::vector<XMFLOAT2> uvs;				// UVs from the file
-	std::vector<Vertex> verts;				// Verts we're assembling
-	std::vector<unsigned int> indices;		// Indices of these verts
-	int vertCounter = 0;					// Count of vertices
-	int indexCounter = 0;					// Count of indices
-	char chars[100];						// String for line reading
-
-	// Still have data left?
-	while (obj.good())
+	MeshData data = {};
+	data.Name = a_sFilepath;
+	data.Options = a_mloOptions;
+
+	uint32_t uOptionFlags =
+		(a_mloOptions.OptimizeVertexCache ? g_uCacheOptimizedFlag : 0) |
+		(a_mloOptions.GenerateLods ? g_uCacheLodsFlag : 0) |
+		(a_mloOptions.BuildMeshlets ? g_uCacheMeshletsFlag : 0);
+	if (a_mloOptions.UseBinaryCache)
 	{
-		// Get the line (100 characters should be more than enough)
-		obj.getline(chars, 100);
-
-		// Check the type of line
-		if (chars[0] == 'v' && chars[1] == 'n')
+		// Everything below has already been done if an up to date cache exists,
+		// so the mapping is kept open for the arrays to be read straight out of.
+		std::shared_ptr<MeshCache> pCache = std::make_shared<MeshCache>(a_sFilepath, uOptionFlags);
+		if (pCache->IsValid())
 		{
-			// Read the 3 numbers directly into an XMFLOAT3
-			XMFLOAT3 norm;
-			sscanf_s(
-				chars,
-				"vn %f %f %f",
-				&norm.x, &norm.y, &norm.z);
-
-			// Add to the list of normals
-			normals.push_back(norm);
-		}
-		else if (chars[0] == 'v' && chars[1] == 't')
-		{
-			// Read the 2 numbers directly into an XMFLOAT2
-			XMFLOAT2 uv;
-			sscanf_s(
-				chars,
-				"vt %f %f",
-				&uv.x, &uv.y);
-
-			// Add to the list of uv's
-			uvs.push_back(uv);
-		}
-		else if (chars[0] == 'v')
-		{
-			// Read the 3 numbers directly into an XMFLOAT3
-			XMFLOAT3 pos;
-			sscanf_s(
-				chars,
-				"v %f %f %f",
-				&pos.x, &pos.y, &pos.z);
-
-			// Add to the positions
-			positions.push_back(pos);
-		}
-		else if (chars[0] == 'f')
-		{
-			// Read the face indices into an array
-			// NOTE: This assumes the given obj file contains
-			//  vertex positions, uv coordinates AND normals.
-			unsigned int i[12];
-			int numbersRead = sscanf_s(
-				chars,
-				"f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d",
-				&i[0], &i[1], &i[2],
-				&i[3], &i[4], &i[5],
-				&i[6], &i[7], &i[8],
-				&i[9], &i[10], &i[11]);
-
-			// If we only got the first number, chances are the OBJ
-			// file has no UV coordinates.  This isn't great, but we
-			// still want to load the model without crashing, so we
-			// need to re-read a different pattern (in which we assume
-			// there are no UVs denoted for any of the vertices)
-			if (numbersRead == 1)
-			{
-				// Re-read with a different pattern
-				numbersRead = sscanf_s(
-					chars,
-					"f %d//%d %d//%d %d//%d %d//%d",
-					&i[0], &i[2],
-					&i[3], &i[5],
-					&i[6], &i[8],
-					&i[9], &i[11]);
-
-				// The following indices are where the UVs should 
-				// have been, so give them a valid value
-				i[1] = 1;
-				i[4] = 1;
-				i[7] = 1;
-				i[10] = 1;
-
-				// If we have no UVs, create a single UV coordinate
-				// that will be used for all vertices
-				if (uvs.size() == 0)
-					uvs.push_back(XMFLOAT2(0, 0));
-			}
-
-			// - Create the verts by looking up
-			//    corresponding data from vectors
-			// - OBJ File indices are 1-based, so
-			//    they need to be adusted
-			Vertex v1;
-			v1.Position = positions[i[0] - 1];
-			v1.UV = uvs[i[1] - 1];
-			v1.Normal = normals[i[2] - 1];
-
-			Vertex v2;
-			v2.Position = positions[i[3] - 1];
-			v2.UV = uvs[i[4] - 1];
-			v2.Normal = normals[i[5] - 1];
-
-			Vertex v3;
-			v3.Position = positions[i[6] - 1];
-			v3.UV = uvs[i[7] - 1];
-			v3.Normal = normals[i[8] - 1];
-
-			// The model is most likely in a right-handed space,
-			// especially if it came from Maya.  We want to convert
-			// to a left-handed space for DirectX.  This means we 
-			// need to:
-			//  - Invert the Z position
-			//  - Invert the normal's Z
-			//  - Flip the winding order
-			// We also need to flip the UV coordinate since DirectX
-			// defines (0,0) as the top left of the texture, and many
-			// 3D modeling packages use the bottom left as (0,0)
-
-			// Flip the UV's since they're probably "upside down"
-			v1.UV.y = 1.0f - v1.UV.y;
-			v2.UV.y = 1.0f - v2.UV.y;
-			v3.UV.y = 1.0f - v3.UV.y;
-
-			// Flip Z (LH vs. RH)
-			v1.Position.z *= -1.0f;
-			v2.Position.z *= -1.0f;
-			v3.Position.z *= -1.0f;
-
-			// Flip normal's Z
-			v1.Normal.z *= -1.0f;
-			v2.Normal.z *= -1.0f;
-			v3.Normal.z *= -1.0f;
-
-			// Add the verts to the vector (flipping the winding order)
-			verts.push_back(v1);
-			verts.push_back(v3);
-			verts.push_back(v2);
-			vertCounter += 3;
-
-			// Add three more indices
-			indices.push_back(indexCounter); indexCounter += 1;
-			indices.push_back(indexCounter); indexCounter += 1;
-			indices.push_back(indexCounter); indexCounter += 1;
-
-			// Was there a 4th face?
-			// - 12 numbers read means 4 faces WITH uv's
-			// - 8 numbers read means 4 faces WITHOUT uv's
-			if (numbersRead == 12 || numbersRead == 8)
+			const MeshCacheHeader& header = pCache->GetHeader();
+			data.VertexCount = static_cast<int>(header.VertexCount);
+			data.IndexCount = static_cast<int>(header.IndexCount);
+			data.IndexStride = header.IndexStride;
+			data.UnweldedVertexCount = static_cast<int>(header.UnweldedVertexCount);
+			data.LoadedStats = header.LoadedStats;
+			data.OptimizedStats = header.OptimizedStats;
+			data.BoundsMin = header.BoundsMin;
+			data.BoundsMax = header.BoundsMax;
+			data.SphereCenter = header.SphereCenter;
+			data.SphereRadius = header.SphereRadius;
+			data.LodCount = header.LodCount;
+			for (uint32_t i = 0; i < header.LodCount; i++)
 			{
-				// Make the last vertex
-				Vertex v4;
-				v4.Position = positions[i[9] - 1];
-				v4.UV = uvs[i[10] - 1];
-				v4.Normal = normals[i[11] - 1];
-
-				// Flip the UV, Z pos and normal's Z
-				v4.UV.y = 1.0f - v4.UV.y;
-				v4.Position.z *= -1.0f;
-				v4.Normal.z *= -1.0f;
-
-				// Add a whole triangle (flipping the winding order)
-				verts.push_back(v1);
-				verts.push_back(v4);
-				verts.push_back(v3);
-				vertCounter += 3;
-
-				// Add three more indices
-				indices.push_back(indexCounter); indexCounter += 1;
-				indices.push_back(indexCounter); indexCounter += 1;
-				indices.push_back(indexCounter); indexCounter += 1;
+				data.Lods[i] = header.Lods[i];
 			}
+			data.Cache = pCache;
+			return data;
 		}
 	}
 
-	// Close the file and create the actual buffers
-	obj.close();
+	// Parsing the obj file straight out of a memory mapping.  Corners
+	// sharing a position/uv/normal come back already welded together.
+	std::vector<Vertex>& verts = data.Vertices;
+	std::vector<unsigned int>& indices = data.Indices;
+	if (!ObjLoader::Load(a_sFilepath, verts, indices))
+		throw std::invalid_argument("Error opening file: Invalid file path or file is inaccessible");
 
-	m_dVertexCount = vertCounter;
-	m_dIndexCount = indexCounter;
+	data.IndexCount = static_cast<int>(indices.size());
+	data.UnweldedVertexCount = data.IndexCount;
 
-	// Copying the data into a heap allocated array for the tangent function.
-	Vertex* lTempVertArr = new Vertex[verts.size()];
-	unsigned int* lTempIndexArr = new unsigned int[indices.size()];
+	// Measuring how the index buffer behaves in a post-transform cache as loaded.
+	data.LoadedStats = MeshOptimizer::AnalyzeVertexCache(indices.data(), indices.size(), verts.size());
+	data.OptimizedStats = data.LoadedStats;
 
-	// Copying the data from the vectors.
-	std::memcpy(lTempVertArr, verts.data(), verts.size() * sizeof(Vertex));
-	std::memcpy(lTempIndexArr, indices.data(), indices.size() * sizeof(unsigned int));
+	if (a_mloOptions.OptimizeVertexCache)
+	{
+		// Reordering the triangles, but only keeping the result if it actually helps.
+		std::vector<unsigned int> optimized = indices;
+		MeshOptimizer::OptimizeVertexCache(optimized.data(), optimized.size(), verts.size());
+		VertexCacheStats stats = MeshOptimizer::AnalyzeVertexCache(optimized.data(), optimized.size(), verts.size());
+		if (stats.ACMR < data.LoadedStats.ACMR)
+		{
+			indices.swap(optimized);
+			data.OptimizedStats = stats;
+		}
 
-	// Calculate vertex tangents.
-	CalculateTangents(lTempVertArr, m_dVertexCount, lTempIndexArr, m_dIndexCount);
+		// Laying the vertices out in the order they are first fetched.
+		verts.resize(MeshOptimizer::OptimizeVertexFetch(verts.data(), verts.size(), indices.data(), indices.size()));
+	}
+	data.VertexCount = static_cast<int>(verts.size());
 
-	// Setting up the vertex buffer setup struct object.
-	D3D11_BUFFER_DESC vbd = {};
-	vbd.Usage = D3D11_USAGE_IMMUTABLE;						// Will NEVER change
-	vbd.ByteWidth = sizeof(Vertex) * vertCounter;			// 3 = number of vertices in the buffer
-	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;				// Tells Direct3D this is a vertex buffer
-	vbd.CPUAccessFlags = 0;									// Note: We cannot access the data from C++ (this is good)
-	vbd.MiscFlags = 0;
-	vbd.StructureByteStride = 0;
+	// Calculate vertex tangents and bounds.
+	TangentGenerator::CalculateTangents(verts.data(), verts.size(), indices.data(), indices.size());
+	CalculateBounds(verts.data(), data.VertexCount, data.BoundsMin, data.BoundsMax);
+	CalculateBoundingSphere(verts.data(), data.VertexCount, data.BoundsMin, data.BoundsMax, data.SphereCenter, data.SphereRadius);
 
-	// Setting up the index buffer setup struct object.
-	D3D11_BUFFER_DESC ibd = {};
-	ibd.Usage = D3D11_USAGE_IMMUTABLE;						// Will NEVER change
-	ibd.ByteWidth = sizeof(unsigned int) * indexCounter;	// 3 = number of indices in the buffer
-	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;				// Tells Direct3D this is an index buffer
-	ibd.CPUAccessFlags = 0;									// Note: We cannot access the data from C++ (this is good)
-	ibd.MiscFlags = 0;
-	ibd.StructureByteStride = 0;
+	// Simplifying into coarser levels of detail that share the vertices and follow the full detail indices.
+	data.Lods[0] = { 0, static_cast<uint32_t>(data.IndexCount), 0.0f };
+	data.LodCount = 1;
+	if (a_mloOptions.GenerateLods)
+	{
+		std::vector<unsigned int> lodIndices = MeshSimplifier::GenerateLods(verts.data(), verts.size(), indices.data(), indices.size(), data.Lods, data.LodCount);
+		indices.swap(lodIndices);
+		data.IndexCount = static_cast<int>(indices.size());
+	}
 
-	// Creating the structs that actually hold the buffer data
-	D3D11_SUBRESOURCE_DATA initialVertexData = {};
-	D3D11_SUBRESOURCE_DATA initialIndexData = {};
+	if (a_mloOptions.BuildMeshlets)
+	{
+		// Clustering the full detail triangles, then measuring the cache again since they moved.
+		data.Meshlets = MeshletBuilder::Build(verts.data(), verts.size(), indices.data(), data.Lods[0].IndexCount);
+		data.OptimizedStats = MeshOptimizer::AnalyzeVertexCache(indices.data(), data.Lods[0].IndexCount, verts.size());
+	}
 
-	// Setting the system memory to hold the buffer data.
-	initialVertexData.pSysMem = &lTempVertArr[0];
-	initialIndexData.pSysMem = &lTempIndexArr[0];
+	// Narrowing the indices once for both the cache and the index buffer.
+	const void* pIndices = indices.data();
+	data.IndexStride = sizeof(unsigned int);
+	if (FitsIn16BitIndices(data.VertexCount))
+	{
+		data.NarrowedIndices = NarrowIndices(indices.data(), data.IndexCount);
+		pIndices = data.NarrowedIndices.data();
+		data.IndexStride = sizeof(uint16_t);
+	}
 
-	// Creating the buffers.
-	Graphics::Device->CreateBuffer(&vbd, &initialVertexData, m_pVertexBuffer.GetAddressOf());
-	Graphics::Device->CreateBuffer(&ibd, &initialIndexData, m_pIndexBuffer.GetAddressOf());
+	if (a_mloOptions.UseBinaryCache)
+	{
+		// Saving the final arrays so the next launch can skip all of the above.
+		MeshCacheHeader header = {};
+		header.OptionFlags = uOptionFlags;
+		header.VertexCount = static_cast<uint32_t>(data.VertexCount);
+		header.IndexCount = static_cast<uint32_t>(data.IndexCount);
+		header.IndexStride = data.IndexStride;
+		header.UnweldedVertexCount = static_cast<uint32_t>(data.UnweldedVertexCount);
+		header.LoadedStats = data.LoadedStats;
+		header.OptimizedStats = data.OptimizedStats;
+		header.BoundsMin = data.BoundsMin;
+		header.BoundsMax = data.BoundsMax;
+		header.SphereCenter = data.SphereCenter;
+		header.SphereRadius = data.SphereRadius;
+		header.LodCount = data.LodCount;
+		for (unsigned int i = 0; i < data.LodCount; i++)
+		{
+			header.Lods[i] = data.Lods[i];
+		}
+		header.MeshletCount = static_cast<uint32_t>(data.Meshlets.size());
+		MeshCache::Write(a_sFilepath, header, verts.data(), pIndices, data.Meshlets.data());
+	}
 
-	// Deleting the temporary arrays.
-	delete[] lTempIndexArr;
-	delete[] lTempVertArr;
+	return data;
 }
 
 #pragma region Rule of Three
@@ -313,6 +258,26 @@ Mesh::Mesh(const Mesh& a_pOther)
 	m_dVertexCount = a_pOther.m_dVertexCount;
 	m_pIndexBuffer = a_pOther.m_pIndexBuffer;
 	m_dIndexCount = a_pOther.m_dIndexCount;
+	m_dUnweldedVertexCount = a_pOther.m_dUnweldedVertexCount;
+	m_sName = a_pOther.m_sName;
+	m_vcsLoaded = a_pOther.m_vcsLoaded;
+	m_vcsOptimized = a_pOther.m_vcsOptimized;
+	m_v3BoundsMin = a_pOther.m_v3BoundsMin;
+	m_v3BoundsMax = a_pOther.m_v3BoundsMax;
+	m_v3SphereCenter = a_pOther.m_v3SphereCenter;
+	m_fSphereRadius = a_pOther.m_fSphereRadius;
+	m_bLoadedFromCache = a_pOther.m_bLoadedFromCache;
+	m_bCompressed = a_pOther.m_bCompressed;
+	m_uVertexStride = a_pOther.m_uVertexStride;
+	m_fIndexFormat = a_pOther.m_fIndexFormat;
+	m_lPositions = a_pOther.m_lPositions;
+	m_lIndices = a_pOther.m_lIndices;
+	m_uLodCount = a_pOther.m_uLodCount;
+	for (unsigned int i = 0; i < m_uLodCount; i++)
+	{
+		m_pLods[i] = a_pOther.m_pLods[i];
+	}
+	m_lMeshlets = a_pOther.m_lMeshlets;
 }
 Mesh& Mesh::operator=(const Mesh& a_pOther)
 {
@@ -325,6 +290,26 @@ Mesh& Mesh::operator=(const Mesh& a_pOther)
 	m_dVertexCount = a_pOther.m_dVertexCount;
 	m_pIndexBuffer = a_pOther.m_pIndexBuffer;
 	m_dIndexCount = a_pOther.m_dIndexCount;
+	m_dUnweldedVertexCount = a_pOther.m_dUnweldedVertexCount;
+	m_sName = a_pOther.m_sName;
+	m_vcsLoaded = a_pOther.m_vcsLoaded;
+	m_vcsOptimized = a_pOther.m_vcsOptimized;
+	m_v3BoundsMin = a_pOther.m_v3BoundsMin;
+	m_v3BoundsMax = a_pOther.m_v3BoundsMax;
+	m_v3SphereCenter = a_pOther.m_v3SphereCenter;
+	m_fSphereRadius = a_pOther.m_fSphereRadius;
+	m_bLoadedFromCache = a_pOther.m_bLoadedFromCache;
+	m_bCompressed = a_pOther.m_bCompressed;
+	m_uVertexStride = a_pOther.m_uVertexStride;
+	m_fIndexFormat = a_pOther.m_fIndexFormat;
+	m_lPositions = a_pOther.m_lPositions;
+	m_lIndices = a_pOther.m_lIndices;
+	m_uLodCount = a_pOther.m_uLodCount;
+	for (unsigned int i = 0; i < m_uLodCount; i++)
+	{
+		m_pLods[i] = a_pOther.m_pLods[i];
+	}
+	m_lMeshlets = a_pOther.m_lMeshlets;
 
 	return *this;
 }
@@ -347,94 +332,235 @@ int Mesh::GetVertexCount(void)
 {
 	return m_dVertexCount;
 }
+int Mesh::GetUnweldedVertexCount(void)
+{
+	return m_dUnweldedVertexCount;
+}
+std::string Mesh::GetName(void)
+{
+	return m_sName;
+}
+VertexCacheStats Mesh::GetVertexCacheStats(bool a_bOptimized)
+{
+	return a_bOptimized ? m_vcsOptimized : m_vcsLoaded;
+}
+XMFLOAT3 Mesh::GetBoundsMin(void)
+{
+	return m_v3BoundsMin;
+}
+XMFLOAT3 Mesh::GetBoundsMax(void)
+{
+	return m_v3BoundsMax;
+}
+XMFLOAT3 Mesh::GetSphereCenter(void)
+{
+	return m_v3SphereCenter;
+}
+float Mesh::GetSphereRadius(void)
+{
+	return m_fSphereRadius;
+}
+bool Mesh::WasLoadedFromCache(void)
+{
+	return m_bLoadedFromCache;
+}
+bool Mesh::IsCompressed(void)
+{
+	return m_bCompressed;
+}
+UINT Mesh::GetVertexStride(void)
+{
+	return m_uVertexStride;
+}
+DXGI_FORMAT Mesh::GetIndexFormat(void)
+{
+	return m_fIndexFormat;
+}
+const std::vector<XMFLOAT3>& Mesh::GetPositions(void)
+{
+	return m_lPositions;
+}
+const std::vector<unsigned int>& Mesh::GetIndices(void)
+{
+	return m_lIndices;
+}
+unsigned int Mesh::GetLodCount(void)
+{
+	return m_uLodCount;
+}
+const MeshLod& Mesh::GetLod(unsigned int a_uLod)
+{
+	return m_pLods[a_uLod < m_uLodCount ? a_uLod : m_uLodCount - 1];
+}
+const std::vector<Meshlet>& Mesh::GetMeshlets(void)
+{
+	return m_lMeshlets;
+}
 #pragma endregion
 
-void Mesh::Draw(void)
+unsigned int Mesh::SelectLod(float a_fScreenDiameter, float a_fBias)
+{
+	// Turning each level's error, relative to the bounds diagonal, into pixels at this size on screen.
+	XMFLOAT3 v3Size(m_v3BoundsMax.x - m_v3BoundsMin.x, m_v3BoundsMax.y - m_v3BoundsMin.y, m_v3BoundsMax.z - m_v3BoundsMin.z);
+	float fDiagonal = sqrtf(v3Size.x * v3Size.x + v3Size.y * v3Size.y + v3Size.z * v3Size.z);
+	float fPixelsPerUnit = m_fSphereRadius > 0.0f ? a_fScreenDiameter / (2.0f * m_fSphereRadius) : 0.0f;
+
+	unsigned int uLod = 0;
+	for (unsigned int i = 1; i < m_uLodCount; i++)
+	{
+		if (m_pLods[i].Error * fDiagonal * fPixelsPerUnit <= g_fLodErrorPixels * a_fBias) uLod = i;
+	}
+	return uLod;
+}
+
+void Mesh::Draw(unsigned int a_uLod)
 {
-	// Setting the stride to be the memory size of a Vertex
-	UINT stride = sizeof(Vertex);
+	const MeshLod& lod = GetLod(a_uLod);
+
+	// Setting the stride to be the memory size of a (possibly compressed) vertex.
+	UINT stride = m_uVertexStride;
 
 	// The offset starts at the first piece of data.
 	UINT offset = 0;
 
 	// Setting the buffers as the next thing to draw.
-	Graphics::Context->IASetVertexBuffers(0, 1, m_pVertexBuffer.GetAddressOf(), &stride, &offset);
-	Graphics::Context->IASetIndexBuffer(m_pIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+	Graphics::StateCache.SetVertexBuffer(0, m_pVertexBuffer.Get(), stride, offset);
+	Graphics::StateCache.SetIndexBuffer(m_pIndexBuffer.Get(), m_fIndexFormat, 0);
 
 	// Starting up the render pipeline and drawing the currently set Index and Vertex buffers.
 	Graphics::Context->DrawIndexed(
-		m_dIndexCount,		// The number of indices to use (we could draw a subset if we wanted).
-		0,					// Offset to the first index we want to use.
+		lod.IndexCount,		// The number of indices in this level of detail.
+		lod.IndexStart,		// Offset to the level's first index.
 		0);					// Offset to add to each index when looking up vertices.
 }
 
-// --------------------------------------------------------
-// Calculates the tangents of the vertices in a mesh
-// - Code originally adapted from: http://www.terathon.com/code/tangent.html
-// - Updated version found here: http://foundationsofgameenginedev.com/FGED2-sample.pdf
-// - See listing 7.4 in section 7.5 (page 9 of the PDF)
-//
-// - Note: For this code to work, your Vertex format must
-// contain an XMFLOAT3 called Tangent
-//
-// - Be sure to call this BEFORE creating your D3D vertex/index buffers
-// --------------------------------------------------------
-void Mesh::CalculateTangents(Vertex* verts, int numVerts, unsigned int* indices, int numIndices)
-{
-	// Reset tangents
-	for (int i = 0; i < numVerts; i++)
+void Mesh::Draw(const IndexRange* a_pRanges, unsigned int a_uRangeCount)
+{
+	UINT stride = m_uVertexStride;
+	UINT offset = 0;
+	Graphics::StateCache.SetVertexBuffer(0, m_pVertexBuffer.Get(), stride, offset);
+	Graphics::StateCache.SetIndexBuffer(m_pIndexBuffer.Get(), m_fIndexFormat, 0);
+
+	// One draw per run of surviving meshlets, with the same buffers and shader constants.
+	for (unsigned int i = 0; i < a_uRangeCount; i++)
+	{
+		Graphics::Context->DrawIndexed(a_pRanges[i].IndexCount, a_pRanges[i].IndexStart, 0);
+	}
+}
+
+void Mesh::DrawInstanced(unsigned int a_uLod, unsigned int a_uInstanceCount, unsigned int a_uFirstInstance)
+{
+	const MeshLod& lod = GetLod(a_uLod);
+	UINT stride = m_uVertexStride;
+	UINT offset = 0;
+	Graphics::StateCache.SetVertexBuffer(0, m_pVertexBuffer.Get(), stride, offset);
+	Graphics::StateCache.SetIndexBuffer(m_pIndexBuffer.Get(), m_fIndexFormat, 0);
+
+	// The instance's matrices come from slot 1, a_uFirstInstance entries in.
+	Graphics::Context->DrawIndexedInstanced(lod.IndexCount, a_uInstanceCount, lod.IndexStart, 0, a_uFirstInstance);
+}
+
+void Mesh::CreateBuffers(const Vertex* a_pVertices, int a_dVertexCount, const void* a_pIndices, UINT a_uIndexStride, int a_dIndexCount)
+{
+	// Keeping the positions and the full detail indices around for the CPU side occlusion rasterizer.
+	m_lPositions.resize(a_dVertexCount);
+	for (int i = 0; i < a_dVertexCount; i++)
+	{
+		m_lPositions[i] = a_pVertices[i].Position;
+	}
+	m_lIndices.resize(m_pLods[0].IndexCount);
+	for (size_t i = 0; i < m_lIndices.size(); i++)
+	{
+		m_lIndices[i] = a_uIndexStride == sizeof(uint16_t) ?
+			static_cast<const uint16_t*>(a_pIndices)[i] :
+			static_cast<const unsigned int*>(a_pIndices)[i];
+	}
+
+	// Halving the index buffer when every index fits in 16 bits.
+	std::vector<uint16_t> narrowedIndices;
+	if (a_uIndexStride == sizeof(unsigned int) && FitsIn16BitIndices(a_dVertexCount))
+	{
+		narrowedIndices = NarrowIndices(static_cast<const unsigned int*>(a_pIndices), a_dIndexCount);
+		a_pIndices = narrowedIndices.data();
+		a_uIndexStride = sizeof(uint16_t);
+	}
+	m_fIndexFormat = a_uIndexStride == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+	// Quantizing the vertices against the bounds if requested.
+	std::vector<CompressedVertex> compressedVertices;
+	const void* pVertexData = a_pVertices;
+	m_uVertexStride = sizeof(Vertex);
+	if (m_bCompressed)
 	{
-		verts[i].Tangent = XMFLOAT3(0, 0, 0);
+		compressedVertices.resize(a_dVertexCount);
+		for (int i = 0; i < a_dVertexCount; i++)
+		{
+			compressedVertices[i] = VertexCompression::Compress(a_pVertices[i], m_v3BoundsMin, m_v3BoundsMax);
+		}
+		pVertexData = compressedVertices.data();
+		m_uVertexStride = sizeof(CompressedVertex);
 	}
-	// Calculate tangents one whole triangle at a time
-	for (int i = 0; i < numIndices;)
+
+	// Setting up the vertex buffer setup struct object.
+	D3D11_BUFFER_DESC vbd = {};
+	vbd.Usage = D3D11_USAGE_IMMUTABLE;						// Will NEVER change
+	vbd.ByteWidth = m_uVertexStride * a_dVertexCount;		// Number of vertices in the buffer
+	vbd.BindFlags = D3D11_BIND_VERTEX_BUFFER;				// Tells Direct3D this is a vertex buffer
+	vbd.CPUAccessFlags = 0;									// Note: We cannot access the data from C++ (this is good)
+	vbd.MiscFlags = 0;
+	vbd.StructureByteStride = 0;
+
+	// Setting up the index buffer setup struct object.
+	D3D11_BUFFER_DESC ibd = {};
+	ibd.Usage = D3D11_USAGE_IMMUTABLE;						// Will NEVER change
+	ibd.ByteWidth = a_uIndexStride * a_dIndexCount;			// Number of indices in the buffer
+	ibd.BindFlags = D3D11_BIND_INDEX_BUFFER;				// Tells Direct3D this is an index buffer
+	ibd.CPUAccessFlags = 0;									// Note: We cannot access the data from C++ (this is good)
+	ibd.MiscFlags = 0;
+	ibd.StructureByteStride = 0;
+
+	// Creating the structs that actually hold the buffer data
+	D3D11_SUBRESOURCE_DATA initialVertexData = {};
+	D3D11_SUBRESOURCE_DATA initialIndexData = {};
+
+	// Setting the system memory to hold the buffer data.
+	initialVertexData.pSysMem = pVertexData;
+	initialIndexData.pSysMem = a_pIndices;
+
+	// Creating the buffers.
+	Graphics::Device->CreateBuffer(&vbd, &initialVertexData, m_pVertexBuffer.GetAddressOf());
+	Graphics::Device->CreateBuffer(&ibd, &initialIndexData, m_pIndexBuffer.GetAddressOf());
+}
+
+void Mesh::CalculateBounds(const Vertex* a_pVertices, int a_dVertexCount, XMFLOAT3& a_v3Min, XMFLOAT3& a_v3Max)
+{
+	a_v3Min = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	a_v3Max = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	if (a_dVertexCount <= 0) return;
+
+	// Growing a box out from the first vertex.
+	XMVECTOR vMin = XMLoadFloat3(&a_pVertices[0].Position);
+	XMVECTOR vMax = vMin;
+	for (int i = 1; i < a_dVertexCount; i++)
 	{
-		// Grab indices and vertices of first triangle
-		unsigned int i1 = indices[i++];
-		unsigned int i2 = indices[i++];
-		unsigned int i3 = indices[i++];
-		Vertex* v1 = &verts[i1];
-		Vertex* v2 = &verts[i2];
-		Vertex* v3 = &verts[i3];
-		// Calculate vectors relative to triangle positions
-		float x1 = v2->Position.x - v1->Position.x;
-		float y1 = v2->Position.y - v1->Position.y;
-		float z1 = v2->Position.z - v1->Position.z;
-		float x2 = v3->Position.x - v1->Position.x;
-		float y2 = v3->Position.y - v1->Position.y;
-		float z2 = v3->Position.z - v1->Position.z;
-		// Do the same for vectors relative to triangle uv's
-		float s1 = v2->UV.x - v1->UV.x;
-		float t1 = v2->UV.y - v1->UV.y;
-		float s2 = v3->UV.x - v1->UV.x;
-		float t2 = v3->UV.y - v1->UV.y;
-		// Create vectors for tangent calculation
-		float r = 1.0f / (s1 * t2 - s2 * t1);
-		float tx = (t2 * x1 - t1 * x2) * r;
-		float ty = (t2 * y1 - t1 * y2) * r;
-		float tz = (t2 * z1 - t1 * z2) * r;
-		// Adjust tangents of each vert of the triangle
-		v1->Tangent.x += tx;
-		v1->Tangent.y += ty;
-		v1->Tangent.z += tz;
-		v2->Tangent.x += tx;
-		v2->Tangent.y += ty;
-		v2->Tangent.z += tz;
-		v3->Tangent.x += tx;
-		v3->Tangent.y += ty;
-		v3->Tangent.z += tz;
+		XMVECTOR vPosition = XMLoadFloat3(&a_pVertices[i].Position);
+		vMin = XMVectorMin(vMin, vPosition);
+		vMax = XMVectorMax(vMax, vPosition);
 	}
-	// Ensure all of the tangents are orthogonal to the normals
-	for (int i = 0; i < numVerts; i++)
+	XMStoreFloat3(&a_v3Min, vMin);
+	XMStoreFloat3(&a_v3Max, vMax);
+}
+
+void Mesh::CalculateBoundingSphere(const Vertex* a_pVertices, int a_dVertexCount, XMFLOAT3 a_v3Min, XMFLOAT3 a_v3Max, XMFLOAT3& a_v3Center, float& a_fRadius)
+{
+	// Centering on the box and reaching out to the farthest vertex.
+	XMVECTOR vCenter = XMVectorScale(XMVectorAdd(XMLoadFloat3(&a_v3Min), XMLoadFloat3(&a_v3Max)), 0.5f);
+	XMVECTOR vRadiusSq = XMVectorZero();
+	for (int i = 0; i < a_dVertexCount; i++)
 	{
-		// Grab the two vectors
-		XMVECTOR normal = XMLoadFloat3(&verts[i].Normal);
-		XMVECTOR tangent = XMLoadFloat3(&verts[i].Tangent);
-		// Use Gram-Schmidt orthonormalize to ensure
-		// the normal and tangent are exactly 90 degrees apart
-		tangent = XMVector3Normalize(
-			tangent - normal * XMVector3Dot(normal, tangent));
-		// Store the tangent
-		XMStoreFloat3(&verts[i].Tangent, tangent);
+		XMVECTOR vOffset = XMVectorSubtract(XMLoadFloat3(&a_pVertices[i].Position), vCenter);
+		vRadiusSq = XMVectorMax(vRadiusSq, XMVector3LengthSq(vOffset));
 	}
-}
\ No newline at end of file
+	XMStoreFloat3(&a_v3Center, vCenter);
+	a_fRadius = XMVectorGetX(XMVectorSqrt(vRadiusSq));
+}
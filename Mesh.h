@@ -3,10 +3,57 @@
 
 #include <d3d11.h>
 #include <wrl/client.h>
+#include <string>
+#include <memory>
+#include <vector>
 #include "Vertex.h"
+#include "MeshOptimizer.h"
+#include "MeshCache.h"
+#include "MeshSimplifier.h"
+#include "MeshletCuller.h"
 
 typedef Microsoft::WRL::ComPtr<ID3D11Buffer> BufferPtr;
 
+/// <summary>
+/// Optional processing steps applied when a Mesh is loaded from a file.
+/// </summary>
+struct MeshLoadOptions
+{
+	bool OptimizeVertexCache = true;	// Reorders triangles and vertices for post-transform cache reuse.
+	bool UseBinaryCache = true;			// Loads from/saves to a .meshcache file next to the obj file.
+	bool CompressVertices = false;		// Stores CompressedVertex on the GPU, draw it with CompressedVertexShader.
+	bool GenerateLods = true;			// Appends simplified levels of detail to the index buffer, see MeshSimplifier.
+	bool BuildMeshlets = false;			// Splits the full detail level into meshlets for culling, see MeshletBuilder.
+};
+
+/// <summary>
+/// Everything loading a Mesh from a file produces before the graphics device
+/// is needed.  Mesh::Load fills one in on any thread, and the Mesh constructor
+/// taking it creates the buffers on the device thread.
+/// </summary>
+struct MeshData
+{
+	std::string Name;
+	MeshLoadOptions Options;
+	std::shared_ptr<MeshCache> Cache;			// Set when the arrays are read straight out of a .meshcache.
+	std::vector<Vertex> Vertices;				// Unused when Cache is set.
+	std::vector<unsigned int> Indices;			// Unused when Cache is set.
+	std::vector<uint16_t> NarrowedIndices;		// Indices as 16 bits when IndexStride is 2, unused when Cache is set.
+	std::vector<Meshlet> Meshlets;				// Unused when Cache is set.
+	int VertexCount;
+	int IndexCount;								// Across every level of detail.
+	unsigned int IndexStride;
+	int UnweldedVertexCount;
+	VertexCacheStats LoadedStats;
+	VertexCacheStats OptimizedStats;
+	DirectX::XMFLOAT3 BoundsMin;
+	DirectX::XMFLOAT3 BoundsMax;
+	DirectX::XMFLOAT3 SphereCenter;
+	float SphereRadius;
+	MeshLod Lods[MeshSimplifier::MAX_LOD_COUNT];
+	unsigned int LodCount;
+};
+
 /// <summary>
 /// Manages Vertex/Index Buffer objects for rendering to the window.
 /// </summary>
@@ -15,8 +62,25 @@ class Mesh
 private:
 	BufferPtr m_pVertexBuffer;
 	BufferPtr m_pIndexBuffer;
-	int m_dIndexCount;
+	int m_dIndexCount;								// Of the full detail level only.
 	int m_dVertexCount;
+	int m_dUnweldedVertexCount;
+	std::string m_sName;
+	VertexCacheStats m_vcsLoaded;
+	VertexCacheStats m_vcsOptimized;
+	DirectX::XMFLOAT3 m_v3BoundsMin;
+	DirectX::XMFLOAT3 m_v3BoundsMax;
+	DirectX::XMFLOAT3 m_v3SphereCenter;
+	float m_fSphereRadius;
+	bool m_bLoadedFromCache;
+	bool m_bCompressed;
+	UINT m_uVertexStride;
+	DXGI_FORMAT m_fIndexFormat;
+	std::vector<DirectX::XMFLOAT3> m_lPositions;	// CPU side copies for occlusion culling.
+	std::vector<unsigned int> m_lIndices;
+	MeshLod m_pLods[MeshSimplifier::MAX_LOD_COUNT];
+	unsigned int m_uLodCount;
+	std::vector<Meshlet> m_lMeshlets;				// Of the full detail level, empty if it was not split.
 
 public:
 	
@@ -28,13 +92,30 @@ public:
 	/// <param name="a_dVertexCount">The quantity of vertices in the array.</param>
 	/// <param name="a_pIndices">The indices inside of this instance of a Mesh object.</param>
 	/// <param name="a_dIndexCount">The amount of indices in the array.</param>
-	Mesh(Vertex* a_pVertices, int a_dVertexCount, unsigned int* a_pIndices, int a_dIndexCount);
+	/// <param name="a_bCompressVertices">Whether to store the vertices as CompressedVertex on the GPU.</param>
+	Mesh(Vertex* a_pVertices, int a_dVertexCount, unsigned int* a_pIndices, int a_dIndexCount, bool a_bCompressVertices = false);
 
 	/// <summary>
 	/// Loads in the vertices from an obj file.
 	/// </summary>
 	/// <param name="a_sFilepath">File path to the obj file.</param>
-	Mesh(const char* a_sFilepath);
+	/// <param name="a_mloOptions">Processing steps applied to the loaded data.</param>
+	Mesh(const char* a_sFilepath, MeshLoadOptions a_mloOptions = MeshLoadOptions());
+
+	/// <summary>
+	/// Creates the buffers for data loaded with Mesh::Load.  Only call from the device thread.
+	/// </summary>
+	/// <param name="a_mdData">The loaded mesh data.</param>
+	Mesh(const MeshData& a_mdData);
+
+	/// <summary>
+	/// Does all of the file reading and processing of the obj file constructor without
+	/// touching the graphics device, so it is safe to run on a worker thread.
+	/// </summary>
+	/// <param name="a_sFilepath">File path to the obj file.</param>
+	/// <param name="a_mloOptions">Processing steps applied to the loaded data.</param>
+	/// <returns>The data to construct the Mesh from.</returns>
+	static MeshData Load(const char* a_sFilepath, MeshLoadOptions a_mloOptions = MeshLoadOptions());
 
 	#pragma region Rule of Three
 	/// <summary>
@@ -68,9 +149,9 @@ public:
 	BufferPtr GetIndexBuffer(void);
 
 	/// <summary>
-	/// Retrieves the amount of indices in the Index Buffer.
+	/// Retrieves the amount of indices of the full detail level in the Index Buffer.
 	/// </summary>
-	/// <returns>The amount of indices in the Index Buffer.</returns>
+	/// <returns>The amount of indices drawn at level of detail 0.</returns>
 	int GetIndexCount(void);
 
 	/// <summary>
@@ -79,18 +160,157 @@ public:
 	/// <returns>The amount of vertices in the Vertex Buffer.</returns>
 	int GetVertexCount(void);
 
+	/// <summary>
+	/// Retrieves the amount of vertices the mesh would need without any vertex reuse.
+	/// </summary>
+	/// <returns>Three vertices per triangle.</returns>
+	int GetUnweldedVertexCount(void);
+
+	/// <summary>
+	/// Retrieves the name of the mesh (the file it was loaded from, if any).
+	/// </summary>
+	/// <returns>The name of the mesh.</returns>
+	std::string GetName(void);
+
+	/// <summary>
+	/// Retrieves the simulated vertex cache behaviour of the index buffer.
+	/// </summary>
+	/// <param name="a_bOptimized">Whether to get the stats after the cache optimization pass or as loaded.</param>
+	/// <returns>The ACMR/ATVR of the index buffer.</returns>
+	VertexCacheStats GetVertexCacheStats(bool a_bOptimized);
+
+	/// <summary>
+	/// Retrieves the minimum corner of the mesh's local space bounding box.
+	/// </summary>
+	/// <returns>The minimum corner of the bounds.</returns>
+	DirectX::XMFLOAT3 GetBoundsMin(void);
+
+	/// <summary>
+	/// Retrieves the maximum corner of the mesh's local space bounding box.
+	/// </summary>
+	/// <returns>The maximum corner of the bounds.</returns>
+	DirectX::XMFLOAT3 GetBoundsMax(void);
+
+	/// <summary>
+	/// Retrieves the center of the mesh's local space bounding sphere.
+	/// </summary>
+	/// <returns>The center of the sphere.</returns>
+	DirectX::XMFLOAT3 GetSphereCenter(void);
+
+	/// <summary>
+	/// Retrieves the radius of the mesh's local space bounding sphere.
+	/// </summary>
+	/// <returns>The radius of the sphere.</returns>
+	float GetSphereRadius(void);
+
+	/// <summary>
+	/// Retrieves whether the mesh came out of a binary .meshcache file instead of being parsed.
+	/// </summary>
+	/// <returns>True if the obj text was skipped.</returns>
+	bool WasLoadedFromCache(void);
+
+	/// <summary>
+	/// Retrieves whether the vertex buffer holds CompressedVertex instead of Vertex.
+	/// Compressed meshes need CompressedVertexShader and their bounds set to draw.
+	/// </summary>
+	/// <returns>True if the vertices are compressed.</returns>
+	bool IsCompressed(void);
+
+	/// <summary>
+	/// Retrieves the size in bytes of a single vertex in the vertex buffer.
+	/// </summary>
+	/// <returns>sizeof(CompressedVertex) or sizeof(Vertex).</returns>
+	UINT GetVertexStride(void);
+
+	/// <summary>
+	/// Retrieves the format of the index buffer, 16 bit whenever the vertex count allows it.
+	/// </summary>
+	/// <returns>DXGI_FORMAT_R16_UINT or DXGI_FORMAT_R32_UINT.</returns>
+	DXGI_FORMAT GetIndexFormat(void);
+
+	/// <summary>
+	/// Retrieves a CPU side copy of the vertex positions, for rasterizing the mesh as an occluder.
+	/// </summary>
+	/// <returns>One position per vertex, in the vertex buffer's order.</returns>
+	const std::vector<DirectX::XMFLOAT3>& GetPositions(void);
+
+	/// <summary>
+	/// Retrieves a CPU side copy of the full detail level of the index buffer, widened to 32 bits.
+	/// </summary>
+	/// <returns>Three indices per triangle.</returns>
+	const std::vector<unsigned int>& GetIndices(void);
+
+	/// <summary>
+	/// Retrieves the amount of levels of detail in the index buffer, at least 1.
+	/// </summary>
+	/// <returns>The amount of levels of detail.</returns>
+	unsigned int GetLodCount(void);
+
+	/// <summary>
+	/// Retrieves the index range and simplification error of a level of detail.
+	/// </summary>
+	/// <param name="a_uLod">The level, 0 being full detail.</param>
+	/// <returns>The level of detail.</returns>
+	const MeshLod& GetLod(unsigned int a_uLod);
+
+	/// <summary>
+	/// Retrieves the meshlets the full detail level was split into, if it was.
+	/// </summary>
+	/// <returns>The meshlets, in index buffer order.</returns>
+	const std::vector<Meshlet>& GetMeshlets(void);
+
 	// Functional Methods:
+	/// <summary>
+	/// Picks the coarsest level of detail whose error stays under about a pixel.
+	/// </summary>
+	/// <param name="a_fScreenDiameter">How many pixels the bounding sphere's diameter covers on screen.</param>
+	/// <param name="a_fBias">Scales the allowed error in pixels, above 1 switches to coarser levels sooner.</param>
+	/// <returns>The level of detail to draw.</returns>
+	unsigned int SelectLod(float a_fScreenDiameter, float a_fBias = 1.0f);
+
 	/// <summary>
 	/// Sets the buffers and draws with the proper amount of indices.
 	/// </summary>
-	void Draw(void);
+	/// <param name="a_uLod">The level of detail to draw, 0 being full detail.</param>
+	void Draw(unsigned int a_uLod = 0);
+
+	/// <summary>
+	/// Sets the buffers and draws only some ranges of the index buffer, such as the meshlets left after culling.
+	/// </summary>
+	/// <param name="a_pRanges">The ranges of indices to draw.</param>
+	/// <param name="a_uRangeCount">The amount of ranges, one draw call each.</param>
+	void Draw(const IndexRange* a_pRanges, unsigned int a_uRangeCount);
+
+	/// <summary>
+	/// Sets the buffers and draws a level of detail once per instance, with
+	/// the instance data already bound to slot 1.
+	/// </summary>
+	/// <param name="a_uLod">The level of detail to draw, 0 being full detail.</param>
+	/// <param name="a_uInstanceCount">The amount of instances.</param>
+	/// <param name="a_uFirstInstance">The first instance's position in the instance buffer.</param>
+	void DrawInstanced(unsigned int a_uLod, unsigned int a_uInstanceCount, unsigned int a_uFirstInstance);
 
 private:
-	void CalculateTangents(
-		Vertex* a_lVertices, 
+	void CreateBuffers(
+		const Vertex* a_pVertices,
 		int a_dVertexCount,
-		unsigned int* a_lIndices, 
+		const void* a_pIndices,
+		UINT a_uIndexStride,
 		int a_dIndexCount);
+
+	static void CalculateBounds(
+		const Vertex* a_pVertices,
+		int a_dVertexCount,
+		DirectX::XMFLOAT3& a_v3Min,
+		DirectX::XMFLOAT3& a_v3Max);
+
+	static void CalculateBoundingSphere(
+		const Vertex* a_pVertices,
+		int a_dVertexCount,
+		DirectX::XMFLOAT3 a_v3Min,
+		DirectX::XMFLOAT3 a_v3Max,
+		DirectX::XMFLOAT3& a_v3Center,
+		float& a_fRadius);
 };
 
 #endif //__MESH_H_
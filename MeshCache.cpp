@@ -0,0 +1,157 @@
+#include "MeshCache.h"
+
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+	/// <summary>
+	/// Gets the size and last write time of a file, used to detect stale caches.
+	/// </summary>
+	bool GetSourceStamp(const char* a_sSourcePath, uint64_t& a_uSize, int64_t& a_dModifiedTime)
+	{
+		std::error_code error;
+		std::filesystem::path path(a_sSourcePath);
+
+		uintmax_t uSize = std::filesystem::file_size(path, error);
+		if (error) return false;
+
+		std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+		if (error) return false;
+
+		a_uSize = static_cast<uint64_t>(uSize);
+		a_dModifiedTime = static_cast<int64_t>(time.time_since_epoch().count());
+		return true;
+	}
+
+	/// <summary>
+	/// Bytes of padding after the index array, keeping the meshlets after it 4 byte aligned.
+	/// </summary>
+	size_t MeshletPadding(uint64_t a_uIndexBytes)
+	{
+		return static_cast<size_t>((4 - a_uIndexBytes % 4) % 4);
+	}
+
+	/// <summary>
+	/// 32 bit FNV-1a over a block of bytes, continuing from a previous hash.
+	/// </summary>
+	uint32_t Checksum(const void* a_pData, size_t a_uSize, uint32_t a_uHash = 2166136261u)
+	{
+		const unsigned char* pBytes = static_cast<const unsigned char*>(a_pData);
+		for (size_t i = 0; i < a_uSize; i++)
+		{
+			a_uHash ^= pBytes[i];
+			a_uHash *= 16777619u;
+		}
+		return a_uHash;
+	}
+}
+
+MeshCache::MeshCache(const char* a_sSourcePath, uint32_t a_uOptionFlags) :
+	m_mfFile(GetCachePath(a_sSourcePath).c_str()),
+	m_pHeader(nullptr)
+{
+	if (!m_mfFile.IsOpen() || m_mfFile.GetSize() < sizeof(MeshCacheHeader)) return;
+
+	// Checking that the cache was written by this build for this exact obj file.
+	const MeshCacheHeader* pHeader = reinterpret_cast<const MeshCacheHeader*>(m_mfFile.GetData());
+	if (pHeader->Magic != MAGIC ||
+		pHeader->Version != VERSION ||
+		pHeader->VertexStride != sizeof(Vertex) ||
+		pHeader->OptionFlags != a_uOptionFlags ||
+		(pHeader->IndexStride != 2 && pHeader->IndexStride != 4) ||
+		pHeader->LodCount == 0 || pHeader->LodCount > MeshSimplifier::MAX_LOD_COUNT)
+		return;
+
+	uint64_t uSourceSize = 0;
+	int64_t dSourceTime = 0;
+	if (!GetSourceStamp(a_sSourcePath, uSourceSize, dSourceTime) ||
+		pHeader->SourceSize != uSourceSize ||
+		pHeader->SourceModifiedTime != dSourceTime)
+		return;
+
+	// Making sure the arrays are all there.
+	uint64_t uVertexBytes = static_cast<uint64_t>(pHeader->VertexCount) * pHeader->VertexStride;
+	uint64_t uIndexBytes = static_cast<uint64_t>(pHeader->IndexCount) * pHeader->IndexStride;
+	uint64_t uMeshletBytes = MeshletPadding(uIndexBytes) + static_cast<uint64_t>(pHeader->MeshletCount) * sizeof(Meshlet);
+	if (m_mfFile.GetSize() != sizeof(MeshCacheHeader) + uVertexBytes + uIndexBytes + uMeshletBytes) return;
+	for (uint32_t i = 0; i < pHeader->LodCount; i++)
+	{
+		if (static_cast<uint64_t>(pHeader->Lods[i].IndexStart) + pHeader->Lods[i].IndexCount > pHeader->IndexCount) return;
+	}
+
+	// Hashing the payload would touch every page of the mapping, which is most of what loading
+	// from the cache costs, so only debug and validating builds look past the header.
+#if defined(DEBUG) || defined(_DEBUG) || defined(MESHCACHE_VALIDATE)
+	const char* pPayload = m_mfFile.GetData() + sizeof(MeshCacheHeader);
+	if (Checksum(pPayload, static_cast<size_t>(uVertexBytes + uIndexBytes + uMeshletBytes)) != pHeader->Checksum) return;
+#endif
+
+	m_pHeader = pHeader;
+}
+
+bool MeshCache::IsValid(void) const { return m_pHeader != nullptr; }
+const MeshCacheHeader& MeshCache::GetHeader(void) const { return *m_pHeader; }
+
+const Vertex* MeshCache::GetVertices(void) const
+{
+	return reinterpret_cast<const Vertex*>(m_mfFile.GetData() + sizeof(MeshCacheHeader));
+}
+
+const void* MeshCache::GetIndices(void) const
+{
+	return m_mfFile.GetData() + sizeof(MeshCacheHeader) + static_cast<size_t>(m_pHeader->VertexCount) * sizeof(Vertex);
+}
+
+const Meshlet* MeshCache::GetMeshlets(void) const
+{
+	size_t uIndexBytes = static_cast<size_t>(m_pHeader->IndexCount) * m_pHeader->IndexStride;
+	return reinterpret_cast<const Meshlet*>(static_cast<const char*>(GetIndices()) + uIndexBytes + MeshletPadding(uIndexBytes));
+}
+
+bool MeshCache::Write(const char* a_sSourcePath, MeshCacheHeader a_mchHeader, const Vertex* a_pVertices, const void* a_pIndices, const Meshlet* a_pMeshlets)
+{
+	// Stamping the header with everything the reader validates against.
+	a_mchHeader.Magic = MAGIC;
+	a_mchHeader.Version = VERSION;
+	a_mchHeader.VertexStride = sizeof(Vertex);
+	if (!GetSourceStamp(a_sSourcePath, a_mchHeader.SourceSize, a_mchHeader.SourceModifiedTime)) return false;
+
+	size_t uVertexBytes = static_cast<size_t>(a_mchHeader.VertexCount) * sizeof(Vertex);
+	size_t uIndexBytes = static_cast<size_t>(a_mchHeader.IndexCount) * a_mchHeader.IndexStride;
+	size_t uMeshletBytes = a_pMeshlets != nullptr ? static_cast<size_t>(a_mchHeader.MeshletCount) * sizeof(Meshlet) : 0;
+	a_mchHeader.MeshletCount = static_cast<uint32_t>(uMeshletBytes / sizeof(Meshlet));
+	const char pPadding[4] = {};
+	size_t uPaddingBytes = MeshletPadding(uIndexBytes);
+	uint32_t uHash = Checksum(pPadding, uPaddingBytes, Checksum(a_pIndices, uIndexBytes, Checksum(a_pVertices, uVertexBytes)));
+	a_mchHeader.Checksum = Checksum(a_pMeshlets, uMeshletBytes, uHash);
+
+	// Writing to a temporary file first so a half written cache is never picked up.
+	std::string sCachePath = GetCachePath(a_sSourcePath);
+	std::string sTempPath = sCachePath + ".tmp";
+	{
+		std::ofstream file(sTempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) return false;
+
+		file.write(reinterpret_cast<const char*>(&a_mchHeader), sizeof(MeshCacheHeader));
+		file.write(reinterpret_cast<const char*>(a_pVertices), uVertexBytes);
+		file.write(reinterpret_cast<const char*>(a_pIndices), uIndexBytes);
+		file.write(pPadding, uPaddingBytes);
+		file.write(reinterpret_cast<const char*>(a_pMeshlets), uMeshletBytes);
+		if (!file.good()) return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(sTempPath, sCachePath, error);
+	if (error)
+	{
+		std::filesystem::remove(sTempPath, error);
+		return false;
+	}
+	return true;
+}
+
+std::string MeshCache::GetCachePath(const char* a_sSourcePath)
+{
+	return std::string(a_sSourcePath) + ".meshcache";
+}
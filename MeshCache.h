@@ -0,0 +1,118 @@
+#ifndef __MESHCACHE_H_
+#define __MESHCACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <DirectXMath.h>
+#include "Vertex.h"
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
+
+/// <summary>
+/// Fixed size header at the start of every .meshcache file.  The vertex array
+/// immediately follows it, then the index array holding every level of detail,
+/// then the meshlets if any.
+/// </summary>
+struct MeshCacheHeader
+{
+	uint32_t Magic;						// Always MeshCache::MAGIC.
+	uint32_t Version;					// Bumped whenever the layout of the file or of Vertex changes.
+	uint64_t SourceSize;				// Size in bytes of the obj file the cache was built from.
+	int64_t SourceModifiedTime;			// Last write time of the obj file the cache was built from.
+	uint32_t OptionFlags;				// The MeshLoadOptions the data was processed with.
+	uint32_t VertexStride;				// sizeof(Vertex) when the cache was written.
+	uint32_t VertexCount;
+	uint32_t IndexCount;				// Across every level of detail.
+	uint32_t IndexStride;				// 2 or 4 bytes per index.
+	uint32_t UnweldedVertexCount;
+	VertexCacheStats LoadedStats;
+	VertexCacheStats OptimizedStats;
+	DirectX::XMFLOAT3 BoundsMin;
+	DirectX::XMFLOAT3 BoundsMax;
+	DirectX::XMFLOAT3 SphereCenter;
+	float SphereRadius;
+	uint32_t LodCount;
+	MeshLod Lods[MeshSimplifier::MAX_LOD_COUNT];
+	uint32_t MeshletCount;				// Covering the full detail level, 0 if it was not split.
+	uint32_t Checksum;					// FNV-1a of everything after the header, only verified by debug builds.
+};
+
+/// <summary>
+/// Memory-mapped binary copy of a fully processed mesh, stored next to the
+/// obj file it was built from.  Loading one skips parsing, welding, cache
+/// optimization and tangent generation entirely.
+/// </summary>
+class MeshCache
+{
+private:
+	MappedFile m_mfFile;
+	const MeshCacheHeader* m_pHeader;
+
+public:
+	static const uint32_t MAGIC = 0x4843534D;	// "MSCH"
+	static const uint32_t VERSION = 5;
+
+	/// <summary>
+	/// Maps the cache belonging to an obj file and validates it against the
+	/// obj file's size and modification time and the requested options.
+	/// </summary>
+	/// <param name="a_sSourcePath">Path to the obj file (not the cache itself).</param>
+	/// <param name="a_uOptionFlags">The options the data needs to have been processed with.</param>
+	MeshCache(const char* a_sSourcePath, uint32_t a_uOptionFlags);
+
+	MeshCache(const MeshCache&) = delete;
+	MeshCache& operator=(const MeshCache&) = delete;
+
+	/// <summary>
+	/// Whether or not a cache exists and is up to date with its obj file.
+	/// </summary>
+	/// <returns>True if the header and arrays can be used.</returns>
+	bool IsValid(void) const;
+
+	/// <summary>
+	/// Retrieves the header of the cache.  Only call if IsValid().
+	/// </summary>
+	/// <returns>The cache header.</returns>
+	const MeshCacheHeader& GetHeader(void) const;
+
+	/// <summary>
+	/// Retrieves the vertex array, straight out of the mapping.
+	/// </summary>
+	/// <returns>Pointer to GetHeader().VertexCount vertices.</returns>
+	const Vertex* GetVertices(void) const;
+
+	/// <summary>
+	/// Retrieves the index array, straight out of the mapping.
+	/// </summary>
+	/// <returns>Pointer to GetHeader().IndexCount indices of GetHeader().IndexStride bytes each.</returns>
+	const void* GetIndices(void) const;
+
+	/// <summary>
+	/// Retrieves the meshlet array, straight out of the mapping.
+	/// </summary>
+	/// <returns>Pointer to GetHeader().MeshletCount meshlets.</returns>
+	const Meshlet* GetMeshlets(void) const;
+
+	/// <summary>
+	/// Writes a cache file for an obj file.  Failures are silently ignored,
+	/// the mesh just gets parsed from text again next time.
+	/// </summary>
+	/// <param name="a_sSourcePath">Path to the obj file (not the cache itself).</param>
+	/// <param name="a_mchHeader">Header with the counts, stats, bounds and options filled in.  The rest is filled in here.</param>
+	/// <param name="a_pVertices">The final vertex array.</param>
+	/// <param name="a_pIndices">The final index array.</param>
+	/// <param name="a_pMeshlets">The meshlets, only read if the header has any.</param>
+	/// <returns>True if the cache was written.</returns>
+	static bool Write(const char* a_sSourcePath, MeshCacheHeader a_mchHeader, const Vertex* a_pVertices, const void* a_pIndices, const Meshlet* a_pMeshlets = nullptr);
+
+	/// <summary>
+	/// Gets the path of the cache file belonging to an obj file.
+	/// </summary>
+	/// <param name="a_sSourcePath">Path to the obj file.</param>
+	/// <returns>The obj path with .meshcache appended.</returns>
+	static std::string GetCachePath(const char* a_sSourcePath);
+};
+
+#endif //__MESHCACHE_H_
@@ -0,0 +1,279 @@
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <climits>
+#include <vector>
+
+namespace
+{
+	// Tuning values from "Linear-Speed Vertex Cache Optimisation" (Tom Forsyth, 2006).
+	const int g_dScoringCacheSize = 32;
+	const float g_fCacheDecayPower = 1.5f;
+	const float g_fLastTriangleScore = 0.75f;
+	const float g_fValenceBoostScale = 2.0f;
+	const float g_fValenceBoostPower = 0.5f;
+	const int g_dMaxScoredValence = 64;
+
+	const size_t NO_TRIANGLE = static_cast<size_t>(-1);
+
+	/// <summary>
+	/// Precomputed vertex scores by cache position and by remaining triangle count.
+	/// </summary>
+	struct ScoreTables
+	{
+		float CachePosition[g_dScoringCacheSize];
+		float Valence[g_dMaxScoredValence + 1];
+
+		ScoreTables()
+		{
+			for (int i = 0; i < g_dScoringCacheSize; i++)
+			{
+				// The three vertices of the last triangle get a fixed score so that
+				// the strip does not simply ping-pong back onto its own edge.
+				if (i < 3)
+				{
+					CachePosition[i] = g_fLastTriangleScore;
+				}
+				else
+				{
+					float fScaler = 1.0f / (g_dScoringCacheSize - 3);
+					CachePosition[i] = powf(1.0f - (i - 3) * fScaler, g_fCacheDecayPower);
+				}
+			}
+
+			Valence[0] = 0.0f;
+			for (int i = 1; i <= g_dMaxScoredValence; i++)
+			{
+				// Boosting vertices with few triangles left so they get finished off.
+				Valence[i] = g_fValenceBoostScale * powf(static_cast<float>(i), -g_fValenceBoostPower);
+			}
+		}
+
+		float Score(int a_dCachePosition, unsigned int a_uRemainingTriangles) const
+		{
+			if (a_uRemainingTriangles == 0) return -1.0f;
+
+			float fScore = a_dCachePosition >= 0 ? CachePosition[a_dCachePosition] : 0.0f;
+			unsigned int uValence = a_uRemainingTriangles < g_dMaxScoredValence ? a_uRemainingTriangles : g_dMaxScoredValence;
+			return fScore + Valence[uValence];
+		}
+	};
+}
+
+void MeshOptimizer::OptimizeVertexCache(unsigned int* a_pIndices, size_t a_uIndexCount, size_t a_uVertexCount)
+{
+	static const ScoreTables tables;
+
+	size_t uTriangleCount = a_uIndexCount / 3;
+	if (uTriangleCount == 0 || a_uVertexCount == 0) return;
+
+	// Building vertex -> triangle adjacency.  Each vertex's remaining triangles
+	// are always kept at the front of its range in lAdjacency.
+	std::vector<unsigned int> lRemaining(a_uVertexCount, 0);
+	for (size_t i = 0; i < uTriangleCount * 3; i++) lRemaining[a_pIndices[i]]++;
+
+	std::vector<size_t> lOffsets(a_uVertexCount + 1, 0);
+	for (size_t v = 0; v < a_uVertexCount; v++) lOffsets[v + 1] = lOffsets[v] + lRemaining[v];
+
+	std::vector<size_t> lAdjacency(uTriangleCount * 3);
+	std::vector<size_t> lFill(lOffsets.begin(), lOffsets.end() - 1);
+	for (size_t t = 0; t < uTriangleCount; t++)
+	{
+		for (int c = 0; c < 3; c++) lAdjacency[lFill[a_pIndices[t * 3 + c]]++] = t;
+	}
+
+	// Initial vertex and triangle scores.
+	std::vector<int> lCachePosition(a_uVertexCount, -1);
+	std::vector<float> lVertexScore(a_uVertexCount);
+	for (size_t v = 0; v < a_uVertexCount; v++) lVertexScore[v] = tables.Score(-1, lRemaining[v]);
+
+	std::vector<float> lTriangleScore(uTriangleCount);
+	std::vector<bool> lEmitted(uTriangleCount, false);
+	size_t uBestTriangle = 0;
+	for (size_t t = 0; t < uTriangleCount; t++)
+	{
+		lTriangleScore[t] =
+			lVertexScore[a_pIndices[t * 3]] +
+			lVertexScore[a_pIndices[t * 3 + 1]] +
+			lVertexScore[a_pIndices[t * 3 + 2]];
+		if (lTriangleScore[t] > lTriangleScore[uBestTriangle]) uBestTriangle = t;
+	}
+
+	std::vector<unsigned int> lOutput(uTriangleCount * 3);
+	unsigned int lCache[g_dScoringCacheSize + 3];
+	unsigned int lNewCache[g_dScoringCacheSize + 3];
+	int dCacheCount = 0;
+	size_t uScanCursor = 0;
+
+	for (size_t uEmitted = 0; uEmitted < uTriangleCount; uEmitted++)
+	{
+		// Nothing in the cache has triangles left, so just take the next unused one.
+		if (uBestTriangle == NO_TRIANGLE)
+		{
+			while (lEmitted[uScanCursor]) uScanCursor++;
+			uBestTriangle = uScanCursor;
+		}
+
+		const unsigned int* pTriangle = &a_pIndices[uBestTriangle * 3];
+		lEmitted[uBestTriangle] = true;
+		for (int c = 0; c < 3; c++)
+		{
+			unsigned int v = pTriangle[c];
+			lOutput[uEmitted * 3 + c] = v;
+
+			// Removing the triangle from the vertex's remaining set.
+			size_t uBegin = lOffsets[v];
+			size_t uEnd = uBegin + lRemaining[v];
+			for (size_t a = uBegin; a < uEnd; a++)
+			{
+				if (lAdjacency[a] == uBestTriangle)
+				{
+					lAdjacency[a] = lAdjacency[uEnd - 1];
+					break;
+				}
+			}
+			lRemaining[v]--;
+		}
+
+		// Pushing the triangle's vertices to the front of the simulated cache.
+		int dNewCount = 0;
+		for (int c = 0; c < 3; c++) lNewCache[dNewCount++] = pTriangle[c];
+		for (int i = 0; i < dCacheCount; i++)
+		{
+			unsigned int v = lCache[i];
+			if (v != pTriangle[0] && v != pTriangle[1] && v != pTriangle[2]) lNewCache[dNewCount++] = v;
+		}
+
+		// Rescoring everything that moved (including anything that just fell out)
+		// and pushing the change in score onto the vertices' remaining triangles.
+		for (int i = 0; i < dNewCount; i++)
+		{
+			unsigned int v = lNewCache[i];
+			lCachePosition[v] = i < g_dScoringCacheSize ? i : -1;
+
+			float fNewScore = tables.Score(lCachePosition[v], lRemaining[v]);
+			float fDelta = fNewScore - lVertexScore[v];
+			lVertexScore[v] = fNewScore;
+
+			size_t uBegin = lOffsets[v];
+			size_t uEnd = uBegin + lRemaining[v];
+			for (size_t a = uBegin; a < uEnd; a++) lTriangleScore[lAdjacency[a]] += fDelta;
+		}
+
+		dCacheCount = dNewCount < g_dScoringCacheSize ? dNewCount : g_dScoringCacheSize;
+		for (int i = 0; i < dCacheCount; i++) lCache[i] = lNewCache[i];
+
+		// The next triangle is the best scoring one touching the cache.
+		uBestTriangle = NO_TRIANGLE;
+		float fBestScore = -1.0f;
+		for (int i = 0; i < dCacheCount; i++)
+		{
+			unsigned int v = lCache[i];
+			size_t uBegin = lOffsets[v];
+			size_t uEnd = uBegin + lRemaining[v];
+			for (size_t a = uBegin; a < uEnd; a++)
+			{
+				size_t t = lAdjacency[a];
+				if (lTriangleScore[t] > fBestScore)
+				{
+					fBestScore = lTriangleScore[t];
+					uBestTriangle = t;
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < lOutput.size(); i++) a_pIndices[i] = lOutput[i];
+}
+
+size_t MeshOptimizer::OptimizeVertexFetch(Vertex* a_pVertices, size_t a_uVertexCount, unsigned int* a_pIndices, size_t a_uIndexCount)
+{
+	// Handing out new vertex slots in the order the indices first touch them.
+	std::vector<unsigned int> lRemap(a_uVertexCount, UINT_MAX);
+	unsigned int uNextVertex = 0;
+	for (size_t i = 0; i < a_uIndexCount; i++)
+	{
+		unsigned int& uRemapped = lRemap[a_pIndices[i]];
+		if (uRemapped == UINT_MAX) uRemapped = uNextVertex++;
+		a_pIndices[i] = uRemapped;
+	}
+
+	std::vector<Vertex> lReordered(uNextVertex);
+	for (size_t v = 0; v < a_uVertexCount; v++)
+	{
+		if (lRemap[v] != UINT_MAX) lReordered[lRemap[v]] = a_pVertices[v];
+	}
+	for (size_t v = 0; v < lReordered.size(); v++) a_pVertices[v] = lReordered[v];
+
+	return uNextVertex;
+}
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(
+	const unsigned int* a_pIndices,
+	size_t a_uIndexCount,
+	size_t a_uVertexCount,
+	unsigned int a_uCacheSize,
+	VertexCacheModel a_vcmModel)
+{
+	VertexCacheStats stats = {};
+	if (a_uIndexCount < 3 || a_uVertexCount == 0 || a_uCacheSize == 0) return stats;
+
+	std::vector<bool> lReferenced(a_uVertexCount, false);
+	unsigned int uUniqueVertices = 0;
+
+	// FIFO: each vertex remembers how many insertions had happened when it entered,
+	// so it is a hit if fewer than a_uCacheSize insertions have happened since.
+	std::vector<unsigned int> lInsertedAt(a_uVertexCount, 0);
+	unsigned int uInsertions = a_uCacheSize + 1;
+
+	// LRU: an explicit most-recently-used-first list, the cache is small enough to scan.
+	std::vector<unsigned int> lRecent;
+	lRecent.reserve(a_uCacheSize);
+
+	for (size_t i = 0; i < a_uIndexCount; i++)
+	{
+		unsigned int v = a_pIndices[i];
+		if (!lReferenced[v])
+		{
+			lReferenced[v] = true;
+			uUniqueVertices++;
+		}
+
+		if (a_vcmModel == VertexCacheModel::FIFO)
+		{
+			bool bHit = lInsertedAt[v] != 0 && uInsertions - lInsertedAt[v] <= a_uCacheSize;
+			if (!bHit)
+			{
+				stats.TransformCount++;
+				lInsertedAt[v] = uInsertions++;
+			}
+		}
+		else
+		{
+			size_t uFound = lRecent.size();
+			for (size_t c = 0; c < lRecent.size(); c++)
+			{
+				if (lRecent[c] == v)
+				{
+					uFound = c;
+					break;
+				}
+			}
+
+			if (uFound == lRecent.size())
+			{
+				stats.TransformCount++;
+				if (lRecent.size() < a_uCacheSize) lRecent.push_back(v);
+				uFound = lRecent.size() - 1;
+			}
+
+			// Moving the vertex to the front, evicting the back entry on a miss.
+			for (size_t c = uFound; c > 0; c--) lRecent[c] = lRecent[c - 1];
+			lRecent[0] = v;
+		}
+	}
+
+	stats.ACMR = static_cast<float>(stats.TransformCount) / static_cast<float>(a_uIndexCount / 3);
+	stats.ATVR = static_cast<float>(stats.TransformCount) / static_cast<float>(uUniqueVertices);
+	return stats;
+}
@@ -0,0 +1,69 @@
+#ifndef __MESHOPTIMIZER_H_
+#define __MESHOPTIMIZER_H_
+
+#include <cstddef>
+#include "Vertex.h"
+
+/// <summary>
+/// Results of running an index buffer through a simulated post-transform vertex cache.
+/// </summary>
+struct VertexCacheStats
+{
+	float ACMR;						// Average cache miss ratio: vertex shader invocations per triangle (0.5 - 3.0).
+	float ATVR;						// Average transformed vertex ratio: vertex shader invocations per unique vertex (1.0+).
+	unsigned int TransformCount;	// Total simulated vertex shader invocations.
+};
+
+/// <summary>
+/// Replacement policy of the simulated post-transform cache.
+/// </summary>
+enum class VertexCacheModel
+{
+	FIFO,
+	LRU
+};
+
+/// <summary>
+/// CPU-side index/vertex buffer reordering for better GPU vertex reuse.  None
+/// of these functions touch the graphics device.
+/// </summary>
+namespace MeshOptimizer
+{
+	/// <summary>
+	/// Reorders the triangles of an indexed triangle list in place for post-transform
+	/// cache locality using Tom Forsyth's linear-speed vertex cache optimization.
+	/// </summary>
+	/// <param name="a_pIndices">The triangle list being reordered.</param>
+	/// <param name="a_uIndexCount">The amount of indices in the list.</param>
+	/// <param name="a_uVertexCount">The amount of vertices the indices reference.</param>
+	void OptimizeVertexCache(unsigned int* a_pIndices, size_t a_uIndexCount, size_t a_uVertexCount);
+
+	/// <summary>
+	/// Reorders vertices into the order the index buffer first references them so vertex
+	/// fetches walk memory sequentially.  Unreferenced vertices are dropped.
+	/// </summary>
+	/// <param name="a_pVertices">The vertices being reordered.</param>
+	/// <param name="a_uVertexCount">The amount of vertices.</param>
+	/// <param name="a_pIndices">The indices, remapped in place to the new order.</param>
+	/// <param name="a_uIndexCount">The amount of indices.</param>
+	/// <returns>The amount of vertices left after reordering.</returns>
+	size_t OptimizeVertexFetch(Vertex* a_pVertices, size_t a_uVertexCount, unsigned int* a_pIndices, size_t a_uIndexCount);
+
+	/// <summary>
+	/// Simulates a post-transform vertex cache over a triangle list.
+	/// </summary>
+	/// <param name="a_pIndices">The triangle list being measured.</param>
+	/// <param name="a_uIndexCount">The amount of indices in the list.</param>
+	/// <param name="a_uVertexCount">The amount of vertices the indices reference.</param>
+	/// <param name="a_uCacheSize">The amount of entries in the simulated cache.</param>
+	/// <param name="a_vcmModel">The replacement policy of the simulated cache.</param>
+	/// <returns>ACMR/ATVR of the triangle list.</returns>
+	VertexCacheStats AnalyzeVertexCache(
+		const unsigned int* a_pIndices,
+		size_t a_uIndexCount,
+		size_t a_uVertexCount,
+		unsigned int a_uCacheSize = 16,
+		VertexCacheModel a_vcmModel = VertexCacheModel::FIFO);
+}
+
+#endif //__MESHOPTIMIZER_H_
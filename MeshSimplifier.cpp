@@ -0,0 +1,324 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+namespace
+{
+	// A level of detail has to drop at least this fraction of the triangles of the one before it.
+	const float g_fMinLodReduction = 0.2f;
+
+	// Collapses may not turn a triangle further than about 75 degrees, which also keeps slivers from folding over.
+	const float g_fMinNormalCos = 0.25f;
+
+	/// <summary>
+	/// Symmetric 4x4 matrix summing squared distances to a set of planes.
+	/// </summary>
+	struct Quadric
+	{
+		double A00, A01, A02, A03, A11, A12, A13, A22, A23, A33;
+
+		void AddPlane(double a_dX, double a_dY, double a_dZ, double a_dD)
+		{
+			A00 += a_dX * a_dX; A01 += a_dX * a_dY; A02 += a_dX * a_dZ; A03 += a_dX * a_dD;
+			A11 += a_dY * a_dY; A12 += a_dY * a_dZ; A13 += a_dY * a_dD;
+			A22 += a_dZ * a_dZ; A23 += a_dZ * a_dD;
+			A33 += a_dD * a_dD;
+		}
+
+		void Add(const Quadric& a_qOther)
+		{
+			A00 += a_qOther.A00; A01 += a_qOther.A01; A02 += a_qOther.A02; A03 += a_qOther.A03;
+			A11 += a_qOther.A11; A12 += a_qOther.A12; A13 += a_qOther.A13;
+			A22 += a_qOther.A22; A23 += a_qOther.A23;
+			A33 += a_qOther.A33;
+		}
+
+		double Evaluate(const DirectX::XMFLOAT3& a_v3Point) const
+		{
+			double x = a_v3Point.x, y = a_v3Point.y, z = a_v3Point.z;
+			double dError =
+				A00 * x * x + 2.0 * (A01 * x * y + A02 * x * z + A03 * x) +
+				A11 * y * y + 2.0 * (A12 * y * z + A13 * y) +
+				A22 * z * z + 2.0 * A23 * z +
+				A33;
+			return dError > 0.0 ? dError : 0.0;
+		}
+	};
+
+	struct Collapse
+	{
+		double Cost;
+		unsigned int From;
+		unsigned int To;
+
+		bool operator<(const Collapse& a_cOther) const
+		{
+			if (Cost != a_cOther.Cost) return Cost < a_cOther.Cost;
+			if (From != a_cOther.From) return From < a_cOther.From;
+			return To < a_cOther.To;
+		}
+	};
+
+	/// <summary>
+	/// Gives vertices with exactly the same position the same id, lowest vertex index first.
+	/// </summary>
+	std::vector<unsigned int> FindPositionIds(const Vertex* a_pVertices, size_t a_uVertexCount)
+	{
+		std::vector<unsigned int> lOrder(a_uVertexCount);
+		for (size_t v = 0; v < a_uVertexCount; v++) lOrder[v] = static_cast<unsigned int>(v);
+
+		// Comparing the bits so the order is total and the same on every machine.
+		auto key = [&](unsigned int a_uVertex)
+		{
+			uint32_t pBits[3];
+			memcpy(pBits, &a_pVertices[a_uVertex].Position, sizeof(pBits));
+			return std::make_tuple(pBits[0], pBits[1], pBits[2], a_uVertex);
+		};
+		std::sort(lOrder.begin(), lOrder.end(), [&](unsigned int a, unsigned int b) { return key(a) < key(b); });
+
+		std::vector<unsigned int> lIds(a_uVertexCount);
+		for (size_t i = 0; i < a_uVertexCount; i++)
+		{
+			bool bSame = i > 0 && memcmp(&a_pVertices[lOrder[i]].Position, &a_pVertices[lOrder[i - 1]].Position, sizeof(DirectX::XMFLOAT3)) == 0;
+			lIds[lOrder[i]] = bSame ? lIds[lOrder[i - 1]] : lOrder[i];
+		}
+		return lIds;
+	}
+
+	DirectX::XMFLOAT3 TriangleNormal(const DirectX::XMFLOAT3& a_v3A, const DirectX::XMFLOAT3& a_v3B, const DirectX::XMFLOAT3& a_v3C)
+	{
+		float fX1 = a_v3B.x - a_v3A.x, fY1 = a_v3B.y - a_v3A.y, fZ1 = a_v3B.z - a_v3A.z;
+		float fX2 = a_v3C.x - a_v3A.x, fY2 = a_v3C.y - a_v3A.y, fZ2 = a_v3C.z - a_v3A.z;
+		return DirectX::XMFLOAT3(fY1 * fZ2 - fZ1 * fY2, fZ1 * fX2 - fX1 * fZ2, fX1 * fY2 - fY1 * fX2);
+	}
+}
+
+std::vector<unsigned int> MeshSimplifier::Simplify(
+	const Vertex* a_pVertices,
+	size_t a_uVertexCount,
+	const unsigned int* a_pIndices,
+	size_t a_uIndexCount,
+	size_t a_uTargetIndexCount,
+	float a_fTargetError,
+	float* a_pResultError)
+{
+	std::vector<unsigned int> lIndices(a_pIndices, a_pIndices + (a_uIndexCount / 3) * 3);
+	if (a_pResultError) *a_pResultError = 0.0f;
+	if (lIndices.size() <= a_uTargetIndexCount) return lIndices;
+
+	std::vector<unsigned int> lPositionIds = FindPositionIds(a_pVertices, a_uVertexCount);
+
+	// Errors are measured against the bounding box diagonal of the referenced vertices.
+	DirectX::XMFLOAT3 v3Min = a_pVertices[lIndices[0]].Position, v3Max = v3Min;
+	for (unsigned int i : lIndices)
+	{
+		const DirectX::XMFLOAT3& p = a_pVertices[i].Position;
+		v3Min = DirectX::XMFLOAT3(std::min(v3Min.x, p.x), std::min(v3Min.y, p.y), std::min(v3Min.z, p.z));
+		v3Max = DirectX::XMFLOAT3(std::max(v3Max.x, p.x), std::max(v3Max.y, p.y), std::max(v3Max.z, p.z));
+	}
+	double dExtent = sqrt(
+		double(v3Max.x - v3Min.x) * (v3Max.x - v3Min.x) +
+		double(v3Max.y - v3Min.y) * (v3Max.y - v3Min.y) +
+		double(v3Max.z - v3Min.z) * (v3Max.z - v3Min.z));
+	if (dExtent <= 0.0) return lIndices;
+	double dCostLimit = (a_fTargetError * dExtent) * (a_fTargetError * dExtent);
+
+	// Positions shared by several vertices sit on a uv or normal seam.
+	std::vector<unsigned int> lVerticesAtPosition(a_uVertexCount, 0);
+	std::vector<bool> lReferenced(a_uVertexCount, false);
+	for (unsigned int i : lIndices)
+	{
+		if (lReferenced[i]) continue;
+		lReferenced[i] = true;
+		lVerticesAtPosition[lPositionIds[i]]++;
+	}
+	std::vector<bool> lLocked(a_uVertexCount, false);
+	for (size_t v = 0; v < a_uVertexCount; v++)
+	{
+		if (lVerticesAtPosition[v] > 1) lLocked[v] = true;
+	}
+
+	// Edges without a twin running the other way are open borders, edges with several are non-manifold.
+	std::vector<uint64_t> lEdges;
+	lEdges.reserve(lIndices.size());
+	for (size_t t = 0; t < lIndices.size(); t += 3)
+	{
+		for (int e = 0; e < 3; e++)
+		{
+			uint64_t uFrom = lPositionIds[lIndices[t + e]];
+			uint64_t uTo = lPositionIds[lIndices[t + (e + 1) % 3]];
+			if (uFrom != uTo) lEdges.push_back((uFrom << 32) | uTo);
+		}
+	}
+	std::sort(lEdges.begin(), lEdges.end());
+	for (size_t i = 0; i < lEdges.size(); i++)
+	{
+		uint64_t uReverse = (lEdges[i] << 32) | (lEdges[i] >> 32);
+		auto range = std::equal_range(lEdges.begin(), lEdges.end(), uReverse);
+		bool bRepeated = (i > 0 && lEdges[i - 1] == lEdges[i]) || (i + 1 < lEdges.size() && lEdges[i + 1] == lEdges[i]);
+		if (range.first == range.second || range.second - range.first > 1 || bRepeated)
+		{
+			lLocked[static_cast<size_t>(lEdges[i] >> 32)] = true;
+			lLocked[static_cast<size_t>(lEdges[i] & 0xFFFFFFFF)] = true;
+		}
+	}
+
+	// Every position starts out with the planes of the triangles around it.
+	std::vector<Quadric> lQuadrics(a_uVertexCount, Quadric{});
+	for (size_t t = 0; t < lIndices.size(); t += 3)
+	{
+		const DirectX::XMFLOAT3& p0 = a_pVertices[lIndices[t]].Position;
+		DirectX::XMFLOAT3 v3Normal = TriangleNormal(p0, a_pVertices[lIndices[t + 1]].Position, a_pVertices[lIndices[t + 2]].Position);
+		double dLength = sqrt(double(v3Normal.x) * v3Normal.x + double(v3Normal.y) * v3Normal.y + double(v3Normal.z) * v3Normal.z);
+		if (dLength <= 0.0) continue;
+
+		double dX = v3Normal.x / dLength, dY = v3Normal.y / dLength, dZ = v3Normal.z / dLength;
+		double dD = -(dX * p0.x + dY * p0.y + dZ * p0.z);
+		for (int c = 0; c < 3; c++) lQuadrics[lPositionIds[lIndices[t + c]]].AddPlane(dX, dY, dZ, dD);
+	}
+
+	double dWorstCost = 0.0;
+	std::vector<unsigned int> lRemap(a_uVertexCount);
+	for (size_t v = 0; v < a_uVertexCount; v++) lRemap[v] = static_cast<unsigned int>(v);
+
+	// Each pass collapses a set of edges that share no triangles, cheapest first, then rewrites the indices.
+	while (lIndices.size() > a_uTargetIndexCount)
+	{
+		size_t uTriangleCount = lIndices.size() / 3;
+
+		std::vector<Collapse> lCollapses;
+		lCollapses.reserve(lIndices.size() * 2);
+		for (size_t t = 0; t < lIndices.size(); t += 3)
+		{
+			for (int e = 0; e < 3; e++)
+			{
+				unsigned int a = lIndices[t + e], b = lIndices[t + (e + 1) % 3];
+				for (int d = 0; d < 2; d++, std::swap(a, b))
+				{
+					unsigned int uFrom = lPositionIds[a], uTo = lPositionIds[b];
+					if (lLocked[uFrom] || uFrom == uTo) continue;
+
+					Quadric q = lQuadrics[uFrom];
+					q.Add(lQuadrics[uTo]);
+					lCollapses.push_back({ q.Evaluate(a_pVertices[b].Position), a, b });
+				}
+			}
+		}
+		std::sort(lCollapses.begin(), lCollapses.end());
+
+		// Vertex -> triangle adjacency, laid out like MeshOptimizer's.
+		std::vector<size_t> lOffsets(a_uVertexCount + 1, 0);
+		for (unsigned int i : lIndices) lOffsets[i + 1]++;
+		for (size_t v = 0; v < a_uVertexCount; v++) lOffsets[v + 1] += lOffsets[v];
+		std::vector<size_t> lAdjacency(lIndices.size());
+		std::vector<size_t> lFill(lOffsets.begin(), lOffsets.end() - 1);
+		for (size_t t = 0; t < uTriangleCount; t++)
+		{
+			for (int c = 0; c < 3; c++) lAdjacency[lFill[lIndices[t * 3 + c]]++] = t;
+		}
+
+		std::vector<bool> lTouched(a_uVertexCount, false);
+		size_t uTrianglesLeft = uTriangleCount;
+		size_t uCollapsed = 0;
+		for (const Collapse& c : lCollapses)
+		{
+			if (c.Cost > dCostLimit || uTrianglesLeft * 3 <= a_uTargetIndexCount) break;
+			if (lTouched[c.From] || lTouched[c.To]) continue;
+
+			// Rejecting collapses that would turn a surviving triangle too far.
+			bool bFlips = false;
+			size_t uRemoved = 0;
+			unsigned int uToPosition = lPositionIds[c.To];
+			for (size_t a = lOffsets[c.From]; a < lOffsets[c.From + 1] && !bFlips; a++)
+			{
+				const unsigned int* pTriangle = &lIndices[lAdjacency[a] * 3];
+				if (lPositionIds[pTriangle[0]] == uToPosition || lPositionIds[pTriangle[1]] == uToPosition || lPositionIds[pTriangle[2]] == uToPosition)
+				{
+					uRemoved++;
+					continue;
+				}
+
+				DirectX::XMFLOAT3 pBefore[3], pAfter[3];
+				for (int k = 0; k < 3; k++)
+				{
+					pBefore[k] = a_pVertices[pTriangle[k]].Position;
+					pAfter[k] = pTriangle[k] == c.From ? a_pVertices[c.To].Position : pBefore[k];
+				}
+				DirectX::XMFLOAT3 v3Before = TriangleNormal(pBefore[0], pBefore[1], pBefore[2]);
+				DirectX::XMFLOAT3 v3After = TriangleNormal(pAfter[0], pAfter[1], pAfter[2]);
+				float fDot = v3Before.x * v3After.x + v3Before.y * v3After.y + v3Before.z * v3After.z;
+				float fBefore = v3Before.x * v3Before.x + v3Before.y * v3Before.y + v3Before.z * v3Before.z;
+				float fAfter = v3After.x * v3After.x + v3After.y * v3After.y + v3After.z * v3After.z;
+				bFlips = fDot <= 0.0f || fDot * fDot < g_fMinNormalCos * g_fMinNormalCos * fBefore * fAfter;
+			}
+			if (bFlips) continue;
+
+			lRemap[c.From] = c.To;
+			lQuadrics[uToPosition].Add(lQuadrics[lPositionIds[c.From]]);
+			dWorstCost = std::max(dWorstCost, c.Cost);
+			uTrianglesLeft -= uRemoved;
+			uCollapsed++;
+
+			// Everything around the collapsed vertex has changed, it waits for the next pass.
+			for (size_t a = lOffsets[c.From]; a < lOffsets[c.From + 1]; a++)
+			{
+				const unsigned int* pTriangle = &lIndices[lAdjacency[a] * 3];
+				for (int k = 0; k < 3; k++) lTouched[pTriangle[k]] = true;
+			}
+		}
+		if (uCollapsed == 0) break;
+
+		// Rewriting the indices and dropping the triangles that collapsed to a line.
+		size_t uWrite = 0;
+		for (size_t t = 0; t < lIndices.size(); t += 3)
+		{
+			unsigned int a = lRemap[lIndices[t]], b = lRemap[lIndices[t + 1]], c = lRemap[lIndices[t + 2]];
+			unsigned int uA = lPositionIds[a], uB = lPositionIds[b], uC = lPositionIds[c];
+			if (uA == uB || uB == uC || uC == uA) continue;
+
+			lIndices[uWrite++] = a;
+			lIndices[uWrite++] = b;
+			lIndices[uWrite++] = c;
+		}
+		lIndices.resize(uWrite);
+	}
+
+	if (a_pResultError) *a_pResultError = static_cast<float>(sqrt(dWorstCost) / dExtent);
+	return lIndices;
+}
+
+std::vector<unsigned int> MeshSimplifier::GenerateLods(
+	const Vertex* a_pVertices,
+	size_t a_uVertexCount,
+	const unsigned int* a_pIndices,
+	size_t a_uIndexCount,
+	MeshLod* a_pLods,
+	unsigned int& a_uLodCount,
+	float a_fMaxError)
+{
+	std::vector<unsigned int> lAllIndices(a_pIndices, a_pIndices + a_uIndexCount);
+	a_pLods[0] = { 0, static_cast<uint32_t>(a_uIndexCount), 0.0f };
+	a_uLodCount = 1;
+
+	while (a_uLodCount < MAX_LOD_COUNT)
+	{
+		// Always simplifying the full detail mesh, so each level's error is measured against the original.
+		size_t uTarget = ((a_uIndexCount >> a_uLodCount) / 3) * 3;
+		float fError = 0.0f;
+		std::vector<unsigned int> lLod = Simplify(a_pVertices, a_uVertexCount, a_pIndices, a_uIndexCount, uTarget, a_fMaxError, &fError);
+
+		size_t uPrevious = a_pLods[a_uLodCount - 1].IndexCount;
+		if (lLod.empty() || lLod.size() > uPrevious * (1.0f - g_fMinLodReduction)) break;
+
+		MeshOptimizer::OptimizeVertexCache(lLod.data(), lLod.size(), a_uVertexCount);
+		a_pLods[a_uLodCount] = { static_cast<uint32_t>(lAllIndices.size()), static_cast<uint32_t>(lLod.size()), fError };
+		lAllIndices.insert(lAllIndices.end(), lLod.begin(), lLod.end());
+		a_uLodCount++;
+	}
+
+	return lAllIndices;
+}
@@ -0,0 +1,74 @@
+#ifndef __MESHSIMPLIFIER_H_
+#define __MESHSIMPLIFIER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Vertex.h"
+
+/// <summary>
+/// One level of detail of a mesh: a range of its index buffer.
+/// </summary>
+struct MeshLod
+{
+	uint32_t IndexStart;
+	uint32_t IndexCount;
+	float Error;			// Deviation from the full detail mesh, as a fraction of its bounding box diagonal.
+};
+
+/// <summary>
+/// Quadric error metric simplification (Garland and Heckbert, 1997) that only
+/// collapses vertices onto existing ones, so every level of detail indexes the
+/// original vertex buffer.  Vertices on uv/normal seams and open borders never
+/// move, so neither ever cracks.  Deterministic and free of the graphics device.
+/// </summary>
+namespace MeshSimplifier
+{
+	// Levels of detail per mesh, including the full detail one.
+	const unsigned int MAX_LOD_COUNT = 4;
+
+	/// <summary>
+	/// Removes triangles by collapsing edges, cheapest first, until the target
+	/// is reached or the next collapse would exceed the target error.
+	/// </summary>
+	/// <param name="a_pVertices">The vertices.</param>
+	/// <param name="a_uVertexCount">The amount of vertices.</param>
+	/// <param name="a_pIndices">The triangle list being simplified.</param>
+	/// <param name="a_uIndexCount">The amount of indices in the list.</param>
+	/// <param name="a_uTargetIndexCount">The amount of indices to stop at.</param>
+	/// <param name="a_fTargetError">The largest error to allow, as a fraction of the bounding box diagonal.</param>
+	/// <param name="a_pResultError">Receives the error of the result, as a fraction of the bounding box diagonal.</param>
+	/// <returns>The simplified triangle list, indexing the same vertices.</returns>
+	std::vector<unsigned int> Simplify(
+		const Vertex* a_pVertices,
+		size_t a_uVertexCount,
+		const unsigned int* a_pIndices,
+		size_t a_uIndexCount,
+		size_t a_uTargetIndexCount,
+		float a_fTargetError,
+		float* a_pResultError = nullptr);
+
+	/// <summary>
+	/// Builds a chain of levels of detail, each with about half the triangles
+	/// of the one before.  The chain stops early once a level would exceed the
+	/// error limit or barely removes anything.
+	/// </summary>
+	/// <param name="a_pVertices">The vertices.</param>
+	/// <param name="a_uVertexCount">The amount of vertices.</param>
+	/// <param name="a_pIndices">The full detail triangle list.</param>
+	/// <param name="a_uIndexCount">The amount of indices in the list.</param>
+	/// <param name="a_pLods">Receives up to MAX_LOD_COUNT levels, the first being the full detail list.</param>
+	/// <param name="a_uLodCount">Receives the amount of levels.</param>
+	/// <param name="a_fMaxError">The largest error any level may have, as a fraction of the bounding box diagonal.</param>
+	/// <returns>Every level's triangle list one after another, each reordered for the vertex cache after the first.</returns>
+	std::vector<unsigned int> GenerateLods(
+		const Vertex* a_pVertices,
+		size_t a_uVertexCount,
+		const unsigned int* a_pIndices,
+		size_t a_uIndexCount,
+		MeshLod* a_pLods,
+		unsigned int& a_uLodCount,
+		float a_fMaxError = 0.05f);
+}
+
+#endif //__MESHSIMPLIFIER_H_
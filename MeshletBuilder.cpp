@@ -0,0 +1,239 @@
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+
+#include <cmath>
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace
+{
+	// What a candidate facing fully sideways to the meshlet costs, in vertices it would add.
+	const float g_fFacingWeight = 0.5f;
+
+	/// <summary>
+	/// The unit normal of a triangle, or zero if it has no area.
+	/// </summary>
+	XMFLOAT3 TriangleNormal(const Vertex* a_pVertices, const unsigned int* a_pTriangle)
+	{
+		const XMFLOAT3& a = a_pVertices[a_pTriangle[0]].Position;
+		const XMFLOAT3& b = a_pVertices[a_pTriangle[1]].Position;
+		const XMFLOAT3& c = a_pVertices[a_pTriangle[2]].Position;
+		float fX1 = b.x - a.x, fY1 = b.y - a.y, fZ1 = b.z - a.z;
+		float fX2 = c.x - a.x, fY2 = c.y - a.y, fZ2 = c.z - a.z;
+		XMFLOAT3 v3Normal(fY1 * fZ2 - fZ1 * fY2, fZ1 * fX2 - fX1 * fZ2, fX1 * fY2 - fY1 * fX2);
+
+		float fLength = sqrtf(v3Normal.x * v3Normal.x + v3Normal.y * v3Normal.y + v3Normal.z * v3Normal.z);
+		if (fLength <= 0.0f) return XMFLOAT3(0.0f, 0.0f, 0.0f);
+		return XMFLOAT3(v3Normal.x / fLength, v3Normal.y / fLength, v3Normal.z / fLength);
+	}
+
+	XMFLOAT3 Normalize(XMFLOAT3 a_v3Vector)
+	{
+		float fLength = sqrtf(a_v3Vector.x * a_v3Vector.x + a_v3Vector.y * a_v3Vector.y + a_v3Vector.z * a_v3Vector.z);
+		if (fLength <= FLT_EPSILON) return XMFLOAT3(0.0f, 0.0f, 0.0f);
+		return XMFLOAT3(a_v3Vector.x / fLength, a_v3Vector.y / fLength, a_v3Vector.z / fLength);
+	}
+
+	float Dot(const XMFLOAT3& a_v3A, const XMFLOAT3& a_v3B)
+	{
+		return a_v3A.x * a_v3B.x + a_v3A.y * a_v3B.y + a_v3A.z * a_v3B.z;
+	}
+
+	/// <summary>
+	/// Fills in the bounding sphere and normal cone of a finished meshlet.
+	/// </summary>
+	void CalculateBounds(Meshlet& a_mMeshlet, const Vertex* a_pVertices, const unsigned int* a_pIndices, const XMFLOAT3* a_pNormals)
+	{
+		// Sphere around the center of the box, tight enough for clusters this small.
+		XMFLOAT3 v3Min(FLT_MAX, FLT_MAX, FLT_MAX), v3Max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (uint32_t i = 0; i < a_mMeshlet.TriangleCount * 3; i++)
+		{
+			const XMFLOAT3& p = a_pVertices[a_pIndices[i]].Position;
+			v3Min = XMFLOAT3(fminf(v3Min.x, p.x), fminf(v3Min.y, p.y), fminf(v3Min.z, p.z));
+			v3Max = XMFLOAT3(fmaxf(v3Max.x, p.x), fmaxf(v3Max.y, p.y), fmaxf(v3Max.z, p.z));
+		}
+		a_mMeshlet.Center = XMFLOAT3((v3Min.x + v3Max.x) * 0.5f, (v3Min.y + v3Max.y) * 0.5f, (v3Min.z + v3Max.z) * 0.5f);
+		float fRadiusSq = 0.0f;
+		for (uint32_t i = 0; i < a_mMeshlet.TriangleCount * 3; i++)
+		{
+			const XMFLOAT3& p = a_pVertices[a_pIndices[i]].Position;
+			XMFLOAT3 v3Offset(p.x - a_mMeshlet.Center.x, p.y - a_mMeshlet.Center.y, p.z - a_mMeshlet.Center.z);
+			fRadiusSq = fmaxf(fRadiusSq, Dot(v3Offset, v3Offset));
+		}
+		a_mMeshlet.Radius = sqrtf(fRadiusSq);
+
+		// The cone around every triangle's facing.  Degenerate triangles face nowhere and never render.
+		XMFLOAT3 v3Sum(0.0f, 0.0f, 0.0f);
+		for (uint32_t t = 0; t < a_mMeshlet.TriangleCount; t++)
+		{
+			v3Sum = XMFLOAT3(v3Sum.x + a_pNormals[t].x, v3Sum.y + a_pNormals[t].y, v3Sum.z + a_pNormals[t].z);
+		}
+		a_mMeshlet.ConeAxis = Normalize(v3Sum);
+		a_mMeshlet.ConeApex = a_mMeshlet.Center;
+		a_mMeshlet.ConeCutoff = 1.0f;
+
+		float fMinDot = 1.0f;
+		for (uint32_t t = 0; t < a_mMeshlet.TriangleCount; t++)
+		{
+			if (a_pNormals[t].x == 0.0f && a_pNormals[t].y == 0.0f && a_pNormals[t].z == 0.0f) continue;
+			fMinDot = fminf(fMinDot, Dot(a_pNormals[t], a_mMeshlet.ConeAxis));
+		}
+		if (fMinDot <= 0.0f || (a_mMeshlet.ConeAxis.x == 0.0f && a_mMeshlet.ConeAxis.y == 0.0f && a_mMeshlet.ConeAxis.z == 0.0f)) return;
+
+		// Sliding the apex along the axis as far forward as it can go while staying behind every plane.
+		float fApexT = FLT_MAX;
+		for (uint32_t t = 0; t < a_mMeshlet.TriangleCount; t++)
+		{
+			if (a_pNormals[t].x == 0.0f && a_pNormals[t].y == 0.0f && a_pNormals[t].z == 0.0f) continue;
+
+			const XMFLOAT3& p = a_pVertices[a_pIndices[t * 3]].Position;
+			XMFLOAT3 v3Offset(p.x - a_mMeshlet.Center.x, p.y - a_mMeshlet.Center.y, p.z - a_mMeshlet.Center.z);
+			fApexT = fminf(fApexT, Dot(v3Offset, a_pNormals[t]) / Dot(a_mMeshlet.ConeAxis, a_pNormals[t]));
+		}
+		a_mMeshlet.ConeApex = XMFLOAT3(
+			a_mMeshlet.Center.x + a_mMeshlet.ConeAxis.x * fApexT,
+			a_mMeshlet.Center.y + a_mMeshlet.ConeAxis.y * fApexT,
+			a_mMeshlet.Center.z + a_mMeshlet.ConeAxis.z * fApexT);
+		a_mMeshlet.ConeCutoff = sqrtf(1.0f - fMinDot * fMinDot);
+	}
+}
+
+std::vector<Meshlet> MeshletBuilder::Build(
+	const Vertex* a_pVertices,
+	size_t a_uVertexCount,
+	unsigned int* a_pIndices,
+	size_t a_uIndexCount,
+	uint32_t a_uIndexOffset,
+	unsigned int a_uMaxVertices,
+	unsigned int a_uMaxTriangles)
+{
+	std::vector<Meshlet> lMeshlets;
+	size_t uTriangleCount = a_uIndexCount / 3;
+	if (uTriangleCount == 0) return lMeshlets;
+
+	std::vector<XMFLOAT3> lNormals(uTriangleCount);
+	for (size_t t = 0; t < uTriangleCount; t++)
+	{
+		lNormals[t] = TriangleNormal(a_pVertices, &a_pIndices[t * 3]);
+	}
+
+	// Vertex -> triangle adjacency, laid out like MeshOptimizer's.
+	std::vector<size_t> lOffsets(a_uVertexCount + 1, 0);
+	for (size_t i = 0; i < uTriangleCount * 3; i++) lOffsets[a_pIndices[i] + 1]++;
+	for (size_t v = 0; v < a_uVertexCount; v++) lOffsets[v + 1] += lOffsets[v];
+	std::vector<unsigned int> lAdjacency(uTriangleCount * 3);
+	std::vector<size_t> lFill(lOffsets.begin(), lOffsets.end() - 1);
+	for (size_t t = 0; t < uTriangleCount; t++)
+	{
+		for (int c = 0; c < 3; c++) lAdjacency[lFill[a_pIndices[t * 3 + c]]++] = static_cast<unsigned int>(t);
+	}
+
+	// Stamped with the current meshlet's number, so nothing needs clearing between meshlets.
+	std::vector<uint32_t> lVertexStamp(a_uVertexCount, 0);
+	std::vector<uint32_t> lCandidateStamp(uTriangleCount, 0);
+	std::vector<bool> lUsed(uTriangleCount, false);
+
+	std::vector<unsigned int> lOrdered;
+	std::vector<XMFLOAT3> lOrderedNormals;
+	std::vector<unsigned int> lCandidates;
+	lOrdered.reserve(uTriangleCount * 3);
+	lOrderedNormals.reserve(uTriangleCount);
+
+	// Seeding each meshlet with the first unused triangle keeps the input's (cache optimized) locality.
+	size_t uSeed = 0;
+	while (true)
+	{
+		while (uSeed < uTriangleCount && lUsed[uSeed]) uSeed++;
+		if (uSeed == uTriangleCount) break;
+
+		uint32_t uStamp = static_cast<uint32_t>(lMeshlets.size()) + 1;
+		Meshlet meshlet = {};
+		meshlet.IndexStart = a_uIndexOffset + static_cast<uint32_t>(lOrdered.size());
+		XMFLOAT3 v3NormalSum(0.0f, 0.0f, 0.0f);
+		lCandidates.clear();
+
+		size_t uTriangle = uSeed;
+		while (true)
+		{
+			// Adding the triangle, and every unused triangle touching its new vertices as a candidate.
+			lUsed[uTriangle] = true;
+			for (int c = 0; c < 3; c++)
+			{
+				unsigned int uVertex = a_pIndices[uTriangle * 3 + c];
+				lOrdered.push_back(uVertex);
+				if (lVertexStamp[uVertex] == uStamp) continue;
+
+				lVertexStamp[uVertex] = uStamp;
+				meshlet.VertexCount++;
+				for (size_t a = lOffsets[uVertex]; a < lOffsets[uVertex + 1]; a++)
+				{
+					unsigned int uNeighbour = lAdjacency[a];
+					if (lUsed[uNeighbour] || lCandidateStamp[uNeighbour] == uStamp) continue;
+					lCandidateStamp[uNeighbour] = uStamp;
+					lCandidates.push_back(uNeighbour);
+				}
+			}
+			lOrderedNormals.push_back(lNormals[uTriangle]);
+			v3NormalSum = XMFLOAT3(v3NormalSum.x + lNormals[uTriangle].x, v3NormalSum.y + lNormals[uTriangle].y, v3NormalSum.z + lNormals[uTriangle].z);
+			meshlet.TriangleCount++;
+			if (meshlet.TriangleCount >= a_uMaxTriangles) break;
+
+			// Picking the neighbour adding the fewest vertices, then the one facing most like the meshlet.
+			XMFLOAT3 v3Axis = Normalize(v3NormalSum);
+			size_t uBest = uTriangleCount;
+			float fBestScore = FLT_MAX;
+			size_t uKept = 0;
+			for (size_t i = 0; i < lCandidates.size(); i++)
+			{
+				unsigned int uCandidate = lCandidates[i];
+				if (lUsed[uCandidate]) continue;
+				lCandidates[uKept++] = uCandidate;
+
+				unsigned int uNewVertices = 0;
+				for (int c = 0; c < 3; c++) uNewVertices += lVertexStamp[a_pIndices[uCandidate * 3 + c]] != uStamp;
+				if (meshlet.VertexCount + uNewVertices > a_uMaxVertices) continue;
+
+				float fScore = uNewVertices + g_fFacingWeight * (1.0f - Dot(lNormals[uCandidate], v3Axis));
+				if (fScore < fBestScore || (fScore == fBestScore && uCandidate < uBest))
+				{
+					fBestScore = fScore;
+					uBest = uCandidate;
+				}
+			}
+			lCandidates.resize(uKept);
+			if (uBest == uTriangleCount) break;
+			uTriangle = uBest;
+		}
+
+		size_t uFirst = meshlet.IndexStart - a_uIndexOffset;
+		CalculateBounds(meshlet, a_pVertices, &lOrdered[uFirst], &lOrderedNormals[uFirst / 3]);
+		lMeshlets.push_back(meshlet);
+	}
+
+	// Growing by fewest new vertices scatters the cache friendly order, so each meshlet gets it back.
+	for (const Meshlet& meshlet : lMeshlets)
+	{
+		MeshOptimizer::OptimizeVertexCache(&lOrdered[meshlet.IndexStart - a_uIndexOffset], meshlet.TriangleCount * 3, a_uVertexCount);
+	}
+
+	for (size_t i = 0; i < lOrdered.size(); i++) a_pIndices[i] = lOrdered[i];
+	return lMeshlets;
+}
+
+MeshletStats MeshletBuilder::Analyze(const Meshlet* a_pMeshlets, size_t a_uCount, unsigned int a_uMaxVertices, unsigned int a_uMaxTriangles)
+{
+	MeshletStats stats = {};
+	stats.MeshletCount = static_cast<unsigned int>(a_uCount);
+	if (a_uCount == 0) return stats;
+
+	double dVertices = 0.0, dTriangles = 0.0;
+	for (size_t i = 0; i < a_uCount; i++)
+	{
+		dVertices += a_pMeshlets[i].VertexCount;
+		dTriangles += a_pMeshlets[i].TriangleCount;
+	}
+	stats.VertexFill = static_cast<float>(dVertices / (double(a_uCount) * a_uMaxVertices));
+	stats.TriangleFill = static_cast<float>(dTriangles / (double(a_uCount) * a_uMaxTriangles));
+	return stats;
+}
@@ -0,0 +1,81 @@
+#ifndef __MESHLETBUILDER_H_
+#define __MESHLETBUILDER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include "Vertex.h"
+
+/// <summary>
+/// A small cluster of neighbouring triangles, stored as a contiguous range of
+/// its mesh's index buffer, with the bounds needed to cull it as a whole.
+/// </summary>
+struct Meshlet
+{
+	uint32_t IndexStart;				// First index in the mesh's index buffer.
+	uint32_t TriangleCount;
+	uint32_t VertexCount;				// Distinct vertices the triangles reference.
+	DirectX::XMFLOAT3 Center;			// Local space bounding sphere.
+	float Radius;
+	DirectX::XMFLOAT3 ConeApex;			// Behind every triangle's plane, the tip of the region seeing only back faces.
+	DirectX::XMFLOAT3 ConeAxis;			// Average facing of the triangles.
+	float ConeCutoff;					// Sine of the largest angle between a triangle and the axis, 1 if the meshlet can never be back facing.
+};
+
+/// <summary>
+/// How well a set of meshlets uses its limits.
+/// </summary>
+struct MeshletStats
+{
+	unsigned int MeshletCount;
+	float VertexFill;					// Average VertexCount over the vertex limit.
+	float TriangleFill;					// Average TriangleCount over the triangle limit.
+};
+
+/// <summary>
+/// Splits a triangle list into meshlets by growing each one from a seed
+/// triangle through its neighbours, preferring triangles that add the fewest
+/// vertices and face the same way, so the clusters stay compact and their
+/// normal cones stay narrow.  Free of the graphics device.
+/// </summary>
+namespace MeshletBuilder
+{
+	// Default limits per meshlet, the sizes mesh shading hardware is tuned for.  Smaller
+	// meshlets face fewer ways each and cull better, but need more draws.
+	const unsigned int MAX_VERTICES = 64;
+	const unsigned int MAX_TRIANGLES = 124;
+
+	/// <summary>
+	/// Reorders the triangles of a triangle list in place so every meshlet's
+	/// triangles are contiguous, and computes each meshlet's bounds.
+	/// </summary>
+	/// <param name="a_pVertices">The vertices.</param>
+	/// <param name="a_uVertexCount">The amount of vertices.</param>
+	/// <param name="a_pIndices">The triangle list being reordered.</param>
+	/// <param name="a_uIndexCount">The amount of indices in the list.</param>
+	/// <param name="a_uIndexOffset">Added to every IndexStart, for lists that sit further into an index buffer.</param>
+	/// <param name="a_uMaxVertices">The most distinct vertices per meshlet.</param>
+	/// <param name="a_uMaxTriangles">The most triangles per meshlet.</param>
+	/// <returns>The meshlets, in index buffer order.</returns>
+	std::vector<Meshlet> Build(
+		const Vertex* a_pVertices,
+		size_t a_uVertexCount,
+		unsigned int* a_pIndices,
+		size_t a_uIndexCount,
+		uint32_t a_uIndexOffset = 0,
+		unsigned int a_uMaxVertices = MAX_VERTICES,
+		unsigned int a_uMaxTriangles = MAX_TRIANGLES);
+
+	/// <summary>
+	/// Measures how full a set of meshlets is.
+	/// </summary>
+	/// <param name="a_pMeshlets">The meshlets.</param>
+	/// <param name="a_uCount">The amount of meshlets.</param>
+	/// <param name="a_uMaxVertices">The vertex limit they were built with.</param>
+	/// <param name="a_uMaxTriangles">The triangle limit they were built with.</param>
+	/// <returns>The average vertex and triangle fill.</returns>
+	MeshletStats Analyze(const Meshlet* a_pMeshlets, size_t a_uCount, unsigned int a_uMaxVertices = MAX_VERTICES, unsigned int a_uMaxTriangles = MAX_TRIANGLES);
+}
+
+#endif //__MESHLETBUILDER_H_
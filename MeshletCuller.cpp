@@ -0,0 +1,91 @@
+#include "MeshletCuller.h"
+
+#include <cmath>
+
+using namespace DirectX;
+
+bool MeshletCuller::IsBackFacing(const Meshlet& a_mMeshlet, const XMFLOAT3& a_v3CameraPosition)
+{
+	// Triangles facing every which way can always be seen from somewhere.
+	if (a_mMeshlet.ConeCutoff >= 1.0f) return false;
+
+	// Front faces point back at the camera.  The apex is behind every triangle's plane, and
+	// so is anything further back from it than 90 degrees minus the widest normal's angle
+	// off the axis, which leaves every triangle facing away.
+	XMFLOAT3 v3FromCamera(
+		a_mMeshlet.ConeApex.x - a_v3CameraPosition.x,
+		a_mMeshlet.ConeApex.y - a_v3CameraPosition.y,
+		a_mMeshlet.ConeApex.z - a_v3CameraPosition.z);
+	float fDistance = sqrtf(v3FromCamera.x * v3FromCamera.x + v3FromCamera.y * v3FromCamera.y + v3FromCamera.z * v3FromCamera.z);
+	if (fDistance <= 0.0f) return false;
+
+	float fDot = v3FromCamera.x * a_mMeshlet.ConeAxis.x + v3FromCamera.y * a_mMeshlet.ConeAxis.y + v3FromCamera.z * a_mMeshlet.ConeAxis.z;
+	return fDot >= a_mMeshlet.ConeCutoff * fDistance;
+}
+
+unsigned int MeshletCuller::Cull(
+	const Meshlet* a_pMeshlets,
+	size_t a_uCount,
+	const XMFLOAT4X4& a_m4World,
+	const Frustum& a_fFrustum,
+	const XMFLOAT3& a_v3CameraPosition,
+	std::vector<IndexRange>& a_lRanges,
+	MeshletCullStats& a_mcsStats)
+{
+	XMMATRIX mWorld = XMLoadFloat4x4(&a_m4World);
+	XMVECTOR vScale = XMVectorMax(XMVector3Length(mWorld.r[0]), XMVectorMax(XMVector3Length(mWorld.r[1]), XMVector3Length(mWorld.r[2])));
+	float fRadiusScale = XMVectorGetX(vScale);
+
+	// Facing is tested in local space, where the meshlets' cones are.  Which side of a
+	// triangle's plane a point is on survives any transform that does not mirror.
+	XMVECTOR vDeterminant;
+	XMMATRIX mInverseWorld = XMMatrixInverse(&vDeterminant, mWorld);
+	bool bTestFacing = XMVectorGetX(vDeterminant) > 0.0f;
+	XMFLOAT3 v3LocalCamera;
+	XMStoreFloat3(&v3LocalCamera, XMVector3Transform(XMLoadFloat3(&a_v3CameraPosition), mInverseWorld));
+
+	size_t uFirstRange = a_lRanges.size();
+	for (size_t i = 0; i < a_uCount; i++)
+	{
+		const Meshlet& meshlet = a_pMeshlets[i];
+		a_mcsStats.Meshlets++;
+		a_mcsStats.Triangles += meshlet.TriangleCount;
+
+		// Sphere against the six planes, which are normalized.
+		XMFLOAT3 v3Center;
+		XMStoreFloat3(&v3Center, XMVector3Transform(XMLoadFloat3(&meshlet.Center), mWorld));
+		float fRadius = meshlet.Radius * fRadiusScale;
+		bool bOutside = false;
+		for (int p = 0; p < 6 && !bOutside; p++)
+		{
+			const XMFLOAT4& plane = a_fFrustum.Planes[p];
+			bOutside = plane.x * v3Center.x + plane.y * v3Center.y + plane.z * v3Center.z + plane.w < -fRadius;
+		}
+		if (bOutside)
+		{
+			a_mcsStats.FrustumCulled++;
+			continue;
+		}
+		if (bTestFacing && IsBackFacing(meshlet, v3LocalCamera))
+		{
+			a_mcsStats.BackfaceCulled++;
+			continue;
+		}
+
+		// Meshlets are stored back to back, so neighbours that both survive share a draw.
+		a_mcsStats.TrianglesKept += meshlet.TriangleCount;
+		uint32_t uIndexCount = meshlet.TriangleCount * 3;
+		if (a_lRanges.size() > uFirstRange && a_lRanges.back().IndexStart + a_lRanges.back().IndexCount == meshlet.IndexStart)
+		{
+			a_lRanges.back().IndexCount += uIndexCount;
+		}
+		else
+		{
+			a_lRanges.push_back({ meshlet.IndexStart, uIndexCount });
+		}
+	}
+
+	unsigned int uAppended = static_cast<unsigned int>(a_lRanges.size() - uFirstRange);
+	a_mcsStats.Ranges += uAppended;
+	return uAppended;
+}
@@ -0,0 +1,69 @@
+#ifndef __MESHLETCULLER_H_
+#define __MESHLETCULLER_H_
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+#include "FrustumCuller.h"
+#include "MeshletBuilder.h"
+
+/// <summary>
+/// A run of indices to draw with one DrawIndexed call.
+/// </summary>
+struct IndexRange
+{
+	uint32_t IndexStart;
+	uint32_t IndexCount;
+};
+
+/// <summary>
+/// What culling meshlets rejected, summed over every mesh it ran on.
+/// </summary>
+struct MeshletCullStats
+{
+	unsigned int Meshlets;				// Meshlets tested.
+	unsigned int FrustumCulled;			// Outside the view volume.
+	unsigned int BackfaceCulled;		// Inside it, but facing entirely away from the camera.
+	unsigned int Triangles;				// In every tested meshlet.
+	unsigned int TrianglesKept;			// In the meshlets left to draw.
+	unsigned int Ranges;				// Draw calls the kept meshlets merged into.
+};
+
+/// <summary>
+/// Rejects whole meshlets that are off screen or face away from the camera,
+/// then merges the survivors that sit next to each other in the index buffer
+/// into as few draws as possible.  Free of the graphics device.
+/// </summary>
+namespace MeshletCuller
+{
+	/// <summary>
+	/// Tests whether every triangle of a meshlet faces away from a point.
+	/// Conservative: a meshlet with any triangle that could be seen is kept.
+	/// </summary>
+	/// <param name="a_mMeshlet">The meshlet.</param>
+	/// <param name="a_v3CameraPosition">The camera's position in the meshlet's local space.</param>
+	/// <returns>True if the meshlet can be skipped.</returns>
+	bool IsBackFacing(const Meshlet& a_mMeshlet, const DirectX::XMFLOAT3& a_v3CameraPosition);
+
+	/// <summary>
+	/// Culls the meshlets of one mesh instance and appends the index ranges left to draw.
+	/// </summary>
+	/// <param name="a_pMeshlets">The mesh's meshlets, in index buffer order.</param>
+	/// <param name="a_uCount">The amount of meshlets.</param>
+	/// <param name="a_m4World">The instance's world matrix.</param>
+	/// <param name="a_fFrustum">The world space view volume.</param>
+	/// <param name="a_v3CameraPosition">The world space camera position.</param>
+	/// <param name="a_lRanges">Receives the merged ranges of the kept meshlets.</param>
+	/// <param name="a_mcsStats">Gets the counts of this call added to it.</param>
+	/// <returns>The amount of ranges appended.</returns>
+	unsigned int Cull(
+		const Meshlet* a_pMeshlets,
+		size_t a_uCount,
+		const DirectX::XMFLOAT4X4& a_m4World,
+		const Frustum& a_fFrustum,
+		const DirectX::XMFLOAT3& a_v3CameraPosition,
+		std::vector<IndexRange>& a_lRanges,
+		MeshletCullStats& a_mcsStats);
+}
+
+#endif //__MESHLETCULLER_H_
@@ -0,0 +1,453 @@
+#include "ObjLoader.h"
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <cstring>
+#include <climits>
+
+using namespace DirectX;
+using ObjLoader::FaceCorner;
+
+// Based on the basic .OBJ loader by Chris Cascioli, rewritten to
+// tokenize a memory-mapped file in place instead of getline/sscanf_s.
+
+namespace
+{
+	// Exactly representable powers of ten used by the float parser.
+	const double g_lPowersOfTen[] =
+	{
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	const int g_dMaxExactPower = 22;
+
+	// Face corners beyond this are ignored; real obj files stay far below it.
+	const int g_dMaxFaceCorners = 64;
+
+	/// <summary>
+	/// Open-addressing hash table mapping a face corner's (position, uv, normal)
+	/// index triple to the single vertex every matching corner shares.
+	/// </summary>
+	class CornerWelder
+	{
+	private:
+		struct Slot
+		{
+			FaceCorner Key;
+			unsigned int Vertex;
+		};
+
+		static const unsigned int EMPTY = UINT_MAX;
+
+		std::vector<Slot> m_lSlots;
+		size_t m_uMask;
+		size_t m_uCount;
+
+	public:
+		CornerWelder(size_t a_uExpectedVertices) : m_uMask(0), m_uCount(0)
+		{
+			Resize(a_uExpectedVertices * 2);
+		}
+
+		/// <summary>
+		/// Returns the vertex already assigned to this corner, or assigns it a_uNewVertex.
+		/// </summary>
+		unsigned int FindOrAdd(const FaceCorner& a_fcCorner, unsigned int a_uNewVertex, bool& a_bAdded)
+		{
+			// Keeping the load factor at or below one half.
+			if ((m_uCount + 1) * 2 > m_lSlots.size()) Resize(m_lSlots.size() * 2);
+
+			size_t uSlot = Hash(a_fcCorner) & m_uMask;
+			while (m_lSlots[uSlot].Vertex != EMPTY)
+			{
+				const FaceCorner& key = m_lSlots[uSlot].Key;
+				if (key.Position == a_fcCorner.Position && key.UV == a_fcCorner.UV && key.Normal == a_fcCorner.Normal)
+				{
+					a_bAdded = false;
+					return m_lSlots[uSlot].Vertex;
+				}
+				uSlot = (uSlot + 1) & m_uMask;
+			}
+
+			m_lSlots[uSlot].Key = a_fcCorner;
+			m_lSlots[uSlot].Vertex = a_uNewVertex;
+			m_uCount++;
+			a_bAdded = true;
+			return a_uNewVertex;
+		}
+
+	private:
+		static size_t Hash(const FaceCorner& a_fcCorner)
+		{
+			uint64_t uKey =
+				static_cast<uint64_t>(static_cast<uint32_t>(a_fcCorner.Position)) * 0x9E3779B97F4A7C15ull ^
+				static_cast<uint64_t>(static_cast<uint32_t>(a_fcCorner.UV)) * 0xC2B2AE3D27D4EB4Full ^
+				static_cast<uint64_t>(static_cast<uint32_t>(a_fcCorner.Normal)) * 0x165667B19E3779F9ull;
+			return static_cast<size_t>(uKey ^ (uKey >> 29));
+		}
+
+		void Resize(size_t a_uMinimumSlots)
+		{
+			size_t uCapacity = 16;
+			while (uCapacity < a_uMinimumSlots) uCapacity <<= 1;
+
+			std::vector<Slot> lOld;
+			lOld.swap(m_lSlots);
+			m_lSlots.assign(uCapacity, Slot{ { -1, -1, -1 }, EMPTY });
+			m_uMask = uCapacity - 1;
+
+			// Re-inserting everything that was already welded.
+			for (const Slot& slot : lOld)
+			{
+				if (slot.Vertex == EMPTY) continue;
+				size_t uSlot = Hash(slot.Key) & m_uMask;
+				while (m_lSlots[uSlot].Vertex != EMPTY) uSlot = (uSlot + 1) & m_uMask;
+				m_lSlots[uSlot] = slot;
+			}
+		}
+	};
+
+	inline bool IsDigit(char a_cChar) { return a_cChar >= '0' && a_cChar <= '9'; }
+	inline bool IsBlank(char a_cChar) { return a_cChar == ' ' || a_cChar == '\t'; }
+
+	inline const char* SkipBlanks(const char* a_pCursor, const char* a_pEnd)
+	{
+		while (a_pCursor < a_pEnd && IsBlank(*a_pCursor)) a_pCursor++;
+		return a_pCursor;
+	}
+
+	inline const char* FindLineEnd(const char* a_pCursor, const char* a_pEnd)
+	{
+		const void* pNewLine = std::memchr(a_pCursor, '\n', a_pEnd - a_pCursor);
+		return pNewLine ? static_cast<const char*>(pNewLine) : a_pEnd;
+	}
+
+	/// <summary>
+	/// Parses a decimal float ("-1.25", "3e-4", ...) without going through the C locale.
+	/// </summary>
+	const char* ParseFloat(const char* a_pCursor, const char* a_pEnd, float& a_fResult)
+	{
+		a_pCursor = SkipBlanks(a_pCursor, a_pEnd);
+
+		bool bNegative = false;
+		if (a_pCursor < a_pEnd && (*a_pCursor == '-' || *a_pCursor == '+'))
+		{
+			bNegative = *a_pCursor == '-';
+			a_pCursor++;
+		}
+
+		// Accumulating up to 19 significant digits, anything past that only moves the exponent.
+		uint64_t uMantissa = 0;
+		int dSignificantDigits = 0;
+		int dExponent = 0;
+		while (a_pCursor < a_pEnd && IsDigit(*a_pCursor))
+		{
+			if (dSignificantDigits < 19)
+			{
+				uMantissa = uMantissa * 10 + static_cast<uint64_t>(*a_pCursor - '0');
+				if (uMantissa != 0) dSignificantDigits++;
+			}
+			else
+			{
+				dExponent++;
+			}
+			a_pCursor++;
+		}
+		if (a_pCursor < a_pEnd && *a_pCursor == '.')
+		{
+			a_pCursor++;
+			while (a_pCursor < a_pEnd && IsDigit(*a_pCursor))
+			{
+				if (dSignificantDigits < 19)
+				{
+					uMantissa = uMantissa * 10 + static_cast<uint64_t>(*a_pCursor - '0');
+					if (uMantissa != 0) dSignificantDigits++;
+					dExponent--;
+				}
+				a_pCursor++;
+			}
+		}
+		if (a_pCursor < a_pEnd && (*a_pCursor == 'e' || *a_pCursor == 'E'))
+		{
+			a_pCursor++;
+			bool bNegativeExponent = false;
+			if (a_pCursor < a_pEnd && (*a_pCursor == '-' || *a_pCursor == '+'))
+			{
+				bNegativeExponent = *a_pCursor == '-';
+				a_pCursor++;
+			}
+			int dWrittenExponent = 0;
+			while (a_pCursor < a_pEnd && IsDigit(*a_pCursor))
+			{
+				if (dWrittenExponent < 10000) dWrittenExponent = dWrittenExponent * 10 + (*a_pCursor - '0');
+				a_pCursor++;
+			}
+			dExponent += bNegativeExponent ? -dWrittenExponent : dWrittenExponent;
+		}
+
+		// Scaling by exact powers of ten keeps the result within a rounding step of strtof.
+		double dValue = static_cast<double>(uMantissa);
+		while (dExponent > g_dMaxExactPower && dValue != 0.0)
+		{
+			dValue *= g_lPowersOfTen[g_dMaxExactPower];
+			dExponent -= g_dMaxExactPower;
+		}
+		while (dExponent < -g_dMaxExactPower && dValue != 0.0)
+		{
+			dValue /= g_lPowersOfTen[g_dMaxExactPower];
+			dExponent += g_dMaxExactPower;
+		}
+		if (dExponent > 0 && dExponent <= g_dMaxExactPower) dValue *= g_lPowersOfTen[dExponent];
+		else if (dExponent < 0 && dExponent >= -g_dMaxExactPower) dValue /= g_lPowersOfTen[-dExponent];
+
+		a_fResult = static_cast<float>(bNegative ? -dValue : dValue);
+		return a_pCursor;
+	}
+
+	/// <summary>
+	/// Parses an optionally signed integer.  Leaves the result untouched if there are no digits.
+	/// </summary>
+	const char* ParseInt(const char* a_pCursor, const char* a_pEnd, int& a_dResult, bool& a_bFound)
+	{
+		bool bNegative = false;
+		if (a_pCursor < a_pEnd && (*a_pCursor == '-' || *a_pCursor == '+'))
+		{
+			bNegative = *a_pCursor == '-';
+			a_pCursor++;
+		}
+
+		int dValue = 0;
+		a_bFound = false;
+		while (a_pCursor < a_pEnd && IsDigit(*a_pCursor))
+		{
+			dValue = dValue * 10 + (*a_pCursor - '0');
+			a_bFound = true;
+			a_pCursor++;
+		}
+
+		if (a_bFound) a_dResult = bNegative ? -dValue : dValue;
+		return a_pCursor;
+	}
+
+	/// <summary>
+	/// Converts a 1-based (or negative, relative) obj index into a 0-based one, -1 if invalid.
+	/// </summary>
+	inline int ResolveIndex(int a_dIndex, size_t a_uCount)
+	{
+		int dResolved = a_dIndex > 0 ? a_dIndex - 1 : static_cast<int>(a_uCount) + a_dIndex;
+		return (dResolved >= 0 && dResolved < static_cast<int>(a_uCount)) ? dResolved : -1;
+	}
+
+	/// <summary>
+	/// Parses a "p", "p/t", "p//n" or "p/t/n" face corner.
+	/// </summary>
+	const char* ParseCorner(
+		const char* a_pCursor,
+		const char* a_pEnd,
+		size_t a_uPositionCount,
+		size_t a_uUVCount,
+		size_t a_uNormalCount,
+		FaceCorner& a_fcCorner,
+		bool& a_bFound)
+	{
+		int dPosition = 0, dUV = 0, dNormal = 0;
+		bool bUV = false, bNormal = false;
+
+		a_pCursor = ParseInt(a_pCursor, a_pEnd, dPosition, a_bFound);
+		if (a_pCursor < a_pEnd && *a_pCursor == '/')
+		{
+			a_pCursor = ParseInt(a_pCursor + 1, a_pEnd, dUV, bUV);
+			if (a_pCursor < a_pEnd && *a_pCursor == '/')
+			{
+				a_pCursor = ParseInt(a_pCursor + 1, a_pEnd, dNormal, bNormal);
+			}
+		}
+
+		a_fcCorner.Position = a_bFound ? ResolveIndex(dPosition, a_uPositionCount) : -1;
+		a_fcCorner.UV = bUV ? ResolveIndex(dUV, a_uUVCount) : -1;
+		a_fcCorner.Normal = bNormal ? ResolveIndex(dNormal, a_uNormalCount) : -1;
+		a_bFound = a_bFound && a_fcCorner.Position >= 0;
+
+		// Skipping anything unexpected up to the next separator.
+		while (a_pCursor < a_pEnd && !IsBlank(*a_pCursor) && *a_pCursor != '\r') a_pCursor++;
+		return a_pCursor;
+	}
+
+	/// <summary>
+	/// Builds a left-handed vertex from a face corner.
+	/// </summary>
+	inline Vertex MakeVertex(
+		const FaceCorner& a_fcCorner,
+		const std::vector<XMFLOAT3>& a_lPositions,
+		const std::vector<XMFLOAT2>& a_lUVs,
+		const std::vector<XMFLOAT3>& a_lNormals)
+	{
+		Vertex vertex = {};
+		vertex.Position = a_lPositions[a_fcCorner.Position];
+		vertex.UV = a_fcCorner.UV >= 0 ? a_lUVs[a_fcCorner.UV] : XMFLOAT2(0.0f, 0.0f);
+		vertex.Normal = a_fcCorner.Normal >= 0 ? a_lNormals[a_fcCorner.Normal] : XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+		// The model is most likely in a right-handed space, so:
+		//  - Flip the UV since DirectX defines (0,0) as the top left
+		//  - Invert the Z position
+		//  - Invert the normal's Z
+		vertex.UV.y = 1.0f - vertex.UV.y;
+		vertex.Position.z *= -1.0f;
+		vertex.Normal.z *= -1.0f;
+		return vertex;
+	}
+}
+
+bool ObjLoader::Load(const char* a_sFilepath, std::vector<Vertex>& a_lVertices, std::vector<unsigned int>& a_lIndices)
+{
+	MappedFile file(a_sFilepath);
+	if (!file.IsOpen()) return false;
+
+	Parse(file.GetData(), file.GetSize(), a_lVertices, a_lIndices);
+	return true;
+}
+
+void ObjLoader::Parse(const char* a_pData, size_t a_uSize, std::vector<Vertex>& a_lVertices, std::vector<unsigned int>& a_lIndices)
+{
+	Contents cContents;
+	Tokenize(a_pData, a_uSize, cContents);
+	Weld(cContents, a_lVertices, a_lIndices);
+}
+
+void ObjLoader::Tokenize(const char* a_pData, size_t a_uSize, Contents& a_cContents)
+{
+	const char* pEnd = a_pData + a_uSize;
+
+	// Counting pass: sizing every array up front so the parsing pass never reallocates
+	// (faces are assumed to be quads at most when reserving).
+	size_t uPositionCount = 0, uUVCount = 0, uNormalCount = 0, uFaceCount = 0;
+	for (const char* pLine = a_pData; pLine < pEnd;)
+	{
+		const char* pLineEnd = FindLineEnd(pLine, pEnd);
+		const char* pCursor = SkipBlanks(pLine, pLineEnd);
+		if (pLineEnd - pCursor >= 2)
+		{
+			if (pCursor[0] == 'v')
+			{
+				if (IsBlank(pCursor[1])) uPositionCount++;
+				else if (pCursor[1] == 't') uUVCount++;
+				else if (pCursor[1] == 'n') uNormalCount++;
+			}
+			else if (pCursor[0] == 'f' && IsBlank(pCursor[1]))
+			{
+				uFaceCount++;
+			}
+		}
+		pLine = pLineEnd + 1;
+	}
+
+	std::vector<XMFLOAT3>& lPositions = a_cContents.Positions;
+	std::vector<XMFLOAT2>& lUVs = a_cContents.UVs;
+	std::vector<XMFLOAT3>& lNormals = a_cContents.Normals;
+	lPositions.clear();
+	lUVs.clear();
+	lNormals.clear();
+	a_cContents.Corners.clear();
+	a_cContents.FaceSizes.clear();
+	lPositions.reserve(uPositionCount);
+	lUVs.reserve(uUVCount);
+	lNormals.reserve(uNormalCount);
+	a_cContents.Corners.reserve(uFaceCount * 4);
+	a_cContents.FaceSizes.reserve(uFaceCount);
+
+	// Parsing pass: tokenizing each line in place.
+	FaceCorner lCorners[g_dMaxFaceCorners];
+	for (const char* pLine = a_pData; pLine < pEnd;)
+	{
+		const char* pLineEnd = FindLineEnd(pLine, pEnd);
+		const char* pCursor = SkipBlanks(pLine, pLineEnd);
+
+		if (pLineEnd - pCursor >= 2 && pCursor[0] == 'v')
+		{
+			if (IsBlank(pCursor[1]))
+			{
+				XMFLOAT3 pos;
+				pCursor = ParseFloat(pCursor + 1, pLineEnd, pos.x);
+				pCursor = ParseFloat(pCursor, pLineEnd, pos.y);
+				ParseFloat(pCursor, pLineEnd, pos.z);
+				lPositions.push_back(pos);
+			}
+			else if (pCursor[1] == 't')
+			{
+				XMFLOAT2 uv;
+				pCursor = ParseFloat(pCursor + 2, pLineEnd, uv.x);
+				ParseFloat(pCursor, pLineEnd, uv.y);
+				lUVs.push_back(uv);
+			}
+			else if (pCursor[1] == 'n')
+			{
+				XMFLOAT3 norm;
+				pCursor = ParseFloat(pCursor + 2, pLineEnd, norm.x);
+				pCursor = ParseFloat(pCursor, pLineEnd, norm.y);
+				ParseFloat(pCursor, pLineEnd, norm.z);
+				lNormals.push_back(norm);
+			}
+		}
+		else if (pLineEnd - pCursor >= 2 && pCursor[0] == 'f' && IsBlank(pCursor[1]))
+		{
+			// Reading every corner of the face.
+			int dCornerCount = 0;
+			pCursor++;
+			while (dCornerCount < g_dMaxFaceCorners)
+			{
+				pCursor = SkipBlanks(pCursor, pLineEnd);
+				if (pCursor >= pLineEnd || *pCursor == '\r') break;
+
+				bool bFound = false;
+				pCursor = ParseCorner(
+					pCursor, pLineEnd,
+					lPositions.size(), lUVs.size(), lNormals.size(),
+					lCorners[dCornerCount], bFound);
+				if (bFound) dCornerCount++;
+			}
+			a_cContents.Corners.insert(a_cContents.Corners.end(), lCorners, lCorners + dCornerCount);
+			a_cContents.FaceSizes.push_back(static_cast<unsigned char>(dCornerCount));
+		}
+
+		pLine = pLineEnd + 1;
+	}
+}
+
+void ObjLoader::Weld(const Contents& a_cContents, std::vector<Vertex>& a_lVertices, std::vector<unsigned int>& a_lIndices)
+{
+	size_t uPositionCount = a_cContents.Positions.size();
+	a_lVertices.clear();
+	a_lIndices.clear();
+	a_lVertices.reserve(uPositionCount + uPositionCount / 2);
+	a_lIndices.reserve(a_cContents.FaceSizes.size() * 6);
+
+	// Corners that reference the same position/uv/normal triple share one vertex.
+	CornerWelder welder(uPositionCount + uPositionCount / 2);
+	unsigned int lCornerVertices[g_dMaxFaceCorners];
+
+	const FaceCorner* pCorner = a_cContents.Corners.data();
+	for (unsigned char uFaceSize : a_cContents.FaceSizes)
+	{
+		// Welding each corner to an existing vertex where possible.
+		int dCornerCount = uFaceSize;
+		for (int i = 0; i < dCornerCount; i++)
+		{
+			bool bAdded = false;
+			lCornerVertices[i] = welder.FindOrAdd(
+				pCorner[i],
+				static_cast<unsigned int>(a_lVertices.size()),
+				bAdded);
+			if (bAdded) a_lVertices.push_back(MakeVertex(pCorner[i], a_cContents.Positions, a_cContents.UVs, a_cContents.Normals));
+		}
+		pCorner += dCornerCount;
+
+		// Fanning the polygon into triangles, flipping the winding order
+		// for the left-handed conversion (v1, v3, v2 and v1, v4, v3 for quads).
+		for (int i = 2; i < dCornerCount; i++)
+		{
+			a_lIndices.push_back(lCornerVertices[0]);
+			a_lIndices.push_back(lCornerVertices[i]);
+			a_lIndices.push_back(lCornerVertices[i - 1]);
+		}
+	}
+}
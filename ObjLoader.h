@@ -0,0 +1,72 @@
+#ifndef __OBJLOADER_H_
+#define __OBJLOADER_H_
+
+#include <cstddef>
+#include <vector>
+#include "Vertex.h"
+
+/// <summary>
+/// CPU-only .OBJ parsing, supporting positions, uvs and normals.  Does not
+/// touch the graphics device so it can be run and timed on its own.
+/// Face corners sharing a position/uv/normal triple are welded into one
+/// vertex, so the output is a properly indexed triangle list.
+/// </summary>
+namespace ObjLoader
+{
+	/// <summary>
+	/// The 0-based position/uv/normal indices of a single face corner, -1 when missing.
+	/// </summary>
+	struct FaceCorner
+	{
+		int Position;
+		int UV;
+		int Normal;
+	};
+
+	/// <summary>
+	/// What an obj file holds, read but not yet welded into vertices.
+	/// </summary>
+	struct Contents
+	{
+		std::vector<DirectX::XMFLOAT3> Positions;
+		std::vector<DirectX::XMFLOAT2> UVs;
+		std::vector<DirectX::XMFLOAT3> Normals;
+		std::vector<FaceCorner> Corners;			// Every face's corners, face after face.
+		std::vector<unsigned char> FaceSizes;		// Corners per face.
+	};
+
+	/// <summary>
+	/// Memory-maps and parses an obj file into a triangle list.
+	/// </summary>
+	/// <param name="a_sFilepath">File path to the obj file.</param>
+	/// <param name="a_lVertices">Receives the unique, welded vertices.</param>
+	/// <param name="a_lIndices">Receives the triangle list indices.</param>
+	/// <returns>False if the file could not be opened.</returns>
+	bool Load(const char* a_sFilepath, std::vector<Vertex>& a_lVertices, std::vector<unsigned int>& a_lIndices);
+
+	/// <summary>
+	/// Parses obj text that is already in memory.  The buffer does not need to be null terminated.
+	/// </summary>
+	/// <param name="a_pData">The start of the obj text.</param>
+	/// <param name="a_uSize">The amount of bytes of obj text.</param>
+	/// <param name="a_lVertices">Receives the unique, welded vertices.</param>
+	/// <param name="a_lIndices">Receives the triangle list indices.</param>
+	void Parse(const char* a_pData, size_t a_uSize, std::vector<Vertex>& a_lVertices, std::vector<unsigned int>& a_lIndices);
+
+	/// <summary>
+	/// The first half of Parse(): reads the attributes and face corners of obj text in memory.
+	/// </summary>
+	/// <param name="a_cContents">Receives what the text holds, replacing what was there.</param>
+	void Tokenize(const char* a_pData, size_t a_uSize, Contents& a_cContents);
+
+	/// <summary>
+	/// The second half of Parse(): gives every distinct corner one vertex, and
+	/// fans the faces into triangles of those vertices.
+	/// </summary>
+	/// <param name="a_cContents">What Tokenize() read.</param>
+	/// <param name="a_lVertices">Receives the unique, welded vertices.</param>
+	/// <param name="a_lIndices">Receives the triangle list indices.</param>
+	void Weld(const Contents& a_cContents, std::vector<Vertex>& a_lVertices, std::vector<unsigned int>& a_lIndices);
+}
+
+#endif //__OBJLOADER_H_
@@ -0,0 +1,369 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <future>
+
+using namespace DirectX;
+
+namespace
+{
+	// Clipping a triangle against five planes adds at most one vertex per plane.
+	const unsigned int g_uMaxClippedVertices = 8;
+
+	// Triangles covering less than this many square pixels are skipped.
+	const float g_fMinTriangleArea = 1e-6f;
+
+	/// <summary>
+	/// Clips a convex polygon in clip space against the plane dot(plane, v) >= 0.
+	/// </summary>
+	unsigned int ClipPolygon(const XMFLOAT4* a_pIn, unsigned int a_uCount, XMFLOAT4 a_v4Plane, XMFLOAT4* a_pOut)
+	{
+		unsigned int uOut = 0;
+		for (unsigned int i = 0; i < a_uCount; i++)
+		{
+			const XMFLOAT4& v4A = a_pIn[i];
+			const XMFLOAT4& v4B = a_pIn[(i + 1) % a_uCount];
+			float fA = v4A.x * a_v4Plane.x + v4A.y * a_v4Plane.y + v4A.z * a_v4Plane.z + v4A.w * a_v4Plane.w;
+			float fB = v4B.x * a_v4Plane.x + v4B.y * a_v4Plane.y + v4B.z * a_v4Plane.z + v4B.w * a_v4Plane.w;
+
+			if (fA >= 0.0f) a_pOut[uOut++] = v4A;
+			if ((fA >= 0.0f) != (fB >= 0.0f))
+			{
+				float fT = fA / (fA - fB);
+				a_pOut[uOut++] = XMFLOAT4(
+					v4A.x + (v4B.x - v4A.x) * fT,
+					v4A.y + (v4B.y - v4A.y) * fT,
+					v4A.z + (v4B.z - v4A.z) * fT,
+					v4A.w + (v4B.w - v4A.w) * fT);
+			}
+		}
+		return uOut;
+	}
+}
+
+OcclusionCuller::OcclusionCuller(unsigned int a_uWidth, unsigned int a_uHeight)
+{
+	m_uBlocksX = (a_uWidth + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	m_uBlocksY = (a_uHeight + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	m_uWidth = m_uBlocksX * BLOCK_SIZE;
+	m_uHeight = m_uBlocksY * BLOCK_SIZE;
+	m_lDepth.assign(m_uWidth * m_uHeight, 1.0f);
+	m_lBlockDepth.assign(m_uBlocksX * m_uBlocksY, 1.0f);
+	m_osStats = {};
+}
+
+void OcclusionCuller::BeginFrame(void)
+{
+	m_tpFrameStart = Clock::now();
+	m_lTriangles.clear();
+	m_osStats = {};
+}
+
+void OcclusionCuller::AddOccluder(const XMFLOAT3* a_pPositions, const unsigned int* a_pIndices, unsigned int a_uIndexCount, const XMFLOAT4X4& a_m4WorldViewProjection)
+{
+	// Left, right, bottom, top and near.  Anything past the far plane loses to the cleared depth anyway.
+	const XMFLOAT4 pPlanes[5] =
+	{
+		XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f),
+		XMFLOAT4(-1.0f, 0.0f, 0.0f, 1.0f),
+		XMFLOAT4(0.0f, 1.0f, 0.0f, 1.0f),
+		XMFLOAT4(0.0f, -1.0f, 0.0f, 1.0f),
+		XMFLOAT4(0.0f, 0.0f, 1.0f, 0.0f)
+	};
+
+	XMMATRIX worldViewProjection = XMLoadFloat4x4(&a_m4WorldViewProjection);
+	float fHalfWidth = m_uWidth * 0.5f;
+	float fHalfHeight = m_uHeight * 0.5f;
+
+	for (unsigned int i = 0; i + 2 < a_uIndexCount; i += 3)
+	{
+		XMFLOAT4 pPolygon[g_uMaxClippedVertices + 1];
+		XMFLOAT4 pClipped[g_uMaxClippedVertices + 1];
+		for (unsigned int v = 0; v < 3; v++)
+		{
+			XMStoreFloat4(&pPolygon[v], XMVector3Transform(XMLoadFloat3(&a_pPositions[a_pIndices[i + v]]), worldViewProjection));
+		}
+
+		// Clipping to the screen keeps the pixel coordinates small enough for the edge functions to stay exact.
+		unsigned int uCount = 3;
+		for (int p = 0; p < 5 && uCount >= 3; p++)
+		{
+			uCount = ClipPolygon(pPolygon, uCount, pPlanes[p], pClipped);
+			std::copy(pClipped, pClipped + uCount, pPolygon);
+		}
+		if (uCount < 3) continue;
+
+		// Clip space to buffer pixels, y pointing down.
+		XMFLOAT3 pScreen[g_uMaxClippedVertices + 1];
+		for (unsigned int v = 0; v < uCount; v++)
+		{
+			float fInverseW = 1.0f / pPolygon[v].w;
+			pScreen[v] = XMFLOAT3(
+				(pPolygon[v].x * fInverseW + 1.0f) * fHalfWidth,
+				(1.0f - pPolygon[v].y * fInverseW) * fHalfHeight,
+				pPolygon[v].z * fInverseW);
+		}
+
+		for (unsigned int v = 1; v + 1 < uCount; v++)
+		{
+			AddScreenTriangle(pScreen[0], pScreen[v], pScreen[v + 1]);
+		}
+	}
+}
+
+void OcclusionCuller::Rasterize(JobSystem* a_pJobs)
+{
+	if (a_pJobs == nullptr || a_pJobs->GetThreadCount() == 0)
+	{
+		RasterizeBlockRows(0, m_uBlocksY);
+	}
+	else
+	{
+		// Rows never share pixels or blocks, so the jobs need no synchronization.
+		std::vector<std::future<void>> lJobs;
+		lJobs.reserve(m_uBlocksY);
+		for (unsigned int uRow = 0; uRow < m_uBlocksY; uRow++)
+		{
+			lJobs.push_back(a_pJobs->Submit([this, uRow]() { RasterizeBlockRows(uRow, uRow + 1); }));
+		}
+		for (std::future<void>& job : lJobs)
+		{
+			job.get();
+		}
+	}
+
+	m_osStats.OccluderTriangles = static_cast<unsigned int>(m_lTriangles.size());
+	m_osStats.RasterizeMs = std::chrono::duration<double, std::milli>(Clock::now() - m_tpFrameStart).count();
+}
+
+bool OcclusionCuller::IsVisible(const CullBox& a_cbBox, const XMFLOAT4X4& a_m4ViewProjection) const
+{
+	XMMATRIX viewProjection = XMLoadFloat4x4(&a_m4ViewProjection);
+	float fMinX = FLT_MAX, fMinY = FLT_MAX, fMinZ = FLT_MAX;
+	float fMaxX = -FLT_MAX, fMaxY = -FLT_MAX;
+
+	for (int i = 0; i < 8; i++)
+	{
+		XMVECTOR vCorner = XMVectorSet(
+			a_cbBox.Center.x + ((i & 1) ? a_cbBox.Extents.x : -a_cbBox.Extents.x),
+			a_cbBox.Center.y + ((i & 2) ? a_cbBox.Extents.y : -a_cbBox.Extents.y),
+			a_cbBox.Center.z + ((i & 4) ? a_cbBox.Extents.z : -a_cbBox.Extents.z),
+			1.0f);
+		XMFLOAT4 v4Clip;
+		XMStoreFloat4(&v4Clip, XMVector4Transform(vCorner, viewProjection));
+
+		// Reaching in front of the near plane, nothing can be said about it.
+		if (v4Clip.z < 0.0f || v4Clip.w <= 0.0f) return true;
+
+		float fInverseW = 1.0f / v4Clip.w;
+		fMinX = std::min(fMinX, v4Clip.x * fInverseW);
+		fMaxX = std::max(fMaxX, v4Clip.x * fInverseW);
+		fMinY = std::min(fMinY, v4Clip.y * fInverseW);
+		fMaxY = std::max(fMaxY, v4Clip.y * fInverseW);
+		fMinZ = std::min(fMinZ, v4Clip.z * fInverseW);
+	}
+
+	// Every pixel the box's screen rectangle touches, plus a ring around them.
+	// Occluders only cover pixels whose centers they cover, so the ring keeps a
+	// box peeking out of a partly covered pixel from hiding behind it.
+	int nLeft = static_cast<int>(floorf((fMinX + 1.0f) * m_uWidth * 0.5f)) - 1;
+	int nRight = static_cast<int>(floorf((fMaxX + 1.0f) * m_uWidth * 0.5f)) + 1;
+	int nTop = static_cast<int>(floorf((1.0f - fMaxY) * m_uHeight * 0.5f)) - 1;
+	int nBottom = static_cast<int>(floorf((1.0f - fMinY) * m_uHeight * 0.5f)) + 1;
+	if (nRight < 0 || nBottom < 0 || nLeft >= static_cast<int>(m_uWidth) || nTop >= static_cast<int>(m_uHeight)) return true;
+	nLeft = std::max(nLeft, 0);
+	nTop = std::max(nTop, 0);
+	nRight = std::min(nRight, static_cast<int>(m_uWidth) - 1);
+	nBottom = std::min(nBottom, static_cast<int>(m_uHeight) - 1);
+
+	for (int nBlockY = nTop / BLOCK_SIZE; nBlockY <= nBottom / static_cast<int>(BLOCK_SIZE); nBlockY++)
+	{
+		for (int nBlockX = nLeft / BLOCK_SIZE; nBlockX <= nRight / static_cast<int>(BLOCK_SIZE); nBlockX++)
+		{
+			// The whole block is nearer than the box, whatever part of it the box covers.
+			if (m_lBlockDepth[nBlockY * m_uBlocksX + nBlockX] < fMinZ) continue;
+
+			// Otherwise only the pixels the box actually covers decide.
+			int nFirstY = std::max(nTop, nBlockY * static_cast<int>(BLOCK_SIZE));
+			int nLastY = std::min(nBottom, (nBlockY + 1) * static_cast<int>(BLOCK_SIZE) - 1);
+			int nFirstX = std::max(nLeft, nBlockX * static_cast<int>(BLOCK_SIZE));
+			int nLastX = std::min(nRight, (nBlockX + 1) * static_cast<int>(BLOCK_SIZE) - 1);
+			for (int y = nFirstY; y <= nLastY; y++)
+			{
+				const float* pRow = &m_lDepth[y * m_uWidth];
+				for (int x = nFirstX; x <= nLastX; x++)
+				{
+					if (pRow[x] >= fMinZ) return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+unsigned int OcclusionCuller::Cull(const CullBox* a_pBoxes, unsigned int a_uCount, const XMFLOAT4X4& a_m4ViewProjection, unsigned char* a_pVisible)
+{
+	Clock::time_point tpStart = Clock::now();
+	unsigned int uOccluded = 0;
+
+	for (unsigned int i = 0; i < a_uCount; i++)
+	{
+		if (!a_pVisible[i]) continue;
+
+		m_osStats.Tested++;
+		if (!IsVisible(a_pBoxes[i], a_m4ViewProjection))
+		{
+			a_pVisible[i] = 0;
+			uOccluded++;
+		}
+	}
+
+	m_osStats.Occluded += uOccluded;
+	m_osStats.TestMs += std::chrono::duration<double, std::milli>(Clock::now() - tpStart).count();
+	return uOccluded;
+}
+
+float OcclusionCuller::GetDepth(unsigned int a_uX, unsigned int a_uY) const
+{
+	return m_lDepth[a_uY * m_uWidth + a_uX];
+}
+
+unsigned int OcclusionCuller::GetWidth(void) const
+{
+	return m_uWidth;
+}
+
+unsigned int OcclusionCuller::GetHeight(void) const
+{
+	return m_uHeight;
+}
+
+const OcclusionStats& OcclusionCuller::GetStats(void) const
+{
+	return m_osStats;
+}
+
+void OcclusionCuller::AddScreenTriangle(XMFLOAT3 a_v3A, XMFLOAT3 a_v3B, XMFLOAT3 a_v3C)
+{
+	float fArea = (a_v3B.x - a_v3A.x) * (a_v3C.y - a_v3A.y) - (a_v3C.x - a_v3A.x) * (a_v3B.y - a_v3A.y);
+	if (fabsf(fArea) < g_fMinTriangleArea) return;
+
+	ScreenTriangle triangle;
+
+	// Edge from a to b is (b - a) x (p - a), positive on the inside for counter clockwise triangles.
+	// Flipping clockwise ones draws both sides the same.
+	float fSign = fArea > 0.0f ? 1.0f : -1.0f;
+	const XMFLOAT3* pVertices[3] = { &a_v3A, &a_v3B, &a_v3C };
+	for (int e = 0; e < 3; e++)
+	{
+		const XMFLOAT3& v3From = *pVertices[e];
+		const XMFLOAT3& v3To = *pVertices[(e + 1) % 3];
+		triangle.EdgeA[e] = -(v3To.y - v3From.y) * fSign;
+		triangle.EdgeB[e] = (v3To.x - v3From.x) * fSign;
+		triangle.EdgeC[e] = ((v3To.y - v3From.y) * v3From.x - (v3To.x - v3From.x) * v3From.y) * fSign;
+	}
+
+	// Depth over the screen is a plane.  Sampling it at the far corner of each
+	// pixel keeps the stored depth from ever being nearer than the occluder.
+	float fInverseArea = 1.0f / fArea;
+	triangle.DepthA = ((a_v3B.z - a_v3A.z) * (a_v3C.y - a_v3A.y) - (a_v3C.z - a_v3A.z) * (a_v3B.y - a_v3A.y)) * fInverseArea;
+	triangle.DepthB = ((a_v3B.x - a_v3A.x) * (a_v3C.z - a_v3A.z) - (a_v3C.x - a_v3A.x) * (a_v3B.z - a_v3A.z)) * fInverseArea;
+	triangle.DepthC = a_v3A.z - triangle.DepthA * a_v3A.x - triangle.DepthB * a_v3A.y
+		+ 0.5f * (fabsf(triangle.DepthA) + fabsf(triangle.DepthB));
+
+	// Pixels whose centers (x + 0.5, y + 0.5) fall within the triangle's bounds.
+	float fMinX = std::min(a_v3A.x, std::min(a_v3B.x, a_v3C.x));
+	float fMaxX = std::max(a_v3A.x, std::max(a_v3B.x, a_v3C.x));
+	float fMinY = std::min(a_v3A.y, std::min(a_v3B.y, a_v3C.y));
+	float fMaxY = std::max(a_v3A.y, std::max(a_v3B.y, a_v3C.y));
+	triangle.MinX = std::max(0, static_cast<int>(ceilf(fMinX - 0.5f)));
+	triangle.MaxX = std::min(static_cast<int>(m_uWidth) - 1, static_cast<int>(floorf(fMaxX - 0.5f)));
+	triangle.MinY = std::max(0, static_cast<int>(ceilf(fMinY - 0.5f)));
+	triangle.MaxY = std::min(static_cast<int>(m_uHeight) - 1, static_cast<int>(floorf(fMaxY - 0.5f)));
+	if (triangle.MinX > triangle.MaxX || triangle.MinY > triangle.MaxY) return;
+
+	m_lTriangles.push_back(triangle);
+}
+
+void OcclusionCuller::RasterizeBlockRows(unsigned int a_uFirstRow, unsigned int a_uLastRow)
+{
+	int nFirstY = static_cast<int>(a_uFirstRow * BLOCK_SIZE);
+	int nLastY = static_cast<int>(a_uLastRow * BLOCK_SIZE) - 1;
+	std::fill(m_lDepth.begin() + nFirstY * m_uWidth, m_lDepth.begin() + (nLastY + 1) * m_uWidth, 1.0f);
+
+	// The centers of four neighbouring pixels, one per lane.
+	XMVECTOR vLaneOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+	XMVECTOR vZero = XMVectorZero();
+
+	for (const ScreenTriangle& triangle : m_lTriangles)
+	{
+		if (triangle.MaxY < nFirstY || triangle.MinY > nLastY) continue;
+
+		XMVECTOR pEdgeA[3], pEdgeStep[3];
+		for (int e = 0; e < 3; e++)
+		{
+			pEdgeA[e] = XMVectorReplicate(triangle.EdgeA[e]);
+			pEdgeStep[e] = XMVectorReplicate(triangle.EdgeA[e] * 4.0f);
+		}
+		XMVECTOR vDepthA = XMVectorReplicate(triangle.DepthA);
+		XMVECTOR vDepthStep = XMVectorReplicate(triangle.DepthA * 4.0f);
+
+		// Rows start on a multiple of four so every load and store is one whole vector.
+		int nStartX = triangle.MinX & ~3;
+		XMVECTOR vStartX = XMVectorAdd(XMVectorReplicate(static_cast<float>(nStartX)), vLaneOffsets);
+		int nRowBegin = std::max(triangle.MinY, nFirstY);
+		int nRowEnd = std::min(triangle.MaxY, nLastY);
+
+		for (int y = nRowBegin; y <= nRowEnd; y++)
+		{
+			float fCenterY = y + 0.5f;
+			XMVECTOR pEdges[3];
+			for (int e = 0; e < 3; e++)
+			{
+				pEdges[e] = XMVectorMultiplyAdd(pEdgeA[e], vStartX, XMVectorReplicate(triangle.EdgeB[e] * fCenterY + triangle.EdgeC[e]));
+			}
+			XMVECTOR vDepth = XMVectorMultiplyAdd(vDepthA, vStartX, XMVectorReplicate(triangle.DepthB * fCenterY + triangle.DepthC));
+
+			float* pRow = &m_lDepth[y * m_uWidth];
+			for (int x = nStartX; x <= triangle.MaxX; x += 4)
+			{
+				XMVECTOR vInside = XMVectorAndInt(
+					XMVectorAndInt(XMVectorGreaterOrEqual(pEdges[0], vZero), XMVectorGreaterOrEqual(pEdges[1], vZero)),
+					XMVectorGreaterOrEqual(pEdges[2], vZero));
+
+				XMFLOAT4* pPixels = reinterpret_cast<XMFLOAT4*>(pRow + x);
+				XMVECTOR vCurrent = XMLoadFloat4(pPixels);
+				XMStoreFloat4(pPixels, XMVectorSelect(vCurrent, XMVectorMin(vCurrent, vDepth), vInside));
+
+				for (int e = 0; e < 3; e++)
+				{
+					pEdges[e] = XMVectorAdd(pEdges[e], pEdgeStep[e]);
+				}
+				vDepth = XMVectorAdd(vDepth, vDepthStep);
+			}
+		}
+	}
+
+	// Each block keeps its farthest pixel, so a box behind it is behind every pixel in it.
+	for (unsigned int uRow = a_uFirstRow; uRow < a_uLastRow; uRow++)
+	{
+		for (unsigned int uBlockX = 0; uBlockX < m_uBlocksX; uBlockX++)
+		{
+			XMVECTOR vFarthest = XMVectorZero();
+			for (unsigned int y = uRow * BLOCK_SIZE; y < (uRow + 1) * BLOCK_SIZE; y++)
+			{
+				const float* pPixels = &m_lDepth[y * m_uWidth + uBlockX * BLOCK_SIZE];
+				for (unsigned int x = 0; x < BLOCK_SIZE; x += 4)
+				{
+					vFarthest = XMVectorMax(vFarthest, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(pPixels + x)));
+				}
+			}
+
+			XMFLOAT4 v4Farthest;
+			XMStoreFloat4(&v4Farthest, vFarthest);
+			m_lBlockDepth[uRow * m_uBlocksX + uBlockX] = std::max(std::max(v4Farthest.x, v4Farthest.y), std::max(v4Farthest.z, v4Farthest.w));
+		}
+	}
+}
@@ -0,0 +1,140 @@
+#ifndef __OCCLUSIONCULLER_H_
+#define __OCCLUSIONCULLER_H_
+
+#include <DirectXMath.h>
+#include <chrono>
+#include <vector>
+#include "FrustumCuller.h"
+#include "JobSystem.h"
+
+/// <summary>
+/// What the occlusion culler did over the last frame.
+/// </summary>
+struct OcclusionStats
+{
+	unsigned int OccluderTriangles;		// Triangles rasterized, after clipping to the screen.
+	unsigned int Tested;				// Boxes tested against the depth buffer.
+	unsigned int Occluded;				// Boxes found to be hidden.
+	double RasterizeMs;					// From BeginFrame() until the depth buffer was done.
+	double TestMs;						// Spent in Cull().
+};
+
+/// <summary>
+/// Rasterizes a few large, low poly occluders into a small depth buffer on the
+/// CPU, then tests boxes against it to skip drawing whatever they hide.  Needs
+/// no graphics device.
+///
+/// The buffer keeps the nearest occluder depth per pixel and, one level up,
+/// the farthest of those per BLOCK_SIZE square block, so most boxes are
+/// settled by a handful of block reads.  Pixels count as covered when their
+/// center is, like the GPU, so boxes are tested with a one pixel ring around
+/// them.  Only gaps between occluders thinner than a pixel can still hide
+/// something that should have been drawn.
+/// </summary>
+class OcclusionCuller
+{
+private:
+	/// <summary>
+	/// A triangle set up for rasterizing, in buffer pixels.
+	/// </summary>
+	struct ScreenTriangle
+	{
+		float EdgeA[3], EdgeB[3], EdgeC[3];	// A * x + B * y + C >= 0 inside every edge.
+		float DepthA, DepthB, DepthC;		// A * x + B * y + C is the depth, rounded away from the camera.
+		int MinX, MaxX, MinY, MaxY;			// Inclusive pixel bounds, clamped to the buffer.
+	};
+
+	typedef std::chrono::steady_clock Clock;
+
+	unsigned int m_uWidth;
+	unsigned int m_uHeight;
+	unsigned int m_uBlocksX;
+	unsigned int m_uBlocksY;
+	std::vector<float> m_lDepth;				// Nearest occluder per pixel, 1 where there is none.
+	std::vector<float> m_lBlockDepth;			// Farthest value of m_lDepth per block.
+	std::vector<ScreenTriangle> m_lTriangles;
+	OcclusionStats m_osStats;
+	Clock::time_point m_tpFrameStart;
+
+public:
+	// Pixels per side of a block, also the rows each rasterizer job covers.
+	static const unsigned int BLOCK_SIZE = 8;
+
+	/// <summary>
+	/// Creates the depth buffer.  Its size is independent of the window's, a
+	/// quarter of the resolution or less is plenty.
+	/// </summary>
+	/// <param name="a_uWidth">Width in pixels, rounded up to a multiple of BLOCK_SIZE.</param>
+	/// <param name="a_uHeight">Height in pixels, rounded up to a multiple of BLOCK_SIZE.</param>
+	OcclusionCuller(unsigned int a_uWidth = 320, unsigned int a_uHeight = 192);
+
+	/// <summary>
+	/// Forgets last frame's occluders.  Call before adding this frame's.
+	/// </summary>
+	void BeginFrame(void);
+
+	/// <summary>
+	/// Clips and sets up an indexed triangle list for rasterizing.  Both sides
+	/// of every triangle are drawn.
+	/// </summary>
+	/// <param name="a_pPositions">Local space vertex positions.</param>
+	/// <param name="a_pIndices">Three indices per triangle.</param>
+	/// <param name="a_uIndexCount">The amount of indices.</param>
+	/// <param name="a_m4WorldViewProjection">The occluder's row vector world * view * projection.</param>
+	void AddOccluder(
+		const DirectX::XMFLOAT3* a_pPositions,
+		const unsigned int* a_pIndices,
+		unsigned int a_uIndexCount,
+		const DirectX::XMFLOAT4X4& a_m4WorldViewProjection);
+
+	/// <summary>
+	/// Draws every added occluder into the depth buffer, one row of blocks per job.
+	/// </summary>
+	/// <param name="a_pJobs">Splits the rows across these workers if given, otherwise it all runs on the calling thread.</param>
+	void Rasterize(JobSystem* a_pJobs = nullptr);
+
+	/// <summary>
+	/// Tests whether any part of a box could be in front of the occluders.
+	/// Boxes crossing the near plane or leaving the screen are always visible.
+	/// </summary>
+	/// <param name="a_cbBox">The world space box.</param>
+	/// <param name="a_m4ViewProjection">The row vector view * projection the occluders were drawn with.</param>
+	/// <returns>False only if the box is entirely behind the occluders.</returns>
+	bool IsVisible(const CullBox& a_cbBox, const DirectX::XMFLOAT4X4& a_m4ViewProjection) const;
+
+	/// <summary>
+	/// Tests every box still marked visible, clearing the flags of the hidden ones.
+	/// </summary>
+	/// <param name="a_pBoxes">The world space boxes.</param>
+	/// <param name="a_uCount">The amount of boxes.</param>
+	/// <param name="a_m4ViewProjection">The row vector view * projection the occluders were drawn with.</param>
+	/// <param name="a_pVisible">One flag per box, from frustum culling.  Occluded boxes are set to 0.</param>
+	/// <returns>The amount of boxes found to be occluded.</returns>
+	unsigned int Cull(const CullBox* a_pBoxes, unsigned int a_uCount, const DirectX::XMFLOAT4X4& a_m4ViewProjection, unsigned char* a_pVisible);
+
+	/// <summary>
+	/// Gets the depth buffer value of a pixel, for debugging.
+	/// </summary>
+	float GetDepth(unsigned int a_uX, unsigned int a_uY) const;
+
+	unsigned int GetWidth(void) const;
+	unsigned int GetHeight(void) const;
+
+	/// <summary>
+	/// Gets the counts and timings of the current frame.
+	/// </summary>
+	const OcclusionStats& GetStats(void) const;
+
+private:
+	/// <summary>
+	/// Sets up one triangle that already lies within the screen and in front of the near plane.
+	/// </summary>
+	void AddScreenTriangle(DirectX::XMFLOAT3 a_v3A, DirectX::XMFLOAT3 a_v3B, DirectX::XMFLOAT3 a_v3C);
+
+	/// <summary>
+	/// Clears and rasterizes rows of blocks [a_uFirstRow, a_uLastRow), then fills in their block depths.
+	/// </summary>
+	void RasterizeBlockRows(unsigned int a_uFirstRow, unsigned int a_uLastRow);
+};
+
+#endif //__OCCLUSIONCULLER_H_
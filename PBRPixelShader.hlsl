@@ -1,26 +1,20 @@
 #include "ShaderFunctions.hlsli"
 #include "PBRFunctions.hlsli"
-#define MAX_LIGHT_COUNT 5
+#include "SceneConstants.hlsli"
 
 Texture2D Albedo : register(t0); // 't' register is specifically for textures.
 Texture2D NormalMap : register(t1);
 Texture2D RoughnessMap : register(t2);
 Texture2D MetalnessMap : register(t3);
-Texture2D ShadowMap : register(t4);
 
 SamplerState BasicSampler : register(s0); // 's' register is specifically for samplers.
-SamplerComparisonState ShadowSampler : register(s1);
 
-cbuffer ExternalData : register(b0)
+// Only the material's own values, the camera, lights and shadow map come from SceneConstants.hlsli.
+cbuffer PerMaterial : register(b0)
 {
     // - -
     float2 scale;
     float2 offset;
-    // - -
-    float3 cameraPosition;
-    float padding;
-    // - -
-    Light lights[MAX_LIGHT_COUNT];
 }
 
 float4 main(VertexToPixel input) : SV_TARGET
@@ -51,9 +45,9 @@ float4 main(VertexToPixel input) : SV_TARGET
     float3 unpackedNormal = NormalMap.Sample(BasicSampler, input.uv * scale + offset).rgb * 2 - 1;
     unpackedNormal = normalize(unpackedNormal);
     float3 N = normalize(input.normal);
-    float3 T = normalize(input.tangent);
+    float3 T = normalize(input.tangent.xyz);
     T = normalize(T - N * dot(T, N));
-    float3 B = cross(T, N);
+    float3 B = cross(T, N) * input.tangent.w;
     float3x3 TBN = float3x3(T, B, N);
     input.normal = mul(unpackedNormal, TBN);
     
@@ -0,0 +1,174 @@
+#include "PipelineStateCache.h"
+
+PipelineStateCache::PipelineStateCache() :
+	m_pContext(nullptr),
+	m_pContext1(nullptr),
+	m_pssStats(),
+	m_pssLastFrame()
+{
+	Invalidate();
+}
+
+void PipelineStateCache::SetContext(ID3D11DeviceContext* a_pContext, ID3D11DeviceContext1* a_pContext1)
+{
+	m_pContext = a_pContext;
+	m_pContext1 = a_pContext1;
+	Invalidate();
+}
+
+void PipelineStateCache::Invalidate(void)
+{
+	m_sInputLayout.Known = false;
+	m_sVertexShader.Known = false;
+	m_sPixelShader.Known = false;
+	for (unsigned int i = 0; i < CONSTANT_BUFFER_SLOTS; i++)
+	{
+		m_sVSConstantBuffers[i].Known = false;
+		m_sPSConstantBuffers[i].Known = false;
+	}
+	for (unsigned int i = 0; i < SAMPLER_SLOTS; i++)
+	{
+		m_sVSSamplers[i].Known = false;
+		m_sPSSamplers[i].Known = false;
+	}
+	for (unsigned int i = 0; i < VERTEX_BUFFER_SLOTS; i++)
+	{
+		m_sVertexBuffers[i].Known = false;
+	}
+	m_sIndexBuffer.Known = false;
+	m_sRasterizerState.Known = false;
+	m_sDepthStencilState.Known = false;
+	ForgetShaderResources();
+}
+
+void PipelineStateCache::ForgetShaderResources(void)
+{
+	for (unsigned int i = 0; i < SHADER_RESOURCE_SLOTS; i++)
+	{
+		m_sVSShaderResources[i].Known = false;
+		m_sPSShaderResources[i].Known = false;
+	}
+}
+
+void PipelineStateCache::BeginFrame(void)
+{
+	m_pssLastFrame = m_pssStats;
+	m_pssStats = {};
+	Invalidate();
+}
+
+const PipelineStateStats& PipelineStateCache::GetStats(void) const { return m_pssStats; }
+const PipelineStateStats& PipelineStateCache::GetLastFrameStats(void) const { return m_pssLastFrame; }
+
+void PipelineStateCache::SetInputLayout(ID3D11InputLayout* a_pInputLayout)
+{
+	if (Update(m_sInputLayout, a_pInputLayout)) m_pContext->IASetInputLayout(a_pInputLayout);
+}
+
+void PipelineStateCache::SetVertexShader(ID3D11VertexShader* a_pShader)
+{
+	if (Update(m_sVertexShader, a_pShader)) m_pContext->VSSetShader(a_pShader, 0, 0);
+}
+
+void PipelineStateCache::SetPixelShader(ID3D11PixelShader* a_pShader)
+{
+	if (Update(m_sPixelShader, a_pShader)) m_pContext->PSSetShader(a_pShader, 0, 0);
+}
+
+void PipelineStateCache::SetVSConstantBuffer(UINT a_uSlot, ID3D11Buffer* a_pBuffer, UINT a_uFirstConstant, UINT a_uNumConstants)
+{
+	if (a_uSlot < CONSTANT_BUFFER_SLOTS && !Update(m_sVSConstantBuffers[a_uSlot], ConstantBufferBinding{ a_pBuffer, a_uFirstConstant, a_uNumConstants }))
+		return;
+	if (a_uNumConstants > 0)
+		m_pContext1->VSSetConstantBuffers1(a_uSlot, 1, &a_pBuffer, &a_uFirstConstant, &a_uNumConstants);
+	else
+		m_pContext->VSSetConstantBuffers(a_uSlot, 1, &a_pBuffer);
+}
+
+void PipelineStateCache::SetPSConstantBuffer(UINT a_uSlot, ID3D11Buffer* a_pBuffer, UINT a_uFirstConstant, UINT a_uNumConstants)
+{
+	if (a_uSlot < CONSTANT_BUFFER_SLOTS && !Update(m_sPSConstantBuffers[a_uSlot], ConstantBufferBinding{ a_pBuffer, a_uFirstConstant, a_uNumConstants }))
+		return;
+	if (a_uNumConstants > 0)
+		m_pContext1->PSSetConstantBuffers1(a_uSlot, 1, &a_pBuffer, &a_uFirstConstant, &a_uNumConstants);
+	else
+		m_pContext->PSSetConstantBuffers(a_uSlot, 1, &a_pBuffer);
+}
+
+void PipelineStateCache::SetVSShaderResource(UINT a_uSlot, ID3D11ShaderResourceView* a_pSRV)
+{
+	if (a_uSlot >= SHADER_RESOURCE_SLOTS || Update(m_sVSShaderResources[a_uSlot], a_pSRV))
+		m_pContext->VSSetShaderResources(a_uSlot, 1, &a_pSRV);
+}
+
+void PipelineStateCache::SetPSShaderResource(UINT a_uSlot, ID3D11ShaderResourceView* a_pSRV)
+{
+	if (a_uSlot >= SHADER_RESOURCE_SLOTS || Update(m_sPSShaderResources[a_uSlot], a_pSRV))
+		m_pContext->PSSetShaderResources(a_uSlot, 1, &a_pSRV);
+}
+
+void PipelineStateCache::SetVSSampler(UINT a_uSlot, ID3D11SamplerState* a_pSampler)
+{
+	if (a_uSlot >= SAMPLER_SLOTS || Update(m_sVSSamplers[a_uSlot], a_pSampler))
+		m_pContext->VSSetSamplers(a_uSlot, 1, &a_pSampler);
+}
+
+void PipelineStateCache::SetPSSampler(UINT a_uSlot, ID3D11SamplerState* a_pSampler)
+{
+	if (a_uSlot >= SAMPLER_SLOTS || Update(m_sPSSamplers[a_uSlot], a_pSampler))
+		m_pContext->PSSetSamplers(a_uSlot, 1, &a_pSampler);
+}
+
+void PipelineStateCache::SetPSConstantBuffers(UINT a_uStartSlot, UINT a_uCount, ID3D11Buffer* const* a_pBuffers)
+{
+	// Whole buffers, recorded as single binds of them would be.
+	ConstantBufferBinding lBindings[CONSTANT_BUFFER_SLOTS] = {};
+	for (UINT i = 0; i < a_uCount && i < CONSTANT_BUFFER_SLOTS; i++) lBindings[i].Buffer = a_pBuffers[i];
+	const ConstantBufferBinding* pBindings = lBindings;
+	if (UpdateRange(m_sPSConstantBuffers, a_uStartSlot, a_uCount, pBindings))
+		m_pContext->PSSetConstantBuffers(a_uStartSlot, a_uCount, a_pBuffers + (pBindings - lBindings));
+}
+
+void PipelineStateCache::SetPSShaderResources(UINT a_uStartSlot, UINT a_uCount, ID3D11ShaderResourceView* const* a_pSRVs)
+{
+	if (UpdateRange(m_sPSShaderResources, a_uStartSlot, a_uCount, a_pSRVs))
+		m_pContext->PSSetShaderResources(a_uStartSlot, a_uCount, a_pSRVs);
+}
+
+void PipelineStateCache::SetPSSamplers(UINT a_uStartSlot, UINT a_uCount, ID3D11SamplerState* const* a_pSamplers)
+{
+	if (UpdateRange(m_sPSSamplers, a_uStartSlot, a_uCount, a_pSamplers))
+		m_pContext->PSSetSamplers(a_uStartSlot, a_uCount, a_pSamplers);
+}
+
+void PipelineStateCache::SetVertexBuffer(UINT a_uSlot, ID3D11Buffer* a_pBuffer, UINT a_uStride, UINT a_uOffset)
+{
+	if (a_uSlot >= VERTEX_BUFFER_SLOTS || Update(m_sVertexBuffers[a_uSlot], VertexBufferBinding{ a_pBuffer, a_uStride, a_uOffset }))
+		m_pContext->IASetVertexBuffers(a_uSlot, 1, &a_pBuffer, &a_uStride, &a_uOffset);
+}
+
+void PipelineStateCache::SetIndexBuffer(ID3D11Buffer* a_pBuffer, DXGI_FORMAT a_fFormat, UINT a_uOffset)
+{
+	if (Update(m_sIndexBuffer, IndexBufferBinding{ a_pBuffer, a_fFormat, a_uOffset }))
+		m_pContext->IASetIndexBuffer(a_pBuffer, a_fFormat, a_uOffset);
+}
+
+void PipelineStateCache::SetRasterizerState(ID3D11RasterizerState* a_pState)
+{
+	if (Update(m_sRasterizerState, a_pState)) m_pContext->RSSetState(a_pState);
+}
+
+void PipelineStateCache::SetDepthStencilState(ID3D11DepthStencilState* a_pState, UINT a_uStencilRef)
+{
+	if (Update(m_sDepthStencilState, DepthStencilBinding{ a_pState, a_uStencilRef }))
+		m_pContext->OMSetDepthStencilState(a_pState, a_uStencilRef);
+}
+
+void PipelineStateCache::SetRenderTargets(UINT a_uCount, ID3D11RenderTargetView* const* a_pRTVs, ID3D11DepthStencilView* a_pDSV)
+{
+	m_pssStats.Issued++;
+	m_pContext->OMSetRenderTargets(a_uCount, a_pRTVs, a_pDSV);
+
+	// The context unbinds shader resources that alias the new outputs without saying which.
+	ForgetShaderResources();
+}
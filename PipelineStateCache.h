@@ -0,0 +1,209 @@
+#ifndef __PIPELINESTATECACHE_H_
+#define __PIPELINESTATECACHE_H_
+
+#include <d3d11_1.h>
+
+/// <summary>
+/// Binding calls over a frame.
+/// </summary>
+struct PipelineStateStats
+{
+	unsigned int Issued;				// Reached the device context.
+	unsigned int Elided;				// Dropped, the same thing was already bound.
+};
+
+/// <summary>
+/// Remembers what is bound to the device context and drops binds that would
+/// change nothing.  Only sees binds made through it, so anything bound behind
+/// its back must be followed by Invalidate().  Binding render targets always
+/// reaches the context and forgets the shader resources, since the context
+/// unbinds any of them that are now also an output.
+/// </summary>
+class PipelineStateCache
+{
+public:
+	// Slots tracked per kind of binding, binds to higher slots always reach the context.
+	static const unsigned int CONSTANT_BUFFER_SLOTS = D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT;
+	static const unsigned int SHADER_RESOURCE_SLOTS = 16;
+	static const unsigned int SAMPLER_SLOTS = D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT;
+	static const unsigned int VERTEX_BUFFER_SLOTS = 4;
+
+private:
+	/// <summary>
+	/// A bound value, or nothing known about it.
+	/// </summary>
+	template<typename T>
+	struct Slot
+	{
+		T Value;
+		bool Known;
+	};
+
+	struct ConstantBufferBinding
+	{
+		ID3D11Buffer* Buffer;
+		UINT FirstConstant;
+		UINT NumConstants;				// 0 for the whole buffer.
+		bool operator==(const ConstantBufferBinding& a_cbbOther) const { return Buffer == a_cbbOther.Buffer && FirstConstant == a_cbbOther.FirstConstant && NumConstants == a_cbbOther.NumConstants; }
+	};
+
+	struct VertexBufferBinding
+	{
+		ID3D11Buffer* Buffer;
+		UINT Stride;
+		UINT Offset;
+		bool operator==(const VertexBufferBinding& a_vbbOther) const { return Buffer == a_vbbOther.Buffer && Stride == a_vbbOther.Stride && Offset == a_vbbOther.Offset; }
+	};
+
+	struct IndexBufferBinding
+	{
+		ID3D11Buffer* Buffer;
+		DXGI_FORMAT Format;
+		UINT Offset;
+		bool operator==(const IndexBufferBinding& a_ibbOther) const { return Buffer == a_ibbOther.Buffer && Format == a_ibbOther.Format && Offset == a_ibbOther.Offset; }
+	};
+
+	struct DepthStencilBinding
+	{
+		ID3D11DepthStencilState* State;
+		UINT StencilRef;
+		bool operator==(const DepthStencilBinding& a_dsbOther) const { return State == a_dsbOther.State && StencilRef == a_dsbOther.StencilRef; }
+	};
+
+	ID3D11DeviceContext* m_pContext;
+	ID3D11DeviceContext1* m_pContext1;
+	Slot<ID3D11InputLayout*> m_sInputLayout;
+	Slot<ID3D11VertexShader*> m_sVertexShader;
+	Slot<ID3D11PixelShader*> m_sPixelShader;
+	Slot<ConstantBufferBinding> m_sVSConstantBuffers[CONSTANT_BUFFER_SLOTS];
+	Slot<ConstantBufferBinding> m_sPSConstantBuffers[CONSTANT_BUFFER_SLOTS];
+	Slot<ID3D11ShaderResourceView*> m_sVSShaderResources[SHADER_RESOURCE_SLOTS];
+	Slot<ID3D11ShaderResourceView*> m_sPSShaderResources[SHADER_RESOURCE_SLOTS];
+	Slot<ID3D11SamplerState*> m_sVSSamplers[SAMPLER_SLOTS];
+	Slot<ID3D11SamplerState*> m_sPSSamplers[SAMPLER_SLOTS];
+	Slot<VertexBufferBinding> m_sVertexBuffers[VERTEX_BUFFER_SLOTS];
+	Slot<IndexBufferBinding> m_sIndexBuffer;
+	Slot<ID3D11RasterizerState*> m_sRasterizerState;
+	Slot<DepthStencilBinding> m_sDepthStencilState;
+	PipelineStateStats m_pssStats;
+	PipelineStateStats m_pssLastFrame;
+
+	/// <summary>
+	/// Records a bind and says whether it has to reach the context.
+	/// </summary>
+	template<typename T>
+	bool Update(Slot<T>& a_sSlot, const T& a_tValue)
+	{
+		if (a_sSlot.Known && a_sSlot.Value == a_tValue)
+		{
+			m_pssStats.Elided++;
+			return false;
+		}
+		a_sSlot.Value = a_tValue;
+		a_sSlot.Known = true;
+		m_pssStats.Issued++;
+		return true;
+	}
+
+	/// <summary>
+	/// Records binds to a run of slots and narrows the run to the slots that
+	/// changed.  Slots past the tracked ones always count as changed.
+	/// </summary>
+	/// <returns>False if nothing changed, so no call has to reach the context.</returns>
+	template<typename T, unsigned int N>
+	bool UpdateRange(Slot<T> (&a_sSlots)[N], UINT& a_uStartSlot, UINT& a_uCount, T const*& a_pValues)
+	{
+		UINT uFirst = a_uStartSlot + a_uCount;
+		UINT uEnd = a_uStartSlot;
+		for (UINT i = 0; i < a_uCount; i++)
+		{
+			UINT uSlot = a_uStartSlot + i;
+			if (uSlot < N)
+			{
+				if (a_sSlots[uSlot].Known && a_sSlots[uSlot].Value == a_pValues[i]) continue;
+				a_sSlots[uSlot].Value = a_pValues[i];
+				a_sSlots[uSlot].Known = true;
+			}
+			if (uSlot < uFirst) uFirst = uSlot;
+			uEnd = uSlot + 1;
+		}
+		if (uEnd <= uFirst)
+		{
+			m_pssStats.Elided++;
+			return false;
+		}
+		a_pValues += uFirst - a_uStartSlot;
+		a_uStartSlot = uFirst;
+		a_uCount = uEnd - uFirst;
+		m_pssStats.Issued++;
+		return true;
+	}
+
+	void ForgetShaderResources(void);
+
+public:
+	PipelineStateCache();
+
+	/// <summary>
+	/// Sets the context binds are passed on to, and forgets everything.
+	/// </summary>
+	/// <param name="a_pContext1">The same context's 11.1 interface, needed to bind part of a constant buffer.</param>
+	void SetContext(ID3D11DeviceContext* a_pContext, ID3D11DeviceContext1* a_pContext1 = nullptr);
+
+	/// <summary>
+	/// Forgets everything, so each kind of binding reaches the context once more.
+	/// </summary>
+	void Invalidate(void);
+
+	/// <summary>
+	/// Keeps the last frame's counts, resets them, and forgets everything
+	/// bound over the previous frame outside of the cache.
+	/// </summary>
+	void BeginFrame(void);
+
+	/// <summary>
+	/// Gets the counts of the frame so far.
+	/// </summary>
+	const PipelineStateStats& GetStats(void) const;
+
+	/// <summary>
+	/// Gets the counts of the whole previous frame.
+	/// </summary>
+	const PipelineStateStats& GetLastFrameStats(void) const;
+
+	void SetInputLayout(ID3D11InputLayout* a_pInputLayout);
+	void SetVertexShader(ID3D11VertexShader* a_pShader);
+	void SetPixelShader(ID3D11PixelShader* a_pShader);
+
+	/// <summary>
+	/// Binds a constant buffer, or the part of one given in 16 byte constants.
+	/// Binding a part takes the 11.1 context, the first constant a multiple of 16.
+	/// </summary>
+	void SetVSConstantBuffer(UINT a_uSlot, ID3D11Buffer* a_pBuffer, UINT a_uFirstConstant = 0, UINT a_uNumConstants = 0);
+	void SetPSConstantBuffer(UINT a_uSlot, ID3D11Buffer* a_pBuffer, UINT a_uFirstConstant = 0, UINT a_uNumConstants = 0);
+
+
+	void SetVSShaderResource(UINT a_uSlot, ID3D11ShaderResourceView* a_pSRV);
+	void SetPSShaderResource(UINT a_uSlot, ID3D11ShaderResourceView* a_pSRV);
+	void SetVSSampler(UINT a_uSlot, ID3D11SamplerState* a_pSampler);
+	void SetPSSampler(UINT a_uSlot, ID3D11SamplerState* a_pSampler);
+
+	/// <summary>
+	/// Binds a run of neighbouring slots in one call, narrowed to the slots that change.
+	/// </summary>
+	void SetPSConstantBuffers(UINT a_uStartSlot, UINT a_uCount, ID3D11Buffer* const* a_pBuffers);
+	void SetPSShaderResources(UINT a_uStartSlot, UINT a_uCount, ID3D11ShaderResourceView* const* a_pSRVs);
+	void SetPSSamplers(UINT a_uStartSlot, UINT a_uCount, ID3D11SamplerState* const* a_pSamplers);
+
+	void SetVertexBuffer(UINT a_uSlot, ID3D11Buffer* a_pBuffer, UINT a_uStride, UINT a_uOffset);
+	void SetIndexBuffer(ID3D11Buffer* a_pBuffer, DXGI_FORMAT a_fFormat, UINT a_uOffset);
+	void SetRasterizerState(ID3D11RasterizerState* a_pState);
+	void SetDepthStencilState(ID3D11DepthStencilState* a_pState, UINT a_uStencilRef);
+
+	/// <summary>
+	/// Binds render targets, which always reaches the context.
+	/// </summary>
+	void SetRenderTargets(UINT a_uCount, ID3D11RenderTargetView* const* a_pRTVs, ID3D11DepthStencilView* a_pDSV);
+};
+
+#endif //__PIPELINESTATECACHE_H_
@@ -1,11 +1,11 @@
 #include "LightingFunctions.hlsli"
-#define MAX_LIGHT_COUNT 5
+#include "SceneConstants.hlsli"
 
 Texture2D SurfaceTexture : register(t0);    // 't' register is specifically for textures.
 Texture2D NormalMap : register(t1);
 SamplerState BasicSampler : register(s0);   // 's' register is specifically for samplers.
 
-cbuffer ExternalData : register(b0)
+cbuffer PerMaterial : register(b0)
 {
     // - -
     float4 colorTint;
@@ -13,13 +13,8 @@ cbuffer ExternalData : register(b0)
     float2 scale;
     float2 offset;
     // - -
-    float3 cameraPosition;
     float roughness;
-    // - -
-    float3 ambient;
-    float padding;
-    // - -
-    Light lights[MAX_LIGHT_COUNT];
+    float3 padding;
 }
 
 float4 main(VertexToPixel input) : SV_TARGET
@@ -31,9 +26,9 @@ float4 main(VertexToPixel input) : SV_TARGET
     unpackedNormal = normalize(unpackedNormal);
     
     float3 N = normalize(input.normal);
-    float3 T = normalize(input.tangent);
+    float3 T = normalize(input.tangent.xyz);
     T = normalize(T - N * dot(T, N));
-    float3 B = cross(T, N);
+    float3 B = cross(T, N) * input.tangent.w;
     float3x3 TBN = float3x3(T, B, N);
     input.normal = mul(unpackedNormal, TBN);
     
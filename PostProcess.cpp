@@ -64,12 +64,12 @@ void PostProcess::PreRender(float a_fBackgroundColor[4])
 	Graphics::Context->ClearRenderTargetView(m_pResourceTarget.Get(), a_fBackgroundColor);
 
 	// Swapping the active render targets.
-	Graphics::Context->OMSetRenderTargets(1, m_pResourceTarget.GetAddressOf(), Graphics::DepthBufferDSV.Get());
+	Graphics::StateCache.SetRenderTargets(1, m_pResourceTarget.GetAddressOf(), Graphics::DepthBufferDSV.Get());
 }
 
 void PostProcess::PostRender(std::shared_ptr<SimpleVertexShader> a_pVertexShader, Microsoft::WRL::ComPtr<ID3D11SamplerState> a_pSampler)
 {
-	Graphics::Context->OMSetRenderTargets(1, Graphics::BackBufferRTV.GetAddressOf(), 0);
+	Graphics::StateCache.SetRenderTargets(1, Graphics::BackBufferRTV.GetAddressOf(), 0);
 
 	// Setting the active shaders.
 	a_pVertexShader->SetShader();
@@ -0,0 +1,218 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <functional>
+
+namespace
+{
+	// Keys are sorted a byte at a time.
+	const unsigned int g_uRadixBits = 8;
+	const unsigned int g_uBuckets = 1 << g_uRadixBits;
+
+	// Below this many keys per worker, splitting a pass costs more than it saves.
+	const size_t g_uMinKeysPerJob = 16384;
+
+	typedef std::chrono::steady_clock Clock;
+
+	uint64_t FieldMask(unsigned int a_uBits)
+	{
+		return (uint64_t(1) << a_uBits) - 1;
+	}
+
+	/// <summary>
+	/// Counts the neighbouring keys that differ at or above a bit.
+	/// </summary>
+	unsigned int CountChanges(const uint64_t* a_pKeys, size_t a_uCount, unsigned int a_uShift)
+	{
+		unsigned int uChanges = 0;
+		for (size_t i = 1; i < a_uCount; i++)
+		{
+			if ((a_pKeys[i] >> a_uShift) != (a_pKeys[i - 1] >> a_uShift)) uChanges++;
+		}
+		return uChanges;
+	}
+
+	/// <summary>
+	/// Runs a job for each of a_uJobs chunks and waits for all of them.
+	/// </summary>
+	void RunJobs(JobSystem* a_pJobs, unsigned int a_uJobs, const std::function<void(unsigned int)>& a_fJob)
+	{
+		if (a_pJobs == nullptr || a_uJobs <= 1)
+		{
+			for (unsigned int j = 0; j < a_uJobs; j++) a_fJob(j);
+			return;
+		}
+
+		std::vector<std::future<void>> lJobs;
+		lJobs.reserve(a_uJobs);
+		for (unsigned int j = 0; j < a_uJobs; j++)
+		{
+			lJobs.push_back(a_pJobs->Submit([&a_fJob, j]() { a_fJob(j); }));
+		}
+		for (std::future<void>& job : lJobs)
+			job.get();
+	}
+}
+
+RenderQueue::RenderQueue() :
+	m_rqsStats()
+{
+}
+
+uint32_t RenderQueue::GetId(std::unordered_map<const void*, uint32_t>& a_mIds, const void* a_pObject)
+{
+	if (a_pObject == nullptr) return 0;
+
+	// Ids start at 1, leaving 0 for draws without the object.
+	auto it = a_mIds.find(a_pObject);
+	if (it != a_mIds.end()) return it->second;
+	uint32_t uId = static_cast<uint32_t>(a_mIds.size()) + 1;
+	a_mIds.emplace(a_pObject, uId);
+	return uId;
+}
+
+uint32_t RenderQueue::QuantizeDepth(float a_fDepth)
+{
+	if (!(a_fDepth > 0.0f)) return 0;
+
+	// Positive floats order the same as their bits, so the top bits below the sign
+	// are the exponent and the leading mantissa bits.
+	uint32_t uBits;
+	memcpy(&uBits, &a_fDepth, sizeof(uBits));
+	return uBits >> (31 - DEPTH_BITS);
+}
+
+RenderPass RenderQueue::GetPass(uint64_t a_uKey)
+{
+	return static_cast<RenderPass>(a_uKey >> PASS_SHIFT);
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass a_rpPass, const void* a_pShader, const void* a_pMaterial, const void* a_pMesh, float a_fDepth)
+{
+	return
+		((static_cast<uint64_t>(a_rpPass) & FieldMask(PASS_BITS)) << PASS_SHIFT) |
+		((GetId(m_mShaderIds, a_pShader) & FieldMask(SHADER_BITS)) << SHADER_SHIFT) |
+		((GetId(m_mMaterialIds, a_pMaterial) & FieldMask(MATERIAL_BITS)) << MATERIAL_SHIFT) |
+		((GetId(m_mMeshIds, a_pMesh) & FieldMask(MESH_BITS)) << MESH_SHIFT) |
+		(static_cast<uint64_t>(QuantizeDepth(a_fDepth)) << DEPTH_SHIFT);
+}
+
+void RenderQueue::Clear(void)
+{
+	m_lKeys.clear();
+	m_lValues.clear();
+}
+
+void RenderQueue::Add(uint64_t a_uKey, uint32_t a_uValue)
+{
+	m_lKeys.push_back(a_uKey);
+	m_lValues.push_back(a_uValue);
+}
+
+void RenderQueue::Sort(JobSystem* a_pJobs)
+{
+	Clock::time_point tpStart = Clock::now();
+	size_t uCount = m_lKeys.size();
+	m_rqsStats.Draws = static_cast<unsigned int>(uCount);
+	m_rqsStats.UnsortedStateChanges = CountChanges(m_lKeys.data(), uCount, MATERIAL_SHIFT);
+	m_rqsStats.UnsortedMeshChanges = CountChanges(m_lKeys.data(), uCount, MESH_SHIFT);
+
+	m_lScratchKeys.resize(uCount);
+	m_lScratchValues.resize(uCount);
+	RadixSort(m_lKeys.data(), m_lValues.data(), uCount, m_lScratchKeys.data(), m_lScratchValues.data(), a_pJobs);
+
+	m_rqsStats.StateChanges = CountChanges(m_lKeys.data(), uCount, MATERIAL_SHIFT);
+	m_rqsStats.MeshChanges = CountChanges(m_lKeys.data(), uCount, MESH_SHIFT);
+	m_rqsStats.SortMs = std::chrono::duration<double, std::milli>(Clock::now() - tpStart).count();
+}
+
+void RenderQueue::GetPassRange(RenderPass a_rpPass, size_t& a_uFirst, size_t& a_uLast) const
+{
+	uint64_t uPass = static_cast<uint64_t>(a_rpPass);
+	a_uFirst = std::lower_bound(m_lKeys.begin(), m_lKeys.end(), uPass << PASS_SHIFT) - m_lKeys.begin();
+	a_uLast = a_uFirst;
+	while (a_uLast < m_lKeys.size() && GetPass(m_lKeys[a_uLast]) == a_rpPass) a_uLast++;
+}
+
+size_t RenderQueue::GetCount(void) const { return m_lKeys.size(); }
+const uint64_t* RenderQueue::GetKeys(void) const { return m_lKeys.data(); }
+const uint32_t* RenderQueue::GetValues(void) const { return m_lValues.data(); }
+const RenderQueueStats& RenderQueue::GetStats(void) const { return m_rqsStats; }
+
+void RenderQueue::RadixSort(uint64_t* a_pKeys, uint32_t* a_pValues, size_t a_uCount, uint64_t* a_pScratchKeys, uint32_t* a_pScratchValues, JobSystem* a_pJobs)
+{
+	if (a_uCount < 2) return;
+
+	// Bytes every key has the same would leave the order as it is.
+	uint64_t uAnd = ~uint64_t(0);
+	uint64_t uOr = 0;
+	for (size_t i = 0; i < a_uCount; i++)
+	{
+		uAnd &= a_pKeys[i];
+		uOr |= a_pKeys[i];
+	}
+	uint64_t uVarying = uAnd ^ uOr;
+
+	// Each worker counts and then scatters its own contiguous chunk.  Its offsets
+	// within a bucket come after every earlier chunk's, which keeps the sort stable.
+	unsigned int uThreads = a_pJobs != nullptr ? a_pJobs->GetThreadCount() : 0;
+	size_t uJobs = a_uCount / g_uMinKeysPerJob;
+	if (uThreads < uJobs) uJobs = uThreads;
+	if (uJobs < 1) uJobs = 1;
+	size_t uPerJob = (a_uCount + uJobs - 1) / uJobs;
+	std::vector<std::array<size_t, g_uBuckets>> lOffsets(uJobs);
+
+	uint64_t* pSourceKeys = a_pKeys;
+	uint32_t* pSourceValues = a_pValues;
+	uint64_t* pTargetKeys = a_pScratchKeys;
+	uint32_t* pTargetValues = a_pScratchValues;
+	for (unsigned int uShift = 0; uShift < 64; uShift += g_uRadixBits)
+	{
+		if (((uVarying >> uShift) & (g_uBuckets - 1)) == 0) continue;
+
+		RunJobs(a_pJobs, static_cast<unsigned int>(uJobs), [&](unsigned int j)
+		{
+			std::array<size_t, g_uBuckets>& counts = lOffsets[j];
+			counts.fill(0);
+			size_t uEnd = (j + 1) * uPerJob < a_uCount ? (j + 1) * uPerJob : a_uCount;
+			for (size_t i = j * uPerJob; i < uEnd; i++)
+				counts[(pSourceKeys[i] >> uShift) & (g_uBuckets - 1)]++;
+		});
+
+		size_t uOffset = 0;
+		for (unsigned int b = 0; b < g_uBuckets; b++)
+		{
+			for (size_t j = 0; j < uJobs; j++)
+			{
+				size_t uBucketCount = lOffsets[j][b];
+				lOffsets[j][b] = uOffset;
+				uOffset += uBucketCount;
+			}
+		}
+
+		RunJobs(a_pJobs, static_cast<unsigned int>(uJobs), [&](unsigned int j)
+		{
+			std::array<size_t, g_uBuckets>& offsets = lOffsets[j];
+			size_t uEnd = (j + 1) * uPerJob < a_uCount ? (j + 1) * uPerJob : a_uCount;
+			for (size_t i = j * uPerJob; i < uEnd; i++)
+			{
+				size_t uTarget = offsets[(pSourceKeys[i] >> uShift) & (g_uBuckets - 1)]++;
+				pTargetKeys[uTarget] = pSourceKeys[i];
+				pTargetValues[uTarget] = pSourceValues[i];
+			}
+		});
+
+		std::swap(pSourceKeys, pTargetKeys);
+		std::swap(pSourceValues, pTargetValues);
+	}
+
+	// An odd amount of passes leaves the result in the scratch arrays.
+	if (pSourceKeys != a_pKeys)
+	{
+		memcpy(a_pKeys, pSourceKeys, a_uCount * sizeof(uint64_t));
+		memcpy(a_pValues, pSourceValues, a_uCount * sizeof(uint32_t));
+	}
+}
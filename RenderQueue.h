@@ -0,0 +1,141 @@
+#ifndef __RENDERQUEUE_H_
+#define __RENDERQUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "JobSystem.h"
+
+/// <summary>
+/// The passes of a frame, submitted in this order.
+/// </summary>
+enum class RenderPass : uint8_t
+{
+	Shadow = 0,
+	Opaque = 1
+};
+
+/// <summary>
+/// What sorting the queue did over the last frame.
+/// </summary>
+struct RenderQueueStats
+{
+	unsigned int Draws;
+	unsigned int StateChanges;				// Shader or material switches between neighbouring draws, sorted.
+	unsigned int UnsortedStateChanges;		// The same, in the order the draws were added.
+	unsigned int MeshChanges;				// Vertex and index buffer switches, sorted.
+	unsigned int UnsortedMeshChanges;
+	double SortMs;
+};
+
+/// <summary>
+/// A frame's draws as 64 bit keys with a 32 bit value each, sorted so that
+/// draws sharing a shader, then a material, then a mesh sit next to each
+/// other, and front to back within those.  From the top bit down a key holds
+/// the pass, shader, material, mesh and depth.  Free of the graphics device.
+/// </summary>
+class RenderQueue
+{
+public:
+	// Widths of the key's fields.  Ids past a field's width wrap, which only costs state changes.
+	static const unsigned int PASS_BITS = 4;
+	static const unsigned int SHADER_BITS = 10;
+	static const unsigned int MATERIAL_BITS = 14;
+	static const unsigned int MESH_BITS = 16;
+	static const unsigned int DEPTH_BITS = 20;
+
+	static const unsigned int DEPTH_SHIFT = 0;
+	static const unsigned int MESH_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+	static const unsigned int MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+	static const unsigned int SHADER_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+	static const unsigned int PASS_SHIFT = SHADER_SHIFT + SHADER_BITS;
+
+private:
+	std::vector<uint64_t> m_lKeys;
+	std::vector<uint32_t> m_lValues;
+	std::vector<uint64_t> m_lScratchKeys;
+	std::vector<uint32_t> m_lScratchValues;
+	std::unordered_map<const void*, uint32_t> m_mShaderIds;
+	std::unordered_map<const void*, uint32_t> m_mMaterialIds;
+	std::unordered_map<const void*, uint32_t> m_mMeshIds;
+	RenderQueueStats m_rqsStats;
+
+	static uint32_t GetId(std::unordered_map<const void*, uint32_t>& a_mIds, const void* a_pObject);
+
+public:
+	RenderQueue();
+
+	/// <summary>
+	/// Turns a depth into the key's depth field, keeping its order.  Uses the
+	/// top bits of the float itself, so precision is relative to the depth
+	/// and no near or far plane is needed.
+	/// </summary>
+	/// <param name="a_fDepth">Larger is further away.  Anything not above 0 sorts first.</param>
+	static uint32_t QuantizeDepth(float a_fDepth);
+
+	/// <summary>
+	/// Gets the pass a key belongs to.
+	/// </summary>
+	static RenderPass GetPass(uint64_t a_uKey);
+
+	/// <summary>
+	/// Builds the key of a draw.  Shaders, materials and meshes are given ids
+	/// in the order they are first seen, which stay the same from frame to frame.
+	/// </summary>
+	/// <param name="a_rpPass">The pass the draw belongs to.</param>
+	/// <param name="a_pShader">The vertex shader, or anything else that decides the pipeline state.</param>
+	/// <param name="a_pMaterial">The material, null if the pass has none.</param>
+	/// <param name="a_pMesh">The mesh whose buffers get bound.</param>
+	/// <param name="a_fDepth">The distance from the viewer, see QuantizeDepth().</param>
+	uint64_t MakeKey(RenderPass a_rpPass, const void* a_pShader, const void* a_pMaterial, const void* a_pMesh, float a_fDepth);
+
+	/// <summary>
+	/// Empties the queue for a new frame.
+	/// </summary>
+	void Clear(void);
+
+	/// <summary>
+	/// Queues a draw.
+	/// </summary>
+	/// <param name="a_uKey">From MakeKey().</param>
+	/// <param name="a_uValue">Whatever the submitting code needs to find the draw again.</param>
+	void Add(uint64_t a_uKey, uint32_t a_uValue);
+
+	/// <summary>
+	/// Sorts the queued draws by key, keeping the order draws were added in for equal keys.
+	/// </summary>
+	/// <param name="a_pJobs">Splits the work across these workers if given, otherwise it all runs on the calling thread.</param>
+	void Sort(JobSystem* a_pJobs = nullptr);
+
+	/// <summary>
+	/// Finds the draws of one pass, once sorted.
+	/// </summary>
+	/// <param name="a_rpPass">The pass.</param>
+	/// <param name="a_uFirst">Receives the first draw of the pass.</param>
+	/// <param name="a_uLast">Receives one past its last draw.</param>
+	void GetPassRange(RenderPass a_rpPass, size_t& a_uFirst, size_t& a_uLast) const;
+
+	size_t GetCount(void) const;
+	const uint64_t* GetKeys(void) const;
+	const uint32_t* GetValues(void) const;
+
+	/// <summary>
+	/// Gets what the last Sort() did.
+	/// </summary>
+	const RenderQueueStats& GetStats(void) const;
+
+	/// <summary>
+	/// Stable least significant digit radix sort of keys and their values, a
+	/// byte at a time, skipping every byte that all keys share.
+	/// </summary>
+	/// <param name="a_pKeys">The keys, sorted in place.</param>
+	/// <param name="a_pValues">Moved along with their keys.</param>
+	/// <param name="a_uCount">The amount of keys.</param>
+	/// <param name="a_pScratchKeys">Room for a_uCount keys.</param>
+	/// <param name="a_pScratchValues">Room for a_uCount values.</param>
+	/// <param name="a_pJobs">Splits each pass across these workers if given.</param>
+	static void RadixSort(uint64_t* a_pKeys, uint32_t* a_pValues, size_t a_uCount, uint64_t* a_pScratchKeys, uint32_t* a_pScratchValues, JobSystem* a_pJobs = nullptr);
+};
+
+#endif //__RENDERQUEUE_H_
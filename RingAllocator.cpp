@@ -0,0 +1,68 @@
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator(size_t a_uCapacity)
+{
+	Reset(a_uCapacity);
+}
+
+void RingAllocator::Reset(size_t a_uCapacity)
+{
+	m_uCapacity = a_uCapacity;
+	m_uHead = 0;
+	m_uTail = 0;
+	m_uUsed = 0;
+	m_uFrameBytes = 0;
+	m_lFrames.clear();
+}
+
+size_t RingAllocator::Allocate(size_t a_uSize, size_t a_uAlignment)
+{
+	if (a_uSize == 0 || a_uSize > m_uCapacity) return NPOS;
+
+	// Once nothing is taken or in flight, starting over at the front keeps the most room in one piece.
+	if (m_uUsed == 0 && m_lFrames.empty()) m_uHead = m_uTail = 0;
+	else if (m_uUsed > 0 && m_uHead == m_uTail) return NPOS;
+
+	size_t uStart = (m_uHead + a_uAlignment - 1) & ~(a_uAlignment - 1);
+	if (m_uHead >= m_uTail)
+	{
+		// Free space runs from the head to the end, then from the front to the tail.
+		if (uStart + a_uSize > m_uCapacity)
+		{
+			if (a_uSize > m_uTail) return NPOS;
+
+			// The end of the buffer is skipped, and stays taken until this frame retires.
+			uStart = 0;
+		}
+	}
+	else if (uStart + a_uSize > m_uTail)
+	{
+		return NPOS;
+	}
+
+	size_t uTaken = uStart >= m_uHead ? uStart + a_uSize - m_uHead : m_uCapacity - m_uHead + a_uSize;
+	m_uUsed += uTaken;
+	m_uFrameBytes += uTaken;
+	m_uHead = uStart + a_uSize;
+	return uStart;
+}
+
+void RingAllocator::EndFrame(void)
+{
+	m_lFrames.push_back({ m_uHead, m_uFrameBytes });
+	m_uFrameBytes = 0;
+}
+
+bool RingAllocator::RetireFrame(void)
+{
+	if (m_lFrames.empty()) return false;
+
+	m_uTail = m_lFrames.front().End;
+	m_uUsed -= m_lFrames.front().Bytes;
+	m_lFrames.pop_front();
+	return true;
+}
+
+size_t RingAllocator::GetCapacity(void) const { return m_uCapacity; }
+size_t RingAllocator::GetUsed(void) const { return m_uUsed; }
+size_t RingAllocator::GetFramesInFlight(void) const { return m_lFrames.size(); }
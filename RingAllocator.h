@@ -0,0 +1,69 @@
+#ifndef __RINGALLOCATOR_H_
+#define __RINGALLOCATOR_H_
+
+#include <cstddef>
+#include <deque>
+
+/// <summary>
+/// Hands out ranges of a fixed size buffer front to back and wraps around,
+/// tracking which frame each range belongs to.  A frame's ranges are only
+/// reused once it is retired, after the GPU is done reading them.  Free of
+/// the graphics device: it only deals in offsets.
+/// </summary>
+class RingAllocator
+{
+public:
+	// Returned by Allocate() when a range does not fit.
+	static const size_t NPOS = ~size_t(0);
+
+private:
+	/// <summary>
+	/// Where a submitted frame's ranges end, and the bytes they and their padding take.
+	/// </summary>
+	struct FrameMarker
+	{
+		size_t End;
+		size_t Bytes;
+	};
+
+	size_t m_uCapacity;
+	size_t m_uHead;						// Where the next range starts, before alignment.
+	size_t m_uTail;						// Where the oldest frame still in flight starts.
+	size_t m_uUsed;						// Bytes between the tail and the head, including padding.
+	size_t m_uFrameBytes;				// Of m_uUsed, the bytes of the frame being recorded.
+	std::deque<FrameMarker> m_lFrames;	// Submitted and not yet retired, oldest first.
+
+public:
+	RingAllocator(size_t a_uCapacity = 0);
+
+	/// <summary>
+	/// Forgets every range, such as after moving to a larger buffer.
+	/// </summary>
+	/// <param name="a_uCapacity">The size of the buffer now being handed out.</param>
+	void Reset(size_t a_uCapacity);
+
+	/// <summary>
+	/// Takes a range for the frame being recorded.
+	/// </summary>
+	/// <param name="a_uSize">Bytes needed.</param>
+	/// <param name="a_uAlignment">What the offset has to be a multiple of, a power of two.</param>
+	/// <returns>The offset of the range, or NPOS if it does not fit until older frames retire or the buffer grows.</returns>
+	size_t Allocate(size_t a_uSize, size_t a_uAlignment);
+
+	/// <summary>
+	/// Closes the frame being recorded, whose ranges stay taken until it is retired.
+	/// </summary>
+	void EndFrame(void);
+
+	/// <summary>
+	/// Frees the ranges of the oldest submitted frame.
+	/// </summary>
+	/// <returns>False if no frame was in flight.</returns>
+	bool RetireFrame(void);
+
+	size_t GetCapacity(void) const;
+	size_t GetUsed(void) const;
+	size_t GetFramesInFlight(void) const;
+};
+
+#endif //__RINGALLOCATOR_H_
@@ -0,0 +1,66 @@
+#include "SceneConstants.h"
+
+#include <cstring>
+#include "Graphics.h"
+#include "SimpleShader.h"
+
+const char* const SceneConstants::BUFFER_NAME = "SceneConstants";
+const char* const SceneConstants::VIEW_BUFFER_NAME = "ViewConstants";
+
+SceneConstants::SceneConstants() :
+	m_scdData(),
+	m_vcdData(),
+	m_bUploaded(false),
+	m_bViewUploaded(false)
+{
+	D3D11_BUFFER_DESC bufferDesc = {};
+	bufferDesc.ByteWidth = sizeof(SceneConstantData);
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	Graphics::Device->CreateBuffer(&bufferDesc, 0, m_pBuffer.GetAddressOf());
+	bufferDesc.ByteWidth = sizeof(ViewConstantData);
+	Graphics::Device->CreateBuffer(&bufferDesc, 0, m_pViewBuffer.GetAddressOf());
+}
+
+void SceneConstants::SetShadowMap(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_pShadowMap, Microsoft::WRL::ComPtr<ID3D11SamplerState> a_pShadowSampler)
+{
+	m_pShadowMap = a_pShadowMap;
+	m_pShadowSampler = a_pShadowSampler;
+}
+
+void SceneConstants::Upload(ID3D11Buffer* a_pBuffer, const void* a_pData, void* a_pLast, size_t a_uSize, bool& a_bUploaded)
+{
+	// Counted along with the shaders' own buffers.
+	if (a_bUploaded && memcmp(a_pData, a_pLast, a_uSize) == 0)
+	{
+		ISimpleShader::UploadStats.Skipped++;
+		return;
+	}
+	memcpy(a_pLast, a_pData, a_uSize);
+	a_bUploaded = true;
+	Graphics::Context->UpdateSubresource(a_pBuffer, 0, 0, a_pLast, 0, 0);
+	ISimpleShader::UploadStats.Uploads++;
+	ISimpleShader::UploadStats.Bytes += static_cast<unsigned int>(a_uSize);
+}
+
+void SceneConstants::Update(const DirectX::XMFLOAT3& a_v3Ambient, const DirectX::XMFLOAT3& a_v3CameraPosition, const Light* a_pLights, unsigned int a_uLightCount)
+{
+	SceneConstantData scdData = {};
+	scdData.Ambient = a_v3Ambient;
+	if (a_uLightCount > MAX_LIGHT_COUNT) a_uLightCount = MAX_LIGHT_COUNT;
+	if (a_uLightCount > 0) memcpy(scdData.Lights, a_pLights, sizeof(Light) * a_uLightCount);
+	Upload(m_pBuffer.Get(), &scdData, &m_scdData, sizeof(SceneConstantData), m_bUploaded);
+
+	ViewConstantData vcdData = {};
+	vcdData.CameraPosition = a_v3CameraPosition;
+	Upload(m_pViewBuffer.Get(), &vcdData, &m_vcdData, sizeof(ViewConstantData), m_bViewUploaded);
+}
+
+void SceneConstants::Bind(void)
+{
+	// The two buffers sit in neighbouring slots, so one call binds both.
+	ID3D11Buffer* lBuffers[] = { m_pViewBuffer.Get(), m_pBuffer.Get() };
+	Graphics::StateCache.SetPSConstantBuffers(VIEW_BUFFER_SLOT, ARRAYSIZE(lBuffers), lBuffers);
+	Graphics::StateCache.SetPSShaderResource(SHADOW_MAP_SLOT, m_pShadowMap.Get());
+	Graphics::StateCache.SetPSSampler(SHADOW_SAMPLER_SLOT, m_pShadowSampler.Get());
+}
@@ -0,0 +1,91 @@
+#ifndef __SCENECONSTANTS_H_
+#define __SCENECONSTANTS_H_
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <DirectXMath.h>
+#include "Lights.h"
+
+/// <summary>
+/// The lights and ambient the pixel shaders read, which rarely change,
+/// laid out as SceneConstants.hlsli declares it.
+/// </summary>
+struct SceneConstantData
+{
+	DirectX::XMFLOAT3 Ambient;
+	float AmbientPadding;
+	Light Lights[MAX_LIGHT_COUNT];
+};
+
+/// <summary>
+/// What the pixel shaders read about the camera, which moves most frames.
+/// </summary>
+struct ViewConstantData
+{
+	DirectX::XMFLOAT3 CameraPosition;
+	float CameraPadding;
+};
+
+/// <summary>
+/// Fills one constant buffer with the lights and ambient and another with
+/// the camera, and binds them with the shadow map and its sampler for every
+/// pixel shader at once.  Each buffer is only uploaded when its own data
+/// changed, so a moving camera does not send the lights again.  Shaders leave
+/// the buffers alone as long as their names are in
+/// ISimpleShader::SharedConstantBufferNames, so drawing an entity only
+/// writes what belongs to that entity.
+/// </summary>
+class SceneConstants
+{
+public:
+	// The name and registers SceneConstants.hlsli declares.
+	static const char* const BUFFER_NAME;
+	static const UINT BUFFER_SLOT = 2;
+	static const char* const VIEW_BUFFER_NAME;
+	static const UINT VIEW_BUFFER_SLOT = BUFFER_SLOT - 1;		// Bound together with the scene buffer.
+	static const UINT SHADOW_MAP_SLOT = 4;
+	static const UINT SHADOW_SAMPLER_SLOT = 1;
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_pBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_pViewBuffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_pShadowMap;
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> m_pShadowSampler;
+	SceneConstantData m_scdData;
+	ViewConstantData m_vcdData;
+	bool m_bUploaded;
+	bool m_bViewUploaded;
+
+	/// <summary>
+	/// Uploads data to a buffer, unless it matches what was uploaded last.
+	/// </summary>
+	/// <param name="a_pLast">What was uploaded last, replaced by a_pData when uploading.</param>
+	/// <param name="a_bUploaded">Whether anything was uploaded yet, set when uploading.</param>
+	static void Upload(ID3D11Buffer* a_pBuffer, const void* a_pData, void* a_pLast, size_t a_uSize, bool& a_bUploaded);
+
+public:
+	/// <summary>
+	/// Creates the constant buffers.
+	/// </summary>
+	SceneConstants();
+
+	/// <summary>
+	/// Sets the shadow map bound along with the constants.
+	/// </summary>
+	void SetShadowMap(Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> a_pShadowMap, Microsoft::WRL::ComPtr<ID3D11SamplerState> a_pShadowSampler);
+
+	/// <summary>
+	/// Uploads the frame's constants, each buffer unless it matches what was uploaded last.
+	/// </summary>
+	/// <param name="a_pLights">The lights, any past MAX_LIGHT_COUNT are ignored.</param>
+	/// <param name="a_uLightCount">The amount of lights, the rest are left black.</param>
+	void Update(const DirectX::XMFLOAT3& a_v3Ambient, const DirectX::XMFLOAT3& a_v3CameraPosition, const Light* a_pLights, unsigned int a_uLightCount);
+
+	/// <summary>
+	/// Binds both buffers and the shadow map to the pixel shader stage.
+	/// Binding render targets forgets the shadow map, so this goes after.
+	/// </summary>
+	void Bind(void);
+};
+
+#endif //__SCENECONSTANTS_H_
@@ -0,0 +1,29 @@
+#ifndef __SCENECONSTANTS_H_
+#define __SCENECONSTANTS_H_
+
+#include "ShaderFunctions.hlsli"
+
+#define MAX_LIGHT_COUNT 5
+
+// Filled and bound once for every shader by SceneConstants.cpp, which mirrors these layouts.
+// The camera has its own buffer, so moving it re-uploads 16 bytes instead of the lights.
+cbuffer ViewConstants : register(b1)
+{
+    // - -
+    float3 cameraPosition;
+    float cameraPadding;
+}
+
+cbuffer SceneConstants : register(b2)
+{
+    // - -
+    float3 ambient;
+    float ambientPadding;
+    // - -
+    Light lights[MAX_LIGHT_COUNT];
+}
+
+Texture2D ShadowMap : register(t4);
+SamplerComparisonState ShadowSampler : register(s1);
+
+#endif //__SCENECONSTANTS_H_
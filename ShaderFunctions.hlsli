@@ -11,7 +11,16 @@ struct VertexShaderInput
     float3 localPosition : POSITION;
     float3 normal : NORMAL;
     float2 uv : TEXCOORD;
-    float3 tangent : TANGENT;
+    float4 tangent : TANGENT;           // w is the handedness of the uv mapping
+};
+
+// Matches CompressedVertex, the 16 bit formats are expanded by the input assembler.
+struct CompressedVertexShaderInput
+{
+    float4 localPosition : POSITION;    // UNORM16 within the mesh's bounds, w is the handedness as 0 or 1
+    float2 normal : NORMAL;             // SNORM16 octahedral
+    float2 uv : TEXCOORD;               // Half floats
+    float2 tangent : TANGENT;           // SNORM16 octahedral
 };
 
 struct VertexToPixel
@@ -20,7 +29,7 @@ struct VertexToPixel
     float3 normal : NORMAL;
     float2 uv : TEXCOORD;
     float3 worldPos : POSITION;
-    float3 tangent : TANGENT;
+    float4 tangent : TANGENT;
     float4 shadowMapPos : SHADOW_POSITION;
 };
 
@@ -42,4 +51,19 @@ struct Light
     // - -
 };
 
+// Unfolds an octahedral encoded unit vector, see VertexCompression.cpp.
+float3 DecodeOctahedral(float2 encoded)
+{
+    float3 direction = float3(encoded, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-direction.z);
+    direction.xy += (direction.xy >= 0.0f) ? -t : t;
+    return normalize(direction);
+}
+
+// Rebuilds a local space position from its quantized offset within the mesh's bounds.
+float3 DecodePosition(float4 quantized, float3 boundsMin, float3 boundsExtent)
+{
+    return boundsMin + quantized.xyz * boundsExtent;
+}
+
 #endif //__SHADERFUNCTIONS_H_
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "ShaderReflectionCache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	// Longest name a cache can hold, far beyond any HLSL identifier.
+	const size_t g_uMaxNameLength = 0xFFFF;
+
+	/// <summary>
+	/// 32 bit FNV-1a over a block of bytes.
+	/// </summary>
+	uint32_t Checksum(const unsigned char* a_pBytes, size_t a_uSize)
+	{
+		uint32_t uHash = 2166136261u;
+		for (size_t i = 0; i < a_uSize; i++)
+		{
+			uHash ^= a_pBytes[i];
+			uHash *= 16777619u;
+		}
+		return uHash;
+	}
+
+	void WriteUInt(std::vector<unsigned char>& a_lBytes, uint32_t a_uValue)
+	{
+		const unsigned char* pValue = reinterpret_cast<const unsigned char*>(&a_uValue);
+		a_lBytes.insert(a_lBytes.end(), pValue, pValue + sizeof(a_uValue));
+	}
+
+	void WriteString(std::vector<unsigned char>& a_lBytes, const std::string& a_sValue)
+	{
+		uint16_t uLength = static_cast<uint16_t>(a_sValue.size() < g_uMaxNameLength ? a_sValue.size() : g_uMaxNameLength);
+		const unsigned char* pLength = reinterpret_cast<const unsigned char*>(&uLength);
+		a_lBytes.insert(a_lBytes.end(), pLength, pLength + sizeof(uLength));
+		a_lBytes.insert(a_lBytes.end(), a_sValue.begin(), a_sValue.begin() + uLength);
+	}
+
+	void WriteResources(std::vector<unsigned char>& a_lBytes, const std::vector<ShaderReflectionResource>& a_lResources)
+	{
+		for (const ShaderReflectionResource& resource : a_lResources)
+		{
+			WriteString(a_lBytes, resource.Name);
+			WriteUInt(a_lBytes, resource.BindIndex);
+		}
+	}
+
+	/// <summary>
+	/// Walks the bytes after the header, failing instead of reading past the end.
+	/// </summary>
+	struct Reader
+	{
+		const unsigned char* Data;
+		size_t Size;
+		size_t Position;
+
+		bool ReadUInt(uint32_t& a_uValue)
+		{
+			if (Size - Position < sizeof(a_uValue)) return false;
+			memcpy(&a_uValue, Data + Position, sizeof(a_uValue));
+			Position += sizeof(a_uValue);
+			return true;
+		}
+
+		bool ReadString(std::string& a_sValue)
+		{
+			uint16_t uLength = 0;
+			if (Size - Position < sizeof(uLength)) return false;
+			memcpy(&uLength, Data + Position, sizeof(uLength));
+			Position += sizeof(uLength);
+			if (Size - Position < uLength) return false;
+			a_sValue.assign(reinterpret_cast<const char*>(Data + Position), uLength);
+			Position += uLength;
+			return true;
+		}
+
+		bool ReadResources(uint32_t a_uCount, std::vector<ShaderReflectionResource>& a_lResources)
+		{
+			// Every resource takes at least its name's length and bind index.
+			if (a_uCount > (Size - Position) / 6) return false;
+			a_lResources.resize(a_uCount);
+			for (ShaderReflectionResource& resource : a_lResources)
+			{
+				if (!ReadString(resource.Name) || !ReadUInt(resource.BindIndex)) return false;
+			}
+			return true;
+		}
+	};
+}
+
+uint64_t ShaderReflectionCache::Hash(const void* a_pBytecode, size_t a_uSize)
+{
+	const unsigned char* pBytes = static_cast<const unsigned char*>(a_pBytecode);
+	uint64_t uHash = 14695981039346656037ull;
+	for (size_t i = 0; i < a_uSize; i++)
+	{
+		uHash ^= pBytes[i];
+		uHash *= 1099511628211ull;
+	}
+	return uHash;
+}
+
+std::vector<unsigned char> ShaderReflectionCache::Serialize(uint64_t a_uBytecodeHash, uint64_t a_uBytecodeSize, const ShaderReflectionData& a_srdData)
+{
+	std::vector<unsigned char> lBytes(sizeof(ShaderReflectionCacheHeader));
+	for (const ShaderReflectionBuffer& buffer : a_srdData.Buffers)
+	{
+		WriteString(lBytes, buffer.Name);
+		WriteUInt(lBytes, buffer.Type);
+		WriteUInt(lBytes, buffer.BindIndex);
+		WriteUInt(lBytes, buffer.Size);
+		WriteUInt(lBytes, static_cast<uint32_t>(buffer.Variables.size()));
+		for (const ShaderReflectionVariable& variable : buffer.Variables)
+		{
+			WriteString(lBytes, variable.Name);
+			WriteUInt(lBytes, variable.ByteOffset);
+			WriteUInt(lBytes, variable.Size);
+		}
+	}
+	WriteResources(lBytes, a_srdData.Textures);
+	WriteResources(lBytes, a_srdData.Samplers);
+
+	ShaderReflectionCacheHeader header = {};
+	header.Magic = MAGIC;
+	header.Version = VERSION;
+	header.BytecodeHash = a_uBytecodeHash;
+	header.BytecodeSize = a_uBytecodeSize;
+	header.BufferCount = static_cast<uint32_t>(a_srdData.Buffers.size());
+	header.TextureCount = static_cast<uint32_t>(a_srdData.Textures.size());
+	header.SamplerCount = static_cast<uint32_t>(a_srdData.Samplers.size());
+	header.Checksum = Checksum(lBytes.data() + sizeof(header), lBytes.size() - sizeof(header));
+	memcpy(lBytes.data(), &header, sizeof(header));
+	return lBytes;
+}
+
+bool ShaderReflectionCache::Deserialize(const void* a_pData, size_t a_uSize, uint64_t a_uBytecodeHash, uint64_t a_uBytecodeSize, ShaderReflectionData& a_srdData)
+{
+	if (a_pData == nullptr || a_uSize < sizeof(ShaderReflectionCacheHeader)) return false;
+
+	// Checking that the cache was written by this build for this exact bytecode.
+	ShaderReflectionCacheHeader header;
+	memcpy(&header, a_pData, sizeof(header));
+	const unsigned char* pBytes = static_cast<const unsigned char*>(a_pData);
+	if (header.Magic != MAGIC ||
+		header.Version != VERSION ||
+		header.BytecodeHash != a_uBytecodeHash ||
+		header.BytecodeSize != a_uBytecodeSize ||
+		header.Checksum != Checksum(pBytes + sizeof(header), a_uSize - sizeof(header)))
+		return false;
+
+	ShaderReflectionData data;
+	Reader reader = { pBytes, a_uSize, sizeof(header) };
+
+	// Every buffer takes at least its name's length and four counts.
+	if (header.BufferCount > (a_uSize - sizeof(header)) / 18) return false;
+	data.Buffers.resize(header.BufferCount);
+	for (ShaderReflectionBuffer& buffer : data.Buffers)
+	{
+		uint32_t uVariableCount = 0;
+		if (!reader.ReadString(buffer.Name) ||
+			!reader.ReadUInt(buffer.Type) ||
+			!reader.ReadUInt(buffer.BindIndex) ||
+			!reader.ReadUInt(buffer.Size) ||
+			!reader.ReadUInt(uVariableCount) ||
+			uVariableCount > (reader.Size - reader.Position) / 10)
+			return false;
+
+		buffer.Variables.resize(uVariableCount);
+		for (ShaderReflectionVariable& variable : buffer.Variables)
+		{
+			if (!reader.ReadString(variable.Name) ||
+				!reader.ReadUInt(variable.ByteOffset) ||
+				!reader.ReadUInt(variable.Size) ||
+				static_cast<uint64_t>(variable.ByteOffset) + variable.Size > buffer.Size)
+				return false;
+		}
+	}
+	if (!reader.ReadResources(header.TextureCount, data.Textures) ||
+		!reader.ReadResources(header.SamplerCount, data.Samplers) ||
+		reader.Position != a_uSize)
+		return false;
+
+	a_srdData = std::move(data);
+	return true;
+}
+
+bool ShaderReflectionCache::Read(const std::filesystem::path& a_sShaderPath, uint64_t a_uBytecodeHash, uint64_t a_uBytecodeSize, ShaderReflectionData& a_srdData)
+{
+	std::ifstream file(GetCachePath(a_sShaderPath), std::ios::binary);
+	if (!file.is_open()) return false;
+
+	std::vector<unsigned char> lBytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return Deserialize(lBytes.data(), lBytes.size(), a_uBytecodeHash, a_uBytecodeSize, a_srdData);
+}
+
+bool ShaderReflectionCache::Write(const std::filesystem::path& a_sShaderPath, uint64_t a_uBytecodeHash, uint64_t a_uBytecodeSize, const ShaderReflectionData& a_srdData)
+{
+	std::vector<unsigned char> lBytes = Serialize(a_uBytecodeHash, a_uBytecodeSize, a_srdData);
+
+	// Writing to a temporary file first so a half written cache is never picked up.
+	std::filesystem::path sCachePath = GetCachePath(a_sShaderPath);
+	std::filesystem::path sTempPath = sCachePath;
+	sTempPath += ".tmp";
+	{
+		std::ofstream file(sTempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) return false;
+
+		file.write(reinterpret_cast<const char*>(lBytes.data()), lBytes.size());
+		if (!file.good()) return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(sTempPath, sCachePath, error);
+	if (error)
+	{
+		std::filesystem::remove(sTempPath, error);
+		return false;
+	}
+	return true;
+}
+
+std::filesystem::path ShaderReflectionCache::GetCachePath(const std::filesystem::path& a_sShaderPath)
+{
+	std::filesystem::path sCachePath = a_sShaderPath;
+	sCachePath += ".reflcache";
+	return sCachePath;
+}
@@ -0,0 +1,130 @@
+#ifndef __SHADERREFLECTIONCACHE_H_
+#define __SHADERREFLECTIONCACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// A variable inside a reflected constant buffer.
+/// </summary>
+struct ShaderReflectionVariable
+{
+	std::string Name;
+	uint32_t ByteOffset;
+	uint32_t Size;
+};
+
+/// <summary>
+/// A reflected constant buffer and its variables, in declaration order.
+/// </summary>
+struct ShaderReflectionBuffer
+{
+	std::string Name;
+	uint32_t Type;						// A D3D_CBUFFER_TYPE.
+	uint32_t BindIndex;
+	uint32_t Size;
+	std::vector<ShaderReflectionVariable> Variables;
+};
+
+/// <summary>
+/// A reflected texture or sampler.
+/// </summary>
+struct ShaderReflectionResource
+{
+	std::string Name;
+	uint32_t BindIndex;
+};
+
+/// <summary>
+/// Everything SimpleShader needs out of a shader's reflection to build its
+/// tables, without the reflection interface itself.
+/// </summary>
+struct ShaderReflectionData
+{
+	std::vector<ShaderReflectionBuffer> Buffers;
+	std::vector<ShaderReflectionResource> Textures;		// Structured buffers included.
+	std::vector<ShaderReflectionResource> Samplers;
+};
+
+/// <summary>
+/// Fixed size header at the start of every .reflcache file.  The buffers
+/// follow it, each with its variables, then the textures, then the samplers.
+/// Every string is stored as a 16 bit length and its characters.
+/// </summary>
+struct ShaderReflectionCacheHeader
+{
+	uint32_t Magic;						// Always ShaderReflectionCache::MAGIC.
+	uint32_t Version;					// Bumped whenever the layout of the file changes.
+	uint64_t BytecodeHash;				// ShaderReflectionCache::Hash() of the bytecode that was reflected.
+	uint64_t BytecodeSize;
+	uint32_t BufferCount;
+	uint32_t TextureCount;
+	uint32_t SamplerCount;
+	uint32_t Checksum;					// FNV-1a of everything after the header.
+};
+
+/// <summary>
+/// Compact binary copy of a compiled shader's reflection, stored next to the
+/// .cso it came from and checked against a hash of the bytecode rather than
+/// the file's time, so recompiling a shader to the same bytecode keeps it.
+/// Free of the graphics device.
+/// </summary>
+namespace ShaderReflectionCache
+{
+	const uint32_t MAGIC = 0x4C464552;	// "REFL"
+	const uint32_t VERSION = 1;
+
+	/// <summary>
+	/// 64 bit FNV-1a of a shader's bytecode, what caches and shared reflections are keyed by.
+	/// </summary>
+	uint64_t Hash(const void* a_pBytecode, size_t a_uSize);
+
+	/// <summary>
+	/// Turns reflection data into the bytes of a cache file.
+	/// </summary>
+	/// <param name="a_uBytecodeHash">Hash() of the bytecode the data came from.</param>
+	/// <param name="a_uBytecodeSize">Size of that bytecode.</param>
+	/// <param name="a_srdData">The reflection data.</param>
+	/// <returns>The header followed by the data.</returns>
+	std::vector<unsigned char> Serialize(uint64_t a_uBytecodeHash, uint64_t a_uBytecodeSize, const ShaderReflectionData& a_srdData);
+
+	/// <summary>
+	/// Reads reflection data back out of the bytes of a cache file, checking
+	/// every count and length against the size so a damaged file is refused
+	/// rather than read past.
+	/// </summary>
+	/// <param name="a_pData">The bytes.</param>
+	/// <param name="a_uSize">The amount of bytes.</param>
+	/// <param name="a_uBytecodeHash">Hash() of the bytecode the data has to have come from.</param>
+	/// <param name="a_uBytecodeSize">Size of that bytecode.</param>
+	/// <param name="a_srdData">Receives the reflection data.</param>
+	/// <returns>False if the bytes are not a cache of this version for this bytecode.</returns>
+	bool Deserialize(const void* a_pData, size_t a_uSize, uint64_t a_uBytecodeHash, uint64_t a_uBytecodeSize, ShaderReflectionData& a_srdData);
+
+	/// <summary>
+	/// Loads the cache belonging to a compiled shader.
+	/// </summary>
+	/// <param name="a_sShaderPath">Path to the .cso (not the cache itself).</param>
+	/// <returns>False if there is no cache, or it is stale or damaged.</returns>
+	bool Read(const std::filesystem::path& a_sShaderPath, uint64_t a_uBytecodeHash, uint64_t a_uBytecodeSize, ShaderReflectionData& a_srdData);
+
+	/// <summary>
+	/// Writes the cache for a compiled shader.  Failures are silently ignored,
+	/// the shader just gets reflected again next time.
+	/// </summary>
+	/// <param name="a_sShaderPath">Path to the .cso (not the cache itself).</param>
+	/// <returns>True if the cache was written.</returns>
+	bool Write(const std::filesystem::path& a_sShaderPath, uint64_t a_uBytecodeHash, uint64_t a_uBytecodeSize, const ShaderReflectionData& a_srdData);
+
+	/// <summary>
+	/// Gets the path of the cache file belonging to a compiled shader.
+	/// </summary>
+	/// <param name="a_sShaderPath">Path to the .cso.</param>
+	/// <returns>The .cso path with .reflcache appended.</returns>
+	std::filesystem::path GetCachePath(const std::filesystem::path& a_sShaderPath);
+}
+
+#endif //__SHADERREFLECTIONCACHE_H_
@@ -3,6 +3,7 @@
 #include "Window.h"
 #include "Graphics.h"
 #include "PathHelpers.h"
+#include "VertexCompression.h"
 
 #define SHADOW_MAP_RESOLUTION 4096
 
@@ -98,23 +99,34 @@ ShadowManager::ShadowManager(DirectX::XMFLOAT3 a_v3LightDirection)
 	// Storing the calculated matrix values.
 	DirectX::XMStoreFloat4x4(&m_m4LightViewMatrix, lightView);
 	DirectX::XMStoreFloat4x4(&m_m4LightProjectionMatrix, lightProjection);
+	DirectX::XMStoreFloat4x4(&m_m4LightViewProjectionMatrix, DirectX::XMMatrixMultiply(lightView, lightProjection));
+	m_fLightFrustum = FrustumCuller::ExtractFrustum(m_m4LightViewProjectionMatrix);
 
 	// Loading in the vertex shader.
 	m_pVertexShader = std::make_shared<SimpleVertexShader>(
 		Graphics::Device, Graphics::Context, FixPath(L"ShadowVertex.cso").c_str());
+	m_pCompressedVertexShader = std::make_shared<SimpleVertexShader>(
+		Graphics::Device, Graphics::Context, FixPath(L"CompressedShadowVertex.cso").c_str(),
+		VertexCompression::CreateInputLayout(FixPath(L"CompressedShadowVertex.cso").c_str()), false);
+
+	// Finding the per draw variables once.
+	m_hWorldViewProjection = m_pVertexShader->GetVariableHandle("worldViewProjection");
+	m_hCompressedWorldViewProjection = m_pCompressedVertexShader->GetVariableHandle("worldViewProjection");
+	m_hBoundsMin = m_pCompressedVertexShader->GetVariableHandle("boundsMin");
+	m_hBoundsExtent = m_pCompressedVertexShader->GetVariableHandle("boundsExtent");
 }
 
-void ShadowManager::Draw(std::vector<Entity>& a_lActiveEntities)
+void ShadowManager::Draw(std::vector<Entity>& a_lActiveEntities, const unsigned char* a_pLods, const RenderQueue& a_rqQueue, InstanceRenderer* a_pInstances)
 {
 	// Clearing the shadow map.
 	Graphics::Context->ClearDepthStencilView(m_pShadowDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
 	
 	// Setting up the output merger stage.
 	ID3D11RenderTargetView* nullRTV{};
-	Graphics::Context->OMSetRenderTargets(1, &nullRTV, m_pShadowDSV.Get());
+	Graphics::StateCache.SetRenderTargets(1, &nullRTV, m_pShadowDSV.Get());
 
 	// Halting pixel processing completely.
-	Graphics::Context->PSSetShader(0, 0, 0);
+	Graphics::StateCache.SetPixelShader(nullptr);
 
 	// Setting the viewport for the rasterizer.
 	D3D11_VIEWPORT viewport = {};
@@ -124,38 +136,68 @@ void ShadowManager::Draw(std::vector<Entity>& a_lActiveEntities)
 	Graphics::Context->RSSetViewports(1, &viewport);
 	
 	// Setting the shadow rasterizer.
-	Graphics::Context->RSSetState(m_pShadowRasterizer.Get());
-
-	// Setting some of the shader data.
-	m_pVertexShader->SetShader();
-	m_pVertexShader->SetMatrix4x4("view", m_m4LightViewMatrix);
-	m_pVertexShader->SetMatrix4x4("projection", m_m4LightProjectionMatrix);
-
-	// Loop and draw all entities.
-	for (Entity& e : a_lActiveEntities)
+	Graphics::StateCache.SetRasterizerState(m_pShadowRasterizer.Get());
+
+	// Walking the sorted shadow draws, binding a shader only when it changes.
+	size_t uFirst, uLast;
+	a_rqQueue.GetPassRange(RenderPass::Shadow, uFirst, uLast);
+	const uint32_t* pValues = a_rqQueue.GetValues();
+	SimpleVertexShader* pBoundShader = nullptr;
+	for (size_t q = uFirst; q < uLast; q++)
 	{
-		// Setting the world matrix and copying the buffer data over.
-		m_pVertexShader->SetMatrix4x4("world", e.GetTransform().GetWorldMatrix());
-		m_pVertexShader->CopyAllBufferData();
+		if (pValues[q] & INSTANCE_BATCH_FLAG)
+		{
+			a_pInstances->DrawShadowBatch(a_lActiveEntities, a_pLods, pValues[q] & ~INSTANCE_BATCH_FLAG);
+			pBoundShader = a_pInstances->GetShadowVertexShader().get();
+			continue;
+		}
+		Entity& e = a_lActiveEntities[pValues[q]];
+
+		// Compressed meshes need their own input layout and the bounds to decode positions.
+		std::shared_ptr<Mesh> pMesh = e.GetMesh();
+		std::shared_ptr<SimpleVertexShader> vs = GetVertexShader(pMesh);
+		if (vs.get() != pBoundShader)
+		{
+			vs->SetShader();
+			pBoundShader = vs.get();
+		}
+		if (pMesh->IsCompressed())
+		{
+			DirectX::XMFLOAT3 v3Min = pMesh->GetBoundsMin();
+			DirectX::XMFLOAT3 v3Max = pMesh->GetBoundsMax();
+			vs->SetFloat3(m_hBoundsMin, v3Min);
+			vs->SetFloat3(m_hBoundsExtent, DirectX::XMFLOAT3(v3Max.x - v3Min.x, v3Max.y - v3Min.y, v3Max.z - v3Min.z));
+		}
+
+		// Setting the precomputed world * light view projection and copying the buffer data over.
+		vs->SetMatrix4x4(pMesh->IsCompressed() ? m_hCompressedWorldViewProjection : m_hWorldViewProjection, e.GetTransform().GetWorldLightViewProjectionMatrix());
+		vs->CopyAllBufferData();
 
 		// Draw the mesh directly to avoid the entity's material.
-		e.GetMesh()->Draw();
+		pMesh->Draw(a_pLods[pValues[q]]);
 	}
 
 	// Unbinding the shadow rasterizer.
-	Graphics::Context->RSSetState(0);
+	Graphics::StateCache.SetRasterizerState(nullptr);
 
 	// Reseting the pipeline for actual rendering.
 	viewport.Width = (float)Window::Width();
 	viewport.Height = (float)Window::Height();
 	Graphics::Context->RSSetViewports(1, &viewport);
-	Graphics::Context->OMSetRenderTargets(
+	Graphics::StateCache.SetRenderTargets(
 		1,
 		Graphics::BackBufferRTV.GetAddressOf(),
 		Graphics::DepthBufferDSV.Get());
 }
 
+std::shared_ptr<SimpleVertexShader> ShadowManager::GetVertexShader(std::shared_ptr<Mesh> a_pMesh)
+{
+	return a_pMesh->IsCompressed() ? m_pCompressedVertexShader : m_pVertexShader;
+}
+
 Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> ShadowManager::GetShadowSRV() { return m_pShadowSRV; }
 Microsoft::WRL::ComPtr<ID3D11SamplerState> ShadowManager::GetShadowSampler(void) { return m_pShadowSampler; }
 DirectX::XMFLOAT4X4 ShadowManager::GetLightProjection(void) { return m_m4LightProjectionMatrix; }
 DirectX::XMFLOAT4X4 ShadowManager::GetLightView(void) { return m_m4LightViewMatrix; }
+DirectX::XMFLOAT4X4 ShadowManager::GetLightViewProjection(void) { return m_m4LightViewProjectionMatrix; }
+Frustum ShadowManager::GetLightFrustum(void) { return m_fLightFrustum; }
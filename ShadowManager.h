@@ -9,6 +9,9 @@
 
 #include "Entity.h"
 #include "SimpleShader.h"
+#include "FrustumCuller.h"
+#include "InstanceRenderer.h"
+#include "RenderQueue.h"
 
 /// <summary>
 /// Manages the shadow map and light matrices for a single light in the scene.
@@ -17,12 +20,19 @@ class ShadowManager
 {
 private:
 	std::shared_ptr<SimpleVertexShader> m_pVertexShader;
+	std::shared_ptr<SimpleVertexShader> m_pCompressedVertexShader;
+	SimpleVariableHandle m_hWorldViewProjection;
+	SimpleVariableHandle m_hCompressedWorldViewProjection;
+	SimpleVariableHandle m_hBoundsMin;
+	SimpleVariableHandle m_hBoundsExtent;
 	Microsoft::WRL::ComPtr<ID3D11DepthStencilView> m_pShadowDSV;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_pShadowSRV;
 	Microsoft::WRL::ComPtr<ID3D11RasterizerState> m_pShadowRasterizer;
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> m_pShadowSampler;
 	DirectX::XMFLOAT4X4 m_m4LightViewMatrix;
 	DirectX::XMFLOAT4X4 m_m4LightProjectionMatrix;
+	DirectX::XMFLOAT4X4 m_m4LightViewProjectionMatrix;
+	Frustum m_fLightFrustum;
 
 public:
 	/// <summary>
@@ -32,9 +42,18 @@ public:
 	ShadowManager(DirectX::XMFLOAT3 a_v3LightDirection);
 
 	/// <summary>
-	/// Creates the shadow map with the active entities in the scene.
+	/// Creates the shadow map from the shadow pass of a sorted render queue.
 	/// </summary>
-	void Draw(std::vector<Entity>& a_lActiveEntities);
+	/// <param name="a_lActiveEntities">The entities the queue's values index.</param>
+	/// <param name="a_pLods">One level of detail per entity.</param>
+	/// <param name="a_rqQueue">Sorted, its shadow pass values are entity indices, or batch indices flagged with INSTANCE_BATCH_FLAG.</param>
+	/// <param name="a_pInstances">Draws the flagged batches.</param>
+	void Draw(std::vector<Entity>& a_lActiveEntities, const unsigned char* a_pLods, const RenderQueue& a_rqQueue, InstanceRenderer* a_pInstances);
+
+	/// <summary>
+	/// Gets the vertex shader a mesh is drawn into the shadow map with when not batched.
+	/// </summary>
+	std::shared_ptr<SimpleVertexShader> GetVertexShader(std::shared_ptr<Mesh> a_pMesh);
 
 	/// <summary>
 	/// Gets the currently generated shadow map.
@@ -55,6 +74,16 @@ public:
 	/// Gets the light's projection matrix.
 	/// </summary>
 	DirectX::XMFLOAT4X4 GetLightProjection(void);
+
+	/// <summary>
+	/// Gets the light's view matrix times its projection matrix.
+	/// </summary>
+	DirectX::XMFLOAT4X4 GetLightViewProjection(void);
+
+	/// <summary>
+	/// Gets the planes of the light's orthographic volume, for culling shadow casters.
+	/// </summary>
+	Frustum GetLightFrustum(void);
 };
 
 #endif //__SHADOWMANAGER_H_
@@ -2,14 +2,11 @@
 
 cbuffer externalData : register(b0)
 {
-    matrix world;
-    matrix view;
-    matrix projection;
+    matrix worldViewProjection;	// Through the light's view and projection.
 };
 
 // Simplified vertex shader for rendering shadows.
 float4 main(VertexShaderInput input) : SV_POSITION
 {
-    matrix wvp = mul(projection, mul(view, world));
-    return mul(wvp, float4(input.localPosition, 1.0f));
+    return mul(worldViewProjection, float4(input.localPosition, 1.0f));
 }
\ No newline at end of file
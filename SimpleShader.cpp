@@ -1,9 +1,66 @@
 #include "SimpleShader.h"
+#include "PipelineStateCache.h"
+#include "UploadRing.h"
+#include "ShaderReflectionCache.h"
+
+#include <algorithm>
 
 // Default error reporting state
 bool ISimpleShader::ReportErrors = false;
 bool ISimpleShader::ReportWarnings = false;
 
+// No state cache unless one is given
+PipelineStateCache* ISimpleShader::StateCache = nullptr;
+UploadRing* ISimpleShader::ConstantRing = nullptr;
+
+// Nothing uploaded yet
+SimpleUploadStats ISimpleShader::UploadStats;
+
+// Nothing loaded yet
+SimpleReflectionStats ISimpleShader::ReflectionStats;
+
+// Every shader owns all of its buffers unless some are named
+std::vector<std::string> ISimpleShader::SharedConstantBufferNames;
+
+// --------------------------------------------------------
+// Reflections of the shaders currently loaded, by bytecode
+// hash, so loading the same bytecode again shares them
+// --------------------------------------------------------
+static std::unordered_map<uint64_t, std::weak_ptr<SimpleShaderReflection>>& ReflectionRegistry()
+{
+	static std::unordered_map<uint64_t, std::weak_ptr<SimpleShaderReflection>> registry;
+	return registry;
+}
+
+// --------------------------------------------------------
+// Stands in for the reflection of a shader that isn't
+// loaded, so lookups simply find nothing
+// --------------------------------------------------------
+static std::shared_ptr<SimpleShaderReflection> EmptyReflection()
+{
+	static std::shared_ptr<SimpleShaderReflection> empty = std::make_shared<SimpleShaderReflection>();
+	return empty;
+}
+
+// --------------------------------------------------------
+// Frees the constant buffers and resource wrappers once
+// the last shader using them is gone
+// --------------------------------------------------------
+SimpleShaderReflection::~SimpleShaderReflection()
+{
+	for (unsigned int i = 0; i < ConstantBufferCount; i++)
+	{
+		delete[] ConstantBuffers[i].LocalDataBuffer;
+	}
+	delete[] ConstantBuffers;
+
+	for (unsigned int i = 0; i < ShaderResourceViews.size(); i++)
+		delete ShaderResourceViews[i];
+
+	for (unsigned int i = 0; i < SamplerStates.size(); i++)
+		delete SamplerStates[i];
+}
+
 // To enable error reporting, use either or both 
 // of the following lines somewhere in your program, 
 // preferably before loading/using any shaders.
@@ -26,6 +83,7 @@ ISimpleShader::ISimpleShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Micros
 	this->deviceContext = context;
 
 	// Set up fields
+	this->reflection = EmptyReflection();
 	this->constantBufferCount = 0;
 	this->constantBuffers = 0;
 	this->shaderValid = false;
@@ -40,34 +98,15 @@ ISimpleShader::~ISimpleShader()
 }
 
 // --------------------------------------------------------
-// Cleans up the variable table and buffers - Some things will
+// Lets go of the variable table and buffers - Some things will
 // be handled by derived classes
 // --------------------------------------------------------
 void ISimpleShader::CleanUp()
 {
-	// Handle constant buffers and local data buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		delete[] constantBuffers[i].LocalDataBuffer;
-	}
-
-	if (constantBuffers)
-	{
-		delete[] constantBuffers;
-		constantBufferCount = 0;
-	}
-
-	for (unsigned int i = 0; i < shaderResourceViews.size(); i++)
-		delete shaderResourceViews[i];
-	
-	for (unsigned int i = 0; i < samplerStates.size(); i++)
-		delete samplerStates[i];
-
-	// Clean up tables
-	varTable.clear();
-	cbTable.clear();
-	samplerTable.clear();
-	textureTable.clear();
+	// The tables and buffers go with the last shader sharing them
+	reflection = EmptyReflection();
+	constantBuffers = 0;
+	constantBufferCount = 0;
 }
 
 // --------------------------------------------------------
@@ -109,8 +148,55 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 		return false;
 	}
 
-	// Set up shader reflection to get information about
-	// this shader and its variables,  buffers, etc.
+	// Another shader loaded from the same bytecode has all the
+	// tables and constant buffers this one would build
+	uint64_t hash = ShaderReflectionCache::Hash(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize());
+	auto& registry = ReflectionRegistry();
+	auto shared = registry.find(hash);
+	if (shared != registry.end())
+	{
+		std::shared_ptr<SimpleShaderReflection> existing = shared->second.lock();
+		if (existing && existing->BytecodeSize == shaderBlob->GetBufferSize())
+		{
+			reflection = existing;
+			constantBuffers = reflection->ConstantBuffers;
+			constantBufferCount = reflection->ConstantBufferCount;
+			ReflectionStats.Shared++;
+			return true;
+		}
+	}
+
+	// Otherwise the reflection cached next to the file skips
+	// reflecting, as long as it came from this same bytecode
+	ShaderReflectionData data;
+	if (ShaderReflectionCache::Read(shaderFile, hash, shaderBlob->GetBufferSize(), data))
+	{
+		ReflectionStats.Cached++;
+	}
+	else
+	{
+		ReflectShader(data);
+		ShaderReflectionCache::Write(shaderFile, hash, shaderBlob->GetBufferSize(), data);
+		ReflectionStats.Reflected++;
+	}
+
+	BuildReflection(data);
+	reflection->BytecodeHash = hash;
+	reflection->BytecodeSize = shaderBlob->GetBufferSize();
+	registry[hash] = reflection;
+
+	// All set
+	return true;
+}
+
+// --------------------------------------------------------
+// Uses shader reflection to get information about this
+// shader's buffers, variables and resources
+//
+// data - Receives what reflection found
+// --------------------------------------------------------
+void ISimpleShader::ReflectShader(ShaderReflectionData& data)
+{
 	Microsoft::WRL::ComPtr<ID3D11ShaderReflection> refl;
 	D3DReflect(
 		shaderBlob->GetBufferPointer(),
@@ -122,10 +208,6 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 	D3D11_SHADER_DESC shaderDesc;
 	refl->GetDesc(&shaderDesc);
 
-	// Create resource arrays
-	constantBufferCount = shaderDesc.ConstantBuffers;
-	constantBuffers = new SimpleConstantBuffer[constantBufferCount];
-	
 	// Handle bound resources (like shaders and samplers)
 	unsigned int resourceCount = shaderDesc.BoundResources;
 	for (unsigned int r = 0; r < resourceCount; r++)
@@ -139,33 +221,18 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 		{
 		case D3D_SIT_STRUCTURED: // Treat structured buffers as texture resources
 		case D3D_SIT_TEXTURE: // A texture resource
-		{
-			// Create the SRV wrapper
-			SimpleSRV* srv = new SimpleSRV();
-			srv->BindIndex = resourceDesc.BindPoint;				// Shader bind point
-			srv->Index = (unsigned int)shaderResourceViews.size();	// Raw index
-
-			textureTable.insert(std::pair<std::string, SimpleSRV*>(resourceDesc.Name, srv));
-			shaderResourceViews.push_back(srv);
-		}
+			data.Textures.push_back({ resourceDesc.Name, resourceDesc.BindPoint });
 			break;
 
 		case D3D_SIT_SAMPLER: // A sampler resource
-		{
-			// Create the sampler wrapper
-			SimpleSampler* samp = new SimpleSampler();
-			samp->BindIndex = resourceDesc.BindPoint;			// Shader bind point
-			samp->Index = (unsigned int)samplerStates.size();	// Raw index
-
-			samplerTable.insert(std::pair<std::string, SimpleSampler*>(resourceDesc.Name, samp));
-			samplerStates.push_back(samp);
-		}
+			data.Samplers.push_back({ resourceDesc.Name, resourceDesc.BindPoint });
 			break;
 		}
 	}
 
 	// Loop through all constant buffers
-	for (unsigned int b = 0; b < constantBufferCount; b++)
+	data.Buffers.resize(shaderDesc.ConstantBuffers);
+	for (unsigned int b = 0; b < shaderDesc.ConstantBuffers; b++)
 	{
 		// Get this buffer
 		ID3D11ShaderReflectionConstantBuffer* cb =
@@ -175,62 +242,123 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 		D3D11_SHADER_BUFFER_DESC bufferDesc;
 		cb->GetDesc(&bufferDesc);
 
-		// Save the type, which we reference when setting these buffers
-		constantBuffers[b].Type = bufferDesc.Type;
-		
 		// Get the description of the resource binding, so
 		// we know exactly how it's bound in the shader
 		D3D11_SHADER_INPUT_BIND_DESC bindDesc;
 		refl->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc);
+
+		ShaderReflectionBuffer& buffer = data.Buffers[b];
+		buffer.Name = bufferDesc.Name;
+		buffer.Type = bufferDesc.Type;
+		buffer.BindIndex = bindDesc.BindPoint;
+		buffer.Size = bufferDesc.Size;
+
+		// Loop through all variables in this buffer
+		for (unsigned int v = 0; v < bufferDesc.Variables; v++)
+		{
+			// Get this variable
+			ID3D11ShaderReflectionVariable* var =
+				cb->GetVariableByIndex(v);
+			
+			// Get the description of the variable and its type
+			D3D11_SHADER_VARIABLE_DESC varDesc;
+			var->GetDesc(&varDesc);
+
+			buffer.Variables.push_back({ varDesc.Name, varDesc.StartOffset, varDesc.Size });
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Builds the variable table, resource tables and constant
+// buffers from reflection data, whether it was just
+// reflected or came from the cache
+//
+// data - What reflection found
+// --------------------------------------------------------
+void ISimpleShader::BuildReflection(const ShaderReflectionData& data)
+{
+	reflection = std::make_shared<SimpleShaderReflection>();
+
+	// Create resource arrays
+	constantBufferCount = (unsigned int)data.Buffers.size();
+	constantBuffers = new SimpleConstantBuffer[constantBufferCount];
+	reflection->ConstantBufferCount = constantBufferCount;
+	reflection->ConstantBuffers = constantBuffers;
+
+	// Handle bound resources (like shaders and samplers)
+	for (const ShaderReflectionResource& texture : data.Textures)
+	{
+		// Create the SRV wrapper
+		SimpleSRV* srv = new SimpleSRV();
+		srv->BindIndex = texture.BindIndex;									// Shader bind point
+		srv->Index = (unsigned int)reflection->ShaderResourceViews.size();	// Raw index
+
+		reflection->TextureTable.insert(std::pair<std::string, SimpleSRV*>(texture.Name, srv));
+		reflection->ShaderResourceViews.push_back(srv);
+	}
+
+	for (const ShaderReflectionResource& sampler : data.Samplers)
+	{
+		// Create the sampler wrapper
+		SimpleSampler* samp = new SimpleSampler();
+		samp->BindIndex = sampler.BindIndex;							// Shader bind point
+		samp->Index = (unsigned int)reflection->SamplerStates.size();	// Raw index
+
+		reflection->SamplerTable.insert(std::pair<std::string, SimpleSampler*>(sampler.Name, samp));
+		reflection->SamplerStates.push_back(samp);
+	}
+
+	// Loop through all constant buffers
+	for (unsigned int b = 0; b < constantBufferCount; b++)
+	{
+		const ShaderReflectionBuffer& buffer = data.Buffers[b];
+
+		// Save the type, which we reference when setting these buffers
+		constantBuffers[b].Type = (D3D_CBUFFER_TYPE)buffer.Type;
 		
 		// Set up the buffer and put its pointer in the table
-		constantBuffers[b].BindIndex = bindDesc.BindPoint;
-		constantBuffers[b].Name = bufferDesc.Name;
-		cbTable.insert(std::pair<std::string, SimpleConstantBuffer*>(bufferDesc.Name, &constantBuffers[b]));
+		constantBuffers[b].BindIndex = buffer.BindIndex;
+		constantBuffers[b].Name = buffer.Name;
+		constantBuffers[b].Shared = std::find(SharedConstantBufferNames.begin(), SharedConstantBufferNames.end(), buffer.Name) != SharedConstantBufferNames.end();
+		reflection->CBTable.insert(std::pair<std::string, SimpleConstantBuffer*>(buffer.Name, &constantBuffers[b]));
 
-		// Create this constant buffer
+		// Create this constant buffer, unless the caller provides it
 		D3D11_BUFFER_DESC newBuffDesc = {};
 		newBuffDesc.Usage = D3D11_USAGE_DEFAULT;
-		newBuffDesc.ByteWidth = ((bufferDesc.Size + 15) / 16) * 16; // Quick and dirty 16-byte alignment using integer division
+		newBuffDesc.ByteWidth = ((buffer.Size + 15) / 16) * 16; // Quick and dirty 16-byte alignment using integer division
 		newBuffDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
 		newBuffDesc.CPUAccessFlags = 0;
 		newBuffDesc.MiscFlags = 0;
 		newBuffDesc.StructureByteStride = 0;
-		device->CreateBuffer(&newBuffDesc, 0, constantBuffers[b].ConstantBuffer.GetAddressOf());
+		if (!constantBuffers[b].Shared)
+			device->CreateBuffer(&newBuffDesc, 0, constantBuffers[b].ConstantBuffer.GetAddressOf());
 
 		// Set up the data buffer for this constant buffer
-		constantBuffers[b].Size = bufferDesc.Size;
-		constantBuffers[b].LocalDataBuffer = new unsigned char[bufferDesc.Size];
-		ZeroMemory(constantBuffers[b].LocalDataBuffer, bufferDesc.Size);
+		constantBuffers[b].Size = buffer.Size;
+		constantBuffers[b].LocalDataBuffer = new unsigned char[buffer.Size];
+		ZeroMemory(constantBuffers[b].LocalDataBuffer, buffer.Size);
+
+		// The GPU copy starts out undefined, so the first upload has to happen
+		constantBuffers[b].DirtyStart = 0;
+		constantBuffers[b].DirtyEnd = buffer.Size;
 
 		// Loop through all variables in this buffer
-		for (unsigned int v = 0; v < bufferDesc.Variables; v++)
+		for (const ShaderReflectionVariable& variable : buffer.Variables)
 		{
-			// Get this variable
-			ID3D11ShaderReflectionVariable* var =
-				cb->GetVariableByIndex(v);
-			
-			// Get the description of the variable and its type
-			D3D11_SHADER_VARIABLE_DESC varDesc;
-			var->GetDesc(&varDesc);
-
 			// Create the variable struct
 			SimpleShaderVariable varStruct = {};
+			varStruct.Index = (unsigned int)reflection->Variables.size();	// Raw index
 			varStruct.ConstantBufferIndex = b;
-			varStruct.ByteOffset = varDesc.StartOffset;
-			varStruct.Size = varDesc.Size;
-			
-			// Get a string version
-			std::string varName(varDesc.Name);
+			varStruct.ByteOffset = variable.ByteOffset;
+			varStruct.Size = variable.Size;
 
 			// Add this variable to the table and the constant buffer
-			varTable.insert(std::pair<std::string, SimpleShaderVariable>(varName, varStruct));
+			if (reflection->VarTable.insert(std::pair<std::string, SimpleShaderVariable>(variable.Name, varStruct)).second)
+				reflection->Variables.push_back(varStruct);
 			constantBuffers[b].Variables.push_back(varStruct);
 		}
 	}
-
-	// All set
-	return true;
 }
 
 // --------------------------------------------------------
@@ -240,14 +368,14 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 // name - the name of the variable to look for
 // size - the size of the variable (for verification), or -1 to bypass
 // --------------------------------------------------------
-SimpleShaderVariable* ISimpleShader::FindVariable(std::string name, int size)
+SimpleShaderVariable* ISimpleShader::FindVariable(std::string_view name, int size)
 {
 	// Look for the key
-	std::unordered_map<std::string, SimpleShaderVariable>::iterator result =
-		varTable.find(name);
+	auto result =
+		reflection->VarTable.find(name);
 
 	// Did we find the key?
-	if (result == varTable.end())
+	if (result == reflection->VarTable.end())
 		return 0;
 
 	// Grab the result from the iterator
@@ -264,14 +392,14 @@ SimpleShaderVariable* ISimpleShader::FindVariable(std::string name, int size)
 // --------------------------------------------------------
 // Helper for looking up a constant buffer by name
 // --------------------------------------------------------
-SimpleConstantBuffer* ISimpleShader::FindConstantBuffer(std::string name)
+SimpleConstantBuffer* ISimpleShader::FindConstantBuffer(std::string_view name)
 {
 	// Look for the key
-	std::unordered_map<std::string, SimpleConstantBuffer*>::iterator result =
-		cbTable.find(name);
+	auto result =
+		reflection->CBTable.find(name);
 
 	// Did we find the key?
-	if (result == cbTable.end())
+	if (result == reflection->CBTable.end())
 		return 0;
 
 	// Success
@@ -345,13 +473,10 @@ void ISimpleShader::CopyAllBufferData()
 	// Ensure the shader is valid
 	if (!shaderValid) return;
 
-	// Loop through the constant buffers and copy all data
+	// Loop through the constant buffers and copy the ones that changed
 	for (unsigned int i = 0; i < constantBufferCount; i++)
 	{
-		// Copy the entire local data buffer
-		deviceContext->UpdateSubresource(
-			constantBuffers[i].ConstantBuffer.Get(), 0, 0,
-			constantBuffers[i].LocalDataBuffer, 0, 0);
+		UploadBuffer(&constantBuffers[i]);
 	}
 }
 
@@ -380,9 +505,7 @@ void ISimpleShader::CopyBufferData(unsigned int index)
 	if (!cb) return;
 
 	// Copy the data and get out
-	deviceContext->UpdateSubresource(
-		cb->ConstantBuffer.Get(), 0, 0, 
-		cb->LocalDataBuffer, 0, 0);
+	UploadBuffer(cb);
 }
 
 // --------------------------------------------------------
@@ -392,7 +515,7 @@ void ISimpleShader::CopyBufferData(unsigned int index)
 //              Useful for updating more frequently-changing
 //              variables without having to re-copy all buffers.
 // --------------------------------------------------------
-void ISimpleShader::CopyBufferData(std::string bufferName)
+void ISimpleShader::CopyBufferData(std::string_view bufferName)
 {
 	// Ensure the shader is valid
 	if (!shaderValid) return;
@@ -402,9 +525,78 @@ void ISimpleShader::CopyBufferData(std::string bufferName)
 	if (!cb) return;
 
 	// Copy the data and get out
-	deviceContext->UpdateSubresource(
-		cb->ConstantBuffer.Get(), 0, 0, 
-		cb->LocalDataBuffer, 0, 0);
+	UploadBuffer(cb);
+}
+
+// --------------------------------------------------------
+// Copies a buffer's local data to the GPU if any of it
+// changed since the last copy, and counts it either way
+// --------------------------------------------------------
+void ISimpleShader::UploadBuffer(SimpleConstantBuffer* cb)
+{
+	// Shared buffers are the caller's to upload
+	if (cb->Shared)
+		return;
+
+	// Ring data lives at a new offset each upload, which has to be bound
+	if (cb->Type == D3D11_CT_CBUFFER && UsesConstantRing())
+	{
+		if (UploadToRing(cb))
+			BindConstantBuffer(cb);
+		else
+			UploadStats.Skipped++;
+		return;
+	}
+
+	unsigned int bytes = cb->Upload(deviceContext.Get());
+	if (bytes > 0)
+	{
+		UploadStats.Uploads++;
+		UploadStats.Bytes += bytes;
+	}
+	else
+	{
+		UploadStats.Skipped++;
+	}
+}
+
+// --------------------------------------------------------
+// Writes a constant buffer's local data to the shared
+// upload ring, if it changed or the ring has moved on
+// since it was last written
+//
+// cb - The buffer to write
+//
+// Returns true if the buffer was written and needs binding
+// --------------------------------------------------------
+bool ISimpleShader::UploadToRing(SimpleConstantBuffer* cb)
+{
+	if (!cb->IsDirty() && cb->RingEpoch == ConstantRing->GetEpoch())
+		return false;
+
+	// Offsets are bound in constants, so they have to line up
+	// with the 16 constant granularity as well
+	UploadAllocation allocation;
+	void* dest = ConstantRing->Map(cb->RingSize(), 256, allocation);
+	if (dest)
+	{
+		memcpy(dest, cb->LocalDataBuffer, cb->Size);
+		ConstantRing->Unmap();
+		cb->RingBuffer = allocation.Buffer;
+		cb->RingOffset = allocation.Offset;
+		cb->RingEpoch = ConstantRing->GetEpoch(); // Mapping may have grown the ring
+	}
+	else
+	{
+		// Fall back on the buffer's own copy
+		deviceContext->UpdateSubresource(cb->ConstantBuffer.Get(), 0, 0, cb->LocalDataBuffer, 0, 0);
+		cb->RingEpoch = 0;
+	}
+
+	cb->DirtyStart = cb->DirtyEnd = 0;
+	UploadStats.Uploads++;
+	UploadStats.Bytes += cb->Size;
+	return true;
 }
 
 
@@ -417,7 +609,7 @@ void ISimpleShader::CopyBufferData(std::string bufferName)
 //
 // Returns true if data is copied, false if variable doesn't exist
 // --------------------------------------------------------
-bool ISimpleShader::SetData(std::string name, const void* data, unsigned int size)
+bool ISimpleShader::SetData(std::string_view name, const void* data, unsigned int size)
 {
 	// Look for the variable and verify
 	SimpleShaderVariable* var = FindVariable(name, -1);
@@ -426,7 +618,7 @@ bool ISimpleShader::SetData(std::string name, const void* data, unsigned int siz
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleShader::SetData() - Shader variable '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' not found. Ensure the name is spelled correctly and that it exists in a constant buffer in the shader.\n");
 		}
 		return false;
@@ -439,17 +631,14 @@ bool ISimpleShader::SetData(std::string name, const void* data, unsigned int siz
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleShader::SetData() - Shader variable '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' is smaller than the size of the data being set. Ensure the variable is large enough for the specified data.\n");
 		}
 		return false;
 	}
 
 	// Set the data in the local data buffer
-	memcpy(
-		constantBuffers[var->ConstantBufferIndex].LocalDataBuffer + var->ByteOffset,
-		data,
-		size);
+	constantBuffers[var->ConstantBufferIndex].Write(var->ByteOffset, data, size);
 
 	// Success
 	return true;
@@ -458,7 +647,7 @@ bool ISimpleShader::SetData(std::string name, const void* data, unsigned int siz
 // --------------------------------------------------------
 // Sets INTEGER data
 // --------------------------------------------------------
-bool ISimpleShader::SetInt(std::string name, int data)
+bool ISimpleShader::SetInt(std::string_view name, int data)
 {
 	return this->SetData(name, (void*)(&data), sizeof(int));
 }
@@ -466,7 +655,7 @@ bool ISimpleShader::SetInt(std::string name, int data)
 // --------------------------------------------------------
 // Sets a FLOAT variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat(std::string name, float data)
+bool ISimpleShader::SetFloat(std::string_view name, float data)
 {
 	return this->SetData(name, (void*)(&data), sizeof(float));
 }
@@ -474,7 +663,7 @@ bool ISimpleShader::SetFloat(std::string name, float data)
 // --------------------------------------------------------
 // Sets a FLOAT2 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat2(std::string name, const float data[2])
+bool ISimpleShader::SetFloat2(std::string_view name, const float data[2])
 {
 	return this->SetData(name, (void*)data, sizeof(float) * 2);
 }
@@ -482,7 +671,7 @@ bool ISimpleShader::SetFloat2(std::string name, const float data[2])
 // --------------------------------------------------------
 // Sets a FLOAT2 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat2(std::string name, const DirectX::XMFLOAT2 data)
+bool ISimpleShader::SetFloat2(std::string_view name, const DirectX::XMFLOAT2 data)
 {
 	return this->SetData(name, &data, sizeof(float) * 2);
 }
@@ -490,7 +679,7 @@ bool ISimpleShader::SetFloat2(std::string name, const DirectX::XMFLOAT2 data)
 // --------------------------------------------------------
 // Sets a FLOAT3 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat3(std::string name, const float data[3])
+bool ISimpleShader::SetFloat3(std::string_view name, const float data[3])
 {
 	return this->SetData(name, (void*)data, sizeof(float) * 3);
 }
@@ -498,7 +687,7 @@ bool ISimpleShader::SetFloat3(std::string name, const float data[3])
 // --------------------------------------------------------
 // Sets a FLOAT3 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat3(std::string name, const DirectX::XMFLOAT3 data)
+bool ISimpleShader::SetFloat3(std::string_view name, const DirectX::XMFLOAT3 data)
 {
 	return this->SetData(name, &data, sizeof(float) * 3);
 }
@@ -506,7 +695,7 @@ bool ISimpleShader::SetFloat3(std::string name, const DirectX::XMFLOAT3 data)
 // --------------------------------------------------------
 // Sets a FLOAT4 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat4(std::string name, const float data[4])
+bool ISimpleShader::SetFloat4(std::string_view name, const float data[4])
 {
 	return this->SetData(name, (void*)data, sizeof(float) * 4);
 }
@@ -514,7 +703,7 @@ bool ISimpleShader::SetFloat4(std::string name, const float data[4])
 // --------------------------------------------------------
 // Sets a FLOAT4 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat4(std::string name, const DirectX::XMFLOAT4 data)
+bool ISimpleShader::SetFloat4(std::string_view name, const DirectX::XMFLOAT4 data)
 {
 	return this->SetData(name, &data, sizeof(float) * 4);
 }
@@ -522,7 +711,7 @@ bool ISimpleShader::SetFloat4(std::string name, const DirectX::XMFLOAT4 data)
 // --------------------------------------------------------
 // Sets a MATRIX (4x4) variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetMatrix4x4(std::string name, const float data[16])
+bool ISimpleShader::SetMatrix4x4(std::string_view name, const float data[16])
 {
 	return this->SetData(name, (void*)data, sizeof(float) * 16);
 }
@@ -530,16 +719,152 @@ bool ISimpleShader::SetMatrix4x4(std::string name, const float data[16])
 // --------------------------------------------------------
 // Sets a MATRIX (4x4) variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetMatrix4x4(std::string name, const DirectX::XMFLOAT4X4 data)
+bool ISimpleShader::SetMatrix4x4(std::string_view name, const DirectX::XMFLOAT4X4 data)
 {
 	return this->SetData(name, &data, sizeof(float) * 16);
 }
 
+// --------------------------------------------------------
+// Finds a variable once, for setting it by handle later.
+// The handle is invalid if the variable doesn't exist.
+// --------------------------------------------------------
+SimpleVariableHandle ISimpleShader::GetVariableHandle(std::string_view name)
+{
+	SimpleVariableHandle handle;
+	SimpleShaderVariable* var = FindVariable(name, -1);
+	if (var) handle.Index = (int)var->Index;
+	return handle;
+}
+
+// --------------------------------------------------------
+// Finds an SRV once, for setting it by handle later
+// --------------------------------------------------------
+SimpleSRVHandle ISimpleShader::GetShaderResourceViewHandle(std::string_view name)
+{
+	SimpleSRVHandle handle;
+	const SimpleSRV* srv = GetShaderResourceViewInfo(name);
+	if (srv) handle.Index = (int)srv->Index;
+	return handle;
+}
+
+// --------------------------------------------------------
+// Finds a sampler once, for setting it by handle later
+// --------------------------------------------------------
+SimpleSamplerHandle ISimpleShader::GetSamplerHandle(std::string_view name)
+{
+	SimpleSamplerHandle handle;
+	const SimpleSampler* samp = GetSamplerInfo(name);
+	if (samp) handle.Index = (int)samp->Index;
+	return handle;
+}
+
+// --------------------------------------------------------
+// Sets a variable by handle with arbitrary data of the specified size
+//
+// handle - The handle from GetVariableHandle()
+// data - The data to set in the buffer
+// size - The size of the data (this must be less than or equal to the variable's size)
+//
+// Returns true if data is copied, false if the handle is invalid
+// --------------------------------------------------------
+bool ISimpleShader::SetData(SimpleVariableHandle handle, const void* data, unsigned int size)
+{
+	// Invalid handles are expected for variables a shader doesn't use
+	if (handle.Index < 0 || (size_t)handle.Index >= reflection->Variables.size())
+		return false;
+
+	// Ensure we're not trying to copy more data than the variable can hold
+	const SimpleShaderVariable& var = reflection->Variables[handle.Index];
+	if (size > var.Size)
+	{
+		if (ReportWarnings)
+			LogWarning("SimpleShader::SetData() - Shader variable is smaller than the size of the data being set.\n");
+		return false;
+	}
+
+	// Set the data in the local data buffer
+	constantBuffers[var.ConstantBufferIndex].Write(var.ByteOffset, data, size);
+	return true;
+}
+
+// --------------------------------------------------------
+// Handle based versions of the typed setters above
+// --------------------------------------------------------
+bool ISimpleShader::SetInt(SimpleVariableHandle handle, int data) { return SetData(handle, &data, sizeof(int)); }
+bool ISimpleShader::SetFloat(SimpleVariableHandle handle, float data) { return SetData(handle, &data, sizeof(float)); }
+bool ISimpleShader::SetFloat2(SimpleVariableHandle handle, const DirectX::XMFLOAT2& data) { return SetData(handle, &data, sizeof(float) * 2); }
+bool ISimpleShader::SetFloat3(SimpleVariableHandle handle, const DirectX::XMFLOAT3& data) { return SetData(handle, &data, sizeof(float) * 3); }
+bool ISimpleShader::SetFloat4(SimpleVariableHandle handle, const DirectX::XMFLOAT4& data) { return SetData(handle, &data, sizeof(float) * 4); }
+bool ISimpleShader::SetMatrix4x4(SimpleVariableHandle handle, const DirectX::XMFLOAT4X4& data) { return SetData(handle, &data, sizeof(float) * 16); }
+
+// --------------------------------------------------------
+// Sets a run of bytes in a constant buffer's local data
+// buffer, only marking them dirty if they changed
+//
+// Returns true if the run fits in the buffer, false otherwise
+// --------------------------------------------------------
+bool ISimpleShader::SetBufferData(unsigned int index, unsigned int offset, const void* data, unsigned int size)
+{
+	if (index >= constantBufferCount || offset > constantBuffers[index].Size || size > constantBuffers[index].Size - offset)
+	{
+		if (ReportWarnings)
+			LogWarning("SimpleShader::SetBufferData() - Data does not fit in the constant buffer.\n");
+		return false;
+	}
+
+	constantBuffers[index].Write(offset, data, size);
+	return true;
+}
+
+// --------------------------------------------------------
+// Sets a shader resource view by handle
+//
+// Returns true if the handle is valid, false otherwise
+// --------------------------------------------------------
+bool ISimpleShader::SetShaderResourceView(SimpleSRVHandle handle, ID3D11ShaderResourceView* srv)
+{
+	if (handle.Index < 0 || (size_t)handle.Index >= reflection->ShaderResourceViews.size())
+		return false;
+
+	BindShaderResourceView(reflection->ShaderResourceViews[handle.Index]->BindIndex, srv);
+	return true;
+}
+
+// --------------------------------------------------------
+// Sets a sampler state by handle
+//
+// Returns true if the handle is valid, false otherwise
+// --------------------------------------------------------
+bool ISimpleShader::SetSamplerState(SimpleSamplerHandle handle, ID3D11SamplerState* samplerState)
+{
+	if (handle.Index < 0 || (size_t)handle.Index >= reflection->SamplerStates.size())
+		return false;
+
+	BindSamplerState(reflection->SamplerStates[handle.Index]->BindIndex, samplerState);
+	return true;
+}
+
+// --------------------------------------------------------
+// Binds resources to neighbouring registers one at a time,
+// for stages without a way to bind a run at once
+// --------------------------------------------------------
+void ISimpleShader::BindShaderResourceViews(unsigned int startSlot, unsigned int count, ID3D11ShaderResourceView* const* srvs)
+{
+	for (unsigned int i = 0; i < count; i++)
+		BindShaderResourceView(startSlot + i, srvs[i]);
+}
+
+void ISimpleShader::BindSamplerStates(unsigned int startSlot, unsigned int count, ID3D11SamplerState* const* samplerStates)
+{
+	for (unsigned int i = 0; i < count; i++)
+		BindSamplerState(startSlot + i, samplerStates[i]);
+}
+
 // --------------------------------------------------------
 // Determines if the shader contains the specified
 // variable within one of its constant buffers
 // --------------------------------------------------------
-bool ISimpleShader::HasVariable(std::string name)
+bool ISimpleShader::HasVariable(std::string_view name)
 {
 	return FindVariable(name, -1) != 0;
 }
@@ -547,7 +872,7 @@ bool ISimpleShader::HasVariable(std::string name)
 // --------------------------------------------------------
 // Determines if the shader contains the specified SRV
 // --------------------------------------------------------
-bool ISimpleShader::HasShaderResourceView(std::string name)
+bool ISimpleShader::HasShaderResourceView(std::string_view name)
 {
 	return GetShaderResourceViewInfo(name) != 0;
 }
@@ -555,7 +880,7 @@ bool ISimpleShader::HasShaderResourceView(std::string name)
 // --------------------------------------------------------
 // Determines if the shader contains the specified sampler
 // --------------------------------------------------------
-bool ISimpleShader::HasSamplerState(std::string name)
+bool ISimpleShader::HasSamplerState(std::string_view name)
 {
 	return GetSamplerInfo(name) != 0;
 }
@@ -563,7 +888,7 @@ bool ISimpleShader::HasSamplerState(std::string name)
 // --------------------------------------------------------
 // Gets info about a shader variable, if it exists
 // --------------------------------------------------------
-const SimpleShaderVariable* ISimpleShader::GetVariableInfo(std::string name)
+const SimpleShaderVariable* ISimpleShader::GetVariableInfo(std::string_view name)
 {
 	return FindVariable(name, -1);
 }
@@ -573,14 +898,14 @@ const SimpleShaderVariable* ISimpleShader::GetVariableInfo(std::string name)
 //
 // name - the name of the SRV
 // --------------------------------------------------------
-const SimpleSRV* ISimpleShader::GetShaderResourceViewInfo(std::string name)
+const SimpleSRV* ISimpleShader::GetShaderResourceViewInfo(std::string_view name)
 {
 	// Look for the key
-	std::unordered_map<std::string, SimpleSRV*>::iterator result =
-		textureTable.find(name);
+	auto result =
+		reflection->TextureTable.find(name);
 
 	// Did we find the key?
-	if (result == textureTable.end())
+	if (result == reflection->TextureTable.end())
 		return 0;
 
 	// Success
@@ -596,10 +921,10 @@ const SimpleSRV* ISimpleShader::GetShaderResourceViewInfo(std::string name)
 const SimpleSRV* ISimpleShader::GetShaderResourceViewInfo(unsigned int index)
 {
 	// Valid index?
-	if (index >= shaderResourceViews.size()) return 0;
+	if (index >= reflection->ShaderResourceViews.size()) return 0;
 
 	// Grab the bind index
-	return shaderResourceViews[index];
+	return reflection->ShaderResourceViews[index];
 }
 
 
@@ -608,14 +933,14 @@ const SimpleSRV* ISimpleShader::GetShaderResourceViewInfo(unsigned int index)
 // 
 // name - the name of the sampler
 // --------------------------------------------------------
-const SimpleSampler* ISimpleShader::GetSamplerInfo(std::string name)
+const SimpleSampler* ISimpleShader::GetSamplerInfo(std::string_view name)
 {
 	// Look for the key
-	std::unordered_map<std::string, SimpleSampler*>::iterator result =
-		samplerTable.find(name);
+	auto result =
+		reflection->SamplerTable.find(name);
 
 	// Did we find the key?
-	if (result == samplerTable.end())
+	if (result == reflection->SamplerTable.end())
 		return 0;
 
 	// Success
@@ -630,10 +955,10 @@ const SimpleSampler* ISimpleShader::GetSamplerInfo(std::string name)
 const SimpleSampler* ISimpleShader::GetSamplerInfo(unsigned int index)
 {
 	// Valid index?
-	if (index >= samplerStates.size()) return 0;
+	if (index >= reflection->SamplerStates.size()) return 0;
 
 	// Grab the bind index
-	return samplerStates[index];
+	return reflection->SamplerStates[index];
 }
 
 
@@ -661,7 +986,7 @@ unsigned int ISimpleShader::GetBufferSize(unsigned int index)
 // Gets info about a particular constant buffer 
 // by name, if it exists
 // --------------------------------------------------------
-const SimpleConstantBuffer * ISimpleShader::GetBufferInfo(std::string name)
+const SimpleConstantBuffer * ISimpleShader::GetBufferInfo(std::string_view name)
 {
 	return FindConstantBuffer(name);
 }
@@ -869,24 +1194,62 @@ void SimpleVertexShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 
 	// Set the shader and input layout
-	deviceContext->IASetInputLayout(inputLayout.Get());
-	deviceContext->VSSetShader(shader.Get(), 0, 0);
+	if (StateCache)
+	{
+		StateCache->SetInputLayout(inputLayout.Get());
+		StateCache->SetVertexShader(shader.Get());
+	}
+	else
+	{
+		deviceContext->IASetInputLayout(inputLayout.Get());
+		deviceContext->VSSetShader(shader.Get(), 0, 0);
+	}
 
 	// Set the constant buffers
 	for (unsigned int i = 0; i < constantBufferCount; i++)
 	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
+		// Skip "buffers" that aren't true constant buffers, and
+		// shared ones bound by the caller
+		if (constantBuffers[i].Type != D3D11_CT_CBUFFER || constantBuffers[i].Shared)
 			continue;
 
 		// This is a real constant buffer, so set it
-		deviceContext->VSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
+		if (UsesConstantRing())
+		{
+			UploadToRing(&constantBuffers[i]);
+			BindConstantBuffer(&constantBuffers[i]);
+		}
+		else if (StateCache)
+			StateCache->SetVSConstantBuffer(constantBuffers[i].BindIndex, constantBuffers[i].ConstantBuffer.Get());
+		else
+			deviceContext->VSSetConstantBuffers(
+				constantBuffers[i].BindIndex,
+				1,
+				constantBuffers[i].ConstantBuffer.GetAddressOf());
 	}
 }
 
+// --------------------------------------------------------
+// Whether this shader's constants go through the upload
+// ring, which needs the state cache to bind at offsets
+// --------------------------------------------------------
+bool SimpleVertexShader::UsesConstantRing()
+{
+	return ConstantRing && StateCache;
+}
+
+// --------------------------------------------------------
+// Binds a constant buffer where its data is this frame,
+// its place in the ring or else its own buffer
+// --------------------------------------------------------
+void SimpleVertexShader::BindConstantBuffer(SimpleConstantBuffer* cb)
+{
+	if (cb->RingEpoch == ConstantRing->GetEpoch())
+		StateCache->SetVSConstantBuffer(cb->BindIndex, cb->RingBuffer, cb->RingOffset / 16, cb->RingSize() / 16);
+	else
+		StateCache->SetVSConstantBuffer(cb->BindIndex, cb->ConstantBuffer.Get());
+}
+
 // --------------------------------------------------------
 // Sets a shader resource view in the vertex shader stage
 //
@@ -895,7 +1258,7 @@ void SimpleVertexShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleVertexShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleVertexShader::SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -904,14 +1267,14 @@ bool SimpleVertexShader::SetShaderResourceView(std::string name, Microsoft::WRL:
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleVertexShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->VSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	BindShaderResourceView(srvInfo->BindIndex, srv.Get());
 
 	// Success
 	return true;
@@ -925,7 +1288,7 @@ bool SimpleVertexShader::SetShaderResourceView(std::string name, Microsoft::WRL:
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleVertexShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleVertexShader::SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -934,19 +1297,43 @@ bool SimpleVertexShader::SetSamplerState(std::string name, Microsoft::WRL::ComPt
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleVertexShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->VSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	BindSamplerState(sampInfo->BindIndex, samplerState.Get());
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Binds a shader resource view to a register in the
+// vertex shader stage
+// --------------------------------------------------------
+void SimpleVertexShader::BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv)
+{
+	if (StateCache)
+		StateCache->SetVSShaderResource(bindIndex, srv);
+	else
+		deviceContext->VSSetShaderResources(bindIndex, 1, &srv);
+}
+
+// --------------------------------------------------------
+// Binds a sampler state to a register in the
+// vertex shader stage
+// --------------------------------------------------------
+void SimpleVertexShader::BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState)
+{
+	if (StateCache)
+		StateCache->SetVSSampler(bindIndex, samplerState);
+	else
+		deviceContext->VSSetSamplers(bindIndex, 1, &samplerState);
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // ------ SIMPLE PIXEL SHADER -------------------------------------------------
@@ -1012,23 +1399,56 @@ void SimplePixelShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 	
 	// Set the shader
-	deviceContext->PSSetShader(shader.Get(), 0, 0);
+	if (StateCache)
+		StateCache->SetPixelShader(shader.Get());
+	else
+		deviceContext->PSSetShader(shader.Get(), 0, 0);
 
 	// Set the constant buffers
 	for (unsigned int i = 0; i < constantBufferCount; i++)
 	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
+		// Skip "buffers" that aren't true constant buffers, and
+		// shared ones bound by the caller
+		if (constantBuffers[i].Type != D3D11_CT_CBUFFER || constantBuffers[i].Shared)
 			continue;
 
 		// This is a real constant buffer, so set it
-		deviceContext->PSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
+		if (UsesConstantRing())
+		{
+			UploadToRing(&constantBuffers[i]);
+			BindConstantBuffer(&constantBuffers[i]);
+		}
+		else if (StateCache)
+			StateCache->SetPSConstantBuffer(constantBuffers[i].BindIndex, constantBuffers[i].ConstantBuffer.Get());
+		else
+			deviceContext->PSSetConstantBuffers(
+				constantBuffers[i].BindIndex,
+				1,
+				constantBuffers[i].ConstantBuffer.GetAddressOf());
 	}
 }
 
+// --------------------------------------------------------
+// Whether this shader's constants go through the upload
+// ring, which needs the state cache to bind at offsets
+// --------------------------------------------------------
+bool SimplePixelShader::UsesConstantRing()
+{
+	return ConstantRing && StateCache;
+}
+
+// --------------------------------------------------------
+// Binds a constant buffer where its data is this frame,
+// its place in the ring or else its own buffer
+// --------------------------------------------------------
+void SimplePixelShader::BindConstantBuffer(SimpleConstantBuffer* cb)
+{
+	if (cb->RingEpoch == ConstantRing->GetEpoch())
+		StateCache->SetPSConstantBuffer(cb->BindIndex, cb->RingBuffer, cb->RingOffset / 16, cb->RingSize() / 16);
+	else
+		StateCache->SetPSConstantBuffer(cb->BindIndex, cb->ConstantBuffer.Get());
+}
+
 // --------------------------------------------------------
 // Sets a shader resource view in the pixel shader stage
 //
@@ -1037,7 +1457,7 @@ void SimplePixelShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimplePixelShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimplePixelShader::SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1046,14 +1466,14 @@ bool SimplePixelShader::SetShaderResourceView(std::string name, Microsoft::WRL::
 		if (ReportWarnings)
 		{
 			LogWarning("SimplePixelShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->PSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	BindShaderResourceView(srvInfo->BindIndex, srv.Get());
 
 	// Success
 	return true;
@@ -1067,7 +1487,7 @@ bool SimplePixelShader::SetShaderResourceView(std::string name, Microsoft::WRL::
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimplePixelShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimplePixelShader::SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1076,19 +1496,67 @@ bool SimplePixelShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr
 		if (ReportWarnings)
 		{
 			LogWarning("SimplePixelShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->PSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	BindSamplerState(sampInfo->BindIndex, samplerState.Get());
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Binds a shader resource view to a register in the
+// pixel shader stage
+// --------------------------------------------------------
+void SimplePixelShader::BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv)
+{
+	if (StateCache)
+		StateCache->SetPSShaderResource(bindIndex, srv);
+	else
+		deviceContext->PSSetShaderResources(bindIndex, 1, &srv);
+}
+
+// --------------------------------------------------------
+// Binds a sampler state to a register in the
+// pixel shader stage
+// --------------------------------------------------------
+void SimplePixelShader::BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState)
+{
+	if (StateCache)
+		StateCache->SetPSSampler(bindIndex, samplerState);
+	else
+		deviceContext->PSSetSamplers(bindIndex, 1, &samplerState);
+}
+
+// --------------------------------------------------------
+// Binds shader resources to a run of registers in the
+// pixel shader stage with one call
+// --------------------------------------------------------
+void SimplePixelShader::BindShaderResourceViews(unsigned int startSlot, unsigned int count, ID3D11ShaderResourceView* const* srvs)
+{
+	if (StateCache)
+		StateCache->SetPSShaderResources(startSlot, count, srvs);
+	else
+		deviceContext->PSSetShaderResources(startSlot, count, srvs);
+}
+
+// --------------------------------------------------------
+// Binds sampler states to a run of registers in the
+// pixel shader stage with one call
+// --------------------------------------------------------
+void SimplePixelShader::BindSamplerStates(unsigned int startSlot, unsigned int count, ID3D11SamplerState* const* samplerStates)
+{
+	if (StateCache)
+		StateCache->SetPSSamplers(startSlot, count, samplerStates);
+	else
+		deviceContext->PSSetSamplers(startSlot, count, samplerStates);
+}
+
 
 
 
@@ -1161,8 +1629,9 @@ void SimpleDomainShader::SetShaderAndCBs()
 	// Set the constant buffers
 	for (unsigned int i = 0; i < constantBufferCount; i++)
 	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
+		// Skip "buffers" that aren't true constant buffers, and
+		// shared ones bound by the caller
+		if (constantBuffers[i].Type != D3D11_CT_CBUFFER || constantBuffers[i].Shared)
 			continue;
 
 		// This is a real constant buffer, so set it
@@ -1181,7 +1650,7 @@ void SimpleDomainShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleDomainShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleDomainShader::SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1190,14 +1659,14 @@ bool SimpleDomainShader::SetShaderResourceView(std::string name, Microsoft::WRL:
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleDomainShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->DSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	BindShaderResourceView(srvInfo->BindIndex, srv.Get());
 
 	// Success
 	return true;
@@ -1211,7 +1680,7 @@ bool SimpleDomainShader::SetShaderResourceView(std::string name, Microsoft::WRL:
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleDomainShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleDomainShader::SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1220,19 +1689,37 @@ bool SimpleDomainShader::SetSamplerState(std::string name, Microsoft::WRL::ComPt
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleDomainShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->DSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	BindSamplerState(sampInfo->BindIndex, samplerState.Get());
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Binds a shader resource view to a register in the
+// domain shader stage
+// --------------------------------------------------------
+void SimpleDomainShader::BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv)
+{
+	deviceContext->DSSetShaderResources(bindIndex, 1, &srv);
+}
+
+// --------------------------------------------------------
+// Binds a sampler state to a register in the
+// domain shader stage
+// --------------------------------------------------------
+void SimpleDomainShader::BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState)
+{
+	deviceContext->DSSetSamplers(bindIndex, 1, &samplerState);
+}
+
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1304,8 +1791,9 @@ void SimpleHullShader::SetShaderAndCBs()
 	// Set the constant buffers?
 	for (unsigned int i = 0; i < constantBufferCount; i++)
 	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
+		// Skip "buffers" that aren't true constant buffers, and
+		// shared ones bound by the caller
+		if (constantBuffers[i].Type != D3D11_CT_CBUFFER || constantBuffers[i].Shared)
 			continue;
 
 		// This is a real constant buffer, so set it
@@ -1324,7 +1812,7 @@ void SimpleHullShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleHullShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleHullShader::SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1333,14 +1821,14 @@ bool SimpleHullShader::SetShaderResourceView(std::string name, Microsoft::WRL::C
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleHullShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->HSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	BindShaderResourceView(srvInfo->BindIndex, srv.Get());
 
 	// Success
 	return true;
@@ -1354,7 +1842,7 @@ bool SimpleHullShader::SetShaderResourceView(std::string name, Microsoft::WRL::C
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleHullShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleHullShader::SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1363,19 +1851,37 @@ bool SimpleHullShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleHullShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->HSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	BindSamplerState(sampInfo->BindIndex, samplerState.Get());
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Binds a shader resource view to a register in the
+// hull shader stage
+// --------------------------------------------------------
+void SimpleHullShader::BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv)
+{
+	deviceContext->HSSetShaderResources(bindIndex, 1, &srv);
+}
+
+// --------------------------------------------------------
+// Binds a sampler state to a register in the
+// hull shader stage
+// --------------------------------------------------------
+void SimpleHullShader::BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState)
+{
+	deviceContext->HSSetSamplers(bindIndex, 1, &samplerState);
+}
+
 
 
 
@@ -1578,8 +2084,9 @@ void SimpleGeometryShader::SetShaderAndCBs()
 	// Set the constant buffers?
 	for (unsigned int i = 0; i < constantBufferCount; i++)
 	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
+		// Skip "buffers" that aren't true constant buffers, and
+		// shared ones bound by the caller
+		if (constantBuffers[i].Type != D3D11_CT_CBUFFER || constantBuffers[i].Shared)
 			continue;
 
 		// This is a real constant buffer, so set it
@@ -1598,7 +2105,7 @@ void SimpleGeometryShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleGeometryShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleGeometryShader::SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1607,14 +2114,14 @@ bool SimpleGeometryShader::SetShaderResourceView(std::string name, Microsoft::WR
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleGeometryShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->GSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	BindShaderResourceView(srvInfo->BindIndex, srv.Get());
 
 	// Success
 	return true;
@@ -1628,7 +2135,7 @@ bool SimpleGeometryShader::SetShaderResourceView(std::string name, Microsoft::WR
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleGeometryShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleGeometryShader::SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1637,19 +2144,37 @@ bool SimpleGeometryShader::SetSamplerState(std::string name, Microsoft::WRL::Com
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleGeometryShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->GSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	BindSamplerState(sampInfo->BindIndex, samplerState.Get());
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Binds a shader resource view to a register in the
+// geometry shader stage
+// --------------------------------------------------------
+void SimpleGeometryShader::BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv)
+{
+	deviceContext->GSSetShaderResources(bindIndex, 1, &srv);
+}
+
+// --------------------------------------------------------
+// Binds a sampler state to a register in the
+// geometry shader stage
+// --------------------------------------------------------
+void SimpleGeometryShader::BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState)
+{
+	deviceContext->GSSetSamplers(bindIndex, 1, &samplerState);
+}
+
 // --------------------------------------------------------
 // Calculates the number of components specified by a parameter description mask
 //
@@ -1788,8 +2313,9 @@ void SimpleComputeShader::SetShaderAndCBs()
 	// Set the constant buffers?
 	for (unsigned int i = 0; i < constantBufferCount; i++)
 	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
+		// Skip "buffers" that aren't true constant buffers, and
+		// shared ones bound by the caller
+		if (constantBuffers[i].Type != D3D11_CT_CBUFFER || constantBuffers[i].Shared)
 			continue;
 
 		// This is a real constant buffer, so set it
@@ -1856,7 +2382,7 @@ void SimpleComputeShader::DispatchByThreads(unsigned int threadsX, unsigned int
 // --------------------------------------------------------
 // Determines if this shader has the specified UAV
 // --------------------------------------------------------
-bool SimpleComputeShader::HasUnorderedAccessView(std::string name)
+bool SimpleComputeShader::HasUnorderedAccessView(std::string_view name)
 {
 	return GetUnorderedAccessViewIndex(name) != -1;
 }
@@ -1869,7 +2395,7 @@ bool SimpleComputeShader::HasUnorderedAccessView(std::string name)
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleComputeShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleComputeShader::SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1878,14 +2404,14 @@ bool SimpleComputeShader::SetShaderResourceView(std::string name, Microsoft::WRL
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleComputeShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->CSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	BindShaderResourceView(srvInfo->BindIndex, srv.Get());
 
 	// Success
 	return true;
@@ -1899,7 +2425,7 @@ bool SimpleComputeShader::SetShaderResourceView(std::string name, Microsoft::WRL
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleComputeShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleComputeShader::SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1908,19 +2434,37 @@ bool SimpleComputeShader::SetSamplerState(std::string name, Microsoft::WRL::ComP
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleComputeShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->CSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	BindSamplerState(sampInfo->BindIndex, samplerState.Get());
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Binds a shader resource view to a register in the
+// compute shader stage
+// --------------------------------------------------------
+void SimpleComputeShader::BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv)
+{
+	deviceContext->CSSetShaderResources(bindIndex, 1, &srv);
+}
+
+// --------------------------------------------------------
+// Binds a sampler state to a register in the
+// compute shader stage
+// --------------------------------------------------------
+void SimpleComputeShader::BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState)
+{
+	deviceContext->CSSetSamplers(bindIndex, 1, &samplerState);
+}
+
 // --------------------------------------------------------
 // Sets an unordered access view in the Compute shader stage
 //
@@ -1930,7 +2474,7 @@ bool SimpleComputeShader::SetSamplerState(std::string name, Microsoft::WRL::ComP
 //
 // Returns true if a UAV of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleComputeShader::SetUnorderedAccessView(std::string name, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav, unsigned int appendConsumeOffset)
+bool SimpleComputeShader::SetUnorderedAccessView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav, unsigned int appendConsumeOffset)
 {
 	// Look for the variable and verify
 	unsigned int bindIndex = GetUnorderedAccessViewIndex(name);
@@ -1939,7 +2483,7 @@ bool SimpleComputeShader::SetUnorderedAccessView(std::string name, Microsoft::WR
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleComputeShader::SetUnorderedAccessView() - UAV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
@@ -1955,10 +2499,10 @@ bool SimpleComputeShader::SetUnorderedAccessView(std::string name, Microsoft::WR
 // --------------------------------------------------------
 // Gets the index of the specified UAV (or -1)
 // --------------------------------------------------------
-int SimpleComputeShader::GetUnorderedAccessViewIndex(std::string name)
+int SimpleComputeShader::GetUnorderedAccessViewIndex(std::string_view name)
 {
 	// Look for the key
-	std::unordered_map<std::string, unsigned int>::iterator result =
+	auto result =
 		uavTable.find(name);
 
 	// Did we find the key?
@@ -4,13 +4,20 @@
 
 #include <d3d11.h>
 #include <d3dcompiler.h>
+#include <cstdint>
+#include <cstring>
 #include <DirectXMath.h>
 #include <wrl/client.h>
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 #include <string>
+#include <string_view>
 
+class PipelineStateCache;
+class UploadRing;
+struct ShaderReflectionData;
 
 // --------------------------------------------------------
 // Used by simple shaders to store information about
@@ -18,6 +25,7 @@
 // --------------------------------------------------------
 struct SimpleShaderVariable
 {
+	unsigned int Index;		// The raw index of the variable
 	unsigned int ByteOffset;
 	unsigned int Size;
 	unsigned int ConstantBufferIndex;
@@ -37,6 +45,82 @@ struct SimpleConstantBuffer
 	Microsoft::WRL::ComPtr<ID3D11Buffer> ConstantBuffer = 0;
 	unsigned char* LocalDataBuffer = 0;
 	std::vector<SimpleShaderVariable> Variables;
+
+	// Bytes of the local data buffer changed since the last
+	// upload, none when the two are equal
+	unsigned int DirtyStart = 0;
+	unsigned int DirtyEnd = 0;
+
+	// Where the data last went in the shared upload ring, good
+	// for as long as the ring's epoch is still RingEpoch
+	ID3D11Buffer* RingBuffer = 0;
+	unsigned int RingOffset = 0;
+	unsigned int RingEpoch = 0;
+
+	// Filled and bound by the caller for every shader at once,
+	// so the shader never uploads or binds it
+	bool Shared = false;
+
+	bool IsDirty() const { return DirtyStart < DirtyEnd; }
+
+	// Space taken in the ring, which binds in whole multiples
+	// of 16 constants of 16 bytes
+	unsigned int RingSize() const { return (Size + 255) & ~255u; }
+
+	// Copies data into the local data buffer, only marking
+	// the bytes dirty if they actually changed
+	bool Write(unsigned int offset, const void* data, unsigned int size)
+	{
+		unsigned char* dest = LocalDataBuffer + offset;
+		if (size == 0 || memcmp(dest, data, size) == 0)
+			return false;
+
+		memcpy(dest, data, size);
+		if (!IsDirty())
+		{
+			DirtyStart = offset;
+			DirtyEnd = offset + size;
+		}
+		else
+		{
+			DirtyStart = offset < DirtyStart ? offset : DirtyStart;
+			DirtyEnd = offset + size > DirtyEnd ? offset + size : DirtyEnd;
+		}
+		return true;
+	}
+
+	// Sends the local data buffer to the GPU if anything in it
+	// changed, returning the bytes sent.  The whole buffer goes,
+	// as D3D11.0 can't update part of a constant buffer.
+	unsigned int Upload(ID3D11DeviceContext* context)
+	{
+		if (!IsDirty())
+			return 0;
+
+		context->UpdateSubresource(ConstantBuffer.Get(), 0, 0, LocalDataBuffer, 0, 0);
+		DirtyStart = DirtyEnd = 0;
+		return Size;
+	}
+};
+
+// --------------------------------------------------------
+// Constant buffer uploads, summed over every shader
+// --------------------------------------------------------
+struct SimpleUploadStats
+{
+	unsigned int Uploads = 0;		// Buffers sent to the GPU
+	unsigned int Skipped = 0;		// Buffers left alone, nothing in them changed
+	unsigned int Bytes = 0;			// Bytes sent to the GPU
+};
+
+// --------------------------------------------------------
+// Where loaded shaders got their reflection from
+// --------------------------------------------------------
+struct SimpleReflectionStats
+{
+	unsigned int Reflected = 0;		// Reflected from the bytecode
+	unsigned int Cached = 0;		// Read from the file cached next to the shader
+	unsigned int Shared = 0;		// Taken from a shader loaded from the same bytecode
 };
 
 // --------------------------------------------------------
@@ -57,6 +141,69 @@ struct SimpleSampler
 	unsigned int BindIndex; // The register of the Sampler
 };
 
+// --------------------------------------------------------
+// Handles to a variable, SRV or sampler, found by name once
+// so setting them skips the lookup.  Only valid for the
+// shader they came from.
+// --------------------------------------------------------
+struct SimpleVariableHandle
+{
+	int Index = -1;
+	bool IsValid() const { return Index >= 0; }
+};
+
+struct SimpleSRVHandle
+{
+	int Index = -1;
+	bool IsValid() const { return Index >= 0; }
+};
+
+struct SimpleSamplerHandle
+{
+	int Index = -1;
+	bool IsValid() const { return Index >= 0; }
+};
+
+// --------------------------------------------------------
+// Hashes names so tables keyed by std::string can be
+// searched with a std::string_view, without a copy
+// --------------------------------------------------------
+struct SimpleNameHash
+{
+	using is_transparent = void;
+	size_t operator()(std::string_view name) const { return std::hash<std::string_view>()(name); }
+};
+
+template<typename T>
+using SimpleNameTable = std::unordered_map<std::string, T, SimpleNameHash, std::equal_to<>>;
+
+// --------------------------------------------------------
+// The tables built from a shader's reflection, along with
+// its constant buffers.  Shared by every shader object
+// loaded from the same bytecode, so they also share the
+// constant buffers' data.
+// --------------------------------------------------------
+struct SimpleShaderReflection
+{
+	uint64_t BytecodeHash = 0;
+	size_t BytecodeSize = 0;
+
+	unsigned int ConstantBufferCount = 0;
+	SimpleConstantBuffer* ConstantBuffers = 0;	// For index-based lookup
+	std::vector<SimpleShaderVariable> Variables;	// For handle-based lookup
+	std::vector<SimpleSRV*> ShaderResourceViews;
+	std::vector<SimpleSampler*> SamplerStates;
+	SimpleNameTable<SimpleConstantBuffer*> CBTable;
+	SimpleNameTable<SimpleShaderVariable> VarTable;
+	SimpleNameTable<SimpleSRV*> TextureTable;
+	SimpleNameTable<SimpleSampler*> SamplerTable;
+
+	SimpleShaderReflection() = default;
+	SimpleShaderReflection(const SimpleShaderReflection&) = delete;
+	SimpleShaderReflection& operator=(const SimpleShaderReflection&) = delete;
+	~SimpleShaderReflection();
+};
+
 // --------------------------------------------------------
 // Base abstract class for simplifying shader handling
 // --------------------------------------------------------
@@ -73,46 +220,71 @@ public:
 	void SetShader();
 	void CopyAllBufferData();
 	void CopyBufferData(unsigned int index);
-	void CopyBufferData(std::string bufferName);
+	void CopyBufferData(std::string_view bufferName);
 
 	// Sets arbitrary shader data
-	bool SetData(std::string name, const void* data, unsigned int size);
-
-	bool SetInt(std::string name, int data);
-	bool SetFloat(std::string name, float data);
-	bool SetFloat2(std::string name, const float data[2]);
-	bool SetFloat2(std::string name, const DirectX::XMFLOAT2 data);
-	bool SetFloat3(std::string name, const float data[3]);
-	bool SetFloat3(std::string name, const DirectX::XMFLOAT3 data);
-	bool SetFloat4(std::string name, const float data[4]);
-	bool SetFloat4(std::string name, const DirectX::XMFLOAT4 data);
-	bool SetMatrix4x4(std::string name, const float data[16]);
-	bool SetMatrix4x4(std::string name, const DirectX::XMFLOAT4X4 data);
+	bool SetData(std::string_view name, const void* data, unsigned int size);
+
+	bool SetInt(std::string_view name, int data);
+	bool SetFloat(std::string_view name, float data);
+	bool SetFloat2(std::string_view name, const float data[2]);
+	bool SetFloat2(std::string_view name, const DirectX::XMFLOAT2 data);
+	bool SetFloat3(std::string_view name, const float data[3]);
+	bool SetFloat3(std::string_view name, const DirectX::XMFLOAT3 data);
+	bool SetFloat4(std::string_view name, const float data[4]);
+	bool SetFloat4(std::string_view name, const DirectX::XMFLOAT4 data);
+	bool SetMatrix4x4(std::string_view name, const float data[16]);
+	bool SetMatrix4x4(std::string_view name, const DirectX::XMFLOAT4X4 data);
+
+	// Finds names once for the handle based setters
+	SimpleVariableHandle GetVariableHandle(std::string_view name);
+	SimpleSRVHandle GetShaderResourceViewHandle(std::string_view name);
+	SimpleSamplerHandle GetSamplerHandle(std::string_view name);
+
+	// Sets shader data by handle, skipping the lookup
+	bool SetData(SimpleVariableHandle handle, const void* data, unsigned int size);
+
+	bool SetInt(SimpleVariableHandle handle, int data);
+	bool SetFloat(SimpleVariableHandle handle, float data);
+	bool SetFloat2(SimpleVariableHandle handle, const DirectX::XMFLOAT2& data);
+	bool SetFloat3(SimpleVariableHandle handle, const DirectX::XMFLOAT3& data);
+	bool SetFloat4(SimpleVariableHandle handle, const DirectX::XMFLOAT4& data);
+	bool SetMatrix4x4(SimpleVariableHandle handle, const DirectX::XMFLOAT4X4& data);
+
+	// Sets a run of bytes within a constant buffer at once, such
+	// as a block of variables packed ahead of time
+	bool SetBufferData(unsigned int index, unsigned int offset, const void* data, unsigned int size);
 
 	// Setting shader resources
-	virtual bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv) = 0;
-	virtual bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState) = 0;
+	virtual bool SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv) = 0;
+	virtual bool SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState) = 0;
+	bool SetShaderResourceView(SimpleSRVHandle handle, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(SimpleSamplerHandle handle, ID3D11SamplerState* samplerState);
+
+	// Binds resources to neighbouring registers with one call
+	void SetShaderResourceViews(unsigned int startSlot, unsigned int count, ID3D11ShaderResourceView* const* srvs) { BindShaderResourceViews(startSlot, count, srvs); }
+	void SetSamplerStates(unsigned int startSlot, unsigned int count, ID3D11SamplerState* const* samplerStates) { BindSamplerStates(startSlot, count, samplerStates); }
 
 	// Simple resource checking
-	bool HasVariable(std::string name);
-	bool HasShaderResourceView(std::string name);
-	bool HasSamplerState(std::string name);
+	bool HasVariable(std::string_view name);
+	bool HasShaderResourceView(std::string_view name);
+	bool HasSamplerState(std::string_view name);
 
 	// Getting data about variables and resources
-	const SimpleShaderVariable* GetVariableInfo(std::string name);
+	const SimpleShaderVariable* GetVariableInfo(std::string_view name);
 	
-	const SimpleSRV* GetShaderResourceViewInfo(std::string name);
+	const SimpleSRV* GetShaderResourceViewInfo(std::string_view name);
 	const SimpleSRV* GetShaderResourceViewInfo(unsigned int index);
-	size_t GetShaderResourceViewCount() { return textureTable.size(); }
+	size_t GetShaderResourceViewCount() { return reflection->TextureTable.size(); }
 	
-	const SimpleSampler* GetSamplerInfo(std::string name);
+	const SimpleSampler* GetSamplerInfo(std::string_view name);
 	const SimpleSampler* GetSamplerInfo(unsigned int index);
-	size_t GetSamplerCount() { return samplerTable.size(); }
+	size_t GetSamplerCount() { return reflection->SamplerTable.size(); }
 
 	// Get data about constant buffers
 	unsigned int GetBufferCount();
 	unsigned int GetBufferSize(unsigned int index);
-	const SimpleConstantBuffer* GetBufferInfo(std::string name);
+	const SimpleConstantBuffer* GetBufferInfo(std::string_view name);
 	const SimpleConstantBuffer* GetBufferInfo(unsigned int index);
 	
 	// Misc getters
@@ -122,6 +294,23 @@ public:
 	static bool ReportErrors;
 	static bool ReportWarnings;
 
+	// Vertex and pixel shaders bind through this when set, which drops binds of what is already bound
+	static PipelineStateCache* StateCache;
+
+	// Vertex and pixel shader constants are written here instead of their own buffers
+	// when set along with StateCache, and bound at their offset in it
+	static UploadRing* ConstantRing;
+
+	// Counts constant buffer uploads until reset
+	static SimpleUploadStats UploadStats;
+
+	// Counts where shaders got their reflection from
+	static SimpleReflectionStats ReflectionStats;
+
+	// Constant buffers with these names are shared by every shader, which
+	// leave them to the caller.  Set before loading any shaders.
+	static std::vector<std::string> SharedConstantBufferNames;
+
 protected:
 	
 	bool shaderValid;
@@ -132,27 +321,44 @@ protected:
 	// Resource counts
 	unsigned int constantBufferCount;
 	
-	// Maps for variables and buffers
-	SimpleConstantBuffer*		constantBuffers; // For index-based lookup
-	std::vector<SimpleSRV*>		shaderResourceViews;
-	std::vector<SimpleSampler*>	samplerStates;
-	std::unordered_map<std::string, SimpleConstantBuffer*> cbTable;
-	std::unordered_map<std::string, SimpleShaderVariable> varTable;
-	std::unordered_map<std::string, SimpleSRV*> textureTable;
-	std::unordered_map<std::string, SimpleSampler*> samplerTable;
+	// Maps for variables and buffers, possibly shared with other shaders
+	std::shared_ptr<SimpleShaderReflection> reflection;
+	SimpleConstantBuffer*		constantBuffers; // Short for reflection->ConstantBuffers
 
 	// Initialization method
 	bool LoadShaderFile(LPCWSTR shaderFile);
 
+	// Reflects the loaded bytecode, and builds the tables and
+	// constant buffers out of the reflection data
+	void ReflectShader(ShaderReflectionData& data);
+	void BuildReflection(const ShaderReflectionData& data);
+
 	// Pure virtual functions for dealing with shader types
 	virtual bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob) = 0;
 	virtual void SetShaderAndCBs() = 0;
+	virtual void BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv) = 0;
+	virtual void BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState) = 0;
+
+	// One register at a time unless a stage binds a whole run at once
+	virtual void BindShaderResourceViews(unsigned int startSlot, unsigned int count, ID3D11ShaderResourceView* const* srvs);
+	virtual void BindSamplerStates(unsigned int startSlot, unsigned int count, ID3D11SamplerState* const* samplerStates);
 
 	virtual void CleanUp();
 
+	// Stages that can bind part of a buffer take their constants from the ring
+	virtual bool UsesConstantRing() { return false; }
+	virtual void BindConstantBuffer(SimpleConstantBuffer* cb) { }
+
 	// Helpers for finding data by name
-	SimpleShaderVariable* FindVariable(std::string name, int size);
-	SimpleConstantBuffer* FindConstantBuffer(std::string name);
+	SimpleShaderVariable* FindVariable(std::string_view name, int size);
+	SimpleConstantBuffer* FindConstantBuffer(std::string_view name);
+
+	// Uploads a buffer if it changed and counts it
+	void UploadBuffer(SimpleConstantBuffer* cb);
+
+	// Writes a buffer to the ring if it changed or the ring moved
+	// on since, returning whether it has to be bound again
+	bool UploadToRing(SimpleConstantBuffer* cb);
 
 	// Error logging
 	void Log(std::string message, WORD color);
@@ -178,8 +384,10 @@ public:
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> GetInputLayout() { return inputLayout; }
 	bool GetPerInstanceCompatible() { return perInstanceCompatible; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	using ISimpleShader::SetShaderResourceView;
+	using ISimpleShader::SetSamplerState;
+	bool SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
+	bool SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
 
 protected:
 	bool perInstanceCompatible;
@@ -187,6 +395,10 @@ protected:
 	 Microsoft::WRL::ComPtr<ID3D11VertexShader> shader;
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv);
+	void BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState);
+	bool UsesConstantRing();
+	void BindConstantBuffer(SimpleConstantBuffer* cb);
 	void CleanUp();
 };
 
@@ -201,13 +413,21 @@ public:
 	~SimplePixelShader();
 	Microsoft::WRL::ComPtr<ID3D11PixelShader> GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	using ISimpleShader::SetShaderResourceView;
+	using ISimpleShader::SetSamplerState;
+	bool SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
+	bool SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
 
 protected:
 	Microsoft::WRL::ComPtr<ID3D11PixelShader> shader;
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv);
+	void BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState);
+	void BindShaderResourceViews(unsigned int startSlot, unsigned int count, ID3D11ShaderResourceView* const* srvs);
+	void BindSamplerStates(unsigned int startSlot, unsigned int count, ID3D11SamplerState* const* samplerStates);
+	bool UsesConstantRing();
+	void BindConstantBuffer(SimpleConstantBuffer* cb);
 	void CleanUp();
 };
 
@@ -221,13 +441,17 @@ public:
 	~SimpleDomainShader();
 	Microsoft::WRL::ComPtr<ID3D11DomainShader> GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	using ISimpleShader::SetShaderResourceView;
+	using ISimpleShader::SetSamplerState;
+	bool SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
+	bool SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
 
 protected:
 	Microsoft::WRL::ComPtr<ID3D11DomainShader> shader;
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv);
+	void BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState);
 	void CleanUp();
 };
 
@@ -241,13 +465,17 @@ public:
 	~SimpleHullShader();
 	Microsoft::WRL::ComPtr<ID3D11HullShader> GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	using ISimpleShader::SetShaderResourceView;
+	using ISimpleShader::SetSamplerState;
+	bool SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
+	bool SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
 
 protected:
 	Microsoft::WRL::ComPtr<ID3D11HullShader> shader;
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv);
+	void BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState);
 	void CleanUp();
 };
 
@@ -261,8 +489,10 @@ public:
 	~SimpleGeometryShader();
 	Microsoft::WRL::ComPtr<ID3D11GeometryShader> GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	using ISimpleShader::SetShaderResourceView;
+	using ISimpleShader::SetSamplerState;
+	bool SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
+	bool SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
 
 	bool CreateCompatibleStreamOutBuffer(Microsoft::WRL::ComPtr<ID3D11Buffer> buffer, int vertexCount);
 
@@ -280,6 +510,8 @@ protected:
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	bool CreateShaderWithStreamOut(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv);
+	void BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState);
 	void CleanUp();
 
 	// Helpers
@@ -300,17 +532,19 @@ public:
 	void DispatchByGroups(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ);
 	void DispatchByThreads(unsigned int threadsX, unsigned int threadsY, unsigned int threadsZ);
 
-	bool HasUnorderedAccessView(std::string name);
+	bool HasUnorderedAccessView(std::string_view name);
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
-	bool SetUnorderedAccessView(std::string name, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav, unsigned int appendConsumeOffset = -1);
+	using ISimpleShader::SetShaderResourceView;
+	using ISimpleShader::SetSamplerState;
+	bool SetShaderResourceView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
+	bool SetSamplerState(std::string_view name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	bool SetUnorderedAccessView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav, unsigned int appendConsumeOffset = -1);
 
-	int GetUnorderedAccessViewIndex(std::string name);
+	int GetUnorderedAccessViewIndex(std::string_view name);
 
 protected:
 	Microsoft::WRL::ComPtr<ID3D11ComputeShader> shader;
-	std::unordered_map<std::string, unsigned int> uavTable;
+	SimpleNameTable<unsigned int> uavTable;
 
 	unsigned int threadsX;
 	unsigned int threadsY;
@@ -319,5 +553,7 @@ protected:
 
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindShaderResourceView(unsigned int bindIndex, ID3D11ShaderResourceView* srv);
+	void BindSamplerState(unsigned int bindIndex, ID3D11SamplerState* samplerState);
 	void CleanUp();
 };
\ No newline at end of file
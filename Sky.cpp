@@ -30,8 +30,8 @@ Sky::Sky(std::shared_ptr<Mesh> a_pMesh, Microsoft::WRL::ComPtr<ID3D11SamplerStat
 void Sky::Draw(std::shared_ptr<Camera> a_pCamera)
 {
 	// Setting the proper rasterizer and depth stencil.
-	Graphics::Context->RSSetState(m_pRasterizer.Get());
-	Graphics::Context->OMSetDepthStencilState(m_pDepthStencil.Get(), 0);
+	Graphics::StateCache.SetRasterizerState(m_pRasterizer.Get());
+	Graphics::StateCache.SetDepthStencilState(m_pDepthStencil.Get(), 0);
 
 	// Setting the active shaders.
 	m_pVertexShader->SetShader();
@@ -52,8 +52,8 @@ void Sky::Draw(std::shared_ptr<Camera> a_pCamera)
 	m_pSkyMesh->Draw();
 
 	// Reseting render states.
-	Graphics::Context->RSSetState(nullptr);
-	Graphics::Context->OMSetDepthStencilState(nullptr, 0);
+	Graphics::StateCache.SetRasterizerState(nullptr);
+	Graphics::StateCache.SetDepthStencilState(nullptr, 0);
 }
 
 // --------------------------------------------------------
@@ -149,4 +149,39 @@ void Sky::CreateCubemap(
 
 	// Send back the SRV, which is what we need for our shaders
 	m_pSRV = cubeSRV;
+}
+
+void Sky::CreateCubemap(const DecodedImage a_pFaces[6])
+{
+	if (a_pFaces[0].Pixels.empty()) return;
+
+	// Same cube map as above, but the faces go in as initial data.
+	D3D11_TEXTURE2D_DESC cubeDesc = {};
+	cubeDesc.ArraySize = 6;
+	cubeDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	cubeDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	cubeDesc.Width = a_pFaces[0].Width;
+	cubeDesc.Height = a_pFaces[0].Height;
+	cubeDesc.MipLevels = 1;
+	cubeDesc.MiscFlags = D3D11_RESOURCE_MISC_TEXTURECUBE;
+	cubeDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	cubeDesc.SampleDesc.Count = 1;
+
+	D3D11_SUBRESOURCE_DATA faceData[6] = {};
+	for (int i = 0; i < 6; i++)
+	{
+		if (a_pFaces[i].Width != cubeDesc.Width || a_pFaces[i].Height != cubeDesc.Height) return;
+		faceData[i].pSysMem = a_pFaces[i].Pixels.data();
+		faceData[i].SysMemPitch = a_pFaces[i].Width * 4;
+	}
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> cubeMapTexture;
+	if (FAILED(Graphics::Device->CreateTexture2D(&cubeDesc, faceData, cubeMapTexture.GetAddressOf()))) return;
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = cubeDesc.Format;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+	srvDesc.TextureCube.MipLevels = 1;
+	srvDesc.TextureCube.MostDetailedMip = 0;
+	Graphics::Device->CreateShaderResourceView(cubeMapTexture.Get(), &srvDesc, m_pSRV.ReleaseAndGetAddressOf());
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "Mesh.h"
 #include "SimpleShader.h"
 #include "Camera.h"
+#include "TextureLoader.h"
 
 #include <d3d11.h>
 #include <wrl/client.h>
@@ -47,6 +48,13 @@ public:
 		const wchar_t* down,
 		const wchar_t* front,
 		const wchar_t* back);
+
+	/// <summary>
+	/// Creates the cube map from six faces that were already decoded (e.g. on
+	/// a JobSystem), skipping the temporary per-face textures and copies.
+	/// </summary>
+	/// <param name="a_pFaces">The faces in +X, -X, +Y, -Y, +Z, -Z order, all the same size.</param>
+	void CreateCubemap(const DecodedImage a_pFaces[6]);
 };
 
 #endif //__SKY_H_
@@ -0,0 +1,258 @@
+#include "TangentGenerator.h"
+
+#include <future>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Jobs get at least this many batches of four triangles, smaller meshes are not worth splitting.
+	const size_t g_uMinBatchesPerJob = 4096;
+
+	// Upper bound on the memory spent on per-job accumulation buffers.
+	const size_t g_uMaxAccumulatorBytes = 256 * 1024 * 1024;
+
+	/// <summary>
+	/// Loads a vertex's position or normal with one unaligned load instead of three.
+	/// Both are followed by another field of Vertex, so the fourth float is in bounds.
+	/// </summary>
+	XMVECTOR LoadWide(const XMFLOAT3& a_v3Field)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&a_v3Field));
+	}
+
+	/// <summary>
+	/// Calculates the tangents of four triangles at once, with each SIMD lane
+	/// holding one triangle, and adds them to the triangles' vertices.  The
+	/// handedness vote dot(N, T x B) of each corner is accumulated in w.  The
+	/// accumulators are a_uStride bytes apart, so they can be the vertices' own tangents.
+	/// </summary>
+	void AccumulateBatch(const Vertex* a_pVertices, const unsigned int a_pCorners[12], char* a_pAccumulators, size_t a_uStride)
+	{
+		// Gathering the edges, uv deltas and normals one triangle per row.
+		XMMATRIX edge1, edge2, uvDeltas, normals[3];
+		for (int i = 0; i < 4; i++)
+		{
+			const Vertex& v1 = a_pVertices[a_pCorners[i * 3 + 0]];
+			const Vertex& v2 = a_pVertices[a_pCorners[i * 3 + 1]];
+			const Vertex& v3 = a_pVertices[a_pCorners[i * 3 + 2]];
+
+			// Positions and normals are loaded four floats wide, w picks up the next field of
+			// the vertex and is never used.
+			XMVECTOR position = LoadWide(v1.Position);
+			edge1.r[i] = LoadWide(v2.Position) - position;
+			edge2.r[i] = LoadWide(v3.Position) - position;
+
+			XMVECTOR uv = XMLoadFloat2(&v1.UV);
+			uvDeltas.r[i] = XMVectorPermute<0, 1, 4, 5>(XMLoadFloat2(&v2.UV) - uv, XMLoadFloat2(&v3.UV) - uv);
+
+			normals[0].r[i] = LoadWide(v1.Normal);
+			normals[1].r[i] = LoadWide(v2.Normal);
+			normals[2].r[i] = LoadWide(v3.Normal);
+		}
+
+		// Transposing so every register holds one component of all four triangles.
+		edge1 = XMMatrixTranspose(edge1);
+		edge2 = XMMatrixTranspose(edge2);
+		uvDeltas = XMMatrixTranspose(uvDeltas);
+		XMVECTOR s1 = uvDeltas.r[0];
+		XMVECTOR t1 = uvDeltas.r[1];
+		XMVECTOR s2 = uvDeltas.r[2];
+		XMVECTOR t2 = uvDeltas.r[3];
+
+		// Triangles with no uv area (and padding lanes) contribute nothing.
+		XMVECTOR determinant = s1 * t2 - s2 * t1;
+		XMVECTOR r = XMVectorSelect(XMVectorReciprocal(determinant), XMVectorZero(), XMVectorEqual(determinant, XMVectorZero()));
+
+		XMVECTOR tx = (t2 * edge1.r[0] - t1 * edge2.r[0]) * r;
+		XMVECTOR ty = (t2 * edge1.r[1] - t1 * edge2.r[1]) * r;
+		XMVECTOR tz = (t2 * edge1.r[2] - t1 * edge2.r[2]) * r;
+		XMVECTOR bx = (s1 * edge2.r[0] - s2 * edge1.r[0]) * r;
+		XMVECTOR by = (s1 * edge2.r[1] - s2 * edge1.r[1]) * r;
+		XMVECTOR bz = (s1 * edge2.r[2] - s2 * edge1.r[2]) * r;
+
+		// T x B, to compare against each corner's normal for the handedness.
+		XMVECTOR cx = ty * bz - tz * by;
+		XMVECTOR cy = tz * bx - tx * bz;
+		XMVECTOR cz = tx * by - ty * bx;
+
+		for (int c = 0; c < 3; c++)
+		{
+			XMMATRIX n = XMMatrixTranspose(normals[c]);
+			XMVECTOR handedness = n.r[0] * cx + n.r[1] * cy + n.r[2] * cz;
+
+			// Back to one triangle per register for the scatter.
+			XMMATRIX contributions = XMMatrixTranspose(XMMATRIX(tx, ty, tz, handedness));
+			for (int i = 0; i < 4; i++)
+			{
+				XMFLOAT4* pAccumulator = reinterpret_cast<XMFLOAT4*>(a_pAccumulators + a_pCorners[i * 3 + c] * a_uStride);
+				XMStoreFloat4(pAccumulator, XMLoadFloat4(pAccumulator) + contributions.r[i]);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Turns an accumulated tangent into a unit tangent orthogonal to the
+	/// normal with the handedness sign in w.
+	/// </summary>
+	XMVECTOR FinishTangent(FXMVECTOR a_vNormal, FXMVECTOR a_vAccumulated)
+	{
+		// Gram-Schmidt orthonormalize so the normal and tangent are exactly 90 degrees apart.
+		XMVECTOR tangent = XMVector3Normalize(a_vAccumulated - a_vNormal * XMVector3Dot(a_vNormal, a_vAccumulated));
+		return XMVectorSetW(tangent, XMVectorGetW(a_vAccumulated) < 0.0f ? -1.0f : 1.0f);
+	}
+}
+
+void TangentGenerator::CalculateTangents(Vertex* a_pVertices, size_t a_uVertexCount, const unsigned int* a_pIndices, size_t a_uIndexCount, JobSystem* a_pJobs)
+{
+	if (a_uVertexCount == 0) return;
+
+	size_t uTriangleCount = a_uIndexCount / 3;
+	size_t uBatchCount = (uTriangleCount + 3) / 4;
+	unsigned int uThreads = a_pJobs != nullptr ? a_pJobs->GetThreadCount() : 0;
+	size_t uJobs = uBatchCount / g_uMinBatchesPerJob;
+	size_t uByMemory = g_uMaxAccumulatorBytes / (a_uVertexCount * sizeof(XMFLOAT4) + 1) + 1;
+	if (uThreads < uJobs) uJobs = uThreads;
+	if (uByMemory < uJobs) uJobs = uByMemory;
+	if (uJobs < 1) uJobs = 1;
+
+	// The first job adds straight into the vertices' tangents, every other one into its own
+	// buffer, so the scatter never races.
+	for (size_t v = 0; v < a_uVertexCount; v++)
+		a_pVertices[v].Tangent = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+	std::vector<std::vector<XMFLOAT4>> accumulators(uJobs - 1, std::vector<XMFLOAT4>(a_uVertexCount, XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f)));
+
+	auto AccumulateRange = [&](size_t a_uJob, size_t a_uBegin, size_t a_uEnd)
+	{
+		char* pAccumulators = a_uJob == 0 ? reinterpret_cast<char*>(&a_pVertices[0].Tangent) : reinterpret_cast<char*>(accumulators[a_uJob - 1].data());
+		size_t uStride = a_uJob == 0 ? sizeof(Vertex) : sizeof(XMFLOAT4);
+		for (size_t b = a_uBegin; b < a_uEnd; b++)
+		{
+			size_t uFirstIndex = b * 12;
+			if (uFirstIndex + 12 <= uTriangleCount * 3)
+			{
+				AccumulateBatch(a_pVertices, a_pIndices + uFirstIndex, pAccumulators, uStride);
+				continue;
+			}
+
+			// Padding the last batch out with degenerate triangles.
+			unsigned int pCorners[12] = {};
+			for (size_t i = uFirstIndex; i < uTriangleCount * 3; i++)
+				pCorners[i - uFirstIndex] = a_pIndices[i];
+			AccumulateBatch(a_pVertices, pCorners, pAccumulators, uStride);
+		}
+	};
+	auto FinishRange = [&](size_t a_uBegin, size_t a_uEnd)
+	{
+		for (size_t v = a_uBegin; v < a_uEnd; v++)
+		{
+			XMVECTOR accumulated = XMLoadFloat4(&a_pVertices[v].Tangent);
+			for (const std::vector<XMFLOAT4>& lAccumulator : accumulators)
+				accumulated += XMLoadFloat4(&lAccumulator[v]);
+
+			XMStoreFloat4(&a_pVertices[v].Tangent, FinishTangent(XMLoadFloat3(&a_pVertices[v].Normal), accumulated));
+		}
+	};
+
+	if (uJobs == 1)
+	{
+		AccumulateRange(0, 0, uBatchCount);
+		FinishRange(0, a_uVertexCount);
+		return;
+	}
+
+	std::vector<std::future<void>> jobs;
+	jobs.reserve(uJobs);
+	size_t uPerJob = (uBatchCount + uJobs - 1) / uJobs;
+	for (size_t j = 0; j < uJobs; j++)
+	{
+		size_t uFirst = j * uPerJob < uBatchCount ? j * uPerJob : uBatchCount;
+		size_t uLast = uFirst + uPerJob < uBatchCount ? uFirst + uPerJob : uBatchCount;
+		jobs.push_back(a_pJobs->Submit([&AccumulateRange, j, uFirst, uLast]() { AccumulateRange(j, uFirst, uLast); }));
+	}
+	for (std::future<void>& job : jobs)
+		job.get();
+
+	// Summing the jobs' buffers and finishing each vertex.
+	jobs.clear();
+	uPerJob = (a_uVertexCount + uJobs - 1) / uJobs;
+	for (size_t uFirst = 0; uFirst < a_uVertexCount; uFirst += uPerJob)
+	{
+		size_t uLast = uFirst + uPerJob < a_uVertexCount ? uFirst + uPerJob : a_uVertexCount;
+		jobs.push_back(a_pJobs->Submit([&FinishRange, uFirst, uLast]() { FinishRange(uFirst, uLast); }));
+	}
+	for (std::future<void>& job : jobs)
+		job.get();
+}
+
+// --------------------------------------------------------
+// Calculates the tangents of the vertices in a mesh
+// - Code originally adapted from: http://www.terathon.com/code/tangent.html
+// - Updated version found here: http://foundationsofgameenginedev.com/FGED2-sample.pdf
+// - See listing 7.4 in section 7.5 (page 9 of the PDF)
+//
+// - Note: For this code to work, your Vertex format must
+// contain an XMFLOAT4 called Tangent
+//
+// - Be sure to call this BEFORE creating your D3D vertex/index buffers
+// --------------------------------------------------------
+void TangentGenerator::CalculateTangentsReference(Vertex* verts, size_t numVerts, const unsigned int* indices, size_t numIndices)
+{
+	// Reset tangents
+	for (size_t i = 0; i < numVerts; i++)
+	{
+		verts[i].Tangent = XMFLOAT4(0, 0, 0, 0);
+	}
+	// Calculate tangents one whole triangle at a time
+	for (size_t i = 0; i < numIndices;)
+	{
+		// Grab indices and vertices of first triangle
+		unsigned int i1 = indices[i++];
+		unsigned int i2 = indices[i++];
+		unsigned int i3 = indices[i++];
+		Vertex* v1 = &verts[i1];
+		Vertex* v2 = &verts[i2];
+		Vertex* v3 = &verts[i3];
+		// Calculate vectors relative to triangle positions
+		float x1 = v2->Position.x - v1->Position.x;
+		float y1 = v2->Position.y - v1->Position.y;
+		float z1 = v2->Position.z - v1->Position.z;
+		float x2 = v3->Position.x - v1->Position.x;
+		float y2 = v3->Position.y - v1->Position.y;
+		float z2 = v3->Position.z - v1->Position.z;
+		// Do the same for vectors relative to triangle uv's
+		float s1 = v2->UV.x - v1->UV.x;
+		float t1 = v2->UV.y - v1->UV.y;
+		float s2 = v3->UV.x - v1->UV.x;
+		float t2 = v3->UV.y - v1->UV.y;
+		// Create vectors for tangent calculation
+		float r = 1.0f / (s1 * t2 - s2 * t1);
+		float tx = (t2 * x1 - t1 * x2) * r;
+		float ty = (t2 * y1 - t1 * y2) * r;
+		float tz = (t2 * z1 - t1 * z2) * r;
+		// Adjust tangents of each vert of the triangle
+		v1->Tangent.x += tx;
+		v1->Tangent.y += ty;
+		v1->Tangent.z += tz;
+		v2->Tangent.x += tx;
+		v2->Tangent.y += ty;
+		v2->Tangent.z += tz;
+		v3->Tangent.x += tx;
+		v3->Tangent.y += ty;
+		v3->Tangent.z += tz;
+	}
+	// Ensure all of the tangents are orthogonal to the normals
+	for (size_t i = 0; i < numVerts; i++)
+	{
+		// Grab the two vectors
+		XMVECTOR normal = XMLoadFloat3(&verts[i].Normal);
+		XMVECTOR tangent = XMLoadFloat3(reinterpret_cast<XMFLOAT3*>(&verts[i].Tangent));
+		// Use Gram-Schmidt orthonormalize to ensure
+		// the normal and tangent are exactly 90 degrees apart
+		tangent = XMVector3Normalize(
+			tangent - normal * XMVector3Dot(normal, tangent));
+		// Store the tangent
+		XMStoreFloat3(reinterpret_cast<XMFLOAT3*>(&verts[i].Tangent), tangent);
+	}
+}
@@ -0,0 +1,40 @@
+#ifndef __TANGENTGENERATOR_H_
+#define __TANGENTGENERATOR_H_
+
+#include <cstddef>
+#include "JobSystem.h"
+#include "Vertex.h"
+
+/// <summary>
+/// Per-vertex tangent frame generation for normal mapping.  Both versions
+/// write a unit tangent orthogonal to the normal into Tangent.xyz and the
+/// handedness of the uv mapping (+1 or -1) into Tangent.w, so the pixel
+/// shader can rebuild the bitangent as cross(T, N) * w.
+/// </summary>
+namespace TangentGenerator
+{
+	/// <summary>
+	/// Calculates tangents four triangles at a time with SIMD, splitting large
+	/// meshes into jobs.  Each job accumulates into its own buffer and the
+	/// buffers are summed per vertex, so no two jobs write the same memory.
+	/// </summary>
+	/// <param name="a_pVertices">The vertices whose tangents are being calculated.</param>
+	/// <param name="a_uVertexCount">The amount of vertices.</param>
+	/// <param name="a_pIndices">The triangle list referencing the vertices.</param>
+	/// <param name="a_uIndexCount">The amount of indices in the list.</param>
+	/// <param name="a_pJobs">Workers to split large meshes across, null to run on the calling thread, as from inside a job.</param>
+	void CalculateTangents(Vertex* a_pVertices, size_t a_uVertexCount, const unsigned int* a_pIndices, size_t a_uIndexCount, JobSystem* a_pJobs = nullptr);
+
+	/// <summary>
+	/// The original one triangle at a time loop, kept as the baseline the SIMD
+	/// version is timed and checked against.  It writes no handedness, leaves w
+	/// at 0, and triangles with no uv area turn their vertices' tangents into NaNs.
+	/// </summary>
+	/// <param name="a_pVertices">The vertices whose tangents are being calculated.</param>
+	/// <param name="a_uVertexCount">The amount of vertices.</param>
+	/// <param name="a_pIndices">The triangle list referencing the vertices.</param>
+	/// <param name="a_uIndexCount">The amount of indices in the list.</param>
+	void CalculateTangentsReference(Vertex* a_pVertices, size_t a_uVertexCount, const unsigned int* a_pIndices, size_t a_uIndexCount);
+}
+
+#endif //__TANGENTGENERATOR_H_
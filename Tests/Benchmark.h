@@ -0,0 +1,47 @@
+#ifndef __BENCHMARK_H_
+#define __BENCHMARK_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+/// <summary>
+/// Timing helpers for the benchmark harnesses.  Each harness prints a table
+/// and checks that the paths it compares agree.  Run with --quick, as ctest
+/// does, it only does enough work to run those checks.
+/// </summary>
+namespace Benchmark
+{
+	/// <summary>
+	/// Whether the harness was asked for a quick run.
+	/// </summary>
+	inline bool IsQuick(int a_iArgc, char** a_pArgv)
+	{
+		for (int i = 1; i < a_iArgc; i++)
+		{
+			if (strcmp(a_pArgv[i], "--quick") == 0) return true;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Runs a function several times and returns the median time of one run,
+	/// which shrugs off the odd run interrupted by the OS.
+	/// </summary>
+	template<typename Function>
+	double MedianMs(unsigned int a_uRuns, Function a_fFunction)
+	{
+		std::vector<double> lTimes(a_uRuns > 0 ? a_uRuns : 1);
+		for (double& fTime : lTimes)
+		{
+			auto tpStart = std::chrono::steady_clock::now();
+			a_fFunction();
+			fTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tpStart).count();
+		}
+		std::nth_element(lTimes.begin(), lTimes.begin() + lTimes.size() / 2, lTimes.end());
+		return lTimes[lTimes.size() / 2];
+	}
+}
+
+#endif //__BENCHMARK_H_
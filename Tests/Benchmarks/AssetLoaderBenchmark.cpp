@@ -0,0 +1,113 @@
+// Loads a batch of stub assets through AssetLoader on job systems of
+// different sizes, each compared with the same batch on JobSystem(0), which
+// runs every load inline as loading one asset after another did.  Each load
+// step sleeps like a file read would, so the overlap shows even on a single
+// core.  Fails if a create step runs off the calling thread or out of order,
+// or if a thrown exception goes missing.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AssetLoader.h"
+#include "Benchmark.h"
+#include "Check.h"
+
+namespace
+{
+	const unsigned int g_uAssetCount = 20;
+	const std::chrono::milliseconds g_tLoadTime(5);
+
+	/// <summary>
+	/// Loads g_uAssetCount stub assets, checking where and in which order they are created.
+	/// </summary>
+	AssetLoadStats LoadBatch(JobSystem& a_jsJobs)
+	{
+		std::thread::id idCaller = std::this_thread::get_id();
+		std::vector<unsigned int> lCreated;
+		std::atomic<unsigned int> uOffCallerCreates = 0;
+
+		AssetLoader loader(a_jsJobs);
+		for (unsigned int i = 0; i < g_uAssetCount; i++)
+		{
+			loader.Add(
+				[i]()
+				{
+					std::this_thread::sleep_for(g_tLoadTime);
+					return std::to_string(i);
+				},
+				[&, i](std::string& a_sValue)
+				{
+					if (std::this_thread::get_id() != idCaller) uOffCallerCreates++;
+					if (a_sValue == std::to_string(i)) lCreated.push_back(i);
+				});
+		}
+		AssetLoadStats stats = loader.Finish();
+
+		CHECK(uOffCallerCreates == 0);
+		std::vector<unsigned int> lExpected(g_uAssetCount);
+		for (unsigned int i = 0; i < g_uAssetCount; i++) lExpected[i] = i;
+		CHECK(lCreated == lExpected);
+		CHECK(stats.AssetCount == g_uAssetCount);
+		CHECK(stats.ThreadCount == a_jsJobs.GetThreadCount());
+		return stats;
+	}
+
+	/// <summary>
+	/// Checks that Finish() rethrows an exception thrown by a load or a create step.
+	/// </summary>
+	void CheckRethrows(JobSystem& a_jsJobs, bool a_bFromCreate)
+	{
+		bool bThrown = false;
+		{
+			AssetLoader loader(a_jsJobs);
+			loader.Add([]() { return 1; }, [](int&) {});
+			loader.Add(
+				[a_bFromCreate]()
+				{
+					if (!a_bFromCreate) throw std::runtime_error("load");
+					return 2;
+				},
+				[](int&) { throw std::runtime_error("create"); });
+			loader.Add([]() { return 3; }, [](int&) {});
+			try
+			{
+				loader.Finish();
+			}
+			catch (const std::runtime_error& e)
+			{
+				bThrown = std::string(e.what()) == (a_bFromCreate ? "create" : "load");
+			}
+		}
+		CHECK(bThrown);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int uRuns = Benchmark::IsQuick(argc, argv) ? 1 : 5;
+
+	printf("%u assets, each loading for %lld ms\n\n", g_uAssetCount, static_cast<long long>(g_tLoadTime.count()));
+	printf("%8s %10s %8s\n", "threads", "wall ms", "speedup");
+	double fSerialMs = 0.0, fSingleThreadMs = 0.0;
+	for (unsigned int uThreads : { 0u, 1u, 4u })
+	{
+		JobSystem jobs(uThreads);
+		double fWallMs = Benchmark::MedianMs(uRuns, [&]() { LoadBatch(jobs); });
+		if (uThreads == 0) fSerialMs = fWallMs;
+		printf("%8u %10.1f %7.2fx\n", uThreads, fWallMs, fSerialMs / fWallMs);
+
+		CheckRethrows(jobs, false);
+		CheckRethrows(jobs, true);
+
+		// The loads overlap with four workers, they cannot with fewer.
+		if (uThreads == 1) fSingleThreadMs = fWallMs;
+		if (uThreads == 4) CHECK(fWallMs < fSingleThreadMs / 2.0);
+	}
+
+	return Check::Report("AssetLoaderBenchmark");
+}
@@ -0,0 +1,116 @@
+// Times building, refitting and querying a BoundingVolumeHierarchy at 100 to
+// 100k random boxes, against FrustumCuller's linear pass and a brute force ray
+// cast.  The counts in between show where the tree starts to beat the linear
+// cull, which Game uses below that.  Fails if the tree's answers differ from either.
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "BoundingVolumeHierarchy.h"
+#include "Check.h"
+
+using namespace DirectX;
+
+namespace
+{
+	/// <summary>
+	/// Where a ray enters a box, the brute force baseline tests every box with this.
+	/// </summary>
+	/// <returns>The distance along the ray, FLT_MAX if it misses.</returns>
+	float RayEnters(const CullBox& a_cbBox, const float* a_pOrigin, const float* a_pInverseDirection)
+	{
+		const float* pCenter = &a_cbBox.Center.x;
+		const float* pExtents = &a_cbBox.Extents.x;
+		float fEnter = 0.0f;
+		float fExit = FLT_MAX;
+		for (int a = 0; a < 3; a++)
+		{
+			float fT1 = (pCenter[a] - pExtents[a] - a_pOrigin[a]) * a_pInverseDirection[a];
+			float fT2 = (pCenter[a] + pExtents[a] - a_pOrigin[a]) * a_pInverseDirection[a];
+			fEnter = std::max(fEnter, std::min(fT1, fT2));
+			fExit = std::min(fExit, std::max(fT1, fT2));
+		}
+		return fExit >= fEnter ? fEnter : FLT_MAX;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = Benchmark::IsQuick(argc, argv);
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<float> fUnit(-1.0f, 1.0f);
+
+	XMFLOAT4X4 m4ViewProjection;
+	XMStoreFloat4x4(&m4ViewProjection,
+		XMMatrixLookToLH(XMVectorSet(0, 0, -50, 1), XMVectorSet(0.3f, 0, 1, 0), XMVectorSet(0, 1, 0, 0)) *
+		XMMatrixPerspectiveFovLH(XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.01f, 900.0f));
+	Frustum frustum = FrustumCuller::ExtractFrustum(m4ViewProjection);
+
+	printf("%7s %9s %9s %9s %13s %13s %12s %12s\n", "boxes", "visible", "build ms", "refit ms", "linear cull ms", "tree cull ms", "brute ray us", "tree ray us");
+	for (unsigned int uCount : { 100u, 1000u, 2500u, 5000u, 10000u, 100000u })
+	{
+		// The boxes fill a cube that grows with their count, so the density stays the same.
+		float fSpan = std::cbrt(static_cast<float>(uCount)) * 4.0f;
+		std::vector<CullBox> lBoxes(uCount);
+		for (CullBox& box : lBoxes)
+		{
+			box.Center = XMFLOAT3(fUnit(rng) * fSpan, fUnit(rng) * fSpan, fUnit(rng) * fSpan);
+			box.Extents = XMFLOAT3(0.5f + std::fabs(fUnit(rng)), 0.5f + std::fabs(fUnit(rng)), 0.5f + std::fabs(fUnit(rng)));
+		}
+
+		unsigned int uRuns = bQuick ? 1 : (uCount >= 100000 ? 9 : 51);
+		BoundingVolumeHierarchy bvh;
+		double fBuildMs = Benchmark::MedianMs(bQuick ? 1 : 5, [&]() { bvh.Build(lBoxes.data(), uCount); });
+		double fRefitMs = Benchmark::MedianMs(uRuns, [&]() { bvh.Refit(lBoxes.data()); });
+
+		std::vector<unsigned char> lLinear(uCount), lTree(uCount);
+		unsigned int uLinear = 0, uTree = 0;
+		double fLinearMs = Benchmark::MedianMs(uRuns, [&]() { uLinear = FrustumCuller::Cull(frustum, lBoxes.data(), uCount, lLinear.data()); });
+		double fTreeMs = Benchmark::MedianMs(uRuns, [&]() { uTree = bvh.QueryFrustum(frustum, lTree.data()); });
+		CHECK(uTree == uLinear);
+		CHECK(lTree == lLinear);
+
+		// The same rays through both, timed over the whole set.
+		const int iRayCount = bQuick ? 20 : 200;
+		std::vector<XMFLOAT3> lOrigins(iRayCount), lDirections(iRayCount);
+		for (int r = 0; r < iRayCount; r++)
+		{
+			lOrigins[r] = XMFLOAT3(fUnit(rng) * fSpan * 1.5f, fUnit(rng) * fSpan * 1.5f, fUnit(rng) * fSpan * 1.5f);
+			lDirections[r] = XMFLOAT3(fUnit(rng), fUnit(rng), fUnit(rng));
+		}
+		std::vector<float> lBrute(iRayCount), lTreeDistances(iRayCount);
+		double fBruteMs = Benchmark::MedianMs(bQuick ? 1 : 5, [&]()
+		{
+			for (int r = 0; r < iRayCount; r++)
+			{
+				float lInverse[3] = { 1.0f / lDirections[r].x, 1.0f / lDirections[r].y, 1.0f / lDirections[r].z };
+				lBrute[r] = FLT_MAX;
+				for (const CullBox& box : lBoxes) lBrute[r] = std::min(lBrute[r], RayEnters(box, &lOrigins[r].x, lInverse));
+			}
+		});
+		double fRayMs = Benchmark::MedianMs(bQuick ? 1 : 25, [&]()
+		{
+			for (int r = 0; r < iRayCount; r++)
+			{
+				unsigned int uHit;
+				if (!bvh.RayCast(lOrigins[r], lDirections[r], uHit, lTreeDistances[r])) lTreeDistances[r] = FLT_MAX;
+			}
+		});
+		unsigned int uRayMismatches = 0;
+		for (int r = 0; r < iRayCount; r++)
+		{
+			if (std::fabs(lBrute[r] - lTreeDistances[r]) > 1e-4f * std::max(1.0f, lBrute[r])) uRayMismatches++;
+		}
+		CHECK(uRayMismatches == 0);
+
+		printf("%7u %9u %9.2f %9.3f %13.3f %13.3f %12.2f %12.2f\n", uCount, uTree, fBuildMs, fRefitMs, fLinearMs, fTreeMs,
+			fBruteMs * 1000.0 / iRayCount, fRayMs * 1000.0 / iRayCount);
+	}
+
+	return Check::Report("BoundingVolumeHierarchyBenchmark");
+}
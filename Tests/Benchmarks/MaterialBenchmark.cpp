@@ -0,0 +1,190 @@
+// Times the pixel shader side of a draw: binding a material, then uploading
+// the shader's constant buffers.  Compares Material's baked ranges and packed
+// block with binding each slot and setting each parameter through handles, as
+// materials did before, with draws sorted by material and switching every
+// draw.  Fails if the two leave different bindings or constants.
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "Material.h"
+#include "PipelineStateCache.h"
+
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+	const unsigned int g_uMaterialCount = 7;
+	const unsigned int g_uDrawsPerMaterial = 8;
+	const unsigned int g_uDrawCount = g_uMaterialCount * g_uDrawsPerMaterial;
+
+	const char* g_lTextureNames[] = { "Albedo", "NormalMap", "RoughnessMap", "MetalnessMap", "ShadowMap" };
+	const char* g_lSamplerNames[] = { "BasicSampler", "ShadowSampler" };
+
+	/// <summary>
+	/// A material's slots and parameters found by handle, bound one by one.
+	/// </summary>
+	struct PerSlotMaterial
+	{
+		std::vector<std::pair<SimpleSRVHandle, ID3D11ShaderResourceView*>> Textures;
+		std::vector<std::pair<SimpleSamplerHandle, ID3D11SamplerState*>> Samplers;
+		SimpleVariableHandle ColorTint;
+		SimpleVariableHandle Roughness;
+		SimpleVariableHandle Scale;
+		SimpleVariableHandle Offset;
+	};
+
+	/// <summary>
+	/// Registers a pixel shader with a 48 byte material buffer, five textures and two samplers.
+	/// </summary>
+	void AddShaders(void)
+	{
+		MockShaders::Add(L"MaterialBenchmarkVS.cso", {});
+		MockShaders::Shader pixel;
+		pixel.Buffers = { { "PerMaterial", 0, 48, { { "colorTint", 0, 16 }, { "scale", 16, 8 }, { "offset", 24, 8 }, { "roughness", 32, 4 } } } };
+		for (unsigned int t = 0; t < ARRAYSIZE(g_lTextureNames); t++) pixel.Resources.push_back({ g_lTextureNames[t], D3D_SIT_TEXTURE, t });
+		for (unsigned int s = 0; s < ARRAYSIZE(g_lSamplerNames); s++) pixel.Resources.push_back({ g_lSamplerNames[s], D3D_SIT_SAMPLER, s });
+		MockShaders::Add(L"MaterialBenchmarkPS.cso", pixel);
+	}
+
+	/// <summary>
+	/// What one draw left bound and in the material buffer.
+	/// </summary>
+	struct DrawState
+	{
+		ID3D11ShaderResourceView* Textures[ARRAYSIZE(g_lTextureNames)];
+		ID3D11SamplerState* Samplers[ARRAYSIZE(g_lSamplerNames)];
+		unsigned char Constants[48];
+	};
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = Benchmark::IsQuick(argc, argv);
+
+	AddShaders();
+	ComPtr<ID3D11Device> device(new ID3D11Device());
+	ID3D11DeviceContext1* pContext = new ID3D11DeviceContext1();
+	ComPtr<ID3D11DeviceContext> context(pContext);
+	PipelineStateCache cache;
+	cache.SetContext(pContext, pContext);
+	ISimpleShader::StateCache = &cache;
+	std::shared_ptr<SimpleVertexShader> vs = std::make_shared<SimpleVertexShader>(device, context, L"MaterialBenchmarkVS.cso");
+	std::shared_ptr<SimplePixelShader> ps = std::make_shared<SimplePixelShader>(device, context, L"MaterialBenchmarkPS.cso");
+	if (!CHECK(ps->IsShaderValid())) return Check::Report("MaterialBenchmark");
+
+	// Every material has its own textures and parameters, and shares the samplers and shadow map.
+	std::vector<ComPtr<ID3D11ShaderResourceView>> lTextures;
+	ComPtr<ID3D11ShaderResourceView> shadowMap(new ID3D11ShaderResourceView());
+	ComPtr<ID3D11SamplerState> lSamplers[] = { ComPtr<ID3D11SamplerState>(new ID3D11SamplerState()), ComPtr<ID3D11SamplerState>(new ID3D11SamplerState()) };
+	std::vector<std::unique_ptr<Material>> lMaterials;
+	std::vector<PerSlotMaterial> lPerSlot(g_uMaterialCount);
+	for (unsigned int m = 0; m < g_uMaterialCount; m++)
+	{
+		float f = static_cast<float>(m);
+		lMaterials.push_back(std::make_unique<Material>(vs, ps, XMFLOAT4(1.0f, 0.5f, f / g_uMaterialCount, 1.0f), 0.1f * f));
+		Material& material = *lMaterials.back();
+		material.SetScale(XMFLOAT2(2.0f + f, 2.0f));
+		material.SetOffset(XMFLOAT2(0.0f, 0.25f * f));
+		PerSlotMaterial& perSlot = lPerSlot[m];
+		for (unsigned int t = 0; t < ARRAYSIZE(g_lTextureNames); t++)
+		{
+			if (t + 1 < ARRAYSIZE(g_lTextureNames)) lTextures.emplace_back(new ID3D11ShaderResourceView());
+			ComPtr<ID3D11ShaderResourceView> srv = t + 1 < ARRAYSIZE(g_lTextureNames) ? lTextures.back() : shadowMap;
+			material.AddTexturesSRV(g_lTextureNames[t], srv);
+			perSlot.Textures.push_back({ ps->GetShaderResourceViewHandle(g_lTextureNames[t]), srv.Get() });
+		}
+		for (unsigned int s = 0; s < ARRAYSIZE(g_lSamplerNames); s++)
+		{
+			material.AddSampler(g_lSamplerNames[s], lSamplers[s]);
+			perSlot.Samplers.push_back({ ps->GetSamplerHandle(g_lSamplerNames[s]), lSamplers[s].Get() });
+		}
+		perSlot.ColorTint = ps->GetVariableHandle("colorTint");
+		perSlot.Roughness = ps->GetVariableHandle("roughness");
+		perSlot.Scale = ps->GetVariableHandle("scale");
+		perSlot.Offset = ps->GetVariableHandle("offset");
+	}
+
+	// A draw binds the material only when it changed, the per slot path then sets its parameters every draw.
+	auto DrawBaked = [&](unsigned int a_uMaterial, bool a_bBind)
+	{
+		if (a_bBind)
+		{
+			ps->SetShader();
+			lMaterials[a_uMaterial]->PrepMaterialForDraw();
+		}
+		ps->CopyAllBufferData();
+	};
+	auto DrawPerSlot = [&](unsigned int a_uMaterial, bool a_bBind)
+	{
+		Material& material = *lMaterials[a_uMaterial];
+		const PerSlotMaterial& perSlot = lPerSlot[a_uMaterial];
+		if (a_bBind)
+		{
+			ps->SetShader();
+			for (const auto& t : perSlot.Textures) ps->SetShaderResourceView(t.first, t.second);
+			for (const auto& s : perSlot.Samplers) ps->SetSamplerState(s.first, s.second);
+		}
+		ps->SetFloat4(perSlot.ColorTint, material.GetColor());
+		ps->SetFloat(perSlot.Roughness, material.GetRoughness());
+		ps->SetFloat2(perSlot.Scale, material.GetScale());
+		ps->SetFloat2(perSlot.Offset, material.GetOffset());
+		ps->CopyAllBufferData();
+	};
+	auto Frame = [&](auto a_fDraw, bool a_bSwitchEveryDraw, std::vector<DrawState>* a_pStates)
+	{
+		cache.BeginFrame();
+		for (unsigned int d = 0; d < g_uDrawCount; d++)
+		{
+			unsigned int uMaterial = a_bSwitchEveryDraw ? d % g_uMaterialCount : d / g_uDrawsPerMaterial;
+			a_fDraw(uMaterial, a_bSwitchEveryDraw || d % g_uDrawsPerMaterial == 0);
+			if (!a_pStates) continue;
+			DrawState& state = a_pStates->emplace_back();
+			memcpy(state.Textures, pContext->PS.ShaderResources, sizeof(state.Textures));
+			memcpy(state.Samplers, pContext->PS.Samplers, sizeof(state.Samplers));
+			memcpy(state.Constants, ps->GetBufferInfo(0u)->ConstantBuffer->Contents.data(), sizeof(state.Constants));
+		}
+	};
+
+	const unsigned int uRuns = bQuick ? 1 : 31;
+	const unsigned int uFrames = bQuick ? 1 : 2000;
+	printf("%-24s %12s %14s %16s\n", "path", "ns per draw", "binds per draw", "uploads per draw");
+	for (bool bSwitchEveryDraw : { false, true })
+	{
+		const char* sOrder = bSwitchEveryDraw ? "switching" : "sorted";
+
+		// Both paths leave the same textures, samplers and constants on the GPU for every draw.
+		std::vector<DrawState> lBaked, lPerSlotStates;
+		Frame(DrawBaked, bSwitchEveryDraw, &lBaked);
+		Frame(DrawPerSlot, bSwitchEveryDraw, &lPerSlotStates);
+		CHECK(lBaked.size() == lPerSlotStates.size() && memcmp(lBaked.data(), lPerSlotStates.data(), lBaked.size() * sizeof(DrawState)) == 0);
+
+		for (int iPath = 0; iPath < 2; iPath++)
+		{
+			// One frame first so the counts are those of a frame like the one before it.
+			bool bBaked = iPath == 0;
+			auto RunFrame = [&]() { bBaked ? Frame(DrawBaked, bSwitchEveryDraw, nullptr) : Frame(DrawPerSlot, bSwitchEveryDraw, nullptr); };
+			RunFrame();
+			unsigned int uBinds = pContext->BindCalls, uUploads = pContext->UpdateCalls;
+			RunFrame();
+			double fBinds = static_cast<double>(pContext->BindCalls - uBinds) / g_uDrawCount;
+			double fUploads = static_cast<double>(pContext->UpdateCalls - uUploads) / g_uDrawCount;
+
+			double fMs = Benchmark::MedianMs(uRuns, [&]()
+			{
+				for (unsigned int f = 0; f < uFrames; f++) RunFrame();
+			});
+			char sName[32];
+			snprintf(sName, sizeof(sName), "%s, %s", bBaked ? "baked" : "per slot", sOrder);
+			printf("%-24s %12.1f %14.2f %16.2f\n", sName, fMs * 1e6 / (static_cast<double>(uFrames) * g_uDrawCount), fBinds, fUploads);
+		}
+	}
+
+	ISimpleShader::StateCache = nullptr;
+	return Check::Report("MaterialBenchmark");
+}
@@ -0,0 +1,127 @@
+// Loads each shipped model through Mesh::Load from text and from the
+// .meshcache the first load writes, and fails unless the cache hands back
+// exactly the bytes the obj path produced.  The models are copied to a
+// temporary directory so the caches are never written next to the originals.
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "Mesh.h"
+
+namespace
+{
+	const char* g_lModels[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+
+	/// <summary>
+	/// Whether two arrays hold the same bytes.
+	/// </summary>
+	bool SameBytes(const void* a_pA, const void* a_pB, size_t a_uSize)
+	{
+		return a_uSize == 0 || memcmp(a_pA, a_pB, a_uSize) == 0;
+	}
+
+	/// <summary>
+	/// Checks that data read out of a cache matches data parsed from text.
+	/// </summary>
+	void CheckMatches(const MeshData& a_mdCached, const MeshData& a_mdParsed)
+	{
+		if (!CHECK(a_mdCached.Cache != nullptr)) return;
+		const MeshCacheHeader& header = a_mdCached.Cache->GetHeader();
+
+		CHECK(a_mdCached.VertexCount == a_mdParsed.VertexCount);
+		CHECK(a_mdCached.IndexCount == a_mdParsed.IndexCount);
+		CHECK(a_mdCached.IndexStride == a_mdParsed.IndexStride);
+		CHECK(a_mdCached.UnweldedVertexCount == a_mdParsed.UnweldedVertexCount);
+		CHECK(SameBytes(&a_mdCached.LoadedStats, &a_mdParsed.LoadedStats, sizeof(VertexCacheStats)));
+		CHECK(SameBytes(&a_mdCached.OptimizedStats, &a_mdParsed.OptimizedStats, sizeof(VertexCacheStats)));
+		CHECK(SameBytes(&a_mdCached.BoundsMin, &a_mdParsed.BoundsMin, sizeof(DirectX::XMFLOAT3)));
+		CHECK(SameBytes(&a_mdCached.BoundsMax, &a_mdParsed.BoundsMax, sizeof(DirectX::XMFLOAT3)));
+		CHECK(SameBytes(&a_mdCached.SphereCenter, &a_mdParsed.SphereCenter, sizeof(DirectX::XMFLOAT3)));
+		CHECK(a_mdCached.SphereRadius == a_mdParsed.SphereRadius);
+		CHECK(a_mdCached.LodCount == a_mdParsed.LodCount);
+		CHECK(SameBytes(a_mdCached.Lods, a_mdParsed.Lods, sizeof(MeshLod) * a_mdParsed.LodCount));
+
+		CHECK(header.VertexCount == a_mdParsed.Vertices.size());
+		CHECK(SameBytes(a_mdCached.Cache->GetVertices(), a_mdParsed.Vertices.data(), sizeof(Vertex) * a_mdParsed.Vertices.size()));
+
+		const void* pIndices = a_mdParsed.IndexStride == sizeof(uint16_t) ?
+			static_cast<const void*>(a_mdParsed.NarrowedIndices.data()) :
+			static_cast<const void*>(a_mdParsed.Indices.data());
+		CHECK(SameBytes(a_mdCached.Cache->GetIndices(), pIndices, static_cast<size_t>(a_mdParsed.IndexStride) * a_mdParsed.IndexCount));
+
+		CHECK(header.MeshletCount == a_mdParsed.Meshlets.size());
+		CHECK(SameBytes(a_mdCached.Cache->GetMeshlets(), a_mdParsed.Meshlets.data(), sizeof(Meshlet) * a_mdParsed.Meshlets.size()));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int uRuns = Benchmark::IsQuick(argc, argv) ? 1 : 25;
+
+	std::filesystem::path pDirectory = std::filesystem::temp_directory_path() / "MeshCacheBenchmark";
+	std::filesystem::create_directories(pDirectory);
+
+	// The default options, then everything a cache can hold.
+	MeshLoadOptions lOptions[2] = {};
+	lOptions[1].GenerateLods = true;
+	lOptions[1].BuildMeshlets = true;
+
+	printf("%-18s %-9s %8s %10s %10s %10s %8s\n", "model", "options", "verts", "cache KB", "obj ms", "cache ms", "speedup");
+	for (const char* sModel : g_lModels)
+	{
+		std::filesystem::path pSource = pDirectory / (std::string(sModel) + ".graphics_obj");
+		std::filesystem::copy_file(std::string(MODELS_DIR) + sModel + ".graphics_obj", pSource, std::filesystem::copy_options::overwrite_existing);
+		std::string sSource = pSource.string();
+		std::string sCache = MeshCache::GetCachePath(sSource.c_str());
+
+		for (int o = 0; o < 2; o++)
+		{
+			MeshLoadOptions mloOptions = lOptions[o];
+			mloOptions.UseBinaryCache = false;
+			MeshData mdParsed = Mesh::Load(sSource.c_str(), mloOptions);
+
+			// The first cached load parses the text and writes the cache, the second maps it.
+			mloOptions.UseBinaryCache = true;
+			std::filesystem::remove(sCache);
+			MeshData mdWritten = Mesh::Load(sSource.c_str(), mloOptions);
+			CHECK(mdWritten.Cache == nullptr);
+			CHECK(std::filesystem::exists(sCache));
+			MeshData mdCached = Mesh::Load(sSource.c_str(), mloOptions);
+			CheckMatches(mdCached, mdParsed);
+
+			// A cache built with other options must not be used.
+			MeshLoadOptions mloOther = mloOptions;
+			mloOther.BuildMeshlets = !mloOther.BuildMeshlets;
+			CHECK(Mesh::Load(sSource.c_str(), mloOther).Cache == nullptr);
+			Mesh::Load(sSource.c_str(), mloOptions);
+
+			mloOptions.UseBinaryCache = false;
+			double fObjMs = Benchmark::MedianMs(uRuns, [&]() { Mesh::Load(sSource.c_str(), mloOptions); });
+			mloOptions.UseBinaryCache = true;
+			double fCacheMs = Benchmark::MedianMs(uRuns, [&]() { Mesh::Load(sSource.c_str(), mloOptions); });
+
+			printf("%-18s %-9s %8d %10.1f %10.3f %10.3f %7.1fx\n", sModel, o == 0 ? "default" : "all",
+				mdParsed.VertexCount, std::filesystem::file_size(sCache) / 1024.0, fObjMs, fCacheMs, fObjMs / fCacheMs);
+		}
+
+		// Only the header is checked on load, but a cache cut short is still refused.
+		MeshLoadOptions mloOptions = lOptions[0];
+		mloOptions.UseBinaryCache = true;
+		Mesh::Load(sSource.c_str(), mloOptions);
+		std::filesystem::resize_file(sCache, std::filesystem::file_size(sCache) - 1);
+		CHECK(Mesh::Load(sSource.c_str(), mloOptions).Cache == nullptr);
+
+		// Touching the obj file makes the cache stale.
+		Mesh::Load(sSource.c_str(), mloOptions);
+		std::filesystem::last_write_time(pSource, std::filesystem::last_write_time(pSource) + std::chrono::seconds(5));
+		CHECK(Mesh::Load(sSource.c_str(), mloOptions).Cache == nullptr);
+	}
+
+	std::filesystem::remove_all(pDirectory);
+	return Check::Report("MeshCacheBenchmark");
+}
@@ -0,0 +1,99 @@
+// Runs the shipped models through the vertex cache optimization Mesh does at
+// load and fails if the simulated cache misses regress past the thresholds
+// below, or if the reordering loses or changes a triangle.
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "MeshOptimizer.h"
+#include "ObjLoader.h"
+
+namespace
+{
+	/// <summary>
+	/// A model and the worst 16 entry FIFO ACMR its optimized order may have.
+	/// Raise a threshold only on purpose: the optimizer was measured under each.
+	/// </summary>
+	struct ModelThreshold
+	{
+		const char* Name;
+		float MaxACMR;
+	};
+
+	const ModelThreshold g_lModels[] =
+	{
+		{ "cube", 2.00f },
+		{ "cylinder", 1.10f },
+		{ "helix", 1.02f },
+		{ "sphere", 0.74f },
+		{ "torus", 0.69f },
+	};
+
+	typedef std::array<unsigned int, 3> Triangle;
+
+	/// <summary>
+	/// Gets a triangle list's triangles in a canonical order, each rotated to
+	/// start at its smallest index so the winding is kept.
+	/// </summary>
+	std::vector<Triangle> SortedTriangles(const std::vector<unsigned int>& a_lIndices)
+	{
+		std::vector<Triangle> lTriangles;
+		for (size_t i = 0; i + 2 < a_lIndices.size(); i += 3)
+		{
+			Triangle t = { a_lIndices[i], a_lIndices[i + 1], a_lIndices[i + 2] };
+			std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+			lTriangles.push_back(t);
+		}
+		std::sort(lTriangles.begin(), lTriangles.end());
+		return lTriangles;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int uRuns = Benchmark::IsQuick(argc, argv) ? 1 : 25;
+
+	printf("%-10s %8s %12s %12s %9s %10s\n", "model", "tris", "ACMR before", "ACMR after", "limit", "optimize ms");
+	for (const ModelThreshold& mtModel : g_lModels)
+	{
+		std::vector<Vertex> lVertices;
+		std::vector<unsigned int> lIndices;
+		CHECK(ObjLoader::Load((std::string(MODELS_DIR) + mtModel.Name + ".graphics_obj").c_str(), lVertices, lIndices));
+		VertexCacheStats vcsBefore = MeshOptimizer::AnalyzeVertexCache(lIndices.data(), lIndices.size(), lVertices.size());
+
+		std::vector<unsigned int> lOptimized;
+		double fOptimizeMs = Benchmark::MedianMs(uRuns, [&]()
+		{
+			lOptimized = lIndices;
+			MeshOptimizer::OptimizeVertexCache(lOptimized.data(), lOptimized.size(), lVertices.size());
+		});
+		VertexCacheStats vcsAfter = MeshOptimizer::AnalyzeVertexCache(lOptimized.data(), lOptimized.size(), lVertices.size());
+
+		// Same triangles with the same winding, only reordered.
+		CHECK(SortedTriangles(lOptimized) == SortedTriangles(lIndices));
+		CHECK(vcsAfter.ACMR <= vcsBefore.ACMR);
+		CHECK(vcsAfter.ACMR <= mtModel.MaxACMR);
+
+		// Renumbering vertices for fetch order must not change what gets drawn.
+		std::vector<Vertex> lFetchVertices = lVertices;
+		std::vector<unsigned int> lFetchIndices = lOptimized;
+		size_t uKept = MeshOptimizer::OptimizeVertexFetch(lFetchVertices.data(), lFetchVertices.size(), lFetchIndices.data(), lFetchIndices.size());
+		bool bSameCorners = CHECK(uKept <= lVertices.size());
+		for (size_t i = 0; bSameCorners && i < lFetchIndices.size(); i++)
+		{
+			bSameCorners = lFetchIndices[i] < uKept &&
+				memcmp(&lFetchVertices[lFetchIndices[i]], &lVertices[lOptimized[i]], sizeof(Vertex)) == 0;
+		}
+		CHECK(bSameCorners);
+		CHECK(MeshOptimizer::AnalyzeVertexCache(lFetchIndices.data(), lFetchIndices.size(), uKept).ACMR == vcsAfter.ACMR);
+
+		printf("%-10s %8zu %12.3f %12.3f %9.2f %10.3f\n", mtModel.Name, lIndices.size() / 3, vcsBefore.ACMR, vcsAfter.ACMR, mtModel.MaxACMR, fOptimizeMs);
+	}
+
+	return Check::Report("MeshOptimizerBenchmark");
+}
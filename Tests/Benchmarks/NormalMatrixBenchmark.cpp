@@ -0,0 +1,136 @@
+// Times Transform's directly built inverse transpose against the general
+// inverse it used before, and fails if it is less accurate against a double
+// precision reference or if degenerate scales stop falling back.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "DoubleMath.h"
+#include "Transform.h"
+#include "TransformSystem.h"
+
+using namespace DirectX;
+
+namespace
+{
+	// Largest error allowed relative to the largest element of the matrix.  The
+	// translations and small scales here put elements around 1e4 in the last
+	// column, so this is float rounding on those.
+	const double g_fMaxRelativeError = 5e-5;
+
+	/// <summary>
+	/// What Transform did before: both matrices from the general inverse.
+	/// </summary>
+	void GeneralInverse(const XMFLOAT3& a_v3Position, const XMFLOAT3& a_v3Rotation, const XMFLOAT3& a_v3Scale, XMFLOAT4X4& a_m4World, XMFLOAT4X4& a_m4Normal)
+	{
+		XMMATRIX world =
+			XMMatrixScaling(a_v3Scale.x, a_v3Scale.y, a_v3Scale.z) *
+			XMMatrixRotationRollPitchYaw(a_v3Rotation.x, a_v3Rotation.y, a_v3Rotation.z) *
+			XMMatrixTranslation(a_v3Position.x, a_v3Position.y, a_v3Position.z);
+		XMStoreFloat4x4(&a_m4World, world);
+		XMStoreFloat4x4(&a_m4Normal, XMMatrixInverse(0, XMMatrixTranspose(world)));
+	}
+
+	bool SameMatrix(const XMFLOAT4X4& a_m4A, const XMFLOAT4X4& a_m4B)
+	{
+		return memcmp(&a_m4A, &a_m4B, sizeof(XMFLOAT4X4)) == 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = Benchmark::IsQuick(argc, argv);
+	const unsigned int uCount = bQuick ? 10000 : 100000;
+
+	// Translations up to 300, scales from 0.03 to 30 and some mirrored axes.
+	std::mt19937 rng(9);
+	std::uniform_real_distribution<float> fPosition(-300.0f, 300.0f);
+	std::uniform_real_distribution<float> fAngle(-XM_PI, XM_PI);
+	std::uniform_real_distribution<float> fLogScale(std::log(0.03f), std::log(30.0f));
+	std::vector<Transform> lTransforms(uCount);
+	for (unsigned int i = 0; i < uCount; i++)
+	{
+		float fSign = i % 5 == 0 ? -1.0f : 1.0f;
+		lTransforms[i].SetPosition(fPosition(rng), fPosition(rng), fPosition(rng));
+		lTransforms[i].SetRotation(fAngle(rng), fAngle(rng), fAngle(rng));
+		lTransforms[i].SetScale(std::exp(fLogScale(rng)), fSign * std::exp(fLogScale(rng)), std::exp(fLogScale(rng)));
+	}
+
+	double fDirectError = 0.0;
+	double fGeneralError = 0.0;
+	for (Transform& transform : lTransforms)
+	{
+		DoubleMath::Matrix mWorld = DoubleMath::World(transform.GetPosition(), transform.GetRotation(), transform.GetScale());
+		DoubleMath::Matrix mNormal = DoubleMath::Transpose(DoubleMath::Inverse(mWorld));
+		XMFLOAT4X4 m4World, m4Normal;
+		GeneralInverse(transform.GetPosition(), transform.GetRotation(), transform.GetScale(), m4World, m4Normal);
+		fDirectError = std::max(fDirectError, DoubleMath::RelativeError(transform.GetWorldInverseTransposeMatrix(), mNormal));
+		fGeneralError = std::max(fGeneralError, DoubleMath::RelativeError(m4Normal, mNormal));
+	}
+	printf("%u transforms, largest error relative to the largest element\n", uCount);
+	printf("direct %.3g, general inverse %.3g\n", fDirectError, fGeneralError);
+	CHECK(fDirectError <= g_fMaxRelativeError);
+	CHECK(fDirectError <= 2.0 * fGeneralError);
+
+	// A zero scale has no inverse, both Transform and TransformSystem leave it to the general one.
+	XMFLOAT3 v3Position(4.0f, -2.0f, 7.0f);
+	XMFLOAT3 v3Rotation(0.3f, 1.1f, -0.4f);
+	XMFLOAT3 v3Scale(2.0f, 0.0f, 1.5f);
+	CHECK(Transform::HasDegenerateScale(v3Scale));
+	Transform degenerate;
+	degenerate.SetPosition(v3Position);
+	degenerate.SetRotation(v3Rotation);
+	degenerate.SetScale(v3Scale);
+	XMFLOAT4X4 m4World, m4Normal;
+	GeneralInverse(v3Position, v3Rotation, v3Scale, m4World, m4Normal);
+	CHECK(SameMatrix(degenerate.GetWorldInverseTransposeMatrix(), m4Normal));
+
+	TransformSystem system;
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		// The degenerate one shares a batch with three that are fine.
+		unsigned int uIndex = system.Create();
+		system.SetPosition(uIndex, lTransforms[i].GetPosition());
+		system.SetRotation(uIndex, lTransforms[i].GetRotation());
+		system.SetScale(uIndex, i == 2 ? v3Scale : lTransforms[i].GetScale());
+	}
+	system.Update();
+	const XMFLOAT4X4& m4SystemNormal = system.GetWorldInverseTransposeMatrix(2);
+	bool bSameFiniteness = true;
+	for (int r = 0; r < 4; r++)
+		for (int c = 0; c < 4; c++) bSameFiniteness &= std::isfinite(m4SystemNormal.m[r][c]) == std::isfinite(m4Normal.m[r][c]);
+	CHECK(bSameFiniteness);
+	for (unsigned int i : { 0u, 1u, 3u })
+	{
+		DoubleMath::Matrix mWorld = DoubleMath::World(lTransforms[i].GetPosition(), lTransforms[i].GetRotation(), lTransforms[i].GetScale());
+		CHECK(DoubleMath::RelativeError(system.GetWorldInverseTransposeMatrix(i), DoubleMath::Transpose(DoubleMath::Inverse(mWorld))) <= g_fMaxRelativeError);
+	}
+
+	// Rebuilding every transform's matrices, as a frame where everything moves.
+	unsigned int uRuns = bQuick ? 1 : 15;
+	XMFLOAT4X4 m4Sink = {};
+	double fGeneralMs = Benchmark::MedianMs(uRuns, [&]()
+	{
+		for (Transform& transform : lTransforms)
+		{
+			GeneralInverse(transform.GetPosition(), transform.GetRotation(), transform.GetScale(), m4World, m4Sink);
+		}
+	});
+	double fDirectMs = Benchmark::MedianMs(uRuns, [&]()
+	{
+		for (Transform& transform : lTransforms)
+		{
+			transform.Rotate(0.0f, 0.0f, 0.0f);
+			m4Sink = transform.GetWorldInverseTransposeMatrix();
+		}
+	});
+	printf("world and normal matrix of every transform: general inverse %.2f ms, direct %.2f ms, %.2fx\n", fGeneralMs, fDirectMs, fGeneralMs / fDirectMs);
+
+	return Check::Report("NormalMatrixBenchmark");
+}
@@ -0,0 +1,163 @@
+// Times ObjLoader against the getline/sscanf loop Mesh(const char*) used to
+// run, and checks both produce the same triangles, bit for bit, for every
+// shipped model.  Reading the file is timed apart from welding its corners,
+// which the old loop never did, so the parse column compares like with like.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "MappedFile.h"
+#include "ObjLoader.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const char* const g_lModels[] =
+	{
+		"cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus"
+	};
+
+	/// <summary>
+	/// The original parsing loop, with sscanf in place of MSVC's sscanf_s.  It
+	/// emits three unshared vertices per triangle.
+	/// </summary>
+	bool LoadReference(const char* a_sFilepath, std::vector<Vertex>& a_lVertices)
+	{
+		std::ifstream obj(a_sFilepath);
+		if (!obj.is_open()) return false;
+
+		std::vector<XMFLOAT3> positions;
+		std::vector<XMFLOAT3> normals;
+		std::vector<XMFLOAT2> uvs;
+		char chars[100];
+		a_lVertices.clear();
+
+		while (obj.good())
+		{
+			obj.getline(chars, 100);
+
+			if (chars[0] == 'v' && chars[1] == 'n')
+			{
+				XMFLOAT3 norm;
+				sscanf(chars, "vn %f %f %f", &norm.x, &norm.y, &norm.z);
+				normals.push_back(norm);
+			}
+			else if (chars[0] == 'v' && chars[1] == 't')
+			{
+				XMFLOAT2 uv;
+				sscanf(chars, "vt %f %f", &uv.x, &uv.y);
+				uvs.push_back(uv);
+			}
+			else if (chars[0] == 'v')
+			{
+				XMFLOAT3 pos;
+				sscanf(chars, "v %f %f %f", &pos.x, &pos.y, &pos.z);
+				positions.push_back(pos);
+			}
+			else if (chars[0] == 'f')
+			{
+				unsigned int i[12];
+				int numbersRead = sscanf(
+					chars,
+					"f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u",
+					&i[0], &i[1], &i[2],
+					&i[3], &i[4], &i[5],
+					&i[6], &i[7], &i[8],
+					&i[9], &i[10], &i[11]);
+				if (numbersRead == 1)
+				{
+					numbersRead = sscanf(
+						chars,
+						"f %u//%u %u//%u %u//%u %u//%u",
+						&i[0], &i[2],
+						&i[3], &i[5],
+						&i[6], &i[8],
+						&i[9], &i[11]);
+					i[1] = 1;
+					i[4] = 1;
+					i[7] = 1;
+					i[10] = 1;
+					if (uvs.size() == 0) uvs.push_back(XMFLOAT2(0, 0));
+				}
+
+				Vertex corners[4] = {};
+				int cornerCount = numbersRead == 12 || numbersRead == 8 ? 4 : 3;
+				for (int c = 0; c < cornerCount; c++)
+				{
+					corners[c].Position = positions[i[c * 3] - 1];
+					corners[c].UV = uvs[i[c * 3 + 1] - 1];
+					corners[c].Normal = normals[i[c * 3 + 2] - 1];
+					corners[c].UV.y = 1.0f - corners[c].UV.y;
+					corners[c].Position.z *= -1.0f;
+					corners[c].Normal.z *= -1.0f;
+				}
+
+				// Flipping the winding order.
+				a_lVertices.push_back(corners[0]);
+				a_lVertices.push_back(corners[2]);
+				a_lVertices.push_back(corners[1]);
+				if (cornerCount == 4)
+				{
+					a_lVertices.push_back(corners[0]);
+					a_lVertices.push_back(corners[3]);
+					a_lVertices.push_back(corners[2]);
+				}
+			}
+		}
+		return true;
+	}
+
+	bool SameCorner(const Vertex& a_vA, const Vertex& a_vB)
+	{
+		return memcmp(&a_vA.Position, &a_vB.Position, sizeof(XMFLOAT3)) == 0 &&
+			memcmp(&a_vA.Normal, &a_vB.Normal, sizeof(XMFLOAT3)) == 0 &&
+			memcmp(&a_vA.UV, &a_vB.UV, sizeof(XMFLOAT2)) == 0;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int uRuns = Benchmark::IsQuick(argc, argv) ? 1 : 25;
+
+	printf("%-18s %8s %10s %10s %10s %10s %8s %8s\n", "model", "tris", "sscanf ms", "parse ms", "weld ms", "load ms", "parse x", "load x");
+	for (const char* sModel : g_lModels)
+	{
+		std::string sPath = std::string(MODELS_DIR) + sModel + ".graphics_obj";
+
+		std::vector<Vertex> lReference;
+		std::vector<Vertex> lVertices;
+		std::vector<unsigned int> lIndices;
+		double fReferenceMs = Benchmark::MedianMs(uRuns, [&]() { LoadReference(sPath.c_str(), lReference); });
+		double fLoaderMs = Benchmark::MedianMs(uRuns, [&]() { ObjLoader::Load(sPath.c_str(), lVertices, lIndices); });
+
+		// The same load in its two halves, mapping the file counted with parsing as the old loop counted reading it.
+		ObjLoader::Contents cContents;
+		double fParseMs = Benchmark::MedianMs(uRuns, [&]()
+		{
+			MappedFile file(sPath.c_str());
+			ObjLoader::Tokenize(file.GetData(), file.GetSize(), cContents);
+		});
+		std::vector<Vertex> lWelded;
+		std::vector<unsigned int> lWeldedIndices;
+		double fWeldMs = Benchmark::MedianMs(uRuns, [&]() { ObjLoader::Weld(cContents, lWelded, lWeldedIndices); });
+		CHECK(lWeldedIndices == lIndices && lWelded.size() == lVertices.size());
+
+		// Both should give the same corners in the same order, ObjLoader just shares them.
+		bool bSame = CHECK(lIndices.size() == lReference.size());
+		for (size_t i = 0; bSame && i < lIndices.size(); i++)
+		{
+			bSame = SameCorner(lVertices[lIndices[i]], lReference[i]);
+		}
+		CHECK(bSame);
+
+		printf("%-18s %8zu %10.3f %10.3f %10.3f %10.3f %7.1fx %7.1fx\n", sModel, lIndices.size() / 3,
+			fReferenceMs, fParseMs, fWeldMs, fLoaderMs, fReferenceMs / fParseMs, fReferenceMs / fLoaderMs);
+	}
+
+	return Check::Report("ObjLoaderBenchmark");
+}
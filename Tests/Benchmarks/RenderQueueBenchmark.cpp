@@ -0,0 +1,94 @@
+// Times RenderQueue's radix sort against std::stable_sort on 1k, 10k and 100k
+// keys, both random and shaped like a scene's (two passes and a handful of
+// shaders), inline and on 4 workers.  Fails if any order differs from
+// std::stable_sort's, ties included, or if sorting a frame of interleaved
+// draws does not cut its state changes.
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "RenderQueue.h"
+
+namespace
+{
+	/// <summary>
+	/// Keys as a frame would build them, so the pass and shader bytes are mostly shared.
+	/// </summary>
+	uint64_t SceneKey(std::mt19937_64& a_rng)
+	{
+		return (static_cast<uint64_t>(a_rng() % 2) << RenderQueue::PASS_SHIFT) |
+			((a_rng() % 16) << RenderQueue::SHADER_SHIFT) |
+			((a_rng() % 256) << RenderQueue::MATERIAL_SHIFT) |
+			((a_rng() % 512) << RenderQueue::MESH_SHIFT) |
+			(a_rng() % (1u << RenderQueue::DEPTH_BITS));
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = Benchmark::IsQuick(argc, argv);
+	std::mt19937_64 rng(7);
+	JobSystem jobs(4);
+
+	printf("%-10s %7s %13s %15s %17s\n", "keys", "count", "radix ms", "radix 4 jobs ms", "stable_sort ms");
+	for (bool bRandom : { false, true })
+	{
+		for (size_t uCount : { size_t(1000), size_t(10000), size_t(100000) })
+		{
+			std::vector<uint64_t> lOriginal(uCount);
+			for (uint64_t& uKey : lOriginal) uKey = bRandom ? rng() : SceneKey(rng);
+
+			// The reference order, with each key's position as its value.
+			std::vector<std::pair<uint64_t, uint32_t>> lPairs(uCount);
+			double fStableMs = Benchmark::MedianMs(bQuick ? 1 : 21, [&]()
+			{
+				for (size_t i = 0; i < uCount; i++) lPairs[i] = { lOriginal[i], static_cast<uint32_t>(i) };
+				std::stable_sort(lPairs.begin(), lPairs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+			});
+			std::vector<uint32_t> lExpected(uCount);
+			for (size_t i = 0; i < uCount; i++) lExpected[i] = lPairs[i].second;
+
+			std::vector<uint64_t> lKeys(uCount), lScratchKeys(uCount);
+			std::vector<uint32_t> lValues(uCount), lScratchValues(uCount);
+			double lRadixMs[2];
+			for (int iJobs = 0; iJobs < 2; iJobs++)
+			{
+				lRadixMs[iJobs] = Benchmark::MedianMs(bQuick ? 1 : 21, [&]()
+				{
+					lKeys = lOriginal;
+					for (size_t i = 0; i < uCount; i++) lValues[i] = static_cast<uint32_t>(i);
+					RenderQueue::RadixSort(lKeys.data(), lValues.data(), uCount, lScratchKeys.data(), lScratchValues.data(), iJobs ? &jobs : nullptr);
+				});
+				CHECK(lValues == lExpected);
+			}
+
+			printf("%-10s %7zu %13.3f %15.3f %17.3f\n", bRandom ? "random" : "scene-like", uCount, lRadixMs[0], lRadixMs[1], fStableMs);
+		}
+	}
+
+	// A frame of 700 draws added with shadow and opaque, materials and meshes interleaved.
+	int lShaders[2], lMaterials[7], lMeshes[4];
+	RenderQueue queue;
+	for (uint32_t i = 0; i < 700; i++)
+	{
+		bool bOpaque = i % 2 == 1;
+		queue.Add(queue.MakeKey(bOpaque ? RenderPass::Opaque : RenderPass::Shadow, &lShaders[i % 2],
+			bOpaque ? &lMaterials[i % 7] : nullptr, &lMeshes[i % 7 % 4], static_cast<float>(rng() % 100)), i);
+	}
+	queue.Sort(&jobs);
+	size_t uFirst, uLast;
+	queue.GetPassRange(RenderPass::Opaque, uFirst, uLast);
+	CHECK(uFirst == 350 && uLast == 700);
+	const RenderQueueStats& stats = queue.GetStats();
+	printf("\n700 interleaved draws: %u -> %u state changes, %u -> %u mesh changes\n",
+		stats.UnsortedStateChanges, stats.StateChanges, stats.UnsortedMeshChanges, stats.MeshChanges);
+	CHECK(stats.StateChanges < stats.UnsortedStateChanges);
+	CHECK(stats.MeshChanges < stats.UnsortedMeshChanges);
+
+	return Check::Report("RenderQueueBenchmark");
+}
@@ -0,0 +1,230 @@
+// Times a frame of PBR draws with the lights, ambient and camera written into
+// every draw's pixel shader, as Game::Draw and Entity did before, and with
+// SceneConstants uploading them once into the shared buffers.  Fails if the two
+// leave different lights or camera on the GPU, if SceneConstants uploads a
+// frame that did not change, or sends the lights again when only the camera moved.
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "Graphics.h"
+#include "Material.h"
+#include "SceneConstants.h"
+
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+	const unsigned int g_uEntityCount = 10000;
+	const unsigned int g_uMaterialCount = 7;
+	const unsigned int g_uLightCount = 3;
+
+	const char* g_lTextureNames[] = { "Albedo", "NormalMap", "RoughnessMap", "MetalnessMap" };
+
+	/// <summary>
+	/// Registers PBRPixelShader.hlsl with its split buffers from before, and as it is now.
+	/// </summary>
+	void AddShaders(void)
+	{
+		MockShaders::Add(L"SceneConstantsBenchmarkVS.cso", {});
+
+		std::vector<MockShaders::Resource> lResources;
+		for (unsigned int t = 0; t < ARRAYSIZE(g_lTextureNames); t++) lResources.push_back({ g_lTextureNames[t], D3D_SIT_TEXTURE, t });
+		lResources.push_back({ "ShadowMap", D3D_SIT_TEXTURE, SceneConstants::SHADOW_MAP_SLOT });
+		lResources.push_back({ "BasicSampler", D3D_SIT_SAMPLER, 0 });
+		lResources.push_back({ "ShadowSampler", D3D_SIT_SAMPLER, SceneConstants::SHADOW_SAMPLER_SLOT });
+		MockShaders::Buffer material = { "PerMaterial", 0, 16, { { "scale", 0, 8 }, { "offset", 8, 8 } } };
+
+		MockShaders::Shader before;
+		before.Buffers =
+		{
+			material,
+			{ "PerView", 1, 16, { { "cameraPosition", 0, 12 }, { "padding", 12, 4 } } },
+			{ "PerFrame", 2, sizeof(Light) * MAX_LIGHT_COUNT, { { "lights", 0, sizeof(Light) * MAX_LIGHT_COUNT } } },
+		};
+		before.Resources = lResources;
+		MockShaders::Add(L"SceneConstantsBenchmarkBeforePS.cso", before);
+
+		MockShaders::Shader after;
+		after.Buffers =
+		{
+			material,
+			{ SceneConstants::VIEW_BUFFER_NAME, SceneConstants::VIEW_BUFFER_SLOT, sizeof(ViewConstantData), { { "cameraPosition", 0, 12 }, { "cameraPadding", 12, 4 } } },
+			{ SceneConstants::BUFFER_NAME, SceneConstants::BUFFER_SLOT, sizeof(SceneConstantData),
+				{ { "ambient", 0, 12 }, { "ambientPadding", 12, 4 }, { "lights", 16, sizeof(Light) * MAX_LIGHT_COUNT } } },
+		};
+		after.Resources = lResources;
+		MockShaders::Add(L"SceneConstantsBenchmarkAfterPS.cso", after);
+	}
+
+	/// <summary>
+	/// Seven materials on one pixel shader, carrying the shadow map themselves when asked to.
+	/// </summary>
+	std::vector<std::shared_ptr<Material>> MakeMaterials(std::shared_ptr<SimpleVertexShader> a_pVS, std::shared_ptr<SimplePixelShader> a_pPS,
+		ComPtr<ID3D11SamplerState> a_pSampler, ComPtr<ID3D11ShaderResourceView> a_pShadowMap, ComPtr<ID3D11SamplerState> a_pShadowSampler, bool a_bWithShadowMap)
+	{
+		std::vector<std::shared_ptr<Material>> lMaterials;
+		for (unsigned int m = 0; m < g_uMaterialCount; m++)
+		{
+			std::shared_ptr<Material> material = std::make_shared<Material>(a_pVS, a_pPS, XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f), 0.0f);
+			material->AddSampler("BasicSampler", a_pSampler);
+			for (const char* sName : g_lTextureNames) material->AddTexturesSRV(sName, ComPtr<ID3D11ShaderResourceView>(new ID3D11ShaderResourceView()));
+			if (a_bWithShadowMap)
+			{
+				material->AddSampler("ShadowSampler", a_pShadowSampler);
+				material->AddTexturesSRV("ShadowMap", a_pShadowMap);
+			}
+			material->SetScale(XMFLOAT2(1.0f + m, 1.0f));
+			lMaterials.push_back(material);
+		}
+		return lMaterials;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = Benchmark::IsQuick(argc, argv);
+
+	AddShaders();
+	Graphics::Device = ComPtr<ID3D11Device>(new ID3D11Device());
+	ID3D11DeviceContext1* pContext = new ID3D11DeviceContext1();
+	Graphics::Context = ComPtr<ID3D11DeviceContext>(pContext);
+	Graphics::StateCache.SetContext(pContext, pContext);
+	ISimpleShader::StateCache = &Graphics::StateCache;
+
+	// The shader from before is loaded first, so that it keeps its own copy of every buffer.
+	std::shared_ptr<SimpleVertexShader> vs = std::make_shared<SimpleVertexShader>(Graphics::Device, Graphics::Context, L"SceneConstantsBenchmarkVS.cso");
+	std::shared_ptr<SimplePixelShader> psBefore = std::make_shared<SimplePixelShader>(Graphics::Device, Graphics::Context, L"SceneConstantsBenchmarkBeforePS.cso");
+	ISimpleShader::SharedConstantBufferNames = { SceneConstants::BUFFER_NAME, SceneConstants::VIEW_BUFFER_NAME };
+	std::shared_ptr<SimplePixelShader> psAfter = std::make_shared<SimplePixelShader>(Graphics::Device, Graphics::Context, L"SceneConstantsBenchmarkAfterPS.cso");
+	if (!CHECK(psBefore->IsShaderValid() && psAfter->IsShaderValid())) return Check::Report("SceneConstantsBenchmark");
+
+	ComPtr<ID3D11SamplerState> sampler(new ID3D11SamplerState()), shadowSampler(new ID3D11SamplerState());
+	ComPtr<ID3D11ShaderResourceView> shadowMap(new ID3D11ShaderResourceView());
+	std::vector<std::shared_ptr<Material>> lBeforeMaterials = MakeMaterials(vs, psBefore, sampler, shadowMap, shadowSampler, true);
+	std::vector<std::shared_ptr<Material>> lAfterMaterials = MakeMaterials(vs, psAfter, sampler, shadowMap, shadowSampler, false);
+	SceneConstants scene;
+	scene.SetShadowMap(shadowMap, shadowSampler);
+
+	std::vector<Light> lLights(g_uLightCount);
+	for (unsigned int l = 0; l < g_uLightCount; l++)
+	{
+		lLights[l] = {};
+		lLights[l].Type = LIGHT_TYPE_POINT;
+		lLights[l].Position = XMFLOAT3(static_cast<float>(l), 2.0f, 0.0f);
+		lLights[l].Intensity = 1.0f;
+		lLights[l].Color = XMFLOAT3(1.0f, 1.0f, 1.0f);
+	}
+	const XMFLOAT3 v3Ambient(0.1f, 0.1f, 0.1f);
+
+	// What Game::Draw and Entity wrote before, through the handles the material held.
+	SimpleVariableHandle hAmbient = psBefore->GetVariableHandle("ambient");
+	SimpleVariableHandle hLights = psBefore->GetVariableHandle("lights");
+	SimpleVariableHandle hTotalTime = psBefore->GetVariableHandle("totalTime");
+	SimpleVariableHandle hCameraPosition = psBefore->GetVariableHandle("cameraPosition");
+
+	auto SceneBefore = [&](const XMFLOAT3&)
+	{
+		for (unsigned int e = 0; e < g_uEntityCount; e++)
+		{
+			SimplePixelShader* ps = lBeforeMaterials[e % g_uMaterialCount]->GetPixelShader().get();
+			ps->SetFloat3(hAmbient, v3Ambient);
+			ps->SetData(hLights, lLights.data(), sizeof(Light) * g_uLightCount);
+		}
+	};
+	auto SceneAfter = [&](const XMFLOAT3& a_v3Camera)
+	{
+		scene.Update(v3Ambient, a_v3Camera, lLights.data(), g_uLightCount);
+		scene.Bind();
+	};
+
+	// Draws sorted by material, as the render queue leaves them.
+	auto Draws = [&](const std::vector<std::shared_ptr<Material>>& a_lMaterials, bool a_bBefore, float a_fTime, const XMFLOAT3& a_v3Camera)
+	{
+		for (unsigned int e = 0; e < g_uEntityCount; e++)
+		{
+			unsigned int uMaterial = e * g_uMaterialCount / g_uEntityCount;
+			SimplePixelShader* ps = a_lMaterials[uMaterial]->GetPixelShader().get();
+			if (e == 0 || (e - 1) * g_uMaterialCount / g_uEntityCount != uMaterial)
+			{
+				ps->SetShader();
+				a_lMaterials[uMaterial]->PrepMaterialForDraw();
+			}
+			if (a_bBefore)
+			{
+				ps->SetFloat(hTotalTime, a_fTime);
+				ps->SetFloat3(hCameraPosition, a_v3Camera);
+			}
+			ps->CopyAllBufferData();
+		}
+	};
+	auto Frame = [&](bool a_bBefore, unsigned int a_uFrame)
+	{
+		XMFLOAT3 v3Camera(0.01f * a_uFrame, 1.0f, -5.0f);
+		Graphics::StateCache.BeginFrame();
+		a_bBefore ? SceneBefore(v3Camera) : SceneAfter(v3Camera);
+		Draws(a_bBefore ? lBeforeMaterials : lAfterMaterials, a_bBefore, a_uFrame / 60.0f, v3Camera);
+	};
+
+	// Both leave the same camera and lights where the shader reads them.
+	Frame(true, 1);
+	std::vector<unsigned char> lBeforeCamera = pContext->PS.ConstantBuffers[1]->Contents;
+	std::vector<unsigned char> lBeforeLights = pContext->PS.ConstantBuffers[2]->Contents;
+	Frame(false, 1);
+	const SceneConstantData* pScene = reinterpret_cast<const SceneConstantData*>(pContext->PS.ConstantBuffers[SceneConstants::BUFFER_SLOT]->Contents.data());
+	const ViewConstantData* pView = reinterpret_cast<const ViewConstantData*>(pContext->PS.ConstantBuffers[SceneConstants::VIEW_BUFFER_SLOT]->Contents.data());
+	CHECK(memcmp(&pView->CameraPosition, lBeforeCamera.data(), sizeof(XMFLOAT3)) == 0);
+	CHECK(memcmp(pScene->Lights, lBeforeLights.data(), sizeof(Light) * MAX_LIGHT_COUNT) == 0);
+	CHECK(memcmp(&pScene->Ambient, &v3Ambient, sizeof(XMFLOAT3)) == 0);
+
+	// A frame that changed nothing uploads nothing.
+	unsigned int uUpdates = pContext->UpdateCalls;
+	SceneAfter(XMFLOAT3(0.01f, 1.0f, -5.0f));
+	CHECK(pContext->UpdateCalls == uUpdates);
+
+	// Moving the camera only uploads the view buffer.
+	ISimpleShader::UploadStats = {};
+	SceneAfter(XMFLOAT3(0.02f, 1.0f, -5.0f));
+	CHECK(pContext->UpdateCalls == uUpdates + 1 && ISimpleShader::UploadStats.Bytes == sizeof(ViewConstantData));
+
+	const unsigned int uRuns = bQuick ? 1 : 31;
+	const unsigned int uFrames = bQuick ? 1 : 20;
+	printf("%-8s %14s %15s %16s %15s %14s\n", "path", "scene us", "frame us", "uploads/frame", "bytes/frame", "binds/frame");
+	for (bool bBefore : { true, false })
+	{
+		// The camera moves every frame, so the counts are those of a moving camera.
+		Frame(bBefore, 2);
+		unsigned int uBinds = pContext->BindCalls;
+		uUpdates = pContext->UpdateCalls;
+		ISimpleShader::UploadStats = {};
+		Frame(bBefore, 3);
+		unsigned int uUploads = ISimpleShader::UploadStats.Uploads, uBytes = ISimpleShader::UploadStats.Bytes;
+		CHECK(uUploads == pContext->UpdateCalls - uUpdates);
+		uBinds = pContext->BindCalls - uBinds;
+
+		unsigned int uFrame = 4;
+		double fSceneMs = Benchmark::MedianMs(uRuns, [&]()
+		{
+			for (unsigned int f = 0; f < uFrames; f++)
+			{
+				XMFLOAT3 v3Camera(0.01f * uFrame++, 1.0f, -5.0f);
+				bBefore ? SceneBefore(v3Camera) : SceneAfter(v3Camera);
+			}
+		});
+		double fFrameMs = Benchmark::MedianMs(uRuns, [&]()
+		{
+			for (unsigned int f = 0; f < uFrames; f++) Frame(bBefore, uFrame++);
+		});
+		printf("%-8s %14.1f %15.1f %16u %15u %14u\n", bBefore ? "before" : "after",
+			fSceneMs * 1e3 / uFrames, fFrameMs * 1e3 / uFrames, uUploads, uBytes, uBinds);
+	}
+
+	ISimpleShader::StateCache = nullptr;
+	ISimpleShader::SharedConstantBufferNames.clear();
+	return Check::Report("SceneConstantsBenchmark");
+}
@@ -0,0 +1,157 @@
+// Times setting the 12 per-draw variables Entity::Draw set when the handles
+// were introduced, by name and through handles resolved once.  Fails if the
+// two leave different bytes in the constant buffer.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "SimpleShader.h"
+
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+	const unsigned int g_uEntityCount = 256;
+
+	const char* g_lNames[] =
+	{
+		"world", "worldInvTranspose", "worldViewProjection", "worldLightViewProjection",
+		"boundsMin", "boundsExtent", "colorTint", "scale", "offset", "ambient", "cameraPosition", "totalTime"
+	};
+
+	/// <summary>
+	/// What one entity sets each draw.
+	/// </summary>
+	struct PerDraw
+	{
+		XMFLOAT4X4 World;
+		XMFLOAT4X4 WorldInvTranspose;
+		XMFLOAT4X4 WorldViewProjection;
+		XMFLOAT4X4 WorldLightViewProjection;
+		XMFLOAT3 BoundsMin;
+		XMFLOAT3 BoundsExtent;
+		XMFLOAT4 ColorTint;
+		XMFLOAT2 Scale;
+		XMFLOAT2 Offset;
+		XMFLOAT3 Ambient;
+		XMFLOAT3 CameraPosition;
+		float TotalTime;
+	};
+
+	void SetByName(SimplePixelShader& a_spsShader, const PerDraw& a_pdDraw)
+	{
+		a_spsShader.SetMatrix4x4("world", a_pdDraw.World);
+		a_spsShader.SetMatrix4x4("worldInvTranspose", a_pdDraw.WorldInvTranspose);
+		a_spsShader.SetMatrix4x4("worldViewProjection", a_pdDraw.WorldViewProjection);
+		a_spsShader.SetMatrix4x4("worldLightViewProjection", a_pdDraw.WorldLightViewProjection);
+		a_spsShader.SetFloat3("boundsMin", a_pdDraw.BoundsMin);
+		a_spsShader.SetFloat3("boundsExtent", a_pdDraw.BoundsExtent);
+		a_spsShader.SetFloat4("colorTint", a_pdDraw.ColorTint);
+		a_spsShader.SetFloat2("scale", a_pdDraw.Scale);
+		a_spsShader.SetFloat2("offset", a_pdDraw.Offset);
+		a_spsShader.SetFloat3("ambient", a_pdDraw.Ambient);
+		a_spsShader.SetFloat3("cameraPosition", a_pdDraw.CameraPosition);
+		a_spsShader.SetFloat("totalTime", a_pdDraw.TotalTime);
+	}
+
+	void SetByHandle(SimplePixelShader& a_spsShader, const SimpleVariableHandle* a_pHandles, const PerDraw& a_pdDraw)
+	{
+		a_spsShader.SetMatrix4x4(a_pHandles[0], a_pdDraw.World);
+		a_spsShader.SetMatrix4x4(a_pHandles[1], a_pdDraw.WorldInvTranspose);
+		a_spsShader.SetMatrix4x4(a_pHandles[2], a_pdDraw.WorldViewProjection);
+		a_spsShader.SetMatrix4x4(a_pHandles[3], a_pdDraw.WorldLightViewProjection);
+		a_spsShader.SetFloat3(a_pHandles[4], a_pdDraw.BoundsMin);
+		a_spsShader.SetFloat3(a_pHandles[5], a_pdDraw.BoundsExtent);
+		a_spsShader.SetFloat4(a_pHandles[6], a_pdDraw.ColorTint);
+		a_spsShader.SetFloat2(a_pHandles[7], a_pdDraw.Scale);
+		a_spsShader.SetFloat2(a_pHandles[8], a_pdDraw.Offset);
+		a_spsShader.SetFloat3(a_pHandles[9], a_pdDraw.Ambient);
+		a_spsShader.SetFloat3(a_pHandles[10], a_pdDraw.CameraPosition);
+		a_spsShader.SetFloat(a_pHandles[11], a_pdDraw.TotalTime);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = Benchmark::IsQuick(argc, argv);
+
+	// The variables packed as HLSL would, one 352 byte constant buffer.
+	const UINT lOffsets[] = { 0, 64, 128, 192, 256, 272, 288, 304, 312, 320, 336, 348 };
+	const UINT lSizes[] = { 64, 64, 64, 64, 12, 12, 16, 8, 8, 12, 12, 4 };
+	MockShaders::Buffer buffer = { "PerDraw", 0, 352, {} };
+	for (unsigned int i = 0; i < ARRAYSIZE(g_lNames); i++) buffer.Variables.push_back({ g_lNames[i], lOffsets[i], lSizes[i] });
+	MockShaders::Add(L"ShaderHandleBenchmark.cso", { { buffer }, {}, {}, {} });
+
+	ComPtr<ID3D11Device> device(new ID3D11Device());
+	ComPtr<ID3D11DeviceContext> context(new ID3D11DeviceContext());
+	SimplePixelShader shader(device, context, L"ShaderHandleBenchmark.cso");
+	if (!CHECK(shader.IsShaderValid())) return Check::Report("ShaderHandleBenchmark");
+
+	SimpleVariableHandle lHandles[ARRAYSIZE(g_lNames)];
+	for (unsigned int i = 0; i < ARRAYSIZE(g_lNames); i++)
+	{
+		lHandles[i] = shader.GetVariableHandle(g_lNames[i]);
+		CHECK(lHandles[i].IsValid());
+	}
+
+	// Every entity sets different values, so no write is skipped as unchanged.
+	std::vector<PerDraw> lDraws(g_uEntityCount);
+	for (unsigned int e = 0; e < g_uEntityCount; e++)
+	{
+		PerDraw& draw = lDraws[e];
+		float f = static_cast<float>(e);
+		XMStoreFloat4x4(&draw.World, XMMatrixTranslation(f, f * 0.5f, -f));
+		XMStoreFloat4x4(&draw.WorldInvTranspose, XMMatrixScaling(1.0f + f, 1.0f, 1.0f));
+		XMStoreFloat4x4(&draw.WorldViewProjection, XMMatrixRotationRollPitchYaw(0.0f, f * 0.01f, 0.0f));
+		XMStoreFloat4x4(&draw.WorldLightViewProjection, XMMatrixRotationRollPitchYaw(f * 0.02f, 0.0f, 0.0f));
+		draw.BoundsMin = XMFLOAT3(f, -f, 0.5f * f);
+		draw.BoundsExtent = XMFLOAT3(1.0f + f, 2.0f, 3.0f);
+		draw.ColorTint = XMFLOAT4(f / g_uEntityCount, 1.0f, 0.5f, 1.0f);
+		draw.Scale = XMFLOAT2(1.0f + f, 1.0f);
+		draw.Offset = XMFLOAT2(0.0f, f);
+		draw.Ambient = XMFLOAT3(0.1f, 0.1f, 0.1f + f);
+		draw.CameraPosition = XMFLOAT3(0.0f, f, -5.0f);
+		draw.TotalTime = f * 0.016f;
+	}
+
+	// Both paths leave the same bytes.
+	const SimpleConstantBuffer* pBuffer = shader.GetBufferInfo(0u);
+	unsigned int uDifferentDraws = 0;
+	for (const PerDraw& draw : lDraws)
+	{
+		SetByName(shader, draw);
+		std::vector<unsigned char> lByName(pBuffer->LocalDataBuffer, pBuffer->LocalDataBuffer + pBuffer->Size);
+		memset(pBuffer->LocalDataBuffer, 0, pBuffer->Size);
+		SetByHandle(shader, lHandles, draw);
+		if (memcmp(lByName.data(), pBuffer->LocalDataBuffer, pBuffer->Size) != 0) uDifferentDraws++;
+	}
+	CHECK(uDifferentDraws == 0);
+
+	const unsigned int uRuns = bQuick ? 1 : 51;
+	const unsigned int uRounds = bQuick ? 1 : 40;
+	double fNameMs = Benchmark::MedianMs(uRuns, [&]()
+	{
+		for (unsigned int r = 0; r < uRounds; r++)
+		{
+			for (const PerDraw& draw : lDraws) SetByName(shader, draw);
+		}
+	});
+	double fHandleMs = Benchmark::MedianMs(uRuns, [&]()
+	{
+		for (unsigned int r = 0; r < uRounds; r++)
+		{
+			for (const PerDraw& draw : lDraws) SetByHandle(shader, lHandles, draw);
+		}
+	});
+
+	double fDraws = static_cast<double>(g_uEntityCount) * uRounds;
+	printf("%-12s %14s\n", "setter", "ns per draw");
+	printf("%-12s %14.1f\n", "by name", fNameMs * 1e6 / fDraws);
+	printf("%-12s %14.1f\n", "by handle", fHandleMs * 1e6 / fDraws);
+
+	return Check::Report("ShaderHandleBenchmark");
+}
@@ -0,0 +1,179 @@
+// Times TangentGenerator's SIMD path, on the calling thread and through a
+// JobSystem, against the original scalar loop on a finely tessellated sphere
+// with mirrored uvs on one half.  Fails if the SIMD tangents differ from the
+// original's wherever those are defined, there or on the shipped models.  The
+// original writes no handedness, so the signs are checked on their own.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "JobSystem.h"
+#include "ObjLoader.h"
+#include "TangentGenerator.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const char* g_lModels[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+
+	// Largest difference allowed per tangent component between the two paths.
+	const float g_fMaxDifference = 1e-5f;
+
+	/// <summary>
+	/// Builds a uv sphere out of a_iSegments x a_iSegments quads.  The uvs are
+	/// mirrored on one half so both handedness signs show up, and slightly
+	/// jittered so no two triangles are exactly alike.
+	/// </summary>
+	void BuildSphere(int a_iSegments, std::vector<Vertex>& a_lVertices, std::vector<unsigned int>& a_lIndices)
+	{
+		std::mt19937 rng(3);
+		std::uniform_real_distribution<float> fJitter(-0.0003f, 0.0003f);
+		for (int y = 0; y <= a_iSegments; y++)
+		{
+			for (int x = 0; x <= a_iSegments; x++)
+			{
+				float fTheta = XM_PI * (y + 0.5f) / (a_iSegments + 1);
+				float fPhi = XM_2PI * x / a_iSegments;
+				Vertex vertex = {};
+				vertex.Normal = XMFLOAT3(std::sin(fTheta) * std::cos(fPhi), std::cos(fTheta), std::sin(fTheta) * std::sin(fPhi));
+				vertex.Position = vertex.Normal;
+				float fU = 4.0f * x / a_iSegments;
+				vertex.UV = XMFLOAT2((x > a_iSegments / 2 ? -fU : fU) + fJitter(rng), 2.0f * y / a_iSegments);
+				a_lVertices.push_back(vertex);
+			}
+		}
+		for (int y = 0; y < a_iSegments; y++)
+		{
+			for (int x = 0; x < a_iSegments; x++)
+			{
+				unsigned int a = y * (a_iSegments + 1) + x;
+				unsigned int c = a + a_iSegments + 1;
+				a_lIndices.insert(a_lIndices.end(), { a, c, a + 1, a + 1, c, c + 1 });
+			}
+		}
+
+		// A triangle with no uv area, which has to add nothing rather than NaNs.
+		a_lIndices.insert(a_lIndices.end(), { 0, 0, 1 });
+	}
+
+	/// <summary>
+	/// Compares the SIMD tangents with the original's, skipping the vertices
+	/// the original turned into NaNs.
+	/// </summary>
+	/// <returns>The largest tangent component difference.</returns>
+	float CheckAgree(const std::vector<Vertex>& a_lReference, const std::vector<Vertex>& a_lSimd, long& a_lUndefined)
+	{
+		float fMaxDifference = 0.0f;
+		a_lUndefined = 0;
+		for (size_t i = 0; i < a_lReference.size(); i++)
+		{
+			const XMFLOAT4& a = a_lReference[i].Tangent;
+			const XMFLOAT4& b = a_lSimd[i].Tangent;
+			if (!std::isfinite(a.x) || !std::isfinite(a.y) || !std::isfinite(a.z))
+			{
+				a_lUndefined++;
+				continue;
+			}
+			fMaxDifference = std::max({ fMaxDifference, std::fabs(a.x - b.x), std::fabs(a.y - b.y), std::fabs(a.z - b.z) });
+		}
+		CHECK(fMaxDifference <= g_fMaxDifference);
+		return fMaxDifference;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = Benchmark::IsQuick(argc, argv);
+	unsigned int uRuns = bQuick ? 1 : 9;
+
+	printf("%-18s %9s %12s %10s %10s\n", "mesh", "tris", "max diff", "undefined", "w < 0");
+	for (const char* sModel : g_lModels)
+	{
+		std::vector<Vertex> lVertices;
+		std::vector<unsigned int> lIndices;
+		if (!CHECK(ObjLoader::Load((std::string(MODELS_DIR) + sModel + ".graphics_obj").c_str(), lVertices, lIndices))) continue;
+
+		std::vector<Vertex> lReference = lVertices;
+		std::vector<Vertex> lSimd = lVertices;
+		TangentGenerator::CalculateTangentsReference(lReference.data(), lReference.size(), lIndices.data(), lIndices.size());
+		TangentGenerator::CalculateTangents(lSimd.data(), lSimd.size(), lIndices.data(), lIndices.size());
+		long lUndefined = 0;
+		float fMaxDifference = CheckAgree(lReference, lSimd, lUndefined);
+		long lNegative = std::count_if(lSimd.begin(), lSimd.end(), [](const Vertex& v) { return v.Tangent.w < 0.0f; });
+		printf("%-18s %9zu %12.3g %10ld %10ld\n", sModel, lIndices.size() / 3, fMaxDifference, lUndefined, lNegative);
+	}
+
+	std::vector<Vertex> lVertices;
+	std::vector<unsigned int> lIndices;
+	BuildSphere(bQuick ? 200 : 1200, lVertices, lIndices);
+
+	std::vector<Vertex> lReference = lVertices;
+	std::vector<Vertex> lSimd = lVertices;
+	std::vector<Vertex> lJobs = lVertices;
+	JobSystem jsJobs;
+	double fReferenceMs = Benchmark::MedianMs(uRuns, [&]()
+	{
+		TangentGenerator::CalculateTangentsReference(lReference.data(), lReference.size(), lIndices.data(), lIndices.size());
+	});
+	double fSimdMs = Benchmark::MedianMs(uRuns, [&]()
+	{
+		TangentGenerator::CalculateTangents(lSimd.data(), lSimd.size(), lIndices.data(), lIndices.size());
+	});
+	double fJobsMs = Benchmark::MedianMs(uRuns, [&]()
+	{
+		TangentGenerator::CalculateTangents(lJobs.data(), lJobs.size(), lIndices.data(), lIndices.size(), &jsJobs);
+	});
+
+	// Only the vertices of the one triangle with no uv area are undefined in the original.
+	long lUndefined = 0;
+	float fMaxDifference = CheckAgree(lReference, lSimd, lUndefined);
+	long lNegative = std::count_if(lSimd.begin(), lSimd.end(), [](const Vertex& v) { return v.Tangent.w < 0.0f; });
+	printf("%-18s %9zu %12.3g %10ld %10ld\n", "mirrored sphere", lIndices.size() / 3, fMaxDifference, lUndefined, lNegative);
+	CHECK(lUndefined == 2);
+
+	// Splitting into jobs changes the order of the sums, not the result beyond rounding.  Four
+	// workers, so the split happens even where the timed JobSystem has only one.
+	JobSystem jsSplit(4);
+	std::vector<Vertex> lSplit = lVertices;
+	TangentGenerator::CalculateTangents(lSplit.data(), lSplit.size(), lIndices.data(), lIndices.size(), &jsSplit);
+	unsigned int uSplitMismatches = 0;
+	for (const std::vector<Vertex>* pOther : { &lJobs, &lSplit })
+	{
+		for (size_t i = 0; i < lSimd.size(); i++)
+		{
+			const XMFLOAT4& a = lSimd[i].Tangent;
+			const XMFLOAT4& b = (*pOther)[i].Tangent;
+			if (std::fabs(a.x - b.x) > g_fMaxDifference || std::fabs(a.y - b.y) > g_fMaxDifference || std::fabs(a.z - b.z) > g_fMaxDifference || a.w != b.w)
+				uSplitMismatches++;
+		}
+	}
+	CHECK(uSplitMismatches == 0);
+
+	// Both handedness signs have to come out of the mirrored halves.
+	CHECK(lNegative > 0 && lNegative < static_cast<long>(lSimd.size()));
+
+	// Every tangent a finite unit vector orthogonal to its normal.
+	long lMalformed = std::count_if(lSimd.begin(), lSimd.end(), [](const Vertex& v)
+	{
+		const XMFLOAT4& t = v.Tangent;
+		const XMFLOAT3& n = v.Normal;
+		return !(std::fabs(t.x * t.x + t.y * t.y + t.z * t.z - 1.0f) < 1e-4f) || !(std::fabs(t.x * n.x + t.y * n.y + t.z * n.z) < 1e-4f);
+	});
+	CHECK(lMalformed == 0);
+
+	printf("\n%u job threads\n", jsJobs.GetThreadCount());
+	printf("%-10s %10s %9s\n", "path", "ms", "speedup");
+	printf("%-10s %10.2f %8.2fx\n", "original", fReferenceMs, 1.0);
+	printf("%-10s %10.2f %8.2fx\n", "simd", fSimdMs, fReferenceMs / fSimdMs);
+	printf("%-10s %10.2f %8.2fx\n", "simd jobs", fJobsMs, fReferenceMs / fJobsMs);
+
+	return Check::Report("TangentGeneratorBenchmark");
+}
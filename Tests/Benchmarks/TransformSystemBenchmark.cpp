@@ -0,0 +1,161 @@
+// Times TransformSystem's batched update against one Transform per object,
+// with every object rotating each frame, and fails if its matrices drift from
+// a double precision reference or from what Transform computes.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "DoubleMath.h"
+#include "Transform.h"
+#include "TransformSystem.h"
+
+using namespace DirectX;
+
+namespace
+{
+	// Largest error allowed relative to the largest element of the matrix.
+	const double g_fMaxRelativeError = 1e-5;
+
+	struct RandomTransform
+	{
+		XMFLOAT3 Position;
+		XMFLOAT3 Rotation;
+		XMFLOAT3 Scale;
+	};
+
+	/// <summary>
+	/// Makes transforms spread around a scene, some of them mirrored.
+	/// </summary>
+	std::vector<RandomTransform> MakeTransforms(unsigned int a_uCount)
+	{
+		std::mt19937 rng(8);
+		std::uniform_real_distribution<float> fPosition(-100.0f, 100.0f);
+		std::uniform_real_distribution<float> fAngle(-XM_PI, XM_PI);
+		std::uniform_real_distribution<float> fScale(0.1f, 10.0f);
+		std::vector<RandomTransform> lTransforms(a_uCount);
+		for (unsigned int i = 0; i < a_uCount; i++)
+		{
+			lTransforms[i].Position = XMFLOAT3(fPosition(rng), fPosition(rng), fPosition(rng));
+			lTransforms[i].Rotation = XMFLOAT3(fAngle(rng), fAngle(rng), fAngle(rng));
+			lTransforms[i].Scale = XMFLOAT3(fScale(rng), fScale(rng), i % 7 == 0 ? -fScale(rng) : fScale(rng));
+		}
+		return lTransforms;
+	}
+
+	bool SameMatrix(const XMFLOAT4X4& a_m4A, const XMFLOAT4X4& a_m4B)
+	{
+		return memcmp(&a_m4A, &a_m4B, sizeof(XMFLOAT4X4)) == 0;
+	}
+
+	/// <summary>
+	/// Checks the batched matrices against the reference and against Transform.
+	/// A count that is not a multiple of 4 leaves a partly filled last batch.
+	/// </summary>
+	void CheckAccuracy(unsigned int a_uCount, JobSystem& a_jsJobs)
+	{
+		std::vector<RandomTransform> lTransforms = MakeTransforms(a_uCount);
+		TransformSystem system;
+		TransformSystem threaded;
+		std::vector<Transform> lObjects(a_uCount);
+		for (unsigned int i = 0; i < a_uCount; i++)
+		{
+			for (TransformSystem* pSystem : { &system, &threaded })
+			{
+				unsigned int uIndex = pSystem->Create();
+				pSystem->SetPosition(uIndex, lTransforms[i].Position);
+				pSystem->SetRotation(uIndex, lTransforms[i].Rotation);
+				pSystem->SetScale(uIndex, lTransforms[i].Scale);
+			}
+			lObjects[i].SetPosition(lTransforms[i].Position);
+			lObjects[i].SetRotation(lTransforms[i].Rotation);
+			lObjects[i].SetScale(lTransforms[i].Scale);
+		}
+		system.Update();
+		threaded.Update(&a_jsJobs);
+		CHECK(system.GetDirtyCount() == 0);
+		CHECK(system.GetRecalculationCount() == a_uCount);
+
+		double fWorldError = 0.0;
+		double fNormalError = 0.0;
+		double fTransformError = 0.0;
+		unsigned int uThreadedMismatches = 0;
+		for (unsigned int i = 0; i < a_uCount; i++)
+		{
+			DoubleMath::Matrix mWorld = DoubleMath::World(lTransforms[i].Position, lTransforms[i].Rotation, lTransforms[i].Scale);
+			DoubleMath::Matrix mNormal = DoubleMath::Transpose(DoubleMath::Inverse(mWorld));
+			const XMFLOAT4X4& m4World = system.GetWorldMatrix(i);
+			const XMFLOAT4X4& m4Normal = system.GetWorldInverseTransposeMatrix(i);
+			fWorldError = std::max(fWorldError, DoubleMath::RelativeError(m4World, mWorld));
+			fNormalError = std::max(fNormalError, DoubleMath::RelativeError(m4Normal, mNormal));
+			fTransformError = std::max(fTransformError, DoubleMath::RelativeError(m4World, DoubleMath::FromFloat(lObjects[i].GetWorldMatrix())));
+			fTransformError = std::max(fTransformError, DoubleMath::RelativeError(m4Normal, DoubleMath::FromFloat(lObjects[i].GetWorldInverseTransposeMatrix())));
+			if (!SameMatrix(m4World, threaded.GetWorldMatrix(i)) || !SameMatrix(m4Normal, threaded.GetWorldInverseTransposeMatrix(i))) uThreadedMismatches++;
+		}
+		printf("%u transforms: world %.3g, inverse transpose %.3g, vs Transform %.3g\n", a_uCount, fWorldError, fNormalError, fTransformError);
+		CHECK(fWorldError <= g_fMaxRelativeError);
+		CHECK(fNormalError <= g_fMaxRelativeError);
+		CHECK(fTransformError <= g_fMaxRelativeError);
+		CHECK(uThreadedMismatches == 0);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = Benchmark::IsQuick(argc, argv);
+	JobSystem jobs;
+
+	printf("largest error relative to the largest element\n");
+	CheckAccuracy(1003, jobs);
+
+	printf("\n%u threads, every object rotating each frame\n", jobs.GetThreadCount());
+	printf("%9s %14s %12s %14s %8s\n", "objects", "Transform ms", "system ms", "threaded ms", "speedup");
+	std::vector<unsigned int> lCounts = { 1000, 10000 };
+	if (!bQuick) lCounts.insert(lCounts.end(), { 100000, 1000000 });
+	for (unsigned int uCount : lCounts)
+	{
+		std::vector<RandomTransform> lTransforms = MakeTransforms(uCount);
+		std::vector<Transform> lObjects(uCount);
+		TransformSystem system;
+		for (unsigned int i = 0; i < uCount; i++)
+		{
+			lObjects[i].SetPosition(lTransforms[i].Position);
+			lObjects[i].SetRotation(lTransforms[i].Rotation);
+			lObjects[i].SetScale(lTransforms[i].Scale);
+			unsigned int uIndex = system.Create();
+			system.SetPosition(uIndex, lTransforms[i].Position);
+			system.SetRotation(uIndex, lTransforms[i].Rotation);
+			system.SetScale(uIndex, lTransforms[i].Scale);
+		}
+
+		unsigned int uRuns = bQuick ? 1 : (uCount >= 1000000 ? 5 : 15);
+		XMFLOAT4X4 m4Sink = {};
+		double fTransformMs = Benchmark::MedianMs(uRuns, [&]()
+		{
+			for (Transform& transform : lObjects)
+			{
+				transform.Rotate(0.0f, 0.01f, 0.0f);
+				m4Sink = transform.GetWorldMatrix();
+				m4Sink = transform.GetWorldInverseTransposeMatrix();
+			}
+		});
+		double fSystemMs = Benchmark::MedianMs(uRuns, [&]()
+		{
+			for (unsigned int i = 0; i < uCount; i++) system.Rotate(i, XMFLOAT3(0.0f, 0.01f, 0.0f));
+			system.Update();
+		});
+		double fThreadedMs = Benchmark::MedianMs(uRuns, [&]()
+		{
+			for (unsigned int i = 0; i < uCount; i++) system.Rotate(i, XMFLOAT3(0.0f, 0.01f, 0.0f));
+			system.Update(&jobs);
+		});
+		CHECK(system.GetDirtyCount() == 0);
+		printf("%9u %14.3f %12.3f %14.3f %7.2fx\n", uCount, fTransformMs, fSystemMs, fThreadedMs, fTransformMs / std::min(fSystemMs, fThreadedMs));
+	}
+
+	return Check::Report("TransformSystemBenchmark");
+}
@@ -0,0 +1,78 @@
+// Times TransformSystem::CalculateViewProjections for a scene of 50k objects
+// and fails if its products drift from a double precision world * view *
+// projection, or if the threaded split changes a single bit.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "Benchmark.h"
+#include "Check.h"
+#include "DoubleMath.h"
+#include "TransformSystem.h"
+
+using namespace DirectX;
+
+namespace
+{
+	// Largest error allowed relative to the largest element of the matrix.
+	const double g_fMaxRelativeError = 1e-5;
+}
+
+int main(int argc, char** argv)
+{
+	bool bQuick = Benchmark::IsQuick(argc, argv);
+	const unsigned int uCount = 50000;
+
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> fPosition(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> fAngle(-XM_PI, XM_PI);
+	std::uniform_real_distribution<float> fScale(0.1f, 10.0f);
+	TransformSystem system;
+	for (unsigned int i = 0; i < uCount; i++)
+	{
+		unsigned int uIndex = system.Create();
+		system.SetPosition(uIndex, XMFLOAT3(fPosition(rng), fPosition(rng), fPosition(rng)));
+		system.SetRotation(uIndex, XMFLOAT3(fAngle(rng), fAngle(rng), fAngle(rng)));
+		system.SetScale(uIndex, XMFLOAT3(fScale(rng), fScale(rng), fScale(rng)));
+	}
+	system.Update();
+
+	// A camera and a shadow casting light like the ones Game sets up.
+	XMFLOAT4X4 m4ViewProjection, m4LightViewProjection;
+	XMStoreFloat4x4(&m4ViewProjection,
+		XMMatrixLookToLH(XMVectorSet(0.0f, 5.0f, -150.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) *
+		XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.01f, 1000.0f));
+	XMStoreFloat4x4(&m4LightViewProjection,
+		XMMatrixLookToLH(XMVectorSet(100.0f, 100.0f, -100.0f, 1.0f), XMVector3Normalize(XMVectorSet(-1.0f, -1.0f, 1.0f, 0.0f)), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) *
+		XMMatrixOrthographicLH(300.0f, 300.0f, 0.1f, 400.0f));
+
+	JobSystem jobs;
+	unsigned int uRuns = bQuick ? 1 : 51;
+	double fSerialMs = Benchmark::MedianMs(uRuns, [&]() { system.CalculateViewProjections(m4ViewProjection, m4LightViewProjection); });
+	std::vector<XMFLOAT4X4> lSerial(uCount);
+	for (unsigned int i = 0; i < uCount; i++) lSerial[i] = system.GetWorldViewProjectionMatrix(i);
+	double fThreadedMs = Benchmark::MedianMs(uRuns, [&]() { system.CalculateViewProjections(m4ViewProjection, m4LightViewProjection, &jobs); });
+
+	DoubleMath::Matrix mViewProjection = DoubleMath::FromFloat(m4ViewProjection);
+	DoubleMath::Matrix mLightViewProjection = DoubleMath::FromFloat(m4LightViewProjection);
+	double fError = 0.0;
+	unsigned int uThreadedMismatches = 0;
+	for (unsigned int i = 0; i < uCount; i++)
+	{
+		DoubleMath::Matrix mWorld = DoubleMath::FromFloat(system.GetWorldMatrix(i));
+		fError = std::max(fError, DoubleMath::RelativeError(system.GetWorldViewProjectionMatrix(i), DoubleMath::Multiply(mWorld, mViewProjection)));
+		fError = std::max(fError, DoubleMath::RelativeError(system.GetWorldLightViewProjectionMatrix(i), DoubleMath::Multiply(mWorld, mLightViewProjection)));
+		if (memcmp(&lSerial[i], &system.GetWorldViewProjectionMatrix(i), sizeof(XMFLOAT4X4)) != 0) uThreadedMismatches++;
+	}
+	CHECK(fError <= g_fMaxRelativeError);
+	CHECK(uThreadedMismatches == 0);
+
+	printf("%u objects, camera and light products\n", uCount);
+	printf("largest error relative to the largest element %.3g\n", fError);
+	printf("serial %.3f ms, %u threads %.3f ms\n", fSerialMs, jobs.GetThreadCount(), fThreadedMs);
+
+	return Check::Report("ViewProjectionBenchmark");
+}
@@ -0,0 +1,196 @@
+// Checks every BoundingVolumeHierarchy query against brute force over random
+// boxes, and that moving items refits the tree while reshuffling rebuilds it.
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "BoundingVolumeHierarchy.h"
+#include "Check.h"
+
+using namespace DirectX;
+
+namespace
+{
+	/// <summary>
+	/// The nearest box a ray enters, testing every box.
+	/// </summary>
+	/// <returns>The distance along the ray, FLT_MAX if nothing was hit.</returns>
+	float BruteForceRayCast(const std::vector<CullBox>& a_lBoxes, XMFLOAT3 a_v3Origin, XMFLOAT3 a_v3Direction, unsigned int& a_uHit)
+	{
+		const float* pOrigin = &a_v3Origin.x;
+		const float* pDirection = &a_v3Direction.x;
+		float fNearest = FLT_MAX;
+		for (unsigned int i = 0; i < a_lBoxes.size(); i++)
+		{
+			const float* pCenter = &a_lBoxes[i].Center.x;
+			const float* pExtents = &a_lBoxes[i].Extents.x;
+			float fEnter = 0.0f;
+			float fExit = FLT_MAX;
+			for (int a = 0; a < 3; a++)
+			{
+				float fInverse = 1.0f / pDirection[a];
+				float fT1 = (pCenter[a] - pExtents[a] - pOrigin[a]) * fInverse;
+				float fT2 = (pCenter[a] + pExtents[a] - pOrigin[a]) * fInverse;
+				fEnter = std::max(fEnter, std::min(fT1, fT2));
+				fExit = std::min(fExit, std::max(fT1, fT2));
+			}
+			if (fExit >= fEnter && fEnter < fNearest)
+			{
+				fNearest = fEnter;
+				a_uHit = i;
+			}
+		}
+		return fNearest;
+	}
+
+	bool OverlapsSphere(const CullBox& a_cbBox, XMFLOAT3 a_v3Center, float a_fRadius)
+	{
+		float fDistanceSquared = 0.0f;
+		const float* pBoxCenter = &a_cbBox.Center.x;
+		const float* pExtents = &a_cbBox.Extents.x;
+		const float* pCenter = &a_v3Center.x;
+		for (int a = 0; a < 3; a++)
+		{
+			float fOutside = std::max({ pBoxCenter[a] - pExtents[a] - pCenter[a], pCenter[a] - pBoxCenter[a] - pExtents[a], 0.0f });
+			fDistanceSquared += fOutside * fOutside;
+		}
+		return fDistanceSquared <= a_fRadius * a_fRadius;
+	}
+
+	bool OverlapsBox(const CullBox& a_cbA, const CullBox& a_cbB)
+	{
+		return std::fabs(a_cbA.Center.x - a_cbB.Center.x) <= a_cbA.Extents.x + a_cbB.Extents.x &&
+			std::fabs(a_cbA.Center.y - a_cbB.Center.y) <= a_cbA.Extents.y + a_cbB.Extents.y &&
+			std::fabs(a_cbA.Center.z - a_cbB.Center.z) <= a_cbA.Extents.z + a_cbB.Extents.z;
+	}
+
+	std::vector<unsigned int> Sorted(std::vector<unsigned int> a_lIndices)
+	{
+		std::sort(a_lIndices.begin(), a_lIndices.end());
+		return a_lIndices;
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<float> fUnit(-1.0f, 1.0f);
+
+	XMFLOAT4X4 m4ViewProjection;
+	XMStoreFloat4x4(&m4ViewProjection,
+		XMMatrixLookToLH(XMVectorSet(0, 0, -50, 1), XMVectorSet(0.3f, 0, 1, 0), XMVectorSet(0, 1, 0, 0)) *
+		XMMatrixPerspectiveFovLH(XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.01f, 900.0f));
+	Frustum frustum = FrustumCuller::ExtractFrustum(m4ViewProjection);
+
+	for (unsigned int uCount : { 1u, 3u, 1000u, 5003u })
+	{
+		float fSpan = std::cbrt(static_cast<float>(uCount)) * 4.0f;
+		std::vector<CullBox> lBoxes(uCount);
+		for (CullBox& box : lBoxes)
+		{
+			box.Center = XMFLOAT3(fUnit(rng) * fSpan, fUnit(rng) * fSpan, fUnit(rng) * fSpan);
+			box.Extents = XMFLOAT3(0.5f + std::fabs(fUnit(rng)), 0.5f + std::fabs(fUnit(rng)), 0.5f + std::fabs(fUnit(rng)));
+		}
+		BoundingVolumeHierarchy bvh;
+		bvh.Build(lBoxes.data(), uCount);
+		CHECK(bvh.GetItemCount() == uCount);
+
+		// The frustum flags are exactly FrustumCuller's.
+		std::vector<unsigned char> lLinear(uCount), lTree(uCount);
+		unsigned int uLinear = FrustumCuller::Cull(frustum, lBoxes.data(), uCount, lLinear.data());
+		CHECK(bvh.QueryFrustum(frustum, lTree.data()) == uLinear);
+		CHECK(lTree == lLinear);
+
+		// Rays from all around, most of them starting outside every box.
+		unsigned int uRayMismatches = 0;
+		for (int r = 0; r < 500; r++)
+		{
+			XMFLOAT3 v3Origin(fUnit(rng) * fSpan * 1.5f, fUnit(rng) * fSpan * 1.5f, fUnit(rng) * fSpan * 1.5f);
+			XMFLOAT3 v3Direction(fUnit(rng), fUnit(rng), fUnit(rng));
+			unsigned int uExpectedHit = ~0u;
+			unsigned int uHit = ~0u;
+			float fDistance = 0.0f;
+			float fExpected = BruteForceRayCast(lBoxes, v3Origin, v3Direction, uExpectedHit);
+			bool bHit = bvh.RayCast(v3Origin, v3Direction, uHit, fDistance);
+			if (bHit != (fExpected != FLT_MAX) || (bHit && std::fabs(fDistance - fExpected) > 1e-4f * std::max(1.0f, fExpected)))
+				uRayMismatches++;
+		}
+		CHECK(uRayMismatches == 0);
+
+		// Spheres and boxes return the same items in any order.
+		unsigned int uQueryMismatches = 0;
+		std::vector<unsigned int> lResults;
+		for (int q = 0; q < 100; q++)
+		{
+			XMFLOAT3 v3Center(fUnit(rng) * fSpan, fUnit(rng) * fSpan, fUnit(rng) * fSpan);
+			float fRadius = 2.0f + std::fabs(fUnit(rng)) * 5.0f;
+			std::vector<unsigned int> lExpected;
+			for (unsigned int i = 0; i < uCount; i++)
+			{
+				if (OverlapsSphere(lBoxes[i], v3Center, fRadius)) lExpected.push_back(i);
+			}
+			bvh.QuerySphere(v3Center, fRadius, lResults);
+			if (Sorted(lResults) != lExpected) uQueryMismatches++;
+
+			CullBox query = { v3Center, XMFLOAT3(fRadius, fRadius * 0.5f, fRadius) };
+			lExpected.clear();
+			for (unsigned int i = 0; i < uCount; i++)
+			{
+				if (OverlapsBox(lBoxes[i], query)) lExpected.push_back(i);
+			}
+			bvh.QueryBox(query, lResults);
+			if (Sorted(lResults) != lExpected) uQueryMismatches++;
+		}
+		CHECK(uQueryMismatches == 0);
+		printf("%u boxes: %u visible, %u nodes\n", uCount, uLinear, bvh.GetNodeCount());
+	}
+
+	// Small moves only refit, reshuffling or changing the count rebuilds.
+	const unsigned int uCount = 5000;
+	std::vector<CullBox> lBoxes(uCount);
+	for (CullBox& box : lBoxes)
+	{
+		box.Center = XMFLOAT3(fUnit(rng) * 80.0f, fUnit(rng) * 80.0f, fUnit(rng) * 80.0f);
+		box.Extents = XMFLOAT3(1.0f, 1.0f, 1.0f);
+	}
+	BoundingVolumeHierarchy bvh;
+	bvh.Update(lBoxes.data(), uCount);
+	CHECK(bvh.GetBuildCount() == 1);
+	for (CullBox& box : lBoxes) box.Center.x += fUnit(rng) * 0.1f;
+	bvh.Update(lBoxes.data(), uCount);
+	CHECK(bvh.GetBuildCount() == 1);
+
+	// A refitted tree still answers exactly.
+	std::vector<unsigned char> lLinear(uCount), lTree(uCount);
+	FrustumCuller::Cull(frustum, lBoxes.data(), uCount, lLinear.data());
+	bvh.QueryFrustum(frustum, lTree.data());
+	CHECK(lTree == lLinear);
+
+	std::shuffle(lBoxes.begin(), lBoxes.end(), rng);
+	bvh.Update(lBoxes.data(), uCount);
+	CHECK(bvh.GetBuildCount() == 2);
+	FrustumCuller::Cull(frustum, lBoxes.data(), uCount, lLinear.data());
+	bvh.QueryFrustum(frustum, lTree.data());
+	CHECK(lTree == lLinear);
+
+	lBoxes.pop_back();
+	bvh.Update(lBoxes.data(), uCount - 1);
+	CHECK(bvh.GetBuildCount() == 3);
+
+	// Items that cannot be told apart end up in one leaf, and an empty tree hits nothing.
+	std::vector<CullBox> lSame(50, CullBox{ { 1, 1, 1 }, { 1, 1, 1 } });
+	bvh.Build(lSame.data(), static_cast<unsigned int>(lSame.size()));
+	std::vector<unsigned int> lResults;
+	bvh.QuerySphere(XMFLOAT3(1, 1, 1), 0.1f, lResults);
+	CHECK(lResults.size() == lSame.size());
+	bvh.Build(nullptr, 0);
+	unsigned int uHit;
+	float fDistance;
+	CHECK(!bvh.RayCast(XMFLOAT3(0, 0, 0), XMFLOAT3(1, 0, 0), uHit, fDistance));
+
+	return Check::Report("BoundingVolumeHierarchyTest");
+}
@@ -0,0 +1,44 @@
+#ifndef __CHECK_H_
+#define __CHECK_H_
+
+#include <cmath>
+#include <cstdio>
+
+/// <summary>
+/// Minimal assertions for the headless tests.  A failed check prints where it
+/// failed and keeps going, and Check::Report() turns the count into the exit
+/// code, so ctest fails the run without stopping at the first problem.
+/// </summary>
+namespace Check
+{
+	inline int g_iChecks = 0;
+	inline int g_iFailures = 0;
+
+	inline bool Record(bool a_bPassed, const char* a_sExpression, const char* a_sFile, int a_iLine)
+	{
+		g_iChecks++;
+		if (!a_bPassed)
+		{
+			g_iFailures++;
+			printf("%s(%d): check failed: %s\n", a_sFile, a_iLine, a_sExpression);
+		}
+		return a_bPassed;
+	}
+
+	/// <summary>
+	/// Prints the totals.
+	/// </summary>
+	/// <returns>The exit code for main, 0 if every check passed.</returns>
+	inline int Report(const char* a_sName)
+	{
+		printf("%s: %d of %d checks passed\n", a_sName, g_iChecks - g_iFailures, g_iChecks);
+		return g_iFailures == 0 ? 0 : 1;
+	}
+}
+
+#define CHECK(a_bCondition) Check::Record(static_cast<bool>(a_bCondition), #a_bCondition, __FILE__, __LINE__)
+#define CHECK_NEAR(a_fValue, a_fExpected, a_fTolerance) \
+	Check::Record(std::fabs(static_cast<double>(a_fValue) - static_cast<double>(a_fExpected)) <= static_cast<double>(a_fTolerance), \
+		#a_fValue " within " #a_fTolerance " of " #a_fExpected, __FILE__, __LINE__)
+
+#endif //__CHECK_H_
@@ -0,0 +1,133 @@
+#ifndef __DOUBLEMATH_H_
+#define __DOUBLEMATH_H_
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <DirectXMath.h>
+
+/// <summary>
+/// Double precision versions of the transform math, for measuring how far the
+/// engine's float results drift.  Same row vector convention as DirectXMath.
+/// </summary>
+namespace DoubleMath
+{
+	struct Matrix
+	{
+		double m[4][4];
+	};
+
+	inline Matrix Identity(void)
+	{
+		Matrix result = {};
+		for (int i = 0; i < 4; i++) result.m[i][i] = 1.0;
+		return result;
+	}
+
+	inline Matrix FromFloat(const DirectX::XMFLOAT4X4& a_m4Matrix)
+	{
+		Matrix result;
+		for (int r = 0; r < 4; r++)
+			for (int c = 0; c < 4; c++) result.m[r][c] = a_m4Matrix.m[r][c];
+		return result;
+	}
+
+	inline Matrix Multiply(const Matrix& a_mA, const Matrix& a_mB)
+	{
+		Matrix result = {};
+		for (int r = 0; r < 4; r++)
+			for (int c = 0; c < 4; c++)
+				for (int k = 0; k < 4; k++) result.m[r][c] += a_mA.m[r][k] * a_mB.m[k][c];
+		return result;
+	}
+
+	inline Matrix Transpose(const Matrix& a_mMatrix)
+	{
+		Matrix result;
+		for (int r = 0; r < 4; r++)
+			for (int c = 0; c < 4; c++) result.m[r][c] = a_mMatrix.m[c][r];
+		return result;
+	}
+
+	/// <summary>
+	/// Gauss-Jordan elimination with partial pivoting.
+	/// </summary>
+	inline Matrix Inverse(Matrix a_mMatrix)
+	{
+		Matrix result = Identity();
+		for (int c = 0; c < 4; c++)
+		{
+			int iPivot = c;
+			for (int r = c + 1; r < 4; r++)
+			{
+				if (std::fabs(a_mMatrix.m[r][c]) > std::fabs(a_mMatrix.m[iPivot][c])) iPivot = r;
+			}
+			std::swap(a_mMatrix.m[c], a_mMatrix.m[iPivot]);
+			std::swap(result.m[c], result.m[iPivot]);
+
+			double fScale = 1.0 / a_mMatrix.m[c][c];
+			for (int k = 0; k < 4; k++)
+			{
+				a_mMatrix.m[c][k] *= fScale;
+				result.m[c][k] *= fScale;
+			}
+			for (int r = 0; r < 4; r++)
+			{
+				if (r == c) continue;
+				double fFactor = a_mMatrix.m[r][c];
+				for (int k = 0; k < 4; k++)
+				{
+					a_mMatrix.m[r][k] -= fFactor * a_mMatrix.m[c][k];
+					result.m[r][k] -= fFactor * result.m[c][k];
+				}
+			}
+		}
+		return result;
+	}
+
+	/// <summary>
+	/// Scale * roll/pitch/yaw rotation * translation, as Transform builds it.
+	/// </summary>
+	inline Matrix World(const DirectX::XMFLOAT3& a_v3Position, const DirectX::XMFLOAT3& a_v3Rotation, const DirectX::XMFLOAT3& a_v3Scale)
+	{
+		double sp = std::sin(static_cast<double>(a_v3Rotation.x)), cp = std::cos(static_cast<double>(a_v3Rotation.x));
+		double sy = std::sin(static_cast<double>(a_v3Rotation.y)), cy = std::cos(static_cast<double>(a_v3Rotation.y));
+		double sr = std::sin(static_cast<double>(a_v3Rotation.z)), cr = std::cos(static_cast<double>(a_v3Rotation.z));
+		const double lRotation[3][3] =
+		{
+			{ cr * cy + sr * sp * sy, sr * cp, sr * sp * cy - cr * sy },
+			{ cr * sp * sy - sr * cy, cr * cp, sr * sy + cr * sp * cy },
+			{ cp * sy, -sp, cp * cy },
+		};
+		const double lScale[3] = { a_v3Scale.x, a_v3Scale.y, a_v3Scale.z };
+
+		Matrix result = Identity();
+		for (int r = 0; r < 3; r++)
+			for (int c = 0; c < 3; c++) result.m[r][c] = lRotation[r][c] * lScale[r];
+		result.m[3][0] = a_v3Position.x;
+		result.m[3][1] = a_v3Position.y;
+		result.m[3][2] = a_v3Position.z;
+		return result;
+	}
+
+	/// <summary>
+	/// Largest difference between a float matrix and a reference, relative to
+	/// the reference's largest element so it reads the same at any scale.
+	/// </summary>
+	inline double RelativeError(const DirectX::XMFLOAT4X4& a_m4Matrix, const Matrix& a_mReference)
+	{
+		double fLargest = 0.0;
+		double fError = 0.0;
+		for (int r = 0; r < 4; r++)
+		{
+			for (int c = 0; c < 4; c++)
+			{
+				fLargest = std::max(fLargest, std::fabs(a_mReference.m[r][c]));
+				fError = std::max(fError, std::fabs(a_m4Matrix.m[r][c] - a_mReference.m[r][c]));
+			}
+		}
+		return fLargest > 0.0 ? fError / fLargest : fError;
+	}
+}
+
+#endif //__DOUBLEMATH_H_
@@ -0,0 +1,145 @@
+// Checks FrustumCuller against boxes inside, outside and crossing the planes
+// of a perspective and an orthographic view, and its SIMD batches against a
+// plane by plane test of many random boxes.
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Check.h"
+#include "FrustumCuller.h"
+
+using namespace DirectX;
+
+namespace
+{
+	/// <summary>
+	/// A box and whether it has to come back visible.
+	/// </summary>
+	struct BoxCase
+	{
+		const char* Name;
+		CullBox Box;
+		bool Visible;
+	};
+
+	Frustum MakeFrustum(FXMMATRIX a_mView, CXMMATRIX a_mProjection)
+	{
+		XMFLOAT4X4 m4ViewProjection;
+		XMStoreFloat4x4(&m4ViewProjection, a_mView * a_mProjection);
+		return FrustumCuller::ExtractFrustum(m4ViewProjection);
+	}
+
+	/// <summary>
+	/// Culls every case in one call, so some of them land in a partly filled batch.
+	/// </summary>
+	void CheckCases(const Frustum& a_fFrustum, const std::vector<BoxCase>& a_lCases)
+	{
+		std::vector<CullBox> lBoxes;
+		unsigned int uExpected = 0;
+		for (const BoxCase& bcCase : a_lCases)
+		{
+			lBoxes.push_back(bcCase.Box);
+			uExpected += bcCase.Visible ? 1 : 0;
+		}
+		std::vector<unsigned char> lVisible(lBoxes.size(), 2);
+		CHECK(FrustumCuller::Cull(a_fFrustum, lBoxes.data(), static_cast<unsigned int>(lBoxes.size()), lVisible.data()) == uExpected);
+		for (size_t i = 0; i < a_lCases.size(); i++)
+		{
+			if (!CHECK(lVisible[i] == (a_lCases[i].Visible ? 1 : 0))) printf("    case: %s\n", a_lCases[i].Name);
+		}
+	}
+
+	/// <summary>
+	/// Whether a box is fully behind any one plane, the same conservative test one box at a time.
+	/// </summary>
+	bool IsOutside(const Frustum& a_fFrustum, const CullBox& a_cbBox)
+	{
+		for (const XMFLOAT4& p : a_fFrustum.Planes)
+		{
+			float fDistance = p.x * a_cbBox.Center.x + p.y * a_cbBox.Center.y + p.z * a_cbBox.Center.z + p.w;
+			float fRadius = std::fabs(p.x) * a_cbBox.Extents.x + std::fabs(p.y) * a_cbBox.Extents.y + std::fabs(p.z) * a_cbBox.Extents.z;
+			if (fDistance + fRadius < 0.0f) return true;
+		}
+		return false;
+	}
+}
+
+int main()
+{
+	// Looking down +Z from the origin with a 90 degree field of view, so at a
+	// depth of z the sides of the frustum are z away from its center line.
+	XMMATRIX view = XMMatrixLookToLH(XMVectorSet(0, 0, 0, 1), XMVectorSet(0, 0, 1, 0), XMVectorSet(0, 1, 0, 0));
+	Frustum perspective = MakeFrustum(view, XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 1.0f, 100.0f));
+
+	// The planes come out normalized.
+	for (const XMFLOAT4& p : perspective.Planes) CHECK_NEAR(std::sqrt(p.x * p.x + p.y * p.y + p.z * p.z), 1.0f, 1e-5f);
+
+	CheckCases(perspective,
+	{
+		{ "inside", { { 0, 0, 10 }, { 1, 1, 1 } }, true },
+		{ "inside, off center", { { 6, -6, 20 }, { 2, 2, 2 } }, true },
+		{ "enclosing the whole frustum", { { 0, 0, 50 }, { 200, 200, 200 } }, true },
+		{ "behind the camera", { { 0, 0, -10 }, { 1, 1, 1 } }, false },
+		{ "past the far plane", { { 0, 0, 150 }, { 1, 1, 1 } }, false },
+		{ "left of the frustum", { { -15, 0, 10 }, { 1, 1, 1 } }, false },
+		{ "right of the frustum", { { 15, 0, 10 }, { 1, 1, 1 } }, false },
+		{ "below the frustum", { { 0, -15, 10 }, { 1, 1, 1 } }, false },
+		{ "above the frustum", { { 0, 15, 10 }, { 1, 1, 1 } }, false },
+		{ "crossing the left plane", { { -10, 0, 10 }, { 1, 1, 1 } }, true },
+		{ "crossing the top plane", { { 0, 10.5f, 10 }, { 1, 1, 1 } }, true },
+		{ "crossing the near plane", { { 0, 0, 1 }, { 0.5f, 0.5f, 0.5f } }, true },
+		{ "crossing the far plane", { { 0, 0, 100 }, { 1, 1, 1 } }, true },
+	});
+
+	// Orthographic, 20 wide and 10 tall, from 0 to 50 along +Z.
+	Frustum orthographic = MakeFrustum(view, XMMatrixOrthographicLH(20.0f, 10.0f, 0.0f, 50.0f));
+	CheckCases(orthographic,
+	{
+		{ "ortho inside", { { 5, 2, 25 }, { 1, 1, 1 } }, true },
+		{ "ortho outside the sides", { { 12, 0, 25 }, { 1, 1, 1 } }, false },
+		{ "ortho outside the top", { { 0, 7, 25 }, { 1, 1, 1 } }, false },
+		{ "ortho behind", { { 0, 0, -5 }, { 1, 1, 1 } }, false },
+		{ "ortho crossing the side", { { 10, 0, 25 }, { 1, 1, 1 } }, true },
+		{ "ortho crossing the far plane", { { 0, 0, 50.5f }, { 1, 1, 1 } }, true },
+	});
+
+	// A box rotated 45 degrees around Y grows to fit its corners.
+	XMFLOAT4X4 m4World;
+	XMStoreFloat4x4(&m4World, XMMatrixRotationRollPitchYaw(0.0f, XM_PIDIV4, 0.0f) * XMMatrixTranslation(3.0f, 4.0f, 5.0f));
+	CullBox rotated = FrustumCuller::TransformBox(XMFLOAT3(-1, -1, -1), XMFLOAT3(1, 1, 1), m4World);
+	CHECK_NEAR(rotated.Center.x, 3.0f, 1e-5f);
+	CHECK_NEAR(rotated.Center.y, 4.0f, 1e-5f);
+	CHECK_NEAR(rotated.Center.z, 5.0f, 1e-5f);
+	CHECK_NEAR(rotated.Extents.x, std::sqrt(2.0f), 1e-5f);
+	CHECK_NEAR(rotated.Extents.y, 1.0f, 1e-5f);
+	CHECK_NEAR(rotated.Extents.z, std::sqrt(2.0f), 1e-5f);
+
+	// Random boxes all around the camera give the same answer as one box at a time.
+	std::mt19937 rng(12);
+	std::uniform_real_distribution<float> fCenter(-120.0f, 120.0f);
+	std::uniform_real_distribution<float> fExtent(0.1f, 8.0f);
+	std::vector<CullBox> lBoxes(10001);
+	for (CullBox& box : lBoxes)
+	{
+		box.Center = XMFLOAT3(fCenter(rng), fCenter(rng), fCenter(rng));
+		box.Extents = XMFLOAT3(fExtent(rng), fExtent(rng), fExtent(rng));
+	}
+	std::vector<unsigned char> lVisible(lBoxes.size());
+	unsigned int uVisible = FrustumCuller::Cull(perspective, lBoxes.data(), static_cast<unsigned int>(lBoxes.size()), lVisible.data());
+	unsigned int uExpected = 0;
+	unsigned int uMismatches = 0;
+	for (size_t i = 0; i < lBoxes.size(); i++)
+	{
+		bool bVisible = !IsOutside(perspective, lBoxes[i]);
+		uExpected += bVisible ? 1 : 0;
+		if (lVisible[i] != (bVisible ? 1 : 0)) uMismatches++;
+	}
+	printf("%u of %zu random boxes visible\n", uVisible, lBoxes.size());
+	CHECK(uMismatches == 0);
+	CHECK(uVisible == uExpected);
+	CHECK(uVisible > 0 && uVisible < lBoxes.size());
+
+	return Check::Report("FrustumCullerTest");
+}
@@ -0,0 +1,145 @@
+// Checks InstanceBatcher: entities are grouped by mesh, material and level of
+// detail, groups smaller than the minimum are left to draw one by one, the
+// order does not depend on where meshes and materials live, and each batch's
+// First and Count pick out its own entities from instance data laid out in Order.
+
+#include <cstdio>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "Check.h"
+#include "InstanceBatcher.h"
+
+namespace
+{
+	/// <summary>
+	/// Stand ins for meshes and materials, only their addresses matter.
+	/// </summary>
+	int g_lMeshes[3];
+	int g_lMaterials[3];
+
+	bool SameKey(const InstanceKey& a_ikA, const InstanceKey& a_ikB)
+	{
+		return a_ikA.Mesh == a_ikB.Mesh && a_ikA.Material == a_ikB.Material && a_ikA.Lod == a_ikB.Lod;
+	}
+
+	/// <summary>
+	/// Keys with one or two meshes and materials in both orders, a level of detail
+	/// apart, an entity not drawn and one whose key no other entity has.
+	/// </summary>
+	std::vector<InstanceKey> SmallScene(const void* a_pMeshA, const void* a_pMeshB, const void* a_pMaterialA, const void* a_pMaterialB)
+	{
+		return {
+			{ a_pMeshA, a_pMaterialA, 0 },		// 0
+			{ a_pMeshB, a_pMaterialA, 0 },		// 1
+			{ a_pMeshA, a_pMaterialA, 0 },		// 2
+			{ a_pMeshA, a_pMaterialB, 0 },		// 3
+			{ a_pMeshA, a_pMaterialA, 1 },		// 4
+			{ nullptr, a_pMaterialA, 0 },		// 5, not drawn
+			{ a_pMeshB, a_pMaterialA, 0 },		// 6
+			{ a_pMeshA, a_pMaterialA, 0 },		// 7
+			{ a_pMeshA, a_pMaterialB, 0 },		// 8
+			{ a_pMeshA, a_pMaterialA, 1 },		// 9
+			{ a_pMeshB, a_pMaterialB, 0 },		// 10, alone
+		};
+	}
+}
+
+int main()
+{
+	// Groups come in the order of their first entity, each in entity order.
+	std::vector<InstanceKey> lKeys = SmallScene(&g_lMeshes[0], &g_lMeshes[1], &g_lMaterials[0], &g_lMaterials[1]);
+	InstanceBatches ibBatches;
+	CHECK(InstanceBatcher::Build(lKeys.data(), lKeys.size(), ibBatches) == 9);
+	CHECK(ibBatches.Order == std::vector<uint32_t>({ 0, 2, 7, 1, 6, 3, 8, 4, 9 }));
+	CHECK(ibBatches.Batches.size() == 4);
+	if (ibBatches.Batches.size() == 4)
+	{
+		CHECK(ibBatches.Batches[0].First == 0 && ibBatches.Batches[0].Count == 3);
+		CHECK(ibBatches.Batches[1].First == 3 && ibBatches.Batches[1].Count == 2);
+		CHECK(ibBatches.Batches[2].First == 5 && ibBatches.Batches[2].Count == 2);
+		CHECK(ibBatches.Batches[3].First == 7 && ibBatches.Batches[3].Count == 2);
+	}
+	CHECK(ibBatches.Batched == std::vector<unsigned char>({ 1, 1, 1, 1, 1, 0, 1, 1, 1, 1, 0 }));
+
+	// Swapping which mesh and material sit first in memory changes nothing.
+	InstanceBatches ibSwapped;
+	std::vector<InstanceKey> lSwapped = SmallScene(&g_lMeshes[1], &g_lMeshes[0], &g_lMaterials[1], &g_lMaterials[0]);
+	InstanceBatcher::Build(lSwapped.data(), lSwapped.size(), ibSwapped);
+	CHECK(ibSwapped.Order == ibBatches.Order);
+	CHECK(ibSwapped.Batched == ibBatches.Batched);
+
+	// A higher minimum leaves more to single draws, a minimum of one batches everything drawn.
+	CHECK(InstanceBatcher::Build(lKeys.data(), lKeys.size(), ibBatches, 3) == 3);
+	CHECK(ibBatches.Batches.size() == 1 && ibBatches.Order == std::vector<uint32_t>({ 0, 2, 7 }));
+	CHECK(ibBatches.Batched == std::vector<unsigned char>({ 1, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0 }));
+	CHECK(InstanceBatcher::Build(lKeys.data(), lKeys.size(), ibBatches, 1) == 10);
+	CHECK(ibBatches.Batches.size() == 5 && ibBatches.Batches.back().First == 9 && ibBatches.Batches.back().Count == 1);
+	CHECK(ibBatches.Batched[10] == 1 && ibBatches.Batched[5] == 0);
+
+	// Building again replaces what was there.
+	CHECK(InstanceBatcher::Build(lKeys.data(), 0, ibBatches) == 0);
+	CHECK(ibBatches.Order.empty() && ibBatches.Batches.empty() && ibBatches.Batched.empty());
+
+	// Random scenes, with instance data written in Order as InstanceRenderer does
+	// and read back through each batch's First and Count.
+	std::mt19937 rng(17);
+	unsigned int uWrongKey = 0, uOutOfOrder = 0, uGaps = 0, uWrongFlags = 0, uSmall = 0, uMissed = 0, uBatched = 0, uTotal = 0;
+	for (int s = 0; s < 200; s++)
+	{
+		size_t uCount = 1 + rng() % 500;
+		lKeys.resize(uCount);
+		for (InstanceKey& key : lKeys)
+		{
+			key.Mesh = rng() % 8 == 0 ? nullptr : &g_lMeshes[rng() % 3];
+			key.Material = &g_lMaterials[rng() % 3];
+			key.Lod = rng() % 4;
+		}
+		uBatched += InstanceBatcher::Build(lKeys.data(), uCount, ibBatches);
+		uTotal += static_cast<unsigned int>(uCount);
+
+		std::vector<uint32_t> lInstances(ibBatches.Order.size());
+		for (size_t i = 0; i < ibBatches.Order.size(); i++) lInstances[i] = ibBatches.Order[i];
+
+		uint32_t uNext = 0, uLastFirst = 0;
+		std::vector<unsigned char> lSeen(uCount, 0);
+		for (const InstanceBatch& batch : ibBatches.Batches)
+		{
+			uGaps += batch.First != uNext;
+			uSmall += batch.Count < InstanceBatcher::MIN_INSTANCES;
+			uNext = batch.First + batch.Count;
+			if (uNext > lInstances.size()) break;
+			uint32_t uFirst = lInstances[batch.First];
+			uOutOfOrder += batch.First != 0 && uFirst < uLastFirst;
+			uLastFirst = uFirst;
+			for (uint32_t i = batch.First; i < uNext; i++)
+			{
+				uWrongKey += !SameKey(lKeys[lInstances[i]], lKeys[uFirst]);
+				uOutOfOrder += i > batch.First && lInstances[i] <= lInstances[i - 1];
+				lSeen[lInstances[i]] = 1;
+			}
+		}
+		uGaps += uNext != lInstances.size();
+		uWrongFlags += lSeen != ibBatches.Batched;
+
+		// What is left to single draws is in a group too small to batch.
+		std::map<std::tuple<const void*, const void*, uint32_t>, unsigned int> lGroupSizes;
+		for (const InstanceKey& key : lKeys) lGroupSizes[std::make_tuple(key.Mesh, key.Material, key.Lod)]++;
+		for (size_t i = 0; i < uCount; i++)
+		{
+			bool bWorthBatching = lKeys[i].Mesh != nullptr && lGroupSizes[std::make_tuple(lKeys[i].Mesh, lKeys[i].Material, lKeys[i].Lod)] >= InstanceBatcher::MIN_INSTANCES;
+			uMissed += bWorthBatching != (ibBatches.Batched[i] != 0);
+		}
+	}
+	printf("%u of %u entities batched\n", uBatched, uTotal);
+	CHECK(uWrongKey == 0);
+	CHECK(uOutOfOrder == 0);
+	CHECK(uGaps == 0);
+	CHECK(uWrongFlags == 0);
+	CHECK(uSmall == 0);
+	CHECK(uMissed == 0);
+
+	return Check::Report("InstanceBatcherTest");
+}
@@ -0,0 +1,128 @@
+// Checks that MeshSimplifier's levels of detail get monotonically coarser
+// within the error limit, and that generating them twice gives the same bytes.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+#include "MeshSimplifier.h"
+#include "ObjLoader.h"
+
+namespace
+{
+	const char* g_lModels[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+	const float g_fMaxError = 0.05f;
+
+	/// <summary>
+	/// Builds a gently rolling square of terrain without uv or normal seams,
+	/// dense enough for the whole chain of levels.  The shipped models stop
+	/// after a level or two.
+	/// </summary>
+	void BuildTerrain(int a_iQuads, std::vector<Vertex>& a_lVertices, std::vector<unsigned int>& a_lIndices)
+	{
+		for (int z = 0; z <= a_iQuads; z++)
+		{
+			for (int x = 0; x <= a_iQuads; x++)
+			{
+				float fX = static_cast<float>(x) / a_iQuads;
+				float fZ = static_cast<float>(z) / a_iQuads;
+				float fSlopeX = 0.3f * std::cos(fX * 6.0f);
+				float fSlopeZ = -0.2f * std::sin(fZ * 4.0f);
+				Vertex vertex = {};
+				vertex.Position = DirectX::XMFLOAT3(fX * 10.0f, 0.5f * std::sin(fX * 6.0f) + 0.5f * std::cos(fZ * 4.0f), fZ * 10.0f);
+				float fLength = std::sqrt(fSlopeX * fSlopeX + 1.0f + fSlopeZ * fSlopeZ);
+				vertex.Normal = DirectX::XMFLOAT3(-fSlopeX / fLength, 1.0f / fLength, -fSlopeZ / fLength);
+				vertex.UV = DirectX::XMFLOAT2(fX, fZ);
+				a_lVertices.push_back(vertex);
+			}
+		}
+		for (int z = 0; z < a_iQuads; z++)
+		{
+			for (int x = 0; x < a_iQuads; x++)
+			{
+				unsigned int a = z * (a_iQuads + 1) + x;
+				unsigned int c = a + a_iQuads + 1;
+				a_lIndices.insert(a_lIndices.end(), { a, c, a + 1, a + 1, c, c + 1 });
+			}
+		}
+	}
+}
+
+int main()
+{
+	printf("%-18s %s\n", "model", "triangles per level (error)");
+	std::vector<std::string> lNames(std::begin(g_lModels), std::end(g_lModels));
+	lNames.push_back("terrain");
+	for (const std::string& sName : lNames)
+	{
+		std::vector<Vertex> lVertices;
+		std::vector<unsigned int> lIndices;
+		if (sName == "terrain")
+			BuildTerrain(64, lVertices, lIndices);
+		else if (!CHECK(ObjLoader::Load((MODELS_DIR + sName + ".graphics_obj").c_str(), lVertices, lIndices)))
+			continue;
+
+		MeshLod lLods[MeshSimplifier::MAX_LOD_COUNT] = {};
+		unsigned int uLodCount = 0;
+		std::vector<unsigned int> lResult = MeshSimplifier::GenerateLods(
+			lVertices.data(), lVertices.size(), lIndices.data(), lIndices.size(), lLods, uLodCount, g_fMaxError);
+
+		// The same input, from different copies, gives exactly the same levels.
+		std::vector<Vertex> lVerticesCopy = lVertices;
+		std::vector<unsigned int> lIndicesCopy = lIndices;
+		MeshLod lLodsAgain[MeshSimplifier::MAX_LOD_COUNT] = {};
+		unsigned int uLodCountAgain = 0;
+		std::vector<unsigned int> lResultAgain = MeshSimplifier::GenerateLods(
+			lVerticesCopy.data(), lVerticesCopy.size(), lIndicesCopy.data(), lIndicesCopy.size(), lLodsAgain, uLodCountAgain, g_fMaxError);
+		CHECK(lResultAgain == lResult);
+		CHECK(uLodCountAgain == uLodCount);
+		CHECK(memcmp(lLodsAgain, lLods, sizeof(lLods)) == 0);
+
+		// The first level is the full detail list untouched, the rest follow it back to back.
+		if (!CHECK(uLodCount >= 1 && uLodCount <= MeshSimplifier::MAX_LOD_COUNT)) continue;
+		CHECK(lLods[0].IndexStart == 0);
+		CHECK(lLods[0].IndexCount == lIndices.size());
+		CHECK(lLods[0].Error == 0.0f);
+		CHECK(std::equal(lIndices.begin(), lIndices.end(), lResult.begin()));
+
+		printf("%-18s %u", sName.c_str(), lLods[0].IndexCount / 3);
+		for (unsigned int i = 1; i < uLodCount; i++)
+		{
+			printf(" -> %u (%.4f)", lLods[i].IndexCount / 3, lLods[i].Error);
+			CHECK(lLods[i].IndexStart == lLods[i - 1].IndexStart + lLods[i - 1].IndexCount);
+			CHECK(lLods[i].IndexCount % 3 == 0);
+			CHECK(lLods[i].IndexCount > 0);
+			CHECK(lLods[i].IndexCount < lLods[i - 1].IndexCount);
+			CHECK(lLods[i].Error >= lLods[i - 1].Error);
+			CHECK(lLods[i].Error <= g_fMaxError);
+		}
+		printf("\n");
+		if (sName == "terrain") CHECK(uLodCount == MeshSimplifier::MAX_LOD_COUNT);
+		CHECK(lLods[uLodCount - 1].IndexStart + lLods[uLodCount - 1].IndexCount == lResult.size());
+
+		// Every level indexes the original vertices and has no collapsed triangles left.
+		unsigned int uBadTriangles = 0;
+		for (size_t i = 0; i + 2 < lResult.size(); i += 3)
+		{
+			unsigned int a = lResult[i], b = lResult[i + 1], c = lResult[i + 2];
+			if (a >= lVertices.size() || b >= lVertices.size() || c >= lVertices.size() || a == b || b == c || a == c) uBadTriangles++;
+		}
+		CHECK(uBadTriangles == 0);
+
+		// Simplify stops at its target or its error limit, whichever comes first.
+		float fError = -1.0f;
+		std::vector<unsigned int> lHalf = MeshSimplifier::Simplify(
+			lVertices.data(), lVertices.size(), lIndices.data(), lIndices.size(), lIndices.size() / 2, g_fMaxError, &fError);
+		CHECK(lHalf.size() % 3 == 0);
+		CHECK(lHalf.size() <= lIndices.size());
+		CHECK(fError >= 0.0f && fError <= g_fMaxError);
+		CHECK(MeshSimplifier::Simplify(lVertices.data(), lVertices.size(), lIndices.data(), lIndices.size(), lIndices.size() / 2, g_fMaxError) == lHalf);
+	}
+
+	return Check::Report("MeshSimplifierTest");
+}
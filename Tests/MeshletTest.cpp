@@ -0,0 +1,173 @@
+// Checks that MeshletBuilder only regroups triangles within its limits, and
+// that MeshletCuller culls meshlets facing away from the camera or outside
+// the view while keeping every meshlet with a triangle that could be seen.
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+#include "MeshletCuller.h"
+#include "ObjLoader.h"
+
+using namespace DirectX;
+
+namespace
+{
+	typedef std::array<unsigned int, 3> Triangle;
+
+	/// <summary>
+	/// Gets a triangle list's triangles in a canonical order, each rotated to
+	/// start at its smallest index so the winding is kept.
+	/// </summary>
+	std::vector<Triangle> SortedTriangles(const std::vector<unsigned int>& a_lIndices)
+	{
+		std::vector<Triangle> lTriangles;
+		for (size_t i = 0; i + 2 < a_lIndices.size(); i += 3)
+		{
+			Triangle t = { a_lIndices[i], a_lIndices[i + 1], a_lIndices[i + 2] };
+			std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+			lTriangles.push_back(t);
+		}
+		std::sort(lTriangles.begin(), lTriangles.end());
+		return lTriangles;
+	}
+
+	/// <summary>
+	/// Whether a point sees the front of a triangle, with Direct3D's clockwise front faces.
+	/// </summary>
+	bool IsFrontFacing(const Vertex* a_pVertices, const unsigned int* a_pTriangle, const XMFLOAT3& a_v3Point)
+	{
+		XMVECTOR a = XMLoadFloat3(&a_pVertices[a_pTriangle[0]].Position);
+		XMVECTOR b = XMLoadFloat3(&a_pVertices[a_pTriangle[1]].Position);
+		XMVECTOR c = XMLoadFloat3(&a_pVertices[a_pTriangle[2]].Position);
+		XMVECTOR normal = XMVector3Cross(b - a, c - a);
+		return XMVectorGetX(XMVector3Dot(normal, XMLoadFloat3(&a_v3Point) - a)) > 0.0f;
+	}
+
+	Frustum MakeFrustum(const XMFLOAT3& a_v3Position, const XMFLOAT3& a_v3Direction)
+	{
+		XMFLOAT4X4 m4ViewProjection;
+		XMStoreFloat4x4(&m4ViewProjection,
+			XMMatrixLookToLH(XMLoadFloat3(&a_v3Position), XMLoadFloat3(&a_v3Direction), XMVectorSet(0, 1, 0, 0)) *
+			XMMatrixPerspectiveFovLH(XM_PIDIV4, 1.0f, 0.1f, 100.0f));
+		return FrustumCuller::ExtractFrustum(m4ViewProjection);
+	}
+}
+
+int main()
+{
+	// A flat patch of 4 x 4 quads in the XY plane, small enough for one meshlet,
+	// its front facing -Z.
+	std::vector<Vertex> lPatch;
+	std::vector<unsigned int> lPatchIndices;
+	for (int y = 0; y <= 4; y++)
+	{
+		for (int x = 0; x <= 4; x++)
+		{
+			Vertex vertex = {};
+			vertex.Position = XMFLOAT3(x * 0.5f - 1.0f, y * 0.5f - 1.0f, 0.0f);
+			vertex.Normal = XMFLOAT3(0.0f, 0.0f, -1.0f);
+			lPatch.push_back(vertex);
+		}
+	}
+	for (unsigned int y = 0; y < 4; y++)
+	{
+		for (unsigned int x = 0; x < 4; x++)
+		{
+			unsigned int a = y * 5 + x;
+			lPatchIndices.insert(lPatchIndices.end(), { a, a + 5, a + 1, a + 1, a + 5, a + 6 });
+		}
+	}
+	std::vector<Meshlet> lPatchMeshlets = MeshletBuilder::Build(lPatch.data(), lPatch.size(), lPatchIndices.data(), lPatchIndices.size());
+	CHECK(lPatchMeshlets.size() == 1);
+	CHECK(IsFrontFacing(lPatch.data(), lPatchIndices.data(), XMFLOAT3(0.0f, 0.0f, -5.0f)));
+
+	// Seen from the front it is kept, from behind it is culled, and edge on it is kept.
+	const Meshlet& patch = lPatchMeshlets[0];
+	CHECK(!MeshletCuller::IsBackFacing(patch, XMFLOAT3(0.0f, 0.0f, -5.0f)));
+	CHECK(MeshletCuller::IsBackFacing(patch, XMFLOAT3(0.0f, 0.0f, 5.0f)));
+	CHECK(MeshletCuller::IsBackFacing(patch, XMFLOAT3(3.0f, -2.0f, 0.5f)));
+	CHECK(!MeshletCuller::IsBackFacing(patch, XMFLOAT3(5.0f, 0.0f, -0.01f)));
+
+	// Through Cull(), with the camera behind the patch looking at it.
+	XMFLOAT4X4 m4Identity;
+	XMStoreFloat4x4(&m4Identity, XMMatrixIdentity());
+	std::vector<IndexRange> lRanges;
+	MeshletCullStats stats = {};
+	XMFLOAT3 v3Behind(0.0f, 0.0f, 5.0f);
+	CHECK(MeshletCuller::Cull(lPatchMeshlets.data(), lPatchMeshlets.size(), m4Identity, MakeFrustum(v3Behind, XMFLOAT3(0, 0, -1)), v3Behind, lRanges, stats) == 0);
+	CHECK(stats.BackfaceCulled == 1);
+	CHECK(lRanges.empty());
+
+	// The world matrix is applied: turned around, the patch faces that camera.
+	XMFLOAT4X4 m4Turned;
+	XMStoreFloat4x4(&m4Turned, XMMatrixRotationRollPitchYaw(0.0f, XM_PI, 0.0f));
+	stats = {};
+	CHECK(MeshletCuller::Cull(lPatchMeshlets.data(), lPatchMeshlets.size(), m4Turned, MakeFrustum(v3Behind, XMFLOAT3(0, 0, -1)), v3Behind, lRanges, stats) == 1);
+	CHECK(stats.BackfaceCulled == 0);
+
+	// The sphere seen from outside: the far side is culled, nothing that could be seen is.
+	std::vector<Vertex> lVertices;
+	std::vector<unsigned int> lIndices;
+	if (CHECK(ObjLoader::Load((std::string(MODELS_DIR) + "sphere.graphics_obj").c_str(), lVertices, lIndices)))
+	{
+		std::vector<unsigned int> lOriginal = lIndices;
+		std::vector<Meshlet> lMeshlets = MeshletBuilder::Build(lVertices.data(), lVertices.size(), lIndices.data(), lIndices.size(), 0, 32, 32);
+		CHECK(SortedTriangles(lIndices) == SortedTriangles(lOriginal));
+
+		// Back to back through the index list, within the limits.
+		uint32_t uNext = 0;
+		bool bWithinLimits = true;
+		for (const Meshlet& meshlet : lMeshlets)
+		{
+			bWithinLimits &= meshlet.IndexStart == uNext && meshlet.TriangleCount > 0 && meshlet.TriangleCount <= 32 && meshlet.VertexCount <= 32;
+			uNext = meshlet.IndexStart + meshlet.TriangleCount * 3;
+		}
+		CHECK(bWithinLimits);
+		CHECK(uNext == lIndices.size());
+
+		XMFLOAT3 v3Camera(0.0f, 0.0f, -4.0f);
+		unsigned int uCulled = 0;
+		unsigned int uWronglyCulled = 0;
+		for (const Meshlet& meshlet : lMeshlets)
+		{
+			if (!MeshletCuller::IsBackFacing(meshlet, v3Camera)) continue;
+			uCulled++;
+			for (uint32_t t = 0; t < meshlet.TriangleCount; t++)
+			{
+				if (IsFrontFacing(lVertices.data(), &lIndices[meshlet.IndexStart + t * 3], v3Camera))
+				{
+					uWronglyCulled++;
+					break;
+				}
+			}
+		}
+		printf("sphere: %u of %zu meshlets facing away\n", uCulled, lMeshlets.size());
+		CHECK(uCulled > 0);
+		CHECK(uWronglyCulled == 0);
+
+		// Cull() agrees, and its ranges cover exactly the kept triangles.
+		lRanges.clear();
+		stats = {};
+		MeshletCuller::Cull(lMeshlets.data(), lMeshlets.size(), m4Identity, MakeFrustum(v3Camera, XMFLOAT3(0, 0, 1)), v3Camera, lRanges, stats);
+		CHECK(stats.Meshlets == lMeshlets.size());
+		CHECK(stats.FrustumCulled == 0);
+		CHECK(stats.BackfaceCulled == uCulled);
+		CHECK(stats.Ranges == lRanges.size());
+		uint32_t uRangeIndices = 0;
+		for (const IndexRange& range : lRanges) uRangeIndices += range.IndexCount;
+		CHECK(uRangeIndices == stats.TrianglesKept * 3);
+
+		// Looking away from the sphere, everything is outside the view.
+		lRanges.clear();
+		stats = {};
+		MeshletCuller::Cull(lMeshlets.data(), lMeshlets.size(), m4Identity, MakeFrustum(v3Camera, XMFLOAT3(0, 0, -1)), v3Camera, lRanges, stats);
+		CHECK(stats.FrustumCulled + stats.BackfaceCulled == lMeshlets.size());
+		CHECK(lRanges.empty());
+	}
+
+	return Check::Report("MeshletTest");
+}
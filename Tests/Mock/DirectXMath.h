@@ -0,0 +1,446 @@
+#ifndef __MOCK_DIRECTXMATH_H_
+#define __MOCK_DIRECTXMATH_H_
+
+// Stand-in for the subset of DirectXMath the engine's CPU modules use, so the
+// tests build on hosts without the Windows SDK.  Same types, conventions (row
+// vectors, left handed, 0 to 1 clip depth) and SSE register layout as the real
+// library's _XM_SSE_INTRINSICS_ path; precision may differ in the last bit.
+
+#include <cmath>
+#include <cstdint>
+#include <xmmintrin.h>
+#include <emmintrin.h>
+
+namespace DirectX
+{
+	constexpr float XM_PI = 3.141592654f;
+	constexpr float XM_2PI = 6.283185307f;
+	constexpr float XM_PIDIV2 = 1.570796327f;
+	constexpr float XM_PIDIV4 = 0.785398163f;
+
+	constexpr float XMConvertToRadians(float a_fDegrees) { return a_fDegrees * (XM_PI / 180.0f); }
+	constexpr float XMConvertToDegrees(float a_fRadians) { return a_fRadians * (180.0f / XM_PI); }
+
+	// GCC and Clang give __m128 the arithmetic operators DirectXMath overloads.
+	typedef __m128 XMVECTOR;
+	typedef const XMVECTOR FXMVECTOR;
+	typedef const XMVECTOR GXMVECTOR;
+	typedef const XMVECTOR HXMVECTOR;
+	typedef const XMVECTOR& CXMVECTOR;
+
+	struct XMFLOAT2
+	{
+		float x, y;
+		XMFLOAT2() = default;
+		constexpr XMFLOAT2(float a_fX, float a_fY) : x(a_fX), y(a_fY) {}
+	};
+
+	struct XMFLOAT3
+	{
+		float x, y, z;
+		XMFLOAT3() = default;
+		constexpr XMFLOAT3(float a_fX, float a_fY, float a_fZ) : x(a_fX), y(a_fY), z(a_fZ) {}
+	};
+
+	struct XMFLOAT4
+	{
+		float x, y, z, w;
+		XMFLOAT4() = default;
+		constexpr XMFLOAT4(float a_fX, float a_fY, float a_fZ, float a_fW) : x(a_fX), y(a_fY), z(a_fZ), w(a_fW) {}
+	};
+
+	struct alignas(16) XMFLOAT4A : public XMFLOAT4
+	{
+		XMFLOAT4A() = default;
+		constexpr XMFLOAT4A(float a_fX, float a_fY, float a_fZ, float a_fW) : XMFLOAT4(a_fX, a_fY, a_fZ, a_fW) {}
+	};
+
+	struct XMFLOAT4X4
+	{
+		union
+		{
+			struct
+			{
+				float _11, _12, _13, _14;
+				float _21, _22, _23, _24;
+				float _31, _32, _33, _34;
+				float _41, _42, _43, _44;
+			};
+			float m[4][4];
+		};
+		XMFLOAT4X4() = default;
+		constexpr XMFLOAT4X4(
+			float a_f00, float a_f01, float a_f02, float a_f03,
+			float a_f10, float a_f11, float a_f12, float a_f13,
+			float a_f20, float a_f21, float a_f22, float a_f23,
+			float a_f30, float a_f31, float a_f32, float a_f33) :
+			_11(a_f00), _12(a_f01), _13(a_f02), _14(a_f03),
+			_21(a_f10), _22(a_f11), _23(a_f12), _24(a_f13),
+			_31(a_f20), _32(a_f21), _33(a_f22), _34(a_f23),
+			_41(a_f30), _42(a_f31), _43(a_f32), _44(a_f33) {}
+		float operator()(size_t a_uRow, size_t a_uColumn) const { return m[a_uRow][a_uColumn]; }
+		float& operator()(size_t a_uRow, size_t a_uColumn) { return m[a_uRow][a_uColumn]; }
+	};
+
+	struct XMMATRIX;
+	typedef const XMMATRIX& FXMMATRIX;
+	typedef const XMMATRIX& CXMMATRIX;
+
+	struct alignas(16) XMMATRIX
+	{
+		XMVECTOR r[4];
+		XMMATRIX() = default;
+		XMMATRIX(FXMVECTOR a_vR0, FXMVECTOR a_vR1, FXMVECTOR a_vR2, CXMVECTOR a_vR3) : r{ a_vR0, a_vR1, a_vR2, a_vR3 } {}
+		XMMATRIX operator*(FXMMATRIX a_mOther) const;
+		XMMATRIX& operator*=(FXMMATRIX a_mOther);
+	};
+
+	#pragma region Load and store
+	inline XMVECTOR XMLoadFloat2(const XMFLOAT2* a_pSource) { return _mm_setr_ps(a_pSource->x, a_pSource->y, 0.0f, 0.0f); }
+	inline XMVECTOR XMLoadFloat3(const XMFLOAT3* a_pSource) { return _mm_setr_ps(a_pSource->x, a_pSource->y, a_pSource->z, 0.0f); }
+	inline XMVECTOR XMLoadFloat4(const XMFLOAT4* a_pSource) { return _mm_loadu_ps(&a_pSource->x); }
+	inline XMVECTOR XMLoadFloat4A(const XMFLOAT4A* a_pSource) { return _mm_load_ps(&a_pSource->x); }
+	inline XMMATRIX XMLoadFloat4x4(const XMFLOAT4X4* a_pSource)
+	{
+		return XMMATRIX(_mm_loadu_ps(a_pSource->m[0]), _mm_loadu_ps(a_pSource->m[1]), _mm_loadu_ps(a_pSource->m[2]), _mm_loadu_ps(a_pSource->m[3]));
+	}
+
+	inline void XMStoreFloat2(XMFLOAT2* a_pDestination, FXMVECTOR a_vV)
+	{
+		alignas(16) float f[4];
+		_mm_store_ps(f, a_vV);
+		a_pDestination->x = f[0];
+		a_pDestination->y = f[1];
+	}
+	inline void XMStoreFloat3(XMFLOAT3* a_pDestination, FXMVECTOR a_vV)
+	{
+		alignas(16) float f[4];
+		_mm_store_ps(f, a_vV);
+		a_pDestination->x = f[0];
+		a_pDestination->y = f[1];
+		a_pDestination->z = f[2];
+	}
+	inline void XMStoreFloat4(XMFLOAT4* a_pDestination, FXMVECTOR a_vV) { _mm_storeu_ps(&a_pDestination->x, a_vV); }
+	inline void XMStoreFloat4A(XMFLOAT4A* a_pDestination, FXMVECTOR a_vV) { _mm_store_ps(&a_pDestination->x, a_vV); }
+	inline void XMStoreInt4(uint32_t* a_pDestination, FXMVECTOR a_vV) { _mm_storeu_si128(reinterpret_cast<__m128i*>(a_pDestination), _mm_castps_si128(a_vV)); }
+	inline void XMStoreFloat4x4(XMFLOAT4X4* a_pDestination, FXMMATRIX a_mM)
+	{
+		for (int i = 0; i < 4; i++) _mm_storeu_ps(a_pDestination->m[i], a_mM.r[i]);
+	}
+	#pragma endregion
+
+	#pragma region Vector
+	inline XMVECTOR XMVectorSet(float a_fX, float a_fY, float a_fZ, float a_fW) { return _mm_setr_ps(a_fX, a_fY, a_fZ, a_fW); }
+	inline XMVECTOR XMVectorReplicate(float a_fValue) { return _mm_set1_ps(a_fValue); }
+	inline XMVECTOR XMVectorZero() { return _mm_setzero_ps(); }
+	inline XMVECTOR XMVectorSplatOne() { return _mm_set1_ps(1.0f); }
+	inline XMVECTOR XMVectorFalseInt() { return _mm_setzero_ps(); }
+	inline XMVECTOR XMVectorTrueInt() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+	inline XMVECTOR XMVectorSplatX(FXMVECTOR a_vV) { return _mm_shuffle_ps(a_vV, a_vV, _MM_SHUFFLE(0, 0, 0, 0)); }
+	inline XMVECTOR XMVectorSplatY(FXMVECTOR a_vV) { return _mm_shuffle_ps(a_vV, a_vV, _MM_SHUFFLE(1, 1, 1, 1)); }
+	inline XMVECTOR XMVectorSplatZ(FXMVECTOR a_vV) { return _mm_shuffle_ps(a_vV, a_vV, _MM_SHUFFLE(2, 2, 2, 2)); }
+	inline XMVECTOR XMVectorSplatW(FXMVECTOR a_vV) { return _mm_shuffle_ps(a_vV, a_vV, _MM_SHUFFLE(3, 3, 3, 3)); }
+	inline float XMVectorGetX(FXMVECTOR a_vV) { return _mm_cvtss_f32(a_vV); }
+	inline float XMVectorGetY(FXMVECTOR a_vV) { return _mm_cvtss_f32(XMVectorSplatY(a_vV)); }
+	inline float XMVectorGetZ(FXMVECTOR a_vV) { return _mm_cvtss_f32(XMVectorSplatZ(a_vV)); }
+	inline float XMVectorGetW(FXMVECTOR a_vV) { return _mm_cvtss_f32(XMVectorSplatW(a_vV)); }
+	inline XMVECTOR XMVectorSetW(FXMVECTOR a_vV, float a_fW)
+	{
+		alignas(16) float f[4];
+		_mm_store_ps(f, a_vV);
+		f[3] = a_fW;
+		return _mm_load_ps(f);
+	}
+
+	inline XMVECTOR XMVectorAdd(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_add_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorSubtract(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_sub_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorMultiply(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_mul_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorDivide(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_div_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorMultiplyAdd(FXMVECTOR a_vA, FXMVECTOR a_vB, FXMVECTOR a_vC) { return _mm_add_ps(_mm_mul_ps(a_vA, a_vB), a_vC); }
+	inline XMVECTOR XMVectorNegate(FXMVECTOR a_vV) { return _mm_sub_ps(_mm_setzero_ps(), a_vV); }
+	inline XMVECTOR XMVectorReciprocal(FXMVECTOR a_vV) { return _mm_div_ps(_mm_set1_ps(1.0f), a_vV); }
+	inline XMVECTOR XMVectorSqrt(FXMVECTOR a_vV) { return _mm_sqrt_ps(a_vV); }
+	inline XMVECTOR XMVectorAbs(FXMVECTOR a_vV) { return _mm_max_ps(a_vV, XMVectorNegate(a_vV)); }
+	inline XMVECTOR XMVectorMax(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_max_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorMin(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_min_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorScale(FXMVECTOR a_vV, float a_fScale) { return _mm_mul_ps(a_vV, _mm_set1_ps(a_fScale)); }
+	inline XMVECTOR XMVectorLerp(FXMVECTOR a_vA, FXMVECTOR a_vB, float a_fT) { return XMVectorMultiplyAdd(_mm_sub_ps(a_vB, a_vA), _mm_set1_ps(a_fT), a_vA); }
+
+	inline XMVECTOR XMVectorEqual(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_cmpeq_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorLess(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_cmplt_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorLessOrEqual(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_cmple_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorGreater(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_cmpgt_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorGreaterOrEqual(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_cmpge_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorAndInt(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_and_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorOrInt(FXMVECTOR a_vA, FXMVECTOR a_vB) { return _mm_or_ps(a_vA, a_vB); }
+	inline XMVECTOR XMVectorSelect(FXMVECTOR a_vA, FXMVECTOR a_vB, FXMVECTOR a_vControl)
+	{
+		return _mm_or_ps(_mm_andnot_ps(a_vControl, a_vA), _mm_and_ps(a_vControl, a_vB));
+	}
+
+	// Elements 0-3 come from the first vector, 4-7 from the second.
+	template<uint32_t X, uint32_t Y, uint32_t Z, uint32_t W>
+	inline XMVECTOR XMVectorPermute(FXMVECTOR a_vA, FXMVECTOR a_vB)
+	{
+		static_assert(X < 8 && Y < 8 && Z < 8 && W < 8, "Permute indices must be 0-7");
+		alignas(16) float f[8];
+		_mm_store_ps(f, a_vA);
+		_mm_store_ps(f + 4, a_vB);
+		return _mm_setr_ps(f[X], f[Y], f[Z], f[W]);
+	}
+
+	inline void XMVectorSinCos(XMVECTOR* a_pSin, XMVECTOR* a_pCos, FXMVECTOR a_vV)
+	{
+		alignas(16) float f[4], s[4], c[4];
+		_mm_store_ps(f, a_vV);
+		for (int i = 0; i < 4; i++)
+		{
+			s[i] = sinf(f[i]);
+			c[i] = cosf(f[i]);
+		}
+		*a_pSin = _mm_load_ps(s);
+		*a_pCos = _mm_load_ps(c);
+	}
+	#pragma endregion
+
+	#pragma region Vector3 and Vector4
+	inline XMVECTOR XMVector3Dot(FXMVECTOR a_vA, FXMVECTOR a_vB)
+	{
+		alignas(16) float f[4];
+		_mm_store_ps(f, _mm_mul_ps(a_vA, a_vB));
+		return _mm_set1_ps(f[0] + f[1] + f[2]);
+	}
+	inline XMVECTOR XMVector4Dot(FXMVECTOR a_vA, FXMVECTOR a_vB)
+	{
+		alignas(16) float f[4];
+		_mm_store_ps(f, _mm_mul_ps(a_vA, a_vB));
+		return _mm_set1_ps(f[0] + f[1] + f[2] + f[3]);
+	}
+	inline XMVECTOR XMVector3Cross(FXMVECTOR a_vA, FXMVECTOR a_vB)
+	{
+		XMVECTOR aYZX = _mm_shuffle_ps(a_vA, a_vA, _MM_SHUFFLE(3, 0, 2, 1));
+		XMVECTOR bYZX = _mm_shuffle_ps(a_vB, a_vB, _MM_SHUFFLE(3, 0, 2, 1));
+		XMVECTOR c = _mm_sub_ps(_mm_mul_ps(a_vA, bYZX), _mm_mul_ps(aYZX, a_vB));
+		return _mm_and_ps(_mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1)), _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+	}
+	inline XMVECTOR XMVector3LengthSq(FXMVECTOR a_vV) { return XMVector3Dot(a_vV, a_vV); }
+	inline XMVECTOR XMVector3Length(FXMVECTOR a_vV) { return _mm_sqrt_ps(XMVector3Dot(a_vV, a_vV)); }
+	inline XMVECTOR XMVector3Normalize(FXMVECTOR a_vV)
+	{
+		XMVECTOR vLength = XMVector3Length(a_vV);
+		XMVECTOR vResult = _mm_div_ps(a_vV, vLength);
+		// Zero length gives zero, like the real library.
+		return _mm_and_ps(vResult, _mm_cmpneq_ps(vLength, _mm_setzero_ps()));
+	}
+	inline XMVECTOR XMVector3Transform(FXMVECTOR a_vV, FXMMATRIX a_mM)
+	{
+		XMVECTOR vResult = _mm_mul_ps(XMVectorSplatX(a_vV), a_mM.r[0]);
+		vResult = _mm_add_ps(vResult, _mm_mul_ps(XMVectorSplatY(a_vV), a_mM.r[1]));
+		vResult = _mm_add_ps(vResult, _mm_mul_ps(XMVectorSplatZ(a_vV), a_mM.r[2]));
+		return _mm_add_ps(vResult, a_mM.r[3]);
+	}
+	inline XMVECTOR XMVector3TransformCoord(FXMVECTOR a_vV, FXMMATRIX a_mM)
+	{
+		XMVECTOR vResult = XMVector3Transform(a_vV, a_mM);
+		return _mm_div_ps(vResult, XMVectorSplatW(vResult));
+	}
+	inline XMVECTOR XMVector3TransformNormal(FXMVECTOR a_vV, FXMMATRIX a_mM)
+	{
+		XMVECTOR vResult = _mm_mul_ps(XMVectorSplatX(a_vV), a_mM.r[0]);
+		vResult = _mm_add_ps(vResult, _mm_mul_ps(XMVectorSplatY(a_vV), a_mM.r[1]));
+		return _mm_add_ps(vResult, _mm_mul_ps(XMVectorSplatZ(a_vV), a_mM.r[2]));
+	}
+	inline XMVECTOR XMVector4Transform(FXMVECTOR a_vV, FXMMATRIX a_mM)
+	{
+		XMVECTOR vResult = XMVector3TransformNormal(a_vV, a_mM);
+		return _mm_add_ps(vResult, _mm_mul_ps(XMVectorSplatW(a_vV), a_mM.r[3]));
+	}
+	inline XMVECTOR XMPlaneNormalize(FXMVECTOR a_vP)
+	{
+		return _mm_div_ps(a_vP, XMVector3Length(a_vP));
+	}
+	#pragma endregion
+
+	#pragma region Quaternion
+	inline XMVECTOR XMQuaternionRotationRollPitchYaw(float a_fPitch, float a_fYaw, float a_fRoll)
+	{
+		float sp = sinf(a_fPitch * 0.5f), cp = cosf(a_fPitch * 0.5f);
+		float sy = sinf(a_fYaw * 0.5f), cy = cosf(a_fYaw * 0.5f);
+		float sr = sinf(a_fRoll * 0.5f), cr = cosf(a_fRoll * 0.5f);
+		return _mm_setr_ps(
+			cr * sp * cy + sr * cp * sy,
+			cr * cp * sy - sr * sp * cy,
+			sr * cp * cy - cr * sp * sy,
+			cr * cp * cy + sr * sp * sy);
+	}
+	inline XMVECTOR XMQuaternionRotationRollPitchYawFromVector(FXMVECTOR a_vAngles)
+	{
+		return XMQuaternionRotationRollPitchYaw(XMVectorGetX(a_vAngles), XMVectorGetY(a_vAngles), XMVectorGetZ(a_vAngles));
+	}
+	// Q2 * Q1 in the usual notation, so the result rotates by Q1 and then Q2.
+	inline XMVECTOR XMQuaternionMultiply(FXMVECTOR a_vQ1, FXMVECTOR a_vQ2)
+	{
+		alignas(16) float a[4], b[4];
+		_mm_store_ps(a, a_vQ1);
+		_mm_store_ps(b, a_vQ2);
+		return _mm_setr_ps(
+			b[3] * a[0] + b[0] * a[3] + b[1] * a[2] - b[2] * a[1],
+			b[3] * a[1] - b[0] * a[2] + b[1] * a[3] + b[2] * a[0],
+			b[3] * a[2] + b[0] * a[1] - b[1] * a[0] + b[2] * a[3],
+			b[3] * a[3] - b[0] * a[0] - b[1] * a[1] - b[2] * a[2]);
+	}
+	inline XMVECTOR XMQuaternionConjugate(FXMVECTOR a_vQ) { return _mm_mul_ps(a_vQ, _mm_setr_ps(-1.0f, -1.0f, -1.0f, 1.0f)); }
+	inline XMVECTOR XMVector3Rotate(FXMVECTOR a_vV, FXMVECTOR a_vQ)
+	{
+		XMVECTOR vA = _mm_and_ps(a_vV, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+		XMVECTOR vResult = XMQuaternionMultiply(XMQuaternionConjugate(a_vQ), vA);
+		return XMQuaternionMultiply(vResult, a_vQ);
+	}
+	#pragma endregion
+
+	#pragma region Matrix
+	inline XMMATRIX XMMatrixSet(
+		float a_f00, float a_f01, float a_f02, float a_f03,
+		float a_f10, float a_f11, float a_f12, float a_f13,
+		float a_f20, float a_f21, float a_f22, float a_f23,
+		float a_f30, float a_f31, float a_f32, float a_f33)
+	{
+		return XMMATRIX(
+			_mm_setr_ps(a_f00, a_f01, a_f02, a_f03),
+			_mm_setr_ps(a_f10, a_f11, a_f12, a_f13),
+			_mm_setr_ps(a_f20, a_f21, a_f22, a_f23),
+			_mm_setr_ps(a_f30, a_f31, a_f32, a_f33));
+	}
+	inline XMMATRIX XMMatrixIdentity()
+	{
+		return XMMatrixSet(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1);
+	}
+	inline XMMATRIX XMMatrixTranspose(FXMMATRIX a_mM)
+	{
+		XMMATRIX mResult = a_mM;
+		_MM_TRANSPOSE4_PS(mResult.r[0], mResult.r[1], mResult.r[2], mResult.r[3]);
+		return mResult;
+	}
+	inline XMMATRIX XMMatrixMultiply(FXMMATRIX a_mA, CXMMATRIX a_mB)
+	{
+		XMMATRIX mResult;
+		for (int i = 0; i < 4; i++) mResult.r[i] = XMVector4Transform(a_mA.r[i], a_mB);
+		return mResult;
+	}
+	inline XMMATRIX XMMATRIX::operator*(FXMMATRIX a_mOther) const { return XMMatrixMultiply(*this, a_mOther); }
+	inline XMMATRIX& XMMATRIX::operator*=(FXMMATRIX a_mOther) { *this = XMMatrixMultiply(*this, a_mOther); return *this; }
+
+	inline XMMATRIX XMMatrixTranslation(float a_fX, float a_fY, float a_fZ)
+	{
+		return XMMatrixSet(1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, a_fX, a_fY, a_fZ, 1);
+	}
+	inline XMMATRIX XMMatrixTranslationFromVector(FXMVECTOR a_vOffset)
+	{
+		return XMMatrixTranslation(XMVectorGetX(a_vOffset), XMVectorGetY(a_vOffset), XMVectorGetZ(a_vOffset));
+	}
+	inline XMMATRIX XMMatrixScaling(float a_fX, float a_fY, float a_fZ)
+	{
+		return XMMatrixSet(a_fX, 0, 0, 0, 0, a_fY, 0, 0, 0, 0, a_fZ, 0, 0, 0, 0, 1);
+	}
+	inline XMMATRIX XMMatrixScalingFromVector(FXMVECTOR a_vScale)
+	{
+		return XMMatrixScaling(XMVectorGetX(a_vScale), XMVectorGetY(a_vScale), XMVectorGetZ(a_vScale));
+	}
+	// Roll about z, then pitch about x, then yaw about y.
+	inline XMMATRIX XMMatrixRotationRollPitchYaw(float a_fPitch, float a_fYaw, float a_fRoll)
+	{
+		float sp = sinf(a_fPitch), cp = cosf(a_fPitch);
+		float sy = sinf(a_fYaw), cy = cosf(a_fYaw);
+		float sr = sinf(a_fRoll), cr = cosf(a_fRoll);
+		return XMMatrixSet(
+			cr * cy + sr * sp * sy, sr * cp, sr * sp * cy - cr * sy, 0,
+			cr * sp * sy - sr * cy, cr * cp, sr * sy + cr * sp * cy, 0,
+			cp * sy, -sp, cp * cy, 0,
+			0, 0, 0, 1);
+	}
+	inline XMMATRIX XMMatrixRotationRollPitchYawFromVector(FXMVECTOR a_vAngles)
+	{
+		return XMMatrixRotationRollPitchYaw(XMVectorGetX(a_vAngles), XMVectorGetY(a_vAngles), XMVectorGetZ(a_vAngles));
+	}
+	inline XMMATRIX XMMatrixRotationQuaternion(FXMVECTOR a_vQ)
+	{
+		alignas(16) float q[4];
+		_mm_store_ps(q, a_vQ);
+		float x = q[0], y = q[1], z = q[2], w = q[3];
+		return XMMatrixSet(
+			1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w), 0,
+			2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w), 0,
+			2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y), 0,
+			0, 0, 0, 1);
+	}
+
+	// Cofactor expansion in double precision.  The determinant is written out when asked for.
+	inline XMMATRIX XMMatrixInverse(XMVECTOR* a_pDeterminant, FXMMATRIX a_mM)
+	{
+		alignas(16) float f[16];
+		for (int i = 0; i < 4; i++) _mm_store_ps(f + i * 4, a_mM.r[i]);
+		double m[16], inv[16];
+		for (int i = 0; i < 16; i++) m[i] = f[i];
+		inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+		inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+		inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+		inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+		inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+		inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+		inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+		inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+		inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+		inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+		inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+		inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+		inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+		inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+		inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+		inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+		double dDeterminant = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+		if (a_pDeterminant) *a_pDeterminant = _mm_set1_ps(static_cast<float>(dDeterminant));
+		for (int i = 0; i < 16; i++) f[i] = static_cast<float>(inv[i] / dDeterminant);
+		return XMMATRIX(_mm_load_ps(f), _mm_load_ps(f + 4), _mm_load_ps(f + 8), _mm_load_ps(f + 12));
+	}
+
+	inline XMMATRIX XMMatrixLookToLH(FXMVECTOR a_vEye, FXMVECTOR a_vDirection, FXMVECTOR a_vUp)
+	{
+		XMVECTOR vZ = XMVector3Normalize(a_vDirection);
+		XMVECTOR vX = XMVector3Normalize(XMVector3Cross(a_vUp, vZ));
+		XMVECTOR vY = XMVector3Cross(vZ, vX);
+		XMVECTOR vNegEye = XMVectorNegate(a_vEye);
+		XMMATRIX mResult(
+			XMVectorSetW(vX, XMVectorGetX(XMVector3Dot(vX, vNegEye))),
+			XMVectorSetW(vY, XMVectorGetX(XMVector3Dot(vY, vNegEye))),
+			XMVectorSetW(vZ, XMVectorGetX(XMVector3Dot(vZ, vNegEye))),
+			_mm_setr_ps(0, 0, 0, 1));
+		return XMMatrixTranspose(mResult);
+	}
+	inline XMMATRIX XMMatrixLookAtLH(FXMVECTOR a_vEye, FXMVECTOR a_vFocus, FXMVECTOR a_vUp)
+	{
+		return XMMatrixLookToLH(a_vEye, _mm_sub_ps(a_vFocus, a_vEye), a_vUp);
+	}
+	inline XMMATRIX XMMatrixPerspectiveFovLH(float a_fFovY, float a_fAspect, float a_fNear, float a_fFar)
+	{
+		float fHeight = 1.0f / tanf(a_fFovY * 0.5f);
+		float fWidth = fHeight / a_fAspect;
+		float fRange = a_fFar / (a_fFar - a_fNear);
+		return XMMatrixSet(
+			fWidth, 0, 0, 0,
+			0, fHeight, 0, 0,
+			0, 0, fRange, 1,
+			0, 0, -fRange * a_fNear, 0);
+	}
+	inline XMMATRIX XMMatrixOrthographicLH(float a_fWidth, float a_fHeight, float a_fNear, float a_fFar)
+	{
+		float fRange = 1.0f / (a_fFar - a_fNear);
+		return XMMatrixSet(
+			2.0f / a_fWidth, 0, 0, 0,
+			0, 2.0f / a_fHeight, 0, 0,
+			0, 0, fRange, 0,
+			0, 0, -fRange * a_fNear, 1);
+	}
+	#pragma endregion
+}
+
+#endif //__MOCK_DIRECTXMATH_H_
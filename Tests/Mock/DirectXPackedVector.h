@@ -0,0 +1,87 @@
+#ifndef __MOCK_DIRECTXPACKEDVECTOR_H_
+#define __MOCK_DIRECTXPACKEDVECTOR_H_
+
+// Stand-in for the half float conversions of DirectXPackedVector, see DirectXMath.h.
+
+#include <cstdint>
+#include <cstring>
+#include "DirectXMath.h"
+
+namespace DirectX
+{
+	namespace PackedVector
+	{
+		typedef uint16_t HALF;
+
+		// Rounds to nearest even, like the F16C instructions the real library uses.
+		inline HALF XMConvertFloatToHalf(float a_fValue)
+		{
+			uint32_t uBits;
+			memcpy(&uBits, &a_fValue, sizeof(uBits));
+			uint32_t uSign = (uBits >> 16) & 0x8000u;
+			uint32_t uAbs = uBits & 0x7FFFFFFFu;
+			if (uAbs >= 0x7F800000u)
+			{
+				// Infinity stays infinity, NaN stays a quiet NaN.
+				return static_cast<HALF>(uSign | 0x7C00u | (uAbs > 0x7F800000u ? 0x200u : 0u));
+			}
+			if (uAbs >= 0x477FF000u)
+			{
+				// Rounds past the largest half.
+				return static_cast<HALF>(uSign | 0x7C00u);
+			}
+			if (uAbs < 0x38800000u)
+			{
+				// Denormal half: shift the mantissa with its implicit bit into place.
+				int iShift = 126 - static_cast<int>(uAbs >> 23);
+				if (iShift > 24) return static_cast<HALF>(uSign);
+				uint32_t uMantissa = (uAbs & 0x7FFFFFu) | 0x800000u;
+				uint32_t uHalf = uMantissa >> iShift;
+				uint32_t uRest = uMantissa & ((1u << iShift) - 1u);
+				uint32_t uHalfway = 1u << (iShift - 1);
+				if (uRest > uHalfway || (uRest == uHalfway && (uHalf & 1u))) uHalf++;
+				return static_cast<HALF>(uSign | uHalf);
+			}
+			uint32_t uHalf = (uAbs - 0x38000000u) >> 13;
+			uint32_t uRest = uAbs & 0x1FFFu;
+			if (uRest > 0x1000u || (uRest == 0x1000u && (uHalf & 1u))) uHalf++;
+			return static_cast<HALF>(uSign | uHalf);
+		}
+
+		inline float XMConvertHalfToFloat(HALF a_hValue)
+		{
+			uint32_t uSign = static_cast<uint32_t>(a_hValue & 0x8000u) << 16;
+			uint32_t uExponent = (a_hValue >> 10) & 0x1Fu;
+			uint32_t uMantissa = a_hValue & 0x3FFu;
+			uint32_t uBits;
+			if (uExponent == 0x1Fu)
+			{
+				uBits = uSign | 0x7F800000u | (uMantissa << 13);
+			}
+			else if (uExponent != 0)
+			{
+				uBits = uSign | ((uExponent + 112) << 23) | (uMantissa << 13);
+			}
+			else if (uMantissa != 0)
+			{
+				// Denormal half, normalize it.
+				uExponent = 113;
+				while ((uMantissa & 0x400u) == 0)
+				{
+					uMantissa <<= 1;
+					uExponent--;
+				}
+				uBits = uSign | (uExponent << 23) | ((uMantissa & 0x3FFu) << 13);
+			}
+			else
+			{
+				uBits = uSign;
+			}
+			float fResult;
+			memcpy(&fResult, &uBits, sizeof(fResult));
+			return fResult;
+		}
+	}
+}
+
+#endif //__MOCK_DIRECTXPACKEDVECTOR_H_
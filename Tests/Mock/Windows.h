@@ -0,0 +1,54 @@
+#ifndef __MOCK_WINDOWS_H_
+#define __MOCK_WINDOWS_H_
+
+// Stand-in for the few Windows types and calls the engine's headers and
+// SimpleShader's logging use.  Logging goes to stdout.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+
+typedef int BOOL;
+typedef unsigned char BYTE;
+typedef unsigned short WORD;
+typedef uint32_t DWORD;
+typedef int INT;
+typedef unsigned int UINT;
+typedef float FLOAT;
+typedef size_t SIZE_T;
+typedef int32_t HRESULT;
+typedef const char* LPCSTR;
+typedef const wchar_t* LPCWSTR;
+typedef void* HANDLE;
+typedef void* HWND;
+
+#define S_OK ((HRESULT)0)
+#define S_FALSE ((HRESULT)1)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_INVALIDARG ((HRESULT)0x80070057)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define ZeroMemory(destination, length) memset((destination), 0, (length))
+#define ARRAYSIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+#define STD_OUTPUT_HANDLE ((DWORD)-11)
+#define FOREGROUND_BLUE 0x1
+#define FOREGROUND_GREEN 0x2
+#define FOREGROUND_RED 0x4
+#define FOREGROUND_INTENSITY 0x8
+
+inline HANDLE GetStdHandle(DWORD) { return nullptr; }
+inline BOOL SetConsoleTextAttribute(HANDLE, WORD) { return 1; }
+inline void OutputDebugStringA(LPCSTR) {}
+inline void OutputDebugStringW(LPCWSTR) {}
+
+#define printf_s printf
+#define wprintf_s wprintf
+
+// windows.h has min and max macros, functions here so std::min and std::max still work.
+template<typename A, typename B> inline A max(A a_A, B a_B) { return a_A > static_cast<A>(a_B) ? a_A : static_cast<A>(a_B); }
+template<typename A, typename B> inline A min(A a_A, B a_B) { return a_A < static_cast<A>(a_B) ? a_A : static_cast<A>(a_B); }
+
+#endif //__MOCK_WINDOWS_H_
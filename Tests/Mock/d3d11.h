@@ -0,0 +1,361 @@
+#ifndef __MOCK_D3D11_H_
+#define __MOCK_D3D11_H_
+
+// Stand-in for the parts of Direct3D 11 the engine's CPU-side code touches.
+// The device hands out plain objects, and buffers keep a CPU copy of their
+// contents so tests can read back what was uploaded.  The context records
+// its binds and counts its calls instead of drawing anything.
+
+#include <cstring>
+#include <vector>
+#include "Windows.h"
+
+#pragma region Enums and descriptions
+enum DXGI_FORMAT
+{
+	DXGI_FORMAT_UNKNOWN = 0,
+	DXGI_FORMAT_R32G32B32A32_FLOAT = 2,
+	DXGI_FORMAT_R32G32B32A32_UINT = 3,
+	DXGI_FORMAT_R32G32B32A32_SINT = 4,
+	DXGI_FORMAT_R32G32B32_FLOAT = 6,
+	DXGI_FORMAT_R32G32B32_UINT = 7,
+	DXGI_FORMAT_R32G32B32_SINT = 8,
+	DXGI_FORMAT_R16G16B16A16_UNORM = 11,
+	DXGI_FORMAT_R32G32_FLOAT = 16,
+	DXGI_FORMAT_R32G32_UINT = 17,
+	DXGI_FORMAT_R32G32_SINT = 18,
+	DXGI_FORMAT_R8G8B8A8_UNORM = 28,
+	DXGI_FORMAT_R16G16_FLOAT = 34,
+	DXGI_FORMAT_R16G16_SNORM = 37,
+	DXGI_FORMAT_R32_FLOAT = 41,
+	DXGI_FORMAT_R32_UINT = 42,
+	DXGI_FORMAT_R32_SINT = 43,
+	DXGI_FORMAT_R16_UINT = 57
+};
+
+enum D3D11_USAGE
+{
+	D3D11_USAGE_DEFAULT = 0,
+	D3D11_USAGE_IMMUTABLE = 1,
+	D3D11_USAGE_DYNAMIC = 2,
+	D3D11_USAGE_STAGING = 3
+};
+
+enum D3D11_BIND_FLAG
+{
+	D3D11_BIND_VERTEX_BUFFER = 0x1,
+	D3D11_BIND_INDEX_BUFFER = 0x2,
+	D3D11_BIND_CONSTANT_BUFFER = 0x4,
+	D3D11_BIND_SHADER_RESOURCE = 0x8,
+	D3D11_BIND_STREAM_OUTPUT = 0x10
+};
+
+enum D3D11_CPU_ACCESS_FLAG
+{
+	D3D11_CPU_ACCESS_WRITE = 0x10000,
+	D3D11_CPU_ACCESS_READ = 0x20000
+};
+
+enum D3D11_MAP
+{
+	D3D11_MAP_READ = 1,
+	D3D11_MAP_WRITE = 2,
+	D3D11_MAP_READ_WRITE = 3,
+	D3D11_MAP_WRITE_DISCARD = 4,
+	D3D11_MAP_WRITE_NO_OVERWRITE = 5
+};
+
+enum D3D11_INPUT_CLASSIFICATION
+{
+	D3D11_INPUT_PER_VERTEX_DATA = 0,
+	D3D11_INPUT_PER_INSTANCE_DATA = 1
+};
+
+enum D3D11_QUERY
+{
+	D3D11_QUERY_EVENT = 0
+};
+
+enum D3D11_ASYNC_GETDATA_FLAG
+{
+	D3D11_ASYNC_GETDATA_DONOTFLUSH = 0x1
+};
+
+#define D3D11_APPEND_ALIGNED_ELEMENT 0xffffffff
+#define D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT 14
+#define D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT 128
+#define D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT 16
+#define D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT 32
+#define D3D11_SO_NO_RASTERIZED_STREAM 0xffffffff
+
+struct D3D11_BUFFER_DESC
+{
+	UINT ByteWidth;
+	UINT Usage;
+	UINT BindFlags;
+	UINT CPUAccessFlags;
+	UINT MiscFlags;
+	UINT StructureByteStride;
+};
+
+struct D3D11_SUBRESOURCE_DATA
+{
+	const void* pSysMem;
+	UINT SysMemPitch;
+	UINT SysMemSlicePitch;
+};
+
+struct D3D11_MAPPED_SUBRESOURCE
+{
+	void* pData;
+	UINT RowPitch;
+	UINT DepthPitch;
+};
+
+struct D3D11_INPUT_ELEMENT_DESC
+{
+	LPCSTR SemanticName;
+	UINT SemanticIndex;
+	DXGI_FORMAT Format;
+	UINT InputSlot;
+	UINT AlignedByteOffset;
+	D3D11_INPUT_CLASSIFICATION InputSlotClass;
+	UINT InstanceDataStepRate;
+};
+
+struct D3D11_SO_DECLARATION_ENTRY
+{
+	UINT Stream;
+	LPCSTR SemanticName;
+	UINT SemanticIndex;
+	BYTE StartComponent;
+	BYTE ComponentCount;
+	BYTE OutputSlot;
+};
+
+struct D3D11_QUERY_DESC
+{
+	D3D11_QUERY Query;
+	UINT MiscFlags;
+};
+#pragma endregion
+
+#pragma region Objects
+struct IUnknown
+{
+private:
+	unsigned long m_uReferences = 0;
+
+public:
+	virtual ~IUnknown() {}
+	unsigned long AddRef() { return ++m_uReferences; }
+	unsigned long Release()
+	{
+		unsigned long uReferences = --m_uReferences;
+		if (uReferences == 0) delete this;
+		return uReferences;
+	}
+};
+
+struct ID3DBlob : IUnknown
+{
+	std::vector<unsigned char> Bytes;
+	void* GetBufferPointer() { return Bytes.data(); }
+	SIZE_T GetBufferSize() { return Bytes.size(); }
+};
+
+struct ID3D11DeviceChild : IUnknown {};
+struct ID3D11Resource : ID3D11DeviceChild {};
+
+struct ID3D11Buffer : ID3D11Resource
+{
+	D3D11_BUFFER_DESC Desc = {};
+	std::vector<unsigned char> Contents;	// What the GPU would see, for tests to read back.
+};
+
+struct ID3D11InputLayout : ID3D11DeviceChild {};
+struct ID3D11VertexShader : ID3D11DeviceChild {};
+struct ID3D11PixelShader : ID3D11DeviceChild {};
+struct ID3D11DomainShader : ID3D11DeviceChild {};
+struct ID3D11HullShader : ID3D11DeviceChild {};
+struct ID3D11GeometryShader : ID3D11DeviceChild {};
+struct ID3D11ComputeShader : ID3D11DeviceChild {};
+struct ID3D11ClassLinkage : ID3D11DeviceChild {};
+struct ID3D11ClassInstance : ID3D11DeviceChild {};
+struct ID3D11ShaderResourceView : ID3D11DeviceChild {};
+struct ID3D11UnorderedAccessView : ID3D11DeviceChild {};
+struct ID3D11RenderTargetView : ID3D11DeviceChild {};
+struct ID3D11DepthStencilView : ID3D11DeviceChild {};
+struct ID3D11SamplerState : ID3D11DeviceChild {};
+struct ID3D11RasterizerState : ID3D11DeviceChild {};
+struct ID3D11DepthStencilState : ID3D11DeviceChild {};
+struct ID3D11Query : ID3D11DeviceChild {};
+struct IDXGISwapChain : IUnknown {};
+
+struct ID3D11Device : IUnknown
+{
+	HRESULT CreateBuffer(const D3D11_BUFFER_DESC* a_pDesc, const D3D11_SUBRESOURCE_DATA* a_pInitialData, ID3D11Buffer** a_pBuffer)
+	{
+		ID3D11Buffer* pBuffer = new ID3D11Buffer();
+		pBuffer->Desc = *a_pDesc;
+		pBuffer->Contents.resize(a_pDesc->ByteWidth);
+		if (a_pInitialData && a_pInitialData->pSysMem) memcpy(pBuffer->Contents.data(), a_pInitialData->pSysMem, a_pDesc->ByteWidth);
+		return Hand(pBuffer, a_pBuffer);
+	}
+	HRESULT CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T, ID3D11InputLayout** a_pLayout) { return Hand(new ID3D11InputLayout(), a_pLayout); }
+	HRESULT CreateVertexShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11VertexShader** a_pShader) { return Hand(new ID3D11VertexShader(), a_pShader); }
+	HRESULT CreatePixelShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11PixelShader** a_pShader) { return Hand(new ID3D11PixelShader(), a_pShader); }
+	HRESULT CreateDomainShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11DomainShader** a_pShader) { return Hand(new ID3D11DomainShader(), a_pShader); }
+	HRESULT CreateHullShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11HullShader** a_pShader) { return Hand(new ID3D11HullShader(), a_pShader); }
+	HRESULT CreateGeometryShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11GeometryShader** a_pShader) { return Hand(new ID3D11GeometryShader(), a_pShader); }
+	HRESULT CreateGeometryShaderWithStreamOutput(const void*, SIZE_T, const D3D11_SO_DECLARATION_ENTRY*, UINT, const UINT*, UINT, UINT, ID3D11ClassLinkage*, ID3D11GeometryShader** a_pShader) { return Hand(new ID3D11GeometryShader(), a_pShader); }
+	HRESULT CreateComputeShader(const void*, SIZE_T, ID3D11ClassLinkage*, ID3D11ComputeShader** a_pShader) { return Hand(new ID3D11ComputeShader(), a_pShader); }
+	HRESULT CreateQuery(const D3D11_QUERY_DESC*, ID3D11Query** a_pQuery) { return Hand(new ID3D11Query(), a_pQuery); }
+
+private:
+	template<typename T>
+	static HRESULT Hand(T* a_pObject, T** a_pDestination)
+	{
+		if (!a_pDestination)
+		{
+			delete a_pObject;
+			return S_FALSE;
+		}
+		a_pObject->AddRef();
+		*a_pDestination = a_pObject;
+		return S_OK;
+	}
+};
+
+/// <summary>
+/// What is bound to one shader stage of the mock context.
+/// </summary>
+struct MockStageState
+{
+	ID3D11DeviceChild* Shader;
+	ID3D11Buffer* ConstantBuffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+	UINT FirstConstants[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];	// Only set by the 11.1 binds, see d3d11_1.h.
+	UINT NumConstants[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];	// 0 for the whole buffer.
+	ID3D11ShaderResourceView* ShaderResources[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+	ID3D11SamplerState* Samplers[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+
+	void SetConstantBuffers(UINT a_uStartSlot, UINT a_uCount, ID3D11Buffer* const* a_pBuffers, const UINT* a_pFirstConstants, const UINT* a_pNumConstants)
+	{
+		for (UINT i = 0; i < a_uCount; i++)
+		{
+			ConstantBuffers[a_uStartSlot + i] = a_pBuffers ? a_pBuffers[i] : nullptr;
+			FirstConstants[a_uStartSlot + i] = a_pFirstConstants ? a_pFirstConstants[i] : 0;
+			NumConstants[a_uStartSlot + i] = a_pNumConstants ? a_pNumConstants[i] : 0;
+		}
+	}
+};
+
+// Every binding call is counted in BindCalls and what it binds is kept, so
+// tests can check what reached the context and what it ended up with.
+#define MOCK_D3D11_STAGE(Prefix, ShaderType) \
+	MockStageState Prefix = {}; \
+	void Prefix##SetShader(ShaderType* a_pShader, ID3D11ClassInstance* const*, UINT) { BindCalls++; Prefix.Shader = a_pShader; } \
+	void Prefix##SetConstantBuffers(UINT a_uStartSlot, UINT a_uCount, ID3D11Buffer* const* a_pBuffers) { BindCalls++; Prefix.SetConstantBuffers(a_uStartSlot, a_uCount, a_pBuffers, nullptr, nullptr); } \
+	void Prefix##SetShaderResources(UINT a_uStartSlot, UINT a_uCount, ID3D11ShaderResourceView* const* a_pSRVs) { BindCalls++; Copy(Prefix.ShaderResources, a_uStartSlot, a_uCount, a_pSRVs); } \
+	void Prefix##SetSamplers(UINT a_uStartSlot, UINT a_uCount, ID3D11SamplerState* const* a_pSamplers) { BindCalls++; Copy(Prefix.Samplers, a_uStartSlot, a_uCount, a_pSamplers); }
+
+/// <summary>
+/// Records what gets bound instead of drawing anything.
+/// </summary>
+struct ID3D11DeviceContext : IUnknown
+{
+	unsigned int BindCalls = 0;
+	unsigned int DrawCalls = 0;
+	unsigned int UpdateCalls = 0;
+	unsigned int MapCalls = 0;
+	D3D11_MAP LastMapType = D3D11_MAP_WRITE;
+	HRESULT QueryResult = S_OK;			// What GetData() answers, S_FALSE for a query the GPU has not reached.
+	ID3D11InputLayout* InputLayout = nullptr;
+	ID3D11Buffer* VertexBuffers[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+	UINT VertexStrides[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+	UINT VertexOffsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+	ID3D11Buffer* IndexBuffer = nullptr;
+	DXGI_FORMAT IndexFormat = DXGI_FORMAT_UNKNOWN;
+	UINT IndexOffset = 0;
+	ID3D11RasterizerState* RasterizerState = nullptr;
+	ID3D11DepthStencilState* DepthStencilState = nullptr;
+	UINT StencilRef = 0;
+	ID3D11RenderTargetView* RenderTargets[8] = {};
+	ID3D11DepthStencilView* DepthStencilView = nullptr;
+
+	MOCK_D3D11_STAGE(VS, ID3D11VertexShader)
+	MOCK_D3D11_STAGE(PS, ID3D11PixelShader)
+	MOCK_D3D11_STAGE(DS, ID3D11DomainShader)
+	MOCK_D3D11_STAGE(HS, ID3D11HullShader)
+	MOCK_D3D11_STAGE(GS, ID3D11GeometryShader)
+	MOCK_D3D11_STAGE(CS, ID3D11ComputeShader)
+	void CSSetUnorderedAccessViews(UINT, UINT, ID3D11UnorderedAccessView* const*, const UINT*) { BindCalls++; }
+	void SOSetTargets(UINT, ID3D11Buffer* const*, const UINT*) { BindCalls++; }
+	void IASetInputLayout(ID3D11InputLayout* a_pLayout) { BindCalls++; InputLayout = a_pLayout; }
+	void IASetVertexBuffers(UINT a_uStartSlot, UINT a_uCount, ID3D11Buffer* const* a_pBuffers, const UINT* a_pStrides, const UINT* a_pOffsets)
+	{
+		BindCalls++;
+		Copy(VertexBuffers, a_uStartSlot, a_uCount, a_pBuffers);
+		Copy(VertexStrides, a_uStartSlot, a_uCount, a_pStrides);
+		Copy(VertexOffsets, a_uStartSlot, a_uCount, a_pOffsets);
+	}
+	void IASetIndexBuffer(ID3D11Buffer* a_pBuffer, DXGI_FORMAT a_fFormat, UINT a_uOffset)
+	{
+		BindCalls++;
+		IndexBuffer = a_pBuffer;
+		IndexFormat = a_fFormat;
+		IndexOffset = a_uOffset;
+	}
+	void RSSetState(ID3D11RasterizerState* a_pState) { BindCalls++; RasterizerState = a_pState; }
+	void OMSetDepthStencilState(ID3D11DepthStencilState* a_pState, UINT a_uStencilRef)
+	{
+		BindCalls++;
+		DepthStencilState = a_pState;
+		StencilRef = a_uStencilRef;
+	}
+	void OMSetRenderTargets(UINT a_uCount, ID3D11RenderTargetView* const* a_pRTVs, ID3D11DepthStencilView* a_pDSV)
+	{
+		BindCalls++;
+		for (UINT i = 0; i < ARRAYSIZE(RenderTargets); i++) RenderTargets[i] = i < a_uCount && a_pRTVs ? a_pRTVs[i] : nullptr;
+		DepthStencilView = a_pDSV;
+	}
+	void DrawIndexed(UINT, UINT, INT) { DrawCalls++; }
+	void DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) { DrawCalls++; }
+	void Dispatch(UINT, UINT, UINT) {}
+	void End(ID3D11Query*) {}
+	HRESULT GetData(ID3D11Query*, void*, UINT, UINT) { return QueryResult; }
+
+	void UpdateSubresource(ID3D11Resource* a_pResource, UINT, const void*, const void* a_pData, UINT, UINT)
+	{
+		UpdateCalls++;
+		ID3D11Buffer* pBuffer = dynamic_cast<ID3D11Buffer*>(a_pResource);
+		if (pBuffer && a_pData) memcpy(pBuffer->Contents.data(), a_pData, pBuffer->Contents.size());
+	}
+	HRESULT Map(ID3D11Resource* a_pResource, UINT, D3D11_MAP a_mType, UINT, D3D11_MAPPED_SUBRESOURCE* a_pMapped)
+	{
+		ID3D11Buffer* pBuffer = dynamic_cast<ID3D11Buffer*>(a_pResource);
+		if (!pBuffer || !a_pMapped) return E_INVALIDARG;
+		MapCalls++;
+		LastMapType = a_mType;
+		a_pMapped->pData = pBuffer->Contents.data();
+		a_pMapped->RowPitch = pBuffer->Desc.ByteWidth;
+		a_pMapped->DepthPitch = pBuffer->Desc.ByteWidth;
+		return S_OK;
+	}
+	void Unmap(ID3D11Resource*, UINT) {}
+
+protected:
+	/// <summary>
+	/// Copies a run of bound values into their slots, null values unbinding them.
+	/// </summary>
+	template<typename T, size_t N>
+	static void Copy(T (&a_lSlots)[N], UINT a_uStartSlot, UINT a_uCount, T const* a_pValues)
+	{
+		for (UINT i = 0; i < a_uCount && a_uStartSlot + i < N; i++) a_lSlots[a_uStartSlot + i] = a_pValues ? a_pValues[i] : T();
+	}
+};
+
+#undef MOCK_D3D11_STAGE
+#pragma endregion
+
+#endif //__MOCK_D3D11_H_
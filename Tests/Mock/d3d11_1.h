@@ -0,0 +1,22 @@
+#ifndef __MOCK_D3D11_1_H_
+#define __MOCK_D3D11_1_H_
+
+// Stand-in for the Direct3D 11.1 constant buffer offsetting, see d3d11.h.
+
+#include "d3d11.h"
+
+struct ID3D11DeviceContext1 : ID3D11DeviceContext
+{
+	void VSSetConstantBuffers1(UINT a_uStartSlot, UINT a_uCount, ID3D11Buffer* const* a_pBuffers, const UINT* a_pFirstConstants, const UINT* a_pNumConstants)
+	{
+		BindCalls++;
+		VS.SetConstantBuffers(a_uStartSlot, a_uCount, a_pBuffers, a_pFirstConstants, a_pNumConstants);
+	}
+	void PSSetConstantBuffers1(UINT a_uStartSlot, UINT a_uCount, ID3D11Buffer* const* a_pBuffers, const UINT* a_pFirstConstants, const UINT* a_pNumConstants)
+	{
+		BindCalls++;
+		PS.SetConstantBuffers(a_uStartSlot, a_uCount, a_pBuffers, a_pFirstConstants, a_pNumConstants);
+	}
+};
+
+#endif //__MOCK_D3D11_1_H_
@@ -0,0 +1,261 @@
+#ifndef __MOCK_D3DCOMPILER_H_
+#define __MOCK_D3DCOMPILER_H_
+
+// Stand-in for loading and reflecting compiled shaders, see d3d11.h.  There
+// are no .cso files: a test registers the layout a shader file would reflect
+// to with MockShaders::Add(), and D3DReadFileToBlob and D3DReflect serve it.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "d3d11.h"
+
+#pragma region Enums and descriptions
+enum D3D_CBUFFER_TYPE
+{
+	D3D11_CT_CBUFFER = 0,
+	D3D11_CT_TBUFFER = 1
+};
+
+enum D3D_SHADER_INPUT_TYPE
+{
+	D3D_SIT_CBUFFER = 0,
+	D3D_SIT_TBUFFER,
+	D3D_SIT_TEXTURE,
+	D3D_SIT_SAMPLER,
+	D3D_SIT_UAV_RWTYPED,
+	D3D_SIT_STRUCTURED,
+	D3D_SIT_UAV_RWSTRUCTURED,
+	D3D_SIT_BYTEADDRESS,
+	D3D_SIT_UAV_RWBYTEADDRESS,
+	D3D_SIT_UAV_APPEND_STRUCTURED,
+	D3D_SIT_UAV_CONSUME_STRUCTURED,
+	D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER
+};
+
+enum D3D_REGISTER_COMPONENT_TYPE
+{
+	D3D_REGISTER_COMPONENT_UNKNOWN = 0,
+	D3D_REGISTER_COMPONENT_UINT32 = 1,
+	D3D_REGISTER_COMPONENT_SINT32 = 2,
+	D3D_REGISTER_COMPONENT_FLOAT32 = 3
+};
+
+struct D3D11_SHADER_DESC
+{
+	UINT ConstantBuffers;
+	UINT BoundResources;
+	UINT InputParameters;
+	UINT OutputParameters;
+};
+
+struct D3D11_SHADER_INPUT_BIND_DESC
+{
+	LPCSTR Name;
+	D3D_SHADER_INPUT_TYPE Type;
+	UINT BindPoint;
+	UINT BindCount;
+};
+
+struct D3D11_SHADER_BUFFER_DESC
+{
+	LPCSTR Name;
+	D3D_CBUFFER_TYPE Type;
+	UINT Variables;
+	UINT Size;
+};
+
+struct D3D11_SHADER_VARIABLE_DESC
+{
+	LPCSTR Name;
+	UINT StartOffset;
+	UINT Size;
+};
+
+struct D3D11_SIGNATURE_PARAMETER_DESC
+{
+	LPCSTR SemanticName;
+	UINT SemanticIndex;
+	UINT Register;
+	D3D_REGISTER_COMPONENT_TYPE ComponentType;
+	BYTE Mask;
+	UINT Stream;
+};
+#pragma endregion
+
+#pragma region Registered shaders
+namespace MockShaders
+{
+	struct Variable
+	{
+		std::string Name;
+		UINT StartOffset;
+		UINT Size;
+	};
+
+	struct Buffer
+	{
+		std::string Name;
+		UINT BindPoint;
+		UINT Size;
+		std::vector<Variable> Variables;
+	};
+
+	struct Resource
+	{
+		std::string Name;
+		D3D_SHADER_INPUT_TYPE Type;
+		UINT BindPoint;
+	};
+
+	struct Input
+	{
+		std::string SemanticName;
+		UINT SemanticIndex;
+		D3D_REGISTER_COMPONENT_TYPE ComponentType;
+		BYTE Mask;
+	};
+
+	/// <summary>
+	/// What a compiled shader file holds: its bytecode and what it reflects to.
+	/// </summary>
+	struct Shader
+	{
+		std::vector<Buffer> Buffers;
+		std::vector<Resource> Resources;	// Textures and samplers, the buffers are added automatically.
+		std::vector<Input> Inputs;
+		std::vector<unsigned char> Bytecode;	// Made up from the file name when left empty.
+	};
+
+	inline std::map<std::wstring, Shader> g_mShaders;
+	inline unsigned int g_uReflectCount = 0;
+
+	/// <summary>
+	/// Makes a shader file loadable.  Files with the same bytecode reflect the same.
+	/// </summary>
+	inline void Add(const std::wstring& a_sFile, Shader a_sShader)
+	{
+		if (a_sShader.Bytecode.empty())
+		{
+			for (wchar_t c : a_sFile) a_sShader.Bytecode.push_back(static_cast<unsigned char>(c));
+			a_sShader.Bytecode.resize(a_sShader.Bytecode.size() + 256, 0xCC);
+		}
+		g_mShaders[a_sFile] = std::move(a_sShader);
+	}
+
+	inline const Shader* FindByBytecode(const void* a_pBytecode, SIZE_T a_uSize)
+	{
+		for (const auto& [sFile, sShader] : g_mShaders)
+		{
+			if (sShader.Bytecode.size() == a_uSize && memcmp(sShader.Bytecode.data(), a_pBytecode, a_uSize) == 0) return &sShader;
+		}
+		return nullptr;
+	}
+}
+#pragma endregion
+
+#pragma region Reflection
+struct ID3D11ShaderReflectionVariable
+{
+	const MockShaders::Variable* Variable;
+	HRESULT GetDesc(D3D11_SHADER_VARIABLE_DESC* a_pDesc)
+	{
+		*a_pDesc = { Variable->Name.c_str(), Variable->StartOffset, Variable->Size };
+		return S_OK;
+	}
+};
+
+struct ID3D11ShaderReflectionConstantBuffer
+{
+	const MockShaders::Buffer* Buffer;
+	std::vector<ID3D11ShaderReflectionVariable> Variables;
+	HRESULT GetDesc(D3D11_SHADER_BUFFER_DESC* a_pDesc)
+	{
+		*a_pDesc = { Buffer->Name.c_str(), D3D11_CT_CBUFFER, static_cast<UINT>(Buffer->Variables.size()), Buffer->Size };
+		return S_OK;
+	}
+	ID3D11ShaderReflectionVariable* GetVariableByIndex(UINT a_uIndex) { return &Variables[a_uIndex]; }
+};
+
+struct ID3D11ShaderReflection : IUnknown
+{
+private:
+	MockShaders::Shader m_sShader;
+	std::vector<MockShaders::Resource> m_lBindings;
+	std::vector<ID3D11ShaderReflectionConstantBuffer> m_lBuffers;
+
+public:
+	ID3D11ShaderReflection(const MockShaders::Shader& a_sShader) : m_sShader(a_sShader)
+	{
+		m_lBindings = m_sShader.Resources;
+		m_lBuffers.resize(m_sShader.Buffers.size());
+		for (size_t b = 0; b < m_sShader.Buffers.size(); b++)
+		{
+			const MockShaders::Buffer& buffer = m_sShader.Buffers[b];
+			m_lBindings.push_back({ buffer.Name, D3D_SIT_CBUFFER, buffer.BindPoint });
+			m_lBuffers[b].Buffer = &buffer;
+			for (const MockShaders::Variable& variable : buffer.Variables) m_lBuffers[b].Variables.push_back({ &variable });
+		}
+	}
+	HRESULT GetDesc(D3D11_SHADER_DESC* a_pDesc)
+	{
+		*a_pDesc = { static_cast<UINT>(m_sShader.Buffers.size()), static_cast<UINT>(m_lBindings.size()), static_cast<UINT>(m_sShader.Inputs.size()), 0 };
+		return S_OK;
+	}
+	HRESULT GetResourceBindingDesc(UINT a_uIndex, D3D11_SHADER_INPUT_BIND_DESC* a_pDesc)
+	{
+		*a_pDesc = { m_lBindings[a_uIndex].Name.c_str(), m_lBindings[a_uIndex].Type, m_lBindings[a_uIndex].BindPoint, 1 };
+		return S_OK;
+	}
+	HRESULT GetResourceBindingDescByName(LPCSTR a_sName, D3D11_SHADER_INPUT_BIND_DESC* a_pDesc)
+	{
+		for (UINT i = 0; i < m_lBindings.size(); i++)
+		{
+			if (m_lBindings[i].Name == a_sName) return GetResourceBindingDesc(i, a_pDesc);
+		}
+		return E_INVALIDARG;
+	}
+	ID3D11ShaderReflectionConstantBuffer* GetConstantBufferByIndex(UINT a_uIndex) { return &m_lBuffers[a_uIndex]; }
+	HRESULT GetInputParameterDesc(UINT a_uIndex, D3D11_SIGNATURE_PARAMETER_DESC* a_pDesc)
+	{
+		const MockShaders::Input& input = m_sShader.Inputs[a_uIndex];
+		*a_pDesc = { input.SemanticName.c_str(), input.SemanticIndex, a_uIndex, input.ComponentType, input.Mask, 0 };
+		return S_OK;
+	}
+	HRESULT GetOutputParameterDesc(UINT, D3D11_SIGNATURE_PARAMETER_DESC*) { return E_INVALIDARG; }
+	UINT GetThreadGroupSize(UINT* a_pX, UINT* a_pY, UINT* a_pZ)
+	{
+		if (a_pX) *a_pX = 1;
+		if (a_pY) *a_pY = 1;
+		if (a_pZ) *a_pZ = 1;
+		return 1;
+	}
+};
+
+inline const int IID_ID3D11ShaderReflection = 0;
+
+inline HRESULT D3DReadFileToBlob(LPCWSTR a_sFile, ID3DBlob** a_pBlob)
+{
+	auto itShader = MockShaders::g_mShaders.find(a_sFile);
+	if (itShader == MockShaders::g_mShaders.end()) return E_FAIL;
+	ID3DBlob* pBlob = new ID3DBlob();
+	pBlob->Bytes = itShader->second.Bytecode;
+	pBlob->AddRef();
+	*a_pBlob = pBlob;
+	return S_OK;
+}
+
+inline HRESULT D3DReflect(const void* a_pBytecode, SIZE_T a_uSize, int, void** a_pReflection)
+{
+	const MockShaders::Shader* pShader = MockShaders::FindByBytecode(a_pBytecode, a_uSize);
+	if (!pShader) return E_FAIL;
+	MockShaders::g_uReflectCount++;
+	ID3D11ShaderReflection* pReflection = new ID3D11ShaderReflection(*pShader);
+	pReflection->AddRef();
+	*a_pReflection = pReflection;
+	return S_OK;
+}
+#pragma endregion
+
+#endif //__MOCK_D3DCOMPILER_H_
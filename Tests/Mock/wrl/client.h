@@ -0,0 +1,85 @@
+#ifndef __MOCK_WRL_CLIENT_H_
+#define __MOCK_WRL_CLIENT_H_
+
+// Stand-in for Microsoft::WRL::ComPtr over the mock interfaces in d3d11.h.
+
+#include <cstddef>
+#include <utility>
+
+namespace Microsoft
+{
+	namespace WRL
+	{
+		template<typename T>
+		class ComPtr
+		{
+		private:
+			T* m_pPointer;
+
+			template<typename U> friend class ComPtr;
+
+		public:
+			ComPtr() : m_pPointer(nullptr) {}
+			ComPtr(std::nullptr_t) : m_pPointer(nullptr) {}
+			// A template like the real one, so a literal 0 is taken as null rather than ambiguous.
+			template<typename U>
+			ComPtr(U* a_pPointer) : m_pPointer(a_pPointer) { if (m_pPointer) m_pPointer->AddRef(); }
+			ComPtr(const ComPtr& a_pOther) : m_pPointer(a_pOther.m_pPointer) { if (m_pPointer) m_pPointer->AddRef(); }
+			ComPtr(ComPtr&& a_pOther) noexcept : m_pPointer(a_pOther.m_pPointer) { a_pOther.m_pPointer = nullptr; }
+			template<typename U>
+			ComPtr(const ComPtr<U>& a_pOther) : m_pPointer(a_pOther.m_pPointer) { if (m_pPointer) m_pPointer->AddRef(); }
+			~ComPtr() { Reset(); }
+
+			ComPtr& operator=(const ComPtr& a_pOther)
+			{
+				ComPtr(a_pOther).Swap(*this);
+				return *this;
+			}
+			ComPtr& operator=(ComPtr&& a_pOther) noexcept
+			{
+				ComPtr(std::move(a_pOther)).Swap(*this);
+				return *this;
+			}
+			ComPtr& operator=(T* a_pPointer)
+			{
+				ComPtr(a_pPointer).Swap(*this);
+				return *this;
+			}
+			ComPtr& operator=(std::nullptr_t)
+			{
+				Reset();
+				return *this;
+			}
+
+			T* Get() const { return m_pPointer; }
+			T* operator->() const { return m_pPointer; }
+			T** GetAddressOf() { return &m_pPointer; }
+			T* const* GetAddressOf() const { return &m_pPointer; }
+			T** ReleaseAndGetAddressOf()
+			{
+				Reset();
+				return &m_pPointer;
+			}
+			unsigned long Reset()
+			{
+				unsigned long uCount = 0;
+				if (m_pPointer) uCount = m_pPointer->Release();
+				m_pPointer = nullptr;
+				return uCount;
+			}
+			void Swap(ComPtr& a_pOther) { std::swap(m_pPointer, a_pOther.m_pPointer); }
+			explicit operator bool() const { return m_pPointer != nullptr; }
+		};
+
+		template<typename T, typename U>
+		bool operator==(const ComPtr<T>& a_pA, const ComPtr<U>& a_pB) { return a_pA.Get() == a_pB.Get(); }
+		template<typename T>
+		bool operator==(const ComPtr<T>& a_pA, std::nullptr_t) { return a_pA.Get() == nullptr; }
+		template<typename T, typename U>
+		bool operator!=(const ComPtr<T>& a_pA, const ComPtr<U>& a_pB) { return a_pA.Get() != a_pB.Get(); }
+		template<typename T>
+		bool operator!=(const ComPtr<T>& a_pA, std::nullptr_t) { return a_pA.Get() != nullptr; }
+	}
+}
+
+#endif //__MOCK_WRL_CLIENT_H_
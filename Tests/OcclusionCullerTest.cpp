@@ -0,0 +1,153 @@
+// Checks OcclusionCuller with occluder and occludee pairs: a box is culled
+// only when the boxes drawn in front of it cover all of it on screen, so boxes
+// larger than their occluder, beside it, in front of it, through it, seen
+// through a gap between two occluders or crossing the near plane are kept.
+// Also checks that splitting the rasterization across threads draws the same
+// depth buffer.
+
+#include <cstdio>
+#include <vector>
+
+#include "Check.h"
+#include "OcclusionCuller.h"
+
+using namespace DirectX;
+
+namespace
+{
+	/// <summary>
+	/// Boxes drawn as occluders, one box tested behind, beside or in front of
+	/// them, and whether it has to come back visible.
+	/// </summary>
+	struct OcclusionCase
+	{
+		const char* Name;
+		std::vector<CullBox> Occluders;
+		CullBox Occludee;
+		bool Visible;
+	};
+
+	// A cube two units across, as an occluder mesh.
+	const XMFLOAT3 g_lCubePositions[] =
+	{
+		{ -1, -1, -1 }, { -1, 1, -1 }, { 1, 1, -1 }, { 1, -1, -1 },
+		{ -1, -1, 1 }, { -1, 1, 1 }, { 1, 1, 1 }, { 1, -1, 1 },
+	};
+	const unsigned int g_lCubeIndices[] =
+	{
+		0, 1, 2, 0, 2, 3,	4, 6, 5, 4, 7, 6,
+		0, 4, 5, 0, 5, 1,	3, 2, 6, 3, 6, 7,
+		1, 5, 6, 1, 6, 2,	0, 3, 7, 0, 7, 4,
+	};
+
+	// A square in the XY plane and one in the XZ plane, both two units across.
+	const XMFLOAT3 g_lWallPositions[] = { { -1, -1, 0 }, { -1, 1, 0 }, { 1, 1, 0 }, { 1, -1, 0 } };
+	const XMFLOAT3 g_lFloorPositions[] = { { -1, 0, -1 }, { -1, 0, 1 }, { 1, 0, 1 }, { 1, 0, -1 } };
+	const unsigned int g_lQuadIndices[] = { 0, 1, 2, 0, 2, 3 };
+
+	void AddMesh(OcclusionCuller& a_ocCuller, const XMFLOAT3* a_pPositions, const unsigned int* a_pIndices, unsigned int a_uIndexCount,
+		FXMMATRIX a_mWorld, CXMMATRIX a_mViewProjection)
+	{
+		XMFLOAT4X4 m4WorldViewProjection;
+		XMStoreFloat4x4(&m4WorldViewProjection, a_mWorld * a_mViewProjection);
+		a_ocCuller.AddOccluder(a_pPositions, a_pIndices, a_uIndexCount, m4WorldViewProjection);
+	}
+
+	/// <summary>
+	/// Draws a case's occluders, and nothing else, into the depth buffer.
+	/// </summary>
+	void DrawOccluders(OcclusionCuller& a_ocCuller, const OcclusionCase& a_ocCase, CXMMATRIX a_mViewProjection)
+	{
+		a_ocCuller.BeginFrame();
+		for (const CullBox& box : a_ocCase.Occluders)
+		{
+			XMMATRIX world = XMMatrixScaling(box.Extents.x, box.Extents.y, box.Extents.z) * XMMatrixTranslation(box.Center.x, box.Center.y, box.Center.z);
+			AddMesh(a_ocCuller, g_lCubePositions, g_lCubeIndices, 36, world, a_mViewProjection);
+		}
+		a_ocCuller.Rasterize();
+	}
+
+	/// <summary>
+	/// Draws a 16 x 16 wall 10 units ahead, and a 100 x 60 floor one unit
+	/// below the camera running from behind it to far past the wall.
+	/// </summary>
+	void DrawScene(OcclusionCuller& a_ocCuller, CXMMATRIX a_mViewProjection, JobSystem* a_pJobs)
+	{
+		a_ocCuller.BeginFrame();
+		AddMesh(a_ocCuller, g_lWallPositions, g_lQuadIndices, 6, XMMatrixScaling(8.0f, 8.0f, 1.0f) * XMMatrixTranslation(0.0f, 0.0f, 10.0f), a_mViewProjection);
+		AddMesh(a_ocCuller, g_lFloorPositions, g_lQuadIndices, 6, XMMatrixScaling(50.0f, 1.0f, 30.0f) * XMMatrixTranslation(0.0f, -1.0f, 20.0f), a_mViewProjection);
+		a_ocCuller.Rasterize(a_pJobs);
+	}
+}
+
+int main()
+{
+	// Looking down +Z from the origin, at z the screen reaches 0.96 * z to the sides and 0.58 * z up and down.
+	XMMATRIX viewProjection =
+		XMMatrixLookToLH(XMVectorSet(0, 0, 0, 1), XMVectorSet(0, 0, 1, 0), XMVectorSet(0, 1, 0, 0)) *
+		XMMatrixPerspectiveFovLH(XMConvertToRadians(60.0f), 320.0f / 192.0f, 0.1f, 100.0f);
+	XMFLOAT4X4 m4ViewProjection;
+	XMStoreFloat4x4(&m4ViewProjection, viewProjection);
+
+	// An occludee is hidden when, seen from the camera, it is smaller than what is in front of it.
+	const std::vector<OcclusionCase> lCases =
+	{
+		{ "behind its occluder", { { { 0, 0, 10 }, { 2, 2, 0.5f } } }, { { 0, 0, 15 }, { 1, 1, 1 } }, false },
+		{ "far behind a small, near occluder", { { { 0, 0, 2 }, { 0.5f, 0.5f, 0.1f } } }, { { 0, 0, 50 }, { 5, 5, 5 } }, false },
+		{ "behind two occluders that meet", { { { -1, 0, 10 }, { 1, 2, 0.5f } }, { { 1, 0, 10 }, { 1, 2, 0.5f } } }, { { 0, 0, 15 }, { 1, 1, 1 } }, false },
+		{ "behind an occluder filling the screen", { { { 0, 0, 10 }, { 100, 100, 0.5f } } }, { { 10, 5, 20 }, { 1, 1, 1 } }, false },
+		{ "off the sides of the screen behind an occluder filling it", { { { 0, 0, 10 }, { 100, 100, 0.5f } } }, { { 0, 0, 20 }, { 40, 1, 1 } }, false },
+		{ "larger than its occluder", { { { 0, 0, 10 }, { 1, 1, 0.5f } } }, { { 0, 0, 15 }, { 3, 3, 1 } }, true },
+		{ "beside its occluder", { { { -3, 0, 10 }, { 2, 2, 0.5f } } }, { { 3, 0, 15 }, { 1, 1, 1 } }, true },
+		{ "in front of its occluder", { { { 0, 0, 20 }, { 4, 4, 0.5f } } }, { { 0, 0, 10 }, { 1, 1, 1 } }, true },
+		{ "through its occluder", { { { 0, 0, 10 }, { 3, 3, 0.5f } } }, { { 0, 0, 10 }, { 1, 1, 1 } }, true },
+		{ "seen through a gap between two occluders", { { { -1.5f, 0, 10 }, { 1, 2, 0.5f } }, { { 1.5f, 0, 10 }, { 1, 2, 0.5f } } }, { { 0, 0, 15 }, { 0.2f, 1, 1 } }, true },
+		{ "crossing the near plane", { { { 0, 0, 10 }, { 100, 100, 0.5f } } }, { { 0, 0, 0.1f }, { 0.5f, 0.5f, 0.5f } }, true },
+	};
+
+	// Cull() agrees with IsVisible(), and leaves a box the frustum already culled alone.
+	OcclusionCuller culler;
+	unsigned int uWrongCulls = 0, uTouchedCulled = 0;
+	for (const OcclusionCase& ocCase : lCases)
+	{
+		DrawOccluders(culler, ocCase, viewProjection);
+		if (!CHECK(culler.IsVisible(ocCase.Occludee, m4ViewProjection) == ocCase.Visible)) printf("    case: %s\n", ocCase.Name);
+
+		CullBox lBoxes[] = { ocCase.Occludee, ocCase.Occludee };
+		unsigned char lVisible[] = { 1, 0 };
+		unsigned int uOccluded = culler.Cull(lBoxes, 2, m4ViewProjection, lVisible);
+		uWrongCulls += uOccluded != (ocCase.Visible ? 0u : 1u) || lVisible[0] != (ocCase.Visible ? 1 : 0);
+		uTouchedCulled += lVisible[1] != 0 || culler.GetStats().Tested != 1;
+	}
+	CHECK(uWrongCulls == 0);
+	CHECK(uTouchedCulled == 0);
+
+	// Splitting the rasterization across threads draws the same depth buffer.
+	JobSystem jobs(3);
+	OcclusionCuller threaded;
+	DrawScene(culler, viewProjection, nullptr);
+	DrawScene(threaded, viewProjection, &jobs);
+	CHECK(culler.GetStats().OccluderTriangles > 0);
+	unsigned int uDifferentPixels = 0;
+	for (unsigned int y = 0; y < culler.GetHeight(); y++)
+	{
+		for (unsigned int x = 0; x < culler.GetWidth(); x++)
+		{
+			if (threaded.GetDepth(x, y) != culler.GetDepth(x, y)) uDifferentPixels++;
+		}
+	}
+	CHECK(uDifferentPixels == 0);
+
+	// The floor hides what is under it, and not what stands on it.
+	CHECK(!culler.IsVisible({ { 20, -4, 30 }, { 2, 1, 2 } }, m4ViewProjection));
+	CHECK(culler.IsVisible({ { 16, 0, 20 }, { 1, 1, 1 } }, m4ViewProjection));
+
+	// Without occluders nothing is hidden.
+	culler.BeginFrame();
+	culler.Rasterize();
+	unsigned int uHiddenWithoutOccluders = 0;
+	for (const OcclusionCase& ocCase : lCases) uHiddenWithoutOccluders += culler.IsVisible(ocCase.Occludee, m4ViewProjection) ? 0 : 1;
+	CHECK(uHiddenWithoutOccluders == 0);
+
+	return Check::Report("OcclusionCullerTest");
+}
@@ -0,0 +1,274 @@
+// Checks PipelineStateCache against the recording mock context: binds it
+// drops never reach the context, the ones it issues do, and the context ends
+// up with exactly what binding everything directly would have left.
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "Check.h"
+#include "PipelineStateCache.h"
+
+namespace
+{
+	/// <summary>
+	/// Stand-ins for the objects a frame binds.
+	/// </summary>
+	struct Objects
+	{
+		ID3D11InputLayout Layouts[2];
+		ID3D11VertexShader VertexShaders[2];
+		ID3D11PixelShader PixelShaders[3];
+		ID3D11Buffer Buffers[4];
+		ID3D11ShaderResourceView SRVs[3];
+		ID3D11SamplerState Samplers[2];
+		ID3D11RasterizerState RasterizerStates[2];
+		ID3D11DepthStencilState DepthStencilStates[2];
+		ID3D11RenderTargetView RenderTarget;
+	};
+
+	/// <summary>
+	/// Whether two contexts have the same things bound to the stages the cache covers.
+	/// </summary>
+	bool SameState(const ID3D11DeviceContext& a_dcA, const ID3D11DeviceContext& a_dcB)
+	{
+		return memcmp(&a_dcA.VS, &a_dcB.VS, sizeof(MockStageState)) == 0 &&
+			memcmp(&a_dcA.PS, &a_dcB.PS, sizeof(MockStageState)) == 0 &&
+			a_dcA.InputLayout == a_dcB.InputLayout &&
+			memcmp(a_dcA.VertexBuffers, a_dcB.VertexBuffers, sizeof(a_dcA.VertexBuffers)) == 0 &&
+			memcmp(a_dcA.VertexStrides, a_dcB.VertexStrides, sizeof(a_dcA.VertexStrides)) == 0 &&
+			memcmp(a_dcA.VertexOffsets, a_dcB.VertexOffsets, sizeof(a_dcA.VertexOffsets)) == 0 &&
+			a_dcA.IndexBuffer == a_dcB.IndexBuffer && a_dcA.IndexFormat == a_dcB.IndexFormat && a_dcA.IndexOffset == a_dcB.IndexOffset &&
+			a_dcA.RasterizerState == a_dcB.RasterizerState &&
+			a_dcA.DepthStencilState == a_dcB.DepthStencilState && a_dcA.StencilRef == a_dcB.StencilRef &&
+			memcmp(a_dcA.RenderTargets, a_dcB.RenderTargets, sizeof(a_dcA.RenderTargets)) == 0;
+	}
+
+	/// <summary>
+	/// Makes one random bind through the cache, and the same bind straight to a second context.
+	/// </summary>
+	void RandomBind(std::mt19937& a_rng, Objects& a_oObjects, PipelineStateCache& a_pscCache, ID3D11DeviceContext1& a_dcDirect)
+	{
+		Objects& o = a_oObjects;
+		unsigned int uPick = a_rng() % 2;
+		UINT uSlot = a_rng() % 3;
+		switch (a_rng() % 12)
+		{
+		case 0:
+			a_pscCache.SetInputLayout(&o.Layouts[uPick]);
+			a_dcDirect.IASetInputLayout(&o.Layouts[uPick]);
+			break;
+		case 1:
+			a_pscCache.SetVertexShader(&o.VertexShaders[uPick]);
+			a_dcDirect.VSSetShader(&o.VertexShaders[uPick], 0, 0);
+			break;
+		case 2:
+		{
+			ID3D11PixelShader* pShader = uSlot == 2 ? nullptr : &o.PixelShaders[uSlot];
+			a_pscCache.SetPixelShader(pShader);
+			a_dcDirect.PSSetShader(pShader, 0, 0);
+			break;
+		}
+		case 3:
+		{
+			ID3D11Buffer* pBuffer = &o.Buffers[a_rng() % 4];
+			a_pscCache.SetVSConstantBuffer(uSlot, pBuffer);
+			a_dcDirect.VSSetConstantBuffers(uSlot, 1, &pBuffer);
+			break;
+		}
+		case 4:
+		{
+			// Either the whole buffer or one of two 256 byte parts of it.
+			ID3D11Buffer* pBuffer = &o.Buffers[a_rng() % 4];
+			UINT uFirst = 16 * (a_rng() % 3);
+			UINT uNum = uFirst > 0 ? 16 : 0;
+			a_pscCache.SetPSConstantBuffer(uSlot, pBuffer, uFirst, uNum);
+			if (uNum > 0) a_dcDirect.PSSetConstantBuffers1(uSlot, 1, &pBuffer, &uFirst, &uNum);
+			else a_dcDirect.PSSetConstantBuffers(uSlot, 1, &pBuffer);
+			break;
+		}
+		case 5:
+		{
+			ID3D11ShaderResourceView* pSRV = &o.SRVs[a_rng() % 3];
+			a_pscCache.SetPSShaderResource(uSlot, pSRV);
+			a_dcDirect.PSSetShaderResources(uSlot, 1, &pSRV);
+			break;
+		}
+		case 6:
+		{
+			ID3D11ShaderResourceView* lSRVs[3] = { &o.SRVs[a_rng() % 3], &o.SRVs[a_rng() % 3], &o.SRVs[a_rng() % 3] };
+			a_pscCache.SetPSShaderResources(uPick, 3, lSRVs);
+			a_dcDirect.PSSetShaderResources(uPick, 3, lSRVs);
+			break;
+		}
+		case 7:
+		{
+			ID3D11SamplerState* pSampler = &o.Samplers[uPick];
+			a_pscCache.SetPSSampler(uSlot, pSampler);
+			a_dcDirect.PSSetSamplers(uSlot, 1, &pSampler);
+			break;
+		}
+		case 8:
+		{
+			ID3D11Buffer* pBuffer = &o.Buffers[a_rng() % 2];
+			UINT uStride = uPick ? 32 : 16;
+			UINT uOffset = 0;
+			a_pscCache.SetVertexBuffer(uSlot, pBuffer, uStride, uOffset);
+			a_dcDirect.IASetVertexBuffers(uSlot, 1, &pBuffer, &uStride, &uOffset);
+			break;
+		}
+		case 9:
+		{
+			DXGI_FORMAT fFormat = uPick ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+			a_pscCache.SetIndexBuffer(&o.Buffers[2 + uPick], fFormat, 0);
+			a_dcDirect.IASetIndexBuffer(&o.Buffers[2 + uPick], fFormat, 0);
+			break;
+		}
+		case 10:
+			a_pscCache.SetRasterizerState(&o.RasterizerStates[uPick]);
+			a_dcDirect.RSSetState(&o.RasterizerStates[uPick]);
+			break;
+		case 11:
+			a_pscCache.SetDepthStencilState(&o.DepthStencilStates[uPick], uSlot);
+			a_dcDirect.OMSetDepthStencilState(&o.DepthStencilStates[uPick], uSlot);
+			break;
+		}
+	}
+}
+
+int main()
+{
+	Objects o;
+	ID3D11DeviceContext1 context;
+	PipelineStateCache cache;
+	cache.SetContext(&context, &context);
+
+	// A frame of 100 draws with two materials and two meshes, rebinding
+	// everything before each draw: 10 binds each, of which only the first
+	// draw's, a pixel shader and texture per material change and a vertex
+	// and index buffer per mesh change are needed.
+	cache.BeginFrame();
+	for (int i = 0; i < 100; i++)
+	{
+		int iMaterial = i / 50;
+		int iMesh = (i / 25) % 2;
+		cache.SetInputLayout(&o.Layouts[0]);
+		cache.SetVertexShader(&o.VertexShaders[0]);
+		cache.SetPixelShader(&o.PixelShaders[iMaterial]);
+		cache.SetVSConstantBuffer(0, &o.Buffers[2]);
+		cache.SetPSConstantBuffer(0, &o.Buffers[3]);
+		cache.SetPSShaderResource(0, &o.SRVs[iMaterial]);
+		cache.SetPSShaderResource(1, &o.SRVs[2]);
+		cache.SetPSSampler(0, &o.Samplers[0]);
+		cache.SetVertexBuffer(0, &o.Buffers[iMesh], 32, 0);
+		cache.SetIndexBuffer(&o.Buffers[iMesh], DXGI_FORMAT_R32_UINT, 0);
+		context.DrawIndexed(36, 0, 0);
+	}
+	const PipelineStateStats& stats = cache.GetStats();
+	printf("100 draws: %u of %u binds reached the context\n", context.BindCalls, stats.Issued + stats.Elided);
+	CHECK(stats.Issued + stats.Elided == 1000);
+	CHECK(stats.Issued == 10 + 2 + 3 * 2);
+	CHECK(context.BindCalls == stats.Issued);
+	CHECK(context.DrawCalls == 100);
+	CHECK(context.PS.Shader == &o.PixelShaders[1]);
+	CHECK(context.PS.ShaderResources[0] == &o.SRVs[1]);
+	CHECK(context.VertexBuffers[0] == &o.Buffers[1]);
+
+	// The next frame starts from nothing known and keeps this frame's counts.
+	cache.BeginFrame();
+	CHECK(cache.GetLastFrameStats().Issued == 18);
+	CHECK(cache.GetStats().Issued == 0 && cache.GetStats().Elided == 0);
+	unsigned int uCalls = context.BindCalls;
+	cache.SetInputLayout(&o.Layouts[0]);
+	CHECK(context.BindCalls == uCalls + 1);
+
+	// A different stride, offset, stencil reference or constant range is a different bind.
+	cache.SetVertexBuffer(0, &o.Buffers[1], 32, 0);
+	uCalls = context.BindCalls;
+	cache.SetVertexBuffer(0, &o.Buffers[1], 32, 0);
+	CHECK(context.BindCalls == uCalls);
+	cache.SetVertexBuffer(0, &o.Buffers[1], 16, 0);
+	cache.SetVertexBuffer(0, &o.Buffers[1], 16, 64);
+	CHECK(context.BindCalls == uCalls + 2);
+	CHECK(context.VertexStrides[0] == 16 && context.VertexOffsets[0] == 64);
+	cache.SetDepthStencilState(&o.DepthStencilStates[0], 0);
+	cache.SetDepthStencilState(&o.DepthStencilStates[0], 1);
+	CHECK(context.BindCalls == uCalls + 4);
+	cache.SetVSConstantBuffer(1, &o.Buffers[0], 0, 16);
+	cache.SetVSConstantBuffer(1, &o.Buffers[0], 16, 16);
+	cache.SetVSConstantBuffer(1, &o.Buffers[0], 16, 16);
+	CHECK(context.BindCalls == uCalls + 6);
+	CHECK(context.VS.FirstConstants[1] == 16 && context.VS.NumConstants[1] == 16);
+
+	// Null is a binding like any other.
+	uCalls = context.BindCalls;
+	cache.SetPixelShader(nullptr);
+	cache.SetPixelShader(nullptr);
+	CHECK(context.BindCalls == uCalls + 1);
+	CHECK(context.PS.Shader == nullptr);
+
+	// Slots past the tracked ones always reach the context.
+	uCalls = context.BindCalls;
+	cache.SetPSShaderResource(PipelineStateCache::SHADER_RESOURCE_SLOTS + 4, &o.SRVs[0]);
+	cache.SetPSShaderResource(PipelineStateCache::SHADER_RESOURCE_SLOTS + 4, &o.SRVs[0]);
+	CHECK(context.BindCalls == uCalls + 2);
+
+	// A run of slots is narrowed to the ones that change, or dropped if none do.
+	ID3D11ShaderResourceView* lSRVs[4] = { &o.SRVs[0], &o.SRVs[1], &o.SRVs[2], &o.SRVs[0] };
+	cache.SetPSShaderResources(4, 4, lSRVs);
+	lSRVs[2] = &o.SRVs[1];
+	context.PS.ShaderResources[4] = nullptr;
+	uCalls = context.BindCalls;
+	cache.SetPSShaderResources(4, 4, lSRVs);
+	CHECK(context.BindCalls == uCalls + 1);
+	CHECK(context.PS.ShaderResources[6] == &o.SRVs[1]);
+	CHECK(context.PS.ShaderResources[4] == nullptr);
+	cache.SetPSShaderResources(4, 4, lSRVs);
+	CHECK(context.BindCalls == uCalls + 1);
+
+	// A run of constant buffers is narrowed the same way, and matches single binds of whole buffers.
+	ID3D11Buffer* lBuffers[2] = { &o.Buffers[0], &o.Buffers[1] };
+	cache.SetPSConstantBuffer(5, &o.Buffers[0]);
+	uCalls = context.BindCalls;
+	cache.SetPSConstantBuffers(5, 2, lBuffers);
+	CHECK(context.BindCalls == uCalls + 1);
+	CHECK(context.PS.ConstantBuffers[5] == &o.Buffers[0] && context.PS.ConstantBuffers[6] == &o.Buffers[1]);
+	cache.SetPSConstantBuffers(5, 2, lBuffers);
+	cache.SetPSConstantBuffer(6, &o.Buffers[1]);
+	CHECK(context.BindCalls == uCalls + 1);
+
+	// Render targets always reach the context and make the shader resources unknown.
+	ID3D11RenderTargetView* pTarget = &o.RenderTarget;
+	cache.SetPSSampler(0, &o.Samplers[0]);
+	uCalls = context.BindCalls;
+	cache.SetRenderTargets(1, &pTarget, nullptr);
+	cache.SetRenderTargets(1, &pTarget, nullptr);
+	cache.SetPSShaderResource(5, &o.SRVs[1]);
+	cache.SetPSSampler(0, &o.Samplers[0]);
+	CHECK(context.BindCalls == uCalls + 3);
+
+	// Random binds through the cache leave the same state as binding everything directly.
+	std::mt19937 rng(19);
+	ID3D11DeviceContext1 cached;
+	ID3D11DeviceContext1 direct;
+	cache.SetContext(&cached, &cached);
+	cache.BeginFrame();
+	unsigned int uMismatches = 0;
+	for (int i = 0; i < 20000; i++)
+	{
+		RandomBind(rng, o, cache, direct);
+		if (i % 97 == 0)
+		{
+			ID3D11RenderTargetView* pTarget = i % 2 ? &o.RenderTarget : nullptr;
+			cache.SetRenderTargets(1, &pTarget, nullptr);
+			direct.OMSetRenderTargets(1, &pTarget, nullptr);
+		}
+		if (!SameState(cached, direct)) uMismatches++;
+	}
+	printf("20000 random binds: %u of %u reached the context\n", cached.BindCalls, direct.BindCalls);
+	CHECK(uMismatches == 0);
+	CHECK(cached.BindCalls == cache.GetStats().Issued);
+	CHECK(direct.BindCalls == cache.GetStats().Issued + cache.GetStats().Elided);
+
+	return Check::Report("PipelineStateCacheTest");
+}
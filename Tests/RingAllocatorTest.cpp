@@ -0,0 +1,155 @@
+// Checks RingAllocator's alignment, wrap-around and NPOS when full, that
+// retiring a frame frees its ranges and no others, and that random frames of
+// allocations never hand out a range that overlaps one still in use.
+
+#include <cstdio>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "Check.h"
+#include "RingAllocator.h"
+
+namespace
+{
+	/// <summary>
+	/// A range handed out, from its offset up to but not including its end.
+	/// </summary>
+	struct Range
+	{
+		size_t Start;
+		size_t End;
+	};
+
+	bool Overlaps(const Range& a_rA, const Range& a_rB)
+	{
+		return a_rA.Start < a_rB.End && a_rB.Start < a_rA.End;
+	}
+}
+
+int main()
+{
+	// Offsets are aligned, the padding before them counts as used.
+	RingAllocator ring(1024);
+	CHECK(ring.Allocate(3, 1) == 0);
+	CHECK(ring.Allocate(4, 16) == 16);
+	CHECK(ring.Allocate(1, 256) == 256);
+	CHECK(ring.Allocate(8, 4) == 260);
+	CHECK(ring.GetUsed() == 268);
+
+	// Nothing empty, nothing bigger than the buffer, nothing once it is full.
+	CHECK(ring.Allocate(0, 1) == RingAllocator::NPOS);
+	CHECK(ring.Allocate(1025, 1) == RingAllocator::NPOS);
+	CHECK(ring.Allocate(756, 1) == 268);
+	CHECK(ring.GetUsed() == 1024);
+	CHECK(ring.Allocate(1, 1) == RingAllocator::NPOS);
+
+	// Nothing to retire yet, the frame being recorded is not in flight.
+	CHECK(!ring.RetireFrame());
+	ring.EndFrame();
+	CHECK(ring.GetFramesInFlight() == 1);
+	CHECK(ring.RetireFrame());
+	CHECK(ring.GetUsed() == 0);
+	CHECK(ring.GetFramesInFlight() == 0);
+
+	// Three frames of 256 bytes each, then retiring only the oldest.
+	ring.Reset(1024);
+	for (size_t f = 0; f < 3; f++)
+	{
+		CHECK(ring.Allocate(256, 256) == f * 256);
+		ring.EndFrame();
+	}
+	CHECK(ring.Allocate(256, 256) == 768);
+	CHECK(ring.Allocate(1, 1) == RingAllocator::NPOS);
+	CHECK(ring.RetireFrame());
+	CHECK(ring.GetUsed() == 768);
+
+	// The freed front is handed out again, wrapping around, but only it.
+	CHECK(ring.Allocate(256, 256) == 0);
+	CHECK(ring.Allocate(1, 1) == RingAllocator::NPOS);
+	ring.EndFrame();
+	CHECK(ring.GetFramesInFlight() == 3);
+	CHECK(ring.RetireFrame());
+	CHECK(ring.Allocate(257, 1) == RingAllocator::NPOS);
+	CHECK(ring.Allocate(256, 1) == 256);
+
+	// A range that does not fit at the end wraps to the front, and the end it
+	// skipped stays taken until its frame retires.
+	ring.Reset(1024);
+	CHECK(ring.Allocate(600, 1) == 0);
+	ring.EndFrame();
+	CHECK(ring.Allocate(300, 1) == 600);
+	ring.EndFrame();
+	CHECK(ring.RetireFrame());
+	CHECK(ring.Allocate(200, 1) == 0);
+	CHECK(ring.GetUsed() == 300 + 124 + 200);
+	ring.EndFrame();
+	CHECK(ring.RetireFrame());
+	CHECK(ring.GetUsed() == 124 + 200);
+	CHECK(ring.Allocate(701, 1) == RingAllocator::NPOS);
+	CHECK(ring.Allocate(700, 1) == 200);
+	CHECK(ring.RetireFrame());
+	CHECK(!ring.RetireFrame());
+	CHECK(ring.GetUsed() == 700);
+
+	// Once everything has retired the ring starts over at the front.
+	ring.EndFrame();
+	CHECK(ring.RetireFrame());
+	CHECK(ring.GetUsed() == 0);
+	CHECK(ring.Allocate(1024, 1) == 0);
+
+	// Random frames, retired a few frames late like the GPU would, checked
+	// against every range still in use.
+	std::mt19937 rng(22);
+	const size_t uCapacity = 64 * 1024;
+	ring.Reset(uCapacity);
+	std::deque<std::vector<Range>> lInFlight;
+	std::vector<Range> lRecording;
+	unsigned int uMisaligned = 0, uOutside = 0, uOverlapping = 0, uBadRetires = 0, uRefused = 0, uAllocations = 0;
+	for (int f = 0; f < 2000; f++)
+	{
+		unsigned int uCount = rng() % 40;
+		for (unsigned int a = 0; a < uCount; a++)
+		{
+			size_t uSize = 1 + rng() % 2048;
+			size_t uAlignment = size_t(1) << (rng() % 9);
+			size_t uOffset = ring.Allocate(uSize, uAlignment);
+			if (uOffset == RingAllocator::NPOS)
+			{
+				uRefused++;
+				continue;
+			}
+			uAllocations++;
+			Range range = { uOffset, uOffset + uSize };
+			if (uOffset % uAlignment != 0) uMisaligned++;
+			if (range.End > uCapacity) uOutside++;
+			for (const std::vector<Range>& lFrame : lInFlight)
+			{
+				for (const Range& other : lFrame) uOverlapping += Overlaps(range, other);
+			}
+			for (const Range& other : lRecording) uOverlapping += Overlaps(range, other);
+			lRecording.push_back(range);
+		}
+		ring.EndFrame();
+		lInFlight.push_back(std::move(lRecording));
+		lRecording.clear();
+
+		while (lInFlight.size() > 1 + rng() % 3)
+		{
+			uBadRetires += !ring.RetireFrame();
+			lInFlight.pop_front();
+		}
+		uBadRetires += ring.GetFramesInFlight() != lInFlight.size();
+	}
+	printf("%u allocations, %u refused\n", uAllocations, uRefused);
+	CHECK(uMisaligned == 0);
+	CHECK(uOutside == 0);
+	CHECK(uOverlapping == 0);
+	CHECK(uBadRetires == 0);
+	CHECK(uRefused > 0);
+
+	while (ring.RetireFrame()) {}
+	CHECK(ring.GetUsed() == 0);
+
+	return Check::Report("RingAllocatorTest");
+}
@@ -0,0 +1,177 @@
+// Checks ShaderReflectionCache against the checked in cache in Fixtures/,
+// written by version 1 for PBRPixelShader's layout: it reads back exactly,
+// serializing gives the same bytes, and truncated or flipped bytes or a
+// wrong hash, size or version are refused.  ReflectionFixture.cso stands in
+// for the bytecode, it is not a real shader.
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+#include "ShaderReflectionCache.h"
+
+namespace
+{
+	const std::string g_sShaderPath = std::string(FIXTURES_DIR) + "ReflectionFixture.cso";
+
+	/// <summary>
+	/// What the fixture holds.
+	/// </summary>
+	ShaderReflectionData ExpectedData(void)
+	{
+		ShaderReflectionData data;
+		data.Buffers =
+		{
+			{ "PerMaterial", 0, 0, 16, { { "scale", 0, 8 }, { "offset", 8, 8 } } },
+			{ "SceneConstants", 0, 2, 352, { { "ambient", 0, 12 }, { "ambientPadding", 12, 4 }, { "cameraPosition", 16, 12 }, { "cameraPadding", 28, 4 }, { "lights", 32, 320 } } },
+		};
+		data.Textures = { { "Albedo", 0 }, { "NormalMap", 1 }, { "RoughnessMap", 2 }, { "MetalnessMap", 3 }, { "ShadowMap", 4 } };
+		data.Samplers = { { "BasicSampler", 0 }, { "ShadowSampler", 1 } };
+		return data;
+	}
+
+	std::vector<unsigned char> ReadFile(const std::filesystem::path& a_sPath)
+	{
+		std::ifstream file(a_sPath, std::ios::binary);
+		return std::vector<unsigned char>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	}
+
+	bool Equal(const ShaderReflectionResource& a_srrA, const ShaderReflectionResource& a_srrB)
+	{
+		return a_srrA.Name == a_srrB.Name && a_srrA.BindIndex == a_srrB.BindIndex;
+	}
+
+	/// <summary>
+	/// Whether two sets of reflection data match field for field.
+	/// </summary>
+	bool Equal(const ShaderReflectionData& a_srdA, const ShaderReflectionData& a_srdB)
+	{
+		if (a_srdA.Buffers.size() != a_srdB.Buffers.size() ||
+			a_srdA.Textures.size() != a_srdB.Textures.size() ||
+			a_srdA.Samplers.size() != a_srdB.Samplers.size())
+			return false;
+		for (size_t b = 0; b < a_srdA.Buffers.size(); b++)
+		{
+			const ShaderReflectionBuffer& a = a_srdA.Buffers[b];
+			const ShaderReflectionBuffer& c = a_srdB.Buffers[b];
+			if (a.Name != c.Name || a.Type != c.Type || a.BindIndex != c.BindIndex || a.Size != c.Size || a.Variables.size() != c.Variables.size())
+				return false;
+			for (size_t v = 0; v < a.Variables.size(); v++)
+			{
+				if (a.Variables[v].Name != c.Variables[v].Name || a.Variables[v].ByteOffset != c.Variables[v].ByteOffset || a.Variables[v].Size != c.Variables[v].Size)
+					return false;
+			}
+		}
+		for (size_t t = 0; t < a_srdA.Textures.size(); t++)
+		{
+			if (!Equal(a_srdA.Textures[t], a_srdB.Textures[t])) return false;
+		}
+		for (size_t s = 0; s < a_srdA.Samplers.size(); s++)
+		{
+			if (!Equal(a_srdA.Samplers[s], a_srdB.Samplers[s])) return false;
+		}
+		return true;
+	}
+}
+
+int main()
+{
+	std::vector<unsigned char> lBytecode = ReadFile(g_sShaderPath);
+	std::vector<unsigned char> lFixture = ReadFile(ShaderReflectionCache::GetCachePath(g_sShaderPath));
+	if (!CHECK(!lBytecode.empty() && !lFixture.empty())) return Check::Report("ShaderReflectionCacheTest");
+	uint64_t uHash = ShaderReflectionCache::Hash(lBytecode.data(), lBytecode.size());
+	uint64_t uSize = lBytecode.size();
+	const ShaderReflectionData expected = ExpectedData();
+
+	// The fixture reads back exactly, from memory and from its file.
+	ShaderReflectionData data;
+	CHECK(ShaderReflectionCache::Deserialize(lFixture.data(), lFixture.size(), uHash, uSize, data));
+	CHECK(Equal(data, expected));
+	data = {};
+	CHECK(ShaderReflectionCache::Read(g_sShaderPath, uHash, uSize, data));
+	CHECK(Equal(data, expected));
+
+	// The format has not drifted: this build writes the same bytes.
+	CHECK(ShaderReflectionCache::Serialize(uHash, uSize, expected) == lFixture);
+
+	// Every shorter file is refused, as is one with a byte too many.
+	unsigned int uAccepted = 0;
+	for (size_t uLength = 0; uLength < lFixture.size(); uLength++)
+	{
+		uAccepted += ShaderReflectionCache::Deserialize(lFixture.data(), uLength, uHash, uSize, data);
+	}
+	std::vector<unsigned char> lLonger = lFixture;
+	lLonger.push_back(0);
+	uAccepted += ShaderReflectionCache::Deserialize(lLonger.data(), lLonger.size(), uHash, uSize, data);
+	CHECK(uAccepted == 0);
+
+	// Flipping any bit of any byte, header included, is refused.
+	std::vector<unsigned char> lDamaged = lFixture;
+	for (size_t i = 0; i < lDamaged.size(); i++)
+	{
+		for (int iBit = 0; iBit < 8; iBit++)
+		{
+			lDamaged[i] ^= static_cast<unsigned char>(1 << iBit);
+			uAccepted += ShaderReflectionCache::Deserialize(lDamaged.data(), lDamaged.size(), uHash, uSize, data);
+			lDamaged[i] = lFixture[i];
+		}
+	}
+	CHECK(uAccepted == 0);
+
+	// A cache of other bytecode, or from another version, is refused.
+	CHECK(!ShaderReflectionCache::Deserialize(lFixture.data(), lFixture.size(), uHash + 1, uSize, data));
+	CHECK(!ShaderReflectionCache::Deserialize(lFixture.data(), lFixture.size(), uHash, uSize - 1, data));
+	lBytecode[lBytecode.size() / 2] ^= 1;
+	CHECK(!ShaderReflectionCache::Read(g_sShaderPath, ShaderReflectionCache::Hash(lBytecode.data(), lBytecode.size()), uSize, data));
+	ShaderReflectionCacheHeader header;
+	memcpy(&header, lFixture.data(), sizeof(header));
+	header.Version = ShaderReflectionCache::VERSION + 1;
+	memcpy(lDamaged.data(), &header, sizeof(header));
+	CHECK(!ShaderReflectionCache::Deserialize(lDamaged.data(), lDamaged.size(), uHash, uSize, data));
+	CHECK(!ShaderReflectionCache::Deserialize(nullptr, 0, uHash, uSize, data));
+
+	// Refusing leaves what was passed in alone.
+	CHECK(Equal(data, expected));
+
+	// Random layouts survive the trip through a file next to a shader.
+	std::mt19937 rng(23);
+	std::filesystem::path sShader = std::filesystem::temp_directory_path() / "ShaderReflectionCacheTest.cso";
+	unsigned int uMismatches = 0;
+	for (int r = 0; r < 200; r++)
+	{
+		ShaderReflectionData random;
+		random.Buffers.resize(rng() % 4);
+		for (ShaderReflectionBuffer& buffer : random.Buffers)
+		{
+			buffer.Name = "Buffer" + std::to_string(rng());
+			buffer.Type = rng() % 2;
+			buffer.BindIndex = rng() % 14;
+			buffer.Size = 16 * (1 + rng() % 64);
+			buffer.Variables.resize(rng() % 8);
+			for (ShaderReflectionVariable& variable : buffer.Variables)
+			{
+				variable.Name = std::string(rng() % 40, 'a' + rng() % 26);
+				variable.Size = 4 * (rng() % 5);
+				variable.ByteOffset = rng() % (buffer.Size - variable.Size + 1);
+			}
+		}
+		random.Textures.resize(rng() % 6, { "Texture" + std::to_string(rng()), static_cast<uint32_t>(rng() % 16) });
+		random.Samplers.resize(rng() % 3, { "", static_cast<uint32_t>(rng() % 16) });
+
+		ShaderReflectionData readBack;
+		if (!ShaderReflectionCache::Write(sShader, r, 1000 + r, random) ||
+			!ShaderReflectionCache::Read(sShader, r, 1000 + r, readBack) ||
+			!Equal(readBack, random))
+			uMismatches++;
+	}
+	CHECK(uMismatches == 0);
+	std::filesystem::remove(ShaderReflectionCache::GetCachePath(sShader));
+
+	return Check::Report("ShaderReflectionCacheTest");
+}
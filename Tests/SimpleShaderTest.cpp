@@ -0,0 +1,143 @@
+// Checks SimpleShader's constant buffer dirty tracking against the recording
+// mock context: buffers are only uploaded when a write changed their bytes,
+// and a frame of draws uploads each buffer as often as its values change.
+
+#include <cstdio>
+#include <cstring>
+
+#include "Check.h"
+#include "PipelineStateCache.h"
+#include "SimpleShader.h"
+#include "UploadRing.h"
+
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+	const unsigned int g_uMaterialCount = 4;
+	const unsigned int g_uDrawCount = 100;
+
+	/// <summary>
+	/// Registers the split constant buffers of VertexShader.hlsl and PBRPixelShader.hlsl.
+	/// </summary>
+	void AddShaders(void)
+	{
+		MockShaders::Shader vertex;
+		vertex.Buffers = { { "PerObject", 0, 256, { { "world", 0, 64 }, { "worldInvTranspose", 64, 64 }, { "worldViewProjection", 128, 64 }, { "worldLightViewProjection", 192, 64 } } } };
+		vertex.Inputs = { { "POSITION", 0, D3D_REGISTER_COMPONENT_FLOAT32, 0x7 } };
+		MockShaders::Add(L"SimpleShaderTestVS.cso", vertex);
+
+		MockShaders::Shader pixel;
+		pixel.Buffers =
+		{
+			{ "PerMaterial", 0, 16, { { "scale", 0, 8 }, { "offset", 8, 8 } } },
+			{ "PerView", 1, 16, { { "cameraPosition", 0, 12 } } },
+			{ "PerFrame", 2, 32, { { "ambient", 0, 12 }, { "totalTime", 12, 4 }, { "lightCount", 16, 4 } } },
+		};
+		MockShaders::Add(L"SimpleShaderTestPS.cso", pixel);
+	}
+
+	/// <summary>
+	/// Uploads one buffer and says whether it went to the GPU.
+	/// </summary>
+	bool Uploaded(ISimpleShader& a_ssShader, const char* a_sBuffer)
+	{
+		unsigned int uUploads = ISimpleShader::UploadStats.Uploads;
+		a_ssShader.CopyBufferData(a_sBuffer);
+		return ISimpleShader::UploadStats.Uploads > uUploads;
+	}
+}
+
+int main()
+{
+	AddShaders();
+	ComPtr<ID3D11Device> device(new ID3D11Device());
+	ID3D11DeviceContext1* pContext = new ID3D11DeviceContext1();
+	ComPtr<ID3D11DeviceContext> context(pContext);
+	SimpleVertexShader vs(device, context, L"SimpleShaderTestVS.cso");
+	SimplePixelShader ps(device, context, L"SimpleShaderTestPS.cso");
+	if (!CHECK(vs.IsShaderValid() && ps.IsShaderValid())) return Check::Report("SimpleShaderTest");
+
+	// New buffers start dirty, since what the GPU holds is undefined.
+	ISimpleShader::UploadStats = {};
+	ps.CopyAllBufferData();
+	CHECK(ISimpleShader::UploadStats.Uploads == 3);
+	CHECK(ISimpleShader::UploadStats.Bytes == 16 + 16 + 32);
+	CHECK(pContext->UpdateCalls == 3);
+
+	// Nothing written, or only the same bytes again, uploads nothing.
+	ISimpleShader::UploadStats = {};
+	ps.CopyAllBufferData();
+	ps.SetFloat2("scale", XMFLOAT2(0.0f, 0.0f));
+	ps.SetFloat3("cameraPosition", XMFLOAT3(0.0f, 0.0f, 0.0f));
+	ps.CopyAllBufferData();
+	CHECK(ISimpleShader::UploadStats.Uploads == 0);
+	CHECK(ISimpleShader::UploadStats.Skipped == 6);
+	CHECK(pContext->UpdateCalls == 3);
+
+	// A change uploads only its own buffer, all of it, and the GPU copy matches.
+	ps.SetFloat2("offset", XMFLOAT2(0.5f, 0.25f));
+	ps.SetFloat("totalTime", 2.0f);
+	ps.SetFloat3("ambient", XMFLOAT3(0.1f, 0.2f, 0.3f));
+	const SimpleConstantBuffer* pFrame = ps.GetBufferInfo("PerFrame");
+	CHECK(pFrame->DirtyStart == 0 && pFrame->DirtyEnd == 16);
+	CHECK(!Uploaded(ps, "PerView"));
+	CHECK(Uploaded(ps, "PerMaterial"));
+	CHECK(Uploaded(ps, "PerFrame"));
+	CHECK(!pFrame->IsDirty());
+	CHECK(memcmp(pFrame->ConstantBuffer->Contents.data(), pFrame->LocalDataBuffer, pFrame->Size) == 0);
+	CHECK(pContext->UpdateCalls == 5);
+
+	// Two frames of draws sorted by material, the camera still in the second.
+	// Each draw has its own world matrix, each material its own scale.
+	unsigned int lUploads[4] = {};
+	ISimpleShader::UploadStats = {};
+	for (unsigned int f = 0; f < 2; f++)
+	{
+		ps.SetFloat("totalTime", 3.0f + f);
+		ps.SetFloat3("cameraPosition", XMFLOAT3(0.0f, 1.0f, -5.0f));
+		lUploads[2] += Uploaded(ps, "PerView");
+		lUploads[3] += Uploaded(ps, "PerFrame");
+		for (unsigned int d = 0; d < g_uDrawCount; d++)
+		{
+			unsigned int uMaterial = d * g_uMaterialCount / g_uDrawCount;
+			ps.SetFloat2("scale", XMFLOAT2(1.0f + uMaterial, 1.0f));
+			lUploads[1] += Uploaded(ps, "PerMaterial");
+			XMFLOAT4X4 m4World;
+			XMStoreFloat4x4(&m4World, XMMatrixTranslation(static_cast<float>(d), 0.0f, 0.0f));
+			vs.SetMatrix4x4("world", m4World);
+			lUploads[0] += Uploaded(vs, "PerObject");
+		}
+	}
+	printf("two frames of %u draws: %u per object, %u per material, %u per view and %u per frame uploads, %u bytes\n",
+		g_uDrawCount, lUploads[0], lUploads[1], lUploads[2], lUploads[3], ISimpleShader::UploadStats.Bytes);
+	CHECK(lUploads[0] == 2 * g_uDrawCount);
+	CHECK(lUploads[1] == 2 * g_uMaterialCount);
+	CHECK(lUploads[2] == 1);
+	CHECK(lUploads[3] == 2);
+	CHECK(ISimpleShader::UploadStats.Uploads + ISimpleShader::UploadStats.Skipped == 2 * (2 + 2 * g_uDrawCount));
+
+	// Through the upload ring, an unchanged buffer is skipped until the ring moves on.
+	PipelineStateCache cache;
+	cache.SetContext(pContext, pContext);
+	UploadRing ring;
+	if (CHECK(ring.Initialize(device.Get(), pContext, 64 * 1024, D3D11_BIND_CONSTANT_BUFFER)))
+	{
+		ISimpleShader::StateCache = &cache;
+		ISimpleShader::ConstantRing = &ring;
+		ring.BeginFrame();
+		CHECK(Uploaded(ps, "PerView"));
+		CHECK(!Uploaded(ps, "PerView"));
+		ps.SetFloat3("cameraPosition", XMFLOAT3(1.0f, 1.0f, -5.0f));
+		CHECK(Uploaded(ps, "PerView"));
+		ring.EndFrame();
+		ring.BeginFrame();
+		CHECK(Uploaded(ps, "PerView"));
+		ring.EndFrame();
+		ISimpleShader::StateCache = nullptr;
+		ISimpleShader::ConstantRing = nullptr;
+	}
+
+	return Check::Report("SimpleShaderTest");
+}
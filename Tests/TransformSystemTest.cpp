@@ -0,0 +1,99 @@
+// Checks that a scene standing still recomputes no matrices, however its
+// transforms are read, and that moving something recomputes only that.
+
+#include <cstdio>
+
+#include "Check.h"
+#include "Transform.h"
+#include "TransformSystem.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const unsigned int g_uEntityCount = 100;
+	const unsigned int g_uFrameCount = 60;
+
+	/// <summary>
+	/// Reads everything a frame reads, the way Game::Draw and the ImGui window do.
+	/// </summary>
+	void ReadFrame(TransformSystem& a_tsSystem, const Transform& a_tCamera)
+	{
+		XMFLOAT4X4 m4Identity;
+		XMStoreFloat4x4(&m4Identity, XMMatrixIdentity());
+		a_tsSystem.CalculateViewProjections(m4Identity, m4Identity);
+
+		a_tCamera.GetPosition();
+		for (unsigned int i = 0; i < a_tsSystem.GetCount(); i++)
+		{
+			TransformHandle handle(&a_tsSystem, i);
+			handle.GetPosition();
+			handle.GetRotation();
+			handle.GetScale();
+			handle.GetWorldMatrix();
+			handle.GetWorldInverseTransposeMatrix();
+			handle.GetWorldViewProjectionMatrix();
+		}
+	}
+}
+
+int main()
+{
+	TransformSystem system;
+	for (unsigned int i = 0; i < g_uEntityCount; i++)
+	{
+		TransformHandle handle(&system, system.Create());
+		handle.SetPosition(static_cast<float>(i), 0.0f, -static_cast<float>(i));
+		handle.SetRotation(0.1f * i, 0.0f, 0.0f);
+	}
+	Transform camera;
+	camera.SetPosition(0.0f, 2.0f, -10.0f);
+	camera.GetWorldMatrix();
+
+	// The first update computes everything once.
+	CHECK(system.GetDirtyCount() == g_uEntityCount);
+	system.Update();
+	CHECK(system.GetDirtyCount() == 0);
+	CHECK(system.GetRecalculationCount() == g_uEntityCount);
+
+	// Standing still, nothing is recomputed however many frames go by.
+	unsigned int uSystemBefore = system.GetRecalculationCount();
+	unsigned int uTransformBefore = Transform::GetRecalculationCount();
+	JobSystem jobs(2);
+	for (unsigned int uFrame = 0; uFrame < g_uFrameCount; uFrame++)
+	{
+		system.Update(uFrame % 2 == 0 ? nullptr : &jobs);
+		ReadFrame(system, camera);
+		camera.GetWorldMatrix();
+		camera.GetWorldInverseTransposeMatrix();
+	}
+	CHECK(system.GetRecalculationCount() - uSystemBefore == 0);
+	CHECK(Transform::GetRecalculationCount() - uTransformBefore == 0);
+	CHECK(system.GetDirtyCount() == 0);
+
+	// Moving one entity recomputes just it, and only once.
+	uSystemBefore = system.GetRecalculationCount();
+	TransformHandle(&system, 42).MoveAbsolute(0.0f, 1.0f, 0.0f);
+	CHECK(system.GetDirtyCount() == 1);
+	system.Update();
+	system.Update();
+	ReadFrame(system, camera);
+	CHECK(system.GetRecalculationCount() - uSystemBefore == 1);
+
+	// Reading a dirty matrix before Update() computes it, and Update() then has nothing left to do.
+	uSystemBefore = system.GetRecalculationCount();
+	TransformHandle(&system, 7).Rotate(0.0f, 0.5f, 0.0f);
+	TransformHandle(&system, 7).GetWorldMatrix();
+	system.Update();
+	CHECK(system.GetRecalculationCount() - uSystemBefore == 1);
+
+	// MoveRelative really moves the camera, so its matrices are rebuilt exactly once.
+	uTransformBefore = Transform::GetRecalculationCount();
+	camera.MoveRelative(0.0f, 0.0f, 1.0f);
+	camera.GetPosition();
+	camera.GetWorldMatrix();
+	camera.GetWorldInverseTransposeMatrix();
+	CHECK(Transform::GetRecalculationCount() - uTransformBefore == 1);
+
+	return Check::Report("TransformSystemTest");
+}
@@ -0,0 +1,103 @@
+// Checks UploadRing's grow path: a write that does not fit moves to a larger
+// buffer and a new epoch, the new buffer is mapped with discard once and then
+// with no-overwrite, and the outgrown buffer is let go at the next frame.  Also
+// checks that a frame's space only comes back once its fence has signalled.
+
+#include <cstdio>
+
+#include "Check.h"
+#include "UploadRing.h"
+
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+	/// <summary>
+	/// How many references there are to an object, without changing them.
+	/// </summary>
+	unsigned long References(IUnknown* a_pObject)
+	{
+		a_pObject->AddRef();
+		return a_pObject->Release();
+	}
+
+	/// <summary>
+	/// Writes two full frames of half the ring each, then starts a third with the
+	/// GPU answering every fence as given, and writes half the ring again.
+	/// </summary>
+	/// <returns>True if that write had to move to a larger buffer.</returns>
+	bool GrewWaitingOnFences(ID3D11Device* a_pDevice, ID3D11DeviceContext* a_pContext, HRESULT a_hQueryResult)
+	{
+		unsigned char lData[256] = {};
+		UploadRing ring;
+		UploadAllocation uaFirst = {}, uaLast = {};
+		if (!CHECK(ring.Initialize(a_pDevice, a_pContext, 512, D3D11_BIND_CONSTANT_BUFFER))) return false;
+
+		a_pContext->QueryResult = a_hQueryResult;
+		for (int iFrame = 0; iFrame < 2; iFrame++)
+		{
+			ring.BeginFrame();
+			CHECK(ring.Write(lData, sizeof(lData), 256, iFrame == 0 ? uaFirst : uaLast));
+			ring.EndFrame();
+		}
+		ring.BeginFrame();
+		CHECK(ring.Write(lData, sizeof(lData), 256, uaLast));
+		ring.EndFrame();
+		a_pContext->QueryResult = S_OK;
+		return uaLast.Buffer != uaFirst.Buffer;
+	}
+}
+
+int main()
+{
+	ComPtr<ID3D11Device> device(new ID3D11Device());
+	ComPtr<ID3D11DeviceContext> context(new ID3D11DeviceContext());
+	ID3D11DeviceContext* pContext = context.Get();
+	unsigned char lData[256] = {};
+
+	UploadRing ring;
+	if (!CHECK(ring.Initialize(device.Get(), pContext, 256, D3D11_BIND_CONSTANT_BUFFER))) return Check::Report("UploadRingTest");
+
+	// A new buffer is mapped with discard once, after that with no-overwrite.
+	UploadAllocation uaFirst = {}, uaSecond = {}, uaGrown = {}, uaAfter = {};
+	ring.BeginFrame();
+	CHECK(ring.Write(lData, 128, 16, uaFirst));
+	CHECK(pContext->LastMapType == D3D11_MAP_WRITE_DISCARD);
+	CHECK(ring.Write(lData, 64, 16, uaSecond));
+	CHECK(pContext->LastMapType == D3D11_MAP_WRITE_NO_OVERWRITE);
+	CHECK(uaSecond.Buffer == uaFirst.Buffer && uaSecond.Offset == 128);
+
+	// What does not fit in the frame's space moves to a bigger buffer and a new epoch.
+	ComPtr<ID3D11Buffer> pOutgrown(uaFirst.Buffer);
+	unsigned int uEpoch = ring.GetEpoch();
+	CHECK(ring.Write(lData, 128, 16, uaGrown));
+	CHECK(uaGrown.Buffer != pOutgrown.Get() && uaGrown.Offset == 0);
+	CHECK(uaGrown.Buffer->Desc.ByteWidth == 512);
+	CHECK(ring.GetEpoch() != uEpoch);
+	CHECK(pContext->LastMapType == D3D11_MAP_WRITE_DISCARD);
+	CHECK(ring.Write(lData, 64, 16, uaAfter));
+	CHECK(uaAfter.Buffer == uaGrown.Buffer && uaAfter.Offset == 128);
+	CHECK(pContext->LastMapType == D3D11_MAP_WRITE_NO_OVERWRITE);
+
+	// The outgrown buffer was handed out this frame, so the ring keeps it until the next.
+	CHECK(References(pOutgrown.Get()) > 1);
+	ring.EndFrame();
+	CHECK(References(pOutgrown.Get()) > 1);
+	ring.BeginFrame();
+	CHECK(References(pOutgrown.Get()) == 1);
+	const UploadRingStats& ursStats = ring.GetLastFrameStats();
+	CHECK(ursStats.Allocations == 4 && ursStats.Bytes == 384);
+	CHECK(ursStats.Growths == 1 && ursStats.Capacity == 512);
+
+	// The grown buffer keeps no-overwrite across frames.
+	CHECK(ring.Write(lData, 64, 16, uaAfter));
+	CHECK(uaAfter.Buffer == uaGrown.Buffer);
+	CHECK(pContext->LastMapType == D3D11_MAP_WRITE_NO_OVERWRITE);
+	ring.EndFrame();
+
+	// Two frames fill the ring, the third fits only if the GPU has passed the first.
+	CHECK(!GrewWaitingOnFences(device.Get(), pContext, S_OK));
+	CHECK(GrewWaitingOnFences(device.Get(), pContext, S_FALSE));
+
+	return Check::Report("UploadRingTest");
+}
@@ -0,0 +1,187 @@
+// Round trips the shipped models and a fixed set of random vertices through
+// VertexCompression and checks every component against the error bounds
+// VertexCompression.h states.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Check.h"
+#include "ObjLoader.h"
+#include "VertexCompression.h"
+
+using namespace DirectX;
+
+namespace
+{
+	const char* g_lModels[] = { "cube", "cylinder", "helix", "quad", "quad_double_sided", "sphere", "torus" };
+
+	/// <summary>
+	/// Worst errors seen across every round trip, in the units of the bounds.
+	/// </summary>
+	struct Errors
+	{
+		float Position = 0.0f;		// Fraction of the extent.
+		float Normal = 0.0f;		// Radians.
+		float Tangent = 0.0f;		// Radians.
+		float UV = 0.0f;			// Relative to max(1, |uv|).
+		int HandednessFlips = 0;
+	};
+
+	/// <summary>
+	/// Angle between two unit vectors, accurate for the tiny angles measured here.
+	/// </summary>
+	float AngleBetween(const XMFLOAT3& a_v3A, const XMFLOAT3& a_v3B)
+	{
+		double fCrossX = static_cast<double>(a_v3A.y) * a_v3B.z - static_cast<double>(a_v3A.z) * a_v3B.y;
+		double fCrossY = static_cast<double>(a_v3A.z) * a_v3B.x - static_cast<double>(a_v3A.x) * a_v3B.z;
+		double fCrossZ = static_cast<double>(a_v3A.x) * a_v3B.y - static_cast<double>(a_v3A.y) * a_v3B.x;
+		double fDot = static_cast<double>(a_v3A.x) * a_v3B.x + static_cast<double>(a_v3A.y) * a_v3B.y + static_cast<double>(a_v3A.z) * a_v3B.z;
+		return static_cast<float>(std::atan2(std::sqrt(fCrossX * fCrossX + fCrossY * fCrossY + fCrossZ * fCrossZ), fDot));
+	}
+
+	XMFLOAT3 Normalized(const XMFLOAT3& a_v3Vector)
+	{
+		float fLength = std::sqrt(a_v3Vector.x * a_v3Vector.x + a_v3Vector.y * a_v3Vector.y + a_v3Vector.z * a_v3Vector.z);
+		return XMFLOAT3(a_v3Vector.x / fLength, a_v3Vector.y / fLength, a_v3Vector.z / fLength);
+	}
+
+	/// <summary>
+	/// Compresses and decompresses a vertex, folding its errors into the totals.
+	/// </summary>
+	void RoundTrip(const Vertex& a_vVertex, const XMFLOAT3& a_v3Min, const XMFLOAT3& a_v3Max, Errors& a_eErrors)
+	{
+		Vertex decoded = VertexCompression::Decompress(VertexCompression::Compress(a_vVertex, a_v3Min, a_v3Max), a_v3Min, a_v3Max);
+
+		const float* pOriginal = &a_vVertex.Position.x;
+		const float* pDecoded = &decoded.Position.x;
+		const float* pMin = &a_v3Min.x;
+		const float* pMax = &a_v3Max.x;
+		for (int i = 0; i < 3; i++)
+		{
+			float fExtent = pMax[i] - pMin[i];
+			float fError = std::fabs(pDecoded[i] - pOriginal[i]);
+			a_eErrors.Position = std::max(a_eErrors.Position, fExtent > 0.0f ? fError / fExtent : fError);
+		}
+
+		a_eErrors.Normal = std::max(a_eErrors.Normal, AngleBetween(Normalized(a_vVertex.Normal), decoded.Normal));
+		XMFLOAT3 v3Tangent(a_vVertex.Tangent.x, a_vVertex.Tangent.y, a_vVertex.Tangent.z);
+		XMFLOAT3 v3DecodedTangent(decoded.Tangent.x, decoded.Tangent.y, decoded.Tangent.z);
+		a_eErrors.Tangent = std::max(a_eErrors.Tangent, AngleBetween(Normalized(v3Tangent), v3DecodedTangent));
+		if ((a_vVertex.Tangent.w < 0.0f) != (decoded.Tangent.w < 0.0f)) a_eErrors.HandednessFlips++;
+
+		const float* pUV = &a_vVertex.UV.x;
+		const float* pDecodedUV = &decoded.UV.x;
+		for (int i = 0; i < 2; i++)
+		{
+			float fError = std::fabs(pDecodedUV[i] - pUV[i]) / std::max(1.0f, std::fabs(pUV[i]));
+			a_eErrors.UV = std::max(a_eErrors.UV, fError);
+		}
+	}
+
+	void CheckWithinBounds(const Errors& a_eErrors)
+	{
+		CHECK(a_eErrors.Position <= VertexCompression::MAX_POSITION_ERROR);
+		CHECK(a_eErrors.Normal <= VertexCompression::MAX_DIRECTION_ERROR_RADIANS);
+		CHECK(a_eErrors.Tangent <= VertexCompression::MAX_DIRECTION_ERROR_RADIANS);
+		CHECK(a_eErrors.UV <= VertexCompression::MAX_UV_ERROR);
+		CHECK(a_eErrors.HandednessFlips == 0);
+	}
+
+	void PrintErrors(const char* a_sName, size_t a_uCount, const Errors& a_eErrors)
+	{
+		printf("%-18s %8zu %12.3g %12.3g %12.3g %12.3g\n", a_sName, a_uCount, a_eErrors.Position, a_eErrors.Normal, a_eErrors.Tangent, a_eErrors.UV);
+	}
+}
+
+int main()
+{
+	printf("%-18s %8s %12s %12s %12s %12s\n", "vertices", "count", "position", "normal rad", "tangent rad", "uv");
+	printf("%-18s %8s %12.3g %12.3g %12.3g %12.3g\n", "limit", "",
+		VertexCompression::MAX_POSITION_ERROR, VertexCompression::MAX_DIRECTION_ERROR_RADIANS,
+		VertexCompression::MAX_DIRECTION_ERROR_RADIANS, VertexCompression::MAX_UV_ERROR);
+
+	// The shipped models with tangents made up from their normals, within their own bounds.
+	for (const char* sModel : g_lModels)
+	{
+		std::vector<Vertex> lVertices;
+		std::vector<unsigned int> lIndices;
+		if (!CHECK(ObjLoader::Load((std::string(MODELS_DIR) + sModel + ".graphics_obj").c_str(), lVertices, lIndices))) continue;
+
+		XMFLOAT3 v3Min = lVertices[0].Position;
+		XMFLOAT3 v3Max = lVertices[0].Position;
+		for (const Vertex& vertex : lVertices)
+		{
+			v3Min = XMFLOAT3(std::min(v3Min.x, vertex.Position.x), std::min(v3Min.y, vertex.Position.y), std::min(v3Min.z, vertex.Position.z));
+			v3Max = XMFLOAT3(std::max(v3Max.x, vertex.Position.x), std::max(v3Max.y, vertex.Position.y), std::max(v3Max.z, vertex.Position.z));
+		}
+
+		Errors errors;
+		for (size_t i = 0; i < lVertices.size(); i++)
+		{
+			Vertex vertex = lVertices[i];
+			XMFLOAT3 v3Tangent = Normalized(XMFLOAT3(vertex.Normal.y, vertex.Normal.z + 0.5f, -vertex.Normal.x + 0.25f));
+			vertex.Tangent = XMFLOAT4(v3Tangent.x, v3Tangent.y, v3Tangent.z, i % 2 == 0 ? 1.0f : -1.0f);
+			RoundTrip(vertex, v3Min, v3Max, errors);
+		}
+		PrintErrors(sModel, lVertices.size(), errors);
+		CheckWithinBounds(errors);
+	}
+
+	// Random vertices, with uvs that tile well outside [0, 1].
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> fPosition(-50.0f, 50.0f);
+	std::normal_distribution<float> fDirection(0.0f, 1.0f);
+	std::uniform_real_distribution<float> fUV(-40.0f, 40.0f);
+	XMFLOAT3 v3Min(-50.0f, -50.0f, -50.0f);
+	XMFLOAT3 v3Max(50.0f, 50.0f, 50.0f);
+	Errors errors;
+	const size_t uRandomCount = 100000;
+	for (size_t i = 0; i < uRandomCount; i++)
+	{
+		Vertex vertex = {};
+		vertex.Position = XMFLOAT3(fPosition(rng), fPosition(rng), fPosition(rng));
+		vertex.Normal = Normalized(XMFLOAT3(fDirection(rng), fDirection(rng), fDirection(rng)));
+		XMFLOAT3 v3Tangent = Normalized(XMFLOAT3(fDirection(rng), fDirection(rng), fDirection(rng)));
+		vertex.Tangent = XMFLOAT4(v3Tangent.x, v3Tangent.y, v3Tangent.z, i % 3 == 0 ? -1.0f : 1.0f);
+		vertex.UV = XMFLOAT2(i % 2 == 0 ? fUV(rng) : fUV(rng) / 40.0f, fUV(rng) / 40.0f);
+		RoundTrip(vertex, v3Min, v3Max, errors);
+	}
+
+	// The axes and the octahedron's seams, where the folding is most likely to go wrong.
+	const XMFLOAT3 lDirections[] =
+	{
+		{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+		{ 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+		{ 1, 0, -1 }, { 0, 1, -1 }, { -1, 0, -1 }, { 0, -1, -1 }, { 1, 1, -1 }, { -1, -1, -1 },
+	};
+	for (const XMFLOAT3& v3Direction : lDirections)
+	{
+		Vertex vertex = {};
+		vertex.Position = v3Max;
+		vertex.Normal = Normalized(v3Direction);
+		vertex.Tangent = XMFLOAT4(vertex.Normal.x, vertex.Normal.y, vertex.Normal.z, -1.0f);
+		RoundTrip(vertex, v3Min, v3Max, errors);
+	}
+	PrintErrors("random", uRandomCount, errors);
+	CheckWithinBounds(errors);
+
+	// A flat axis has no extent, everything on it decodes to the minimum.
+	Vertex flat = {};
+	flat.Position = XMFLOAT3(0.5f, 2.0f, -0.25f);
+	flat.Normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+	flat.Tangent = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
+	Vertex decoded = VertexCompression::Decompress(VertexCompression::Compress(flat, XMFLOAT3(-1, 2, -1), XMFLOAT3(1, 2, 1)), XMFLOAT3(-1, 2, -1), XMFLOAT3(1, 2, 1));
+	CHECK(decoded.Position.y == 2.0f);
+
+	// A zero length tangent, from a degenerate uv layout, decodes to +Z instead of NaN.
+	int16_t lEncoded[2];
+	VertexCompression::EncodeOctahedral(XMFLOAT3(0.0f, 0.0f, 0.0f), lEncoded);
+	XMFLOAT3 v3Decoded = VertexCompression::DecodeOctahedral(lEncoded);
+	CHECK(v3Decoded.x == 0.0f && v3Decoded.y == 0.0f && v3Decoded.z == 1.0f);
+
+	return Check::Report("VertexCompressionTest");
+}
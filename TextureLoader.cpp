@@ -0,0 +1,89 @@
+#include "TextureLoader.h"
+
+#include "Graphics.h"
+#include <wincodec.h>
+
+#pragma comment(lib, "windowscodecs.lib")
+
+namespace
+{
+	/// <summary>
+	/// Decodes the first frame of an image into RGBA8.  COM must already be initialized.
+	/// </summary>
+	bool DecodeWithWIC(const wchar_t* a_sFilepath, DecodedImage& a_diImage)
+	{
+		Microsoft::WRL::ComPtr<IWICImagingFactory> pFactory;
+		if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(pFactory.GetAddressOf()))))
+			return false;
+
+		Microsoft::WRL::ComPtr<IWICBitmapDecoder> pDecoder;
+		if (FAILED(pFactory->CreateDecoderFromFilename(a_sFilepath, nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, pDecoder.GetAddressOf())))
+			return false;
+
+		Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> pFrame;
+		if (FAILED(pDecoder->GetFrame(0, pFrame.GetAddressOf())))
+			return false;
+
+		UINT uWidth = 0;
+		UINT uHeight = 0;
+		if (FAILED(pFrame->GetSize(&uWidth, &uHeight)) || uWidth == 0 || uHeight == 0)
+			return false;
+
+		// Converting whatever the file holds to the R8G8B8A8_UNORM the textures are created with.
+		Microsoft::WRL::ComPtr<IWICFormatConverter> pConverter;
+		if (FAILED(pFactory->CreateFormatConverter(pConverter.GetAddressOf())) ||
+			FAILED(pConverter->Initialize(pFrame.Get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom)))
+			return false;
+
+		a_diImage.Width = uWidth;
+		a_diImage.Height = uHeight;
+		a_diImage.Pixels.resize(static_cast<size_t>(uWidth) * uHeight * 4);
+		return SUCCEEDED(pConverter->CopyPixels(
+			nullptr,
+			uWidth * 4,
+			static_cast<UINT>(a_diImage.Pixels.size()),
+			a_diImage.Pixels.data()));
+	}
+}
+
+DecodedImage TextureLoader::Decode(const wchar_t* a_sFilepath)
+{
+	// WIC needs COM on whichever thread this ends up running on.
+	HRESULT hrCom = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+	DecodedImage image;
+	if (!DecodeWithWIC(a_sFilepath, image))
+		image = DecodedImage();
+
+	// Only balancing our own initialization, the thread may already have had COM set up.
+	if (SUCCEEDED(hrCom))
+		CoUninitialize();
+	return image;
+}
+
+Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> TextureLoader::CreateShaderResourceView(const DecodedImage& a_diImage)
+{
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pSRV;
+	if (a_diImage.Pixels.empty()) return pSRV;
+
+	// A full mip chain that the GPU fills in from the top level.
+	D3D11_TEXTURE2D_DESC textureDesc = {};
+	textureDesc.Width = a_diImage.Width;
+	textureDesc.Height = a_diImage.Height;
+	textureDesc.MipLevels = 0;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+	textureDesc.MiscFlags = D3D11_RESOURCE_MISC_GENERATE_MIPS;
+
+	Microsoft::WRL::ComPtr<ID3D11Texture2D> pTexture;
+	if (FAILED(Graphics::Device->CreateTexture2D(&textureDesc, nullptr, pTexture.GetAddressOf())))
+		return pSRV;
+
+	Graphics::Context->UpdateSubresource(pTexture.Get(), 0, nullptr, a_diImage.Pixels.data(), a_diImage.Width * 4, 0);
+	Graphics::Device->CreateShaderResourceView(pTexture.Get(), nullptr, pSRV.GetAddressOf());
+	Graphics::Context->GenerateMips(pSRV.Get());
+	return pSRV;
+}
@@ -0,0 +1,40 @@
+#ifndef __TEXTURELOADER_H_
+#define __TEXTURELOADER_H_
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <vector>
+
+/// <summary>
+/// Image decoded into tightly packed RGBA8 pixels, not yet on the GPU.
+/// </summary>
+struct DecodedImage
+{
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	std::vector<unsigned char> Pixels;	// Width * Height * 4 bytes, top row first.
+};
+
+/// <summary>
+/// Texture loading split into a decode step that is safe on any thread and a
+/// create step that needs the device context, so decodes can run on a JobSystem.
+/// </summary>
+namespace TextureLoader
+{
+	/// <summary>
+	/// Reads and decodes an image file with WIC.  Safe to call from any thread.
+	/// </summary>
+	/// <param name="a_sFilepath">Path to the image file.</param>
+	/// <returns>The decoded image, empty if the file could not be read.</returns>
+	DecodedImage Decode(const wchar_t* a_sFilepath);
+
+	/// <summary>
+	/// Uploads a decoded image and generates its mip chain, the same result as
+	/// CreateWICTextureFromFile with a context.  Only call from the device thread.
+	/// </summary>
+	/// <param name="a_diImage">The decoded image.</param>
+	/// <returns>The shader resource view, null if the image is empty.</returns>
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> CreateShaderResourceView(const DecodedImage& a_diImage);
+}
+
+#endif //__TEXTURELOADER_H_
@@ -1,7 +1,11 @@
 #include "Transform.h"
 
+#include <cmath>
+
 using namespace DirectX;
 
+unsigned int Transform::s_uRecalculationCount = 0;
+
 Transform::Transform() :
     m_v3Position(0.0f, 0.0f, 0.0f),
     m_v3Rotation(0.0f, 0.0f, 0.0f),
@@ -99,6 +103,8 @@ void Transform::MoveRelative(float a_fX, float a_fY, float a_fZ)
         &m_v3Position,
         XMLoadFloat3(&m_v3Position) + vResult
     );
+
+    m_bIsDirty = true;
 }
 void Transform::MoveRelative(DirectX::XMFLOAT3 a_v3Offset)
 {
@@ -117,6 +123,8 @@ void Transform::MoveRelative(DirectX::XMFLOAT3 a_v3Offset)
         &m_v3Position,
         XMLoadFloat3(&m_v3Position) + vResult
     );
+
+    m_bIsDirty = true;
 }
 void Transform::Rotate(float a_fP, float a_fY, float a_fR)
 {
@@ -155,22 +163,16 @@ void Transform::Scale(DirectX::XMFLOAT3 a_v3Scale)
     m_bIsDirty = true;
 }
 
-DirectX::XMFLOAT3& Transform::GetPosition()
+const DirectX::XMFLOAT3& Transform::GetPosition() const
 {
-    // Assume that when returning the position that the data will be altered.
-    m_bIsDirty = true;
     return m_v3Position;
 }
-DirectX::XMFLOAT3& Transform::GetRotation()
+const DirectX::XMFLOAT3& Transform::GetRotation() const
 {
-    // Assume that when returning the position that the data will be altered.
-    m_bIsDirty = true;
     return m_v3Rotation;
 }
-DirectX::XMFLOAT3& Transform::GetScale()
+const DirectX::XMFLOAT3& Transform::GetScale() const
 {
-    // Assume that when returning the position that the data will be altered.
-    m_bIsDirty = true;
     return m_v3Scale;
 }
 
@@ -254,6 +256,7 @@ DirectX::XMFLOAT4X4 Transform::GetWorldInverseTransposeMatrix()
 void Transform::CalculateMatrices(void)
 {
     m_bIsDirty = false;
+    s_uRecalculationCount++;
 
     // Calculating matrices based on the rotation/scale/translation vectors.
     XMMATRIX trMatrix = XMMatrixTranslation(m_v3Position.x, m_v3Position.y, m_v3Position.z);
@@ -265,7 +268,33 @@ void Transform::CalculateMatrices(void)
 
     // Storing the product of those matrices in the world matrix.
     XMStoreFloat4x4(&m_m4WorldMatrix, world);
+
+    // A scale this close to zero has no usable inverse, leaving it to the general one.
+    if (HasDegenerateScale(m_v3Scale))
+    {
+        XMStoreFloat4x4(&m_m4WorldInverseTranspose,
+            XMMatrixInverse(0, XMMatrixTranspose(world))
+        );
+        return;
+    }
+
+    // The inverse of S * R * T is T^-1 * R^T * S^-1, and R is orthonormal, so
+    // its transpose is S^-1 * R * (T^-1)^T.  No general inverse needed.
+    XMMATRIX invScMatrix = XMMatrixScaling(1.0f / m_v3Scale.x, 1.0f / m_v3Scale.y, 1.0f / m_v3Scale.z);
+    XMMATRIX invTrMatrix = XMMatrixTranslation(-m_v3Position.x, -m_v3Position.y, -m_v3Position.z);
     XMStoreFloat4x4(&m_m4WorldInverseTranspose,
-        XMMatrixInverse(0, XMMatrixTranspose(world))
+        invScMatrix * roMatrix * XMMatrixTranspose(invTrMatrix)
     );
 }
+
+bool Transform::HasDegenerateScale(DirectX::XMFLOAT3 a_v3Scale)
+{
+    return fabsf(a_v3Scale.x) < MIN_INVERTIBLE_SCALE ||
+        fabsf(a_v3Scale.y) < MIN_INVERTIBLE_SCALE ||
+        fabsf(a_v3Scale.z) < MIN_INVERTIBLE_SCALE;
+}
+
+unsigned int Transform::GetRecalculationCount(void)
+{
+    return s_uRecalculationCount;
+}
@@ -18,7 +18,12 @@ private:
 
 	bool m_bIsDirty;
 
+	static unsigned int s_uRecalculationCount;
+
 public:
+	// Scales smaller than this on any axis use the general inverse for the normal matrix.
+	static constexpr float MIN_INVERTIBLE_SCALE = 1e-6f;
+
 	Transform();
 
 	void SetPosition(float a_fX, float a_fY, float a_fZ);
@@ -42,9 +47,10 @@ public:
 	void Scale(float a_fX, float a_fY, float a_fZ);
 	void Scale(DirectX::XMFLOAT3 a_v3Scale);
 
-	DirectX::XMFLOAT3& GetPosition();
-	DirectX::XMFLOAT3& GetRotation();
-	DirectX::XMFLOAT3& GetScale();
+	// Reading never marks the matrices dirty, changes go through the setters above.
+	const DirectX::XMFLOAT3& GetPosition() const;
+	const DirectX::XMFLOAT3& GetRotation() const;
+	const DirectX::XMFLOAT3& GetScale() const;
 
 	DirectX::XMFLOAT3 GetUp();
 	DirectX::XMFLOAT3 GetRight();
@@ -53,6 +59,17 @@ public:
 	DirectX::XMFLOAT4X4 GetWorldMatrix();
 	DirectX::XMFLOAT4X4 GetWorldInverseTransposeMatrix();
 
+	/// <summary>
+	/// Checks if a scale is too close to zero on any axis to invert directly.
+	/// </summary>
+	static bool HasDegenerateScale(DirectX::XMFLOAT3 a_v3Scale);
+
+	/// <summary>
+	/// Gets how many times any Transform has recomputed its matrices, for
+	/// checking that nothing is recomputed while the scene stands still.
+	/// </summary>
+	static unsigned int GetRecalculationCount(void);
+
 private:
 	void CalculateMatrices(void);
 };
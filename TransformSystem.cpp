@@ -0,0 +1,366 @@
+#include "TransformSystem.h"
+#include "Transform.h"
+
+#include <bit>
+#include <future>
+
+using namespace DirectX;
+
+namespace
+{
+	// Smallest amount of bitset words (64 transforms each) worth handing to a worker.
+	const size_t g_uMinWordsPerJob = 16;
+
+	// Smallest amount of view projection products worth handing to a worker.
+	const unsigned int g_uMinProductsPerJob = 4096;
+
+	XMVECTOR LoadLanes(const std::vector<float>& a_lComponent, unsigned int a_uFirst)
+	{
+		return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(a_lComponent.data() + a_uFirst));
+	}
+
+	/// <summary>
+	/// Writes one row of four matrices, given each element of that row across the four lanes.
+	/// </summary>
+	void StoreRow(XMFLOAT4X4* a_pMatrices, int a_nRow, FXMVECTOR a_v0, FXMVECTOR a_v1, FXMVECTOR a_v2, CXMVECTOR a_v3)
+	{
+		XMMATRIX rows = XMMatrixTranspose(XMMATRIX(a_v0, a_v1, a_v2, a_v3));
+		for (int i = 0; i < 4; i++)
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(a_pMatrices[i].m[a_nRow]), rows.r[i]);
+	}
+}
+
+TransformSystem::TransformSystem() :
+	m_uCount(0),
+	m_uRecalculationCount(0)
+{
+}
+
+unsigned int TransformSystem::Create(void)
+{
+	unsigned int uIndex = m_uCount++;
+
+	// Growing four at a time, padding with identity transforms.
+	if (m_uCount > m_lPositionX.size())
+	{
+		size_t uSize = m_lPositionX.size() + 4;
+		m_lPositionX.resize(uSize, 0.0f);
+		m_lPositionY.resize(uSize, 0.0f);
+		m_lPositionZ.resize(uSize, 0.0f);
+		m_lRotationX.resize(uSize, 0.0f);
+		m_lRotationY.resize(uSize, 0.0f);
+		m_lRotationZ.resize(uSize, 0.0f);
+		m_lScaleX.resize(uSize, 1.0f);
+		m_lScaleY.resize(uSize, 1.0f);
+		m_lScaleZ.resize(uSize, 1.0f);
+
+		XMFLOAT4X4 m4Identity;
+		XMStoreFloat4x4(&m4Identity, XMMatrixIdentity());
+		m_lWorldMatrices.resize(uSize, m4Identity);
+		m_lWorldInverseTransposes.resize(uSize, m4Identity);
+		m_lWorldViewProjections.resize(uSize, m4Identity);
+		m_lWorldLightViewProjections.resize(uSize, m4Identity);
+
+		m_lDirty.resize((uSize + 63) / 64, 0);
+	}
+
+	return uIndex;
+}
+
+unsigned int TransformSystem::GetCount(void) const
+{
+	return m_uCount;
+}
+
+unsigned int TransformSystem::GetDirtyCount(void) const
+{
+	unsigned int uDirty = 0;
+	for (uint64_t uWord : m_lDirty)
+		uDirty += std::popcount(uWord);
+	return uDirty;
+}
+
+unsigned int TransformSystem::GetRecalculationCount(void) const
+{
+	return m_uRecalculationCount;
+}
+
+void TransformSystem::SetPosition(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Position)
+{
+	m_lPositionX[a_uIndex] = a_v3Position.x;
+	m_lPositionY[a_uIndex] = a_v3Position.y;
+	m_lPositionZ[a_uIndex] = a_v3Position.z;
+	MarkDirty(a_uIndex);
+}
+void TransformSystem::SetRotation(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Rotation)
+{
+	m_lRotationX[a_uIndex] = a_v3Rotation.x;
+	m_lRotationY[a_uIndex] = a_v3Rotation.y;
+	m_lRotationZ[a_uIndex] = a_v3Rotation.z;
+	MarkDirty(a_uIndex);
+}
+void TransformSystem::SetScale(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Scale)
+{
+	m_lScaleX[a_uIndex] = a_v3Scale.x;
+	m_lScaleY[a_uIndex] = a_v3Scale.y;
+	m_lScaleZ[a_uIndex] = a_v3Scale.z;
+	MarkDirty(a_uIndex);
+}
+
+void TransformSystem::MoveAbsolute(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Offset)
+{
+	m_lPositionX[a_uIndex] += a_v3Offset.x;
+	m_lPositionY[a_uIndex] += a_v3Offset.y;
+	m_lPositionZ[a_uIndex] += a_v3Offset.z;
+	MarkDirty(a_uIndex);
+}
+void TransformSystem::Rotate(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Rotation)
+{
+	m_lRotationX[a_uIndex] += a_v3Rotation.x;
+	m_lRotationY[a_uIndex] += a_v3Rotation.y;
+	m_lRotationZ[a_uIndex] += a_v3Rotation.z;
+	MarkDirty(a_uIndex);
+}
+void TransformSystem::Scale(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Scale)
+{
+	m_lScaleX[a_uIndex] *= a_v3Scale.x;
+	m_lScaleY[a_uIndex] *= a_v3Scale.y;
+	m_lScaleZ[a_uIndex] *= a_v3Scale.z;
+	MarkDirty(a_uIndex);
+}
+
+DirectX::XMFLOAT3 TransformSystem::GetPosition(unsigned int a_uIndex) const
+{
+	return XMFLOAT3(m_lPositionX[a_uIndex], m_lPositionY[a_uIndex], m_lPositionZ[a_uIndex]);
+}
+DirectX::XMFLOAT3 TransformSystem::GetRotation(unsigned int a_uIndex) const
+{
+	return XMFLOAT3(m_lRotationX[a_uIndex], m_lRotationY[a_uIndex], m_lRotationZ[a_uIndex]);
+}
+DirectX::XMFLOAT3 TransformSystem::GetScale(unsigned int a_uIndex) const
+{
+	return XMFLOAT3(m_lScaleX[a_uIndex], m_lScaleY[a_uIndex], m_lScaleZ[a_uIndex]);
+}
+
+const DirectX::XMFLOAT4X4& TransformSystem::GetWorldMatrix(unsigned int a_uIndex)
+{
+	if (IsDirty(a_uIndex)) m_uRecalculationCount += UpdateRange(a_uIndex / 64, a_uIndex / 64 + 1);
+	return m_lWorldMatrices[a_uIndex];
+}
+const DirectX::XMFLOAT4X4& TransformSystem::GetWorldInverseTransposeMatrix(unsigned int a_uIndex)
+{
+	if (IsDirty(a_uIndex)) m_uRecalculationCount += UpdateRange(a_uIndex / 64, a_uIndex / 64 + 1);
+	return m_lWorldInverseTransposes[a_uIndex];
+}
+
+void TransformSystem::Update(JobSystem* a_pJobs)
+{
+	size_t uWordCount = m_lDirty.size();
+	unsigned int uThreads = a_pJobs != nullptr ? a_pJobs->GetThreadCount() : 0;
+	size_t uJobs = uWordCount / g_uMinWordsPerJob;
+	if (uThreads < uJobs) uJobs = uThreads;
+
+	if (uJobs <= 1)
+	{
+		m_uRecalculationCount += UpdateRange(0, uWordCount);
+		return;
+	}
+
+	// Every job gets its own whole words of the bitset, so no two touch the same transform.
+	std::vector<std::future<unsigned int>> jobs;
+	jobs.reserve(uJobs);
+	size_t uPerJob = (uWordCount + uJobs - 1) / uJobs;
+	for (size_t uFirst = 0; uFirst < uWordCount; uFirst += uPerJob)
+	{
+		size_t uLast = uFirst + uPerJob < uWordCount ? uFirst + uPerJob : uWordCount;
+		jobs.push_back(a_pJobs->Submit([this, uFirst, uLast]() { return UpdateRange(uFirst, uLast); }));
+	}
+
+	for (std::future<unsigned int>& job : jobs)
+		m_uRecalculationCount += job.get();
+}
+
+void TransformSystem::CalculateViewProjections(
+	const DirectX::XMFLOAT4X4& a_m4ViewProjection,
+	const DirectX::XMFLOAT4X4& a_m4LightViewProjection,
+	JobSystem* a_pJobs)
+{
+	XMMATRIX viewProjection = XMLoadFloat4x4(&a_m4ViewProjection);
+	XMMATRIX lightViewProjection = XMLoadFloat4x4(&a_m4LightViewProjection);
+
+	unsigned int uThreads = a_pJobs != nullptr ? a_pJobs->GetThreadCount() : 0;
+	unsigned int uJobs = m_uCount / g_uMinProductsPerJob;
+	if (uThreads < uJobs) uJobs = uThreads;
+
+	if (uJobs <= 1)
+	{
+		CalculateViewProjectionRange(0, m_uCount, viewProjection, lightViewProjection);
+		return;
+	}
+
+	std::vector<std::future<void>> jobs;
+	jobs.reserve(uJobs);
+	unsigned int uPerJob = (m_uCount + uJobs - 1) / uJobs;
+	for (unsigned int uFirst = 0; uFirst < m_uCount; uFirst += uPerJob)
+	{
+		unsigned int uLast = uFirst + uPerJob < m_uCount ? uFirst + uPerJob : m_uCount;
+		jobs.push_back(a_pJobs->Submit([this, uFirst, uLast, viewProjection, lightViewProjection]()
+		{
+			CalculateViewProjectionRange(uFirst, uLast, viewProjection, lightViewProjection);
+		}));
+	}
+
+	for (std::future<void>& job : jobs)
+		job.get();
+}
+
+const DirectX::XMFLOAT4X4& TransformSystem::GetWorldViewProjectionMatrix(unsigned int a_uIndex) const
+{
+	return m_lWorldViewProjections[a_uIndex];
+}
+const DirectX::XMFLOAT4X4& TransformSystem::GetWorldLightViewProjectionMatrix(unsigned int a_uIndex) const
+{
+	return m_lWorldLightViewProjections[a_uIndex];
+}
+
+void TransformSystem::MarkDirty(unsigned int a_uIndex)
+{
+	m_lDirty[a_uIndex / 64] |= uint64_t(1) << (a_uIndex % 64);
+}
+
+bool TransformSystem::IsDirty(unsigned int a_uIndex) const
+{
+	return (m_lDirty[a_uIndex / 64] >> (a_uIndex % 64)) & 1;
+}
+
+unsigned int TransformSystem::UpdateRange(size_t a_uFirstWord, size_t a_uLastWord)
+{
+	unsigned int uRecalculated = 0;
+	for (size_t w = a_uFirstWord; w < a_uLastWord; w++)
+	{
+		uint64_t uDirty = m_lDirty[w];
+		if (uDirty == 0) continue;
+		uRecalculated += std::popcount(uDirty);
+
+		// Recomputing any group of four with at least one dirty transform,
+		// the clean ones in it come out the same as before.
+		for (unsigned int uGroup = 0; uGroup < 64; uGroup += 4)
+		{
+			if ((uDirty >> uGroup) & 0xF)
+				CalculateBatch(static_cast<unsigned int>(w * 64) + uGroup);
+		}
+		m_lDirty[w] = 0;
+	}
+	return uRecalculated;
+}
+
+void TransformSystem::CalculateBatch(unsigned int a_uFirst)
+{
+	XMVECTOR vSinP, vCosP, vSinY, vCosY, vSinR, vCosR;
+	XMVectorSinCos(&vSinP, &vCosP, LoadLanes(m_lRotationX, a_uFirst));
+	XMVectorSinCos(&vSinY, &vCosY, LoadLanes(m_lRotationY, a_uFirst));
+	XMVectorSinCos(&vSinR, &vCosR, LoadLanes(m_lRotationZ, a_uFirst));
+
+	// The rows of XMMatrixRotationRollPitchYaw, one element per vector.
+	XMVECTOR vSinRSinP = XMVectorMultiply(vSinR, vSinP);
+	XMVECTOR vCosRSinP = XMVectorMultiply(vCosR, vSinP);
+	XMVECTOR vR00 = XMVectorAdd(XMVectorMultiply(vCosR, vCosY), XMVectorMultiply(vSinRSinP, vSinY));
+	XMVECTOR vR01 = XMVectorMultiply(vSinR, vCosP);
+	XMVECTOR vR02 = XMVectorSubtract(XMVectorMultiply(vSinRSinP, vCosY), XMVectorMultiply(vCosR, vSinY));
+	XMVECTOR vR10 = XMVectorSubtract(XMVectorMultiply(vCosRSinP, vSinY), XMVectorMultiply(vSinR, vCosY));
+	XMVECTOR vR11 = XMVectorMultiply(vCosR, vCosP);
+	XMVECTOR vR12 = XMVectorAdd(XMVectorMultiply(vSinR, vSinY), XMVectorMultiply(vCosRSinP, vCosY));
+	XMVECTOR vR20 = XMVectorMultiply(vCosP, vSinY);
+	XMVECTOR vR21 = XMVectorNegate(vSinP);
+	XMVECTOR vR22 = XMVectorMultiply(vCosP, vCosY);
+
+	XMVECTOR vScaleX = LoadLanes(m_lScaleX, a_uFirst);
+	XMVECTOR vScaleY = LoadLanes(m_lScaleY, a_uFirst);
+	XMVECTOR vScaleZ = LoadLanes(m_lScaleZ, a_uFirst);
+	XMVECTOR vPositionX = LoadLanes(m_lPositionX, a_uFirst);
+	XMVECTOR vPositionY = LoadLanes(m_lPositionY, a_uFirst);
+	XMVECTOR vPositionZ = LoadLanes(m_lPositionZ, a_uFirst);
+	XMVECTOR vZero = XMVectorZero();
+	XMVECTOR vOne = XMVectorSplatOne();
+
+	// World = scale * rotation * translation, so each rotation row is scaled by its axis.
+	XMFLOAT4X4* pWorld = m_lWorldMatrices.data() + a_uFirst;
+	StoreRow(pWorld, 0, XMVectorMultiply(vR00, vScaleX), XMVectorMultiply(vR01, vScaleX), XMVectorMultiply(vR02, vScaleX), vZero);
+	StoreRow(pWorld, 1, XMVectorMultiply(vR10, vScaleY), XMVectorMultiply(vR11, vScaleY), XMVectorMultiply(vR12, vScaleY), vZero);
+	StoreRow(pWorld, 2, XMVectorMultiply(vR20, vScaleZ), XMVectorMultiply(vR21, vScaleZ), XMVectorMultiply(vR22, vScaleZ), vZero);
+	StoreRow(pWorld, 3, vPositionX, vPositionY, vPositionZ, vOne);
+
+	// The rotation is orthonormal, so the inverse transpose of scale * rotation is
+	// the rotation rows divided by the scale instead, with no general inverse.  The
+	// last column is the translation undone through that, as XMMatrixInverse gives.
+	XMVECTOR vInvScaleX = XMVectorReciprocal(vScaleX);
+	XMVECTOR vInvScaleY = XMVectorReciprocal(vScaleY);
+	XMVECTOR vInvScaleZ = XMVectorReciprocal(vScaleZ);
+	XMVECTOR vMove0 = XMVectorAdd(XMVectorAdd(XMVectorMultiply(vPositionX, vR00), XMVectorMultiply(vPositionY, vR01)), XMVectorMultiply(vPositionZ, vR02));
+	XMVECTOR vMove1 = XMVectorAdd(XMVectorAdd(XMVectorMultiply(vPositionX, vR10), XMVectorMultiply(vPositionY, vR11)), XMVectorMultiply(vPositionZ, vR12));
+	XMVECTOR vMove2 = XMVectorAdd(XMVectorAdd(XMVectorMultiply(vPositionX, vR20), XMVectorMultiply(vPositionY, vR21)), XMVectorMultiply(vPositionZ, vR22));
+
+	XMFLOAT4X4* pInverseTranspose = m_lWorldInverseTransposes.data() + a_uFirst;
+	StoreRow(pInverseTranspose, 0, XMVectorMultiply(vR00, vInvScaleX), XMVectorMultiply(vR01, vInvScaleX), XMVectorMultiply(vR02, vInvScaleX), XMVectorNegate(XMVectorMultiply(vMove0, vInvScaleX)));
+	StoreRow(pInverseTranspose, 1, XMVectorMultiply(vR10, vInvScaleY), XMVectorMultiply(vR11, vInvScaleY), XMVectorMultiply(vR12, vInvScaleY), XMVectorNegate(XMVectorMultiply(vMove1, vInvScaleY)));
+	StoreRow(pInverseTranspose, 2, XMVectorMultiply(vR20, vInvScaleZ), XMVectorMultiply(vR21, vInvScaleZ), XMVectorMultiply(vR22, vInvScaleZ), XMVectorNegate(XMVectorMultiply(vMove2, vInvScaleZ)));
+	StoreRow(pInverseTranspose, 3, vZero, vZero, vZero, vOne);
+
+	// Same fallback as Transform for scales too close to zero to divide by.
+	for (unsigned int i = 0; i < 4; i++)
+	{
+		if (!Transform::HasDegenerateScale(GetScale(a_uFirst + i))) continue;
+		XMStoreFloat4x4(&pInverseTranspose[i],
+			XMMatrixInverse(nullptr, XMMatrixTranspose(XMLoadFloat4x4(&pWorld[i]))));
+	}
+}
+
+void TransformSystem::CalculateViewProjectionRange(unsigned int a_uFirst, unsigned int a_uLast, DirectX::FXMMATRIX a_mViewProjection, DirectX::CXMMATRIX a_mLightViewProjection)
+{
+	// Both products share the loaded world matrix, and the arrays are walked front to back.
+	for (unsigned int i = a_uFirst; i < a_uLast; i++)
+	{
+		XMMATRIX world = XMLoadFloat4x4(&m_lWorldMatrices[i]);
+		XMStoreFloat4x4(&m_lWorldViewProjections[i], XMMatrixMultiply(world, a_mViewProjection));
+		XMStoreFloat4x4(&m_lWorldLightViewProjections[i], XMMatrixMultiply(world, a_mLightViewProjection));
+	}
+}
+
+TransformHandle::TransformHandle() :
+	m_pSystem(nullptr),
+	m_uIndex(0)
+{
+}
+
+TransformHandle::TransformHandle(TransformSystem* a_pSystem, unsigned int a_uIndex) :
+	m_pSystem(a_pSystem),
+	m_uIndex(a_uIndex)
+{
+}
+
+void TransformHandle::SetPosition(float a_fX, float a_fY, float a_fZ) { m_pSystem->SetPosition(m_uIndex, XMFLOAT3(a_fX, a_fY, a_fZ)); }
+void TransformHandle::SetPosition(DirectX::XMFLOAT3 a_v3Position) { m_pSystem->SetPosition(m_uIndex, a_v3Position); }
+
+void TransformHandle::SetRotation(float a_fP, float a_fY, float a_fR) { m_pSystem->SetRotation(m_uIndex, XMFLOAT3(a_fP, a_fY, a_fR)); }
+void TransformHandle::SetRotation(DirectX::XMFLOAT3 a_v3Rotation) { m_pSystem->SetRotation(m_uIndex, a_v3Rotation); }
+
+void TransformHandle::SetScale(float a_fX, float a_fY, float a_fZ) { m_pSystem->SetScale(m_uIndex, XMFLOAT3(a_fX, a_fY, a_fZ)); }
+void TransformHandle::SetScale(DirectX::XMFLOAT3 a_v3Scale) { m_pSystem->SetScale(m_uIndex, a_v3Scale); }
+
+void TransformHandle::MoveAbsolute(float a_fX, float a_fY, float a_fZ) { m_pSystem->MoveAbsolute(m_uIndex, XMFLOAT3(a_fX, a_fY, a_fZ)); }
+void TransformHandle::MoveAbsolute(DirectX::XMFLOAT3 a_v3Offset) { m_pSystem->MoveAbsolute(m_uIndex, a_v3Offset); }
+
+void TransformHandle::Rotate(float a_fP, float a_fY, float a_fR) { m_pSystem->Rotate(m_uIndex, XMFLOAT3(a_fP, a_fY, a_fR)); }
+void TransformHandle::Rotate(DirectX::XMFLOAT3 a_v3Rotation) { m_pSystem->Rotate(m_uIndex, a_v3Rotation); }
+
+void TransformHandle::Scale(float a_fX, float a_fY, float a_fZ) { m_pSystem->Scale(m_uIndex, XMFLOAT3(a_fX, a_fY, a_fZ)); }
+void TransformHandle::Scale(DirectX::XMFLOAT3 a_v3Scale) { m_pSystem->Scale(m_uIndex, a_v3Scale); }
+
+DirectX::XMFLOAT3 TransformHandle::GetPosition() const { return m_pSystem->GetPosition(m_uIndex); }
+DirectX::XMFLOAT3 TransformHandle::GetRotation() const { return m_pSystem->GetRotation(m_uIndex); }
+DirectX::XMFLOAT3 TransformHandle::GetScale() const { return m_pSystem->GetScale(m_uIndex); }
+
+DirectX::XMFLOAT4X4 TransformHandle::GetWorldMatrix() { return m_pSystem->GetWorldMatrix(m_uIndex); }
+DirectX::XMFLOAT4X4 TransformHandle::GetWorldInverseTransposeMatrix() { return m_pSystem->GetWorldInverseTransposeMatrix(m_uIndex); }
+DirectX::XMFLOAT4X4 TransformHandle::GetWorldViewProjectionMatrix() const { return m_pSystem->GetWorldViewProjectionMatrix(m_uIndex); }
+DirectX::XMFLOAT4X4 TransformHandle::GetWorldLightViewProjectionMatrix() const { return m_pSystem->GetWorldLightViewProjectionMatrix(m_uIndex); }
@@ -0,0 +1,175 @@
+#ifndef __TRANSFORMSYSTEM_H_
+#define __TRANSFORMSYSTEM_H_
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "JobSystem.h"
+
+/// <summary>
+/// Stores the positions, rotations and scales of many objects as separate
+/// arrays (structure of arrays) and recomputes the world and inverse transpose
+/// matrices of every dirty object in one batch, four objects per SIMD register.
+/// Gives the same matrices as Transform, which stays the per-object path.
+/// </summary>
+class TransformSystem
+{
+private:
+	// One array per component, padded to a multiple of 4 so batches never run off the end.
+	std::vector<float> m_lPositionX, m_lPositionY, m_lPositionZ;
+	std::vector<float> m_lRotationX, m_lRotationY, m_lRotationZ;
+	std::vector<float> m_lScaleX, m_lScaleY, m_lScaleZ;
+
+	std::vector<DirectX::XMFLOAT4X4> m_lWorldMatrices;
+	std::vector<DirectX::XMFLOAT4X4> m_lWorldInverseTransposes;
+
+	// World * view * projection for the camera and the shadow casting light, rebuilt every frame.
+	std::vector<DirectX::XMFLOAT4X4> m_lWorldViewProjections;
+	std::vector<DirectX::XMFLOAT4X4> m_lWorldLightViewProjections;
+
+	// One bit per transform, set whenever its position, rotation or scale changes.
+	std::vector<uint64_t> m_lDirty;
+
+	unsigned int m_uCount;
+	unsigned int m_uRecalculationCount;
+
+public:
+	TransformSystem();
+
+	/// <summary>
+	/// Adds a transform at the origin with no rotation and a scale of 1.
+	/// </summary>
+	/// <returns>The index of the new transform.</returns>
+	unsigned int Create(void);
+
+	/// <summary>
+	/// Gets the amount of transforms.
+	/// </summary>
+	unsigned int GetCount(void) const;
+
+	/// <summary>
+	/// Gets the amount of transforms waiting on Update().
+	/// </summary>
+	unsigned int GetDirtyCount(void) const;
+
+	/// <summary>
+	/// Gets how many dirty transforms have had their matrices recomputed so far.
+	/// </summary>
+	unsigned int GetRecalculationCount(void) const;
+
+	void SetPosition(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Position);
+	void SetRotation(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Rotation);
+	void SetScale(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Scale);
+
+	void MoveAbsolute(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Offset);
+	void Rotate(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Rotation);
+	void Scale(unsigned int a_uIndex, DirectX::XMFLOAT3 a_v3Scale);
+
+	DirectX::XMFLOAT3 GetPosition(unsigned int a_uIndex) const;
+	DirectX::XMFLOAT3 GetRotation(unsigned int a_uIndex) const;
+	DirectX::XMFLOAT3 GetScale(unsigned int a_uIndex) const;
+
+	/// <summary>
+	/// Gets the world matrix, computing just this one if it is still dirty.
+	/// </summary>
+	const DirectX::XMFLOAT4X4& GetWorldMatrix(unsigned int a_uIndex);
+
+	/// <summary>
+	/// Gets the inverse transpose of the world matrix, computing just this one if it is still dirty.
+	/// </summary>
+	const DirectX::XMFLOAT4X4& GetWorldInverseTransposeMatrix(unsigned int a_uIndex);
+
+	/// <summary>
+	/// Recomputes the matrices of every dirty transform.  Call once per frame
+	/// after everything has moved and before anything is drawn.
+	/// </summary>
+	/// <param name="a_pJobs">Splits the work across these workers if given, otherwise it all runs on the calling thread.</param>
+	void Update(JobSystem* a_pJobs = nullptr);
+
+	/// <summary>
+	/// Multiplies every world matrix by the camera's and the light's view
+	/// projection, so the vertex shaders only transform vertices.  Call every
+	/// frame after Update(), the camera moves even when nothing else does.
+	/// </summary>
+	/// <param name="a_m4ViewProjection">The camera's view * projection.</param>
+	/// <param name="a_m4LightViewProjection">The shadow casting light's view * projection.</param>
+	/// <param name="a_pJobs">Splits the work across these workers if given, otherwise it all runs on the calling thread.</param>
+	void CalculateViewProjections(
+		const DirectX::XMFLOAT4X4& a_m4ViewProjection,
+		const DirectX::XMFLOAT4X4& a_m4LightViewProjection,
+		JobSystem* a_pJobs = nullptr);
+
+	/// <summary>
+	/// Gets world * view * projection from the last CalculateViewProjections().
+	/// </summary>
+	const DirectX::XMFLOAT4X4& GetWorldViewProjectionMatrix(unsigned int a_uIndex) const;
+
+	/// <summary>
+	/// Gets world * light view * light projection from the last CalculateViewProjections().
+	/// </summary>
+	const DirectX::XMFLOAT4X4& GetWorldLightViewProjectionMatrix(unsigned int a_uIndex) const;
+
+private:
+	void MarkDirty(unsigned int a_uIndex);
+	bool IsDirty(unsigned int a_uIndex) const;
+
+	/// <summary>
+	/// Recomputes the dirty transforms covered by a range of words in the dirty bitset.
+	/// </summary>
+	/// <returns>How many dirty transforms were recomputed.</returns>
+	unsigned int UpdateRange(size_t a_uFirstWord, size_t a_uLastWord);
+
+	/// <summary>
+	/// Computes the matrices of the four transforms starting at a_uFirst, one per SIMD lane.
+	/// </summary>
+	void CalculateBatch(unsigned int a_uFirst);
+
+	/// <summary>
+	/// Multiplies the world matrices in [a_uFirst, a_uLast) by both view projections.
+	/// </summary>
+	void CalculateViewProjectionRange(unsigned int a_uFirst, unsigned int a_uLast, DirectX::FXMMATRIX a_mViewProjection, DirectX::CXMMATRIX a_mLightViewProjection);
+};
+
+/// <summary>
+/// Refers to one transform in a TransformSystem.  Cheap to copy, every copy
+/// refers to the same transform.
+/// </summary>
+class TransformHandle
+{
+private:
+	TransformSystem* m_pSystem;
+	unsigned int m_uIndex;
+
+public:
+	TransformHandle();
+	TransformHandle(TransformSystem* a_pSystem, unsigned int a_uIndex);
+
+	void SetPosition(float a_fX, float a_fY, float a_fZ);
+	void SetPosition(DirectX::XMFLOAT3 a_v3Position);
+
+	void SetRotation(float a_fP, float a_fY, float a_fR);
+	void SetRotation(DirectX::XMFLOAT3 a_v3Rotation);
+
+	void SetScale(float a_fX, float a_fY, float a_fZ);
+	void SetScale(DirectX::XMFLOAT3 a_v3Scale);
+
+	void MoveAbsolute(float a_fX, float a_fY, float a_fZ);
+	void MoveAbsolute(DirectX::XMFLOAT3 a_v3Offset);
+
+	void Rotate(float a_fP, float a_fY, float a_fR);
+	void Rotate(DirectX::XMFLOAT3 a_v3Rotation);
+
+	void Scale(float a_fX, float a_fY, float a_fZ);
+	void Scale(DirectX::XMFLOAT3 a_v3Scale);
+
+	DirectX::XMFLOAT3 GetPosition() const;
+	DirectX::XMFLOAT3 GetRotation() const;
+	DirectX::XMFLOAT3 GetScale() const;
+
+	DirectX::XMFLOAT4X4 GetWorldMatrix();
+	DirectX::XMFLOAT4X4 GetWorldInverseTransposeMatrix();
+	DirectX::XMFLOAT4X4 GetWorldViewProjectionMatrix() const;
+	DirectX::XMFLOAT4X4 GetWorldLightViewProjectionMatrix() const;
+};
+
+#endif //__TRANSFORMSYSTEM_H_
@@ -0,0 +1,141 @@
+#include "UploadRing.h"
+
+#include <cstring>
+
+UploadRing::UploadRing() :
+	m_uBindFlags(0),
+	m_uEpoch(1),
+	m_bDiscardNext(true),
+	m_ursStats(),
+	m_ursLastFrame()
+{
+}
+
+bool UploadRing::Initialize(ID3D11Device* a_pDevice, ID3D11DeviceContext* a_pContext, UINT a_uCapacity, UINT a_uBindFlags)
+{
+	m_pDevice = a_pDevice;
+	m_pContext = a_pContext;
+	m_uBindFlags = a_uBindFlags;
+	return Grow(a_uCapacity);
+}
+
+bool UploadRing::IsValid(void) const { return m_pBuffer != nullptr; }
+
+bool UploadRing::Grow(UINT a_uCapacity)
+{
+	D3D11_BUFFER_DESC bd = {};
+	bd.Usage = D3D11_USAGE_DYNAMIC;
+	bd.ByteWidth = (a_uCapacity + 255) & ~255u;		// Keeps 256 byte constant buffer offsets inside the buffer.
+	bd.BindFlags = m_uBindFlags;
+	bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> pBuffer;
+	if (FAILED(m_pDevice->CreateBuffer(&bd, nullptr, pBuffer.GetAddressOf()))) return false;
+
+	if (m_pBuffer)
+	{
+		m_lOutgrown.push_back(m_pBuffer);
+		m_ursStats.Growths++;
+	}
+	m_pBuffer = pBuffer;
+	m_raRanges.Reset(bd.ByteWidth);
+	for (auto& pFence : m_lFences) m_lFreeFences.push_back(pFence);
+	m_lFences.clear();
+	m_uEpoch++;
+	m_bDiscardNext = true;
+	m_ursStats.Capacity = bd.ByteWidth;
+	return true;
+}
+
+void UploadRing::RetireFinishedFrames(void)
+{
+	while (!m_lFences.empty() && m_pContext->GetData(m_lFences.front().Get(), nullptr, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK)
+	{
+		m_raRanges.RetireFrame();
+		m_lFreeFences.push_back(m_lFences.front());
+		m_lFences.pop_front();
+	}
+}
+
+void UploadRing::BeginFrame(void)
+{
+	m_ursLastFrame = m_ursStats;
+	m_ursStats.Allocations = 0;
+	m_ursStats.Bytes = 0;
+	m_uEpoch++;
+	m_lOutgrown.clear();
+	if (IsValid()) RetireFinishedFrames();
+}
+
+void UploadRing::EndFrame(void)
+{
+	if (!IsValid()) return;
+
+	Microsoft::WRL::ComPtr<ID3D11Query> pFence;
+	if (!m_lFreeFences.empty())
+	{
+		pFence = m_lFreeFences.back();
+		m_lFreeFences.pop_back();
+	}
+	else
+	{
+		D3D11_QUERY_DESC qd = {};
+		qd.Query = D3D11_QUERY_EVENT;
+		if (FAILED(m_pDevice->CreateQuery(&qd, pFence.GetAddressOf())))
+		{
+			// Without a fence nothing can tell when this frame's space is free, so it never is.
+			m_raRanges.EndFrame();
+			return;
+		}
+	}
+	m_pContext->End(pFence.Get());
+	m_lFences.push_back(pFence);
+	m_raRanges.EndFrame();
+}
+
+void* UploadRing::Map(UINT a_uSize, UINT a_uAlignment, UploadAllocation& a_uaAllocation)
+{
+	if (!IsValid()) return nullptr;
+
+	size_t uOffset = m_raRanges.Allocate(a_uSize, a_uAlignment);
+	if (uOffset == RingAllocator::NPOS)
+	{
+		RetireFinishedFrames();
+		uOffset = m_raRanges.Allocate(a_uSize, a_uAlignment);
+	}
+	if (uOffset == RingAllocator::NPOS)
+	{
+		UINT uCapacity = static_cast<UINT>(m_raRanges.GetCapacity()) * 2;
+		while (uCapacity < a_uSize * 2) uCapacity *= 2;
+		if (!Grow(uCapacity)) return nullptr;
+		uOffset = m_raRanges.Allocate(a_uSize, a_uAlignment);
+	}
+
+	// No-overwrite promises the range being written is not one the GPU may still read.
+	D3D11_MAPPED_SUBRESOURCE msr = {};
+	if (FAILED(m_pContext->Map(m_pBuffer.Get(), 0, m_bDiscardNext ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &msr)))
+		return nullptr;
+	m_bDiscardNext = false;
+
+	m_ursStats.Allocations++;
+	m_ursStats.Bytes += a_uSize;
+	a_uaAllocation.Buffer = m_pBuffer.Get();
+	a_uaAllocation.Offset = static_cast<UINT>(uOffset);
+	return static_cast<unsigned char*>(msr.pData) + uOffset;
+}
+
+void UploadRing::Unmap(void)
+{
+	m_pContext->Unmap(m_pBuffer.Get(), 0);
+}
+
+bool UploadRing::Write(const void* a_pData, UINT a_uSize, UINT a_uAlignment, UploadAllocation& a_uaAllocation)
+{
+	void* pDest = Map(a_uSize, a_uAlignment, a_uaAllocation);
+	if (pDest == nullptr) return false;
+	memcpy(pDest, a_pData, a_uSize);
+	Unmap();
+	return true;
+}
+
+unsigned int UploadRing::GetEpoch(void) const { return m_uEpoch; }
+const UploadRingStats& UploadRing::GetLastFrameStats(void) const { return m_ursLastFrame; }
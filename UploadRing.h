@@ -0,0 +1,114 @@
+#ifndef __UPLOADRING_H_
+#define __UPLOADRING_H_
+
+#include <d3d11.h>
+#include <deque>
+#include <vector>
+#include <wrl/client.h>
+#include "RingAllocator.h"
+
+/// <summary>
+/// Where a write to an upload ring landed.
+/// </summary>
+struct UploadAllocation
+{
+	ID3D11Buffer* Buffer;				// Only good until the next BeginFrame().
+	UINT Offset;						// In bytes.
+};
+
+/// <summary>
+/// What an upload ring took over a frame.
+/// </summary>
+struct UploadRingStats
+{
+	unsigned int Allocations;
+	unsigned int Bytes;					// Requested, without alignment.
+	unsigned int Growths;				// Since the ring was created.
+	unsigned int Capacity;
+};
+
+/// <summary>
+/// One large dynamic buffer that per draw data is written into back to back,
+/// mapped with no-overwrite so the GPU keeps reading what earlier draws were
+/// given.  A query marks the end of each frame, and a frame's space is reused
+/// once the GPU has passed it.  When a frame needs more room than the GPU has
+/// given back, the ring moves to a buffer twice the size rather than wait.
+/// </summary>
+class UploadRing
+{
+private:
+	Microsoft::WRL::ComPtr<ID3D11Device> m_pDevice;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> m_pContext;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> m_pBuffer;
+	std::vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> m_lOutgrown;		// Still handed out this frame.
+	UINT m_uBindFlags;
+	RingAllocator m_raRanges;
+	std::deque<Microsoft::WRL::ComPtr<ID3D11Query>> m_lFences;		// One per submitted frame, oldest first.
+	std::vector<Microsoft::WRL::ComPtr<ID3D11Query>> m_lFreeFences;
+	unsigned int m_uEpoch;
+	bool m_bDiscardNext;				// A new buffer has to be mapped with discard first.
+	UploadRingStats m_ursStats;
+	UploadRingStats m_ursLastFrame;
+
+	/// <summary>
+	/// Retires every frame the GPU is done with, without waiting.
+	/// </summary>
+	void RetireFinishedFrames(void);
+
+	/// <summary>
+	/// Moves to a new buffer of at least this size.  The old one is kept until the frame
+	/// ends, after which the runtime holds it for as long as the GPU needs it.
+	/// </summary>
+	bool Grow(UINT a_uCapacity);
+
+public:
+	UploadRing();
+
+	/// <summary>
+	/// Creates the buffer.
+	/// </summary>
+	/// <param name="a_uCapacity">The starting size in bytes.</param>
+	/// <param name="a_uBindFlags">How the buffer gets bound, constant buffers can't be bound any other way.</param>
+	/// <returns>False if the buffer couldn't be created.</returns>
+	bool Initialize(ID3D11Device* a_pDevice, ID3D11DeviceContext* a_pContext, UINT a_uCapacity, UINT a_uBindFlags);
+
+	bool IsValid(void) const;
+
+	/// <summary>
+	/// Gives back the space of frames the GPU has finished, lets go of outgrown
+	/// buffers, and starts a new epoch.
+	/// </summary>
+	void BeginFrame(void);
+
+	/// <summary>
+	/// Marks the end of the frame's writes on the GPU.
+	/// </summary>
+	void EndFrame(void);
+
+	/// <summary>
+	/// Takes space for this frame and maps it, to be followed by Unmap().
+	/// </summary>
+	/// <param name="a_uSize">Bytes needed.</param>
+	/// <param name="a_uAlignment">What the offset has to be a multiple of, a power of two.</param>
+	/// <param name="a_uaAllocation">Receives where the space is.</param>
+	/// <returns>Where to write, or null if mapping failed.</returns>
+	void* Map(UINT a_uSize, UINT a_uAlignment, UploadAllocation& a_uaAllocation);
+
+	void Unmap(void);
+
+	/// <summary>
+	/// Copies data into this frame's space.
+	/// </summary>
+	/// <returns>False if mapping failed.</returns>
+	bool Write(const void* a_pData, UINT a_uSize, UINT a_uAlignment, UploadAllocation& a_uaAllocation);
+
+	/// <summary>
+	/// Changes every frame and whenever the buffer grows.  Writes from an
+	/// earlier epoch may be overwritten by now, or in a buffer about to be released.
+	/// </summary>
+	unsigned int GetEpoch(void) const;
+
+	const UploadRingStats& GetLastFrameStats(void) const;
+};
+
+#endif //__UPLOADRING_H_
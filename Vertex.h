@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <DirectXMath.h>
 
 // --------------------------------------------------------
@@ -12,5 +13,18 @@ struct Vertex
 	DirectX::XMFLOAT3 Position;	    // The local position of the vertex
 	DirectX::XMFLOAT3 Normal;
 	DirectX::XMFLOAT2 UV;
-	DirectX::XMFLOAT3 Tangent;
-};
\ No newline at end of file
+	DirectX::XMFLOAT4 Tangent;	    // w is the handedness of the uv mapping, +1 or -1
+};
+
+// --------------------------------------------------------
+// A 20 byte version of Vertex, see VertexCompression.h
+// for the encoding and CompressedVertexShader.hlsl for
+// the matching decode.
+// --------------------------------------------------------
+struct CompressedVertex
+{
+	uint16_t Position[4];	// UNORM16 xyz within the mesh's bounds, w is the tangent handedness as 0 or 1
+	int16_t Normal[2];		// SNORM16 octahedral encoded unit vector
+	uint16_t UV[2];			// Half floats
+	int16_t Tangent[2];		// SNORM16 octahedral encoded unit vector
+};
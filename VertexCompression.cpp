@@ -0,0 +1,167 @@
+#include "VertexCompression.h"
+
+#include "Graphics.h"
+#include <d3dcompiler.h>
+#include <DirectXPackedVector.h>
+#include <cmath>
+#include <cstddef>
+
+using namespace DirectX;
+
+namespace
+{
+	/// <summary>
+	/// Rounds a float in [0, 1] to the nearest UNORM16.
+	/// </summary>
+	uint16_t ToUNorm16(float a_fValue)
+	{
+		a_fValue = a_fValue < 0.0f ? 0.0f : (a_fValue > 1.0f ? 1.0f : a_fValue);
+		return static_cast<uint16_t>(a_fValue * 65535.0f + 0.5f);
+	}
+
+	/// <summary>
+	/// Rounds a float in [-1, 1] to the nearest SNORM16.
+	/// </summary>
+	int16_t ToSNorm16(float a_fValue)
+	{
+		a_fValue = a_fValue < -1.0f ? -1.0f : (a_fValue > 1.0f ? 1.0f : a_fValue);
+		return static_cast<int16_t>(std::lround(a_fValue * 32767.0f));
+	}
+
+	/// <summary>
+	/// D3D's SNORM conversion, where both -32768 and -32767 mean -1.
+	/// </summary>
+	float FromSNorm16(int16_t a_dValue)
+	{
+		float fValue = a_dValue / 32767.0f;
+		return fValue < -1.0f ? -1.0f : fValue;
+	}
+
+	/// <summary>
+	/// Sign that treats 0 as positive, so the octahedron's seams fold consistently.
+	/// </summary>
+	float SignNotZero(float a_fValue)
+	{
+		return a_fValue >= 0.0f ? 1.0f : -1.0f;
+	}
+}
+
+CompressedVertex VertexCompression::Compress(const Vertex& a_vVertex, const XMFLOAT3& a_v3BoundsMin, const XMFLOAT3& a_v3BoundsMax)
+{
+	CompressedVertex compressed = {};
+
+	// Flat axes (e.g. a quad's) have no extent, everything on them sits at the minimum.
+	const float* pPosition = &a_vVertex.Position.x;
+	const float* pMin = &a_v3BoundsMin.x;
+	const float* pMax = &a_v3BoundsMax.x;
+	for (int i = 0; i < 3; i++)
+	{
+		float fExtent = pMax[i] - pMin[i];
+		compressed.Position[i] = fExtent > 0.0f ? ToUNorm16((pPosition[i] - pMin[i]) / fExtent) : 0;
+	}
+	compressed.Position[3] = a_vVertex.Tangent.w < 0.0f ? 0 : 65535;
+
+	EncodeOctahedral(a_vVertex.Normal, compressed.Normal);
+	EncodeOctahedral(XMFLOAT3(a_vVertex.Tangent.x, a_vVertex.Tangent.y, a_vVertex.Tangent.z), compressed.Tangent);
+
+	compressed.UV[0] = PackedVector::XMConvertFloatToHalf(a_vVertex.UV.x);
+	compressed.UV[1] = PackedVector::XMConvertFloatToHalf(a_vVertex.UV.y);
+	return compressed;
+}
+
+Vertex VertexCompression::Decompress(const CompressedVertex& a_cvVertex, const XMFLOAT3& a_v3BoundsMin, const XMFLOAT3& a_v3BoundsMax)
+{
+	Vertex vertex = {};
+
+	float* pPosition = &vertex.Position.x;
+	const float* pMin = &a_v3BoundsMin.x;
+	const float* pMax = &a_v3BoundsMax.x;
+	for (int i = 0; i < 3; i++)
+	{
+		pPosition[i] = pMin[i] + (a_cvVertex.Position[i] / 65535.0f) * (pMax[i] - pMin[i]);
+	}
+
+	vertex.Normal = DecodeOctahedral(a_cvVertex.Normal);
+	XMFLOAT3 v3Tangent = DecodeOctahedral(a_cvVertex.Tangent);
+	vertex.Tangent = XMFLOAT4(v3Tangent.x, v3Tangent.y, v3Tangent.z, a_cvVertex.Position[3] != 0 ? 1.0f : -1.0f);
+
+	vertex.UV.x = PackedVector::XMConvertHalfToFloat(a_cvVertex.UV[0]);
+	vertex.UV.y = PackedVector::XMConvertHalfToFloat(a_cvVertex.UV[1]);
+	return vertex;
+}
+
+void VertexCompression::EncodeOctahedral(const XMFLOAT3& a_v3Direction, int16_t a_pEncoded[2])
+{
+	// Projecting onto the octahedron |x| + |y| + |z| = 1.
+	float fL1 = std::fabs(a_v3Direction.x) + std::fabs(a_v3Direction.y) + std::fabs(a_v3Direction.z);
+	if (fL1 <= 0.0f)
+	{
+		// Zero length (e.g. a tangent on a degenerate uv layout), pick +Z.
+		a_pEncoded[0] = 0;
+		a_pEncoded[1] = 0;
+		return;
+	}
+	float fX = a_v3Direction.x / fL1;
+	float fY = a_v3Direction.y / fL1;
+
+	// Folding the lower hemisphere out over the corners of the square.
+	if (a_v3Direction.z < 0.0f)
+	{
+		float fFoldedX = (1.0f - std::fabs(fY)) * SignNotZero(fX);
+		float fFoldedY = (1.0f - std::fabs(fX)) * SignNotZero(fY);
+		fX = fFoldedX;
+		fY = fFoldedY;
+	}
+
+	a_pEncoded[0] = ToSNorm16(fX);
+	a_pEncoded[1] = ToSNorm16(fY);
+}
+
+XMFLOAT3 VertexCompression::DecodeOctahedral(const int16_t a_pEncoded[2])
+{
+	float fX = FromSNorm16(a_pEncoded[0]);
+	float fY = FromSNorm16(a_pEncoded[1]);
+	float fZ = 1.0f - std::fabs(fX) - std::fabs(fY);
+
+	// Unfolding the lower hemisphere.
+	float fT = fZ < 0.0f ? -fZ : 0.0f;
+	fX += fX >= 0.0f ? -fT : fT;
+	fY += fY >= 0.0f ? -fT : fT;
+
+	float fLength = std::sqrt(fX * fX + fY * fY + fZ * fZ);
+	return XMFLOAT3(fX / fLength, fY / fLength, fZ / fLength);
+}
+
+Microsoft::WRL::ComPtr<ID3D11InputLayout> VertexCompression::CreateInputLayout(LPCWSTR a_sShaderFile)
+{
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> pInputLayout;
+
+	// The layout is validated against the shader's input signature.
+	Microsoft::WRL::ComPtr<ID3DBlob> pShaderBlob;
+	if (FAILED(D3DReadFileToBlob(a_sShaderFile, pShaderBlob.GetAddressOf())))
+		return pInputLayout;
+
+	D3D11_INPUT_ELEMENT_DESC elements[4] = {};
+	elements[0].SemanticName = "POSITION";
+	elements[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+	elements[0].AlignedByteOffset = offsetof(CompressedVertex, Position);
+	elements[1].SemanticName = "NORMAL";
+	elements[1].Format = DXGI_FORMAT_R16G16_SNORM;
+	elements[1].AlignedByteOffset = offsetof(CompressedVertex, Normal);
+	elements[2].SemanticName = "TEXCOORD";
+	elements[2].Format = DXGI_FORMAT_R16G16_FLOAT;
+	elements[2].AlignedByteOffset = offsetof(CompressedVertex, UV);
+	elements[3].SemanticName = "TANGENT";
+	elements[3].Format = DXGI_FORMAT_R16G16_SNORM;
+	elements[3].AlignedByteOffset = offsetof(CompressedVertex, Tangent);
+	for (D3D11_INPUT_ELEMENT_DESC& element : elements)
+		element.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+	Graphics::Device->CreateInputLayout(
+		elements,
+		ARRAYSIZE(elements),
+		pShaderBlob->GetBufferPointer(),
+		pShaderBlob->GetBufferSize(),
+		pInputLayout.GetAddressOf());
+	return pInputLayout;
+}
@@ -0,0 +1,72 @@
+#ifndef __VERTEXCOMPRESSION_H_
+#define __VERTEXCOMPRESSION_H_
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <DirectXMath.h>
+#include "Vertex.h"
+
+/// <summary>
+/// Encoding between the full float Vertex and the 20 byte CompressedVertex.
+/// Positions are quantized to UNORM16 inside a bounding box, normals and
+/// tangents are octahedral encoded into two SNORM16s and UVs are half floats.
+/// The decode here matches CompressedVertexShader.hlsl exactly.
+/// </summary>
+namespace VertexCompression
+{
+	// Worst case error of a round trip: per position axis as a fraction of the
+	// bounds' extent on that axis, as the angle between the original and decoded
+	// unit vectors, and per uv component relative to max(1, |uv|).
+	const float MAX_POSITION_ERROR = 1.0f / 65535.0f;
+	const float MAX_DIRECTION_ERROR_RADIANS = 0.001f;
+	const float MAX_UV_ERROR = 1.0f / 2048.0f;
+
+	/// <summary>
+	/// Compresses a single vertex.
+	/// </summary>
+	/// <param name="a_vVertex">The vertex being compressed.</param>
+	/// <param name="a_v3BoundsMin">Minimum corner of the box the position is quantized within.</param>
+	/// <param name="a_v3BoundsMax">Maximum corner of the box the position is quantized within.</param>
+	/// <returns>The compressed vertex.</returns>
+	CompressedVertex Compress(
+		const Vertex& a_vVertex,
+		const DirectX::XMFLOAT3& a_v3BoundsMin,
+		const DirectX::XMFLOAT3& a_v3BoundsMax);
+
+	/// <summary>
+	/// Decompresses a single vertex the same way the vertex shader does.
+	/// </summary>
+	/// <param name="a_cvVertex">The vertex being decompressed.</param>
+	/// <param name="a_v3BoundsMin">Minimum corner of the box it was compressed with.</param>
+	/// <param name="a_v3BoundsMax">Maximum corner of the box it was compressed with.</param>
+	/// <returns>The approximated original vertex.</returns>
+	Vertex Decompress(
+		const CompressedVertex& a_cvVertex,
+		const DirectX::XMFLOAT3& a_v3BoundsMin,
+		const DirectX::XMFLOAT3& a_v3BoundsMax);
+
+	/// <summary>
+	/// Maps a unit vector onto an octahedron unfolded into the [-1, 1] square.
+	/// </summary>
+	/// <param name="a_v3Direction">The unit vector being encoded.</param>
+	/// <param name="a_pEncoded">Receives the two SNORM16 components.</param>
+	void EncodeOctahedral(const DirectX::XMFLOAT3& a_v3Direction, int16_t a_pEncoded[2]);
+
+	/// <summary>
+	/// Unfolds an octahedral encoded vector back into a unit vector.
+	/// </summary>
+	/// <param name="a_pEncoded">The two SNORM16 components.</param>
+	/// <returns>The normalized direction.</returns>
+	DirectX::XMFLOAT3 DecodeOctahedral(const int16_t a_pEncoded[2]);
+
+	/// <summary>
+	/// Creates the input layout describing CompressedVertex for a vertex shader.
+	/// Reflection can only produce 32 bit formats, so this layout has to be
+	/// passed into the SimpleVertexShader constructor by hand.
+	/// </summary>
+	/// <param name="a_sShaderFile">Path to the compiled vertex shader (.cso).</param>
+	/// <returns>The input layout, or null if the shader could not be read.</returns>
+	Microsoft::WRL::ComPtr<ID3D11InputLayout> CreateInputLayout(LPCWSTR a_sShaderFile);
+}
+
+#endif //__VERTEXCOMPRESSION_H_
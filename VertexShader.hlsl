@@ -1,21 +1,16 @@
 #include "ShaderFunctions.hlsli"
 
-cbuffer ExternalData : register(b0)
+// Changes every draw, see PBRPixelShader.hlsl and SceneConstants.hlsli for the slower changing buffers.
+cbuffer PerObject : register(b0)
 {
 	// - -
-    float4 colorTint;
-	// - -
     matrix world;	
 	// - -
     matrix worldInvTranspose;
 	// - -
-	matrix view;
-	// - -
-	matrix projection;
+    matrix worldViewProjection;
 	// - -
-    matrix lightView;
-	// - -
-    matrix lightProjection;
+    matrix worldLightViewProjection;
 }
 
 VertexToPixel main( VertexShaderInput input )
@@ -23,15 +18,13 @@ VertexToPixel main( VertexShaderInput input )
 	// Set up output struct
 	VertexToPixel output;
     
-	matrix wvp = mul(projection, mul(view, world));
-    matrix shadowWVP = mul(lightProjection, mul(lightView, world));
-	
-	output.screenPosition = mul(wvp, float4(input.localPosition, 1.0f));
+	// The matrix products are done once per object on the CPU.
+	output.screenPosition = mul(worldViewProjection, float4(input.localPosition, 1.0f));
     output.normal = normalize(mul((float3x3) worldInvTranspose, input.normal));
     output.uv = input.uv;
     output.worldPos = mul(world, float4(input.localPosition, 1.0f)).xyz;
-    output.tangent = normalize(mul((float3x3) world, input.tangent));
-    output.shadowMapPos = mul(shadowWVP, float4(input.localPosition, 1.0f));
+    output.tangent = float4(normalize(mul((float3x3) world, input.tangent.xyz)), input.tangent.w);
+    output.shadowMapPos = mul(worldLightViewProjection, float4(input.localPosition, 1.0f));
 	
 	return output;
 }
\ No newline at end of file